@@ -72,6 +72,7 @@ namespace AdapterLib
     static const DWORD ResourceDiscoveryTimeout = 15000;     //in msecs
 
     static const int64 DevicePingTimeout = 300;            //in seconds
+    static const uint32_t DiscoveryCacheMaxAge = 300;     //in seconds
 
     static const GUID APPLICATION_GUID = { 0xc0d9e107,0x6ec8,0x4255,{0xb1,0xc1,0x05,0xae,0x3a,0x58,0xf8,0xad} };
 
@@ -149,17 +150,30 @@ namespace AdapterLib
             {
                 throw ref new FailureException();
             }
+            //devices found again by the multicast platform discovery are not asked again for their device and resources
+            OCSetDiscoveryCacheMaxAge(DiscoveryCacheMaxAge);
             adapterInstance->InitPlatformDiscovery();
             adapterInstance->InitPresenceRequest();
             }
 
             while (action->Status != AsyncStatus::Canceled)
             {
+                uint32_t timeout = UINT32_MAX;
                 {
                     AutoLock sync(adapterInstance->m_ocStackLock);
-                OCProcess();
+                OCProcessEvents(&timeout);
+                }
+
+                //wait for received data instead of polling, but look for cancellation at least every OCProcessTimeout
+                if (timeout > OCProcessTimeout)
+                {
+                    timeout = static_cast<uint32_t>(OCProcessTimeout);
+                }
+                OCStackResult result = OCWaitForEvents(timeout);
+                if (result != OC_STACK_OK && result != OC_STACK_TIMEOUT)
+                {
+                    Sleep(OCProcessTimeout);
                 }
-                Sleep(OCProcessTimeout);
             }
         })
         );
@@ -619,6 +633,7 @@ namespace AdapterLib
         if (m_OICProcessThreadAction)
         {
             m_OICProcessThreadAction->Cancel();
+            OCSignalEvents();
         }
 
         OCStop();
@@ -102,6 +102,7 @@ LOCAL_C_INCLUDES := $(OIC_SRC_PATH)/include
 LOCAL_C_INCLUDES += $(OIC_SRC_PATH)/c_common
 LOCAL_C_INCLUDES += $(OIC_SRC_PATH)/c_common/oic_string/include
 LOCAL_C_INCLUDES += $(OIC_SRC_PATH)/c_common/oic_malloc/include
+LOCAL_C_INCLUDES += $(OIC_SRC_PATH)/c_common/oic_hash/include
 LOCAL_C_INCLUDES += $(OIC_SRC_PATH)/csdk/stack/include
 LOCAL_C_INCLUDES += $(OIC_SRC_PATH)/csdk/ocsocket/include
 LOCAL_C_INCLUDES += $(OIC_SRC_PATH)/oc_logger/include
@@ -77,6 +77,65 @@ static cJSON *cJSON_New_Item(void)
 	return node;
 }
 
+/* Arena documents: items and strings are carved out of a chain of blocks. The first block starts with the
+   arena header and the root item follows it, so the root is all cJSON_DeleteArena needs. */
+typedef struct cJSON_ArenaBlock {
+	struct cJSON_ArenaBlock *next;
+	size_t size,used;
+} cJSON_ArenaBlock;
+
+typedef struct cJSON_Arena {
+	cJSON_ArenaBlock *first,*current;
+} cJSON_Arena;
+
+typedef union {double d;void *p;} cJSON_ArenaAlign;
+#define cJSON_ArenaRound(n)		(((n)+sizeof(cJSON_ArenaAlign)-1)&~(sizeof(cJSON_ArenaAlign)-1))
+#define cJSON_ArenaHeader		cJSON_ArenaRound(sizeof(cJSON_ArenaBlock)+sizeof(cJSON_Arena))
+#define cJSON_ArenaMinBlock		1024
+
+static void *arena_alloc(cJSON_Arena *arena,size_t size)
+{
+	cJSON_ArenaBlock *block=arena->current;void *ptr;size_t blocksize;
+	size=cJSON_ArenaRound(size);
+	if (block->size-block->used<size)
+	{
+		blocksize=block->size*2;if (blocksize<size+cJSON_ArenaHeader) blocksize=size+cJSON_ArenaHeader;
+		if (!(block=(cJSON_ArenaBlock*)cJSON_malloc(blocksize))) return 0;
+		block->size=blocksize;block->used=cJSON_ArenaRound(sizeof(cJSON_ArenaBlock));
+		/* Keep the first block at the head, it is found again through the root. */
+		block->next=arena->first->next;arena->first->next=block;arena->current=block;
+	}
+	ptr=(char*)block+block->used;block->used+=size;
+	return ptr;
+}
+
+static cJSON_Arena *arena_create(size_t size)
+{
+	cJSON_ArenaBlock *block;cJSON_Arena *arena;
+	size=cJSON_ArenaRound(size)+cJSON_ArenaHeader;if (size<cJSON_ArenaMinBlock) size=cJSON_ArenaMinBlock;
+	if (!(block=(cJSON_ArenaBlock*)cJSON_malloc(size))) return 0;
+	block->next=0;block->size=size;block->used=cJSON_ArenaHeader;
+	arena=(cJSON_Arena*)(block+1);arena->first=arena->current=block;
+	return arena;
+}
+
+static void arena_delete(cJSON_Arena *arena)
+{
+	cJSON_ArenaBlock *block=arena->first,*next;
+	while (block) {next=block->next;cJSON_free(block);block=next;}
+}
+
+/* Allocators of the parser, from the arena if there is one. */
+static void *parse_malloc(cJSON_Arena *arena,size_t size)	{return arena?arena_alloc(arena,size):cJSON_malloc(size);}
+static cJSON *parse_new_item(cJSON_Arena *arena)
+{
+	cJSON *node;
+	if (!arena) return cJSON_New_Item();
+	node=(cJSON*)arena_alloc(arena,sizeof(cJSON));
+	if (node) memset(node,0,sizeof(cJSON));
+	return node;
+}
+
 /* Delete a cJSON structure. */
 void cJSON_Delete(cJSON *c)
 {
@@ -106,7 +165,7 @@ static const char *parse_number(cJSON *item,const char *num)
 		while (*num>='0' && *num<='9') subscale=(subscale*10)+(*num++ - '0');	/* Number? */
 	}
 
-	n=sign*n*pow(10.0,(scale+subscale*signsubscale));	/* number = +/- number.fraction * 10^+/- exponent */
+	n=sign*n;if (scale+subscale*signsubscale) n*=pow(10.0,(scale+subscale*signsubscale));	/* number = +/- number.fraction * 10^+/- exponent */
 	
 	item->valuedouble=n;
 	item->valueint=(int)n;
@@ -114,27 +173,35 @@ static const char *parse_number(cJSON *item,const char *num)
 	return num;
 }
 
-/* Render the number nicely from the given item into a string. */
-static char *print_number(cJSON *item)
+/* Growable output of the printer. Everything is rendered straight into one buffer. */
+typedef struct {char *buffer;size_t length;size_t offset;} printbuffer;
+
+/* Make room for needed more bytes at the offset. The buffer is released if it can't grow. */
+static char *ensure(printbuffer *p,size_t needed)
+{
+	char *newbuffer=0;size_t newsize;
+	if (!p->buffer) return 0;
+	needed+=p->offset;
+	if (needed<=p->length) return p->buffer+p->offset;
+	newsize=p->length*2;if (newsize<needed) newsize=needed;
+	if (cJSON_malloc==malloc && cJSON_free==free) newbuffer=(char*)realloc(p->buffer,newsize);	/* No realloc hook, but the default one may grow in place. */
+	else if ((newbuffer=(char*)cJSON_malloc(newsize))) {memcpy(newbuffer,p->buffer,p->offset);cJSON_free(p->buffer);}
+	if (!newbuffer) {cJSON_free(p->buffer);p->buffer=0;p->length=0;return 0;}
+	p->buffer=newbuffer;p->length=newsize;
+	return newbuffer+p->offset;
+}
+
+/* Render the number nicely from the given item into the buffer. */
+static int print_number(cJSON *item,printbuffer *p)
 {
 	char *str;
 	double d=item->valuedouble;
-	if (fabs(((double)item->valueint)-d)<=DBL_EPSILON && d<=INT_MAX && d>=INT_MIN)
-	{
-		str=(char*)cJSON_malloc(21);	/* 2^64+1 can be represented in 21 chars. */
-		if (str) sprintf(str,"%d",item->valueint);
-	}
-	else
-	{
-		str=(char*)cJSON_malloc(64);	/* This is a nice tradeoff. */
-		if (str)
-		{
-			if (fabs(floor(d)-d)<=DBL_EPSILON && fabs(d)<1.0e60)sprintf(str,"%.0f",d);
-			else if (fabs(d)<1.0e-6 || fabs(d)>1.0e9)			sprintf(str,"%e",d);
-			else												sprintf(str,"%f",d);
-		}
-	}
-	return str;
+	if (!(str=ensure(p,64))) return 0;	/* 2^64+1 can be represented in 21 chars, 64 is a nice tradeoff for the rest. */
+	if (fabs(((double)item->valueint)-d)<=DBL_EPSILON && d<=INT_MAX && d>=INT_MIN)	p->offset+=sprintf(str,"%d",item->valueint);
+	else if (fabs(floor(d)-d)<=DBL_EPSILON && fabs(d)<1.0e60)						p->offset+=sprintf(str,"%.0f",d);
+	else if (fabs(d)<1.0e-6 || fabs(d)>1.0e9)										p->offset+=sprintf(str,"%e",d);
+	else																			p->offset+=sprintf(str,"%f",d);
+	return 1;
 }
 
 static unsigned parse_hex4(const char *str)
@@ -152,18 +219,23 @@ static unsigned parse_hex4(const char *str)
 
 /* Parse the input text into an unescaped cstring, and populate item. */
 static const unsigned char firstByteMark[7] = { 0x00, 0x00, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC };
-static const char *parse_string(cJSON *item,const char *str)
+
+/* Bound the unescaped length of the string at str. Returns the closing quote, or the end of the text. */
+static const char *string_length(const char *str,size_t *len)
 {
-	const char *ptr=str+1;char *ptr2;char *out;int len=0;unsigned uc,uc2;
+	const char *ptr=str+1;size_t escapes=0;
 	if (*str!='\"') {ep=str;return 0;}	/* not a string! */
-	
-	while (*ptr!='\"' && *ptr && ++len) if (*ptr++ == '\\') ptr++;	/* Skip escaped quotes. */
-	
-	out=(char*)cJSON_malloc(len+1);	/* This is how long we need for the string, roughly. */
-	if (!out) return 0;
-	
-	ptr=str+1;ptr2=out;
-	while (*ptr!='\"' && *ptr)
+	while (*(ptr+=strcspn(ptr,"\"\\"))=='\\') {if (!ptr[1]) {ep=str;return 0;} ptr+=2;escapes++;}	/* Skip escaped quotes. */
+	*len=(ptr-str-1)-escapes;
+	return ptr;
+}
+
+/* Unescape the string at str, which ends at end, into out. Escapes may not run past end. */
+static const char *decode_string(char *out,const char *str,const char *end)
+{
+	const char *ptr=str+1;char *ptr2=out;int len;unsigned uc,uc2;
+	if (!memchr(ptr,'\\',end-ptr)) {memcpy(out,ptr,end-ptr);out[end-ptr]=0;return (*end=='\"')?end+1:end;}	/* Nothing to unescape. */
+	while (ptr<end)
 	{
 		if (*ptr!='\\') *ptr2++=*ptr++;
 		else
@@ -177,6 +249,7 @@ static const char *parse_string(cJSON *item,const char *str)
 				case 'r': *ptr2++='\r';	break;
 				case 't': *ptr2++='\t';	break;
 				case 'u':	 /* transcode utf16 to utf8. */
+					if (end-ptr<5) {ep=str;return 0;}	/* cut off. */
 					uc=parse_hex4(ptr+1);ptr+=4;	/* get the unicode char. */
 
 					if ((uc>=0xDC00 && uc<=0xDFFF) || uc==0)	break;	/* check for invalid.	*/
@@ -184,6 +257,7 @@ static const char *parse_string(cJSON *item,const char *str)
 					if (uc>=0xD800 && uc<=0xDBFF)	/* UTF16 surrogate pairs.	*/
 					{
 						if (ptr[1]!='\\' || ptr[2]!='u')	break;	/* missing second-half of surrogate.	*/
+						if (end-ptr<7) {ep=str;return 0;}	/* cut off. */
 						uc2=parse_hex4(ptr+3);ptr+=6;
 						if (uc2<0xDC00 || uc2>0xDFFF)		break;	/* invalid second-half of surrogate.	*/
 						uc=0x10000 + (((uc&0x3FF)<<10) | (uc2&0x3FF));
@@ -205,26 +279,38 @@ static const char *parse_string(cJSON *item,const char *str)
 		}
 	}
 	*ptr2=0;
-	if (*ptr=='\"') ptr++;
+	if (*end=='\"') end++;
+	return end;
+}
+
+static const char *parse_string(cJSON *item,const char *str,cJSON_Arena *arena)
+{
+	const char *end;char *out;size_t len;
+	if (!(end=string_length(str,&len))) return 0;
+	
+	out=(char*)parse_malloc(arena,len+1);	/* This is how long we need for the string, roughly. */
+	if (!out) return 0;
+	
+	if (!(end=decode_string(out,str,end))) {if (!arena) cJSON_free(out);return 0;}
 	item->valuestring=out;
 	item->type=cJSON_String;
-	return ptr;
+	return end;
 }
 
 /* Render the cstring provided to an escaped version that can be printed. */
-static char *print_string_ptr(const char *str)
+static int print_string_ptr(const char *str,printbuffer *p)
 {
-	const char *ptr;char *ptr2,*out;int len=0;unsigned char token;
+	const char *ptr;char *ptr2;size_t len=0;unsigned char token;
 	
-	if (!str) return cJSON_strdup("");
-	ptr=str;while ((token=*ptr) && ++len) {if (strchr("\"\\\b\f\n\r\t",token)) len++; else if (token<32) len+=5;ptr++;}
+	if (!str) return 1;	/* Renders as nothing. */
+	ptr=str;while ((token=*ptr) && ++len) {if (token=='\"' || token=='\\') len++; else if (token<32) len+=strchr("\b\f\n\r\t",token)?1:5;ptr++;}
 	
-	out=(char*)cJSON_malloc(len+3);
-	if (!out) return 0;
+	ptr2=ensure(p,len+3);
+	if (!ptr2) return 0;
 
-	ptr2=out;ptr=str;
 	*ptr2++='\"';
-	while (*ptr)
+	if (len==(size_t)(ptr-str)) {memcpy(ptr2,str,len);ptr2+=len;}	/* Nothing to escape. */
+	else for (ptr=str;*ptr;)
 	{
 		if ((unsigned char)*ptr>31 && *ptr!='\"' && *ptr!='\\') *ptr2++=*ptr++;
 		else
@@ -243,19 +329,27 @@ static char *print_string_ptr(const char *str)
 			}
 		}
 	}
-	*ptr2++='\"';*ptr2++=0;
-	return out;
+	*ptr2++='\"';
+	p->offset=ptr2-p->buffer;
+	return 1;
+}
+
+/* Render a fixed token. */
+static int print_literal(const char *str,printbuffer *p)
+{
+	size_t len=strlen(str);char *ptr=ensure(p,len);
+	if (!ptr) return 0;
+	memcpy(ptr,str,len);p->offset+=len;
+	return 1;
 }
-/* Invote print_string_ptr (which is useful) on an item. */
-static char *print_string(cJSON *item)	{return print_string_ptr(item->valuestring);}
 
 /* Predeclare these prototypes. */
-static const char *parse_value(cJSON *item,const char *value);
-static char *print_value(cJSON *item,int depth,int fmt);
-static const char *parse_array(cJSON *item,const char *value);
-static char *print_array(cJSON *item,int depth,int fmt);
-static const char *parse_object(cJSON *item,const char *value);
-static char *print_object(cJSON *item,int depth,int fmt);
+static const char *parse_value(cJSON *item,const char *value,cJSON_Arena *arena);
+static int print_value(cJSON *item,int depth,int fmt,printbuffer *p);
+static const char *parse_array(cJSON *item,const char *value,cJSON_Arena *arena);
+static int print_array(cJSON *item,int depth,int fmt,printbuffer *p);
+static const char *parse_object(cJSON *item,const char *value,cJSON_Arena *arena);
+static int print_object(cJSON *item,int depth,int fmt,printbuffer *p);
 
 /* Utility to jump whitespace and cr/lf */
 static const char *skip(const char *in) {while (in && *in && (unsigned char)*in<=32) in++; return in;}
@@ -268,7 +362,7 @@ cJSON *cJSON_ParseWithOpts(const char *value,const char **return_parse_end,int r
 	ep=0;
 	if (!c) return 0;       /* memory fail */
 
-	end=parse_value(c,skip(value));
+	end=parse_value(c,skip(value),0);
 	if (!end)	{cJSON_Delete(c);return 0;}	/* parse failure. ep is set. */
 
 	/* if we require null-terminated JSON without appended garbage, skip and then check for a null terminator */
@@ -279,45 +373,74 @@ cJSON *cJSON_ParseWithOpts(const char *value,const char **return_parse_end,int r
 /* Default options for cJSON_Parse */
 cJSON *cJSON_Parse(const char *value) {return cJSON_ParseWithOpts(value,0,0);}
 
+/* Parse a document into an arena. */
+cJSON *cJSON_ParseArena(const char *value)
+{
+	cJSON_Arena *arena;cJSON *c;size_t len;
+	ep=0;
+	if (!value) return 0;
+	/* Strings take no more than the text, and typical documents have a value per 16 chars or more. Denser ones grow the arena. */
+	len=strlen(value);
+	arena=arena_create(len/16*(cJSON_ArenaRound(sizeof(cJSON))+sizeof(cJSON_ArenaAlign))+len);
+	if (!arena) return 0;	/* memory fail */
+	c=parse_new_item(arena);	/* Right behind the header. */
+	if (!c || !parse_value(c,skip(value),arena))	{arena_delete(arena);return 0;}	/* parse failure. ep is set. */
+	return c;
+}
+void cJSON_DeleteArena(cJSON *c)	{if (c) arena_delete((cJSON_Arena*)((cJSON_ArenaBlock*)((char*)c-cJSON_ArenaHeader)+1));}
+
 /* Render a cJSON item/entity/structure to text. */
-char *cJSON_Print(cJSON *item)				{return print_value(item,0,1);}
-char *cJSON_PrintUnformatted(cJSON *item)	{return print_value(item,0,0);}
+char *cJSON_PrintBuffered(cJSON *item,int prebuffer,int fmt)
+{
+	printbuffer p;char *out;
+	p.length=prebuffer>0?(size_t)prebuffer:1;p.offset=0;
+	if (!(p.buffer=(char*)cJSON_malloc(p.length))) return 0;
+	if (!print_value(item,0,fmt,&p) || !(out=ensure(&p,1))) {if (p.buffer) cJSON_free(p.buffer);return 0;}
+	*out=0;
+	/* Give back the slack of the last growth, the text may be kept for a long time. */
+	if (cJSON_malloc==malloc && cJSON_free==free && p.offset+1<p.length && (out=(char*)realloc(p.buffer,p.offset+1))) p.buffer=out;
+	return p.buffer;
+}
+char *cJSON_Print(cJSON *item)				{return cJSON_PrintBuffered(item,256,1);}
+char *cJSON_PrintUnformatted(cJSON *item)	{return cJSON_PrintBuffered(item,256,0);}
 
 /* Parser core - when encountering text, process appropriately. */
-static const char *parse_value(cJSON *item,const char *value)
+static const char *parse_value(cJSON *item,const char *value,cJSON_Arena *arena)
 {
 	if (!value)						return 0;	/* Fail on null. */
-	if (!strncmp(value,"null",4))	{ item->type=cJSON_NULL;  return value+4; }
-	if (!strncmp(value,"false",5))	{ item->type=cJSON_False; return value+5; }
-	if (!strncmp(value,"true",4))	{ item->type=cJSON_True; item->valueint=1;	return value+4; }
-	if (*value=='\"')				{ return parse_string(item,value); }
-	if (*value=='-' || (*value>='0' && *value<='9'))	{ return parse_number(item,value); }
-	if (*value=='[')				{ return parse_array(item,value); }
-	if (*value=='{')				{ return parse_object(item,value); }
+	switch (*value)	/* The first char decides, most values are strings. */
+	{
+		case '\"':	return parse_string(item,value,arena);
+		case '[':	return parse_array(item,value,arena);
+		case '{':	return parse_object(item,value,arena);
+		case 'n':	if (!strncmp(value,"null",4))	{ item->type=cJSON_NULL;  return value+4; }	break;
+		case 'f':	if (!strncmp(value,"false",5))	{ item->type=cJSON_False; return value+5; }	break;
+		case 't':	if (!strncmp(value,"true",4))	{ item->type=cJSON_True; item->valueint=1;	return value+4; }	break;
+		default:	if (*value=='-' || (*value>='0' && *value<='9'))	return parse_number(item,value);	break;
+	}
 
 	ep=value;return 0;	/* failure. */
 }
 
 /* Render a value to text. */
-static char *print_value(cJSON *item,int depth,int fmt)
+static int print_value(cJSON *item,int depth,int fmt,printbuffer *p)
 {
-	char *out=0;
 	if (!item) return 0;
 	switch ((item->type)&255)
 	{
-		case cJSON_NULL:	out=cJSON_strdup("null");	break;
-		case cJSON_False:	out=cJSON_strdup("false");break;
-		case cJSON_True:	out=cJSON_strdup("true"); break;
-		case cJSON_Number:	out=print_number(item);break;
-		case cJSON_String:	out=print_string(item);break;
-		case cJSON_Array:	out=print_array(item,depth,fmt);break;
-		case cJSON_Object:	out=print_object(item,depth,fmt);break;
+		case cJSON_NULL:	return print_literal("null",p);
+		case cJSON_False:	return print_literal("false",p);
+		case cJSON_True:	return print_literal("true",p);
+		case cJSON_Number:	return print_number(item,p);
+		case cJSON_String:	return print_string_ptr(item->valuestring,p);
+		case cJSON_Array:	return print_array(item,depth,fmt,p);
+		case cJSON_Object:	return print_object(item,depth,fmt,p);
 	}
-	return out;
+	return 0;
 }
 
 /* Build an array from input text. */
-static const char *parse_array(cJSON *item,const char *value)
+static const char *parse_array(cJSON *item,const char *value,cJSON_Arena *arena)
 {
 	cJSON *child;
 	if (*value!='[')	{ep=value;return 0;}	/* not an array! */
@@ -326,17 +449,17 @@ static const char *parse_array(cJSON *item,const char *value)
 	value=skip(value+1);
 	if (*value==']') return value+1;	/* empty array. */
 
-	item->child=child=cJSON_New_Item();
+	item->child=child=parse_new_item(arena);
 	if (!item->child) return 0;		 /* memory fail */
-	value=skip(parse_value(child,skip(value)));	/* skip any spacing, get the value. */
+	value=skip(parse_value(child,skip(value),arena));	/* skip any spacing, get the value. */
 	if (!value) return 0;
 
 	while (*value==',')
 	{
 		cJSON *new_item;
-		if (!(new_item=cJSON_New_Item())) return 0; 	/* memory fail */
+		if (!(new_item=parse_new_item(arena))) return 0; 	/* memory fail */
 		child->next=new_item;new_item->prev=child;child=new_item;
-		value=skip(parse_value(child,skip(value+1)));
+		value=skip(parse_value(child,skip(value+1),arena));
 		if (!value) return 0;	/* memory fail */
 	}
 
@@ -345,65 +468,30 @@ static const char *parse_array(cJSON *item,const char *value)
 }
 
 /* Render an array to text */
-static char *print_array(cJSON *item,int depth,int fmt)
+static int print_array(cJSON *item,int depth,int fmt,printbuffer *p)
 {
-	char **entries;
-	char *out=0,*ptr,*ret;int len=5;
+	char *ptr;
 	cJSON *child=item->child;
-	int numentries=0,i=0,fail=0;
-	
-	/* How many entries in the array? */
-	while (child) numentries++,child=child->next;
-	/* Explicitly handle numentries==0 */
-	if (!numentries)
-	{
-		out=(char*)cJSON_malloc(3);
-		if (out) strcpy(out,"[]");
-		return out;
-	}
-	/* Allocate an array to hold the values for each */
-	entries=(char**)cJSON_malloc(numentries*sizeof(char*));
-	if (!entries) return 0;
-	memset(entries,0,numentries*sizeof(char*));
-	/* Retrieve all the results: */
-	child=item->child;
-	while (child && !fail)
-	{
-		ret=print_value(child,depth+1,fmt);
-		entries[i++]=ret;
-		if (ret) len+=strlen(ret)+2+(fmt?1:0); else fail=1;
-		child=child->next;
-	}
-	
-	/* If we didn't fail, try to malloc the output string */
-	if (!fail) out=(char*)cJSON_malloc(len);
-	/* If that fails, we fail. */
-	if (!out) fail=1;
-
-	/* Handle failure. */
-	if (fail)
-	{
-		for (i=0;i<numentries;i++) if (entries[i]) cJSON_free(entries[i]);
-		cJSON_free(entries);
-		return 0;
-	}
 	
-	/* Compose the output array. */
-	*out='[';
-	ptr=out+1;*ptr=0;
-	for (i=0;i<numentries;i++)
+	if (!(ptr=ensure(p,1))) return 0;
+	*ptr='[';p->offset++;
+	while (child)
 	{
-		strcpy(ptr,entries[i]);ptr+=strlen(entries[i]);
-		if (i!=numentries-1) {*ptr++=',';if(fmt)*ptr++=' ';*ptr=0;}
-		cJSON_free(entries[i]);
+		if (!print_value(child,depth+1,fmt,p)) return 0;
+		if ((child=child->next))
+		{
+			if (!(ptr=ensure(p,2))) return 0;
+			*ptr++=',';if (fmt) *ptr++=' ';
+			p->offset=ptr-p->buffer;
+		}
 	}
-	cJSON_free(entries);
-	*ptr++=']';*ptr++=0;
-	return out;	
+	if (!(ptr=ensure(p,1))) return 0;
+	*ptr=']';p->offset++;
+	return 1;
 }
 
 /* Build an object from the text. */
-static const char *parse_object(cJSON *item,const char *value)
+static const char *parse_object(cJSON *item,const char *value,cJSON_Arena *arena)
 {
 	cJSON *child;
 	if (*value!='{')	{ep=value;return 0;}	/* not an object! */
@@ -412,25 +500,25 @@ static const char *parse_object(cJSON *item,const char *value)
 	value=skip(value+1);
 	if (*value=='}') return value+1;	/* empty array. */
 	
-	item->child=child=cJSON_New_Item();
+	item->child=child=parse_new_item(arena);
 	if (!item->child) return 0;
-	value=skip(parse_string(child,skip(value)));
+	value=skip(parse_string(child,skip(value),arena));
 	if (!value) return 0;
 	child->string=child->valuestring;child->valuestring=0;
 	if (*value!=':') {ep=value;return 0;}	/* fail! */
-	value=skip(parse_value(child,skip(value+1)));	/* skip any spacing, get the value. */
+	value=skip(parse_value(child,skip(value+1),arena));	/* skip any spacing, get the value. */
 	if (!value) return 0;
 	
 	while (*value==',')
 	{
 		cJSON *new_item;
-		if (!(new_item=cJSON_New_Item()))	return 0; /* memory fail */
+		if (!(new_item=parse_new_item(arena)))	return 0; /* memory fail */
 		child->next=new_item;new_item->prev=child;child=new_item;
-		value=skip(parse_string(child,skip(value+1)));
+		value=skip(parse_string(child,skip(value+1),arena));
 		if (!value) return 0;
 		child->string=child->valuestring;child->valuestring=0;
 		if (*value!=':') {ep=value;return 0;}	/* fail! */
-		value=skip(parse_value(child,skip(value+1)));	/* skip any spacing, get the value. */
+		value=skip(parse_value(child,skip(value+1),arena));	/* skip any spacing, get the value. */
 		if (!value) return 0;
 	}
 	
@@ -439,71 +527,134 @@ static const char *parse_object(cJSON *item,const char *value)
 }
 
 /* Render an object to text. */
-static char *print_object(cJSON *item,int depth,int fmt)
+static int print_object(cJSON *item,int depth,int fmt,printbuffer *p)
 {
-	char **entries=0,**names=0;
-	char *out=0,*ptr,*ret,*str;int len=7,i=0,j;
+	char *ptr;int i;
 	cJSON *child=item->child;
-	int numentries=0,fail=0;
-	/* Count the number of entries. */
-	while (child) numentries++,child=child->next;
 	/* Explicitly handle empty object case */
-	if (!numentries)
+	if (!child)
 	{
-		out=(char*)cJSON_malloc(fmt?depth+4:3);
-		if (!out)	return 0;
-		ptr=out;*ptr++='{';
+		if (!(ptr=ensure(p,fmt?depth+3:2)))	return 0;
+		*ptr++='{';
 		if (fmt) {*ptr++='\n';for (i=0;i<depth-1;i++) *ptr++='\t';}
-		*ptr++='}';*ptr++=0;
-		return out;
+		*ptr++='}';
+		p->offset=ptr-p->buffer;
+		return 1;
 	}
-	/* Allocate space for the names and the objects */
-	entries=(char**)cJSON_malloc(numentries*sizeof(char*));
-	if (!entries) return 0;
-	names=(char**)cJSON_malloc(numentries*sizeof(char*));
-	if (!names) {cJSON_free(entries);return 0;}
-	memset(entries,0,sizeof(char*)*numentries);
-	memset(names,0,sizeof(char*)*numentries);
-
-	/* Collect all the results into our arrays: */
-	child=item->child;depth++;if (fmt) len+=depth;
+
+	/* Compose the output: */
+	depth++;
+	if (!(ptr=ensure(p,2))) return 0;
+	*ptr++='{';if (fmt) *ptr++='\n';
+	p->offset=ptr-p->buffer;
 	while (child)
 	{
-		names[i]=str=print_string_ptr(child->string);
-		entries[i++]=ret=print_value(child,depth,fmt);
-		if (str && ret) len+=strlen(ret)+strlen(str)+2+(fmt?2+depth:0); else fail=1;
+		if (!(ptr=ensure(p,fmt?depth:0))) return 0;
+		if (fmt) {for (i=0;i<depth;i++) *ptr++='\t';p->offset+=depth;}
+		if (!print_string_ptr(child->string,p)) return 0;
+		if (!(ptr=ensure(p,2))) return 0;
+		*ptr++=':';if (fmt) *ptr++='\t';
+		p->offset=ptr-p->buffer;
+		if (!print_value(child,depth,fmt,p)) return 0;
 		child=child->next;
+		if (!(ptr=ensure(p,2))) return 0;
+		if (child) *ptr++=',';
+		if (fmt) *ptr++='\n';
+		p->offset=ptr-p->buffer;
 	}
 	
-	/* Try to allocate the output string */
-	if (!fail) out=(char*)cJSON_malloc(len);
-	if (!out) fail=1;
+	if (!(ptr=ensure(p,fmt?depth:1))) return 0;
+	if (fmt) for (i=0;i<depth-1;i++) *ptr++='\t';
+	*ptr++='}';
+	p->offset=ptr-p->buffer;
+	return 1;
+}
+
+/* Streaming parser: values go to the callbacks as they are read, and only the current strings are kept. */
+typedef struct {
+	const cJSON_SaxHandler *handler;void *ctx;
+	printbuffer key,value;	/* Scratch space of the current member name and string value. */
+} sax_parser;
+
+static const char *sax_value(sax_parser *sax,const char *key,const char *value);
 
-	/* Handle failure */
-	if (fail)
+static const char *sax_string(printbuffer *scratch,const char *str)
+{
+	const char *end;char *out;size_t len;
+	if (!(end=string_length(str,&len))) return 0;
+	scratch->offset=0;
+	if (!(out=ensure(scratch,len+1))) return 0;
+	return decode_string(out,str,end);
+}
+
+static const char *sax_array(sax_parser *sax,const char *key,const char *value)
+{
+	const cJSON_SaxHandler *h=sax->handler;
+	if (h->start_array && !h->start_array(sax->ctx,key)) return 0;
+	value=skip(value+1);
+	if (*value!=']')
 	{
-		for (i=0;i<numentries;i++) {if (names[i]) cJSON_free(names[i]);if (entries[i]) cJSON_free(entries[i]);}
-		cJSON_free(names);cJSON_free(entries);
-		return 0;
+		value=skip(sax_value(sax,0,value));
+		while (value && *value==',') value=skip(sax_value(sax,0,skip(value+1)));
+		if (!value) return 0;
+		if (*value!=']') {ep=value;return 0;}	/* malformed. */
 	}
-	
-	/* Compose the output: */
-	*out='{';ptr=out+1;if (fmt)*ptr++='\n';*ptr=0;
-	for (i=0;i<numentries;i++)
+	if (h->end_array && !h->end_array(sax->ctx)) return 0;
+	return value+1;
+}
+
+static const char *sax_object(sax_parser *sax,const char *key,const char *value)
+{
+	const cJSON_SaxHandler *h=sax->handler;
+	if (h->start_object && !h->start_object(sax->ctx,key)) return 0;
+	value=skip(value+1);
+	if (*value!='}') for (;;)
 	{
-		if (fmt) for (j=0;j<depth;j++) *ptr++='\t';
-		strcpy(ptr,names[i]);ptr+=strlen(names[i]);
-		*ptr++=':';if (fmt) *ptr++='\t';
-		strcpy(ptr,entries[i]);ptr+=strlen(entries[i]);
-		if (i!=numentries-1) *ptr++=',';
-		if (fmt) *ptr++='\n';*ptr=0;
-		cJSON_free(names[i]);cJSON_free(entries[i]);
+		value=skip(sax_string(&sax->key,value));
+		if (!value) return 0;
+		if (*value!=':') {ep=value;return 0;}	/* fail! */
+		value=skip(sax_value(sax,sax->key.buffer,skip(value+1)));
+		if (!value) return 0;
+		if (*value!=',') break;
+		value=skip(value+1);
 	}
-	
-	cJSON_free(names);cJSON_free(entries);
-	if (fmt) for (i=0;i<depth-1;i++) *ptr++='\t';
-	*ptr++='}';*ptr++=0;
-	return out;	
+	if (*value!='}') {ep=value;return 0;}	/* malformed. */
+	if (h->end_object && !h->end_object(sax->ctx)) return 0;
+	return value+1;
+}
+
+static const char *sax_value(sax_parser *sax,const char *key,const char *value)
+{
+	cJSON item;
+	if (!value)						return 0;	/* Fail on null. */
+	if (*value=='[')				return sax_array(sax,key,value);
+	if (*value=='{')				return sax_object(sax,key,value);
+
+	memset(&item,0,sizeof(cJSON));item.string=(char*)key;
+	if (*value=='\"')						{ if (!(value=sax_string(&sax->value,value))) return 0; item.type=cJSON_String; item.valuestring=sax->value.buffer; }
+	else if (*value=='-' || (*value>='0' && *value<='9'))	{ value=parse_number(&item,value); }
+	else if (!strncmp(value,"null",4))		{ item.type=cJSON_NULL;  value+=4; }
+	else if (!strncmp(value,"false",5))	{ item.type=cJSON_False; value+=5; }
+	else if (!strncmp(value,"true",4))		{ item.type=cJSON_True; item.valueint=1;	value+=4; }
+	else { ep=value;return 0; }	/* failure. */
+
+	if (sax->handler->value && !sax->handler->value(sax->ctx,key,&item)) return 0;
+	return value;
+}
+
+int cJSON_ParseSax(const char *value,const cJSON_SaxHandler *handler,void *ctx)
+{
+	sax_parser sax;const char *end;
+	ep=0;
+	if (!handler) return 0;
+	sax.handler=handler;sax.ctx=ctx;
+	sax.key.length=sax.value.length=64;sax.key.offset=sax.value.offset=0;
+	sax.key.buffer=(char*)cJSON_malloc(sax.key.length);
+	sax.value.buffer=(char*)cJSON_malloc(sax.value.length);
+	end=sax_value(&sax,0,skip(value));
+	if (sax.key.buffer) cJSON_free(sax.key.buffer);
+	if (sax.value.buffer) cJSON_free(sax.value.buffer);
+	return end!=0;
 }
 
 /* Get Array size/item / object item. */
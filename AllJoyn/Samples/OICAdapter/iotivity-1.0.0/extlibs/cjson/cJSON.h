@@ -68,9 +68,33 @@ extern cJSON *cJSON_Parse(const char *value);
 extern char  *cJSON_Print(cJSON *item);
 /* Render a cJSON entity to text for transfer/storage without any formatting. Free the char* when finished. */
 extern char  *cJSON_PrintUnformatted(cJSON *item);
+/* Render a cJSON entity to text, starting with a buffer of prebuffer bytes. fmt=0 gives unformatted, =1 gives formatted. Free the char* when finished. */
+extern char  *cJSON_PrintBuffered(cJSON *item,int prebuffer,int fmt);
 /* Delete a cJSON entity and all subentities. */
 extern void   cJSON_Delete(cJSON *c);
 
+/* Parse a block of JSON into a single arena: one allocation for the document instead of one per item and string.
+   The result is read-only - don't add, detach, replace or cJSON_Delete its items (cJSON_Duplicate gives a heap copy).
+   Call cJSON_DeleteArena on the returned root when finished. */
+extern cJSON *cJSON_ParseArena(const char *value);
+/* Release a document returned by cJSON_ParseArena. */
+extern void   cJSON_DeleteArena(cJSON *c);
+
+/* Callbacks of the streaming parser. key is the member name inside an object and 0 elsewhere. value gets a
+   temporary item holding type, valuestring, valueint and valuedouble; the item and the strings are only valid
+   during the call. Callbacks may be 0. Return 0 from a callback to stop parsing. */
+typedef struct cJSON_SaxHandler {
+	int (*start_object)(void *ctx,const char *key);
+	int (*end_object)(void *ctx);
+	int (*start_array)(void *ctx,const char *key);
+	int (*end_array)(void *ctx);
+	int (*value)(void *ctx,const char *key,const cJSON *item);
+} cJSON_SaxHandler;
+
+/* Walk a block of JSON without building it, for documents too large to keep as items. Returns 1 when the whole
+   value was read, 0 on a parse error (see cJSON_GetErrorPtr), out of memory or when a callback stopped it. */
+extern int    cJSON_ParseSax(const char *value,const cJSON_SaxHandler *handler,void *ctx);
+
 /* Returns the number of items in an array (or object). */
 extern int	  cJSON_GetArraySize(cJSON *array);
 /* Retrieve item number "item" from array "array". Returns NULL if unsuccessful. */
@@ -202,10 +202,25 @@ enum CborParserIteratorFlags
     CborIteratorFlag_ContainerIsMap         = 0x20
 };
 
+struct CborIndexEntry
+{
+    uint32_t begin;
+    uint32_t end;
+};
+typedef struct CborIndexEntry CborIndexEntry;
+
+enum CborIndexFlags
+{
+    CborIndexFlag_ValidateUtf8              = 0x01
+};
+
 struct CborParser
 {
     const uint8_t *end;
     int flags;
+    const uint8_t *indexBase;
+    const CborIndexEntry *index;
+    size_t indexCount;
 };
 typedef struct CborParser CborParser;
 
@@ -221,6 +236,8 @@ struct CborValue
 typedef struct CborValue CborValue;
 
 CBOR_API CborError cbor_parser_init(const uint8_t *buffer, size_t size, int flags, CborParser *parser, CborValue *it);
+CBOR_API CborError cbor_parser_build_index(CborParser *parser, const CborValue *it, int flags,
+                                           CborIndexEntry *entries, size_t capacity, size_t *count);
 
 CBOR_INLINE_API bool cbor_value_at_end(const CborValue *it)
 { return it->remaining == 0; }
@@ -349,8 +366,24 @@ CBOR_PRIVATE_API CborError _cbor_value_copy_string(const CborValue *value, void
 CBOR_PRIVATE_API CborError _cbor_value_dup_string(const CborValue *value, void **buffer,
                                                   size_t *buflen, CborValue *next);
 
+CBOR_PRIVATE_API CborError _cbor_value_get_string_view(const CborValue *value, const void **string,
+                                                       size_t *length, CborValue *next);
+
 CBOR_API CborError cbor_value_calculate_string_length(const CborValue *value, size_t *length);
 
+CBOR_INLINE_API CborError cbor_value_get_text_string_view(const CborValue *value, const char **string,
+                                                          size_t *length, CborValue *next)
+{
+    assert(cbor_value_is_text_string(value));
+    return _cbor_value_get_string_view(value, (const void **)string, length, next);
+}
+CBOR_INLINE_API CborError cbor_value_get_byte_string_view(const CborValue *value, const uint8_t **string,
+                                                          size_t *length, CborValue *next)
+{
+    assert(cbor_value_is_byte_string(value));
+    return _cbor_value_get_string_view(value, (const void **)string, length, next);
+}
+
 CBOR_INLINE_API CborError cbor_value_copy_text_string(const CborValue *value, char *buffer,
                                                       size_t *buflen, CborValue *next)
 {
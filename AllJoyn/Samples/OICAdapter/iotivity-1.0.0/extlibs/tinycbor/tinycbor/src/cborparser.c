@@ -249,6 +249,266 @@ CborError cbor_parser_init(const uint8_t *buffer, size_t size, int flags, CborPa
     return preparse_value(it);
 }
 
+typedef struct IndexBuilder
+{
+    const uint8_t *base;
+    const uint8_t *end;
+    CborIndexEntry *entries;
+    size_t capacity;
+    size_t count;
+    int flags;
+} IndexBuilder;
+
+static size_t index_begin(IndexBuilder *builder, const uint8_t *ptr)
+{
+    size_t i = builder->count++;
+    if (i < builder->capacity)
+        builder->entries[i].begin = ptr - builder->base;
+    return i;
+}
+
+static void index_end(IndexBuilder *builder, size_t i, const uint8_t *ptr)
+{
+    if (i < builder->capacity)
+        builder->entries[i].end = ptr - builder->base;
+}
+
+static bool is_valid_utf8(const uint8_t *ptr, size_t len)
+{
+    const uint8_t *end = ptr + len;
+    while (ptr != end) {
+        // plain ASCII is checked a word at a time
+        while ((size_t)(end - ptr) >= sizeof(uint64_t)) {
+            uint64_t word;
+            memcpy(&word, ptr, sizeof(word));
+            if (word & UINT64_C(0x8080808080808080))
+                break;
+            ptr += sizeof(word);
+        }
+        if (ptr == end)
+            break;
+
+        uint8_t c = *ptr++;
+        if (c < 0x80)
+            continue;
+
+        uint32_t codepoint;
+        uint32_t min;
+        int continuations;
+        if (c < 0xc2) {
+            // continuation byte or overlong two byte sequence
+            return false;
+        } else if (c < 0xe0) {
+            codepoint = c & 0x1f;
+            min = 0x80;
+            continuations = 1;
+        } else if (c < 0xf0) {
+            codepoint = c & 0x0f;
+            min = 0x800;
+            continuations = 2;
+        } else if (c < 0xf5) {
+            codepoint = c & 0x07;
+            min = 0x10000;
+            continuations = 3;
+        } else {
+            return false;
+        }
+
+        if (end - ptr < continuations)
+            return false;
+        while (continuations--) {
+            if ((*ptr & 0xc0) != 0x80)
+                return false;
+            codepoint = (codepoint << 6) | (*ptr++ & 0x3f);
+        }
+        if (codepoint < min || codepoint > 0x10ffff ||
+                (codepoint >= 0xd800 && codepoint <= 0xdfff))
+            return false;
+    }
+    return true;
+}
+
+static CborError index_string_data(IndexBuilder *builder, const uint8_t **ptr, uint64_t length,
+                                   uint8_t type)
+{
+    size_t len = length;
+    if (len != length)
+        return CborErrorDataTooLarge;
+    if (len > (size_t)(builder->end - *ptr))
+        return CborErrorUnexpectedEOF;
+    if (type == CborTextStringType && (builder->flags & CborIndexFlag_ValidateUtf8) &&
+            !is_valid_utf8(*ptr, len))
+        return CborErrorInvalidUtf8TextString;
+    *ptr += len;
+    return CborNoError;
+}
+
+static CborError index_string_chunks(IndexBuilder *builder, const uint8_t **ptr, uint8_t type)
+{
+    size_t entry = index_begin(builder, (*ptr)++);
+    while (true) {
+        if (*ptr == builder->end)
+            return CborErrorUnexpectedEOF;
+        if (**ptr == (uint8_t)BreakByte) {
+            ++*ptr;
+            break;
+        }
+        if ((**ptr & MajorTypeMask) != type)
+            return CborErrorIllegalType;
+
+        uint64_t length;
+        CborError err = extract_number(ptr, builder->end, &length);
+        if (err)
+            return err;
+        err = index_string_data(builder, ptr, length, type);
+        if (err)
+            return err;
+    }
+    index_end(builder, entry, *ptr);
+    return CborNoError;
+}
+
+static CborError index_value(IndexBuilder *builder, const uint8_t **ptr, int nestingLevel,
+                             bool *isTag);
+
+static CborError index_container(IndexBuilder *builder, const uint8_t **ptr, const uint8_t *begin,
+                                 uint32_t items, int nestingLevel)
+{
+    if (nestingLevel == CBOR_PARSER_MAX_RECURSIONS)
+        return CborErrorNestingTooDeep;
+    if (items == 0)
+        return CborNoError;     // nothing to skip, so not indexed
+
+    CborError err;
+    bool isTag;
+    size_t entry = index_begin(builder, begin);
+    if (items == UINT32_MAX) {
+        // a break may follow any item, even a tag
+        while (true) {
+            if (*ptr == builder->end)
+                return CborErrorUnexpectedEOF;
+            if (**ptr == (uint8_t)BreakByte) {
+                ++*ptr;
+                break;
+            }
+            err = index_value(builder, ptr, nestingLevel + 1, &isTag);
+            if (err)
+                return err;
+        }
+    } else {
+        // tags don't count as items
+        while (items) {
+            err = index_value(builder, ptr, nestingLevel + 1, &isTag);
+            if (err)
+                return err;
+            if (!isTag)
+                --items;
+        }
+    }
+    index_end(builder, entry, *ptr);
+    return CborNoError;
+}
+
+// Validates one item, a tag or what follows a tag, the same way as iterating over it does.
+static CborError index_value(IndexBuilder *builder, const uint8_t **ptr, int nestingLevel,
+                             bool *isTag)
+{
+    if (*ptr == builder->end)
+        return CborErrorUnexpectedEOF;
+
+    const uint8_t *begin = *ptr;
+    uint8_t type = *begin & MajorTypeMask;
+    uint8_t descriptor = *begin & SmallValueMask;
+    *isTag = type == CborTagType;
+
+    if (descriptor > Value64Bit) {
+        if (unlikely(descriptor != IndefiniteLength))
+            return type == CborSimpleType ? CborErrorUnknownType : CborErrorIllegalNumber;
+        if (is_fixed_type(type))
+            return type == CborSimpleType ? CborErrorUnexpectedBreak : CborErrorIllegalNumber;
+        if (type == CborArrayType || type == CborMapType) {
+            ++*ptr;
+            return index_container(builder, ptr, begin, UINT32_MAX, nestingLevel);
+        }
+        return index_string_chunks(builder, ptr, type);
+    }
+
+#ifndef CBOR_PARSER_NO_STRICT_CHECKS
+    if (type == CborSimpleType && descriptor == SimpleTypeInNextByte &&
+            begin + 1 < builder->end && begin[1] < 32)
+        return CborErrorIllegalSimpleType;
+#endif
+
+    uint64_t length;
+    CborError err = extract_number(ptr, builder->end, &length);
+    if (err)
+        return err;
+
+    switch (type) {
+    case CborByteStringType:
+    case CborTextStringType:
+        return index_string_data(builder, ptr, length, type);
+
+    case CborArrayType:
+    case CborMapType:
+        if (length >= UINT32_MAX || (type == CborMapType && length > UINT32_MAX / 2))
+            return CborErrorDataTooLarge;
+        return index_container(builder, ptr, begin,
+                               type == CborMapType ? length * 2 : length, nestingLevel);
+    }
+    return CborNoError;
+}
+
+/**
+ * Validates the item at \a it, the tags preceding it and everything nested in
+ * it, and records where each container and chunked string in it ends. Once the
+ * index is attached to \a parser, cbor_value_advance() and
+ * cbor_value_map_find_value() skip over those in O(log n) time for the number
+ * of entries instead of iterating over their contents.
+ *
+ * The \a entries array of \a capacity entries is used by the parser and needs
+ * to remain valid as long as \a parser is used. The number of entries the
+ * item needs is stored in \a count. If that is more than \a capacity, only the
+ * first entries are used, and the containers after them are iterated over as
+ * without an index.
+ *
+ * The validation accepts the same as iterating over the whole item does. If
+ * \a flags contains CborIndexFlag_ValidateUtf8, the text strings must also be
+ * valid UTF-8. If the item is not valid, no index is attached.
+ */
+CborError cbor_parser_build_index(CborParser *parser, const CborValue *it, int flags,
+                                  CborIndexEntry *entries, size_t capacity, size_t *count)
+{
+    assert(it->parser == parser);
+    parser->index = NULL;
+    parser->indexCount = 0;
+    *count = 0;
+    if ((size_t)(parser->end - it->ptr) >= UINT32_MAX)
+        return CborErrorDataTooLarge;
+
+    IndexBuilder builder;
+    builder.base = it->ptr;
+    builder.end = parser->end;
+    builder.entries = entries;
+    builder.capacity = entries ? capacity : 0;
+    builder.count = 0;
+    builder.flags = flags;
+
+    const uint8_t *ptr = it->ptr;
+    bool isTag;
+    do {
+        CborError err = index_value(&builder, &ptr, 0, &isTag);
+        if (err)
+            return err;
+    } while (isTag);
+
+    *count = builder.count;
+    parser->indexBase = it->ptr;
+    parser->index = builder.capacity ? entries : NULL;
+    parser->indexCount = builder.count < builder.capacity ? builder.count : builder.capacity;
+    return CborNoError;
+}
+
 /**
  * Advances the CBOR value \a it by one fixed-size position. Fixed-size types
  * are: integers, tags, simple types (including boolean, null and undefined
@@ -265,11 +525,41 @@ CborError cbor_value_advance_fixed(CborValue *it)
     return advance_internal(it);
 }
 
+static const CborIndexEntry *find_index_entry(const CborParser *parser, const uint8_t *ptr)
+{
+    if (!parser->index || ptr < parser->indexBase)
+        return NULL;
+
+    // the entries are in the order of the items, so sorted by offset
+    size_t offset = ptr - parser->indexBase;
+    size_t low = 0;
+    size_t high = parser->indexCount;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (parser->index[mid].begin < offset)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    if (low < parser->indexCount && parser->index[low].begin == offset)
+        return &parser->index[low];
+    return NULL;
+}
+
 static CborError advance_recursive(CborValue *it, int nestingLevel)
 {
     if (is_fixed_type(it->type))
         return advance_internal(it);
 
+    if (cbor_value_is_container(it) || !cbor_value_is_length_known(it)) {
+        // validated when the index was built, so it can be skipped whole
+        const CborIndexEntry *entry = find_index_entry(it->parser, it->ptr);
+        if (entry) {
+            it->ptr = it->parser->indexBase + entry->end;
+            return preparse_next_value(it);
+        }
+    }
+
     if (!cbor_value_is_container(it)) {
         size_t len = SIZE_MAX;
         return _cbor_value_copy_string(it, NULL, &len, it);
@@ -521,7 +811,7 @@ static CborError iterate_string_chunks(const CborValue *value, char *buffer, siz
         err = extract_length(value->parser, &ptr, &total);
         if (err)
             return err;
-        if (ptr + total > value->parser->end)
+        if (total > (size_t)(value->parser->end - ptr))
             return CborErrorUnexpectedEOF;
         if (total <= *buflen)
             *result = func(buffer, ptr, total);
@@ -556,7 +846,7 @@ static CborError iterate_string_chunks(const CborValue *value, char *buffer, siz
             if (unlikely(add_check_overflow(total, chunkLen, &newTotal)))
                 return CborErrorDataTooLarge;
 
-            if (ptr + chunkLen > value->parser->end)
+            if (chunkLen > (size_t)(value->parser->end - ptr))
                 return CborErrorUnexpectedEOF;
 
             if (*result && *buflen >= newTotal)
@@ -643,6 +933,55 @@ CborError _cbor_value_copy_string(const CborValue *value, void *buffer,
                  copied_all ? CborNoError : CborErrorOutOfMemory;
 }
 
+/**
+ * \fn CborError cbor_value_get_text_string_view(const CborValue *value, const char **string, size_t *length, CborValue *next)
+ *
+ * Stores a pointer to the contents of the text string pointed by \a value in
+ * \a string and its length in \a length, without copying it. The contents are
+ * in the buffer being parsed, and are not NUL terminated.
+ *
+ * Only strings of known length are contiguous in the buffer. For a chunked
+ * string this function returns error condition \ref CborErrorUnknownLength and
+ * the string needs to be copied with cbor_value_copy_text_string().
+ *
+ * The \a next pointer, if not null, will be updated to point to the next item
+ * after this string.
+ *
+ * \sa cbor_value_get_byte_string_view(), cbor_value_copy_text_string()
+ */
+
+/**
+ * \fn CborError cbor_value_get_byte_string_view(const CborValue *value, const uint8_t **string, size_t *length, CborValue *next)
+ *
+ * Stores a pointer to the contents of the byte string pointed by \a value in
+ * \a string and its length in \a length, without copying it. For a chunked
+ * string this function returns error condition \ref CborErrorUnknownLength.
+ *
+ * \sa cbor_value_get_text_string_view(), cbor_value_copy_byte_string()
+ */
+CborError _cbor_value_get_string_view(const CborValue *value, const void **string,
+                                      size_t *length, CborValue *next)
+{
+    assert(cbor_value_is_byte_string(value) || cbor_value_is_text_string(value));
+    if (!cbor_value_is_length_known(value))
+        return CborErrorUnknownLength;
+
+    const uint8_t *ptr = value->ptr;
+    CborError err = extract_length(value->parser, &ptr, length);
+    if (err)
+        return err;
+    if (*length > (size_t)(value->parser->end - ptr))
+        return CborErrorUnexpectedEOF;
+    *string = ptr;
+
+    if (next) {
+        *next = *value;
+        next->ptr = ptr + *length;
+        return preparse_next_value(next);
+    }
+    return CborNoError;
+}
+
 /**
  * Compares the entry \a value with the string \a string and store the result
  * in \a result. If the value is different from \a string or if it is not a
@@ -666,6 +1005,15 @@ CborError cbor_value_text_string_equals(const CborValue *value, const char *stri
     return iterate_string_chunks(&copy, CONST_CAST(char *, string), &len, result, NULL, iterate_memcmp);
 }
 
+// A map of unknown length may end after a tag, or lack the value of its last key.
+static CborError skip_tag_in_map(CborValue *it)
+{
+    CborError err = cbor_value_skip_tag(it);
+    if (!err && cbor_value_at_end(it))
+        err = CborErrorUnexpectedBreak;
+    return err;
+}
+
 /**
  * Attempts to find the value in map \a map that corresponds to the text string
  * entry \a string. If the item is found, it is stored in \a result. If no item
@@ -684,7 +1032,7 @@ CborError cbor_value_map_find_value(const CborValue *map, const char *string, Cb
 
     while (!cbor_value_at_end(element)) {
         // find the non-tag so we can compare
-        err = cbor_value_skip_tag(element);
+        err = skip_tag_in_map(element);
         if (err)
             goto error;
         if (cbor_value_is_text_string(element)) {
@@ -704,7 +1052,7 @@ CborError cbor_value_map_find_value(const CborValue *map, const char *string, Cb
         }
 
         // skip this value
-        err = cbor_value_skip_tag(element);
+        err = skip_tag_in_map(element);
         if (err)
             goto error;
         err = cbor_value_advance(element);
@@ -6,7 +6,7 @@ LOCAL_MODULE := TinyDtls
 LOCAL_SRC_FILES := dtls.c crypto.c ccm.c hmac.c netq.c peer.c dtls_time.c session.c
 #LOCAL_SRC_FILES += debug.c
 LOCAL_SRC_FILES += aes/rijndael.c
-LOCAL_SRC_FILES += ecc/ecc.c
+LOCAL_SRC_FILES += ecc/ecc.c ecc/ecc_p256_64.c
 LOCAL_SRC_FILES += sha2/sha2.c
 
 LOCAL_C_INCLUDES := $(APP_PATH) $(APP_PATH)/aes $(APP_PATH)/ecc $(APP_PATH)/sha2
@@ -88,8 +88,23 @@ static void dtls_cipher_context_release(void)
 }
 
 #ifndef WITH_CONTIKI
+#if defined(DTLS_ECC) || defined(DTLS_X509)
+static pthread_mutex_t ecc_backend_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif /* DTLS_ECC */
+
 void crypto_init()
 {
+#if defined(DTLS_ECC) || defined(DTLS_X509)
+  /* Use the 64-bit secp256r1 code for the handshake where the platform supports it,
+   * unless the application installed its own callbacks. The first install builds the
+   * base point tables, so concurrent dtls_init() calls are serialized. */
+  pthread_mutex_lock(&ecc_backend_mutex);
+  if (!uECC_has_custom_cb())
+  {
+    uECC_use_p256_64();
+  }
+  pthread_mutex_unlock(&ecc_backend_mutex);
+#endif /* DTLS_ECC */
 }
 
 static dtls_handshake_parameters_t *dtls_handshake_malloc() {
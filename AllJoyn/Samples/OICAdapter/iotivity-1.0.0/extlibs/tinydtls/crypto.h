@@ -61,6 +61,9 @@
 #define DTLS_MASTER_SECRET_LENGTH 48
 #define DTLS_RANDOM_LENGTH 32
 
+/** Length of the session ids issued for resumable sessions */
+#define DTLS_SESSION_ID_LENGTH 32
+
 typedef enum { AES128=0 
 } dtls_crypto_alg;
 
@@ -97,6 +100,7 @@ typedef struct {
 typedef struct {
   uint16_t id_length;
   unsigned char identity[DTLS_PSK_MAX_CLIENT_IDENTITY_LEN];
+  unsigned char key_digest[DTLS_HMAC_DIGEST_SIZE]; /**< SHA-256 of the psk in use */
 } dtls_handshake_parameters_psk_t;
 
 typedef struct {
@@ -129,7 +133,10 @@ typedef struct {
 
   dtls_compression_t compression;		/**< compression method */
   dtls_cipher_t cipher;		/**< cipher type */
+  uint8 session_id[DTLS_SESSION_ID_LENGTH]; /**< offered, issued or resumed session id */
+  uint8 session_id_length;
   unsigned int do_client_auth:1;
+  unsigned int resumed:1;	/**< abbreviated handshake of a cached session */
 
 #if defined(DTLS_ECC) && defined(DTLS_PSK)
   struct keyx_t {
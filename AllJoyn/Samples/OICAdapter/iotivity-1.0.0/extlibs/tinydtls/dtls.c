@@ -74,9 +74,9 @@
 #define DTLS_HS_LENGTH sizeof(dtls_handshake_header_t)
 #define DTLS_CH_LENGTH sizeof(dtls_client_hello_t) /* no variable length fields! */
 #define DTLS_COOKIE_LENGTH_MAX 32
-#define DTLS_CH_LENGTH_MAX sizeof(dtls_client_hello_t) + DTLS_COOKIE_LENGTH_MAX + 12 + 26
+#define DTLS_CH_LENGTH_MAX sizeof(dtls_client_hello_t) + DTLS_SESSION_ID_LENGTH + DTLS_COOKIE_LENGTH_MAX + 12 + 26
 #define DTLS_HV_LENGTH sizeof(dtls_hello_verify_t)
-#define DTLS_SH_LENGTH (2 + DTLS_RANDOM_LENGTH + 1 + 2 + 1)
+#define DTLS_SH_LENGTH (2 + DTLS_RANDOM_LENGTH + 1 + DTLS_SESSION_ID_LENGTH + 2 + 1)
 #define DTLS_CE_LENGTH (3 + 3 + 27 + DTLS_EC_KEY_SIZE + DTLS_EC_KEY_SIZE)
 #define DTLS_SKEXEC_LENGTH (1 + 2 + 1 + 1 + DTLS_EC_KEY_SIZE + DTLS_EC_KEY_SIZE + 1 + 1 + 2 + 70)
 #define DTLS_SKEXEC_ECDH_ANON_LENGTH (1 + 2 + 1 + 1 + DTLS_EC_KEY_SIZE + DTLS_EC_KEY_SIZE)
@@ -654,6 +654,205 @@ hs_attempt_with_existing_peer(uint8_t *msg, size_t msglen,
     return 0;
 }
 
+/* Session cache for abbreviated handshakes (RFC 5246, section 7.3).
+ * Only sessions authenticated with a pre-shared key are cached: when
+ * such a session is resumed, the key for its identity is requested
+ * again and compared with the digest stored in the cache, so that a
+ * revoked or replaced key forces a full handshake. Sessions that were
+ * authenticated with certificates or not at all always take the full
+ * handshake. */
+
+static inline int
+is_resumable_cipher(dtls_cipher_t cipher) {
+  return is_tls_psk_with_aes_128_ccm_8(cipher) ||
+    is_tls_ecdhe_psk_with_aes_128_cbc_sha_256(cipher);
+}
+
+static void
+dtls_psk_digest(const unsigned char *psk, size_t length, unsigned char *digest) {
+  dtls_hash_ctx hash;
+
+  dtls_hash_init(&hash);
+  dtls_hash_update(&hash, psk, length);
+  dtls_hash_finalize(digest, &hash);
+}
+
+static inline void
+dtls_session_cache_remove(dtls_cached_session_t *entry) {
+  memset(entry, 0, sizeof(dtls_cached_session_t));
+}
+
+int
+dtls_set_session_cache(dtls_context_t *ctx, size_t capacity,
+		       unsigned int lifetime) {
+  dtls_cached_session_t *cache = NULL;
+
+  if (!ctx || lifetime > DTLS_SESSION_LIFETIME_MAX ||
+      capacity > SIZE_MAX / sizeof(dtls_cached_session_t))
+    return -1;
+
+  if (capacity) {
+    cache = (dtls_cached_session_t *)malloc(capacity * sizeof(dtls_cached_session_t));
+    if (!cache) {
+      dtls_warn("cannot allocate session cache\n");
+      return -1;
+    }
+    memset(cache, 0, capacity * sizeof(dtls_cached_session_t));
+  }
+
+  if (ctx->session_cache) {
+    /* do not leave master secrets behind in freed memory */
+    memset(ctx->session_cache, 0,
+	   ctx->session_cache_size * sizeof(dtls_cached_session_t));
+    free(ctx->session_cache);
+  }
+
+  ctx->session_cache = cache;
+  ctx->session_cache_size = capacity;
+  ctx->session_lifetime = lifetime * CLOCK_SECOND;
+  return 0;
+}
+
+/**
+ * Looks up a session that can be resumed. Servers search by the
+ * session @p id offered by the client, clients by the address of the
+ * server in @p session. Expired entries are dropped on the way.
+ */
+static dtls_cached_session_t *
+dtls_session_cache_find(dtls_context_t *ctx, dtls_peer_type role,
+			const session_t *session,
+			uint8 *id, size_t id_length) {
+  dtls_cached_session_t *entry;
+  dtls_tick_t now;
+  size_t i;
+
+  if (role == DTLS_SERVER && !id_length)
+    return NULL;
+
+  dtls_ticks(&now);
+  for (i = 0; i < ctx->session_cache_size; i++) {
+    entry = &ctx->session_cache[i];
+    if (!entry->id_length || entry->role != role)
+      continue;
+
+    if (entry->expires <= now) {
+      dtls_session_cache_remove(entry);
+      continue;
+    }
+
+    if (role == DTLS_SERVER
+	? (entry->id_length == id_length && equals(entry->id, id, id_length))
+	: dtls_session_equals(&entry->session, session)) {
+      entry->last_used = now;
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Stores the session just negotiated with @p peer in a full handshake.
+ * A client keeps one session per server. When the cache is full, the
+ * least recently used entry is replaced.
+ */
+static void
+dtls_session_cache_store(dtls_context_t *ctx, dtls_peer_t *peer) {
+  dtls_handshake_parameters_t *handshake = peer->handshake_params;
+  dtls_cached_session_t *entry = NULL;
+  dtls_cached_session_t *candidate;
+  dtls_tick_t now;
+  size_t i;
+
+  if (!ctx->session_cache_size)
+    return;
+
+  if (!handshake->session_id_length || !is_resumable_cipher(handshake->cipher)) {
+    /* do not offer the previous session to this server again */
+    if (peer->role == DTLS_CLIENT &&
+	(entry = dtls_session_cache_find(ctx, DTLS_CLIENT, &peer->session, NULL, 0)))
+      dtls_session_cache_remove(entry);
+    return;
+  }
+
+  dtls_ticks(&now);
+  for (i = 0; i < ctx->session_cache_size; i++) {
+    candidate = &ctx->session_cache[i];
+    if (peer->role == DTLS_CLIENT && candidate->id_length &&
+	candidate->role == DTLS_CLIENT &&
+	dtls_session_equals(&candidate->session, &peer->session)) {
+      entry = candidate;
+      break;
+    }
+    if (!entry || (entry->id_length &&
+		   (!candidate->id_length || candidate->expires <= now ||
+		    candidate->last_used < entry->last_used)))
+      entry = candidate;
+  }
+
+  if (entry->id_length && entry->expires > now &&
+      !(entry->role == DTLS_CLIENT && peer->role == DTLS_CLIENT &&
+	dtls_session_equals(&entry->session, &peer->session)))
+    ctx->session_stats.evictions++;
+
+  memset(entry, 0, sizeof(dtls_cached_session_t));
+  memcpy(&entry->session, &peer->session, sizeof(session_t));
+  entry->role = peer->role;
+  memcpy(entry->id, handshake->session_id, handshake->session_id_length);
+  entry->id_length = handshake->session_id_length;
+  memcpy(entry->master_secret, handshake->tmp.master_secret,
+	 DTLS_MASTER_SECRET_LENGTH);
+  entry->cipher = handshake->cipher;
+  entry->compression = handshake->compression;
+  memcpy(&entry->psk, &handshake->keyx.psk, sizeof(entry->psk));
+  entry->expires = now + ctx->session_lifetime;
+  entry->last_used = now;
+}
+
+/**
+ * Returns @c 1 if the application still has the pre-shared key that
+ * @p entry was negotiated with, @c 0 otherwise. As in the full
+ * handshake, the key is requested for the identity of the session.
+ */
+static int
+dtls_session_cache_check_psk(dtls_context_t *ctx, dtls_peer_t *peer,
+			     dtls_cached_session_t *entry) {
+  unsigned char psk[DTLS_PSK_MAX_KEY_LEN];
+  unsigned char digest[DTLS_HMAC_DIGEST_SIZE];
+  int len;
+
+  len = CALL(ctx, get_psk_info, &peer->session, DTLS_PSK_KEY,
+	     entry->psk.identity, entry->psk.id_length,
+	     psk, DTLS_PSK_MAX_KEY_LEN);
+  if (len < 0) {
+    dtls_debug("no psk for cached session\n");
+    return 0;
+  }
+
+  dtls_psk_digest(psk, len, digest);
+  memset(psk, 0, DTLS_PSK_MAX_KEY_LEN);
+
+  return equals(digest, entry->psk.key_digest, sizeof(digest));
+}
+
+/**
+ * Chooses the session id to send in the ServerHello of a full
+ * handshake: a fresh one when the session can be resumed later,
+ * otherwise none.
+ */
+static int
+dtls_new_session_id(dtls_context_t *ctx, dtls_handshake_parameters_t *handshake) {
+  handshake->session_id_length = 0;
+
+  if (!ctx->session_cache_size || !is_resumable_cipher(handshake->cipher))
+    return 0;
+
+  if (!dtls_prng(handshake->session_id, DTLS_SESSION_ID_LENGTH))
+    return dtls_alert_fatal_create(DTLS_ALERT_INTERNAL_ERROR);
+
+  handshake->session_id_length = DTLS_SESSION_ID_LENGTH;
+  return 0;
+}
+
 /** Dump out the cipher keys and IVs used for the symetric cipher. */
 static void dtls_debug_keyblock(dtls_security_parameters_t *config)
 {
@@ -717,6 +916,45 @@ static char *dtls_handshake_type_to_name(int type)
   }
 }
 
+/**
+ * Creates the security parameters for the next epoch of \p peer from
+ * \p master_secret and the random values of the hello messages. The
+ * master secret then replaces the random values in \p handshake for
+ * use in the Finished messages.
+ */
+static int
+calculate_key_block_from_master(dtls_handshake_parameters_t *handshake,
+				dtls_peer_t *peer,
+				const uint8 *master_secret,
+				dtls_peer_type role) {
+  dtls_security_parameters_t *security = dtls_security_params_next(peer);
+
+  if (!security) {
+    return dtls_alert_fatal_create(DTLS_ALERT_INTERNAL_ERROR);
+  }
+
+  /* create key_block from master_secret
+   * key_block = PRF(master_secret,
+                    "key expansion" + tmp.random.server + tmp.random.client) */
+
+  dtls_prf(master_secret,
+	   DTLS_MASTER_SECRET_LENGTH,
+	   PRF_LABEL(key), PRF_LABEL_SIZE(key),
+	   handshake->tmp.random.server, DTLS_RANDOM_LENGTH,
+	   handshake->tmp.random.client, DTLS_RANDOM_LENGTH,
+	   security->key_block,
+	   dtls_kb_size(security, role));
+
+  memcpy(handshake->tmp.master_secret, master_secret, DTLS_MASTER_SECRET_LENGTH);
+  dtls_debug_keyblock(security);
+
+  security->cipher = handshake->cipher;
+  security->compression = handshake->compression;
+  security->rseq = 0;
+
+  return 0;
+}
+
 /**
  * Calculate the pre master secret and after that calculate the master-secret.
  */
@@ -732,13 +970,8 @@ calculate_key_block(dtls_context_t *ctx,
   unsigned char pre_master_secret[MAX_KEYBLOCK_LENGTH];
 #endif /* defined(DTLS_PSK) && defined(DTLS_ECC) */
   int pre_master_len = 0;
-  dtls_security_parameters_t *security = dtls_security_params_next(peer);
   uint8 master_secret[DTLS_MASTER_SECRET_LENGTH];
 
-  if (!security) {
-    return dtls_alert_fatal_create(DTLS_ALERT_INTERNAL_ERROR);
-  }
-
   switch (handshake->cipher) {
 #ifdef DTLS_PSK
   case TLS_PSK_WITH_AES_128_CCM_8: {
@@ -760,6 +993,7 @@ calculate_key_block(dtls_context_t *ctx,
 
     dtls_debug_hexdump("psk", psk, len);
 
+    dtls_psk_digest(psk, len, handshake->keyx.psk.key_digest);
     memset(psk, 0, DTLS_PSK_MAX_KEY_LEN);
     if (pre_master_len < 0) {
       dtls_crit("the psk was too long, for the pre master secret\n");
@@ -807,6 +1041,9 @@ calculate_key_block(dtls_context_t *ctx,
                            pre_master_secret,
                            MAX_KEYBLOCK_LENGTH + uECC_BYTES);
 
+      dtls_psk_digest(psk, psklen, handshake->keyx.psk.key_digest);
+      memset(psk, 0, DTLS_PSK_MAX_KEY_LEN);
+
       if (pre_master_len < 0) {
         dtls_crit("the curve was too long, for the pre master secret\n");
         return dtls_alert_fatal_create(DTLS_ALERT_INTERNAL_ERROR);
@@ -832,26 +1069,7 @@ calculate_key_block(dtls_context_t *ctx,
 
   dtls_debug_dump("master_secret", master_secret, DTLS_MASTER_SECRET_LENGTH);
 
-  /* create key_block from master_secret
-   * key_block = PRF(master_secret,
-                    "key expansion" + tmp.random.server + tmp.random.client) */
-
-  dtls_prf(master_secret,
-	   DTLS_MASTER_SECRET_LENGTH,
-	   PRF_LABEL(key), PRF_LABEL_SIZE(key),
-	   handshake->tmp.random.server, DTLS_RANDOM_LENGTH,
-	   handshake->tmp.random.client, DTLS_RANDOM_LENGTH,
-	   security->key_block,
-	   dtls_kb_size(security, role));
-
-  memcpy(handshake->tmp.master_secret, master_secret, DTLS_MASTER_SECRET_LENGTH);
-  dtls_debug_keyblock(security);
-
-  security->cipher = handshake->cipher;
-  security->compression = handshake->compression;
-  security->rseq = 0;
-
-  return 0;
+  return calculate_key_block_from_master(handshake, peer, master_secret, role);
 }
 
 /* TODO: add a generic method which iterates over a list and searches for a specific key */
@@ -1089,6 +1307,13 @@ dtls_update_parameters(dtls_context_t *ctx,
   data += DTLS_RANDOM_LENGTH;
   data_length -= DTLS_RANDOM_LENGTH;
 
+  /* store the session id the client wants to resume */
+  i = dtls_uint8_to_int(data);
+  if (i > DTLS_SESSION_ID_LENGTH || data_length < i + sizeof(uint8))
+    goto error;
+  memcpy(config->session_id, data + sizeof(uint8), i);
+  config->session_id_length = i;
+
   /* Caution: SKIP_VAR_FIELD may jump to error: */
   SKIP_VAR_FIELD(data, data_length, uint8);	/* skip session id */
   SKIP_VAR_FIELD(data, data_length, uint8);	/* skip cookie */
@@ -2039,7 +2264,11 @@ dtls_send_server_hello(dtls_context_t *ctx, dtls_peer_t *peer)
   memcpy(p, handshake->tmp.random.server, DTLS_RANDOM_LENGTH);
   p += DTLS_RANDOM_LENGTH;
 
-  *p++ = 0;			/* no session id */
+  /* session id, empty if the session cannot be resumed */
+  dtls_int_to_uint8(p, handshake->session_id_length);
+  p += sizeof(uint8);
+  memcpy(p, handshake->session_id, handshake->session_id_length);
+  p += handshake->session_id_length;
 
   if (handshake->cipher != TLS_NULL_WITH_NULL_NULL) {
     /* selected cipher suite */
@@ -2810,6 +3039,66 @@ dtls_send_finished(dtls_context_t *ctx, dtls_peer_t *peer,
 				 buf, p - buf);
 }
 
+/**
+ * Answers a ClientHello that offers a cached session with an
+ * abbreviated handshake: ServerHello with the same session id,
+ * ChangeCipherSpec and Finished. The client replies with its own
+ * ChangeCipherSpec and Finished.
+ *
+ * \return \c 1 if the session is resumed, \c 0 if a full handshake is
+ * required, or a negative value on error.
+ */
+static int
+dtls_resume_session(dtls_context_t *ctx, dtls_peer_t *peer)
+{
+  dtls_handshake_parameters_t *handshake = peer->handshake_params;
+  dtls_cached_session_t *cached;
+  int res;
+
+  cached = dtls_session_cache_find(ctx, DTLS_SERVER, &peer->session,
+				   handshake->session_id,
+				   handshake->session_id_length);
+  if (!cached || cached->cipher != handshake->cipher ||
+      cached->compression != handshake->compression)
+    return 0;
+
+  if (!dtls_session_cache_check_psk(ctx, peer, cached)) {
+    dtls_session_cache_remove(cached);
+    return 0;
+  }
+
+  memcpy(&handshake->keyx.psk, &cached->psk, sizeof(handshake->keyx.psk));
+  handshake->resumed = 1;
+
+  res = dtls_send_server_hello(ctx, peer);
+  if (res < 0) {
+    dtls_debug("dtls_resume_session: cannot prepare ServerHello record\n");
+    return res;
+  }
+
+  res = calculate_key_block_from_master(handshake, peer, cached->master_secret,
+					DTLS_SERVER);
+  if (res < 0) {
+    return res;
+  }
+
+  res = dtls_send_ccs(ctx, peer);
+  if (res < 0) {
+    dtls_debug("cannot send CCS message\n");
+    return res;
+  }
+
+  dtls_security_params_switch(peer);
+
+  res = dtls_send_finished(ctx, peer, PRF_LABEL(server), PRF_LABEL_SIZE(server));
+  if (res < 0) {
+    dtls_debug("sending server Finished failed\n");
+    return res;
+  }
+
+  return 1;
+}
+
 static int
 dtls_send_client_hello(dtls_context_t *ctx, dtls_peer_t *peer,
                        uint8 cookie[], size_t cookie_length) {
@@ -2865,20 +3154,30 @@ dtls_send_client_hello(dtls_context_t *ctx, dtls_peer_t *peer,
   }
 
   if (cookie_length == 0) {
+    dtls_cached_session_t *cached;
+
     /* Set client random: First 4 bytes are the client's Unix timestamp,
      * followed by 28 bytes of generate random data. */
     dtls_ticks(&now);
     dtls_int_to_uint32(handshake->tmp.random.client, now / CLOCK_SECOND);
     dtls_prng(handshake->tmp.random.client + sizeof(uint32),
          DTLS_RANDOM_LENGTH - sizeof(uint32));
+
+    /* offer the last session with this server for resumption */
+    cached = dtls_session_cache_find(ctx, DTLS_CLIENT, &peer->session, NULL, 0);
+    handshake->session_id_length = cached ? cached->id_length : 0;
+    if (cached)
+      memcpy(handshake->session_id, cached->id, cached->id_length);
   }
   /* we must use the same Client Random as for the previous request */
   memcpy(p, handshake->tmp.random.client, DTLS_RANDOM_LENGTH);
   p += DTLS_RANDOM_LENGTH;
 
-  /* session id (length 0) */
-  dtls_int_to_uint8(p, 0);
+  /* session id, the same as in the previous request */
+  dtls_int_to_uint8(p, handshake->session_id_length);
   p += sizeof(uint8);
+  memcpy(p, handshake->session_id, handshake->session_id_length);
+  p += handshake->session_id_length;
 
   /* cookie */
   dtls_int_to_uint8(p, cookie_length);
@@ -3012,6 +3311,9 @@ check_server_hello(dtls_context_t *ctx,
 		      uint8 *data, size_t data_length)
 {
   dtls_handshake_parameters_t *handshake = peer->handshake_params;
+  dtls_cached_session_t *cached;
+  int resume;
+  int err;
 
   /* This function is called when we expect a ServerHello (i.e. we
    * have sent a ClientHello).  We might instead receive a HelloVerify
@@ -3048,6 +3350,18 @@ check_server_hello(dtls_context_t *ctx,
   data += DTLS_RANDOM_LENGTH;
   data_length -= DTLS_RANDOM_LENGTH;
 
+  /* The server resumes the session we offered if it sends back the
+   * same id. Any other id is kept for caching the new session. */
+  if (data_length < sizeof(uint8) ||
+      dtls_uint8_to_int(data) > DTLS_SESSION_ID_LENGTH ||
+      data_length < dtls_uint8_to_int(data) + sizeof(uint8))
+    goto error;
+  resume = handshake->session_id_length &&
+    handshake->session_id_length == dtls_uint8_to_int(data) &&
+    equals(handshake->session_id, data + sizeof(uint8), handshake->session_id_length);
+  handshake->session_id_length = dtls_uint8_to_int(data);
+  memcpy(handshake->session_id, data + sizeof(uint8), handshake->session_id_length);
+
   SKIP_VAR_FIELD(data, data_length, uint8); /* skip session id */
     
   /* Check cipher suite. As we offer all we have, it is sufficient
@@ -3070,7 +3384,28 @@ check_server_hello(dtls_context_t *ctx,
   data += sizeof(uint8);
   data_length -= sizeof(uint8);
 
-  return dtls_check_tls_extension(peer, data, data_length, 0);
+  err = dtls_check_tls_extension(peer, data, data_length, 0);
+  if (err < 0 || !resume)
+    return err;
+
+  /* abbreviated handshake: derive the keys from the cached session */
+  cached = dtls_session_cache_find(ctx, DTLS_CLIENT, &peer->session, NULL, 0);
+  if (!cached || cached->cipher != handshake->cipher ||
+      !equals(cached->id, handshake->session_id, handshake->session_id_length)) {
+    dtls_warn("server resumed a session we do not have\n");
+    return dtls_alert_fatal_create(DTLS_ALERT_HANDSHAKE_FAILURE);
+  }
+  if (!dtls_session_cache_check_psk(ctx, peer, cached)) {
+    dtls_session_cache_remove(cached);
+    return dtls_alert_fatal_create(DTLS_ALERT_HANDSHAKE_FAILURE);
+  }
+
+  memcpy(&handshake->keyx.psk, &cached->psk, sizeof(handshake->keyx.psk));
+  handshake->compression = cached->compression;
+  handshake->resumed = 1;
+
+  return calculate_key_block_from_master(handshake, peer, cached->master_secret,
+					 DTLS_CLIENT);
 
 error:
   return dtls_alert_fatal_create(DTLS_ALERT_DECODE_ERROR);
@@ -3799,7 +4134,9 @@ handle_handshake_msg(dtls_context_t *ctx, dtls_peer_t *peer, session_t *session,
       dtls_warn("error in check_server_hello err: %i\n", err);
       return err;
     }
-    if (is_tls_ecdhe_ecdsa_with_aes_128_ccm_8(peer->handshake_params->cipher))
+    if (peer->handshake_params->resumed)
+      peer->state = DTLS_STATE_WAIT_CHANGECIPHERSPEC; //abbreviated handshake
+    else if (is_tls_ecdhe_ecdsa_with_aes_128_ccm_8(peer->handshake_params->cipher))
       peer->state = DTLS_STATE_WAIT_SERVERCERTIFICATE; //ecdsa
     else if (is_tls_ecdh_anon_with_aes_128_cbc_sha_256(peer->handshake_params->cipher) ||
         is_tls_ecdhe_psk_with_aes_128_cbc_sha_256(peer->handshake_params->cipher))
@@ -3924,8 +4261,9 @@ handle_handshake_msg(dtls_context_t *ctx, dtls_peer_t *peer, session_t *session,
       dtls_warn("error in check_finished err: %i\n", err);
       return err;
     }
-    if (role == DTLS_SERVER) {
-      /* send ServerFinished */
+    /* In a full handshake the server sends its Finished last, in an
+     * abbreviated handshake the client does. */
+    if ((role == DTLS_SERVER) != peer->handshake_params->resumed) {
       update_hs_hash(peer, data, data_length);
 
       /* send change cipher spec message and switch to new configuration */
@@ -3937,12 +4275,21 @@ handle_handshake_msg(dtls_context_t *ctx, dtls_peer_t *peer, session_t *session,
 
       dtls_security_params_switch(peer);
 
-      err = dtls_send_finished(ctx, peer, PRF_LABEL(server), PRF_LABEL_SIZE(server));
+      if (role == DTLS_SERVER)
+        err = dtls_send_finished(ctx, peer, PRF_LABEL(server), PRF_LABEL_SIZE(server));
+      else
+        err = dtls_send_finished(ctx, peer, PRF_LABEL(client), PRF_LABEL_SIZE(client));
       if (err < 0) {
-        dtls_warn("sending server Finished failed\n");
+        dtls_warn("sending Finished failed\n");
         return err;
       }
     }
+    if (peer->handshake_params->resumed) {
+      ctx->session_stats.resumed_handshakes++;
+    } else {
+      ctx->session_stats.full_handshakes++;
+      dtls_session_cache_store(ctx, peer);
+    }
     dtls_handshake_free(peer->handshake_params);
     peer->handshake_params = NULL;
     dtls_debug("Handshake complete\n");
@@ -4089,6 +4436,23 @@ handle_handshake_msg(dtls_context_t *ctx, dtls_peer_t *peer, session_t *session,
     /* update finish MAC */
     update_hs_hash(peer, data, data_length);
 
+    err = dtls_resume_session(ctx, peer);
+    if (err < 0) {
+      return err;
+    }
+    if (err > 0) {
+      /* ServerHello, CCS and Finished have been sent, wait for the
+       * client's ChangeCipherSpec and Finished */
+      peer->state = DTLS_STATE_WAIT_CHANGECIPHERSPEC;
+      err = 0;
+      break;
+    }
+
+    err = dtls_new_session_id(ctx, peer->handshake_params);
+    if (err < 0) {
+      return err;
+    }
+
     err = dtls_send_server_hello_msgs(ctx, peer);
     if (err < 0) {
       return err;
@@ -4275,8 +4639,9 @@ handle_ccs(dtls_context_t *ctx, dtls_peer_t *peer,
   if (data_length < 1 || data[0] != 1)
     return dtls_alert_fatal_create(DTLS_ALERT_DECODE_ERROR);
 
-  /* Just change the cipher when we are on the same epoch */
-  if (peer->role == DTLS_SERVER) {
+  /* Just change the cipher when we are on the same epoch. In an
+   * abbreviated handshake the keys are already in place. */
+  if (peer->role == DTLS_SERVER && !handshake->resumed) {
     err = calculate_key_block(ctx, handshake, peer,
 			      &peer->session, peer->role);
     if (err < 0) {
@@ -4497,9 +4862,12 @@ dtls_handle_message(dtls_context_t *ctx,
 	/* The new security parameters must be used for all messages
 	 * that are sent after the ChangeCipherSpec message. This
 	 * means that the client's Finished message uses epoch + 1
-	 * while the server is still in the old epoch.
+	 * while the server is still in the old epoch. In an abbreviated
+	 * handshake, it is the other way round.
 	 */
-	if (role == DTLS_SERVER && state == DTLS_STATE_WAIT_FINISHED) {
+	if (state == DTLS_STATE_WAIT_FINISHED &&
+	    (role == DTLS_SERVER) !=
+	    (peer->handshake_params && peer->handshake_params->resumed)) {
 	  expected_epoch++;
 	}
 
@@ -4633,6 +5001,7 @@ dtls_free_context(dtls_context_t *ctx) {
     dtls_destroy_peer(ctx, p, 1);
 #endif /* WITH_CONTIKI */
 
+  dtls_set_session_cache(ctx, 0, 0);
   free_context(ctx);
 }
 
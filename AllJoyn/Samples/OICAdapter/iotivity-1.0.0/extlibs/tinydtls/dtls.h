@@ -324,6 +324,33 @@ typedef struct {
 
 } dtls_handler_t;
 
+/** Upper bound for the lifetime of cached sessions in seconds, see RFC 5246, F.1.4 */
+#define DTLS_SESSION_LIFETIME_MAX 86400
+
+/**
+ * A session that can be resumed with an abbreviated handshake. Servers
+ * find it by its id, clients by the address of the server.
+ */
+typedef struct {
+  session_t session;		/**< address of the server (client sessions only) */
+  dtls_peer_type role;		/**< our role in this session */
+  uint8 id[DTLS_SESSION_ID_LENGTH];
+  uint8 id_length;		/**< @c 0 for unused entries */
+  uint8 master_secret[DTLS_MASTER_SECRET_LENGTH];
+  dtls_cipher_t cipher;
+  dtls_compression_t compression;
+  dtls_handshake_parameters_psk_t psk; /**< identity and key the session was created with */
+  clock_time_t expires;		/**< the session cannot be resumed after this time */
+  clock_time_t last_used;	/**< for least recently used replacement */
+} dtls_cached_session_t;
+
+/** Handshake statistics of a DTLS context. */
+typedef struct {
+  unsigned long full_handshakes;    /**< completed full handshakes */
+  unsigned long resumed_handshakes; /**< completed abbreviated handshakes */
+  unsigned long evictions;	    /**< live sessions dropped for lack of space */
+} dtls_session_stats_t;
+
 /** Holds global information of the DTLS engine. */
 typedef struct dtls_context_t {
   unsigned char cookie_secret[DTLS_COOKIE_SECRET_LENGTH];
@@ -347,6 +374,11 @@ typedef struct dtls_context_t {
 
   dtls_cipher_t selected_cipher; /**< selected ciper suite for handshake */
 
+  dtls_cached_session_t *session_cache; /**< resumable sessions */
+  size_t session_cache_size;	/**< number of entries in session_cache */
+  clock_time_t session_lifetime; /**< lifetime of new cache entries in ticks */
+  dtls_session_stats_t session_stats;
+
   unsigned char readbuf[DTLS_MAX_BUF];
 } dtls_context_t;
 
@@ -390,6 +422,30 @@ void dtls_enables_anon_ecdh(dtls_context_t* ctx, dtls_cipher_enable_t is_enable)
  */
 void dtls_select_cipher(dtls_context_t* ctx, const dtls_cipher_t cipher);
 
+/**
+ * Enables session resumption (RFC 5246, section 7.3) for @p ctx. Up to
+ * @p capacity sessions are kept, the least recently used one is replaced
+ * when the cache is full. A session can be resumed for @p lifetime seconds
+ * after its full handshake. Only sessions authenticated with a pre-shared
+ * key are cached; resuming them asks get_psk_info() for the key again and
+ * falls back to a full handshake if it has changed. Sessions already
+ * cached are dropped, a @p capacity of @c 0 disables resumption.
+ *
+ * @param ctx       The DTLS context to use.
+ * @param capacity  The maximum number of cached sessions.
+ * @param lifetime  Session lifetime in seconds, at most
+ *                  DTLS_SESSION_LIFETIME_MAX.
+ * @return @c 0 on success, less than zero on error.
+ */
+int dtls_set_session_cache(dtls_context_t *ctx, size_t capacity,
+			   unsigned int lifetime);
+
+/** Returns the handshake statistics of @p ctx. */
+static inline const dtls_session_stats_t *
+dtls_get_session_stats(const dtls_context_t *ctx) {
+  return &ctx->session_stats;
+}
+
 /**
  * Establishes a DTLS channel with the specified remote peer @p dst.
  * This function returns @c 0 if that channel already exists, a value
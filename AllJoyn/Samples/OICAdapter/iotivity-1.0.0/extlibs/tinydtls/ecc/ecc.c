@@ -410,6 +410,11 @@ void uECC_set_rng(uECC_RNG_Function p_rng)
     g_rng = p_rng;
 }
 
+uECC_RNG_Function uECC_get_rng(void)
+{
+    return g_rng;
+}
+
 static uECC_make_key_Function g_make_key_cb = &uECC_make_key_impl;
 
 void uECC_set_make_key_cb(uECC_make_key_Function p_make_key_cb)
@@ -452,6 +457,16 @@ void uECC_set_get_pubkey_cb(uECC_get_pubkey_Function p_get_pubkey_cb)
 	g_get_pubkey_cb = p_get_pubkey_cb;
 }
 
+int uECC_has_custom_cb(void)
+{
+    return g_make_key_cb != &uECC_make_key_impl ||
+           g_shared_secret_cb != &uECC_shared_secret_impl ||
+           g_sign_cb != (uECC_sign_Function)&uECC_sign_impl ||
+           g_verify_cb != &uECC_verify_impl ||
+           g_ecdhe_cb != &uECC_ecdhe_impl ||
+           g_get_pubkey_cb != &uECC_get_pubkey_impl;
+}
+
 ///////////////////////////////////////////////////////
 
 
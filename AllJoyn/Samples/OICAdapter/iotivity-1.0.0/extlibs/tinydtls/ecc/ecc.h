@@ -84,6 +84,13 @@ Inputs:
 */
 void uECC_set_rng(uECC_RNG_Function p_rng);
 
+/* uECC_get_rng() function.
+
+Returns the function that is used to generate random bytes, so that alternative
+implementations installed through the uECC_set_*_cb() hooks can share it.
+*/
+uECC_RNG_Function uECC_get_rng(void);
+
 //////////////////////////////////////////
 // DTLS_CRYPTO_HAL
 /**
@@ -221,6 +228,28 @@ int uECC_ecdhe(const uint8_t p_public_key_in[uECC_BYTES*2],
 int uECC_get_pubkey(const uint8_t p_key_handle[uECC_BYTES],
                     uint8_t p_public_key[uECC_BYTES*2]);
 
+/**
+* Install the 64-bit secp256r1 implementation from ecc_p256_64.c as the make_key, sign,
+* verify and shared_secret callbacks. It is several times faster than the generic code on
+* 64-bit hosts and runs in constant time for private keys and nonces.
+*
+* Builds the precomputed base point tables (about 60 KB) on the first call, so call it once
+* during start-up, before any handshake. It replaces whatever callbacks are installed and is
+* not thread safe; callers serialize it.
+*
+* @return 1 if the callbacks were installed, 0 if the backend is not available for this
+*    curve or compiler (it needs secp256r1 and 128-bit integers).
+*/
+int uECC_use_p256_64(void);
+
+/**
+* Check whether any of the uECC_set_*_cb hooks holds something other than the built-in
+* implementation, e.g. the callbacks of a hardware crypto element.
+*
+* @return 1 if a callback was replaced, 0 otherwise.
+*/
+int uECC_has_custom_cb(void);
+
 //////////////////////////////////////////
 
 
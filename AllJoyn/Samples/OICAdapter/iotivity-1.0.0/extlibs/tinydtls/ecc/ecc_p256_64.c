@@ -0,0 +1,1043 @@
+/* Licensed under the BSD 2-clause license, like the rest of micro-ecc. */
+
+/* 64-bit secp256r1 backend for the uECC_set_*_cb hooks.
+
+The generic micro-ecc code works for every curve and word size, which makes it slow on
+the 64-bit gateways that terminate most of the DTLS handshakes. This file implements
+secp256r1 only, with 4 x 64-bit limbs:
+
+- field and scalar elements are kept in Montgomery form, multiplied with a word-by-word
+  Montgomery reduction (p = -1 mod 2^64, so the field reduction needs no extra multiply);
+- k * G (key generation, signing) uses 64 precomputed tables of j * 16^i * G, so it is 64
+  mixed additions and no doublings;
+- k * Q (ECDH) uses a fixed 4-bit window over a 16-entry table of multiples of Q;
+- inversions are exponentiations by a public exponent.
+
+Everything that touches a private key or a nonce runs in constant time: table entries are
+read with a full masked scan, the identity and the zero window are handled by masked
+selects and the number of operations never depends on secret data. Only uECC_verify(),
+which works on public data, takes data-dependent shortcuts.
+*/
+
+#include "ecc.h"
+
+#include <string.h>
+
+#if (uECC_CURVE == uECC_secp256r1) && defined(__SIZEOF_INT128__)
+
+typedef unsigned __int128 p256_dword_t;
+
+#define P256_WORDS 4
+#define P256_WINDOWS 64
+#define P256_TABLE_SIZE 16
+
+/* Limbs are little-endian. */
+typedef uint64_t p256_elem[P256_WORDS];
+
+typedef struct
+{
+    p256_elem x;
+    p256_elem y;
+    p256_elem z;
+} p256_jacobian;
+
+typedef struct
+{
+    p256_elem x;
+    p256_elem y;
+} p256_affine;
+
+static const p256_elem g_p =
+    { 0xFFFFFFFFFFFFFFFFull, 0x00000000FFFFFFFFull, 0x0000000000000000ull, 0xFFFFFFFF00000001ull };
+
+static const p256_elem g_n =
+    { 0xF3B9CAC2FC632551ull, 0xBCE6FAADA7179E84ull, 0xFFFFFFFFFFFFFFFFull, 0xFFFFFFFF00000000ull };
+
+/* -n^-1 mod 2^64 */
+static const uint64_t g_n_inv = 0xCCD1C8AAEE00BC4Full;
+
+/* R^2 mod p and R^2 mod n, with R = 2^256 */
+static const p256_elem g_p_rr =
+    { 0x0000000000000003ull, 0xFFFFFFFBFFFFFFFFull, 0xFFFFFFFFFFFFFFFEull, 0x00000004FFFFFFFDull };
+
+static const p256_elem g_n_rr =
+    { 0x83244C95BE79EEA2ull, 0x4699799C49BD6FA6ull, 0x2845B2392B6BEC59ull, 0x66E12D94F3D95620ull };
+
+/* 1, b and G in Montgomery form */
+static const p256_elem g_one =
+    { 0x0000000000000001ull, 0xFFFFFFFF00000000ull, 0xFFFFFFFFFFFFFFFFull, 0x00000000FFFFFFFEull };
+
+static const p256_elem g_b =
+    { 0xD89CDF6229C4BDDFull, 0xACF005CD78843090ull, 0xE5A220ABF7212ED6ull, 0xDC30061D04874834ull };
+
+static const p256_affine g_G =
+{
+    { 0x79E730D418A9143Cull, 0x75BA95FC5FEDB601ull, 0x79FB732B77622510ull, 0x18905F76A53755C6ull },
+    { 0xDDF25357CE95560Aull, 0x8B4AB8E4BA19E45Cull, 0xD2E88688DD21F325ull, 0x8571FF1825885D85ull }
+};
+
+/* g_base[i][j - 1] = j * 16^i * G, affine, Montgomery form. Filled in by uECC_use_p256_64(). */
+static p256_affine g_base[P256_WINDOWS][P256_TABLE_SIZE - 1];
+static int g_base_ready = 0;
+
+/* ---- constant-time helpers ---- */
+
+/* all ones if p_word is zero, zero otherwise */
+static uint64_t mask_is_zero(uint64_t p_word)
+{
+    return (uint64_t)0 - (uint64_t)(1 ^ ((p_word | ((uint64_t)0 - p_word)) >> 63));
+}
+
+static uint64_t mask_equal(uint64_t p_left, uint64_t p_right)
+{
+    return mask_is_zero(p_left ^ p_right);
+}
+
+static uint64_t elem_is_zero(const p256_elem p_a)
+{
+    return mask_is_zero(p_a[0] | p_a[1] | p_a[2] | p_a[3]);
+}
+
+/* p_result = p_mask ? p_a : p_result */
+static void elem_select(p256_elem p_result, const p256_elem p_a, uint64_t p_mask)
+{
+    int i;
+    for (i = 0; i < P256_WORDS; ++i)
+    {
+        p_result[i] ^= p_mask & (p_a[i] ^ p_result[i]);
+    }
+}
+
+/* p_result = p_a - p_b, returns the borrow */
+static uint64_t elem_sub(p256_elem p_result, const p256_elem p_a, const p256_elem p_b)
+{
+    uint64_t l_borrow = 0;
+    int i;
+    for (i = 0; i < P256_WORDS; ++i)
+    {
+        p256_dword_t l_diff = (p256_dword_t)p_a[i] - p_b[i] - l_borrow;
+        p_result[i] = (uint64_t)l_diff;
+        l_borrow = (uint64_t)(l_diff >> 64) & 1;
+    }
+    return l_borrow;
+}
+
+/* p_result = p_a + p_b, returns the carry */
+static uint64_t elem_add(p256_elem p_result, const p256_elem p_a, const p256_elem p_b)
+{
+    uint64_t l_carry = 0;
+    int i;
+    for (i = 0; i < P256_WORDS; ++i)
+    {
+        p256_dword_t l_sum = (p256_dword_t)p_a[i] + p_b[i] + l_carry;
+        p_result[i] = (uint64_t)l_sum;
+        l_carry = (uint64_t)(l_sum >> 64);
+    }
+    return l_carry;
+}
+
+/* reduces p_a + p_carry * 2^256, known to be below 2 * p_mod, into [0, p_mod) */
+static void elem_reduce_once(p256_elem p_a, uint64_t p_carry, const p256_elem p_mod)
+{
+    p256_elem l_tmp;
+    uint64_t l_borrow = elem_sub(l_tmp, p_a, p_mod);
+    /* keep p_a only if the subtraction borrowed and there was no carry to absorb it */
+    elem_select(p_a, l_tmp, ~((uint64_t)0 - (l_borrow & (p_carry ^ 1))));
+}
+
+static int elem_less_than(const p256_elem p_a, const p256_elem p_mod)
+{
+    p256_elem l_tmp;
+    return (int)elem_sub(l_tmp, p_a, p_mod);
+}
+
+static void elem_from_bytes(p256_elem p_result, const uint8_t p_bytes[uECC_BYTES])
+{
+    int i, j;
+    for (i = 0; i < P256_WORDS; ++i)
+    {
+        const uint8_t *l_digit = p_bytes + 8 * (P256_WORDS - 1 - i);
+        uint64_t l_word = 0;
+        for (j = 0; j < 8; ++j)
+        {
+            l_word = (l_word << 8) | l_digit[j];
+        }
+        p_result[i] = l_word;
+    }
+}
+
+static void elem_to_bytes(uint8_t p_bytes[uECC_BYTES], const p256_elem p_a)
+{
+    int i, j;
+    for (i = 0; i < P256_WORDS; ++i)
+    {
+        uint8_t *l_digit = p_bytes + 8 * (P256_WORDS - 1 - i);
+        for (j = 0; j < 8; ++j)
+        {
+            l_digit[j] = (uint8_t)(p_a[i] >> (56 - 8 * j));
+        }
+    }
+}
+
+/* ---- Montgomery arithmetic ---- */
+
+/* p_result = p_a * p_b / 2^256 mod p_mod, with p_inv = -p_mod^-1 mod 2^64 */
+static void mont_mul(p256_elem p_result, const p256_elem p_a, const p256_elem p_b,
+                     const p256_elem p_mod, uint64_t p_inv)
+{
+    uint64_t t[P256_WORDS + 2] = { 0 };
+    int i, j;
+
+    for (i = 0; i < P256_WORDS; ++i)
+    {
+        p256_dword_t l_acc;
+        uint64_t l_carry = 0;
+        uint64_t m;
+
+        for (j = 0; j < P256_WORDS; ++j)
+        {
+            l_acc = (p256_dword_t)p_a[j] * p_b[i] + t[j] + l_carry;
+            t[j] = (uint64_t)l_acc;
+            l_carry = (uint64_t)(l_acc >> 64);
+        }
+        l_acc = (p256_dword_t)t[P256_WORDS] + l_carry;
+        t[P256_WORDS] = (uint64_t)l_acc;
+        t[P256_WORDS + 1] = (uint64_t)(l_acc >> 64);
+
+        m = t[0] * p_inv;
+        l_acc = (p256_dword_t)m * p_mod[0] + t[0];
+        l_carry = (uint64_t)(l_acc >> 64);
+        for (j = 1; j < P256_WORDS; ++j)
+        {
+            l_acc = (p256_dword_t)m * p_mod[j] + t[j] + l_carry;
+            t[j - 1] = (uint64_t)l_acc;
+            l_carry = (uint64_t)(l_acc >> 64);
+        }
+        l_acc = (p256_dword_t)t[P256_WORDS] + l_carry;
+        t[P256_WORDS - 1] = (uint64_t)l_acc;
+        t[P256_WORDS] = t[P256_WORDS + 1] + (uint64_t)(l_acc >> 64);
+    }
+
+    memcpy(p_result, t, sizeof(p256_elem));
+    elem_reduce_once(p_result, t[P256_WORDS], p_mod);
+}
+
+/* Field arithmetic modulo p. -p^-1 mod 2^64 is 1, so each reduction step adds t[i] * p at
+   word i, which clears that word; the multiples of p's limbs are shifts apart from the top one. */
+
+#define FE_MUL_ROW(i) \
+    l_acc = (p256_dword_t)p_a[0] * p_b[i] + t[i]; \
+    t[i] = (uint64_t)l_acc; \
+    l_acc = (l_acc >> 64) + (p256_dword_t)p_a[1] * p_b[i] + t[i + 1]; \
+    t[i + 1] = (uint64_t)l_acc; \
+    l_acc = (l_acc >> 64) + (p256_dword_t)p_a[2] * p_b[i] + t[i + 2]; \
+    t[i + 2] = (uint64_t)l_acc; \
+    l_acc = (l_acc >> 64) + (p256_dword_t)p_a[3] * p_b[i] + t[i + 3]; \
+    t[i + 3] = (uint64_t)l_acc; \
+    t[i + 4] = (uint64_t)(l_acc >> 64)
+
+#define FE_REDUCE_ROUND(i) \
+    l_acc = (p256_dword_t)t[i + 1] + (t[i] << 32); \
+    t[i + 1] = (uint64_t)l_acc; \
+    l_acc = (l_acc >> 64) + (t[i] >> 32) + t[i + 2]; \
+    t[i + 2] = (uint64_t)l_acc; \
+    l_acc = (l_acc >> 64) + (p256_dword_t)t[i] * 0xFFFFFFFF00000001ull + t[i + 3]; \
+    t[i + 3] = (uint64_t)l_acc; \
+    l_acc = (l_acc >> 64) + t[i + 4] + l_carry; \
+    t[i + 4] = (uint64_t)l_acc; \
+    l_carry = (uint64_t)(l_acc >> 64)
+
+static void fe_mul(p256_elem p_result, const p256_elem p_a, const p256_elem p_b)
+{
+    uint64_t t[2 * P256_WORDS] = { 0 };
+    p256_dword_t l_acc;
+    uint64_t l_carry = 0;
+
+    FE_MUL_ROW(0);
+    FE_MUL_ROW(1);
+    FE_MUL_ROW(2);
+    FE_MUL_ROW(3);
+
+    FE_REDUCE_ROUND(0);
+    FE_REDUCE_ROUND(1);
+    FE_REDUCE_ROUND(2);
+    FE_REDUCE_ROUND(3);
+
+    memcpy(p_result, t + P256_WORDS, sizeof(p256_elem));
+    elem_reduce_once(p_result, l_carry, g_p);
+}
+
+/* Same as fe_mul(p_a, p_a), computing each cross product once. */
+static void fe_sqr(p256_elem p_result, const p256_elem p_a)
+{
+    uint64_t t[2 * P256_WORDS];
+    p256_dword_t l_acc;
+    uint64_t l_carry = 0;
+
+    /* a[i] * a[j] for i < j */
+    l_acc = (p256_dword_t)p_a[0] * p_a[1];
+    t[1] = (uint64_t)l_acc;
+    l_acc = (l_acc >> 64) + (p256_dword_t)p_a[0] * p_a[2];
+    t[2] = (uint64_t)l_acc;
+    l_acc = (l_acc >> 64) + (p256_dword_t)p_a[0] * p_a[3];
+    t[3] = (uint64_t)l_acc;
+    t[4] = (uint64_t)(l_acc >> 64);
+    l_acc = (p256_dword_t)p_a[1] * p_a[2] + t[3];
+    t[3] = (uint64_t)l_acc;
+    l_acc = (l_acc >> 64) + (p256_dword_t)p_a[1] * p_a[3] + t[4];
+    t[4] = (uint64_t)l_acc;
+    t[5] = (uint64_t)(l_acc >> 64);
+    l_acc = (p256_dword_t)p_a[2] * p_a[3] + t[5];
+    t[5] = (uint64_t)l_acc;
+    t[6] = (uint64_t)(l_acc >> 64);
+
+    /* doubled */
+    t[7] = t[6] >> 63;
+    t[6] = (t[6] << 1) | (t[5] >> 63);
+    t[5] = (t[5] << 1) | (t[4] >> 63);
+    t[4] = (t[4] << 1) | (t[3] >> 63);
+    t[3] = (t[3] << 1) | (t[2] >> 63);
+    t[2] = (t[2] << 1) | (t[1] >> 63);
+    t[1] <<= 1;
+
+    /* plus a[i]^2 */
+    l_acc = (p256_dword_t)p_a[0] * p_a[0];
+    t[0] = (uint64_t)l_acc;
+    l_acc = (l_acc >> 64) + t[1];
+    t[1] = (uint64_t)l_acc;
+    l_acc = (l_acc >> 64) + (p256_dword_t)p_a[1] * p_a[1] + t[2];
+    t[2] = (uint64_t)l_acc;
+    l_acc = (l_acc >> 64) + t[3];
+    t[3] = (uint64_t)l_acc;
+    l_acc = (l_acc >> 64) + (p256_dword_t)p_a[2] * p_a[2] + t[4];
+    t[4] = (uint64_t)l_acc;
+    l_acc = (l_acc >> 64) + t[5];
+    t[5] = (uint64_t)l_acc;
+    l_acc = (l_acc >> 64) + (p256_dword_t)p_a[3] * p_a[3] + t[6];
+    t[6] = (uint64_t)l_acc;
+    t[7] += (uint64_t)(l_acc >> 64);
+
+    FE_REDUCE_ROUND(0);
+    FE_REDUCE_ROUND(1);
+    FE_REDUCE_ROUND(2);
+    FE_REDUCE_ROUND(3);
+
+    memcpy(p_result, t + P256_WORDS, sizeof(p256_elem));
+    elem_reduce_once(p_result, l_carry, g_p);
+}
+
+static void fe_sqr_n(p256_elem p_result, const p256_elem p_a, int p_count)
+{
+    fe_sqr(p_result, p_a);
+    while (--p_count > 0)
+    {
+        fe_sqr(p_result, p_result);
+    }
+}
+
+static void fe_add(p256_elem p_result, const p256_elem p_a, const p256_elem p_b)
+{
+    uint64_t l_carry = elem_add(p_result, p_a, p_b);
+    elem_reduce_once(p_result, l_carry, g_p);
+}
+
+static void fe_sub(p256_elem p_result, const p256_elem p_a, const p256_elem p_b)
+{
+    p256_elem l_fix;
+    uint64_t l_mask = (uint64_t)0 - elem_sub(p_result, p_a, p_b);
+    int i;
+    for (i = 0; i < P256_WORDS; ++i)
+    {
+        l_fix[i] = g_p[i] & l_mask;
+    }
+    elem_add(p_result, p_result, l_fix);
+}
+
+static void fe_to_mont(p256_elem p_result, const p256_elem p_a)
+{
+    fe_mul(p_result, p_a, g_p_rr);
+}
+
+static void fe_from_mont(p256_elem p_result, const p256_elem p_a)
+{
+    static const p256_elem l_one = { 1, 0, 0, 0 };
+    fe_mul(p_result, p_a, l_one);
+}
+
+/* p_result = p_a^(p - 2). p - 2 is 32 ones, 31 zeros, a one, 96 zeros, 94 ones, a zero and a one. */
+static void fe_inv(p256_elem p_result, const p256_elem p_a)
+{
+    p256_elem x2, x4, x8, x16, x32, r;
+
+    fe_sqr(x2, p_a);
+    fe_mul(x2, x2, p_a);
+    fe_sqr_n(x4, x2, 2);
+    fe_mul(x4, x4, x2);
+    fe_sqr_n(x8, x4, 4);
+    fe_mul(x8, x8, x4);
+    fe_sqr_n(x16, x8, 8);
+    fe_mul(x16, x16, x8);
+    fe_sqr_n(x32, x16, 16);
+    fe_mul(x32, x32, x16);
+
+    fe_sqr_n(r, x32, 32);
+    fe_mul(r, r, p_a);
+    fe_sqr_n(r, r, 96);
+    fe_sqr_n(r, r, 32);
+    fe_mul(r, r, x32);
+    fe_sqr_n(r, r, 32);
+    fe_mul(r, r, x32);
+    fe_sqr_n(r, r, 16);
+    fe_mul(r, r, x16);
+    fe_sqr_n(r, r, 8);
+    fe_mul(r, r, x8);
+    fe_sqr_n(r, r, 4);
+    fe_mul(r, r, x4);
+    fe_sqr_n(r, r, 2);
+    fe_mul(r, r, x2);
+    fe_sqr_n(r, r, 2);
+    fe_mul(p_result, r, p_a);
+}
+
+/* Scalar arithmetic modulo n. */
+
+static void sc_mul(p256_elem p_result, const p256_elem p_a, const p256_elem p_b)
+{
+    mont_mul(p_result, p_a, p_b, g_n, g_n_inv);
+}
+
+/* p_result = p_a mod n, for any p_a below 2^256 */
+static void sc_reduce(p256_elem p_result, const p256_elem p_a)
+{
+    memcpy(p_result, p_a, sizeof(p256_elem));
+    elem_reduce_once(p_result, 0, g_n);
+}
+
+static void sc_add(p256_elem p_result, const p256_elem p_a, const p256_elem p_b)
+{
+    uint64_t l_carry = elem_add(p_result, p_a, p_b);
+    elem_reduce_once(p_result, l_carry, g_n);
+}
+
+/* p_result = p_a^-1 mod n, both in plain (non-Montgomery) form. The exponent n - 2 is public,
+   so the 4-bit window over it does not depend on p_a. */
+static void sc_inv(p256_elem p_result, const p256_elem p_a)
+{
+    static const p256_elem l_one = { 1, 0, 0, 0 };
+    p256_elem l_table[P256_TABLE_SIZE];
+    p256_elem l_exp, r;
+    int i;
+
+    sc_mul(l_table[1], p_a, g_n_rr);
+    sc_mul(l_table[0], l_one, g_n_rr);
+    for (i = 2; i < P256_TABLE_SIZE; ++i)
+    {
+        sc_mul(l_table[i], l_table[i - 1], l_table[1]);
+    }
+
+    elem_sub(l_exp, g_n, l_one);
+    elem_sub(l_exp, l_exp, l_one);
+
+    memcpy(r, l_table[0], sizeof(p256_elem));
+    for (i = P256_WINDOWS - 1; i >= 0; --i)
+    {
+        unsigned l_digit = (unsigned)(l_exp[i / 16] >> (4 * (i % 16))) & 0x0F;
+        sc_mul(r, r, r);
+        sc_mul(r, r, r);
+        sc_mul(r, r, r);
+        sc_mul(r, r, r);
+        sc_mul(r, r, l_table[l_digit]);
+    }
+
+    sc_mul(p_result, r, l_one);
+}
+
+/* ---- point arithmetic, Jacobian coordinates, a = -3 ---- */
+
+/* dbl-2001-b. Doubling the identity (z = 0) gives the identity. */
+static void point_double(p256_jacobian *p_result, const p256_jacobian *p_point)
+{
+    p256_elem delta, gamma, beta, alpha, t0, t1;
+
+    fe_sqr(delta, p_point->z);
+    fe_sqr(gamma, p_point->y);
+    fe_mul(beta, p_point->x, gamma);
+
+    fe_sub(t0, p_point->x, delta);
+    fe_add(t1, p_point->x, delta);
+    fe_mul(alpha, t0, t1);
+    fe_add(t0, alpha, alpha);
+    fe_add(alpha, t0, alpha);
+
+    fe_add(t0, p_point->y, p_point->z);
+    fe_sqr(t0, t0);
+    fe_sub(t0, t0, gamma);
+    fe_sub(p_result->z, t0, delta);
+
+    fe_add(beta, beta, beta);
+    fe_add(beta, beta, beta);
+    fe_sqr(t0, alpha);
+    fe_add(t1, beta, beta);
+    fe_sub(p_result->x, t0, t1);
+
+    fe_sub(t0, beta, p_result->x);
+    fe_mul(t0, alpha, t0);
+    fe_sqr(t1, gamma);
+    fe_add(t1, t1, t1);
+    fe_add(t1, t1, t1);
+    fe_add(t1, t1, t1);
+    fe_sub(p_result->y, t0, t1);
+}
+
+/* add-2007-bl. The caller guarantees that neither input is the identity and that the
+   inputs are neither equal nor opposite. */
+static void point_add(p256_jacobian *p_result, const p256_jacobian *p_left, const p256_jacobian *p_right)
+{
+    p256_elem z1z1, z2z2, u1, u2, s1, s2, h, i, j, r, v, t0;
+
+    fe_sqr(z1z1, p_left->z);
+    fe_sqr(z2z2, p_right->z);
+    fe_mul(u1, p_left->x, z2z2);
+    fe_mul(u2, p_right->x, z1z1);
+    fe_mul(s1, p_left->y, p_right->z);
+    fe_mul(s1, s1, z2z2);
+    fe_mul(s2, p_right->y, p_left->z);
+    fe_mul(s2, s2, z1z1);
+
+    fe_sub(h, u2, u1);
+    fe_add(i, h, h);
+    fe_sqr(i, i);
+    fe_mul(j, h, i);
+    fe_sub(r, s2, s1);
+    fe_add(r, r, r);
+    fe_mul(v, u1, i);
+
+    fe_add(t0, p_left->z, p_right->z);
+    fe_sqr(t0, t0);
+    fe_sub(t0, t0, z1z1);
+    fe_sub(t0, t0, z2z2);
+    fe_mul(p_result->z, t0, h);
+
+    fe_sqr(t0, r);
+    fe_sub(t0, t0, j);
+    fe_sub(t0, t0, v);
+    fe_sub(p_result->x, t0, v);
+
+    fe_sub(t0, v, p_result->x);
+    fe_mul(t0, r, t0);
+    fe_mul(s1, s1, j);
+    fe_add(s1, s1, s1);
+    fe_sub(p_result->y, t0, s1);
+}
+
+/* madd-2007-bl, p_right has z = 1. Same restrictions as point_add(). */
+static void point_add_affine(p256_jacobian *p_result, const p256_jacobian *p_left, const p256_affine *p_right)
+{
+    p256_elem z1z1, u2, s2, h, hh, i, j, r, v, t0;
+
+    fe_sqr(z1z1, p_left->z);
+    fe_mul(u2, p_right->x, z1z1);
+    fe_mul(s2, p_right->y, p_left->z);
+    fe_mul(s2, s2, z1z1);
+
+    fe_sub(h, u2, p_left->x);
+    fe_sqr(hh, h);
+    fe_add(i, hh, hh);
+    fe_add(i, i, i);
+    fe_mul(j, h, i);
+    fe_sub(r, s2, p_left->y);
+    fe_add(r, r, r);
+    fe_mul(v, p_left->x, i);
+
+    fe_add(t0, p_left->z, h);
+    fe_sqr(t0, t0);
+    fe_sub(t0, t0, z1z1);
+    fe_sub(p_result->z, t0, hh);
+
+    fe_sqr(t0, r);
+    fe_sub(t0, t0, j);
+    fe_sub(t0, t0, v);
+    fe_sub(p_result->x, t0, v);
+
+    fe_sub(t0, v, p_result->x);
+    fe_mul(t0, r, t0);
+    fe_mul(j, p_left->y, j);
+    fe_add(j, j, j);
+    fe_sub(p_result->y, t0, j);
+}
+
+static void point_select(p256_jacobian *p_result, const p256_jacobian *p_point, uint64_t p_mask)
+{
+    elem_select(p_result->x, p_point->x, p_mask);
+    elem_select(p_result->y, p_point->y, p_mask);
+    elem_select(p_result->z, p_point->z, p_mask);
+}
+
+static void point_from_affine(p256_jacobian *p_result, const p256_affine *p_point)
+{
+    memcpy(p_result->x, p_point->x, sizeof(p256_elem));
+    memcpy(p_result->y, p_point->y, sizeof(p256_elem));
+    memcpy(p_result->z, g_one, sizeof(p256_elem));
+}
+
+/* Converts to affine coordinates out of Montgomery form. Returns 0 for the identity. */
+static int point_to_affine(p256_elem p_x, p256_elem p_y, const p256_jacobian *p_point)
+{
+    p256_elem l_zinv, l_zinv2;
+
+    fe_inv(l_zinv, p_point->z);
+    fe_sqr(l_zinv2, l_zinv);
+    fe_mul(p_x, p_point->x, l_zinv2);
+    fe_mul(l_zinv2, l_zinv2, l_zinv);
+    fe_mul(p_y, p_point->y, l_zinv2);
+    fe_from_mont(p_x, p_x);
+    fe_from_mont(p_y, p_y);
+
+    return !elem_is_zero(p_point->z);
+}
+
+/* Reads a public key into Montgomery form and checks that it is a point on the curve. */
+static int point_from_bytes(p256_affine *p_result, const uint8_t p_publicKey[uECC_BYTES*2])
+{
+    p256_elem x, y, l_lhs, l_rhs, t0;
+
+    elem_from_bytes(x, p_publicKey);
+    elem_from_bytes(y, p_publicKey + uECC_BYTES);
+    if (!elem_less_than(x, g_p) || !elem_less_than(y, g_p))
+    {
+        return 0;
+    }
+    fe_to_mont(p_result->x, x);
+    fe_to_mont(p_result->y, y);
+
+    /* y^2 = x^3 - 3x + b */
+    fe_sqr(l_lhs, p_result->y);
+    fe_sqr(l_rhs, p_result->x);
+    fe_mul(l_rhs, l_rhs, p_result->x);
+    fe_add(t0, p_result->x, p_result->x);
+    fe_add(t0, t0, p_result->x);
+    fe_sub(l_rhs, l_rhs, t0);
+    fe_add(l_rhs, l_rhs, g_b);
+    fe_sub(t0, l_lhs, l_rhs);
+    return (int)(elem_is_zero(t0) & 1);
+}
+
+/* ---- scalar multiplication ---- */
+
+static unsigned scalar_window(const p256_elem p_scalar, int p_window)
+{
+    return (unsigned)(p_scalar[p_window / 16] >> (4 * (p_window % 16))) & 0x0F;
+}
+
+/* p_result = p_scalar * G. Sums one table entry per window; p_scalar must be below n, so the
+   running sum can never equal or cancel the entry added to it. */
+static void mult_base(p256_jacobian *p_result, const p256_elem p_scalar)
+{
+    p256_jacobian l_sum;
+    uint64_t l_empty = ~(uint64_t)0;
+    int i;
+    unsigned j;
+
+    memset(p_result, 0, sizeof(*p_result));
+    for (i = 0; i < P256_WINDOWS; ++i)
+    {
+        uint64_t l_digit = scalar_window(p_scalar, i);
+        uint64_t l_zero = mask_is_zero(l_digit);
+        p256_affine l_entry;
+        p256_jacobian l_point;
+
+        memset(&l_entry, 0, sizeof(l_entry));
+        for (j = 1; j < P256_TABLE_SIZE; ++j)
+        {
+            uint64_t l_mask = mask_equal(l_digit, j);
+            elem_select(l_entry.x, g_base[i][j - 1].x, l_mask);
+            elem_select(l_entry.y, g_base[i][j - 1].y, l_mask);
+        }
+
+        point_add_affine(&l_sum, p_result, &l_entry);
+        point_from_affine(&l_point, &l_entry);
+        /* nothing accumulated yet: take the entry as is; zero window: keep the old sum */
+        point_select(&l_sum, &l_point, l_empty);
+        point_select(p_result, &l_sum, ~l_zero);
+        l_empty &= l_zero;
+    }
+}
+
+/* p_result = p_scalar * p_point. p_scalar must be below n; p_point must be on the curve, and so has
+   order n. The partial sums are multiples of 16 below n, so they never meet a table entry 1..15. */
+static void mult_point(p256_jacobian *p_result, const p256_affine *p_point, const p256_elem p_scalar)
+{
+    p256_jacobian l_table[P256_TABLE_SIZE];
+    p256_jacobian l_sum;
+    uint64_t l_empty = ~(uint64_t)0;
+    int i;
+    unsigned j;
+
+    memset(&l_table[0], 0, sizeof(l_table[0]));
+    point_from_affine(&l_table[1], p_point);
+    point_double(&l_table[2], &l_table[1]);
+    for (j = 3; j < P256_TABLE_SIZE; ++j)
+    {
+        point_add(&l_table[j], &l_table[j - 1], &l_table[1]);
+    }
+
+    memset(p_result, 0, sizeof(*p_result));
+    for (i = P256_WINDOWS - 1; i >= 0; --i)
+    {
+        uint64_t l_digit = scalar_window(p_scalar, i);
+        uint64_t l_zero = mask_is_zero(l_digit);
+        p256_jacobian l_entry;
+
+        point_double(p_result, p_result);
+        point_double(p_result, p_result);
+        point_double(p_result, p_result);
+        point_double(p_result, p_result);
+
+        memset(&l_entry, 0, sizeof(l_entry));
+        for (j = 1; j < P256_TABLE_SIZE; ++j)
+        {
+            point_select(&l_entry, &l_table[j], mask_equal(l_digit, j));
+        }
+
+        point_add(&l_sum, p_result, &l_entry);
+        point_select(&l_sum, &l_entry, l_empty);
+        point_select(p_result, &l_sum, ~l_zero);
+        l_empty &= l_zero;
+    }
+}
+
+/* Sum of two points for uECC_verify(). Handles every case, in variable time. */
+static void point_add_vartime(p256_jacobian *p_result, const p256_jacobian *p_left, const p256_jacobian *p_right)
+{
+    p256_elem z1z1, z2z2, u1, u2, s1, s2;
+
+    if (elem_is_zero(p_left->z))
+    {
+        *p_result = *p_right;
+        return;
+    }
+    if (elem_is_zero(p_right->z))
+    {
+        *p_result = *p_left;
+        return;
+    }
+
+    fe_sqr(z1z1, p_left->z);
+    fe_sqr(z2z2, p_right->z);
+    fe_mul(u1, p_left->x, z2z2);
+    fe_mul(u2, p_right->x, z1z1);
+    fe_mul(s1, p_left->y, p_right->z);
+    fe_mul(s1, s1, z2z2);
+    fe_mul(s2, p_right->y, p_left->z);
+    fe_mul(s2, s2, z1z1);
+
+    if (memcmp(u1, u2, sizeof(p256_elem)) == 0)
+    {
+        if (memcmp(s1, s2, sizeof(p256_elem)) == 0)
+        {
+            point_double(p_result, p_left);
+        }
+        else
+        {
+            memset(p_result, 0, sizeof(*p_result));
+        }
+        return;
+    }
+    point_add(p_result, p_left, p_right);
+}
+
+/* p_result = p_scalar * p_point for public scalars, using a width-5 NAF over the odd multiples
+   of p_point. */
+static void mult_point_vartime(p256_jacobian *p_result, const p256_affine *p_point, const p256_elem p_scalar)
+{
+    p256_jacobian l_table[8];
+    p256_jacobian l_double, l_entry;
+    signed char l_naf[257];
+    p256_elem k;
+    int l_length = 0;
+    int i;
+
+    point_from_affine(&l_table[0], p_point);
+    point_double(&l_double, &l_table[0]);
+    for (i = 1; i < 8; ++i)
+    {
+        point_add_vartime(&l_table[i], &l_table[i - 1], &l_double);
+    }
+
+    memcpy(k, p_scalar, sizeof(p256_elem));
+    memset(l_naf, 0, sizeof(l_naf));
+    while (!elem_is_zero(k))
+    {
+        if (k[0] & 1)
+        {
+            int l_digit = (int)(k[0] & 0x1F);
+            p256_elem l_digit_elem = { 0, 0, 0, 0 };
+            if (l_digit > 16)
+            {
+                l_digit -= 32;
+                l_digit_elem[0] = (uint64_t)(-l_digit);
+                elem_add(k, k, l_digit_elem);
+            }
+            else
+            {
+                l_digit_elem[0] = (uint64_t)l_digit;
+                elem_sub(k, k, l_digit_elem);
+            }
+            l_naf[l_length] = (signed char)l_digit;
+        }
+        /* k stays below 2^256 + 16, so the carry out of elem_add() is never set */
+        k[0] = (k[0] >> 1) | (k[1] << 63);
+        k[1] = (k[1] >> 1) | (k[2] << 63);
+        k[2] = (k[2] >> 1) | (k[3] << 63);
+        k[3] >>= 1;
+        ++l_length;
+    }
+
+    memset(p_result, 0, sizeof(*p_result));
+    for (i = l_length - 1; i >= 0; --i)
+    {
+        point_double(p_result, p_result);
+        if (l_naf[i] > 0)
+        {
+            point_add_vartime(p_result, p_result, &l_table[l_naf[i] / 2]);
+        }
+        else if (l_naf[i] < 0)
+        {
+            l_entry = l_table[-l_naf[i] / 2];
+            fe_sub(l_entry.y, g_p, l_entry.y);
+            elem_reduce_once(l_entry.y, 0, g_p);
+            point_add_vartime(p_result, p_result, &l_entry);
+        }
+    }
+}
+
+/* ---- table setup ---- */
+
+static void build_base_table(void)
+{
+    p256_jacobian l_row[P256_TABLE_SIZE - 1];
+    p256_jacobian l_base;
+    p256_elem l_prefix[P256_TABLE_SIZE - 1];
+    p256_elem l_inv, l_zinv, l_zinv2;
+    int i, j;
+
+    point_from_affine(&l_base, &g_G);
+    for (i = 0; i < P256_WINDOWS; ++i)
+    {
+        /* l_row[j] = (j + 1) * 16^i * G */
+        l_row[0] = l_base;
+        point_double(&l_row[1], &l_base);
+        for (j = 2; j < P256_TABLE_SIZE - 1; ++j)
+        {
+            point_add(&l_row[j], &l_row[j - 1], &l_base);
+        }
+        point_double(&l_base, &l_row[7]);
+
+        /* one inversion for the whole row */
+        memcpy(l_prefix[0], l_row[0].z, sizeof(p256_elem));
+        for (j = 1; j < P256_TABLE_SIZE - 1; ++j)
+        {
+            fe_mul(l_prefix[j], l_prefix[j - 1], l_row[j].z);
+        }
+        fe_inv(l_inv, l_prefix[P256_TABLE_SIZE - 2]);
+        for (j = P256_TABLE_SIZE - 2; j >= 0; --j)
+        {
+            if (j > 0)
+            {
+                fe_mul(l_zinv, l_inv, l_prefix[j - 1]);
+                fe_mul(l_inv, l_inv, l_row[j].z);
+            }
+            else
+            {
+                memcpy(l_zinv, l_inv, sizeof(p256_elem));
+            }
+            fe_sqr(l_zinv2, l_zinv);
+            fe_mul(g_base[i][j].x, l_row[j].x, l_zinv2);
+            fe_mul(l_zinv2, l_zinv2, l_zinv);
+            fe_mul(g_base[i][j].y, l_row[j].y, l_zinv2);
+        }
+    }
+}
+
+/* ---- uECC hooks ---- */
+
+/* Draws a scalar in [1, n - 1]. */
+static int random_scalar(p256_elem p_result)
+{
+    uECC_RNG_Function l_rng = uECC_get_rng();
+    uint8_t l_bytes[uECC_BYTES];
+    int l_tries;
+
+    for (l_tries = 0; l_tries < 16; ++l_tries)
+    {
+        if (!l_rng(l_bytes, sizeof(l_bytes)))
+        {
+            return 0;
+        }
+        elem_from_bytes(p_result, l_bytes);
+        if (!elem_is_zero(p_result) && elem_less_than(p_result, g_n))
+        {
+            memset(l_bytes, 0, sizeof(l_bytes));
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int p256_make_key(uint8_t p_publicKey[uECC_BYTES*2], uint8_t p_privateKey[uECC_BYTES])
+{
+    p256_elem d, x, y;
+    p256_jacobian l_public;
+
+    if (!random_scalar(d))
+    {
+        return 0;
+    }
+    mult_base(&l_public, d);
+    point_to_affine(x, y, &l_public);
+
+    elem_to_bytes(p_privateKey, d);
+    elem_to_bytes(p_publicKey, x);
+    elem_to_bytes(p_publicKey + uECC_BYTES, y);
+    memset(d, 0, sizeof(d));
+    return 1;
+}
+
+static int p256_shared_secret(const uint8_t p_publicKey[uECC_BYTES*2], const uint8_t p_privateKey[uECC_BYTES],
+                              uint8_t p_secret[uECC_BYTES])
+{
+    p256_affine l_public;
+    p256_jacobian l_product;
+    p256_elem d, x, y;
+    int l_valid;
+
+    if (!point_from_bytes(&l_public, p_publicKey))
+    {
+        return 0;
+    }
+
+    elem_from_bytes(d, p_privateKey);
+    sc_reduce(d, d);
+    mult_point(&l_product, &l_public, d);
+    l_valid = point_to_affine(x, y, &l_product);
+
+    elem_to_bytes(p_secret, x);
+    memset(d, 0, sizeof(d));
+    return l_valid;
+}
+
+static int p256_sign(uint8_t p_privateKey[uECC_BYTES], const uint8_t p_hash[uECC_BYTES],
+                     uint8_t p_signature[uECC_BYTES*2])
+{
+    p256_elem k, d, e, r, s, x, y;
+    p256_jacobian l_point;
+    int l_tries;
+
+    elem_from_bytes(d, p_privateKey);
+    sc_reduce(d, d);
+    elem_from_bytes(e, p_hash);
+    sc_reduce(e, e);
+
+    for (l_tries = 0; l_tries < 16; ++l_tries)
+    {
+        if (!random_scalar(k))
+        {
+            break;
+        }
+
+        /* r = (k * G).x mod n */
+        mult_base(&l_point, k);
+        point_to_affine(x, y, &l_point);
+        sc_reduce(r, x);
+        if (elem_is_zero(r))
+        {
+            continue;
+        }
+
+        /* s = (e + r * d) / k. sc_mul() of a Montgomery-form factor gives the plain product. */
+        sc_mul(s, r, g_n_rr);
+        sc_mul(s, s, d);
+        sc_add(s, s, e);
+        sc_inv(k, k);
+        sc_mul(k, k, g_n_rr);
+        sc_mul(s, s, k);
+        if (elem_is_zero(s))
+        {
+            continue;
+        }
+
+        elem_to_bytes(p_signature, r);
+        elem_to_bytes(p_signature + uECC_BYTES, s);
+        memset(k, 0, sizeof(k));
+        memset(d, 0, sizeof(d));
+        return 1;
+    }
+
+    memset(k, 0, sizeof(k));
+    memset(d, 0, sizeof(d));
+    return 0;
+}
+
+static int p256_verify(const uint8_t p_publicKey[uECC_BYTES*2], const uint8_t p_hash[uECC_BYTES],
+                       const uint8_t p_signature[uECC_BYTES*2])
+{
+    p256_affine l_public;
+    p256_jacobian l_u1G, l_u2Q, l_sum;
+    p256_elem r, s, e, w, u1, u2, x, y;
+
+    elem_from_bytes(r, p_signature);
+    elem_from_bytes(s, p_signature + uECC_BYTES);
+    if (elem_is_zero(r) || elem_is_zero(s) || !elem_less_than(r, g_n) || !elem_less_than(s, g_n))
+    {
+        return 0;
+    }
+    if (!point_from_bytes(&l_public, p_publicKey))
+    {
+        return 0;
+    }
+
+    elem_from_bytes(e, p_hash);
+    sc_reduce(e, e);
+
+    /* u1 = e / s, u2 = r / s */
+    sc_inv(w, s);
+    sc_mul(w, w, g_n_rr);
+    sc_mul(u1, e, w);
+    sc_mul(u2, r, w);
+
+    mult_base(&l_u1G, u1);
+    mult_point_vartime(&l_u2Q, &l_public, u2);
+    point_add_vartime(&l_sum, &l_u1G, &l_u2Q);
+    if (!point_to_affine(x, y, &l_sum))
+    {
+        return 0;
+    }
+
+    /* v = x mod n, accept only if v == r */
+    sc_reduce(x, x);
+    return memcmp(x, r, sizeof(p256_elem)) == 0;
+}
+
+int uECC_use_p256_64(void)
+{
+    if (!g_base_ready)
+    {
+        build_base_table();
+        g_base_ready = 1;
+    }
+
+    uECC_set_make_key_cb(&p256_make_key);
+    uECC_set_shared_secret_cb(&p256_shared_secret);
+    uECC_set_sign_cb(&p256_sign);
+    uECC_set_verify_cb(&p256_verify);
+    return 1;
+}
+
+#else /* (uECC_CURVE == uECC_secp256r1) && defined(__SIZEOF_INT128__) */
+
+int uECC_use_p256_64(void)
+{
+    return 0;
+}
+
+#endif /* (uECC_CURVE == uECC_secp256r1) && defined(__SIZEOF_INT128__) */
@@ -0,0 +1,170 @@
+/* Licensed under the BSD 2-clause license, like the rest of micro-ecc. */
+
+/* Cross-checks the 64-bit secp256r1 backend against the generic implementation, then
+   measures server-side ECDHE_ECDSA handshakes per second with each of them. A handshake
+   is one ephemeral key pair, one shared secret, one signature and one verification. */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "../ecc.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+int uECC_make_key_impl(uint8_t p_publicKey[uECC_BYTES*2], uint8_t p_privateKey[uECC_BYTES]);
+int uECC_shared_secret_impl(const uint8_t p_publicKey[uECC_BYTES*2], const uint8_t p_privateKey[uECC_BYTES], uint8_t p_secret[uECC_BYTES]);
+int uECC_sign_impl(const uint8_t p_privateKey[uECC_BYTES], const uint8_t p_hash[uECC_BYTES], uint8_t p_signature[uECC_BYTES*2]);
+int uECC_verify_impl(const uint8_t p_publicKey[uECC_BYTES*2], const uint8_t p_hash[uECC_BYTES], const uint8_t p_signature[uECC_BYTES*2]);
+
+#define CHECK_ROUNDS 256
+#define BENCHMARK_HANDSHAKES 200
+
+static const uint8_t g_generator[uECC_BYTES*2] =
+{
+    0x6B, 0x17, 0xD1, 0xF2, 0xE1, 0x2C, 0x42, 0x47, 0xF8, 0xBC, 0xE6, 0xE5, 0x63, 0xA4, 0x40, 0xF2,
+    0x77, 0x03, 0x7D, 0x81, 0x2D, 0xEB, 0x33, 0xA0, 0xF4, 0xA1, 0x39, 0x45, 0xD8, 0x98, 0xC2, 0x96,
+    0x4F, 0xE3, 0x42, 0xE2, 0xFE, 0x1A, 0x7F, 0x9B, 0x8E, 0xE7, 0xEB, 0x4A, 0x7C, 0x0F, 0x9E, 0x16,
+    0x2B, 0xCE, 0x33, 0x57, 0x6B, 0x31, 0x5E, 0xCE, 0xCB, 0xB6, 0x40, 0x68, 0x37, 0xBF, 0x51, 0xF5
+};
+
+static int fail(const char *p_what, int p_round)
+{
+    printf("\n%s (round %d)\n", p_what, p_round);
+    return 1;
+}
+
+static int cross_check(void)
+{
+    uint8_t l_private1[uECC_BYTES], l_private2[uECC_BYTES];
+    uint8_t l_public1[uECC_BYTES * 2], l_public2[uECC_BYTES * 2];
+    uint8_t l_secret1[uECC_BYTES], l_secret2[uECC_BYTES];
+    uint8_t l_hash[uECC_BYTES];
+    uint8_t l_signature[uECC_BYTES * 2];
+    int i;
+
+    printf("Cross-checking %d rounds against the generic implementation\n", CHECK_ROUNDS);
+
+    for (i = 0; i < CHECK_ROUNDS; ++i)
+    {
+        printf(".");
+        fflush(stdout);
+
+        /* key pairs from both implementations, public key checked against d * G */
+        if (!uECC_make_key(l_public1, l_private1) || !uECC_make_key_impl(l_public2, l_private2))
+        {
+            return fail("make_key() failed", i);
+        }
+        if (!uECC_shared_secret_impl(g_generator, l_private1, l_secret1)
+            || memcmp(l_secret1, l_public1, uECC_BYTES) != 0)
+        {
+            return fail("public key differs from d * G", i);
+        }
+
+        if (!uECC_shared_secret(l_public2, l_private1, l_secret1)
+            || !uECC_shared_secret_impl(l_public1, l_private2, l_secret2)
+            || memcmp(l_secret1, l_secret2, sizeof(l_secret1)) != 0)
+        {
+            return fail("shared secrets are not identical", i);
+        }
+
+        /* hashes above n must be reduced the same way by both implementations */
+        memset(l_hash, 0xFF, sizeof(l_hash));
+        if (i % 2)
+        {
+            memcpy(l_hash, l_secret1, sizeof(l_hash));
+        }
+
+        if (!uECC_sign(l_private1, l_hash, l_signature)
+            || !uECC_verify_impl(l_public1, l_hash, l_signature)
+            || !uECC_verify(l_public1, l_hash, l_signature))
+        {
+            return fail("signature from the fast path was rejected", i);
+        }
+        if (!uECC_sign_impl(l_private2, l_hash, l_signature)
+            || !uECC_verify(l_public2, l_hash, l_signature))
+        {
+            return fail("signature from the generic code was rejected", i);
+        }
+
+        l_hash[i % uECC_BYTES] ^= 0x01;
+        if (uECC_verify(l_public2, l_hash, l_signature))
+        {
+            return fail("signature over a different hash was accepted", i);
+        }
+    }
+
+    /* a point off the curve must not be used for ECDH */
+    l_public1[uECC_BYTES * 2 - 1] ^= 0x01;
+    if (uECC_shared_secret(l_public1, l_private2, l_secret1))
+    {
+        return fail("shared_secret() accepted a point off the curve", i);
+    }
+
+    printf("\n");
+    return 0;
+}
+
+static double handshakes_per_second(void)
+{
+    uint8_t l_identityPublic[uECC_BYTES * 2], l_identityPrivate[uECC_BYTES];
+    uint8_t l_peerPublic[uECC_BYTES * 2], l_peerPrivate[uECC_BYTES];
+    uint8_t l_ephemeralPublic[uECC_BYTES * 2], l_ephemeralPrivate[uECC_BYTES];
+    uint8_t l_secret[uECC_BYTES];
+    uint8_t l_peerSignature[uECC_BYTES * 2], l_signature[uECC_BYTES * 2];
+    struct timespec l_start, l_end;
+    int i;
+
+    uECC_make_key(l_identityPublic, l_identityPrivate);
+    uECC_make_key(l_peerPublic, l_peerPrivate);
+    uECC_sign(l_peerPrivate, l_identityPublic, l_peerSignature);
+
+    clock_gettime(CLOCK_MONOTONIC, &l_start);
+    for (i = 0; i < BENCHMARK_HANDSHAKES; ++i)
+    {
+        uECC_make_key(l_ephemeralPublic, l_ephemeralPrivate);
+        uECC_sign(l_identityPrivate, l_ephemeralPublic, l_signature);
+        uECC_shared_secret(l_peerPublic, l_ephemeralPrivate, l_secret);
+        if (!uECC_verify(l_peerPublic, l_identityPublic, l_peerSignature))
+        {
+            printf("uECC_verify() failed\n");
+            return 0;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &l_end);
+
+    return BENCHMARK_HANDSHAKES / ((l_end.tv_sec - l_start.tv_sec) + (l_end.tv_nsec - l_start.tv_nsec) / 1e9);
+}
+
+int main()
+{
+    double l_generic, l_fast;
+
+    l_generic = handshakes_per_second();
+
+    if (uECC_has_custom_cb())
+    {
+        return fail("callbacks replaced before the backend was installed", 0);
+    }
+
+    if (!uECC_use_p256_64())
+    {
+        printf("64-bit secp256r1 backend not available in this build\n");
+        return 0;
+    }
+
+    if (!uECC_has_custom_cb())
+    {
+        return fail("installed backend not reported", 0);
+    }
+
+    if (cross_check())
+    {
+        return 1;
+    }
+
+    l_fast = handshakes_per_second();
+    printf("generic: %.0f handshakes/s, 64-bit secp256r1: %.0f handshakes/s (%.1fx)\n",
+           l_generic, l_fast, l_fast / l_generic);
+    return 0;
+}
@@ -0,0 +1,296 @@
+/* Loopback benchmark for DTLS reconnects
+ *
+ * A client and a server context in one process talk over two UDP
+ * sockets on 127.0.0.1. The client connects, closes the connection
+ * and connects again, for each cipher suite once without and once with
+ * the session cache. The time from dtls_connect() until the client
+ * sees DTLS_EVENT_CONNECTED is the reconnect latency.
+ */
+
+#include "tinydtls.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+
+#include "global.h"
+#include "debug.h"
+#include "dtls.h"
+
+#define RECONNECTS 200
+#define SESSION_CACHE_SIZE 16
+#define SESSION_LIFETIME 3600
+
+#define PSK_CLIENT_IDENTITY  "Client_identity"
+#define PSK_SERVER_IDENTITY  "Server_identity"
+
+static unsigned char psk_key[] = "secretPSK";
+
+typedef struct {
+  int fd;
+  int connected;
+} endpoint_t;
+
+static endpoint_t server_ep, client_ep;
+static dtls_context_t *server_ctx, *client_ctx;
+static session_t server_addr;
+
+static int
+get_psk_info(struct dtls_context_t *ctx,
+	     const session_t *session,
+	     dtls_credentials_type_t type,
+	     const unsigned char *id, size_t id_len,
+	     unsigned char *result, size_t result_length) {
+  const char *value;
+  size_t length;
+
+  switch (type) {
+  case DTLS_PSK_HINT:
+    value = PSK_SERVER_IDENTITY;
+    length = strlen(value);
+    break;
+  case DTLS_PSK_IDENTITY:
+    value = PSK_CLIENT_IDENTITY;
+    length = strlen(value);
+    break;
+  case DTLS_PSK_KEY:
+    value = (const char *)psk_key;
+    length = strlen(value);
+    break;
+  default:
+    return dtls_alert_fatal_create(DTLS_ALERT_INTERNAL_ERROR);
+  }
+
+  if (result_length < length)
+    return dtls_alert_fatal_create(DTLS_ALERT_INTERNAL_ERROR);
+
+  memcpy(result, value, length);
+  return length;
+}
+
+static int
+send_to_peer(struct dtls_context_t *ctx,
+	     session_t *session, uint8 *data, size_t len) {
+  endpoint_t *ep = (endpoint_t *)dtls_get_app_data(ctx);
+
+  return sendto(ep->fd, data, len, 0, &session->addr.sa, session->size);
+}
+
+static int
+read_from_peer(struct dtls_context_t *ctx,
+	       session_t *session, uint8 *data, size_t len) {
+  return 0;
+}
+
+static int
+handle_event(struct dtls_context_t *ctx, session_t *session,
+	     dtls_alert_level_t level, unsigned short code) {
+  endpoint_t *ep = (endpoint_t *)dtls_get_app_data(ctx);
+
+  if (level == 0 && code == DTLS_EVENT_CONNECTED)
+    ep->connected = 1;
+  return 0;
+}
+
+static dtls_handler_t cb = {
+  .write = send_to_peer,
+  .read  = read_from_peer,
+  .event = handle_event,
+  .get_psk_info = get_psk_info,
+};
+
+static int
+open_socket(session_t *addr) {
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+  dtls_session_init(addr);
+  addr->size = sizeof(addr->addr.sin);
+  addr->addr.sin.sin_family = AF_INET;
+  addr->addr.sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr->addr.sin.sin_port = 0;
+
+  if (fd < 0 || bind(fd, &addr->addr.sa, addr->size) < 0 ||
+      getsockname(fd, &addr->addr.sa, &addr->size) < 0) {
+    perror("socket");
+    return -1;
+  }
+  return fd;
+}
+
+static void
+receive(dtls_context_t *ctx, int fd) {
+  uint8 buf[DTLS_MAX_BUF];
+  session_t session;
+  int len;
+
+  dtls_session_init(&session);
+  session.size = sizeof(session.addr);
+  len = recvfrom(fd, buf, sizeof(buf), 0, &session.addr.sa, &session.size);
+  if (len > 0)
+    dtls_handle_message(ctx, &session, buf, len);
+}
+
+static int
+client_connected(void) {
+  return client_ep.connected;
+}
+
+static int
+client_closed(void) {
+  return dtls_get_peer(client_ctx, &server_addr) == NULL;
+}
+
+/* Handles datagrams on both sockets until done() holds, at most for a second. */
+static int
+run_until(int (*done)(void)) {
+  struct pollfd fds[2] = { { server_ep.fd, POLLIN, 0 }, { client_ep.fd, POLLIN, 0 } };
+  int waited = 0;
+
+  while (!done()) {
+    int n = poll(fds, 2, 10);
+
+    if (n == 0) {
+      dtls_check_retransmit(server_ctx, NULL);
+      dtls_check_retransmit(client_ctx, NULL);
+      if ((waited += 10) > 1000)
+	return -1;
+      continue;
+    }
+    if (fds[0].revents & POLLIN)
+      receive(server_ctx, server_ep.fd);
+    if (fds[1].revents & POLLIN)
+      receive(client_ctx, client_ep.fd);
+  }
+  return 0;
+}
+
+static double
+now_usec(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* Connects and disconnects the client, returns the time to connect in usec. */
+static double
+reconnect(void) {
+  double start, latency;
+
+  client_ep.connected = 0;
+  start = now_usec();
+  if (dtls_connect(client_ctx, &server_addr) < 0 ||
+      run_until(client_connected) < 0)
+    return -1;
+  latency = now_usec() - start;
+
+  dtls_close(client_ctx, &server_addr);
+  if (run_until(client_closed) < 0)
+    return -1;
+
+  return latency;
+}
+
+static void
+set_session_cache(size_t capacity) {
+  dtls_set_session_cache(server_ctx, capacity, SESSION_LIFETIME);
+  dtls_set_session_cache(client_ctx, capacity, SESSION_LIFETIME);
+  memset(&server_ctx->session_stats, 0, sizeof(dtls_session_stats_t));
+  memset(&client_ctx->session_stats, 0, sizeof(dtls_session_stats_t));
+}
+
+static int
+benchmark(const char *name, dtls_cipher_t cipher, size_t capacity) {
+  const dtls_session_stats_t *stats;
+  double total = 0, latency;
+  int i;
+
+  dtls_select_cipher(client_ctx, cipher);
+  set_session_cache(capacity);
+
+  for (i = 0; i < RECONNECTS; i++) {
+    if ((latency = reconnect()) < 0) {
+      fprintf(stderr, "%s: connect %d failed\n", name, i);
+      return -1;
+    }
+    total += latency;
+  }
+
+  stats = dtls_get_session_stats(server_ctx);
+  printf("%-48s %8.1f usec per connect, %lu full / %lu resumed (%.0f%% resumed)\n",
+	 name, total / RECONNECTS, stats->full_handshakes, stats->resumed_handshakes,
+	 100.0 * stats->resumed_handshakes /
+	 (stats->full_handshakes + stats->resumed_handshakes));
+
+  if (capacity && stats->resumed_handshakes != RECONNECTS - 1) {
+    fprintf(stderr, "%s: expected every reconnect to resume the session\n", name);
+    return -1;
+  }
+  return 0;
+}
+
+/* A new key for the identity must not accept the old session. */
+static int
+check_key_change(void) {
+  const dtls_session_stats_t *stats = dtls_get_session_stats(server_ctx);
+
+  dtls_select_cipher(client_ctx, TLS_PSK_WITH_AES_128_CCM_8);
+  set_session_cache(SESSION_CACHE_SIZE);
+
+  if (reconnect() < 0 || reconnect() < 0 || stats->resumed_handshakes != 1)
+    return -1;
+
+  psk_key[0] ^= 1;
+  if (reconnect() < 0 || stats->full_handshakes != 2 || stats->resumed_handshakes != 1)
+    return -1;
+
+  psk_key[0] ^= 1;
+  return 0;
+}
+
+int
+main(int argc, char **argv) {
+  session_t client_addr;
+  int res = 0;
+
+  dtls_init();
+  dtls_set_log_level(DTLS_LOG_EMERG);
+
+  if ((server_ep.fd = open_socket(&server_addr)) < 0 ||
+      (client_ep.fd = open_socket(&client_addr)) < 0)
+    return 1;
+
+  server_ctx = dtls_new_context(&server_ep);
+  client_ctx = dtls_new_context(&client_ep);
+  if (!server_ctx || !client_ctx)
+    return 1;
+
+  dtls_set_handler(server_ctx, &cb);
+  dtls_set_handler(client_ctx, &cb);
+
+  if (benchmark("TLS_PSK_WITH_AES_128_CCM_8", TLS_PSK_WITH_AES_128_CCM_8, 0) < 0 ||
+      benchmark("TLS_PSK_WITH_AES_128_CCM_8, resumed", TLS_PSK_WITH_AES_128_CCM_8,
+		SESSION_CACHE_SIZE) < 0 ||
+      benchmark("TLS_ECDHE_PSK_WITH_AES_128_CBC_SHA_256",
+		TLS_ECDHE_PSK_WITH_AES_128_CBC_SHA_256, 0) < 0 ||
+      benchmark("TLS_ECDHE_PSK_WITH_AES_128_CBC_SHA_256, resumed",
+		TLS_ECDHE_PSK_WITH_AES_128_CBC_SHA_256, SESSION_CACHE_SIZE) < 0)
+    res = 1;
+
+  if (!res && check_key_change() < 0) {
+    fprintf(stderr, "session was resumed with a changed key\n");
+    res = 1;
+  }
+
+  dtls_free_context(client_ctx);
+  dtls_free_context(server_ctx);
+  close(client_ep.fd);
+  close(server_ep.fd);
+  return res;
+}
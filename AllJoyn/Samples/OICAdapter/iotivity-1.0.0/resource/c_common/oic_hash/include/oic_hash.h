@@ -0,0 +1,167 @@
+/******************************************************************
+ *
+ * Copyright 2015 Intel Mobile Communications GmbH All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+#ifndef OIC_HASH_H_
+#define OIC_HASH_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * Start value of a hash that is built with OICHashAppend().
+ */
+#define OIC_HASH_INIT (2166136261u)
+
+/**
+ * Link that a node of an OICHashTable_t embeds.  A node that is in several
+ * tables embeds one link for each of them.
+ */
+typedef struct OICHashLink
+{
+    struct OICHashLink *next;   /**< Next link in the same bucket. */
+    struct OICHashLink **prev;  /**< Pointer to this link, NULL while not in a table. */
+    uint32_t hash;              /**< Hash of the key of the node. */
+} OICHashLink_t;
+
+/**
+ * Chained hash table of the links embedded in its nodes.  The table does not own
+ * the nodes and several nodes may have the same key.  A zeroed table is empty.
+ */
+typedef struct
+{
+    OICHashLink_t **buckets;    /**< Bucket heads, NULL until the first node. */
+    size_t size;                /**< Number of buckets; always a power of two. */
+    size_t count;               /**< Number of nodes in the table. */
+} OICHashTable_t;
+
+/**
+ * Gets the node that embeds a link.
+ *
+ * @param link Link of the node, not NULL.
+ * @param type Type of the node.
+ * @param member Name of the link in the node.
+ */
+#define OIC_HASH_ENTRY(link, type, member) \
+    ((type *)((char *)(link) - offsetof(type, member)))
+
+/**
+ * Adds bytes to a FNV-1a hash.
+ *
+ * @param hash Hash so far, OIC_HASH_INIT to start a new one.
+ * @param bytes Bytes to add.
+ * @param length Number of bytes.
+ *
+ * @return the hash including the bytes.
+ */
+uint32_t OICHashAppend(uint32_t hash, const void *bytes, size_t length);
+
+/**
+ * Hashes bytes.
+ *
+ * @param bytes Bytes to hash.
+ * @param length Number of bytes.
+ *
+ * @return the hash.
+ */
+uint32_t OICHashBytes(const void *bytes, size_t length);
+
+/**
+ * Hashes a C string without its terminator.
+ *
+ * @param str String to hash.
+ *
+ * @return the hash.
+ */
+uint32_t OICHashString(const char *str);
+
+/**
+ * Hashes the value of a pointer.
+ *
+ * @param pointer Pointer to hash.
+ *
+ * @return the hash.
+ */
+uint32_t OICHashPointer(const void *pointer);
+
+/**
+ * Makes sure the table has at least one bucket for each of count nodes, so that
+ * chains stay short.  A table that cannot grow still works, only with longer chains.
+ *
+ * @param table Table to grow.
+ * @param count Number of nodes to make room for.
+ *
+ * @return false only if the table has no bucket at all.
+ */
+bool OICHashTableReserve(OICHashTable_t *table, size_t count);
+
+/**
+ * Adds a node to the table, growing it when needed.
+ *
+ * @param table Table to add to.
+ * @param link Link of the node, not in any table.
+ * @param hash Hash of the key of the node.
+ *
+ * @return false if the table has no bucket and none could be allocated.
+ */
+bool OICHashTableInsert(OICHashTable_t *table, OICHashLink_t *link, uint32_t hash);
+
+/**
+ * Removes a node from the table.  Nodes that are not in it are left alone.
+ *
+ * @param table Table the node is in.
+ * @param link Link of the node.
+ */
+void OICHashTableRemove(OICHashTable_t *table, OICHashLink_t *link);
+
+/**
+ * Gets the first node with a hash.  The key of the node still has to be compared.
+ *
+ * @param table Table to search.
+ * @param hash Hash of the key.
+ *
+ * @return link of the node, NULL if there is none.
+ */
+OICHashLink_t *OICHashTableFind(const OICHashTable_t *table, uint32_t hash);
+
+/**
+ * Gets the next node with the hash of a node that OICHashTableFind() returned.
+ *
+ * @param link Link of the node before.
+ *
+ * @return link of the node, NULL if there is none.
+ */
+OICHashLink_t *OICHashTableFindNext(const OICHashLink_t *link);
+
+/**
+ * Removes all nodes and frees the buckets.
+ *
+ * @param table Table to clear.
+ */
+void OICHashTableClear(OICHashTable_t *table);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // OIC_HASH_H_
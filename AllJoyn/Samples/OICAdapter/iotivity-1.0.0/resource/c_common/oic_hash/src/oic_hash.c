@@ -0,0 +1,179 @@
+/******************************************************************
+ *
+ * Copyright 2015 Intel Mobile Communications GmbH All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+#include "oic_hash.h"
+
+#include <string.h>
+#include "oic_malloc.h"
+
+// Number of buckets a table starts with; a power of two
+#define OIC_HASH_TABLE_INIT_SIZE (16)
+
+#define FNV_PRIME (16777619u)
+
+uint32_t OICHashAppend(uint32_t hash, const void *bytes, size_t length)
+{
+    const uint8_t *byte = (const uint8_t *)bytes;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash = (hash ^ byte[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+uint32_t OICHashBytes(const void *bytes, size_t length)
+{
+    return OICHashAppend(OIC_HASH_INIT, bytes, length);
+}
+
+uint32_t OICHashString(const char *str)
+{
+    uint32_t hash = OIC_HASH_INIT;
+    for (; *str; str++)
+    {
+        hash = (hash ^ (uint8_t)*str) * FNV_PRIME;
+    }
+    return hash;
+}
+
+uint32_t OICHashPointer(const void *pointer)
+{
+    return OICHashBytes(&pointer, sizeof(pointer));
+}
+
+static void LinkBucket(OICHashLink_t **bucket, OICHashLink_t *link)
+{
+    link->next = *bucket;
+    if (link->next)
+    {
+        link->next->prev = &link->next;
+    }
+    link->prev = bucket;
+    *bucket = link;
+}
+
+bool OICHashTableReserve(OICHashTable_t *table, size_t count)
+{
+    if (count <= table->size)
+    {
+        return true;
+    }
+
+    size_t size = table->size ? table->size : OIC_HASH_TABLE_INIT_SIZE;
+    while (size < count)
+    {
+        size *= 2;
+    }
+
+    OICHashLink_t **buckets = (OICHashLink_t **)OICCalloc(size, sizeof(OICHashLink_t *));
+    if (!buckets)
+    {
+        return 0 != table->size;
+    }
+
+    for (size_t i = 0; i < table->size; i++)
+    {
+        OICHashLink_t *link = table->buckets[i];
+        while (link)
+        {
+            OICHashLink_t *next = link->next;
+            LinkBucket(&buckets[link->hash & (size - 1)], link);
+            link = next;
+        }
+    }
+
+    OICFree(table->buckets);
+    table->buckets = buckets;
+    table->size = size;
+    return true;
+}
+
+bool OICHashTableInsert(OICHashTable_t *table, OICHashLink_t *link, uint32_t hash)
+{
+    if (!OICHashTableReserve(table, table->count + 1))
+    {
+        return false;
+    }
+
+    link->hash = hash;
+    LinkBucket(&table->buckets[hash & (table->size - 1)], link);
+    table->count++;
+    return true;
+}
+
+void OICHashTableRemove(OICHashTable_t *table, OICHashLink_t *link)
+{
+    if (!link->prev)
+    {
+        return;
+    }
+
+    *link->prev = link->next;
+    if (link->next)
+    {
+        link->next->prev = link->prev;
+    }
+    link->next = NULL;
+    link->prev = NULL;
+    table->count--;
+}
+
+OICHashLink_t *OICHashTableFind(const OICHashTable_t *table, uint32_t hash)
+{
+    if (!table->size)
+    {
+        return NULL;
+    }
+
+    OICHashLink_t *link = table->buckets[hash & (table->size - 1)];
+    while (link && link->hash != hash)
+    {
+        link = link->next;
+    }
+    return link;
+}
+
+OICHashLink_t *OICHashTableFindNext(const OICHashLink_t *link)
+{
+    OICHashLink_t *next = link->next;
+    while (next && next->hash != link->hash)
+    {
+        next = next->next;
+    }
+    return next;
+}
+
+void OICHashTableClear(OICHashTable_t *table)
+{
+    // nodes outlive the table, they must not point into the freed buckets
+    for (size_t i = 0; i < table->size; i++)
+    {
+        OICHashLink_t *link = table->buckets[i];
+        while (link)
+        {
+            OICHashLink_t *next = link->next;
+            link->next = NULL;
+            link->prev = NULL;
+            link = next;
+        }
+    }
+
+    OICFree(table->buckets);
+    memset(table, 0, sizeof(*table));
+}
@@ -0,0 +1,131 @@
+//******************************************************************
+//
+// Copyright 2015 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include <oic_hash.h>
+#include <string.h>
+
+typedef struct
+{
+    int key;
+    OICHashLink_t link;
+} HashTestNode;
+
+static HashTestNode *FindNode(const OICHashTable_t *table, int key)
+{
+    for (OICHashLink_t *link = OICHashTableFind(table, OICHashBytes(&key, sizeof(key)));
+         link; link = OICHashTableFindNext(link))
+    {
+        HashTestNode *node = OIC_HASH_ENTRY(link, HashTestNode, link);
+        if (node->key == key)
+        {
+            return node;
+        }
+    }
+    return NULL;
+}
+
+TEST(OICHash, KnownValues)
+{
+    // FNV-1a test vectors
+    EXPECT_EQ(2166136261u, OICHashBytes("", 0));
+    EXPECT_EQ(0xe40c292cu, OICHashBytes("a", 1));
+    EXPECT_EQ(0xbf9cf968u, OICHashString("foobar"));
+    EXPECT_EQ(OICHashString("foobar"), OICHashAppend(OICHashString("foo"), "bar", 3));
+}
+
+TEST(OICHash, EmptyTable)
+{
+    OICHashTable_t table;
+    memset(&table, 0, sizeof(table));
+    EXPECT_EQ(NULL, OICHashTableFind(&table, 0));
+
+    HashTestNode node;
+    memset(&node, 0, sizeof(node));
+    OICHashTableRemove(&table, &node.link);
+    OICHashTableClear(&table);
+    EXPECT_EQ(0u, table.count);
+}
+
+TEST(OICHash, InsertFindRemoveWhileGrowing)
+{
+    const int count = 1000;
+    OICHashTable_t table;
+    memset(&table, 0, sizeof(table));
+    HashTestNode *nodes = new HashTestNode[count];
+
+    for (int i = 0; i < count; i++)
+    {
+        memset(&nodes[i], 0, sizeof(nodes[i]));
+        nodes[i].key = i;
+        ASSERT_TRUE(OICHashTableInsert(&table, &nodes[i].link,
+                                       OICHashBytes(&nodes[i].key, sizeof(int))));
+    }
+    EXPECT_EQ((size_t) count, table.count);
+    EXPECT_LE((size_t) count, table.size);
+
+    for (int i = 0; i < count; i++)
+    {
+        EXPECT_EQ(&nodes[i], FindNode(&table, i));
+    }
+    EXPECT_EQ(NULL, FindNode(&table, count));
+
+    for (int i = 0; i < count; i += 2)
+    {
+        OICHashTableRemove(&table, &nodes[i].link);
+    }
+    // removing twice does nothing
+    OICHashTableRemove(&table, &nodes[0].link);
+    EXPECT_EQ((size_t) count / 2, table.count);
+
+    for (int i = 0; i < count; i++)
+    {
+        EXPECT_EQ((i % 2) ? &nodes[i] : NULL, FindNode(&table, i));
+    }
+
+    OICHashTableClear(&table);
+    EXPECT_EQ(NULL, OICHashTableFind(&table, OICHashBytes(&nodes[1].key, sizeof(int))));
+    EXPECT_EQ(NULL, nodes[1].link.prev);
+    delete[] nodes;
+}
+
+TEST(OICHash, SameKeyIsFoundAsOftenAsInserted)
+{
+    OICHashTable_t table;
+    memset(&table, 0, sizeof(table));
+    HashTestNode nodes[3];
+    memset(nodes, 0, sizeof(nodes));
+
+    for (int i = 0; i < 3; i++)
+    {
+        ASSERT_TRUE(OICHashTableInsert(&table, &nodes[i].link, OICHashString("/a/light")));
+    }
+
+    int found = 0;
+    for (OICHashLink_t *link = OICHashTableFind(&table, OICHashString("/a/light")); link;
+         link = OICHashTableFindNext(link))
+    {
+        found++;
+    }
+    EXPECT_EQ(3, found);
+
+    OICHashTableClear(&table);
+}
@@ -48,6 +48,13 @@ extern "C"
 // Typedefs
 //-----------------------------------------------------------------------------
 
+/**
+ * Called by OICMalloc, OICCalloc and OICRealloc before they allocate.
+ *
+ * @param size - Size of the requested memory block in bytes.
+ */
+typedef void (*OICAllocHook)(size_t size);
+
 //-----------------------------------------------------------------------------
 // Function prototypes
 //-----------------------------------------------------------------------------
@@ -111,6 +118,17 @@ void *OICCalloc(size_t num, size_t size);
  */
 void OICFree(void *ptr);
 
+/**
+ * Set the hook that is told about every allocation, e.g. to count the
+ * allocations of a code path in a test.
+ *
+ * NOTE: This function is not thread safe.  Set the hook before the stack
+ *       starts its threads, or make the hook itself thread safe.
+ *
+ * @param hook - The hook to call, or NULL to remove it.
+ */
+void OICSetAllocHook(OICAllocHook hook);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
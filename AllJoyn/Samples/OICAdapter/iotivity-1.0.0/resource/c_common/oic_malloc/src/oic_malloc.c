@@ -37,6 +37,7 @@
 //-----------------------------------------------------------------------------
 // Private variables
 //-----------------------------------------------------------------------------
+static OICAllocHook g_allocHook = NULL;
 
 //-----------------------------------------------------------------------------
 // Macros
@@ -64,6 +65,11 @@ void *OICMalloc(size_t size)
         return NULL;
     }
 
+    if (g_allocHook)
+    {
+        g_allocHook(size);
+    }
+
 #ifdef ENABLE_MALLOC_DEBUG
     void *ptr = malloc(size);
     if (ptr)
@@ -84,6 +90,11 @@ void *OICCalloc(size_t num, size_t size)
         return NULL;
     }
 
+    if (g_allocHook)
+    {
+        g_allocHook(num * size);
+    }
+
 #ifdef ENABLE_MALLOC_DEBUG
     void *ptr = calloc(num, size);
     if (ptr)
@@ -107,6 +118,11 @@ void *OICRealloc(void* ptr, size_t size)
         return OICMalloc(size);
     }
 
+    if (g_allocHook)
+    {
+        g_allocHook(size);
+    }
+
     // Otherwise leave the behavior up to realloc() itself:
 
 #ifdef ENABLE_MALLOC_DEBUG
@@ -134,3 +150,8 @@ void OICFree(void *ptr)
 
     free(ptr);
 }
+
+void OICSetAllocHook(OICAllocHook hook)
+{
+    g_allocHook = hook;
+}
@@ -43,6 +43,15 @@
     #define OC_STATIC_ASSERT(condition, msg) ((void)sizeof(char[2*!!(condition) - 1]))
 #endif
 
+#if defined(WITH_ARDUINO) || defined(ARDUINO)
+    // Arduino builds are single threaded.
+    #define OC_THREAD_LOCAL
+#elif defined(WIN32)
+    #define OC_THREAD_LOCAL __declspec(thread)
+#else
+    #define OC_THREAD_LOCAL __thread
+#endif
+
 #ifdef WIN32
 #define __func__ __FUNCTION__
 #define strncasecmp _strnicmp
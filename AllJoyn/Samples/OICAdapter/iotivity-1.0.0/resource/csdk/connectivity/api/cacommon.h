@@ -327,6 +327,35 @@ typedef enum
     CA_ADAPTER_ENABLED     /**< Adapter is Enabled */
 } CAAdapterState_t;
 
+/**
+ * @enum CAQueueOverflowPolicy_t
+ * What a message queue does with a message that is added while it is full.
+ */
+typedef enum
+{
+    CA_QUEUE_DROP_OLDEST_NON = 0,  /**< Drop the oldest non-confirmable message to make room,
+                                        reject the new message if there is none */
+    CA_QUEUE_REJECT,               /**< Reject the new message */
+    CA_QUEUE_BLOCK                 /**< Let the sender wait a while for room, then reject */
+} CAQueueOverflowPolicy_t;
+
+/**
+ * Statistics of a message queue.
+ */
+typedef struct
+{
+    uint32_t depth;             /**< Messages in the queue */
+    uint32_t maxDepth;          /**< Most messages that were in the queue at once */
+    uint32_t capacity;          /**< Most messages the queue accepts */
+    uint64_t enqueued;          /**< Messages added */
+    uint64_t dequeued;          /**< Messages taken by the consumer */
+    uint64_t dropped;           /**< Queued messages dropped to make room */
+    uint64_t rejected;          /**< Messages not added because the queue was full */
+    uint64_t blocked;           /**< Times a sender had to wait for room */
+    uint64_t totalLatency;      /**< Time dequeued messages spent in the queue, in microseconds */
+    uint64_t maxLatency;        /**< Longest time a message spent in the queue, in microseconds */
+} CAQueueStats_t;
+
 /**
  * Format indicating which encoding has been used on the payload.
  */
@@ -492,6 +521,8 @@ typedef struct
         CASocket_t m4s;     /**< multicast IPv4 secure */
         int netlinkFd;      /**< netlink */
         int shutdownFds[2]; /**< shutdown pipe */
+        int epollFd;        /**< epoll set of all sockets (linux) */
+        int eventFd;        /**< shutdown and change notification (linux) */
         int selectTimeout;  /**< in seconds */
         int maxfd;          /**< highest fd (for select) */
         bool started;       /**< the IP adapter has started */
@@ -201,6 +201,42 @@ CAResult_t CAGetNetworkInformation(CAEndpoint_t **info, uint32_t *size);
  */
 CAResult_t CAHandleRequestResponse();
 
+/**
+ * Waits until there is received data for ::CAHandleRequestResponse, so that
+ * the caller does not have to poll it.
+ * @param[in]   timeout   maximum time to wait in milliseconds, UINT32_MAX to
+ *                        wait without a timeout.
+ * @return  ::CA_STATUS_OK if there is data or ::CASignalRequestResponse was called,
+ *          ::CA_REQUEST_TIMEOUT if the timeout elapsed, ::CA_NOT_SUPPORTED if
+ *          ::CAHandleRequestResponse has to be polled in this build.
+ */
+CAResult_t CAWaitForRequestResponse(uint32_t timeout);
+
+/**
+ * Wakes up the thread waiting in ::CAWaitForRequestResponse, or makes the
+ * next wait return at once.
+ * @return  ::CA_STATUS_OK or ::CA_STATUS_NOT_INITIALIZED.
+ */
+CAResult_t CASignalRequestResponse();
+
+/**
+ * Bounds the queues of messages waiting to be sent and to be handled by
+ * ::CAHandleRequestResponse.  By default each queue accepts 1024 messages and
+ * drops the oldest non-confirmable one when it is full.
+ * @param[in]   capacity  most messages each queue accepts, at least 1.
+ * @param[in]   policy    what to do with a message added while its queue is full.
+ * @return  ::CA_STATUS_OK, ::CA_STATUS_INVALID_PARAM or ::CA_STATUS_NOT_INITIALIZED.
+ */
+CAResult_t CASetMessageQueueLimit(uint32_t capacity, CAQueueOverflowPolicy_t policy);
+
+/**
+ * Gets the depth, drop and latency statistics of the message queues.
+ * @param[out]  sendStats     statistics of the send queue, may be NULL.
+ * @param[out]  receiveStats  statistics of the receive queue, may be NULL.
+ * @return  ::CA_STATUS_OK or ::CA_STATUS_NOT_INITIALIZED.
+ */
+CAResult_t CAGetMessageQueueStats(CAQueueStats_t *sendStats, CAQueueStats_t *receiveStats);
+
 #ifdef RA_ADAPTER
 /**
  * Set Remote Access information for XMPP Client.
@@ -206,6 +206,44 @@ CAResult_t CAInitiateHandshake(const CAEndpoint_t *endpoint);
  */
 CAResult_t CACloseDtlsSession(const CAEndpoint_t *endpoint);
 
+/**
+ * DTLS handshake statistics. The share of resumed sessions is
+ * resumedHandshakes / (fullHandshakes + resumedHandshakes).
+ */
+typedef struct
+{
+    uint32_t fullHandshakes;      /**< Handshakes that negotiated a new session. */
+    uint32_t resumedHandshakes;   /**< Abbreviated handshakes of a cached session. */
+    uint32_t evictions;           /**< Sessions dropped from a full cache before expiry. */
+} CADtlsSessionStats_t;
+
+/**
+ * Configure the cache of DTLS sessions that can be resumed with an abbreviated
+ * handshake. Only PSK based sessions are cached, and the PSK is requested again
+ * on resumption so that changed credentials force a full handshake.
+ * Sessions cached so far are dropped.
+ *
+ * @param[in] capacity  Maximum number of cached sessions, 0 disables resumption.
+ * @param[in] lifetime  Seconds a session can be resumed after its full handshake,
+ *                      at most 86400.
+ *
+ * @retval  ::CA_STATUS_OK    Successful.
+ * @retval  ::CA_STATUS_INVALID_PARAM  Invalid input arguments.
+ * @retval  ::CA_STATUS_FAILED Operation failed.
+ */
+CAResult_t CASetDtlsSessionCache(size_t capacity, uint32_t lifetime);
+
+/**
+ * Get the DTLS handshake statistics.
+ *
+ * @param[out] stats  Filled with the statistics.
+ *
+ * @retval  ::CA_STATUS_OK    Successful.
+ * @retval  ::CA_STATUS_INVALID_PARAM  Invalid input arguments.
+ * @retval  ::CA_STATUS_FAILED Operation failed.
+ */
+CAResult_t CAGetDtlsSessionStats(CADtlsSessionStats_t *stats);
+
 #endif /* __WITH_DTLS__ */
 
 
@@ -53,9 +53,10 @@ typedef struct ca_thread_pool
 }*ca_thread_pool_t;
 
 /**
- * This function creates a newly allocated thread pool.
+ * This function creates a newly allocated thread pool.  Worker threads are started
+ * on demand, up to num_of_threads.
  *
- * @param num_of_threads The number of worker thread used in this pool.
+ * @param num_of_threads The maximum number of worker threads used in this pool.
  * @param thread_pool_handle Handle to newly create thread pool.
  * @return Error code, CA_STATUS_OK if success, else error number.
  */
@@ -63,17 +64,33 @@ CAResult_t ca_thread_pool_init(int32_t num_of_threads, ca_thread_pool_t *thread_
 
 /**
  * This function adds a routine to be executed by the thread pool at some future time.
+ * The routine runs on one of the pool's worker threads, so it must not block for long;
+ * use ::ca_thread_pool_add_dedicated_task for routines that loop until stopped.
  *
  * @param thread_pool The thread pool structure.
  * @param method The routine to be executed.
  * @param data The data to be passed to the routine.
  *
  * @return CA_STATUS_OK on success.
- * @return Error on failure.
+ * @return Error on failure, including when the task queue is full.
  */
 CAResult_t ca_thread_pool_add_task(ca_thread_pool_t thread_pool, ca_thread_func method,
                     void *data);
 
+/**
+ * This function runs a long-running routine, such as a receive loop or a queueing
+ * thread, on a thread of its own.  The thread is joined by ::ca_thread_pool_free.
+ *
+ * @param thread_pool The thread pool structure.
+ * @param method The routine to be executed.
+ * @param data The data to be passed to the routine.
+ *
+ * @return CA_STATUS_OK on success.
+ * @return Error on failure.
+ */
+CAResult_t ca_thread_pool_add_dedicated_task(ca_thread_pool_t thread_pool, ca_thread_func method,
+                    void *data);
+
 /**
  * This function stops all the worker threads (stop & exit). And frees all the allocated memory.
  * Function will return only after joining all threads executing the currently scheduled tasks.
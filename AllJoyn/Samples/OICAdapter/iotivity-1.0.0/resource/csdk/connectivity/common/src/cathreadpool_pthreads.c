@@ -42,13 +42,65 @@ typedef HANDLE pthread_t;
 #define TAG PCF("UTHREADPOOL")
 
 /**
- * empty struct to represent the details.  This implementation has no data
- * that it needs to keep track of, so it only uses NULL for the internal value.
+ * Number of tasks each worker's queue can hold.  A task is refused once every
+ * queue is full.
+ */
+#define CA_THREAD_POOL_QUEUE_SIZE 64
+
+/**
+ * Task queued on the pool.
+ */
+typedef struct ca_thread_pool_task_t
+{
+    ca_thread_func func;
+    void* data;
+} ca_thread_pool_task_t;
+
+/**
+ * Bounded ring of tasks.  Each worker has one, and tasks are handed out round
+ * robin over them so that submitters and workers do not all contend on a
+ * single lock.  An idle worker steals from the other queues once its own is
+ * empty.
+ */
+typedef struct ca_thread_pool_queue_t
+{
+    ca_mutex lock;
+    uint32_t head;
+    uint32_t count;
+    ca_thread_pool_task_t tasks[CA_THREAD_POOL_QUEUE_SIZE];
+} ca_thread_pool_queue_t;
+
+/**
+ * Worker thread and the queue it drains first.
+ */
+typedef struct ca_thread_pool_worker_t
+{
+    struct ca_thread_pool_details_t* details;
+    uint32_t index;
+    pthread_t thread;
+    ca_thread_pool_queue_t queue;
+} ca_thread_pool_worker_t;
+
+/**
+ * Workers are started on demand, up to num_of_threads, when a task is queued
+ * and no worker is idle.  Tasks added with ca_thread_pool_add_dedicated_task
+ * get a thread of their own, which is recorded in threads_list and joined in
+ * ca_thread_pool_free.
  */
 typedef struct ca_thread_pool_details_t
 {
     u_arraylist_t* threads_list;
     ca_mutex list_lock;
+
+    ca_mutex lock;
+    ca_cond cond;
+    ca_thread_pool_worker_t* workers;
+    uint32_t max_workers;
+    uint32_t num_workers;
+    uint32_t idle_workers;
+    uint32_t pending;
+    uint32_t next_queue;
+    bool is_stop;
 } ca_thread_pool_details_t;
 
 /**
@@ -70,11 +122,142 @@ void* ca_thread_pool_pthreads_delegate(void* data)
     return NULL;
 }
 
-// this implementation doesn't do a thread pool, so this function is essentially
-// a no-op besides creating a valid ca_thread_pool_t object.  It was determined after
-// reading through the existing implementation that the thread-pooling was unnecessary
-// for the posix platforms.  Behavior shouldn't be changed since previously num_of_threads
-// was greater than the number of requested threads.
+static CAResult_t ca_thread_pool_create_thread(void* (*routine)(void*), void* data,
+                                               pthread_t* threadHandle)
+{
+#ifdef WIN32
+    if ((*threadHandle = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE)routine, data, 0, NULL))
+        == INVALID_HANDLE_VALUE)
+    {
+        OIC_LOG_V(ERROR, TAG, "Thread start failed with error %d", GetLastError());
+        return CA_STATUS_FAILED;
+    }
+#else
+    int result = pthread_create(threadHandle, NULL, routine, data);
+
+    if(result != 0)
+    {
+        OIC_LOG_V(ERROR, TAG, "Thread start failed with error %d", result);
+        return CA_STATUS_FAILED;
+    }
+#endif
+    return CA_STATUS_OK;
+}
+
+static void ca_thread_pool_join_thread(pthread_t tid, uint32_t index)
+{
+#ifdef WIN32
+    DWORD joinres = WaitForSingleObject(tid, INFINITE);
+    if (WAIT_OBJECT_0 != joinres)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to join thread at index %u with error %d", index, joinres);
+    }
+    CloseHandle(tid);
+#else
+    int joinres = pthread_join(tid, NULL);
+    if(0 != joinres)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to join thread at index %u with error %d", index, joinres);
+    }
+#endif
+}
+
+static bool ca_thread_pool_queue_push(ca_thread_pool_queue_t* queue, ca_thread_func method,
+                                      void* data)
+{
+    bool pushed = false;
+
+    ca_mutex_lock(queue->lock);
+    if(queue->count < CA_THREAD_POOL_QUEUE_SIZE)
+    {
+        ca_thread_pool_task_t* task =
+            &queue->tasks[(queue->head + queue->count) % CA_THREAD_POOL_QUEUE_SIZE];
+        task->func = method;
+        task->data = data;
+        queue->count++;
+        pushed = true;
+    }
+    ca_mutex_unlock(queue->lock);
+
+    return pushed;
+}
+
+static bool ca_thread_pool_queue_pop(ca_thread_pool_queue_t* queue, ca_thread_pool_task_t* task)
+{
+    bool popped = false;
+
+    ca_mutex_lock(queue->lock);
+    if(queue->count > 0)
+    {
+        *task = queue->tasks[queue->head];
+        queue->head = (queue->head + 1) % CA_THREAD_POOL_QUEUE_SIZE;
+        queue->count--;
+        popped = true;
+    }
+    ca_mutex_unlock(queue->lock);
+
+    return popped;
+}
+
+static void* ca_thread_pool_worker_routine(void* data)
+{
+    ca_thread_pool_worker_t* worker = (ca_thread_pool_worker_t*)data;
+    ca_thread_pool_details_t* details = worker->details;
+
+    for(;;)
+    {
+        ca_mutex_lock(details->lock);
+        details->idle_workers++;
+        while(0 == details->pending && !details->is_stop)
+        {
+            ca_cond_wait(details->cond, details->lock);
+        }
+        details->idle_workers--;
+
+        // queued tasks are still run on stop, as ca_thread_pool_free promises
+        if(0 == details->pending)
+        {
+            ca_mutex_unlock(details->lock);
+            break;
+        }
+        details->pending--;
+        ca_mutex_unlock(details->lock);
+
+        // One queued task is now reserved for this worker, though another
+        // worker may take it from under us, so keep scanning until one is
+        // found: own queue first, then steal from the others.
+        ca_thread_pool_task_t task;
+        uint32_t i = 0;
+        for(;;)
+        {
+            uint32_t index = (worker->index + i) % details->max_workers;
+            if(ca_thread_pool_queue_pop(&details->workers[index].queue, &task))
+            {
+                break;
+            }
+            i++;
+        }
+
+        task.func(task.data);
+    }
+
+    return NULL;
+}
+
+static void ca_thread_pool_free_details(ca_thread_pool_details_t* details, uint32_t num_queues)
+{
+    for(uint32_t i = 0; i < num_queues; ++i)
+    {
+        ca_mutex_free(details->workers[i].queue.lock);
+    }
+    OICFree(details->workers);
+    ca_cond_free(details->cond);
+    ca_mutex_free(details->lock);
+    u_arraylist_free(&details->threads_list);
+    ca_mutex_free(details->list_lock);
+    OICFree(details);
+}
+
 CAResult_t ca_thread_pool_init(int32_t num_of_threads, ca_thread_pool_t *thread_pool)
 {
     OIC_LOG(DEBUG, TAG, "IN");
@@ -99,48 +282,123 @@ CAResult_t ca_thread_pool_init(int32_t num_of_threads, ca_thread_pool_t *thread_
         return CA_MEMORY_ALLOC_FAILED;
     }
 
-    (*thread_pool)->details = OICMalloc(sizeof(struct ca_thread_pool_details_t));
-    if(!(*thread_pool)->details)
+    ca_thread_pool_details_t* details = OICCalloc(1, sizeof(struct ca_thread_pool_details_t));
+    if(!details)
     {
         OIC_LOG(ERROR, TAG, "Failed to allocate for thread-pool details");
         OICFree(*thread_pool);
         *thread_pool=NULL;
         return CA_MEMORY_ALLOC_FAILED;
     }
+    (*thread_pool)->details = details;
 
-    (*thread_pool)->details->list_lock = ca_mutex_new();
+    details->max_workers = (uint32_t)num_of_threads;
+    details->list_lock = ca_mutex_new();
+    details->lock = ca_mutex_new();
+    details->cond = ca_cond_new();
+    details->threads_list = u_arraylist_create();
+    details->workers = OICCalloc(details->max_workers, sizeof(ca_thread_pool_worker_t));
+
+    uint32_t num_queues = 0;
+    if(details->workers)
+    {
+        for(; num_queues < details->max_workers; ++num_queues)
+        {
+            ca_thread_pool_worker_t* worker = &details->workers[num_queues];
+            worker->details = details;
+            worker->index = num_queues;
+            worker->queue.lock = ca_mutex_new();
+            if(!worker->queue.lock)
+            {
+                break;
+            }
+        }
+    }
 
-    if(!(*thread_pool)->details->list_lock)
+    if(!details->list_lock || !details->lock || !details->cond || !details->threads_list
+       || !details->workers || num_queues < details->max_workers)
     {
-        OIC_LOG(ERROR, TAG, "Failed to create thread-pool mutex");
-        OICFree((*thread_pool)->details);
+        OIC_LOG(ERROR, TAG, "Failed to create thread-pool resources");
+        ca_thread_pool_free_details(details, num_queues);
         OICFree(*thread_pool);
         *thread_pool = NULL;
         return CA_STATUS_FAILED;
     }
 
-    (*thread_pool)->details->threads_list = u_arraylist_create();
+    OIC_LOG(DEBUG, TAG, "OUT");
+    return CA_STATUS_OK;
+}
+
+CAResult_t ca_thread_pool_add_task(ca_thread_pool_t thread_pool, ca_thread_func method,
+                                    void *data)
+{
+    OIC_LOG(DEBUG, TAG, "IN");
+
+    if(NULL == thread_pool || NULL == method)
+    {
+        OIC_LOG(ERROR, TAG, "thread_pool or method was NULL");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    ca_thread_pool_details_t* details = thread_pool->details;
 
-    if(!(*thread_pool)->details->threads_list)
+    ca_mutex_lock(details->lock);
+
+    if(details->is_stop)
     {
-        OIC_LOG(ERROR, TAG, "Failed to create thread-pool list");
-        if(!ca_mutex_free((*thread_pool)->details->list_lock))
-        {
-            OIC_LOG(ERROR, TAG, "Failed to free thread-pool mutex");
-        }
+        ca_mutex_unlock(details->lock);
+        OIC_LOG(ERROR, TAG, "thread pool is being freed");
+        return CA_STATUS_FAILED;
+    }
 
-        OICFree((*thread_pool)->details);
-        OICFree(*thread_pool);
-        *thread_pool = NULL;
+    // only spread over the queues of started workers, the others are stolen
+    // from anyway, but keeping tasks close to a live worker keeps them warm
+    uint32_t num_queues = details->num_workers ? details->num_workers : 1;
+    uint32_t first = details->next_queue++ % num_queues;
+    bool pushed = false;
+    for(uint32_t i = 0; i < details->max_workers && !pushed; ++i)
+    {
+        uint32_t index = (first + i) % details->max_workers;
+        pushed = ca_thread_pool_queue_push(&details->workers[index].queue, method, data);
+    }
+
+    if(!pushed)
+    {
+        ca_mutex_unlock(details->lock);
+        OIC_LOG(ERROR, TAG, "thread pool task queue is full");
         return CA_STATUS_FAILED;
     }
 
+    details->pending++;
+
+    if(details->idle_workers < details->pending && details->num_workers < details->max_workers)
+    {
+        ca_thread_pool_worker_t* worker = &details->workers[details->num_workers];
+        if(CA_STATUS_OK == ca_thread_pool_create_thread(ca_thread_pool_worker_routine, worker,
+                                                        &worker->thread))
+        {
+            details->num_workers++;
+        }
+        else if(0 == details->num_workers)
+        {
+            // nobody left to run the task, so take it back out
+            ca_thread_pool_task_t task;
+            ca_thread_pool_queue_pop(&details->workers[first].queue, &task);
+            details->pending--;
+            ca_mutex_unlock(details->lock);
+            return CA_STATUS_FAILED;
+        }
+    }
+
+    ca_cond_signal(details->cond);
+    ca_mutex_unlock(details->lock);
+
     OIC_LOG(DEBUG, TAG, "OUT");
     return CA_STATUS_OK;
 }
 
-CAResult_t ca_thread_pool_add_task(ca_thread_pool_t thread_pool, ca_thread_func method,
-                                    void *data)
+CAResult_t ca_thread_pool_add_dedicated_task(ca_thread_pool_t thread_pool, ca_thread_func method,
+                                             void *data)
 {
     OIC_LOG(DEBUG, TAG, "IN");
 
@@ -162,21 +420,12 @@ CAResult_t ca_thread_pool_add_task(ca_thread_pool_t thread_pool, ca_thread_func
 
     pthread_t threadHandle;
 
-#ifdef WIN32
-    if ((threadHandle = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE)ca_thread_pool_pthreads_delegate, (void*)info, 0, NULL)) == INVALID_HANDLE_VALUE)
-    {
-        OIC_LOG_V(ERROR, TAG, "Thread start failed with error %d", GetLastError());
-        return CA_STATUS_FAILED;
-    }
-#else
-    int result = pthread_create(&threadHandle, NULL, ca_thread_pool_pthreads_delegate, info);
-
-    if(result != 0)
+    if(CA_STATUS_OK != ca_thread_pool_create_thread(ca_thread_pool_pthreads_delegate, info,
+                                                    &threadHandle))
     {
-        OIC_LOG_V(ERROR, TAG, "Thread start failed with error %d", result);
+        OICFree(info);
         return CA_STATUS_FAILED;
     }
-#endif
 
     ca_mutex_lock(thread_pool->details->list_lock);
     bool addResult = u_arraylist_add(thread_pool->details->threads_list, (void*)threadHandle);
@@ -202,33 +451,31 @@ void ca_thread_pool_free(ca_thread_pool_t thread_pool)
         return;
     }
 
-    ca_mutex_lock(thread_pool->details->list_lock);
+    ca_thread_pool_details_t* details = thread_pool->details;
+
+    ca_mutex_lock(details->lock);
+    details->is_stop = true;
+    ca_cond_broadcast(details->cond);
+    ca_mutex_unlock(details->lock);
 
-    for(uint32_t i = 0; i<u_arraylist_length(thread_pool->details->threads_list); ++i)
+    // workers are only started from ca_thread_pool_add_task, which refuses
+    // new tasks from here on, so num_workers is stable
+    for(uint32_t i = 0; i < details->num_workers; ++i)
     {
-        pthread_t tid = (pthread_t)u_arraylist_get(thread_pool->details->threads_list, i);
-#ifdef WIN32
-        DWORD joinres = WaitForSingleObject(tid, INFINITE);
-        if (WAIT_OBJECT_0 != joinres)
-        {
-            OIC_LOG_V(ERROR, TAG, "Failed to join thread at index %u with error %d", i, joinres);
-        }
-        CloseHandle(tid);
-#else
-        int joinres = pthread_join(tid, NULL);
-        if(0 != joinres)
-        {
-            OIC_LOG_V(ERROR, TAG, "Failed to join thread at index %u with error %d", i, joinres);
-        }
-#endif
+        ca_thread_pool_join_thread(details->workers[i].thread, i);
     }
 
-    u_arraylist_free(&(thread_pool->details->threads_list));
+    ca_mutex_lock(details->list_lock);
 
-    ca_mutex_unlock(thread_pool->details->list_lock);
-    ca_mutex_free(thread_pool->details->list_lock);
+    for(uint32_t i = 0; i<u_arraylist_length(details->threads_list); ++i)
+    {
+        pthread_t tid = (pthread_t)u_arraylist_get(details->threads_list, i);
+        ca_thread_pool_join_thread(tid, i);
+    }
+
+    ca_mutex_unlock(details->list_lock);
 
-    OICFree(thread_pool->details);
+    ca_thread_pool_free_details(details, details->max_workers);
     OICFree(thread_pool);
 
     OIC_LOG(DEBUG, TAG, "OUT");
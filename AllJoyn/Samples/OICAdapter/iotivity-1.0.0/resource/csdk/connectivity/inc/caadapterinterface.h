@@ -185,6 +185,24 @@ typedef void (*CARegisterConnectivityCallback)(CAConnectivityHandler_t handler,
 typedef void (*CANetworkPacketReceivedCallback)(const CASecureEndpoint_t *sep,
                                             const void *data, uint32_t dataLen);
 
+/**
+ * A packet of those given to ::CANetworkPacketBatchReceivedCallback.
+ */
+typedef struct
+{
+    CASecureEndpoint_t sep;     /**< network endpoint description. */
+    const void *data;           /**< data received. */
+    uint32_t dataLen;           /**< length of the data in bytes. */
+} CAReceivedPacket_t;
+
+/**
+ * This will be used during the receive of several packets read at once, so that they
+ * are handed on together.
+ * @see CANetworkPacketReceivedCallback
+ */
+typedef void (*CANetworkPacketBatchReceivedCallback)(const CAReceivedPacket_t *packets,
+                                                     uint32_t count);
+
 /**
  * This will be used to notify network changes to the connectivity common logic layer.
  * @see SendUnicastData(), SendMulticastData()
@@ -32,6 +32,16 @@
  */
 #define MAX_SUPPORTED_ADAPTERS 2
 
+/**
+ * Number of DTLS sessions kept for resumption unless configured otherwise.
+ */
+#define CA_DTLS_SESSION_CACHE_SIZE 16
+
+/**
+ * Seconds a DTLS session can be resumed unless configured otherwise.
+ */
+#define CA_DTLS_SESSION_LIFETIME 3600
+
 typedef void (*CAPacketReceivedCallback)(const CASecureEndpoint_t *sep,
                                          const void *data, uint32_t dataLength);
 
@@ -149,6 +159,25 @@ CAResult_t CADtlsSelectCipherSuite(const dtls_cipher_t cipher);
  */
 CAResult_t CADtlsEnableAnonECDHCipherSuite(const bool enable);
 
+/**
+ * Configure the cache of resumable DTLS sessions
+ *
+ * @param[in] capacity  maximum number of cached sessions, 0 disables resumption
+ * @param[in] lifetime  seconds a session can be resumed
+ *
+ * @retval  ::CA_STATUS_OK for success, otherwise some error value
+ */
+CAResult_t CADtlsSetSessionCache(size_t capacity, uint32_t lifetime);
+
+/**
+ * Get the DTLS handshake statistics
+ *
+ * @param[out] stats  handshake statistics
+ *
+ * @retval  ::CA_STATUS_OK for success, otherwise some error value
+ */
+CAResult_t CADtlsGetSessionStats(CADtlsSessionStats_t *stats);
+
 /**
  * Initiate DTLS handshake with selected cipher suite
  *
@@ -33,6 +33,7 @@
 #include "camutex.h"
 #include "uarraylist.h"
 #include "cacommon.h"
+#include "oic_hash.h"
 #include "caprotocolmessage.h"
 
 /**
@@ -58,8 +59,8 @@ typedef struct
     /** callback function for received message. **/
     CAReceiveThreadFunc receivedThreadFunc;
 
-    /** array list on which the thread is operating. **/
-    u_arraylist_t *dataList;
+    /** hash table of block data, keyed by ::CABlockDataID_t. **/
+    OICHashTable_t dataTable;
 
     /** data list mutex for synchronization. **/
     ca_mutex blockDataListMutex;
@@ -80,7 +81,7 @@ typedef struct
 /**
  * Block Data Set.
  */
-typedef struct
+typedef struct CABlockData
 {
     coap_block_t block1;                /**< block1 option. */
     coap_block_t block2;                /**< block2 option. */
@@ -90,6 +91,8 @@ typedef struct
     CAPayload_t payload;                /**< payload buffer. */
     size_t payloadLength;               /**< the total payload length to be received. */
     size_t receivedPayloadLen;          /**< currently received payload length. */
+    size_t payloadCapacity;             /**< allocated size of the payload buffer. */
+    OICHashLink_t link;                 /**< link in the block data hash table. */
 } CABlockData_t;
 
 /**
@@ -455,6 +458,17 @@ CAData_t *CACloneCAData(const CAData_t *data);
 CAResult_t CAUpdatePayloadToCAData(CAData_t *data, const CAPayload_t payload,
                                    size_t payloadLen);
 
+/**
+ * Replace the payload of the input information with the given buffer.
+ * Unlike ::CAUpdatePayloadToCAData, the buffer is not copied and data takes
+ * ownership of it.
+ * @param[in]   data    CAData information that needs to be updated.
+ * @param[in]   payload reassembled payload allocated with OICMalloc.
+ * @param[in]   payloadLen  received full payload length.
+ * @return ::CASTATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAMovePayloadToCAData(CAData_t *data, CAPayload_t payload, size_t payloadLen);
+
 /**
  * Get payload and payload length from the input information.
  * @param[in]   data    CAData information.
@@ -529,6 +543,16 @@ coap_block_t *CAGetBlockOption(const CABlockDataID_t *blockID,
 CAPayload_t CAGetPayloadFromBlockDataList(const CABlockDataID_t *blockID,
                                           size_t *fullPayloadLen);
 
+/**
+ * Take the full payload out of block-wise list. The caller owns the returned
+ * buffer, so this is meant for block data that is removed right afterwards.
+ * @param[in]   blockID     ID set of CABlockData.
+ * @param[out]  fullPayloadLen  received full payload length.
+ * @return payload.
+ */
+CAPayload_t CATakePayloadFromBlockDataList(const CABlockDataID_t *blockID,
+                                           size_t *fullPayloadLen);
+
 /**
  * Create the block data from given data and add the data in block-wise transfer list.
  * @param[in]   sendData    data to be added to a list.
@@ -59,6 +59,14 @@ void CAInitializeAdapters(ca_thread_pool_t handle);
  */
 void CASetPacketReceivedCallback(CANetworkPacketReceivedCallback callback);
 
+/**
+ * Set the callback for packets an adapter reads several at once. Without one they
+ * are given to the callback of CASetPacketReceivedCallback() one by one.
+ * @param[in]   callback         message handler callback to receive packets
+ *                               from different adapters.
+ */
+void CASetPacketBatchReceivedCallback(CANetworkPacketBatchReceivedCallback callback);
+
 /**
  * Set the error handler callback for message handler.
  * @param[in]   errorCallback    error handler callback from adapters
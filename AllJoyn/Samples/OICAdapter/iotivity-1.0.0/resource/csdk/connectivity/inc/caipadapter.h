@@ -53,6 +53,13 @@ CAResult_t CAInitializeIP(CARegisterConnectivityCallback registerCallback,
                           CANetworkChangeCallback netCallback,
                           CAErrorHandleCallback errorCallback, ca_thread_pool_t handle);
 
+/**
+ * Set the callback for packets the IP adapter reads several at once. Without one they
+ * are given to the networkPacketCallback of CAInitializeIP() one by one.
+ * @param[in] callback              Callback to notify the packets, NULL to unset it.
+ */
+void CASetIPPacketBatchReceivedCallback(CANetworkPacketBatchReceivedCallback callback);
+
 /**
  * Start IP Interface adapter.
  * @return  ::CA_STATUS_OK or Appropriate error code.
@@ -29,6 +29,7 @@
 #include <stdbool.h>
 
 #include "cacommon.h"
+#include "caadapterinterface.h"
 #include "cathreadpool.h"
 #include "uarraylist.h"
 
@@ -59,6 +60,16 @@ typedef void (*CAIPPacketReceivedCallback)(const CASecureEndpoint_t *sep,
                                            const void *data,
                                            uint32_t dataLength);
 
+/**
+ * Callback to be notified on reception of several data read at once.
+ *
+ * @param[in]  packets       Data received from remote OIC devices.
+ * @param[in]  count         Number of packets.
+ * @pre  Callback must be registered using CAIPSetPacketBatchReceiveCallback().
+ */
+typedef void (*CAIPPacketBatchReceivedCallback)(const CAReceivedPacket_t *packets,
+                                                uint32_t count);
+
 /**
   * Callback to notify error in the IP adapter.
   *
@@ -122,6 +133,14 @@ CAResult_t CAIPStopListenServer();
  */
 void CAIPSetPacketReceiveCallback(CAIPPacketReceivedCallback callback);
 
+/**
+ * Set this callback for receiving several data packets read at once.
+ * Without one they are given to the callback of CAIPSetPacketReceiveCallback() one by one.
+ *
+ * @param[in]  callback    Callback to be notified on reception of unicast/multicast data packets.
+ */
+void CAIPSetPacketBatchReceiveCallback(CAIPPacketBatchReceivedCallback callback);
+
 /**
  * Set this callback for receiving exception notifications.
  *
@@ -53,6 +53,7 @@ typedef struct
     CAResponseInfo_t *responseInfo;
     CAErrorInfo_t *errorInfo;
     CADataType_t dataType;
+    struct CAReceivedData *receivedData; /**< set if the info borrows a received pdu */
 } CAData_t;
 
 #ifdef __cplusplus
@@ -126,6 +127,38 @@ void CATerminateMessageHandler();
  */
 void CAHandleRequestResponseCallbacks();
 
+/**
+ * Waits until received data is queued for ::CAHandleRequestResponseCallbacks.
+ * @param[in] timeout    maximum time to wait in milliseconds, UINT32_MAX to
+ *                       wait until data is received or signaled.
+ * @return  ::CA_STATUS_OK if data is queued or ::CASignalReceivedData was called,
+ *          ::CA_REQUEST_TIMEOUT if the timeout elapsed and ::CA_NOT_SUPPORTED
+ *          if received data is not queued in this build.
+ */
+CAResult_t CAWaitForReceivedData(uint32_t timeout);
+
+/**
+ * Ends the current or next ::CAWaitForReceivedData.
+ */
+void CASignalReceivedData();
+
+/**
+ * Sets how many messages the send and receive queues accept each and what
+ * happens to messages added while they are full.
+ * @param[in] capacity   most messages a queue accepts.
+ * @param[in] policy     what to do with messages added while a queue is full.
+ * @return  ::CA_STATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CASetSendReceiveQueueLimit(uint32_t capacity, CAQueueOverflowPolicy_t policy);
+
+/**
+ * Gets the statistics of the send and receive queues.
+ * @param[out] sendStats      statistics of the send queue, may be NULL.
+ * @param[out] receiveStats   statistics of the receive queue, may be NULL.
+ * @return  ::CA_STATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAGetSendReceiveQueueStats(CAQueueStats_t *sendStats, CAQueueStats_t *receiveStats);
+
 /**
  * To log the PDU data.
  * @param[in] pdu    pdu data.
@@ -133,6 +166,33 @@ void CAHandleRequestResponseCallbacks();
  */
 void CALogPDUInfo(coap_pdu_t *pdu, const CAEndpoint_t *endpoint);
 
+/**
+ * Generates the data for a received request or response. The info is not
+ * copied out of pdu but points into it, and pdu is owned by the returned
+ * data, which is released with the last ::CAReleaseReceivedData.
+ * @param[in] endpoint    endpoint the pdu was received from.
+ * @param[in] identity    identity of the remote endpoint, may be NULL.
+ * @param[in] pdu         received pdu, deleted with the data on success.
+ * @param[in] dataType    ::CA_REQUEST_DATA or ::CA_RESPONSE_DATA.
+ * @return  received data with a reference count of 1, NULL on failure.
+ */
+CAData_t *CAGenerateReceivedData(const CAEndpoint_t *endpoint, const CARemoteId_t *identity,
+                                 coap_pdu_t *pdu, CADataType_t dataType);
+
+/**
+ * Takes another reference on received data, e.g. for the receive queue.
+ * @param[in] data    data made by ::CAGenerateReceivedData.
+ * @return  data.
+ */
+CAData_t *CAHoldReceivedData(CAData_t *data);
+
+/**
+ * Drops a reference on received data. The last one frees the data and the
+ * pdu it points into.
+ * @param[in] data    data made by ::CAGenerateReceivedData.
+ */
+void CAReleaseReceivedData(CAData_t *data);
+
 #ifdef WITH_BWT
 /**
  * Add the data to the send queue thread.
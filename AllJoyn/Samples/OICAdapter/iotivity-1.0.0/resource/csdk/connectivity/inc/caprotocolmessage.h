@@ -181,6 +181,31 @@ uint32_t CAGetOptionData(uint16_t key, const uint8_t *data, uint32_t len,
 CAResult_t CAGetInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
                             uint32_t *outCode, CAInfo_t *outInfo);
 
+/**
+ * gets the size of the storage CAGetBorrowedInfoFromPDU needs for pdu.
+ * @param[in]    pdu                  received pdu.
+ * @param[in]    endpoint             endpoint information.
+ * @return  storage size in bytes, 0 on invalid parameters.
+ */
+size_t CAGetBorrowedInfoSize(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint);
+
+/**
+ * extracts request information from received pdu without copying it.
+ * token and payload of outInfo point into pdu, header options and resource
+ * uri are placed in storage. outInfo is valid as long as pdu and storage are
+ * and must not be freed with CADestroyInfo.
+ * @param[in]    pdu                  received pdu.
+ * @param[in]    endpoint             endpoint information.
+ * @param[out]   outCode              code of the received pdu.
+ * @param[out]   outInfo              request info structure made from received pdu.
+ * @param[in]    storage              storage for header options and uri.
+ * @param[in]    storageSize          size of storage, see CAGetBorrowedInfoSize.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAGetBorrowedInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
+                                    uint32_t *outCode, CAInfo_t *outInfo,
+                                    void *storage, size_t storageSize);
+
 /**
  * create pdu from received data.
  * @param[in]   data                received data.
@@ -31,19 +31,41 @@
 
 #include "cathreadpool.h"
 #include "camutex.h"
-#include "uqueue.h"
 #include "cacommon.h"
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
+/** Most messages a queue accepts unless another limit is set. **/
+#define CA_QUEUEING_THREAD_DEFAULT_CAPACITY (1024)
+
+/** Most messages the thread takes from the queue at once. **/
+#define CA_QUEUEING_THREAD_BATCH_SIZE (16)
+
+/** Longest time a sender waits for room with ::CA_QUEUE_BLOCK, in microseconds. **/
+#define CA_QUEUEING_THREAD_BLOCK_TIMEOUT (1000000)
+
 /** Thread function to be invoked. **/
 typedef void (*CAThreadTask)(void *threadData);
 
 /** Data destroy function. **/
 typedef void (*CADataDestroyFunction)(void *data, uint32_t size);
 
+/** Tells whether data may be dropped to make room, i.e. is a non-confirmable message. **/
+typedef bool (*CADataDropCheckFunction)(const void *data, uint32_t size);
+
+/** Data in the queue. **/
+typedef struct
+{
+    /** data given to the thread function. **/
+    void *data;
+    /** length of the data. **/
+    uint32_t size;
+    /** time the data was added, in microseconds. **/
+    uint64_t addTime;
+} CAQueueingThreadItem_t;
+
 typedef struct
 {
     /** Thread pool of the thread started. **/
@@ -52,18 +74,40 @@ typedef struct
     ca_mutex threadMutex;
     /** conditional mutex for synchronization. **/
     ca_cond threadCond;
+    /** signaled when room is made for senders waiting with ::CA_QUEUE_BLOCK. **/
+    ca_cond spaceCond;
     /** Thread function to be invoked. **/
     CAThreadTask threadTask;
     /** Data destroy function. **/
     CADataDestroyFunction destroy;
+    /** Tells which data may be dropped, NULL if none may. **/
+    CADataDropCheckFunction dropCheck;
     /** Variable to inform the thread to stop. **/
     bool isStop;
-    /** Que on which the thread is operating. **/
-    u_queue_t *dataQueue;
+    /** Set from start until the thread routine has finished. **/
+    bool isRunning;
+    /** Ring of queued data, in the order it was added; grows by doubling. **/
+    CAQueueingThreadItem_t *items;
+    /** Number of slots of the ring; always a power of two. **/
+    uint32_t itemsSize;
+    /** Slot of the oldest data. **/
+    uint32_t head;
+    /** Number of queued data. **/
+    uint32_t count;
+    /** Most data the queue accepts. **/
+    uint32_t capacity;
+    /** What to do with data added while the queue is full. **/
+    CAQueueOverflowPolicy_t overflowPolicy;
+    /** Number of senders waiting for room. **/
+    uint32_t blockedSenders;
+    /** Statistics; depth and capacity are filled in when they are read. **/
+    CAQueueStats_t stats;
 } CAQueueingThread_t;
 
 /**
  * Initializes the queuing thread.
+ * The queue accepts ::CA_QUEUEING_THREAD_DEFAULT_CAPACITY data and drops the oldest
+ * non-confirmable data when it is full, see ::CAQueueingThreadSetLimit.
  * @param[in]   thread       thread data for each thread.
  * @param[in]   handle       thread pool handle created.
  * @param[in]   task         function to be called for each data.
@@ -82,13 +126,67 @@ CAResult_t CAQueueingThreadStart(CAQueueingThread_t *thread);
 
 /**
  * Add queuing thread data for new thread.
+ * The queue owns the data from then on; data that is not queued is destroyed.
  * @param[in]   thread       thread data for new thread control.
  * @param[in]   data         data that needs to be given for each thread.
  * @param[in]   size         length of the data.
- * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ * @return  CA_STATUS_OK, CA_STATUS_FAILED if the queue is full or other ERROR CODES
+ *          (CAResult_t error codes in cacommon.h).
  */
 CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint32_t size);
 
+/**
+ * Add several data at once, taking the lock and waking the thread only once.
+ * The queue owns the data from then on; data that is not queued is destroyed.
+ * @param[in]   thread       thread data for new thread control.
+ * @param[in]   items        data and lengths to add, oldest first; used as scratch.
+ * @param[in]   count        number of items.
+ * @return  CA_STATUS_OK if all data was queued, otherwise the error of the last data
+ *          that was not (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAQueueingThreadAddDataBatch(CAQueueingThread_t *thread,
+                                        CAQueueingThreadItem_t *items, uint32_t count);
+
+/**
+ * Take the oldest queued data without waiting, for a queue that is read by the caller
+ * instead of a started thread.  The data has to be destroyed by the caller.
+ * @param[in]   thread       thread data.
+ * @param[out]  items        the data taken, oldest first.
+ * @param[in]   count        most data to take.
+ * @return  number of data taken.
+ */
+uint32_t CAQueueingThreadTakeData(CAQueueingThread_t *thread, CAQueueingThreadItem_t *items,
+                                  uint32_t count);
+
+/**
+ * Set how much data the queue accepts and what happens to data added while it is full.
+ * Data queued beyond a lowered capacity stays queued.
+ * @param[in]   thread       thread data.
+ * @param[in]   capacity     most data the queue accepts; at least 1.
+ * @param[in]   policy       what to do with data added while the queue is full.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAQueueingThreadSetLimit(CAQueueingThread_t *thread, uint32_t capacity,
+                                    CAQueueOverflowPolicy_t policy);
+
+/**
+ * Set the function telling which data ::CA_QUEUE_DROP_OLDEST_NON may drop.
+ * Without one no data is dropped and full queues reject new data.
+ * @param[in]   thread       thread data.
+ * @param[in]   dropCheck    function telling whether data may be dropped.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAQueueingThreadSetDropCheck(CAQueueingThread_t *thread,
+                                        CADataDropCheckFunction dropCheck);
+
+/**
+ * Get the statistics of the queue.
+ * @param[in]   thread       thread data.
+ * @param[out]  stats        the statistics.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAQueueingThreadGetStats(CAQueueingThread_t *thread, CAQueueStats_t *stats);
+
 /**
  * Stop the queuing thread.
  * @param[in]   thread       thread data that needs to be started.
@@ -98,7 +196,7 @@ CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint3
 CAResult_t CAQueueingThreadStop(CAQueueingThread_t *thread);
 
 /**
- * Terminate the queuing thread.
+ * Terminate the queuing thread.  Data still queued is destroyed.
  * @param[in]   thread       thread data for each thread.
  * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
  */
@@ -110,4 +208,3 @@ CAResult_t CAQueueingThreadDestroy(CAQueueingThread_t *thread);
 #endif
 
 #endif  /* CA_QUEUEING_THREAD_H_ */
-
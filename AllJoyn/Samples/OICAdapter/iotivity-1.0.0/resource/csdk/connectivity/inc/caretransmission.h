@@ -30,8 +30,8 @@
 
 #include "cathreadpool.h"
 #include "camutex.h"
-#include "uarraylist.h"
 #include "cacommon.h"
+#include "oic_hash.h"
 
 /** IP, EDR, LE. **/
 #define DEFAULT_RETRANSMISSION_TYPE (CA_ADAPTER_IP | \
@@ -44,8 +44,31 @@
 /** default max retransmission trying count is 4(CoAP). **/
 #define DEFAULT_RETRANSMISSION_COUNT      4
 
-/** check period is 1 sec. **/
-#define RETRANSMISSION_CHECK_PERIOD_SEC     1
+#ifdef SINGLE_THREAD
+/** number of bits per timer wheel level. **/
+#define CA_RETRANSMISSION_WHEEL_BITS    3
+
+/** timer wheel tick is 250 msec. **/
+#define CA_RETRANSMISSION_TICK_USEC     250000
+
+/** number of pending data the message id hash table is first sized for. **/
+#define CA_RETRANSMISSION_HASH_SIZE     4
+#else
+/** number of bits per timer wheel level. **/
+#define CA_RETRANSMISSION_WHEEL_BITS    6
+
+/** timer wheel tick is 1/32 sec. **/
+#define CA_RETRANSMISSION_TICK_USEC     31250
+
+/** number of pending data the message id hash table is first sized for. **/
+#define CA_RETRANSMISSION_HASH_SIZE     64
+#endif
+
+/** number of slots per timer wheel level. **/
+#define CA_RETRANSMISSION_WHEEL_SIZE    (1 << CA_RETRANSMISSION_WHEEL_BITS)
+
+/** number of timer wheel levels. **/
+#define CA_RETRANSMISSION_WHEEL_LEVELS  2
 
 /** retransmission data send method type. **/
 typedef CAResult_t (*CADataSendMethod_t)(const CAEndpoint_t *endpoint,
@@ -67,6 +90,19 @@ typedef struct
 
 } CARetransmissionConfig_t;
 
+/** pending retransmission data, defined in caretransmission.c. **/
+typedef struct CARetransmissionData CARetransmissionData_t;
+
+typedef struct
+{
+    /** next tick to be processed. **/
+    uint64_t currentTick;
+
+    /** level 0 holds data expiring within one round, level 1 the rest. **/
+    CARetransmissionData_t *slots[CA_RETRANSMISSION_WHEEL_LEVELS][CA_RETRANSMISSION_WHEEL_SIZE];
+
+} CARetransmissionWheel_t;
+
 typedef struct
 {
     /** Thread pool of the thread started. **/
@@ -90,8 +126,14 @@ typedef struct
     /** Variable to inform the thread to stop. **/
     bool isStop;
 
-    /** array list on which the thread is operating. **/
-    u_arraylist_t *dataList;
+    /** timer wheel ordering the pending data by next retransmission time. **/
+    CARetransmissionWheel_t wheel;
+
+    /** hash table of the pending data keyed by endpoint and message id. **/
+    OICHashTable_t hashTable;
+
+    /** number of pending retransmission data. **/
+    uint32_t count;
 
 } CARetransmission_t;
 
@@ -170,6 +212,12 @@ CAResult_t CARetransmissionDestroy(CARetransmission_t *context);
  */
 void CARetransmissionBaseRoutine(void *threadValue);
 
+/**
+ * Get the current time.
+ * @return  monotonic time in microseconds.
+ */
+uint64_t getCurrentTimeInMicroSeconds();
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
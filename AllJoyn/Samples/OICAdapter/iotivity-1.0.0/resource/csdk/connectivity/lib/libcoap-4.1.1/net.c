@@ -151,11 +151,16 @@ int print_wellknown(coap_context_t *, unsigned char *, size_t *, size_t, coap_op
 
 void coap_handle_failed_notify(coap_context_t *, const coap_address_t *, const str *);
 
+static void coap_sendwheel_advance(coap_context_t *context, coap_tick_t now);
+
 unsigned int coap_adjust_basetime(coap_context_t *ctx, coap_tick_t now)
 {
     unsigned int result = 0;
     coap_tick_diff_t delta = now - ctx->sendqueue_basetime;
 
+    /* everything that has timed out must be in the sendqueue to be counted */
+    coap_sendwheel_advance(ctx, now);
+
     if (ctx->sendqueue)
     {
         /* delta < 0 means that the new time stamp is before the old. */
@@ -273,12 +278,392 @@ coap_new_node()
     return node;
 }
 
+/** Initial number of buckets of the transaction index. */
+#define COAP_TRANSACTION_BUCKETS 16
+
+/** Spreads the bits of hash value @p x for use as bucket index. */
+static inline unsigned int coap_hash_mix(unsigned int x)
+{
+    x ^= x >> 16;
+    x *= 0x45d9f3bU;
+    x ^= x >> 16;
+    return x;
+}
+
+static inline unsigned int coap_transaction_id_bucket(coap_context_t *context, coap_tid_t id)
+{
+    return coap_hash_mix((unsigned int)id) & (context->transaction_buckets - 1);
+}
+
+static inline unsigned int coap_transaction_token_bucket(coap_context_t *context,
+        const coap_queue_t *node)
+{
+    return coap_peer_token_hash(&node->remote, node->pdu->hdr->coap_hdr_udp_t.token,
+            node->pdu->hdr->coap_hdr_udp_t.token_length) & (context->transaction_buckets - 1);
+}
+
+static void coap_transactions_link(coap_context_t *context, coap_queue_t *node)
+{
+    unsigned int b;
+
+    b = coap_transaction_id_bucket(context, node->id);
+    node->id_next = context->transaction_ids[b];
+    context->transaction_ids[b] = node;
+
+    b = coap_transaction_token_bucket(context, node);
+    node->token_next = context->transaction_tokens[b];
+    context->transaction_tokens[b] = node;
+}
+
+/**
+ * Makes room for one more transaction in the index of @p context.
+ * This function returns @c 0 only if @p context has no index and none
+ * could be allocated. A full index is still used when it cannot grow.
+ */
+static int coap_transactions_reserve(coap_context_t *context)
+{
+    coap_queue_t **table, **old, *node, *next;
+    unsigned int buckets, old_buckets, i;
+
+    if (context->transaction_ids && context->transaction_count < context->transaction_buckets)
+        return 1;
+
+    buckets = context->transaction_buckets ?
+            context->transaction_buckets << 1 : COAP_TRANSACTION_BUCKETS;
+    table = (coap_queue_t **)coap_malloc(2 * buckets * sizeof(coap_queue_t *));
+    if (!table)
+    {
+        debug("coap_transactions_reserve: insufficient memory\n");
+        return context->transaction_ids != NULL;
+    }
+    memset(table, 0, 2 * buckets * sizeof(coap_queue_t *));
+
+    old = context->transaction_ids;
+    old_buckets = context->transaction_buckets;
+    context->transaction_ids = table;
+    context->transaction_tokens = table + buckets;
+    context->transaction_buckets = buckets;
+
+    /* every transaction is in exactly one id bucket */
+    for (i = 0; i < old_buckets; i++)
+    {
+        for (node = old[i]; node; node = next)
+        {
+            next = node->id_next;
+            coap_transactions_link(context, node);
+        }
+    }
+    coap_free(old);
+    return 1;
+}
+
+static void coap_transactions_unlink(coap_context_t *context, coap_queue_t *node)
+{
+    coap_queue_t **p;
+
+    if (!context->transaction_ids)
+        return;
+
+    for (p = &context->transaction_ids[coap_transaction_id_bucket(context, node->id)]; *p;
+            p = &(*p)->id_next)
+    {
+        if (*p == node)
+        {
+            *p = node->id_next;
+            context->transaction_count--;
+            break;
+        }
+    }
+
+    for (p = &context->transaction_tokens[coap_transaction_token_bucket(context, node)]; *p;
+            p = &(*p)->token_next)
+    {
+        if (*p == node)
+        {
+            *p = node->token_next;
+            break;
+        }
+    }
+    node->id_next = node->token_next = NULL;
+}
+
+/** Inserts @p node that is due at tick @p due into the sendqueue. */
+static void coap_sendqueue_enqueue(coap_context_t *context, coap_queue_t *node, coap_tick_t due)
+{
+    coap_tick_diff_t t = due - context->sendqueue_basetime;
+
+    node->t = t > 0 ? t : 0;
+    node->wheel_slot = 0;
+    node->next = node->prev = NULL;
+    coap_insert_node(&context->sendqueue, node);
+}
+
+/**
+ * Schedules @p node that is due at tick @p due. Nodes due before the
+ * current send wheel slot go to the sendqueue, all others to the slot
+ * of their due time.
+ */
+static void coap_sendqueue_schedule(coap_context_t *context, coap_queue_t *node, coap_tick_t due)
+{
+    coap_tick_diff_t ahead = due - context->sendwheel_time;
+    unsigned int slot;
+
+    if (ahead < 0)
+    {
+        coap_sendqueue_enqueue(context, node, due);
+        return;
+    }
+
+    slot = (context->sendwheel_pos + ahead / COAP_SENDWHEEL_TICKS) & (COAP_SENDWHEEL_SIZE - 1);
+    node->t = due;
+    node->prev = NULL;
+    node->next = context->sendwheel[slot];
+    if (node->next)
+    {
+        node->next->prev = node;
+    }
+    context->sendwheel[slot] = node;
+    node->wheel_slot = slot + 1;
+    context->sendwheel_count++;
+}
+
+/** Removes @p node from the sendqueue or the send wheel. */
+static void coap_sendqueue_unschedule(coap_context_t *context, coap_queue_t *node)
+{
+    coap_queue_t *p, *q;
+
+    if (node->wheel_slot)
+    {
+        if (node->prev)
+            node->prev->next = node->next;
+        else
+            context->sendwheel[node->wheel_slot - 1] = node->next;
+        if (node->next)
+            node->next->prev = node->prev;
+        node->wheel_slot = 0;
+        context->sendwheel_count--;
+    }
+    else
+    {
+        /* the sendqueue only holds the transactions due next */
+        for (p = NULL, q = context->sendqueue; q && q != node; p = q, q = q->next)
+            ;
+        if (!q)
+            return;
+
+        if (p)
+            p->next = node->next;
+        else
+            context->sendqueue = node->next;
+        if (node->next)
+        { /* must update relative time of node->next */
+            node->next->t += node->t;
+        }
+    }
+    node->next = node->prev = NULL;
+}
+
+/**
+ * Schedules the new or retransmitted transaction @p node to be due
+ * @p timeout ticks after @p now and adds it to the transaction index.
+ */
+static void coap_sendqueue_add(coap_context_t *context, coap_queue_t *node, coap_tick_t now,
+        coap_tick_t timeout)
+{
+    if (!context->sendqueue && !context->sendwheel_count)
+    {
+        context->sendqueue_basetime = now;
+    }
+
+    /* an empty wheel can start anywhere after the sendqueue */
+    if (!context->sendwheel_count && (coap_tick_diff_t)(now - context->sendwheel_time) > 0)
+    {
+        context->sendwheel_time = now;
+    }
+
+    coap_sendqueue_schedule(context, node, now + timeout);
+
+    if (context->transaction_ids)
+    {
+        coap_transactions_link(context, node);
+        context->transaction_count++;
+    }
+}
+
+/** Sorts @p list of nodes with absolute due times by due time. */
+static coap_queue_t *coap_sort_by_due(coap_queue_t *list)
+{
+    coap_queue_t *a, *b, *slow, *fast, *head, **tail;
+
+    if (!list || !list->next)
+        return list;
+
+    for (slow = list, fast = list->next; fast && fast->next; fast = fast->next->next)
+        slow = slow->next;
+    b = slow->next;
+    slow->next = NULL;
+    a = coap_sort_by_due(list);
+    b = coap_sort_by_due(b);
+
+    for (tail = &head; a && b; tail = &(*tail)->next)
+    {
+        if ((coap_tick_diff_t)(b->t - a->t) < 0)
+        {
+            *tail = b;
+            b = b->next;
+        }
+        else
+        {
+            *tail = a;
+            a = a->next;
+        }
+    }
+    *tail = a ? a : b;
+    return head;
+}
+
+/**
+ * Moves @p batch of nodes with absolute due times to the sendqueue in
+ * a single pass over both.
+ */
+static void coap_sendqueue_merge(coap_context_t *context, coap_queue_t *batch)
+{
+    coap_queue_t **p = &context->sendqueue, *next;
+    coap_tick_t at = context->sendqueue_basetime; /* due time of the node before *p */
+    coap_tick_diff_t t;
+
+    for (batch = coap_sort_by_due(batch); batch; batch = next)
+    {
+        next = batch->next;
+        t = batch->t - at;
+        if (t < 0)
+            t = 0;
+
+        /* like coap_insert_node(), insert after nodes with the same time */
+        while (*p && (*p)->t <= (coap_tick_t) t)
+        {
+            t -= (*p)->t;
+            at += (*p)->t;
+            p = &(*p)->next;
+        }
+
+        batch->t = t;
+        batch->next = *p;
+        if (*p)
+            (*p)->t -= t; /* make (*p)->t relative to batch->t */
+        *p = batch;
+
+        at += t;
+        p = &batch->next;
+    }
+}
+
+/** Moves the nodes of the current send wheel slot to the sendqueue and starts the next slot. */
+static void coap_sendwheel_step(coap_context_t *context)
+{
+    coap_tick_t end = context->sendwheel_time + COAP_SENDWHEEL_TICKS;
+    coap_queue_t *node, *next, *batch = NULL;
+
+    for (node = context->sendwheel[context->sendwheel_pos]; node; node = next)
+    {
+        next = node->next;
+        /* nodes of later rounds stay */
+        if ((coap_tick_diff_t)(node->t - end) < 0)
+        {
+            coap_sendqueue_unschedule(context, node);
+            node->next = batch;
+            batch = node;
+        }
+    }
+    coap_sendqueue_merge(context, batch);
+
+    context->sendwheel_time = end;
+    context->sendwheel_pos = (context->sendwheel_pos + 1) & (COAP_SENDWHEEL_SIZE - 1);
+}
+
+/** Moves every node of the send wheel that is due at tick @p now to the sendqueue. */
+static void coap_sendwheel_advance(coap_context_t *context, coap_tick_t now)
+{
+    const coap_tick_t round = COAP_SENDWHEEL_SIZE * COAP_SENDWHEEL_TICKS;
+    coap_tick_diff_t behind = now - context->sendwheel_time;
+    coap_queue_t *node, *next, *batch = NULL;
+    unsigned int i;
+
+    if (behind < 0)
+        return;
+
+    if (!context->sendwheel_count)
+    {
+        context->sendwheel_time += (behind / COAP_SENDWHEEL_TICKS + 1) * COAP_SENDWHEEL_TICKS;
+        return;
+    }
+
+    if ((coap_tick_t) behind >= round)
+    {
+        /* more than a round behind: take the due nodes of all slots at once
+         * and skip the rounds that have passed */
+        for (i = 0; i < COAP_SENDWHEEL_SIZE; i++)
+        {
+            for (node = context->sendwheel[i]; node; node = next)
+            {
+                next = node->next;
+                if ((coap_tick_diff_t)(node->t - now) <= 0)
+                {
+                    coap_sendqueue_unschedule(context, node);
+                    node->next = batch;
+                    batch = node;
+                }
+            }
+        }
+        coap_sendqueue_merge(context, batch);
+        context->sendwheel_time += (behind / round) * round;
+    }
+
+    while ((coap_tick_diff_t)(now - context->sendwheel_time) >= 0)
+    {
+        coap_sendwheel_step(context);
+    }
+}
+
+/** Moves the earliest nodes of the send wheel to the sendqueue if that is empty. */
+static void coap_sendwheel_refill(coap_context_t *context)
+{
+    const coap_tick_t round = COAP_SENDWHEEL_SIZE * COAP_SENDWHEEL_TICKS;
+    coap_tick_diff_t earliest, ahead;
+    coap_queue_t *node;
+    unsigned int steps = 0, i;
+
+    while (!context->sendqueue && context->sendwheel_count)
+    {
+        if (steps++ == COAP_SENDWHEEL_SIZE)
+        {
+            /* a whole round was empty: skip to the round of the earliest node */
+            earliest = -1;
+            for (i = 0; i < COAP_SENDWHEEL_SIZE; i++)
+            {
+                for (node = context->sendwheel[i]; node; node = node->next)
+                {
+                    ahead = node->t - context->sendwheel_time;
+                    if (earliest < 0 || ahead < earliest)
+                        earliest = ahead;
+                }
+            }
+            context->sendwheel_time += (earliest / round) * round;
+            steps = 0;
+        }
+        coap_sendwheel_step(context);
+    }
+}
+
 coap_queue_t *
 coap_peek_next(coap_context_t *context)
 {
-    if (!context || !context->sendqueue)
+    if (!context)
         return NULL;
 
+    if (!context->sendqueue)
+        coap_sendwheel_refill(context);
+
     return context->sendqueue;
 }
 
@@ -287,7 +672,7 @@ coap_pop_next(coap_context_t *context)
 {
     coap_queue_t *next;
 
-    if (!context || !context->sendqueue)
+    if (!coap_peek_next(context))
         return NULL;
 
     next = context->sendqueue;
@@ -297,6 +682,7 @@ coap_pop_next(coap_context_t *context)
         context->sendqueue->t += next->t;
     }
     next->next = NULL;
+    coap_transactions_unlink(context, next);
     return next;
 }
 
@@ -459,11 +845,21 @@ void coap_free_context(coap_context_t *context)
     coap_resource_t *rtmp;
 #endif
 #endif /* WITH_POSIX || WITH_LWIP */
+    unsigned int i;
+
     if (!context)
         return;
 
     coap_delete_all(context->recvqueue);
+    for (i = 0; i < COAP_SENDWHEEL_SIZE; i++)
+    {
+        coap_delete_all(context->sendwheel[i]);
+        context->sendwheel[i] = NULL;
+    }
+    context->sendwheel_count = 0;
     coap_delete_all(context->sendqueue);
+    coap_free(context->transaction_ids);
+    context->transaction_ids = context->transaction_tokens = NULL;
 
 #ifdef WITH_LWIP
     context->sendqueue = NULL;
@@ -481,6 +877,9 @@ void coap_free_context(coap_context_t *context)
             coap_delete_resource(context, res->key);
         }
 #endif /* WITH_POSIX || WITH_LWIP */
+#ifndef WITHOUT_OBSERVE
+    coap_free(context->observers);
+#endif /* WITHOUT_OBSERVE */
 
 #if defined(WITH_POSIX) || defined(WIN32)
     /* coap_delete_list(context->subscriptions); */
@@ -531,12 +930,13 @@ int coap_option_check_critical(coap_context_t *ctx, coap_pdu_t *pdu, coap_opt_fi
     return ok;
 }
 
-void coap_transaction_id(const coap_address_t *peer, const coap_pdu_t *pdu, coap_tid_t *id)
+/**
+ * Adds the transport address of @p peer to the hash key @p h. This
+ * function returns @c 0 if the address family of @p peer is unknown,
+ * @c 1 otherwise.
+ */
+static int coap_hash_address(const coap_address_t *peer, coap_key_t h)
 {
-    coap_key_t h;
-
-    memset(h, 0, sizeof(coap_key_t));
-
     /* Compare the complete address structure in case of IPv4. For IPv6,
      * we need to look at the transport address only. */
 
@@ -553,7 +953,7 @@ void coap_transaction_id(const coap_address_t *peer, const coap_pdu_t *pdu, coap
                 sizeof(peer->addr.sin6.sin6_addr), h);
         break;
         default:
-        return;
+        return 0;
     }
 #endif
 
@@ -567,11 +967,37 @@ void coap_transaction_id(const coap_address_t *peer, const coap_pdu_t *pdu, coap
     coap_hash((const unsigned char *)&peer->addr, sizeof(peer->addr), h);
 #endif /* WITH_LWIP || WITH_CONTIKI */
 
+    return 1;
+}
+
+void coap_transaction_id(const coap_address_t *peer, const coap_pdu_t *pdu, coap_tid_t *id)
+{
+    coap_key_t h;
+
+    memset(h, 0, sizeof(coap_key_t));
+
+    if (!coap_hash_address(peer, h))
+        return;
+
     coap_hash((const unsigned char *)&pdu->hdr->coap_hdr_udp_t.id, sizeof(unsigned short), h);
 
     *id = ((h[0] << 8) | h[1]) ^ ((h[2] << 8) | h[3]);
 }
 
+unsigned int coap_peer_token_hash(const coap_address_t *peer, const unsigned char *token,
+        size_t token_length)
+{
+    coap_key_t h;
+
+    memset(h, 0, sizeof(coap_key_t));
+
+    coap_hash_address(peer, h);
+    if (token_length)
+        coap_hash(token, token_length, h);
+
+    return coap_hash_mix((h[0] << 24) | (h[1] << 16) | (h[2] << 8) | h[3]);
+}
+
 coap_tid_t coap_send_ack(coap_context_t *context, const coap_address_t *dst, coap_pdu_t *request)
 {
     coap_pdu_t *response;
@@ -765,6 +1191,13 @@ coap_tid_t coap_send_confirmed(coap_context_t *context, const coap_address_t *ds
         return COAP_INVALID_TID;
     }
 
+    if (!coap_transactions_reserve(context))
+    {
+        debug("coap_send_confirmed: insufficient memory\n");
+        coap_free_node(node);
+        return COAP_INVALID_TID;
+    }
+
     node->id = coap_send_impl(context, dst, pdu);
     if (COAP_INVALID_TID == node->id)
     {
@@ -784,27 +1217,13 @@ coap_tid_t coap_send_confirmed(coap_context_t *context, const coap_address_t *ds
 
     /* Set timer for pdu retransmission. If this is the first element in
      * the retransmission queue, the base time is set to the current
-     * time and the retransmission time is node->timeout. If there is
-     * already an entry in the sendqueue, we must check if this node is
-     * to be retransmitted earlier. Therefore, node->timeout is first
-     * normalized to the base time and then inserted into the queue with
-     * an adjusted relative time.
+     * time. The node goes to the send wheel slot of its retransmission
+     * time, or to the sendqueue if it is due before the current slot.
      */coap_ticks(&now);
-    if (context->sendqueue == NULL)
-    {
-        node->t = node->timeout;
-        context->sendqueue_basetime = now;
-    }
-    else
-    {
-        /* make node->t relative to context->sendqueue_basetime */
-        node->t = (now - context->sendqueue_basetime) + node->timeout;
-    }
-
-    coap_insert_node(&context->sendqueue, node);
+    coap_sendqueue_add(context, node, now, node->timeout);
 
 #ifdef WITH_LWIP
-    if (node == context->sendqueue) /* don't bother with timer stuff if there are earlier retransmits */
+    if (node == coap_peek_next(context)) /* don't bother with timer stuff if there are earlier retransmits */
     coap_retransmittimer_restart(context);
 #endif
 
@@ -833,20 +1252,27 @@ coap_tid_t coap_retransmit(coap_context_t *context, coap_queue_t *node)
     /* re-initialize timeout when maximum number of retransmissions are not reached yet */
     if (node->retransmit_cnt < COAP_DEFAULT_MAX_RETRANSMIT)
     {
+        coap_tick_t now;
+
         node->retransmit_cnt++;
-        node->t = node->timeout << node->retransmit_cnt;
-        coap_insert_node(&context->sendqueue, node);
-#ifdef WITH_LWIP
-        /* don't bother with timer stuff if there are earlier retransmits */
-        if (node == context->sendqueue)
-        coap_retransmittimer_restart(context);
-#endif
 
         debug(
                 "** retransmission #%d of transaction %d\n", node->retransmit_cnt,
                 ntohs(node->pdu->hdr->coap_hdr_udp_t.id));
 
+        /* the id must be final before the node is indexed */
         node->id = coap_send_impl(context, &node->remote, node->pdu);
+
+        /* the timeout counts from now, not from the queue's base time */
+        coap_ticks(&now);
+        coap_transactions_reserve(context);
+        coap_sendqueue_add(context, node, now, node->timeout << node->retransmit_cnt);
+#ifdef WITH_LWIP
+        /* don't bother with timer stuff if there are earlier retransmits */
+        if (node == coap_peek_next(context))
+        coap_retransmittimer_restart(context);
+#endif
+
         return node->id;
     }
 
@@ -1080,41 +1506,25 @@ void coap_cancel_all_messages(coap_context_t *context, const coap_address_t *dst
 {
     /* cancel all messages in sendqueue that are for dst
      * and use the specified token */
-    coap_queue_t *p, *q;
+    coap_queue_t *q, *next;
+    unsigned int b;
 
     debug("cancel_all_messages\n");
-    while (context->sendqueue && coap_address_equals(dst, &context->sendqueue->remote)
-            && token_match(token, token_length, context->sendqueue->pdu->hdr->coap_hdr_udp_t.token,
-                    context->sendqueue->pdu->hdr->coap_hdr_udp_t.token_length))
-    {
-        q = context->sendqueue;
-        context->sendqueue = q->next;
-        debug("**** removed transaction %d\n", ntohs(q->pdu->hdr->coap_hdr_udp_t.id));
-        coap_delete_node(q);
-    }
-
-    if (!context->sendqueue)
+    if (!context->transaction_ids)
         return;
 
-    p = context->sendqueue;
-    q = p->next;
-
-    /* when q is not NULL, it does not match (dst, token), so we can skip it */
-    while (q)
+    b = coap_peer_token_hash(dst, token, token_length) & (context->transaction_buckets - 1);
+    for (q = context->transaction_tokens[b]; q; q = next)
     {
+        next = q->token_next;
         if (coap_address_equals(dst, &q->remote)
                 && token_match(token, token_length, q->pdu->hdr->coap_hdr_udp_t.token,
                                q->pdu->hdr->coap_hdr_udp_t.token_length))
         {
-            p->next = q->next;
+            coap_sendqueue_unschedule(context, q);
+            coap_transactions_unlink(context, q);
             debug("**** removed transaction %d\n", ntohs(q->pdu->hdr->coap_hdr_udp_t.id));
             coap_delete_node(q);
-            q = p->next;
-        }
-        else
-        {
-            p = q;
-            q = q->next;
         }
     }
 }
@@ -1128,6 +1538,54 @@ coap_find_transaction(coap_queue_t *queue, coap_tid_t id)
     return queue;
 }
 
+coap_queue_t *
+coap_find_sent_transaction(coap_context_t *context, coap_tid_t id)
+{
+    coap_queue_t *q;
+
+    if (!context || !context->transaction_ids)
+        return NULL;
+
+    q = context->transaction_ids[coap_transaction_id_bucket(context, id)];
+    while (q && q->id != id)
+        q = q->id_next;
+
+    return q;
+}
+
+coap_queue_t *
+coap_find_sent_token(coap_context_t *context, const coap_address_t *dst,
+        const unsigned char *token, size_t token_length)
+{
+    coap_queue_t *q;
+
+    if (!context || !context->transaction_ids)
+        return NULL;
+
+    q = context->transaction_tokens[coap_peer_token_hash(dst, token, token_length)
+            & (context->transaction_buckets - 1)];
+    while (q && !(coap_address_equals(dst, &q->remote)
+            && token_match(token, token_length, q->pdu->hdr->coap_hdr_udp_t.token,
+                           q->pdu->hdr->coap_hdr_udp_t.token_length)))
+        q = q->token_next;
+
+    return q;
+}
+
+int coap_remove_from_sendqueue(coap_context_t *context, coap_tid_t id, coap_queue_t **node)
+{
+    coap_queue_t *q = coap_find_sent_transaction(context, id);
+
+    if (!q)
+        return 0;
+
+    coap_sendqueue_unschedule(context, q);
+    coap_transactions_unlink(context, q);
+    *node = q;
+    debug("*** removed transaction %u\n", id);
+    return 1;
+}
+
 coap_pdu_t *
 coap_new_error_response(coap_pdu_t *request, unsigned char code, coap_opt_filter_t opts)
 {
@@ -1612,7 +2070,7 @@ handle_locally(coap_context_t *context __attribute__ ((unused)),
             {
                 case COAP_MESSAGE_ACK:
                     /* find transaction in sendqueue to stop retransmission */
-                    coap_remove_from_queue(&context->sendqueue, rcvd->id, &sent);
+                    coap_remove_from_sendqueue(context, rcvd->id, &sent);
 
                     if (rcvd->pdu->hdr->coap_hdr_udp_t.code == 0)
                         goto cleanup;
@@ -1639,7 +2097,7 @@ handle_locally(coap_context_t *context __attribute__ ((unused)),
                              ntohs(rcvd->pdu->hdr->coap_hdr_udp_t.id));
 
                     /* find transaction in sendqueue to stop retransmission */
-                    coap_remove_from_queue(&context->sendqueue, rcvd->id, &sent);
+                    coap_remove_from_sendqueue(context, rcvd->id, &sent);
 
                     if (sent)
                         coap_handle_rst(context, sent);
@@ -1692,12 +2150,14 @@ handle_locally(coap_context_t *context __attribute__ ((unused)),
 
             cleanup: coap_delete_node(sent);
             coap_delete_node(rcvd);
+            sent = NULL;
         }
     }
 
     int coap_can_exit(coap_context_t *context)
     {
-        return !context || (context->recvqueue == NULL && context->sendqueue == NULL);
+        return !context || (context->recvqueue == NULL && context->sendqueue == NULL
+                && context->sendwheel_count == 0);
     }
 
 #ifdef WITH_CONTIKI
@@ -1809,7 +2269,7 @@ handle_locally(coap_context_t *context __attribute__ ((unused)),
             sys_untimeout(coap_retransmittimer_execute, (void*)ctx);
             ctx->timer_configured = 0;
         }
-        if (ctx->sendqueue != NULL)
+        if (coap_peek_next(ctx) != NULL)
         {
             coap_ticks(&now);
             elapsed = now - ctx->sendqueue_basetime;
@@ -66,6 +66,11 @@ extern "C"
         coap_tid_t id; /**< unique transaction id */
 
         coap_pdu_t *pdu; /**< the CoAP PDU to send */
+
+        struct coap_queue_t *prev; /**< previous node in the same send wheel slot */
+        struct coap_queue_t *id_next; /**< next node in the same transaction id bucket */
+        struct coap_queue_t *token_next; /**< next node in the same peer and token bucket */
+        unsigned short wheel_slot; /**< 1 + send wheel slot holding the node, 0 if none */
     } coap_queue_t;
 
     /** Adds node to given queue, ordered by node->t. */
@@ -90,6 +95,23 @@ extern "C"
     typedef void (*coap_response_handler_t)(struct coap_context_t *, const coap_address_t *remote,
             coap_pdu_t *sent, coap_pdu_t *received, const coap_tid_t id);
 
+#ifndef COAP_SENDWHEEL_BITS
+/** number of bits of the send wheel slot index. */
+#if defined(WITH_CONTIKI) || defined(WITH_ARDUINO)
+#define COAP_SENDWHEEL_BITS 3
+#else
+#define COAP_SENDWHEEL_BITS 8
+#endif
+#endif /* COAP_SENDWHEEL_BITS */
+
+/** number of slots of the send wheel. */
+#define COAP_SENDWHEEL_SIZE (1 << COAP_SENDWHEEL_BITS)
+
+#ifndef COAP_SENDWHEEL_TICKS
+/** ticks covered by one send wheel slot, about 1/32 second. */
+#define COAP_SENDWHEEL_TICKS ((COAP_TICKS_PER_SECOND + 31) / 32)
+#endif /* COAP_SENDWHEEL_TICKS */
+
 #define COAP_MID_CACHE_SIZE 3
     typedef struct
     {
@@ -113,6 +135,35 @@ extern "C"
      * to sendqueue_basetime. */
     coap_tick_t sendqueue_basetime;
     coap_queue_t *sendqueue, *recvqueue;
+
+    /**
+     * Transactions that are due later than all in the sendqueue, in
+     * slots of COAP_SENDWHEEL_TICKS by absolute due time (node->t).
+     * Slot sendwheel_pos starts at sendwheel_time; a node more than a
+     * round away stays in its slot until that round has come. Nodes
+     * move to the sendqueue when their slot is reached, so the sendqueue
+     * only holds the transactions due next. */
+    coap_queue_t *sendwheel[COAP_SENDWHEEL_SIZE];
+    coap_tick_t sendwheel_time; /**< start of slot sendwheel_pos */
+    unsigned int sendwheel_pos; /**< slot due to move to the sendqueue next */
+    unsigned int sendwheel_count; /**< number of nodes in the send wheel */
+
+    /**
+     * Hash tables of all transactions in the sendqueue and the send
+     * wheel, by transaction id and by peer and token. Both have
+     * transaction_buckets entries and share one allocation. */
+    coap_queue_t **transaction_ids, **transaction_tokens;
+    unsigned int transaction_buckets; /**< always a power of 2 */
+    unsigned int transaction_count;
+
+#ifndef WITHOUT_OBSERVE
+    /**
+     * Hash table of the subscriptions to the resources of this context
+     * by observer and token, with observer_buckets entries. */
+    struct coap_subscription_t **observers;
+    unsigned int observer_buckets; /**< always a power of 2 */
+    unsigned int observer_count;
+#endif /* WITHOUT_OBSERVE */
 #if defined(WITH_POSIX) || defined(WITH_ARDUINO) || defined(WIN32)
     int sockfd; /**< send/receive socket */
 #endif /* WITH_POSIX || WITH_ARDUINO */
@@ -343,6 +394,19 @@ static inline unsigned short coap_new_message_id(coap_context_t *context)
      */
     void coap_transaction_id(const coap_address_t *peer, const coap_pdu_t *pdu, coap_tid_t *id);
 
+    /**
+     * Calculates a hash value from the transport address of @p peer and
+     * the given @p token, e.g. to look up transactions or subscriptions.
+     *
+     * @param peer         The remote party.
+     * @param token        The token, may be @c NULL if @p token_length is @c 0.
+     * @param token_length The actual length of @p token.
+     *
+     * @return The hash value.
+     */
+    unsigned int coap_peer_token_hash(const coap_address_t *peer, const unsigned char *token,
+            size_t token_length);
+
     /**
      * This function removes the element with given @p id from the list
      * given list. If @p id was found, @p node is updated to point to the
@@ -390,6 +454,46 @@ static inline unsigned short coap_new_message_id(coap_context_t *context)
      */
     coap_queue_t *coap_find_transaction(coap_queue_t *queue, coap_tid_t id);
 
+    /**
+     * Removes the transaction with given @p id from the sendqueue of @p
+     * context. This is coap_remove_from_queue() for the sendqueue and
+     * its send wheel, using the transaction index of @p context.
+     *
+     * @param context The CoAP context.
+     * @param id      The transaction id.
+     * @param node    If found, @p node is updated to point to the
+     *   removed node. You must release the storage pointed to by
+     *   @p node manually.
+     *
+     * @return @c 1 if @p id was found, @c 0 otherwise.
+     */
+    int coap_remove_from_sendqueue(coap_context_t *context, coap_tid_t id, coap_queue_t **node);
+
+    /**
+     * Retrieves the transaction with given @p id from the sendqueue of
+     * @p context.
+     *
+     * @param context The CoAP context.
+     * @param id      Unique key of the transaction to find.
+     *
+     * @return A pointer to the transaction object or NULL if not found.
+     */
+    coap_queue_t *coap_find_sent_transaction(coap_context_t *context, coap_tid_t id);
+
+    /**
+     * Retrieves a transaction for peer @p dst with the specified token
+     * from the sendqueue of @p context.
+     *
+     * @param context      The CoAP context.
+     * @param dst          Destination address of the transaction.
+     * @param token        Message token.
+     * @param token_length Actual length of @p token.
+     *
+     * @return A pointer to the transaction object or NULL if not found.
+     */
+    coap_queue_t *coap_find_sent_token(coap_context_t *context, const coap_address_t *dst,
+            const unsigned char *token, size_t token_length);
+
     /**
      * Cancels all outstanding messages for peer @p dst that have the
      * specified token.
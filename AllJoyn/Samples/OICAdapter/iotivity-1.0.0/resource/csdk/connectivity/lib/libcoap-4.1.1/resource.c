@@ -474,14 +474,133 @@ void coap_hash_request_uri(const coap_pdu_t *request, coap_key_t key)
         coap_hash(COAP_OPT_VALUE(option), COAP_OPT_LENGTH(option), key);
 }
 
+#if !defined(WITHOUT_OBSERVE) && !defined(WITH_CONTIKI)
+/** Initial number of buckets of the observer table. */
+#define COAP_OBSERVER_BUCKETS 16
+
+static inline unsigned int coap_observer_bucket(coap_context_t *context,
+        const coap_address_t *peer, const unsigned char *token, size_t token_length)
+{
+    return coap_peer_token_hash(peer, token, token_length) & (context->observer_buckets - 1);
+}
+
+static void coap_observers_link(coap_context_t *context, coap_subscription_t *s)
+{
+    unsigned int b = coap_observer_bucket(context, &s->subscriber, s->token, s->token_length);
+
+    s->observer_next = context->observers[b];
+    context->observers[b] = s;
+    context->observer_count++;
+}
+
+static void coap_observers_unlink(coap_context_t *context, coap_subscription_t *s)
+{
+    coap_subscription_t **p;
+
+    if (!context->observers)
+        return;
+
+    for (p = &context->observers[coap_observer_bucket(context, &s->subscriber, s->token,
+            s->token_length)]; *p; p = &(*p)->observer_next)
+    {
+        if (*p == s)
+        {
+            *p = s->observer_next;
+            s->observer_next = NULL;
+            context->observer_count--;
+            return;
+        }
+    }
+}
+
+/**
+ * Makes room for @p count more subscriptions in the observer table of
+ * @p context. A new table indexes the subscribers of all resources of
+ * @p context, so the subscriptions to be linked must not be in the
+ * subscribers of a resource of @p context yet. This function returns
+ * @c 0 only if @p context has no table and none could be allocated.
+ */
+static int coap_observers_reserve(coap_context_t *context, unsigned int count)
+{
+    coap_subscription_t **table, *s;
+    coap_resource_t *r;
+    unsigned int buckets;
+#ifndef COAP_RESOURCES_NOHASH
+    coap_resource_t *tmp;
+#endif
+
+    if (context->observers && context->observer_count + count <= context->observer_buckets)
+        return 1;
+
+    buckets = context->observer_buckets ? context->observer_buckets << 1 : COAP_OBSERVER_BUCKETS;
+    while (buckets < context->observer_count + count)
+        buckets <<= 1;
+    table = (coap_subscription_t **)coap_malloc(buckets * sizeof(coap_subscription_t *));
+    if (!table)
+    {
+        debug("coap_observers_reserve: no memory left\n");
+        return context->observers != NULL;
+    }
+    memset(table, 0, buckets * sizeof(coap_subscription_t *));
+
+    coap_free(context->observers);
+    context->observers = table;
+    context->observer_buckets = buckets;
+    context->observer_count = 0;
+
+#ifdef COAP_RESOURCES_NOHASH
+    LL_FOREACH(context->resources, r)
+    {
+#else
+    HASH_ITER(hh, context->resources, r, tmp)
+    {
+#endif
+        for (s = (coap_subscription_t *) list_head(r->subscribers);
+                s; s = (coap_subscription_t *) list_item_next((void *) s))
+        {
+            coap_observers_link(context, s);
+        }
+    }
+    return 1;
+}
+#endif /* !WITHOUT_OBSERVE && !WITH_CONTIKI */
+
 void coap_add_resource(coap_context_t *context, coap_resource_t *resource)
 {
 #ifndef WITH_CONTIKI
+#ifndef WITHOUT_OBSERVE
+    coap_subscription_t *s;
+
+    if (context->observers)
+    {
+        unsigned int count = 0;
+
+        /* before the resource is added, as a new table links the
+         * subscribers of all resources of context */
+        for (s = (coap_subscription_t *) list_head(resource->subscribers);
+                s; s = (coap_subscription_t *) list_item_next((void *) s))
+            count++;
+        coap_observers_reserve(context, count);
+    }
+#endif /* WITHOUT_OBSERVE */
+
 #ifdef COAP_RESOURCES_NOHASH
     LL_PREPEND(context->resources, resource);
 #else
     HASH_ADD(hh, context->resources, key, sizeof(coap_key_t), resource);
 #endif
+    resource->context = context;
+
+#ifndef WITHOUT_OBSERVE
+    if (context->observers)
+    {
+        for (s = (coap_subscription_t *) list_head(resource->subscribers);
+                s; s = (coap_subscription_t *) list_item_next((void *) s))
+        {
+            coap_observers_link(context, s);
+        }
+    }
+#endif /* WITHOUT_OBSERVE */
 #endif /* WITH_CONTIKI */
 }
 
@@ -489,9 +608,7 @@ int coap_delete_resource(coap_context_t *context, coap_key_t key)
 {
     coap_resource_t *resource;
     coap_attr_t *attr, *tmp;
-#ifdef WITH_CONTIKI
     coap_subscription_t *obs;
-#endif
 
     if (!context)
         return 0;
@@ -511,6 +628,15 @@ int coap_delete_resource(coap_context_t *context, coap_key_t key)
     /* delete registered attributes */
     LL_FOREACH_SAFE(resource->link_attr, attr, tmp) coap_delete_attr(attr);
 
+    /* delete subscribers */
+    while ((obs = (coap_subscription_t *) list_pop(resource->subscribers)))
+    {
+#ifndef WITHOUT_OBSERVE
+        coap_observers_unlink(context, obs);
+#endif /* WITHOUT_OBSERVE */
+        COAP_FREE_TYPE(subscription, obs);
+    }
+
     if (resource->flags & COAP_RESOURCE_FLAGS_RELEASE_URI)
         coap_free(resource->uri.s);
 
@@ -637,6 +763,23 @@ coap_find_observer(coap_resource_t *resource, const coap_address_t *peer, const
     assert(resource);
     assert(peer);
 
+#ifndef WITH_CONTIKI
+    if (token && resource->context && resource->context->observers)
+    {
+        coap_context_t *context = resource->context;
+
+        for (s = context->observers[coap_observer_bucket(context, peer, token->s, token->length)];
+                s; s = s->observer_next)
+        {
+            if (s->resource == resource && coap_address_equals(&s->subscriber, peer)
+                    && token->length == s->token_length
+                    && memcmp(token->s, s->token, token->length) == 0)
+                return s;
+        }
+        return NULL;
+    }
+#endif /* WITH_CONTIKI */
+
     for (s = (coap_subscription_t *) list_head(resource->subscribers);
             s; s = (coap_subscription_t *) list_item_next((void *) s))
     {
@@ -679,6 +822,19 @@ coap_add_observer(coap_resource_t *resource, const coap_address_t *observer, con
         s->token_length = token->length;
         memcpy(s->token, token->s, min(s->token_length, 8));
     }
+    s->resource = resource;
+
+#ifndef WITH_CONTIKI
+    if (resource->context)
+    {
+        if (!coap_observers_reserve(resource->context, 1))
+        {
+            COAP_FREE_TYPE(subscription, s);
+            return NULL;
+        }
+        coap_observers_link(resource->context, s);
+    }
+#endif /* WITH_CONTIKI */
 
     /* add subscriber to resource */
     list_add(resource->subscribers, s);
@@ -692,6 +848,20 @@ void coap_touch_observer(coap_context_t *context, const coap_address_t *observer
     coap_subscription_t *s;
 
 #ifndef WITH_CONTIKI
+    if (token && context->observers)
+    {
+        for (s = context->observers[coap_observer_bucket(context, observer, token->s,
+                token->length)]; s; s = s->observer_next)
+        {
+            if (coap_address_equals(&s->subscriber, observer) && token->length == s->token_length
+                    && memcmp(token->s, s->token, token->length) == 0)
+            {
+                s->fail_cnt = 0;
+            }
+        }
+        return;
+    }
+
 #ifdef COAP_RESOURCES_NOHASH
     LL_FOREACH(context->resources, r)
     {
@@ -732,6 +902,10 @@ void coap_delete_observer(coap_resource_t *resource, const coap_address_t *obser
     if (s)
     {
         list_remove(resource->subscribers, s);
+#ifndef WITH_CONTIKI
+        if (resource->context)
+            coap_observers_unlink(resource->context, s);
+#endif /* WITH_CONTIKI */
 
         COAP_FREE_TYPE(subscription, s);
     }
@@ -854,6 +1028,48 @@ void coap_check_notify(coap_context_t *context)
 #endif /* WITH_CONTIKI */
 }
 
+/**
+ * Counts a failed notify for the observer @p obs of the given resource
+ * and removes it when COAP_OBS_MAX_FAIL is reached.
+ *
+ * @param context  The CoAP context to use
+ * @param resource The resource observed by @p obs
+ * @param obs      The subscription that has failed
+ */
+static void coap_observer_failed(coap_context_t *context, coap_resource_t *resource,
+        coap_subscription_t *obs)
+{
+    /* count failed notifies and remove when
+     * COAP_MAX_FAILED_NOTIFY is reached */
+    if (obs->fail_cnt < COAP_OBS_MAX_FAIL)
+        obs->fail_cnt++;
+    else
+    {
+        list_remove(resource->subscribers, obs);
+#ifndef WITH_CONTIKI
+        if (resource->context)
+            coap_observers_unlink(resource->context, obs);
+#endif /* WITH_CONTIKI */
+        obs->fail_cnt = 0;
+
+#ifndef NDEBUG
+        if (LOG_DEBUG <= coap_get_log_level())
+        {
+#ifndef INET6_ADDRSTRLEN
+#define INET6_ADDRSTRLEN 40
+#endif
+            unsigned char addr[INET6_ADDRSTRLEN + 8];
+
+            if (coap_print_addr(&obs->subscriber, addr, INET6_ADDRSTRLEN + 8))
+                debug("** removed observer %s\n", addr);
+        }
+#endif
+        coap_cancel_all_messages(context, &obs->subscriber, obs->token, obs->token_length);
+
+        COAP_FREE_TYPE(subscription, obs);
+    }
+}
+
 /**
  * Checks the failure counter for (peer, token) and removes peer from
  * the list of observers for the given resource when COAP_OBS_MAX_FAIL
@@ -875,34 +1091,9 @@ static void coap_remove_failed_observers(coap_context_t *context, coap_resource_
         if (coap_address_equals(peer, &obs->subscriber) && token->length == obs->token_length
                 && memcmp(token->s, obs->token, token->length) == 0)
         {
-
-            /* count failed notifies and remove when
-             * COAP_MAX_FAILED_NOTIFY is reached */
-            if (obs->fail_cnt < COAP_OBS_MAX_FAIL)
-                obs->fail_cnt++;
-            else
-            {
-                list_remove(resource->subscribers, obs);
-                obs->fail_cnt = 0;
-
-#ifndef NDEBUG
-                if (LOG_DEBUG <= coap_get_log_level())
-                {
-#ifndef INET6_ADDRSTRLEN
-#define INET6_ADDRSTRLEN 40
-#endif
-                    unsigned char addr[INET6_ADDRSTRLEN + 8];
-
-                    if (coap_print_addr(&obs->subscriber, addr, INET6_ADDRSTRLEN + 8))
-                        debug("** removed observer %s\n", addr);
-                }
-#endif
-                coap_cancel_all_messages(context, &obs->subscriber, obs->token, obs->token_length);
-
-                COAP_FREE_TYPE(subscription, obs);
-            }
+            coap_observer_failed(context, resource, obs);
+            break; /* break loop if observer was found */
         }
-        break; /* break loop if observer was found */
     }
 }
 
@@ -912,6 +1103,22 @@ void coap_handle_failed_notify(coap_context_t *context, const coap_address_t *pe
     coap_resource_t *r;
 
 #ifndef WITH_CONTIKI
+    if (context->observers)
+    {
+        coap_subscription_t *obs, *next;
+
+        for (obs = context->observers[coap_observer_bucket(context, peer, token->s,
+                token->length)]; obs; obs = next)
+        {
+            next = obs->observer_next;
+            if (coap_address_equals(peer, &obs->subscriber) && token->length == obs->token_length
+                    && memcmp(token->s, obs->token, token->length) == 0)
+            {
+                coap_observer_failed(context, obs->resource, obs);
+            }
+        }
+        return;
+    }
 
 #ifdef COAP_RESOURCES_NOHASH
     LL_FOREACH(context->resources, r)
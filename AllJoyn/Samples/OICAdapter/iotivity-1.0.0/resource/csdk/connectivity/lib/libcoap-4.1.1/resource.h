@@ -89,6 +89,7 @@ typedef struct coap_resource_t
     LIST_STRUCT(link_attr); /**< attributes to be included with the link format */
 #endif /* WITH_CONTIKI */
     LIST_STRUCT(subscribers); /**< list of observers for this resource */
+    coap_context_t *context; /**< context the resource was added to, whose observer table indexes the subscribers */
 
     /**
      * Request URI for this resource. This field will point into the
@@ -50,6 +50,9 @@ typedef struct coap_subscription_t
     size_t token_length; /**< actual length of token */
     unsigned char token[8]; /**< token used for subscription */
     /* @todo CON/NON flag, block size */
+
+    struct coap_resource_t *resource; /**< the observed resource */
+    struct coap_subscription_t *observer_next; /**< next element in the same bucket of the context's observer table */
 } coap_subscription_t;
 
 void coap_subscription_init(coap_subscription_t *);
@@ -123,6 +123,7 @@ void t_sendqueue5(void)
     }
 
     coap_ticks(&now);
+    memset(&ctx, 0, sizeof(ctx));
     ctx.sendqueue = sendqueue;
     ctx.sendqueue_basetime = now;
 
@@ -174,6 +175,7 @@ void t_sendqueue6(void)
     }
 
     coap_ticks(&now);
+    memset(&ctx, 0, sizeof(ctx));
     ctx.sendqueue = NULL;
     ctx.sendqueue_basetime = now;
 
@@ -244,6 +246,7 @@ void t_sendqueue9(void)
 
     /* Initialize a fake context that points to our global sendqueue
      * Note that all changes happen on ctx.sendqueue. */
+    memset(&ctx, 0, sizeof(ctx));
     ctx.sendqueue = sendqueue;
     tmp_node = coap_peek_next(&ctx);
     sendqueue = ctx.sendqueue; /* must update global sendqueue for correct result */
@@ -275,6 +278,7 @@ void t_sendqueue10(void)
 
     /* Initialize a fake context that points to our global sendqueue
      * Note that all changes happen on ctx.sendqueue. */
+    memset(&ctx, 0, sizeof(ctx));
     ctx.sendqueue = sendqueue;
 
     tmp_node = coap_pop_next(&ctx);
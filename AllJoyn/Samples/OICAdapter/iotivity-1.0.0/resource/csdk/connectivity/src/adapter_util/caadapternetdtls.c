@@ -656,6 +656,59 @@ CAResult_t CADtlsEnableAnonECDHCipherSuite(const bool enable)
     return CA_STATUS_OK ;
 }
 
+CAResult_t CADtlsSetSessionCache(size_t capacity, uint32_t lifetime)
+{
+    OIC_LOG(DEBUG, NET_DTLS_TAG, "IN CADtlsSetSessionCache");
+
+    if (DTLS_SESSION_LIFETIME_MAX < lifetime)
+    {
+        OIC_LOG(ERROR, NET_DTLS_TAG, "Session lifetime too long");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    ca_mutex_lock(g_dtlsContextMutex);
+    if (NULL == g_caDtlsContext)
+    {
+        OIC_LOG(ERROR, NET_DTLS_TAG, "Context is NULL");
+        ca_mutex_unlock(g_dtlsContextMutex);
+        return CA_STATUS_FAILED;
+    }
+    int ret = dtls_set_session_cache(g_caDtlsContext->dtlsContext, capacity, lifetime);
+    ca_mutex_unlock(g_dtlsContextMutex);
+
+    if (0 != ret)
+    {
+        OIC_LOG(ERROR, NET_DTLS_TAG, "Failed to configure session cache");
+        return CA_STATUS_FAILED;
+    }
+
+    OIC_LOG_V(DEBUG, NET_DTLS_TAG, "Session cache: %u sessions for %u seconds",
+              (unsigned int)capacity, lifetime);
+    OIC_LOG(DEBUG, NET_DTLS_TAG, "OUT CADtlsSetSessionCache");
+
+    return CA_STATUS_OK;
+}
+
+CAResult_t CADtlsGetSessionStats(CADtlsSessionStats_t *stats)
+{
+    VERIFY_NON_NULL_RET(stats, NET_DTLS_TAG, "Param stats is NULL" , CA_STATUS_INVALID_PARAM);
+
+    ca_mutex_lock(g_dtlsContextMutex);
+    if (NULL == g_caDtlsContext)
+    {
+        OIC_LOG(ERROR, NET_DTLS_TAG, "Context is NULL");
+        ca_mutex_unlock(g_dtlsContextMutex);
+        return CA_STATUS_FAILED;
+    }
+    const dtls_session_stats_t *dtlsStats = dtls_get_session_stats(g_caDtlsContext->dtlsContext);
+    stats->fullHandshakes = dtlsStats->full_handshakes;
+    stats->resumedHandshakes = dtlsStats->resumed_handshakes;
+    stats->evictions = dtlsStats->evictions;
+    ca_mutex_unlock(g_dtlsContextMutex);
+
+    return CA_STATUS_OK;
+}
+
 CAResult_t CADtlsInitiateHandshake(const CAEndpoint_t *endpoint)
 {
     stCADtlsAddrInfo_t dst = { 0 };
@@ -1029,6 +1082,13 @@ CAResult_t CAAdapterNetDtlsInit()
     g_caDtlsContext->callbacks.is_x509_active = CAIsX509Active;
 #endif //__WITH_X509__*
     dtls_set_handler(g_caDtlsContext->dtlsContext, &(g_caDtlsContext->callbacks));
+
+    // Reconnects to known peers resume their session instead of a full handshake
+    if (0 != dtls_set_session_cache(g_caDtlsContext->dtlsContext,
+                                    CA_DTLS_SESSION_CACHE_SIZE, CA_DTLS_SESSION_LIFETIME))
+    {
+        OIC_LOG(ERROR, NET_DTLS_TAG, "Failed to create session cache");
+    }
     ca_mutex_unlock(g_dtlsContextMutex);
     OIC_LOG(DEBUG, NET_DTLS_TAG, "OUT");
     return CA_STATUS_OK;
@@ -930,9 +930,9 @@ CAResult_t CAStartLEAdapter()
      *       @c CAGetLEInterfaceInformation() function below for
      *       further details.
      */
-    result = ca_thread_pool_add_task(g_context.client_thread_pool,
-                                     CALEStartEventLoop,
-                                     &g_context);
+    result = ca_thread_pool_add_dedicated_task(g_context.client_thread_pool,
+                                               CALEStartEventLoop,
+                                               &g_context);
 
     if (result != CA_STATUS_OK)
     {
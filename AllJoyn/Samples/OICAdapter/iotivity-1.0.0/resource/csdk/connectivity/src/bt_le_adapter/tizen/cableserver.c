@@ -171,8 +171,8 @@ CAResult_t CAStartLEGattServer()
         return CA_STATUS_FAILED;
     }
 
-    ret = ca_thread_pool_add_task(g_bleServerThreadPool, CAStartBleGattServerThread,
-                                 NULL);
+    ret = ca_thread_pool_add_dedicated_task(g_bleServerThreadPool,
+                                            CAStartBleGattServerThread, NULL);
     if (CA_STATUS_OK != ret)
     {
         OIC_LOG_V(ERROR, TZ_BLE_SERVER_TAG, "ca_thread_pool_add_task failed with ret [%d]", ret);
@@ -52,9 +52,55 @@
 
 #define BLOCK_SIZE(arg) (1 << ((arg) + 4))
 
+// initial number of buckets in the block data table
+#define BLOCK_DATA_TABLE_SIZE      64
+
+// largest Size1/Size2 that is trusted to preallocate the reassembly buffer;
+// beyond it the buffer grows as the blocks arrive
+#define BLOCK_PAYLOAD_PREALLOC_MAX (1 << 20)
+
 // context for block-wise transfer
 static CABlockWiseContext_t g_context = { 0 };
 
+static uint32_t CAHashBlockID(const CABlockDataID_t *blockID)
+{
+    // the ID is made of the token and port
+    return OICHashBytes(blockID->id, blockID->idLength);
+}
+
+static CABlockData_t *CAFindBlockData(const CABlockDataID_t *blockID)
+{
+    if (!blockID->id)
+    {
+        return NULL;
+    }
+
+    for (OICHashLink_t *link = OICHashTableFind(&g_context.dataTable, CAHashBlockID(blockID));
+         link; link = OICHashTableFindNext(link))
+    {
+        CABlockData_t *currData = OIC_HASH_ENTRY(link, CABlockData_t, link);
+        if (CABlockidMatches(currData, blockID))
+        {
+            return currData;
+        }
+    }
+    return NULL;
+}
+
+static void CADestroyBlockData(CABlockData_t *data)
+{
+    if (data->sentData)
+    {
+        CADestroyDataSet(data->sentData);
+    }
+    CADestroyBlockID(data->blockDataId);
+    OICFree(data->payload);
+    OICFree(data);
+}
+
+static CAResult_t CADeliverLastBlock(const CABlockDataID_t *blockID,
+                                     const CAData_t *receivedData, bool keepPayload);
+
 static bool CACheckPayloadLength(const CAData_t *sendData)
 {
     size_t payloadLen = 0;
@@ -88,9 +134,10 @@ CAResult_t CAInitializeBlockWiseTransfer(CASendThreadFunc sendThreadFunc,
         g_context.receivedThreadFunc = receivedThreadFunc;
     }
 
-    if (!g_context.dataList)
+    if (!OICHashTableReserve(&g_context.dataTable, BLOCK_DATA_TABLE_SIZE))
     {
-        g_context.dataList = u_arraylist_create();
+        OIC_LOG(ERROR, TAG, "out of memory");
+        return CA_MEMORY_ALLOC_FAILED;
     }
 
     CAResult_t res = CAInitBlockWiseMutexVariables();
@@ -106,13 +153,23 @@ CAResult_t CATerminateBlockWiseTransfer()
 {
     OIC_LOG(DEBUG, TAG, "terminate");
 
-    if (g_context.dataList)
+    for (size_t i = 0; i < g_context.dataTable.size; i++)
     {
-        u_arraylist_free(&g_context.dataList);
+        while (g_context.dataTable.buckets[i])
+        {
+            CABlockData_t *currData = OIC_HASH_ENTRY(g_context.dataTable.buckets[i],
+                                                     CABlockData_t, link);
+            OICHashTableRemove(&g_context.dataTable, &currData->link);
+            CADestroyBlockData(currData);
+        }
     }
+    OICHashTableClear(&g_context.dataTable);
 
     CATerminateBlockWiseMutexVariables();
 
+    g_context.sendThreadFunc = NULL;
+    g_context.receivedThreadFunc = NULL;
+
     return CA_STATUS_OK;
 }
 
@@ -210,8 +267,7 @@ CAResult_t CASendBlockWiseData(const CAData_t *sendData)
     {
         // #4. send block message
         OIC_LOG(DEBUG, TAG, "send first block msg");
-        res = CAAddSendThreadQueue(currData->sentData,
-                                   (const CABlockDataID_t *)&currData->blockDataId);
+        res = CAAddSendThreadQueue(currData->sentData, currData->blockDataId);
         if (CA_STATUS_OK != res)
         {
             OIC_LOG(ERROR, TAG, "add has failed");
@@ -497,7 +553,7 @@ CAResult_t CAProcessNextStep(const coap_pdu_t *pdu, const CAData_t *receivedData
 
         case CA_OPTION2_LAST_BLOCK:
             // process last block and send upper layer
-            res = CAReceiveLastBlock(blockID, receivedData);
+            res = CADeliverLastBlock(blockID, receivedData, false);
             if (CA_STATUS_OK != res)
             {
                 OIC_LOG(ERROR, TAG, "receive has failed");
@@ -514,8 +570,10 @@ CAResult_t CAProcessNextStep(const coap_pdu_t *pdu, const CAData_t *receivedData
             break;
 
         case CA_OPTION1_NO_ACK_LAST_BLOCK:
-            // process last block and send upper layer
-            res = CAReceiveLastBlock(blockID, receivedData);
+            // process last block and send upper layer, the payload is kept
+            // for a retransmission of the last CON block
+            res = CADeliverLastBlock(blockID, receivedData,
+                                     CA_MSG_NONCONFIRM != pdu->hdr->coap_hdr_udp_t.type);
             if (CA_STATUS_OK != res)
             {
                 OIC_LOG(ERROR, TAG, "receive has failed");
@@ -714,6 +772,7 @@ CAResult_t CASendErrorMessage(const coap_pdu_t *pdu, uint8_t status,
     {
         OICFree(data->payload);
         data->payload = NULL;
+        data->payloadCapacity = 0;
         data->payloadLength = 0;
         data->receivedPayloadLen = 0;
         data->block1.num = 0;
@@ -723,8 +782,11 @@ CAResult_t CASendErrorMessage(const coap_pdu_t *pdu, uint8_t status,
     return CA_STATUS_OK;
 }
 
-CAResult_t CAReceiveLastBlock(const CABlockDataID_t *blockID,
-                              const CAData_t *receivedData)
+// Notifies the upper layer of the reassembled payload. Unless the block data
+// is kept for a retransmitted last block, the payload buffer itself is handed
+// over instead of a copy.
+static CAResult_t CADeliverLastBlock(const CABlockDataID_t *blockID,
+                                     const CAData_t *receivedData, bool keepPayload)
 {
     VERIFY_NON_NULL(blockID, TAG, "blockID");
     VERIFY_NON_NULL(receivedData, TAG, "receivedData");
@@ -739,14 +801,21 @@ CAResult_t CAReceiveLastBlock(const CABlockDataID_t *blockID,
 
     // update payload
     size_t fullPayloadLen = 0;
-    CAPayload_t fullPayload = CAGetPayloadFromBlockDataList(blockID,
-                                                            &fullPayloadLen);
+    CAPayload_t fullPayload = keepPayload ?
+            CAGetPayloadFromBlockDataList(blockID, &fullPayloadLen) :
+            CATakePayloadFromBlockDataList(blockID, &fullPayloadLen);
     if (fullPayload)
     {
-        CAResult_t res = CAUpdatePayloadToCAData(cloneData, fullPayload, fullPayloadLen);
+        CAResult_t res = keepPayload ?
+                CAUpdatePayloadToCAData(cloneData, fullPayload, fullPayloadLen) :
+                CAMovePayloadToCAData(cloneData, fullPayload, fullPayloadLen);
         if (CA_STATUS_OK != res)
         {
             OIC_LOG(ERROR, TAG, "update has failed");
+            if (!keepPayload)
+            {
+                OICFree(fullPayload);
+            }
             CADestroyDataSet(cloneData);
             return res;
         }
@@ -764,6 +833,12 @@ CAResult_t CAReceiveLastBlock(const CABlockDataID_t *blockID,
     return CA_STATUS_OK;
 }
 
+CAResult_t CAReceiveLastBlock(const CABlockDataID_t *blockID,
+                              const CAData_t *receivedData)
+{
+    return CADeliverLastBlock(blockID, receivedData, true);
+}
+
 // TODO make pdu const after libcoap is updated to support that.
 CAResult_t CASetNextBlockOption1(coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
                                  const CAData_t *receivedData, coap_block_t block,
@@ -852,7 +927,7 @@ CAResult_t CASetNextBlockOption1(coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
             else
             {
                 OIC_LOG(INFO, TAG, "received data is not bulk data");
-                CAReceiveLastBlock(blockDataID, receivedData);
+                CADeliverLastBlock(blockDataID, receivedData, false);
                 CARemoveBlockDataFromList(blockDataID);
                 CADestroyBlockID(blockDataID);
                 return CA_STATUS_OK;
@@ -1952,6 +2027,33 @@ uint8_t CACheckBlockErrorType(CABlockData_t *currData, coap_block_t *receivedBlo
     return CA_BLOCK_UNKNOWN;
 }
 
+static CAResult_t CAReservePayloadBuffer(CABlockData_t *currData, size_t requiredLen,
+                                         bool isSizeOption)
+{
+    size_t capacity = requiredLen;
+    if (isSizeOption && currData->payloadLength >= requiredLen
+        && currData->payloadLength <= BLOCK_PAYLOAD_PREALLOC_MAX)
+    {
+        // the size option announces the total payload length
+        OIC_LOG(DEBUG, TAG, "allocate memory for the total payload");
+        capacity = currData->payloadLength;
+    }
+    else if (capacity < currData->payloadCapacity * 2)
+    {
+        capacity = currData->payloadCapacity * 2;
+    }
+
+    CAPayload_t newPayload = (CAPayload_t) OICRealloc(currData->payload, capacity);
+    if (NULL == newPayload)
+    {
+        OIC_LOG(ERROR, TAG, "out of memory");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+    currData->payload = newPayload;
+    currData->payloadCapacity = capacity;
+    return CA_STATUS_OK;
+}
+
 CAResult_t CAUpdatePayloadData(CABlockData_t *currData, const CAData_t *receivedData,
                                uint8_t status, bool isSizeOption, uint16_t blockType)
 {
@@ -1976,55 +2078,26 @@ CAResult_t CAUpdatePayloadData(CABlockData_t *currData, const CAData_t *received
                 BLOCK_SIZE(currData->block2.szx) : BLOCK_SIZE(currData->block1.szx);
     }
 
-    // memory allocation for the received block payload
+    // copy the block into the reassembly buffer, which only grows when the
+    // total length is not known in advance
     size_t prePayloadLen = currData->receivedPayloadLen;
     if (blockPayload)
     {
-        if (currData->payloadLength)
+        size_t totalPayloadLen = prePayloadLen + blockPayloadLen;
+        if (totalPayloadLen > currData->payloadCapacity)
         {
-            // in case the block message has the size option
-            // allocate the memory for the total payload
-            if (isSizeOption)
-            {
-                CAPayload_t prePayload = currData->payload;
-
-                OIC_LOG(DEBUG, TAG, "allocate memory for the total payload");
-                currData->payload = (CAPayload_t) OICCalloc(1, currData->payloadLength);
-                if (NULL == currData->payload)
-                {
-                    OIC_LOG(ERROR, TAG, "out of memory");
-                    return CA_MEMORY_ALLOC_FAILED;
-                }
-                memcpy(currData->payload, prePayload, prePayloadLen);
-                OICFree(prePayload);
-            }
-
-            // update the total payload
-            memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
-        }
-        else
-        {
-            OIC_LOG(DEBUG, TAG, "allocate memory for the received block payload");
-
-            size_t totalPayloadLen = prePayloadLen + blockPayloadLen;
-            CAPayload_t newPayload = OICRealloc(currData->payload, totalPayloadLen);
-            if (NULL == newPayload)
+            CAResult_t res = CAReservePayloadBuffer(currData, totalPayloadLen, isSizeOption);
+            if (CA_STATUS_OK != res)
             {
-                OIC_LOG(ERROR, TAG, "out of memory");
-                return CA_MEMORY_ALLOC_FAILED;
+                return res;
             }
-
-            // update the total payload
-            memset(newPayload + prePayloadLen, 0, blockPayloadLen);
-            currData->payload = newPayload;
-            memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
         }
+        memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
 
         // update received payload length
-        currData->receivedPayloadLen += blockPayloadLen;
+        currData->receivedPayloadLen = totalPayloadLen;
 
-        OIC_LOG_V(DEBUG, TAG, "updated payload: %s, len: %d", currData->payload,
-                  currData->receivedPayloadLen);
+        OIC_LOG_V(DEBUG, TAG, "updated payload len: %d", currData->receivedPayloadLen);
     }
 
     OIC_LOG(DEBUG, TAG, "OUT-UpdatePayloadData");
@@ -2083,6 +2156,9 @@ CAData_t *CACloneCAData(const CAData_t *data)
     }
     *clone = *data;
 
+    // the clone owns deep copies, not a reference to the received pdu
+    clone->receivedData = NULL;
+
     if (data->requestInfo)
     {
         clone->requestInfo = CACloneRequestInfo(data->requestInfo);
@@ -2149,6 +2225,35 @@ CAResult_t CAUpdatePayloadToCAData(CAData_t *data, const CAPayload_t payload,
     return CA_STATUS_OK;
 }
 
+CAResult_t CAMovePayloadToCAData(CAData_t *data, CAPayload_t payload, size_t payloadLen)
+{
+    VERIFY_NON_NULL(data, TAG, "data is NULL");
+    VERIFY_NON_NULL(payload, TAG, "payload is NULL");
+
+    CAInfo_t *info = NULL;
+    switch (data->dataType)
+    {
+        case CA_REQUEST_DATA:
+            info = &data->requestInfo->info;
+            break;
+
+        case CA_RESPONSE_DATA:
+            info = &data->responseInfo->info;
+            break;
+
+        default:
+            // does not occur case
+            OIC_LOG(ERROR, TAG, "not supported data type");
+            return CA_NOT_SUPPORTED;
+    }
+
+    OICFree(info->payload);
+    info->payload = payload;
+    info->payloadSize = payloadLen;
+
+    return CA_STATUS_OK;
+}
+
 CAPayload_t CAGetPayloadInfo(const CAData_t *data, size_t *payloadLen)
 {
     VERIFY_NON_NULL_RET(data, TAG, "data", NULL);
@@ -2209,17 +2314,13 @@ CAResult_t CAUpdateBlockOptionType(const CABlockDataID_t *blockID,
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            currData->type = blockType;
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-UpdateBlockOptionType");
-            return CA_STATUS_OK;
-        }
+        currData->type = blockType;
+        ca_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-UpdateBlockOptionType");
+        return CA_STATUS_OK;
     }
     ca_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2234,16 +2335,12 @@ uint8_t CAGetBlockOptionType(const CABlockDataID_t *blockID)
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-GetBlockOptionType");
-            return currData->type;
-        }
+        ca_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-GetBlockOptionType");
+        return currData->type;
     }
     ca_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2257,19 +2354,10 @@ CAData_t *CAGetDataSetFromBlockDataList(const CABlockDataID_t *blockID)
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
-    {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            return currData->sentData;
-        }
-    }
+    CABlockData_t *currData = CAFindBlockData(blockID);
     ca_mutex_unlock(g_context.blockDataListMutex);
 
-    return NULL;
+    return currData ? currData->sentData : NULL;
 }
 
 CAResult_t CAGetTokenFromBlockDataList(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
@@ -2282,37 +2370,37 @@ CAResult_t CAGetTokenFromBlockDataList(const coap_pdu_t *pdu, const CAEndpoint_t
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    // empty messages carry no token, so the message ID has to be matched
+    // against every block data
+    for (size_t i = 0; i < g_context.dataTable.size; i++)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (NULL == currData)
+        for (OICHashLink_t *link = g_context.dataTable.buckets[i]; link; link = link->next)
         {
-            continue;
-        }
-
-        if (NULL != currData->sentData && NULL != currData->sentData->requestInfo)
-        {
-            if (pdu->hdr->coap_hdr_udp_t.id == currData->sentData->requestInfo->info.messageId &&
-                    endpoint->adapter == currData->sentData->remoteEndpoint->adapter)
+            CABlockData_t *currData = OIC_HASH_ENTRY(link, CABlockData_t, link);
+            if (NULL != currData->sentData && NULL != currData->sentData->requestInfo)
             {
-                if (NULL != currData->sentData->requestInfo->info.token)
+                if (pdu->hdr->coap_hdr_udp_t.id == currData->sentData->requestInfo->info.messageId &&
+                        endpoint->adapter == currData->sentData->remoteEndpoint->adapter)
                 {
-                    uint8_t length = currData->sentData->requestInfo->info.tokenLength;
-                    responseInfo->info.tokenLength = length;
-                    responseInfo->info.token = (char *) OICMalloc(length);
-                    if (NULL == responseInfo->info.token)
+                    if (NULL != currData->sentData->requestInfo->info.token)
                     {
-                        OIC_LOG(ERROR, TAG, "out of memory");
+                        uint8_t length = currData->sentData->requestInfo->info.tokenLength;
+                        responseInfo->info.tokenLength = length;
+                        responseInfo->info.token = (char *) OICMalloc(length);
+                        if (NULL == responseInfo->info.token)
+                        {
+                            OIC_LOG(ERROR, TAG, "out of memory");
+                            ca_mutex_unlock(g_context.blockDataListMutex);
+                            return CA_MEMORY_ALLOC_FAILED;
+                        }
+                        memcpy(responseInfo->info.token,
+                               currData->sentData->requestInfo->info.token,
+                               responseInfo->info.tokenLength);
+
                         ca_mutex_unlock(g_context.blockDataListMutex);
-                        return CA_MEMORY_ALLOC_FAILED;
+                        OIC_LOG(DEBUG, TAG, "OUT-CAGetTokenFromBlockDataList");
+                        return CA_STATUS_OK;
                     }
-                    memcpy(responseInfo->info.token, currData->sentData->requestInfo->info.token,
-                           responseInfo->info.tokenLength);
-
-                    ca_mutex_unlock(g_context.blockDataListMutex);
-                    OIC_LOG(DEBUG, TAG, "OUT-CAGetTokenFromBlockDataList");
-                    return CA_STATUS_OK;
                 }
             }
         }
@@ -2329,93 +2417,57 @@ CAResult_t CACheckBlockDataValidation(const CAData_t *sendData, CABlockData_t **
     VERIFY_NON_NULL(sendData, TAG, "sendData");
     VERIFY_NON_NULL(blockData, TAG, "blockData");
 
-    ca_mutex_lock(g_context.blockDataListMutex);
-
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    if (sendData->requestInfo) // sendData is requestMessage
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
+        // a request always starts a new block data
+        OIC_LOG(DEBUG, TAG, "Send request");
+        return CA_STATUS_FAILED;
+    }
+    else if (!sendData->responseInfo)
+    {
+        OIC_LOG(ERROR, TAG, "no CAInfo data");
+        return CA_STATUS_FAILED;
+    }
 
-        if (!currData)
-        {
-            continue;
-        }
+    // sendData is responseMessage
+    OIC_LOG(DEBUG, TAG, "Send response");
+    if (NULL == sendData->responseInfo->info.token)
+    {
+        return CA_STATUS_FAILED;
+    }
 
-        if (sendData->requestInfo) // sendData is requestMessage
-        {
-            OIC_LOG(DEBUG, TAG, "Send request");
-            if (NULL != currData->blockDataId
-                    && NULL != currData->blockDataId->id
-                    && currData->blockDataId->idLength > 0
-                    && NULL != sendData->requestInfo->info.token)
-            {
-                CABlockDataID_t* blockDataID = CACreateBlockDatablockId(
-                        (CAToken_t)sendData->requestInfo->info.token,
-                        sendData->requestInfo->info.tokenLength,
-                        sendData->remoteEndpoint->port);
+    CABlockDataID_t* blockDataID = CACreateBlockDatablockId(
+            (CAToken_t)sendData->responseInfo->info.token,
+            sendData->responseInfo->info.tokenLength,
+            sendData->remoteEndpoint->port);
 
-                if(NULL == blockDataID || NULL == blockDataID->id || blockDataID->idLength < 1)
-                {
-                    OIC_LOG(ERROR, TAG, "blockId is null");
-                    CADestroyBlockID(blockDataID);
-                    return CA_STATUS_FAILED;
-                }
+    if(NULL == blockDataID || NULL == blockDataID->id || blockDataID->idLength < 1)
+    {
+        OIC_LOG(ERROR, TAG, "blockId is null");
+        CADestroyBlockID(blockDataID);
+        return CA_STATUS_FAILED;
+    }
 
-                if (CABlockidMatches(currData, blockDataID))
-                {
-                    OIC_LOG(ERROR, TAG, "already sent");
-                    CADestroyBlockID(blockDataID);
-                    continue;
-                }
-                CADestroyBlockID(blockDataID);
-            }
-        }
-        else if (sendData->responseInfo) // sendData is responseMessage
-        {
-            OIC_LOG(DEBUG, TAG, "Send response");
-            if (NULL != currData->blockDataId
-                    && NULL != currData->blockDataId->id
-                    && currData->blockDataId->idLength > 0
-                    && NULL != sendData->responseInfo->info.token)
-            {
-                CABlockDataID_t* blockDataID = CACreateBlockDatablockId(
-                        (CAToken_t)sendData->responseInfo->info.token,
-                        sendData->responseInfo->info.tokenLength,
-                        sendData->remoteEndpoint->port);
+    ca_mutex_lock(g_context.blockDataListMutex);
 
-                if(NULL == blockDataID || NULL == blockDataID->id || blockDataID->idLength < 1)
-                {
-                    OIC_LOG(ERROR, TAG, "blockId is null");
-                    CADestroyBlockID(blockDataID);
-                    return CA_STATUS_FAILED;
-                }
+    CABlockData_t *currData = CAFindBlockData(blockDataID);
+    CADestroyBlockID(blockDataID);
+    if (!currData)
+    {
+        ca_mutex_unlock(g_context.blockDataListMutex);
+        return CA_STATUS_FAILED;
+    }
 
-                if (CABlockidMatches(currData, blockDataID))
-                {
-                    // set sendData
-                    if (NULL != currData->sentData)
-                    {
-                        OIC_LOG(DEBUG, TAG, "init block number");
-                        CADestroyDataSet(currData->sentData);
-                    }
-                    currData->sentData = CACloneCAData(sendData);
-                    *blockData = currData;
-                    CADestroyBlockID(blockDataID);
-                    ca_mutex_unlock(g_context.blockDataListMutex);
-                    return CA_STATUS_OK;
-                }
-                CADestroyBlockID(blockDataID);
-            }
-        }
-        else
-        {
-            OIC_LOG(ERROR, TAG, "no CAInfo data");
-            continue;
-        }
+    // set sendData
+    if (NULL != currData->sentData)
+    {
+        OIC_LOG(DEBUG, TAG, "init block number");
+        CADestroyDataSet(currData->sentData);
     }
+    currData->sentData = CACloneCAData(sendData);
+    *blockData = currData;
     ca_mutex_unlock(g_context.blockDataListMutex);
-
-    return CA_STATUS_FAILED;
+    return CA_STATUS_OK;
 }
 
 CABlockData_t *CAGetBlockDataFromBlockDataList(const CABlockDataID_t *blockID)
@@ -2424,19 +2476,10 @@ CABlockData_t *CAGetBlockDataFromBlockDataList(const CABlockDataID_t *blockID)
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
-    {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            return currData;
-        }
-    }
+    CABlockData_t *currData = CAFindBlockData(blockID);
     ca_mutex_unlock(g_context.blockDataListMutex);
 
-    return NULL;
+    return currData;
 }
 
 coap_block_t *CAGetBlockOption(const CABlockDataID_t *blockID,
@@ -2447,28 +2490,23 @@ coap_block_t *CAGetBlockOption(const CABlockDataID_t *blockID,
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
-    {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-GetBlockOption");
-            if (COAP_OPTION_BLOCK2 == blockType)
-            {
-                return &currData->block2;
-            }
-            else
-            {
-                return &currData->block1;
-            }
-        }
-    }
+    CABlockData_t *currData = CAFindBlockData(blockID);
     ca_mutex_unlock(g_context.blockDataListMutex);
 
     OIC_LOG(DEBUG, TAG, "OUT-GetBlockOption");
-    return NULL;
+    if (!currData)
+    {
+        return NULL;
+    }
+
+    if (COAP_OPTION_BLOCK2 == blockType)
+    {
+        return &currData->block2;
+    }
+    else
+    {
+        return &currData->block1;
+    }
 }
 
 CAPayload_t CAGetPayloadFromBlockDataList(const CABlockDataID_t *blockID,
@@ -2480,17 +2518,13 @@ CAPayload_t CAGetPayloadFromBlockDataList(const CABlockDataID_t *blockID,
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            *fullPayloadLen = currData->receivedPayloadLen;
-            OIC_LOG(DEBUG, TAG, "OUT-GetFullPayload");
-            return currData->payload;
-        }
+        ca_mutex_unlock(g_context.blockDataListMutex);
+        *fullPayloadLen = currData->receivedPayloadLen;
+        OIC_LOG(DEBUG, TAG, "OUT-GetFullPayload");
+        return currData->payload;
     }
     ca_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2498,6 +2532,31 @@ CAPayload_t CAGetPayloadFromBlockDataList(const CABlockDataID_t *blockID,
     return NULL;
 }
 
+CAPayload_t CATakePayloadFromBlockDataList(const CABlockDataID_t *blockID,
+                                           size_t *fullPayloadLen)
+{
+    OIC_LOG(DEBUG, TAG, "IN-TakeFullPayload");
+    VERIFY_NON_NULL_RET(blockID, TAG, "blockID", NULL);
+    VERIFY_NON_NULL_RET(fullPayloadLen, TAG, "fullPayloadLen", NULL);
+
+    ca_mutex_lock(g_context.blockDataListMutex);
+
+    CAPayload_t payload = NULL;
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
+    {
+        payload = currData->payload;
+        *fullPayloadLen = currData->receivedPayloadLen;
+
+        currData->payload = NULL;
+        currData->payloadCapacity = 0;
+    }
+    ca_mutex_unlock(g_context.blockDataListMutex);
+
+    OIC_LOG(DEBUG, TAG, "OUT-TakeFullPayload");
+    return payload;
+}
+
 CABlockData_t *CACreateNewBlockData(const CAData_t *sendData)
 {
     OIC_LOG(DEBUG, TAG, "IN-CACreateNewBlockData");
@@ -2550,16 +2609,27 @@ CABlockData_t *CACreateNewBlockData(const CAData_t *sendData)
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    bool res = u_arraylist_add(g_context.dataList, (void *) data);
-    if (!res)
+    if (!g_context.dataTable.size)
     {
-        OIC_LOG(ERROR, TAG, "add has failed");
-        CADestroyBlockID(data->blockDataId);
-        CADestroyDataSet(data->sentData);
-        OICFree(data);
+        OIC_LOG(ERROR, TAG, "block-wise transfer is not initialized");
+        CADestroyBlockData(data);
         ca_mutex_unlock(g_context.blockDataListMutex);
         return NULL;
     }
+
+    // a message with the same token and port starts over; the previous
+    // block data would otherwise never be found or released again
+    CABlockData_t *prevData = CAFindBlockData(blockDataID);
+    if (prevData)
+    {
+        OIC_LOG(DEBUG, TAG, "replace the previous block data");
+        OICHashTableRemove(&g_context.dataTable, &prevData->link);
+        CADestroyBlockData(prevData);
+    }
+
+    // the table still works without growing, only with longer buckets
+    OICHashTableInsert(&g_context.dataTable, &data->link, CAHashBlockID(blockDataID));
+
     ca_mutex_unlock(g_context.blockDataListMutex);
 
     OIC_LOG(DEBUG, TAG, "OUT-CreateBlockData");
@@ -2573,31 +2643,13 @@ CAResult_t CARemoveBlockDataFromList(const CABlockDataID_t *blockID)
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *removedData = CAFindBlockData(blockID);
+    if (removedData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            CABlockData_t *removedData = u_arraylist_remove(g_context.dataList, i);
-            if (!removedData)
-            {
-                OIC_LOG(ERROR, TAG, "data is NULL");
-                ca_mutex_unlock(g_context.blockDataListMutex);
-                return CA_STATUS_FAILED;
-            }
+        OICHashTableRemove(&g_context.dataTable, &removedData->link);
 
-            // destroy memory
-            if (currData->sentData)
-            {
-                CADestroyDataSet(currData->sentData);
-            }
-            CADestroyBlockID(currData->blockDataId);
-            OICFree(currData->payload);
-            OICFree(currData);
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            return CA_STATUS_OK;
-        }
+        // destroy memory
+        CADestroyBlockData(removedData);
     }
     ca_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2611,16 +2663,11 @@ bool CAIsBlockDataInList(const CABlockDataID_t *blockID)
 
     ca_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    if (CAFindBlockData(blockID))
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            OIC_LOG(DEBUG, TAG, "found block data");
-            ca_mutex_unlock(g_context.blockDataListMutex);
-            return true;
-        }
+        OIC_LOG(DEBUG, TAG, "found block data");
+        ca_mutex_unlock(g_context.blockDataListMutex);
+        return true;
     }
     ca_mutex_unlock(g_context.blockDataListMutex);
 
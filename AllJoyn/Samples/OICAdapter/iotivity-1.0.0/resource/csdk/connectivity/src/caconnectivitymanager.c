@@ -377,6 +377,52 @@ CAResult_t CAHandleRequestResponse()
     return CA_STATUS_OK;
 }
 
+CAResult_t CAWaitForRequestResponse(uint32_t timeout)
+{
+    if (!g_isInitialized)
+    {
+        OIC_LOG(ERROR, TAG, "not initialized");
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+
+    return CAWaitForReceivedData(timeout);
+}
+
+CAResult_t CASignalRequestResponse()
+{
+    if (!g_isInitialized)
+    {
+        OIC_LOG(ERROR, TAG, "not initialized");
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+
+    CASignalReceivedData();
+
+    return CA_STATUS_OK;
+}
+
+CAResult_t CASetMessageQueueLimit(uint32_t capacity, CAQueueOverflowPolicy_t policy)
+{
+    if (!g_isInitialized)
+    {
+        OIC_LOG(ERROR, TAG, "not initialized");
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+
+    return CASetSendReceiveQueueLimit(capacity, policy);
+}
+
+CAResult_t CAGetMessageQueueStats(CAQueueStats_t *sendStats, CAQueueStats_t *receiveStats)
+{
+    if (!g_isInitialized)
+    {
+        OIC_LOG(ERROR, TAG, "not initialized");
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+
+    return CAGetSendReceiveQueueStats(sendStats, receiveStats);
+}
+
 #ifdef __WITH_DTLS__
 
 CAResult_t CASelectCipherSuite(const uint16_t cipher)
@@ -393,6 +439,25 @@ CAResult_t CAEnableAnonECDHCipherSuite(const bool enable)
     return CADtlsEnableAnonECDHCipherSuite(enable);
 }
 
+CAResult_t CASetDtlsSessionCache(size_t capacity, uint32_t lifetime)
+{
+    OIC_LOG_V(DEBUG, TAG, "CASetDtlsSessionCache");
+
+    return CADtlsSetSessionCache(capacity, lifetime);
+}
+
+CAResult_t CAGetDtlsSessionStats(CADtlsSessionStats_t *stats)
+{
+    OIC_LOG_V(DEBUG, TAG, "CAGetDtlsSessionStats");
+
+    if (!stats)
+    {
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    return CADtlsGetSessionStats(stats);
+}
+
 CAResult_t CAGenerateOwnerPSK(const CAEndpoint_t* endpoint,
                     const uint8_t* label, const size_t labelLen,
                     const uint8_t* rsrcServerDeviceID, const size_t rsrcServerDeviceIDLen,
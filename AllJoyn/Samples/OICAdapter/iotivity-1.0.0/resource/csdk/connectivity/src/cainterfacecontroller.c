@@ -60,6 +60,8 @@ static CAConnectivityHandler_t g_adapterHandler[CA_TRANSPORT_TYPE_NUM] = {0};
 
 static CANetworkPacketReceivedCallback g_networkPacketReceivedCallback = NULL;
 
+static CANetworkPacketBatchReceivedCallback g_networkPacketBatchReceivedCallback = NULL;
+
 static CANetworkChangeCallback g_networkChangeCallback = NULL;
 
 static CAErrorHandleCallback g_errorHandleCallback = NULL;
@@ -124,6 +126,15 @@ static void CARegisterCallback(CAConnectivityHandler_t handler, CATransportAdapt
     OIC_LOG(DEBUG, TAG, "OUT");
 }
 
+void CASetPacketBatchReceivedCallback(CANetworkPacketBatchReceivedCallback callback)
+{
+    OIC_LOG(DEBUG, TAG, "IN");
+
+    g_networkPacketBatchReceivedCallback = callback;
+
+    OIC_LOG(DEBUG, TAG, "OUT");
+}
+
 #ifdef RA_ADAPTER
 CAResult_t CASetAdapterRAInfo(const CARAInfo_t *caraInfo)
 {
@@ -148,6 +159,20 @@ static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
     OIC_LOG(DEBUG, TAG, "OUT");
 }
 
+static void CAReceivedPacketBatchCallback(const CAReceivedPacket_t *packets, uint32_t count)
+{
+    if (g_networkPacketBatchReceivedCallback != NULL)
+    {
+        g_networkPacketBatchReceivedCallback(packets, count);
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        CAReceivedPacketCallback(&packets[i].sep, packets[i].data, packets[i].dataLen);
+    }
+}
+
 static void CANetworkChangedCallback(const CAEndpoint_t *info, CANetworkStatus_t status)
 {
     OIC_LOG(DEBUG, TAG, "IN");
@@ -184,6 +209,7 @@ void CAInitializeAdapters(ca_thread_pool_t handle)
 #ifdef IP_ADAPTER
     CAInitializeIP(CARegisterCallback, CAReceivedPacketCallback, CANetworkChangedCallback,
                    CAAdapterErrorHandleCallback, handle);
+    CASetIPPacketBatchReceivedCallback(CAReceivedPacketBatchCallback);
 #endif /* IP_ADAPTER */
 
 #ifdef EDR_ADAPTER
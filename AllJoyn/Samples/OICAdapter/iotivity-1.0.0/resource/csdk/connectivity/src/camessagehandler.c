@@ -40,7 +40,6 @@
 #endif
 
 #ifndef  SINGLE_THREAD
-#include "uqueue.h"
 #include "cathreadpool.h" /* for thread pool */
 #include "caqueueingthread.h"
 
@@ -54,6 +53,12 @@ static ca_thread_pool_t g_threadPoolHandle = NULL;
 static CAQueueingThread_t g_sendThread;
 static CAQueueingThread_t g_receiveThread;
 
+// protects the reference counts of received data
+static ca_mutex g_receivedDataMutex = NULL;
+
+// set by CASignalReceivedData to end CAWaitForReceivedData early
+static bool g_receivedDataSignaled = false;
+
 #else
 #define CA_MAX_RT_ARRAY_SIZE    3
 #endif  /* SINGLE_THREAD */
@@ -248,6 +253,165 @@ static CAData_t* CAGenerateHandlerData(const CAEndpoint_t *endpoint,
     OIC_LOG(DEBUG, TAG, "CAGenerateHandlerData OUT");
 }
 
+/**
+ * Received request or response in one allocation, followed by the storage
+ * for the header options and the resource uri. The info borrows token and
+ * payload from pdu, so both live until the last reference is released.
+ */
+typedef struct CAReceivedData
+{
+    CAData_t data;
+    CAEndpoint_t endpoint;
+    union
+    {
+        CARequestInfo_t requestInfo;
+        CAResponseInfo_t responseInfo;
+    } info;
+    CAInfo_t borrowedInfo;      /**< the info as parsed, to find replaced fields */
+    coap_pdu_t *pdu;
+    uint32_t refCount;
+} CAReceivedData_t;
+
+CAData_t *CAGenerateReceivedData(const CAEndpoint_t *endpoint, const CARemoteId_t *identity,
+                                 coap_pdu_t *pdu, CADataType_t dataType)
+{
+    VERIFY_NON_NULL_RET(endpoint, TAG, "endpoint", NULL);
+    VERIFY_NON_NULL_RET(pdu, TAG, "pdu", NULL);
+
+    if (CA_REQUEST_DATA != dataType && CA_RESPONSE_DATA != dataType)
+    {
+        OIC_LOG(ERROR, TAG, "not supported data type");
+        return NULL;
+    }
+
+    size_t storageSize = CAGetBorrowedInfoSize(pdu, endpoint);
+    CAReceivedData_t *received = (CAReceivedData_t *) OICMalloc(sizeof(CAReceivedData_t)
+                                                                + storageSize);
+    if (!received)
+    {
+        OIC_LOG(ERROR, TAG, "memory allocation failed");
+        return NULL;
+    }
+    memset(received, 0, sizeof(CAReceivedData_t));
+
+    CAInfo_t *info = NULL;
+    uint32_t code = CA_NOT_FOUND;
+    if (CA_RESPONSE_DATA == dataType)
+    {
+        info = &received->info.responseInfo.info;
+    }
+    else
+    {
+        info = &received->info.requestInfo.info;
+    }
+
+    CAResult_t result = CAGetBorrowedInfoFromPDU(pdu, endpoint, &code, info,
+                                                 received + 1, storageSize);
+    if (CA_STATUS_OK != result)
+    {
+        OIC_LOG(ERROR, TAG, "CAGetBorrowedInfoFromPDU failed");
+        OICFree(received);
+        return NULL;
+    }
+
+    if (CA_RESPONSE_DATA == dataType)
+    {
+        received->info.responseInfo.result = code;
+        received->data.responseInfo = &received->info.responseInfo;
+    }
+    else
+    {
+        if (CADropSecondMessage(&caglobals.ca.requestHistory, endpoint, info->messageId,
+                                info->token, info->tokenLength))
+        {
+            OIC_LOG(ERROR, TAG, "Second Request with same Token, Drop it");
+            OICFree(received);
+            return NULL;
+        }
+        received->info.requestInfo.method = code;
+        received->data.requestInfo = &received->info.requestInfo;
+    }
+
+    if (identity)
+    {
+        info->identity = *identity;
+    }
+    OIC_LOG(DEBUG, TAG, "Received Info :");
+    CALogPayloadInfo(info);
+
+    received->endpoint = *endpoint;
+    received->borrowedInfo = *info;
+    received->pdu = pdu;
+    received->refCount = 1;
+
+    received->data.remoteEndpoint = &received->endpoint;
+    received->data.dataType = dataType;
+    received->data.receivedData = received;
+
+    return &received->data;
+}
+
+CAData_t *CAHoldReceivedData(CAData_t *data)
+{
+    VERIFY_NON_NULL_RET(data, TAG, "data", NULL);
+    VERIFY_NON_NULL_RET(data->receivedData, TAG, "receivedData", NULL);
+
+#ifndef SINGLE_THREAD
+    ca_mutex_lock(g_receivedDataMutex);
+#endif
+    data->receivedData->refCount++;
+#ifndef SINGLE_THREAD
+    ca_mutex_unlock(g_receivedDataMutex);
+#endif
+
+    return data;
+}
+
+void CAReleaseReceivedData(CAData_t *data)
+{
+    VERIFY_NON_NULL_VOID(data, TAG, "data");
+    CAReceivedData_t *received = data->receivedData;
+    VERIFY_NON_NULL_VOID(received, TAG, "receivedData");
+
+#ifndef SINGLE_THREAD
+    ca_mutex_lock(g_receivedDataMutex);
+#endif
+    uint32_t refCount = --received->refCount;
+#ifndef SINGLE_THREAD
+    ca_mutex_unlock(g_receivedDataMutex);
+#endif
+
+    if (0 < refCount)
+    {
+        return;
+    }
+
+    // fields replaced after parsing, e.g. the token of an empty message,
+    // are owned by the info
+    CAInfo_t *info = data->responseInfo ? &data->responseInfo->info
+                                        : &data->requestInfo->info;
+    const CAInfo_t *borrowed = &received->borrowedInfo;
+    if (info->token != borrowed->token)
+    {
+        OICFree(info->token);
+    }
+    if (info->payload != borrowed->payload)
+    {
+        OICFree(info->payload);
+    }
+    if (info->options != borrowed->options)
+    {
+        OICFree(info->options);
+    }
+    if (info->resourceUri != borrowed->resourceUri)
+    {
+        OICFree(info->resourceUri);
+    }
+
+    coap_delete_pdu(received->pdu);
+    OICFree(received);
+}
+
 static void CATimeoutCallback(const CAEndpoint_t *endpoint, const void *pdu, uint32_t size)
 {
     VERIFY_NON_NULL_VOID(endpoint, TAG, "endpoint");
@@ -319,6 +483,13 @@ static void CADestroyData(void *data, uint32_t size)
         return;
     }
 
+    if (NULL != cadata->receivedData)
+    {
+        CAReleaseReceivedData(cadata);
+        OIC_LOG(DEBUG, TAG, "CADestroyData OUT");
+        return;
+    }
+
     if (NULL != cadata->remoteEndpoint)
     {
         CAFreeEndpoint(cadata->remoteEndpoint);
@@ -343,6 +514,29 @@ static void CADestroyData(void *data, uint32_t size)
     OIC_LOG(DEBUG, TAG, "CADestroyData OUT");
 }
 
+#ifndef SINGLE_THREAD
+static bool CAIsNonConfirmableData(const void *data, uint32_t size)
+{
+    if (NULL == data || (size_t)size < sizeof(CAData_t))
+    {
+        return false;
+    }
+
+    const CAData_t *cadata = (const CAData_t *) data;
+    if (NULL != cadata->requestInfo)
+    {
+        return CA_MSG_NONCONFIRM == cadata->requestInfo->info.type;
+    }
+    if (NULL != cadata->responseInfo)
+    {
+        return CA_MSG_NONCONFIRM == cadata->responseInfo->info.type;
+    }
+
+    // errors are only reported once
+    return false;
+}
+#endif
+
 #ifdef SINGLE_THREAD
 static void CAProcessReceivedData(CAData_t *data)
 {
@@ -707,11 +901,15 @@ static bool CADropSecondMessage(CAHistory_t *history, const CAEndpoint_t *ep, ui
     return ret;
 }
 
-static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
-                                     const void *data, uint32_t dataLen)
+/**
+ * Turn a received packet into data for the receive thread.
+ * @return  held data to process, or NULL if there is none or block-wise transfer took it.
+ */
+static CAData_t *CAPrepareReceivedPacket(const CASecureEndpoint_t *sep,
+                                         const void *data, uint32_t dataLen)
 {
-    VERIFY_NON_NULL_VOID(sep, TAG, "remoteEndpoint");
-    VERIFY_NON_NULL_VOID(data, TAG, "data");
+    VERIFY_NON_NULL_RET(sep, TAG, "remoteEndpoint", NULL);
+    VERIFY_NON_NULL_RET(data, TAG, "data", NULL);
 
     OIC_LOG(DEBUG, TAG, "received pdu data :");
     OIC_LOG_BUFFER(DEBUG, TAG,  data, dataLen);
@@ -724,28 +922,28 @@ static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
     if (NULL == pdu)
     {
         OIC_LOG(ERROR, TAG, "Parse PDU failed");
-        return;
+        return NULL;
     }
 
     OIC_LOG_V(DEBUG, TAG, "code = %d", code);
     if (CA_GET == code || CA_POST == code || CA_PUT == code || CA_DELETE == code)
     {
-        cadata = CAGenerateHandlerData(&(sep->endpoint), &(sep->identity), pdu, CA_REQUEST_DATA);
+        cadata = CAGenerateReceivedData(&(sep->endpoint), &(sep->identity), pdu, CA_REQUEST_DATA);
         if (!cadata)
         {
-            OIC_LOG(ERROR, TAG, "CAReceivedPacketCallback, CAGenerateHandlerData failed!");
+            OIC_LOG(ERROR, TAG, "CAReceivedPacketCallback, CAGenerateReceivedData failed!");
             coap_delete_pdu(pdu);
-            return;
+            return NULL;
         }
     }
     else
     {
-        cadata = CAGenerateHandlerData(&(sep->endpoint), &(sep->identity), pdu, CA_RESPONSE_DATA);
+        cadata = CAGenerateReceivedData(&(sep->endpoint), &(sep->identity), pdu, CA_RESPONSE_DATA);
         if (!cadata)
         {
-            OIC_LOG(ERROR, TAG, "CAReceivedPacketCallback, CAGenerateHandlerData failed!");
+            OIC_LOG(ERROR, TAG, "CAReceivedPacketCallback, CAGenerateReceivedData failed!");
             coap_delete_pdu(pdu);
-            return;
+            return NULL;
         }
 
 #ifdef TCP_ADAPTER
@@ -772,7 +970,7 @@ static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
                     if (CA_STATUS_OK != res)
                     {
                         OIC_LOG(ERROR, TAG, "fail to get Token from retransmission list");
-                        OICFree(info->token);
+                        info->token = NULL;
                         info->tokenLength = 0;
                     }
                 }
@@ -783,10 +981,8 @@ static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
 
     cadata->type = SEND_TYPE_UNICAST;
 
-#ifdef SINGLE_THREAD
-    CAProcessReceivedData(cadata);
-#else
-#ifdef WITH_BWT
+    CAData_t *received = NULL;
+#if !defined(SINGLE_THREAD) && defined(WITH_BWT)
     if (CA_ADAPTER_GATT_BTLE != sep->endpoint.adapter
 #ifdef TCP_ADAPTER
             && CA_ADAPTER_TCP != sep->endpoint.adapter
@@ -797,21 +993,151 @@ static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
         if (CA_NOT_SUPPORTED == res)
         {
             OIC_LOG(ERROR, TAG, "this message does not have block option");
-            CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
-        }
-        else
-        {
-            CADestroyData(cadata, sizeof(CAData_t));
+            received = CAHoldReceivedData(cadata);
         }
     }
     else
 #endif
     {
+        received = CAHoldReceivedData(cadata);
+    }
+
+    // the pdu is deleted with the last reference to the data
+    CAReleaseReceivedData(cadata);
+    return received;
+}
+
+static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
+                                     const void *data, uint32_t dataLen)
+{
+    CAData_t *cadata = CAPrepareReceivedPacket(sep, data, dataLen);
+    if (cadata)
+    {
+#ifdef SINGLE_THREAD
+        CAProcessReceivedData(cadata);
+#else
         CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+#endif
+    }
+}
+
+static void CAReceivedPacketBatchCallback(const CAReceivedPacket_t *packets, uint32_t count)
+{
+    VERIFY_NON_NULL_VOID(packets, TAG, "packets");
+
+#ifdef SINGLE_THREAD
+    for (uint32_t i = 0; i < count; i++)
+    {
+        CAReceivedPacketCallback(&packets[i].sep, packets[i].data, packets[i].dataLen);
+    }
+#else
+    // queued together, so the receive thread is woken once and takes them at once
+    CAQueueingThreadItem_t items[CA_QUEUEING_THREAD_BATCH_SIZE];
+    uint32_t itemCount = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        CAData_t *cadata = CAPrepareReceivedPacket(&packets[i].sep, packets[i].data,
+                                                   packets[i].dataLen);
+        if (cadata)
+        {
+            items[itemCount].data = cadata;
+            items[itemCount].size = sizeof(CAData_t);
+            itemCount++;
+        }
+
+        if (CA_QUEUEING_THREAD_BATCH_SIZE == itemCount || (i + 1 == count && itemCount))
+        {
+            CAQueueingThreadAddDataBatch(&g_receiveThread, items, itemCount);
+            itemCount = 0;
+        }
     }
 #endif
+}
 
-    coap_delete_pdu(pdu);
+CAResult_t CAWaitForReceivedData(uint32_t timeout)
+{
+#ifdef SINGLE_HANDLE
+    VERIFY_NON_NULL(g_receiveThread.threadMutex, TAG, "threadMutex");
+
+    CAResult_t res = CA_STATUS_OK;
+
+    // CAQueueingThreadAddData signals threadCond when the queue stops being empty
+    ca_mutex_lock(g_receiveThread.threadMutex);
+    if (!g_receivedDataSignaled && 0 == g_receiveThread.count)
+    {
+        if (0 == timeout)
+        {
+            res = CA_REQUEST_TIMEOUT;
+        }
+        else if (UINT32_MAX == timeout)
+        {
+            ca_cond_wait(g_receiveThread.threadCond, g_receiveThread.threadMutex);
+        }
+        else if (CA_WAIT_TIMEDOUT == ca_cond_wait_for(g_receiveThread.threadCond,
+                                                      g_receiveThread.threadMutex,
+                                                      (uint64_t) timeout * 1000))
+        {
+            res = CA_REQUEST_TIMEOUT;
+        }
+    }
+    g_receivedDataSignaled = false;
+    ca_mutex_unlock(g_receiveThread.threadMutex);
+
+    return res;
+#else
+    // received data is handled on a thread of its own or read in
+    // CAHandleRequestResponseCallbacks, there is nothing to wait for
+    (void)timeout;
+    return CA_NOT_SUPPORTED;
+#endif
+}
+
+void CASignalReceivedData()
+{
+#ifdef SINGLE_HANDLE
+    VERIFY_NON_NULL_VOID(g_receiveThread.threadMutex, TAG, "threadMutex");
+
+    ca_mutex_lock(g_receiveThread.threadMutex);
+    g_receivedDataSignaled = true;
+    ca_cond_broadcast(g_receiveThread.threadCond);
+    ca_mutex_unlock(g_receiveThread.threadMutex);
+#endif
+}
+
+CAResult_t CASetSendReceiveQueueLimit(uint32_t capacity, CAQueueOverflowPolicy_t policy)
+{
+#ifndef SINGLE_THREAD
+    CAResult_t res = CAQueueingThreadSetLimit(&g_sendThread, capacity, policy);
+    if (CA_STATUS_OK != res)
+    {
+        return res;
+    }
+    return CAQueueingThreadSetLimit(&g_receiveThread, capacity, policy);
+#else
+    (void)capacity;
+    (void)policy;
+    return CA_NOT_SUPPORTED;
+#endif
+}
+
+CAResult_t CAGetSendReceiveQueueStats(CAQueueStats_t *sendStats, CAQueueStats_t *receiveStats)
+{
+#ifndef SINGLE_THREAD
+    CAResult_t res = CA_STATUS_OK;
+    if (NULL != sendStats)
+    {
+        res = CAQueueingThreadGetStats(&g_sendThread, sendStats);
+    }
+    if (CA_STATUS_OK == res && NULL != receiveStats)
+    {
+        res = CAQueueingThreadGetStats(&g_receiveThread, receiveStats);
+    }
+    return res;
+#else
+    (void)sendStats;
+    (void)receiveStats;
+    return CA_NOT_SUPPORTED;
+#endif
 }
 
 static void CANetworkChangedCallback(const CAEndpoint_t *info, CANetworkStatus_t status)
@@ -834,47 +1160,35 @@ void CAHandleRequestResponseCallbacks()
     // #1 parse the data
     // #2 get endpoint
 
-    ca_mutex_lock(g_receiveThread.threadMutex);
-
-    u_queue_message_t *item = u_queue_get_element(g_receiveThread.dataQueue);
+    // take what has been received, up to a batch, with a single lock
+    CAQueueingThreadItem_t items[CA_QUEUEING_THREAD_BATCH_SIZE];
+    uint32_t count = CAQueueingThreadTakeData(&g_receiveThread, items,
+                                              CA_QUEUEING_THREAD_BATCH_SIZE);
 
-    ca_mutex_unlock(g_receiveThread.threadMutex);
-
-    if (NULL == item)
+    for (uint32_t i = 0; i < count; i++)
     {
-        return;
-    }
+        // get endpoint
+        CAData_t *td = (CAData_t *) items[i].data;
 
-    // get values
-    void *msg = item->msg;
+        if (td->requestInfo && g_requestHandler)
+        {
+            OIC_LOG_V(DEBUG, TAG, "request callback : %d", td->requestInfo->info.numOptions);
+            g_requestHandler(td->remoteEndpoint, td->requestInfo);
+        }
+        else if (td->responseInfo && g_responseHandler)
+        {
+            OIC_LOG_V(DEBUG, TAG, "response callback : %d", td->responseInfo->info.numOptions);
+            g_responseHandler(td->remoteEndpoint, td->responseInfo);
+        }
+        else if (td->errorInfo && g_errorHandler)
+        {
+            OIC_LOG_V(DEBUG, TAG, "error callback error: %d", td->errorInfo->result);
+            g_errorHandler(td->remoteEndpoint, td->errorInfo);
+        }
 
-    if (NULL == msg)
-    {
-        return;
+        CADestroyData(td, items[i].size);
     }
 
-    // get endpoint
-    CAData_t *td = (CAData_t *) msg;
-
-    if (td->requestInfo && g_requestHandler)
-    {
-        OIC_LOG_V(DEBUG, TAG, "request callback : %d", td->requestInfo->info.numOptions);
-        g_requestHandler(td->remoteEndpoint, td->requestInfo);
-    }
-    else if (td->responseInfo && g_responseHandler)
-    {
-        OIC_LOG_V(DEBUG, TAG, "response callback : %d", td->responseInfo->info.numOptions);
-        g_responseHandler(td->remoteEndpoint, td->responseInfo);
-    }
-    else if (td->errorInfo && g_errorHandler)
-    {
-        OIC_LOG_V(DEBUG, TAG, "error callback error: %d", td->errorInfo->result);
-        g_errorHandler(td->remoteEndpoint, td->errorInfo);
-    }
-
-    CADestroyData(msg, sizeof(CAData_t));
-    OICFree(item);
-
 #endif /* SINGLE_HANDLE */
 #endif
 }
@@ -953,7 +1267,7 @@ CAResult_t CADetachRequestMessage(const CAEndpoint_t *object, const CARequestInf
 
 #ifdef ARDUINO
     // If max retransmission queue is reached, then don't handle new request
-    if (CA_MAX_RT_ARRAY_SIZE == u_arraylist_length(g_retransmissionContext.dataList))
+    if (CA_MAX_RT_ARRAY_SIZE == g_retransmissionContext.count)
     {
         OIC_LOG(ERROR, TAG, "max RT queue size reached!");
         return CA_SEND_FAILED;
@@ -989,8 +1303,7 @@ CAResult_t CADetachRequestMessage(const CAEndpoint_t *object, const CARequestInf
         if(CA_NOT_SUPPORTED == res)
         {
             OIC_LOG(DEBUG, TAG, "normal msg will be sent");
-            CAQueueingThreadAddData(&g_sendThread, data, sizeof(CAData_t));
-            return CA_STATUS_OK;
+            return CAQueueingThreadAddData(&g_sendThread, data, sizeof(CAData_t));
         }
         else
         {
@@ -1001,7 +1314,7 @@ CAResult_t CADetachRequestMessage(const CAEndpoint_t *object, const CARequestInf
     else
 #endif
     {
-        CAQueueingThreadAddData(&g_sendThread, data, sizeof(CAData_t));
+        return CAQueueingThreadAddData(&g_sendThread, data, sizeof(CAData_t));
     }
 #endif
 
@@ -1048,8 +1361,7 @@ CAResult_t CADetachResponseMessage(const CAEndpoint_t *object,
         if(CA_NOT_SUPPORTED == res)
         {
             OIC_LOG(DEBUG, TAG, "normal msg will be sent");
-            CAQueueingThreadAddData(&g_sendThread, data, sizeof(CAData_t));
-            return CA_STATUS_OK;
+            return CAQueueingThreadAddData(&g_sendThread, data, sizeof(CAData_t));
         }
         else
         {
@@ -1060,7 +1372,7 @@ CAResult_t CADetachResponseMessage(const CAEndpoint_t *object,
     else
 #endif
     {
-        CAQueueingThreadAddData(&g_sendThread, data, sizeof(CAData_t));
+        return CAQueueingThreadAddData(&g_sendThread, data, sizeof(CAData_t));
     }
 #endif
 
@@ -1090,11 +1402,22 @@ void CASetInterfaceCallbacks(CARequestCallback ReqHandler, CAResponseCallback Re
 CAResult_t CAInitializeMessageHandler()
 {
     CASetPacketReceivedCallback(CAReceivedPacketCallback);
+    CASetPacketBatchReceivedCallback(CAReceivedPacketBatchCallback);
 
     CASetNetworkChangeCallback(CANetworkChangedCallback);
     CASetErrorHandleCallback(CAErrorHandler);
 
 #ifndef SINGLE_THREAD
+    if (NULL == g_receivedDataMutex)
+    {
+        g_receivedDataMutex = ca_mutex_new();
+        if (NULL == g_receivedDataMutex)
+        {
+            OIC_LOG(ERROR, TAG, "ca_mutex_new has failed");
+            return CA_STATUS_FAILED;
+        }
+    }
+
     // create thread pool
     CAResult_t res = ca_thread_pool_init(MAX_THREAD_POOL_SIZE, &g_threadPoolHandle);
 
@@ -1111,6 +1434,7 @@ CAResult_t CAInitializeMessageHandler()
         OIC_LOG(ERROR, TAG, "Failed to Initialize send queue thread");
         return CA_STATUS_FAILED;
     }
+    CAQueueingThreadSetDropCheck(&g_sendThread, CAIsNonConfirmableData);
 
     // start send thread
     res = CAQueueingThreadStart(&g_sendThread);
@@ -1130,6 +1454,8 @@ CAResult_t CAInitializeMessageHandler()
         OIC_LOG(ERROR, TAG, "Failed to Initialize receive queue thread");
         return CA_STATUS_FAILED;
     }
+    CAQueueingThreadSetDropCheck(&g_receiveThread, CAIsNonConfirmableData);
+    g_receivedDataSignaled = false;
 
 #ifndef SINGLE_HANDLE // This will be enabled when RI supports multi threading
     // start receive thread
@@ -1175,24 +1501,6 @@ CAResult_t CAInitializeMessageHandler()
 void CATerminateMessageHandler()
 {
 #ifndef SINGLE_THREAD
-    CATransportAdapter_t connType;
-    u_arraylist_t *list = CAGetSelectedNetworkList();
-    uint32_t length = u_arraylist_length(list);
-
-    uint32_t i = 0;
-    for (i = 0; i < length; i++)
-    {
-        void* ptrType = u_arraylist_get(list, i);
-
-        if (NULL == ptrType)
-        {
-            continue;
-        }
-
-        connType = *(CATransportAdapter_t *)ptrType;
-        CAStopAdapter(connType);
-    }
-
     // stop retransmission
     if (NULL != g_retransmissionContext.threadMutex)
     {
@@ -1215,6 +1523,26 @@ void CATerminateMessageHandler()
 #endif /* SINGLE_HANDLE */
     }
 
+    // stop adapters only after the send and retransmission threads are gone,
+    // since those hand data to the adapter queues that CAStopAdapter destroys
+    CATransportAdapter_t connType;
+    u_arraylist_t *list = CAGetSelectedNetworkList();
+    uint32_t length = u_arraylist_length(list);
+
+    uint32_t i = 0;
+    for (i = 0; i < length; i++)
+    {
+        void* ptrType = u_arraylist_get(list, i);
+
+        if (NULL == ptrType)
+        {
+            continue;
+        }
+
+        connType = *(CATransportAdapter_t *)ptrType;
+        CAStopAdapter(connType);
+    }
+
     // destroy thread pool
     if (NULL != g_threadPoolHandle)
     {
@@ -1229,6 +1557,10 @@ void CATerminateMessageHandler()
     CAQueueingThreadDestroy(&g_sendThread);
     CAQueueingThreadDestroy(&g_receiveThread);
 
+    // the receive queue releases its data on destroy
+    ca_mutex_free(g_receivedDataMutex);
+    g_receivedDataMutex = NULL;
+
     // terminate interface adapters by controller
     CATerminateAdapters();
 #else
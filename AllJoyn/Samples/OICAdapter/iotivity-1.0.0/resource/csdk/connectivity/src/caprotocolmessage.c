@@ -710,39 +710,37 @@ uint32_t CAGetOptionCount(coap_opt_iterator_t opt_iter)
     return count;
 }
 
-CAResult_t CAGetInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
-                            uint32_t *outCode, CAInfo_t *outInfo)
+static coap_transport_type CAGetTransportFromPDU(const coap_pdu_t *pdu,
+                                                 const CAEndpoint_t *endpoint)
 {
-    if (!pdu || !outCode || !outInfo)
-    {
-        OIC_LOG(ERROR, TAG, "NULL pointer param");
-        return CA_STATUS_INVALID_PARAM;
-    }
-
-    coap_transport_type transport;
 #ifdef TCP_ADAPTER
     if (CA_ADAPTER_TCP == endpoint->adapter)
     {
-        transport = coap_get_tcp_header_type_from_initbyte(((unsigned char *)pdu->hdr)[0] >> 4);
+        return coap_get_tcp_header_type_from_initbyte(((unsigned char *)pdu->hdr)[0] >> 4);
     }
-    else
+#else
+    (void)pdu;
+    (void)endpoint;
 #endif
-    {
-        transport = coap_udp;
-    }
+    return coap_udp;
+}
 
-    coap_opt_iterator_t opt_iter;
-    coap_option_iterator_init((coap_pdu_t *) pdu, &opt_iter, COAP_OPT_ALL, transport);
+/**
+ * Fills outInfo from pdu without allocating anything. token and payload
+ * point into pdu, the header options go to outInfo->options, which has room
+ * for count options, and the resource URI to uri.
+ */
+static CAResult_t CAParseInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
+                                     uint32_t count, uint32_t *outCode, CAInfo_t *outInfo,
+                                     char *uri, size_t uriSize)
+{
+    coap_transport_type transport = CAGetTransportFromPDU(pdu, endpoint);
 
     if (outCode)
     {
         (*outCode) = (uint32_t) CA_RESPONSE_CODE(coap_get_code(pdu, transport));
     }
 
-    // init HeaderOption list
-    uint32_t count = CAGetOptionCount(opt_iter);
-    memset(outInfo, 0, sizeof(*outInfo));
-
     outInfo->numOptions = count;
 
 #ifdef TCP_ADAPTER
@@ -764,155 +762,105 @@ CAResult_t CAGetInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
         outInfo->acceptFormat = CA_FORMAT_UNDEFINED;
     }
 
-    if (count > 0)
-    {
-        outInfo->options = (CAHeaderOption_t *) OICCalloc(count, sizeof(CAHeaderOption_t));
-        if (NULL == outInfo->options)
-        {
-            OIC_LOG(ERROR, TAG, "Out of memory");
-            return CA_MEMORY_ALLOC_FAILED;
-        }
-    }
+    coap_opt_iterator_t opt_iter;
+    coap_option_iterator_init((coap_pdu_t *) pdu, &opt_iter, COAP_OPT_ALL, transport);
 
     coap_opt_t *option;
-    char optionResult[CA_MAX_URI_LENGTH] = {0};
+    size_t uriLength = 0;
     uint32_t idx = 0;
-    uint32_t optionLength = 0;
-    bool isfirstsetflag = false;
     bool isQueryBeingProcessed = false;
 
     while ((option = coap_option_next(&opt_iter)))
     {
-        char buf[COAP_MAX_PDU_SIZE] = {0};
-        uint32_t bufLength =
-            CAGetOptionData(opt_iter.type, (uint8_t *)(COAP_OPT_VALUE(option)),
-                    COAP_OPT_LENGTH(option), (uint8_t *)buf, sizeof(buf));
-        if (bufLength)
+        const uint8_t *value = COAP_OPT_VALUE(option);
+        uint32_t length = COAP_OPT_LENGTH(option);
+        const uint8_t zero = 0;
+
+        if (0 == length)
         {
-            OIC_LOG_V(DEBUG, TAG, "COAP URI element : %s", buf);
-            if (COAP_OPTION_URI_PATH == opt_iter.type || COAP_OPTION_URI_QUERY == opt_iter.type)
+            // like CAGetOptionData, a 0 length option with variable byte
+            // encoding is passed on as a single 0 byte and others are dropped
+            coap_option_def_t *def = coap_opt_def(opt_iter.type);
+            if (NULL == def || !coap_is_var_bytes(def))
             {
-                if (false == isfirstsetflag)
-                {
-                    isfirstsetflag = true;
-                    optionResult[optionLength] = '/';
-                    optionLength++;
-                    // Make sure there is enough room in the optionResult buffer
-                    if ((optionLength + bufLength) < sizeof(optionResult))
-                    {
-                        memcpy(&optionResult[optionLength], buf, bufLength);
-                        optionLength += bufLength;
-                    }
-                    else
-                    {
-                        goto exit;
-                    }
-                }
-                else
-                {
-                    if (COAP_OPTION_URI_PATH == opt_iter.type)
-                    {
-                        // Make sure there is enough room in the optionResult buffer
-                        if (optionLength < sizeof(optionResult))
-                        {
-                            optionResult[optionLength] = '/';
-                            optionLength++;
-                        }
-                        else
-                        {
-                            goto exit;
-                        }
-                    }
-                    else if (COAP_OPTION_URI_QUERY == opt_iter.type)
-                    {
-                        if (false == isQueryBeingProcessed)
-                        {
-                            // Make sure there is enough room in the optionResult buffer
-                            if (optionLength < sizeof(optionResult))
-                            {
-                                optionResult[optionLength] = '?';
-                                optionLength++;
-                                isQueryBeingProcessed = true;
-                            }
-                            else
-                            {
-                                goto exit;
-                            }
-                        }
-                        else
-                        {
-                            // Make sure there is enough room in the optionResult buffer
-                            if (optionLength < sizeof(optionResult))
-                            {
-                                optionResult[optionLength] = ';';
-                                optionLength++;
-                            }
-                            else
-                            {
-                                goto exit;
-                            }
-                        }
-                    }
-                    // Make sure there is enough room in the optionResult buffer
-                    if ((optionLength + bufLength) < sizeof(optionResult))
-                    {
-                        memcpy(&optionResult[optionLength], buf, bufLength);
-                        optionLength += bufLength;
-                    }
-                    else
-                    {
-                        goto exit;
-                    }
-                }
+                continue;
+            }
+            value = &zero;
+            length = 1;
+        }
+
+        if (COAP_OPTION_URI_PATH == opt_iter.type || COAP_OPTION_URI_QUERY == opt_iter.type)
+        {
+            // "/path/path?query;query", the first element always gets '/'
+            char separator = '/';
+            if (0 != uriLength && COAP_OPTION_URI_QUERY == opt_iter.type)
+            {
+                separator = isQueryBeingProcessed ? ';' : '?';
+                isQueryBeingProcessed = true;
             }
-            else if (COAP_OPTION_BLOCK1 == opt_iter.type || COAP_OPTION_BLOCK2 == opt_iter.type
-                    || COAP_OPTION_SIZE1 == opt_iter.type || COAP_OPTION_SIZE2 == opt_iter.type)
+
+            // Make sure there is enough room in the uri buffer
+            if (uriLength + 1 + length >= uriSize)
             {
-                OIC_LOG_V(DEBUG, TAG, "option[%d] will be filtering", opt_iter.type);
+                OIC_LOG(ERROR, TAG, "buffer too small");
+                return CA_STATUS_FAILED;
             }
-            else if (COAP_OPTION_CONTENT_FORMAT == opt_iter.type)
+            uri[uriLength++] = separator;
+            memcpy(&uri[uriLength], value, length);
+            uriLength += length;
+        }
+        else if (COAP_OPTION_BLOCK1 == opt_iter.type || COAP_OPTION_BLOCK2 == opt_iter.type
+                || COAP_OPTION_SIZE1 == opt_iter.type || COAP_OPTION_SIZE2 == opt_iter.type)
+        {
+            OIC_LOG_V(DEBUG, TAG, "option[%d] will be filtering", opt_iter.type);
+        }
+        else if (COAP_OPTION_CONTENT_FORMAT == opt_iter.type)
+        {
+            if (1 == COAP_OPT_LENGTH(option))
             {
-                if (1 == COAP_OPT_LENGTH(option))
-                {
-                    outInfo->payloadFormat = CAConvertFormat((uint8_t)buf[0]);
-                }
-                else
-                {
-                    outInfo->payloadFormat = CA_FORMAT_UNSUPPORTED;
-                    OIC_LOG_V(DEBUG, TAG, "option[%d] has an unsupported format [%d]",
-                            opt_iter.type, (uint8_t)buf[0]);
-                }
+                outInfo->payloadFormat = CAConvertFormat(value[0]);
             }
-            else if (COAP_OPTION_ACCEPT == opt_iter.type)
+            else
             {
-                if (1 == COAP_OPT_LENGTH(option))
-                {
-                    outInfo->acceptFormat = CAConvertFormat((uint8_t)buf[0]);
-                }
-                else
-                {
-                    outInfo->acceptFormat = CA_FORMAT_UNSUPPORTED;
-                }
+                outInfo->payloadFormat = CA_FORMAT_UNSUPPORTED;
                 OIC_LOG_V(DEBUG, TAG, "option[%d] has an unsupported format [%d]",
-                        opt_iter.type, (uint8_t)buf[0]);
+                        opt_iter.type, value[0]);
+            }
+        }
+        else if (COAP_OPTION_ACCEPT == opt_iter.type)
+        {
+            if (1 == COAP_OPT_LENGTH(option))
+            {
+                outInfo->acceptFormat = CAConvertFormat(value[0]);
             }
             else
             {
-                if (idx < count)
+                outInfo->acceptFormat = CA_FORMAT_UNSUPPORTED;
+            }
+            OIC_LOG_V(DEBUG, TAG, "option[%d] has an unsupported format [%d]",
+                    opt_iter.type, value[0]);
+        }
+        else
+        {
+            if (idx < count)
+            {
+                if (length <= sizeof(outInfo->options[0].optionData))
                 {
-                    if (bufLength <= sizeof(outInfo->options[0].optionData))
-                    {
-                        outInfo->options[idx].optionID = opt_iter.type;
-                        outInfo->options[idx].optionLength = bufLength;
-                        outInfo->options[idx].protocolID = CA_COAP_ID;
-                        memcpy(outInfo->options[idx].optionData, buf, bufLength);
-                        idx++;
-                    }
+                    outInfo->options[idx].optionID = opt_iter.type;
+                    outInfo->options[idx].optionLength = length;
+                    outInfo->options[idx].protocolID = CA_COAP_ID;
+                    memcpy(outInfo->options[idx].optionData, value, length);
+                    idx++;
                 }
             }
         }
     }
 
+    if (uriSize > 0)
+    {
+        uri[uriLength] = '\0';
+    }
+
     unsigned char* token = NULL;
     unsigned int token_length = 0;
     coap_get_token(pdu->hdr, transport, &token, &token_length);
@@ -921,34 +869,85 @@ CAResult_t CAGetInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
     if (token_length > 0)
     {
         OIC_LOG_V(DEBUG, TAG, "inside token length : %d", token_length);
-        outInfo->token = (char *) OICMalloc(token_length);
-        if (NULL == outInfo->token)
-        {
-            OIC_LOG(ERROR, TAG, "Out of memory");
-            OICFree(outInfo->options);
-            return CA_MEMORY_ALLOC_FAILED;
-        }
-        memcpy(outInfo->token, token, token_length);
+        outInfo->token = (CAToken_t) token;
     }
-
     outInfo->tokenLength = token_length;
 
     // set payload data
     size_t dataSize;
     uint8_t *data;
-    if (coap_get_data(pdu, &dataSize, &data))
+    if (coap_get_data((coap_pdu_t *) pdu, &dataSize, &data))
     {
         OIC_LOG(DEBUG, TAG, "inside pdu->data");
-        outInfo->payload = (uint8_t *) OICMalloc(dataSize);
-        if (NULL == outInfo->payload)
+        outInfo->payload = data;
+        outInfo->payloadSize = dataSize;
+    }
+
+    return CA_STATUS_OK;
+}
+
+CAResult_t CAGetInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
+                            uint32_t *outCode, CAInfo_t *outInfo)
+{
+    if (!pdu || !outCode || !outInfo)
+    {
+        OIC_LOG(ERROR, TAG, "NULL pointer param");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    coap_opt_iterator_t opt_iter;
+    coap_option_iterator_init((coap_pdu_t *) pdu, &opt_iter, COAP_OPT_ALL,
+                              CAGetTransportFromPDU(pdu, endpoint));
+
+    // init HeaderOption list
+    uint32_t count = CAGetOptionCount(opt_iter);
+    memset(outInfo, 0, sizeof(*outInfo));
+
+    if (count > 0)
+    {
+        outInfo->options = (CAHeaderOption_t *) OICCalloc(count, sizeof(CAHeaderOption_t));
+        if (NULL == outInfo->options)
+        {
+            OIC_LOG(ERROR, TAG, "Out of memory");
+            return CA_MEMORY_ALLOC_FAILED;
+        }
+    }
+
+    char optionResult[CA_MAX_URI_LENGTH] = {0};
+    CAResult_t res = CAParseInfoFromPDU(pdu, endpoint, count, outCode, outInfo,
+                                        optionResult, sizeof(optionResult));
+    if (CA_STATUS_OK != res)
+    {
+        OICFree(outInfo->options);
+        return res;
+    }
+
+    // the borrowed token and payload are replaced by copies
+    if (outInfo->token)
+    {
+        CAToken_t token = (CAToken_t) OICMalloc(outInfo->tokenLength);
+        if (NULL == token)
+        {
+            OIC_LOG(ERROR, TAG, "Out of memory");
+            OICFree(outInfo->options);
+            return CA_MEMORY_ALLOC_FAILED;
+        }
+        memcpy(token, outInfo->token, outInfo->tokenLength);
+        outInfo->token = token;
+    }
+
+    if (outInfo->payload)
+    {
+        CAPayload_t payload = (CAPayload_t) OICMalloc(outInfo->payloadSize);
+        if (NULL == payload)
         {
             OIC_LOG(ERROR, TAG, "Out of memory");
             OICFree(outInfo->options);
             OICFree(outInfo->token);
             return CA_MEMORY_ALLOC_FAILED;
         }
-        memcpy(outInfo->payload, pdu->data, dataSize);
-        outInfo->payloadSize = dataSize;
+        memcpy(payload, outInfo->payload, outInfo->payloadSize);
+        outInfo->payload = payload;
     }
 
     if (optionResult[0] != '\0')
@@ -960,16 +959,92 @@ CAResult_t CAGetInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
             OIC_LOG(ERROR, TAG, "Out of memory");
             OICFree(outInfo->options);
             OICFree(outInfo->token);
+            OICFree(outInfo->payload);
             return CA_MEMORY_ALLOC_FAILED;
         }
     }
 
     return CA_STATUS_OK;
+}
+
+size_t CAGetBorrowedInfoSize(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint)
+{
+    VERIFY_NON_NULL_RET(pdu, TAG, "pdu", 0);
 
-exit:
-    OIC_LOG(ERROR, TAG, "buffer too small");
-    OICFree(outInfo->options);
-    return CA_STATUS_FAILED;
+    coap_opt_iterator_t opt_iter;
+    coap_option_iterator_init((coap_pdu_t *) pdu, &opt_iter, COAP_OPT_ALL,
+                              CAGetTransportFromPDU(pdu, endpoint));
+
+    // every URI element takes its length and a separator, plus the terminator
+    size_t uriSize = 1;
+    uint32_t count = 0;
+    coap_opt_t *option;
+    while ((option = coap_option_next(&opt_iter)))
+    {
+        if (COAP_OPTION_URI_PATH == opt_iter.type || COAP_OPTION_URI_QUERY == opt_iter.type)
+        {
+            uriSize += COAP_OPT_LENGTH(option) + 1;
+        }
+        else if (COAP_OPTION_BLOCK1 != opt_iter.type && COAP_OPTION_BLOCK2 != opt_iter.type
+                 && COAP_OPTION_SIZE1 != opt_iter.type && COAP_OPTION_SIZE2 != opt_iter.type
+                 && COAP_OPTION_CONTENT_FORMAT != opt_iter.type
+                 && COAP_OPTION_ACCEPT != opt_iter.type)
+        {
+            count++;
+        }
+    }
+
+    if (uriSize > CA_MAX_URI_LENGTH)
+    {
+        uriSize = CA_MAX_URI_LENGTH;
+    }
+
+    return count * sizeof(CAHeaderOption_t) + uriSize;
+}
+
+CAResult_t CAGetBorrowedInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
+                                    uint32_t *outCode, CAInfo_t *outInfo,
+                                    void *storage, size_t storageSize)
+{
+    if (!pdu || !outCode || !outInfo || !storage)
+    {
+        OIC_LOG(ERROR, TAG, "NULL pointer param");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    coap_opt_iterator_t opt_iter;
+    coap_option_iterator_init((coap_pdu_t *) pdu, &opt_iter, COAP_OPT_ALL,
+                              CAGetTransportFromPDU(pdu, endpoint));
+
+    uint32_t count = CAGetOptionCount(opt_iter);
+    size_t optionsSize = count * sizeof(CAHeaderOption_t);
+    if (optionsSize >= storageSize)
+    {
+        OIC_LOG(ERROR, TAG, "storage too small");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    memset(outInfo, 0, sizeof(*outInfo));
+    if (count > 0)
+    {
+        outInfo->options = (CAHeaderOption_t *) storage;
+        memset(outInfo->options, 0, optionsSize);
+    }
+
+    char *uri = (char *) storage + optionsSize;
+    CAResult_t res = CAParseInfoFromPDU(pdu, endpoint, count, outCode, outInfo,
+                                        uri, storageSize - optionsSize);
+    if (CA_STATUS_OK != res)
+    {
+        return res;
+    }
+
+    if (uri[0] != '\0')
+    {
+        outInfo->resourceUri = uri;
+    }
+
+    return CA_STATUS_OK;
 }
 
 CAResult_t CAGetTokenFromPDU(const coap_hdr_t *pdu_hdr, CAInfo_t *outInfo,
@@ -27,11 +27,174 @@
 #endif
 
 #include "caqueueingthread.h"
+#include "caretransmission.h"
 #include "oic_malloc.h"
 #include "logger.h"
 
 #define TAG PCF("CA_QING")
 
+/** initial number of slots of the ring. **/
+#define CA_QUEUEING_THREAD_INIT_SIZE (16)
+
+static void CAQueueingThreadDestroyData(CAQueueingThread_t *thread, void *data, uint32_t size)
+{
+    if (NULL != thread->destroy)
+    {
+        thread->destroy(data, size);
+    }
+    else
+    {
+        OICFree(data);
+    }
+}
+
+/**
+ * Take up to count of the oldest data.  Called with the thread mutex held.
+ */
+static uint32_t CAQueueingThreadTakeItems(CAQueueingThread_t *thread,
+                                          CAQueueingThreadItem_t *items, uint32_t count)
+{
+    if (count > thread->count)
+    {
+        count = thread->count;
+    }
+    if (0 == count)
+    {
+        return 0;
+    }
+
+    uint64_t currentTime = getCurrentTimeInMicroSeconds();
+    uint32_t mask = thread->itemsSize - 1;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        items[i] = thread->items[(thread->head + i) & mask];
+
+        uint64_t latency = (currentTime > items[i].addTime) ? currentTime - items[i].addTime : 0;
+        thread->stats.totalLatency += latency;
+        if (latency > thread->stats.maxLatency)
+        {
+            thread->stats.maxLatency = latency;
+        }
+    }
+    thread->head = (thread->head + count) & mask;
+    thread->count -= count;
+    thread->stats.dequeued += count;
+
+    if (0 < thread->blockedSenders)
+    {
+        ca_cond_broadcast(thread->spaceCond);
+    }
+    return count;
+}
+
+/**
+ * Remove the oldest data that may be dropped.  Called with the thread mutex held.
+ * The items before it move up one slot, which is cheap since it is usually near the head.
+ */
+static bool CAQueueingThreadDropOldest(CAQueueingThread_t *thread, CAQueueingThreadItem_t *dropped)
+{
+    if (NULL == thread->dropCheck)
+    {
+        return false;
+    }
+
+    uint32_t mask = thread->itemsSize - 1;
+    for (uint32_t i = 0; i < thread->count; i++)
+    {
+        CAQueueingThreadItem_t *item = &thread->items[(thread->head + i) & mask];
+        if (!thread->dropCheck(item->data, item->size))
+        {
+            continue;
+        }
+
+        *dropped = *item;
+        for (uint32_t j = i; j > 0; j--)
+        {
+            thread->items[(thread->head + j) & mask] = thread->items[(thread->head + j - 1) & mask];
+        }
+        thread->head = (thread->head + 1) & mask;
+        thread->count--;
+        thread->stats.dropped++;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Make room in a full queue according to its policy.  Called with the thread mutex held.
+ */
+static CAResult_t CAQueueingThreadMakeRoom(CAQueueingThread_t *thread,
+                                           CAQueueingThreadItem_t *dropped)
+{
+    switch (thread->overflowPolicy)
+    {
+        case CA_QUEUE_DROP_OLDEST_NON:
+            if (CAQueueingThreadDropOldest(thread, dropped))
+            {
+                return CA_STATUS_OK;
+            }
+            break;
+
+        case CA_QUEUE_BLOCK:
+        {
+            // the sender may be the one emptying the queue, so only wait a while
+            uint64_t deadline = getCurrentTimeInMicroSeconds() + CA_QUEUEING_THREAD_BLOCK_TIMEOUT;
+            thread->blockedSenders++;
+            thread->stats.blocked++;
+            while (thread->count >= thread->capacity)
+            {
+                uint64_t currentTime = getCurrentTimeInMicroSeconds();
+                if (currentTime >= deadline
+                    || CA_WAIT_TIMEDOUT == ca_cond_wait_for(thread->spaceCond, thread->threadMutex,
+                                                            deadline - currentTime))
+                {
+                    break;
+                }
+            }
+            thread->blockedSenders--;
+            if (thread->count < thread->capacity)
+            {
+                return CA_STATUS_OK;
+            }
+            break;
+        }
+
+        case CA_QUEUE_REJECT:
+        default:
+            break;
+    }
+
+    thread->stats.rejected++;
+    return CA_STATUS_FAILED;
+}
+
+/**
+ * Double the ring.  Called with the thread mutex held.
+ */
+static CAResult_t CAQueueingThreadGrow(CAQueueingThread_t *thread)
+{
+    uint32_t size = thread->itemsSize ? thread->itemsSize * 2 : CA_QUEUEING_THREAD_INIT_SIZE;
+    CAQueueingThreadItem_t *items =
+        (CAQueueingThreadItem_t *) OICMalloc(size * sizeof(CAQueueingThreadItem_t));
+    if (NULL == items)
+    {
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    // unwrap the ring so that the oldest data is in the first slot
+    uint32_t mask = thread->itemsSize - 1;
+    for (uint32_t i = 0; i < thread->count; i++)
+    {
+        items[i] = thread->items[(thread->head + i) & mask];
+    }
+
+    OICFree(thread->items);
+    thread->items = items;
+    thread->itemsSize = size;
+    thread->head = 0;
+    return CA_STATUS_OK;
+}
+
 static void CAQueueingThreadBaseRoutine(void *threadValue)
 {
     OIC_LOG(DEBUG, TAG, "message handler main thread start..");
@@ -45,13 +208,15 @@ static void CAQueueingThreadBaseRoutine(void *threadValue)
         return;
     }
 
+    CAQueueingThreadItem_t batch[CA_QUEUEING_THREAD_BATCH_SIZE];
+
     while (!thread->isStop)
     {
         // mutex lock
         ca_mutex_lock(thread->threadMutex);
 
         // if queue is empty, thread will wait
-        if (!thread->isStop && u_queue_get_size(thread->dataQueue) <= 0)
+        if (!thread->isStop && 0 == thread->count)
         {
             OIC_LOG(DEBUG, TAG, "wait..");
 
@@ -61,8 +226,6 @@ static void CAQueueingThreadBaseRoutine(void *threadValue)
             OIC_LOG(DEBUG, TAG, "wake up..");
         }
 
-
-
         // check stop flag
         if (thread->isStop)
         {
@@ -71,55 +234,38 @@ static void CAQueueingThreadBaseRoutine(void *threadValue)
             continue;
         }
 
-        // get data
-        u_queue_message_t *message = u_queue_get_element(thread->dataQueue);
+        // get data, as much as there is up to a batch
+        uint32_t count = CAQueueingThreadTakeItems(thread, batch, CA_QUEUEING_THREAD_BATCH_SIZE);
         // mutex unlock
         ca_mutex_unlock(thread->threadMutex);
-        if (NULL == message)
-        {
-            continue;
-        }
 
-        // process data
-        thread->threadTask(message->msg);
-
-        // free
-        if (NULL != thread->destroy)
-        {
-            thread->destroy(message->msg, message->size);
-        }
-        else
+        for (uint32_t i = 0; i < count; i++)
         {
-            OICFree(message->msg);
-        }
+            // process data
+            thread->threadTask(batch[i].data);
 
-        OICFree(message);
+            // free
+            CAQueueingThreadDestroyData(thread, batch[i].data, batch[i].size);
+        }
     }
 
     // remove all remained list data.
-    while (u_queue_get_size(thread->dataQueue) > 0)
+    uint32_t count = 0;
+    do
     {
-        // get data
-        u_queue_message_t *message = u_queue_get_element(thread->dataQueue);
+        ca_mutex_lock(thread->threadMutex);
+        count = CAQueueingThreadTakeItems(thread, batch, CA_QUEUEING_THREAD_BATCH_SIZE);
+        ca_mutex_unlock(thread->threadMutex);
 
-        // free
-        if(NULL != message)
+        for (uint32_t i = 0; i < count; i++)
         {
-            if (NULL != thread->destroy)
-            {
-                thread->destroy(message->msg, message->size);
-            }
-            else
-            {
-                OICFree(message->msg);
-            }
-
-            OICFree(message);
+            CAQueueingThreadDestroyData(thread, batch[i].data, batch[i].size);
         }
-    }
+    } while (0 < count);
 
     ca_mutex_lock(thread->threadMutex);
-    ca_cond_signal(thread->threadCond);
+    thread->isRunning = false;
+    ca_cond_broadcast(thread->threadCond);
     ca_mutex_unlock(thread->threadMutex);
 
     OIC_LOG(DEBUG, TAG, "message handler main thread end..");
@@ -143,23 +289,23 @@ CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool
     OIC_LOG(DEBUG, TAG, "thread initialize..");
 
     // set send thread data
+    memset(thread, 0, sizeof(CAQueueingThread_t));
     thread->threadPool = handle;
-    thread->dataQueue = u_queue_create();
     thread->threadMutex = ca_mutex_new();
     thread->threadCond = ca_cond_new();
+    thread->spaceCond = ca_cond_new();
     thread->isStop = true;
+    thread->isRunning = false;
     thread->threadTask = task;
     thread->destroy = destroy;
-    if(NULL == thread->dataQueue || NULL == thread->threadMutex || NULL == thread->threadCond)
+    thread->capacity = CA_QUEUEING_THREAD_DEFAULT_CAPACITY;
+    thread->overflowPolicy = CA_QUEUE_DROP_OLDEST_NON;
+    if(NULL == thread->threadMutex || NULL == thread->threadCond || NULL == thread->spaceCond
+       || CA_STATUS_OK != CAQueueingThreadGrow(thread))
         goto ERROR_MEM_FAILURE;
 
     return CA_STATUS_OK;
     ERROR_MEM_FAILURE:
-    if(thread->dataQueue)
-    {
-        u_queue_delete(thread->dataQueue);
-        thread->dataQueue = NULL;
-    }
     if(thread->threadMutex)
     {
         ca_mutex_free(thread->threadMutex);
@@ -170,6 +316,11 @@ CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool
         ca_cond_free(thread->threadCond);
         thread->threadCond = NULL;
     }
+    if(thread->spaceCond)
+    {
+        ca_cond_free(thread->spaceCond);
+        thread->spaceCond = NULL;
+    }
     return CA_MEMORY_ALLOC_FAILED;
 
 }
@@ -197,14 +348,63 @@ CAResult_t CAQueueingThreadStart(CAQueueingThread_t *thread)
     // mutex lock
     ca_mutex_lock(thread->threadMutex);
     thread->isStop = false;
+    thread->isRunning = true;
     // mutex unlock
     ca_mutex_unlock(thread->threadMutex);
 
-    CAResult_t res = ca_thread_pool_add_task(thread->threadPool, CAQueueingThreadBaseRoutine,
-                                            thread);
+    CAResult_t res = ca_thread_pool_add_dedicated_task(thread->threadPool,
+                                                       CAQueueingThreadBaseRoutine, thread);
     if (res != CA_STATUS_OK)
     {
         OIC_LOG(ERROR, TAG, "thread pool add task error(send thread).");
+        ca_mutex_lock(thread->threadMutex);
+        thread->isStop = true;
+        thread->isRunning = false;
+        ca_mutex_unlock(thread->threadMutex);
+    }
+
+    return res;
+}
+
+/**
+ * Add data to the ring.  Called with the thread mutex held.
+ * Data dropped to make room is returned in dropped, to be destroyed without the mutex.
+ */
+static CAResult_t CAQueueingThreadPush(CAQueueingThread_t *thread, void *data, uint32_t size,
+                                       uint64_t addTime, CAQueueingThreadItem_t *dropped)
+{
+    CAResult_t res = CA_STATUS_OK;
+
+    if (thread->count >= thread->capacity)
+    {
+        res = CAQueueingThreadMakeRoom(thread, dropped);
+    }
+
+    if (CA_STATUS_OK == res && thread->count == thread->itemsSize)
+    {
+        res = CAQueueingThreadGrow(thread);
+    }
+
+    if (CA_STATUS_OK == res)
+    {
+        // add thread data into the ring
+        CAQueueingThreadItem_t *item =
+            &thread->items[(thread->head + thread->count) & (thread->itemsSize - 1)];
+        item->data = data;
+        item->size = size;
+        item->addTime = addTime;
+        thread->count++;
+        thread->stats.enqueued++;
+        if (thread->count > thread->stats.maxDepth)
+        {
+            thread->stats.maxDepth = thread->count;
+        }
+
+        // notify the thread; it only waits while the queue is empty
+        if (1 == thread->count)
+        {
+            ca_cond_broadcast(thread->threadCond);
+        }
     }
 
     return res;
@@ -225,30 +425,160 @@ CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint3
         return CA_STATUS_INVALID_PARAM;
     }
 
-    // create thread data
-    u_queue_message_t *message = (u_queue_message_t *) OICMalloc(sizeof(u_queue_message_t));
+    CAQueueingThreadItem_t dropped = { NULL, 0, 0 };
+
+    // mutex lock
+    ca_mutex_lock(thread->threadMutex);
+
+    CAResult_t res = CAQueueingThreadPush(thread, data, size, getCurrentTimeInMicroSeconds(),
+                                          &dropped);
 
-    if (NULL == message)
+    // mutex unlock
+    ca_mutex_unlock(thread->threadMutex);
+
+    if (NULL != dropped.data)
     {
-        OIC_LOG(ERROR, TAG, "memory error!!");
-        return CA_MEMORY_ALLOC_FAILED;
+        OIC_LOG(DEBUG, TAG, "queue full, dropped the oldest non-confirmable data");
+        CAQueueingThreadDestroyData(thread, dropped.data, dropped.size);
     }
 
-    message->msg = data;
-    message->size = size;
+    if (CA_STATUS_OK != res)
+    {
+        OIC_LOG_V(ERROR, TAG, "data not queued(%d)", res);
+        CAQueueingThreadDestroyData(thread, data, size);
+    }
+
+    return res;
+}
+
+CAResult_t CAQueueingThreadAddDataBatch(CAQueueingThread_t *thread,
+                                        CAQueueingThreadItem_t *items, uint32_t count)
+{
+    if (NULL == thread || NULL == items)
+    {
+        OIC_LOG(ERROR, TAG, "thread instance is empty..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    CAResult_t res = CA_STATUS_OK;
 
     // mutex lock
     ca_mutex_lock(thread->threadMutex);
 
-    // add thread data into list
-    u_queue_add_element(thread->dataQueue, message);
+    // the thread is woken by the first data only, and takes the rest with it
+    uint64_t addTime = getCurrentTimeInMicroSeconds();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        CAQueueingThreadItem_t dropped = { NULL, 0, 0 };
+        CAResult_t pushed = CA_STATUS_INVALID_PARAM;
+        if (NULL != items[i].data && 0 != items[i].size)
+        {
+            pushed = CAQueueingThreadPush(thread, items[i].data, items[i].size, addTime, &dropped);
+        }
 
-    // notity the thread
-    ca_cond_signal(thread->threadCond);
+        // the slot keeps what is left to destroy: the data if it was not queued, or the
+        // data dropped for it
+        if (CA_STATUS_OK == pushed)
+        {
+            items[i] = dropped;
+        }
+        else
+        {
+            res = pushed;
+        }
+    }
 
     // mutex unlock
     ca_mutex_unlock(thread->threadMutex);
 
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (NULL != items[i].data)
+        {
+            OIC_LOG(DEBUG, TAG, "data dropped or not queued");
+            CAQueueingThreadDestroyData(thread, items[i].data, items[i].size);
+        }
+    }
+
+    if (CA_STATUS_OK != res)
+    {
+        OIC_LOG_V(ERROR, TAG, "data not queued(%d)", res);
+    }
+
+    return res;
+}
+
+uint32_t CAQueueingThreadTakeData(CAQueueingThread_t *thread, CAQueueingThreadItem_t *items,
+                                  uint32_t count)
+{
+    if (NULL == thread || NULL == thread->threadMutex || NULL == items)
+    {
+        OIC_LOG(ERROR, TAG, "thread instance is empty..");
+        return 0;
+    }
+
+    ca_mutex_lock(thread->threadMutex);
+    count = CAQueueingThreadTakeItems(thread, items, count);
+    ca_mutex_unlock(thread->threadMutex);
+
+    return count;
+}
+
+CAResult_t CAQueueingThreadSetLimit(CAQueueingThread_t *thread, uint32_t capacity,
+                                    CAQueueOverflowPolicy_t policy)
+{
+    if (NULL == thread || NULL == thread->threadMutex)
+    {
+        OIC_LOG(ERROR, TAG, "thread instance is empty..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    if (0 == capacity || CA_QUEUE_BLOCK < policy)
+    {
+        OIC_LOG(ERROR, TAG, "invalid queue limit..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    ca_mutex_lock(thread->threadMutex);
+    thread->capacity = capacity;
+    thread->overflowPolicy = policy;
+    // senders waiting for room may have got some
+    ca_cond_broadcast(thread->spaceCond);
+    ca_mutex_unlock(thread->threadMutex);
+
+    return CA_STATUS_OK;
+}
+
+CAResult_t CAQueueingThreadSetDropCheck(CAQueueingThread_t *thread,
+                                        CADataDropCheckFunction dropCheck)
+{
+    if (NULL == thread || NULL == thread->threadMutex)
+    {
+        OIC_LOG(ERROR, TAG, "thread instance is empty..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    ca_mutex_lock(thread->threadMutex);
+    thread->dropCheck = dropCheck;
+    ca_mutex_unlock(thread->threadMutex);
+
+    return CA_STATUS_OK;
+}
+
+CAResult_t CAQueueingThreadGetStats(CAQueueingThread_t *thread, CAQueueStats_t *stats)
+{
+    if (NULL == thread || NULL == thread->threadMutex || NULL == stats)
+    {
+        OIC_LOG(ERROR, TAG, "thread instance is empty..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    ca_mutex_lock(thread->threadMutex);
+    *stats = thread->stats;
+    stats->depth = thread->count;
+    stats->capacity = thread->capacity;
+    ca_mutex_unlock(thread->threadMutex);
+
     return CA_STATUS_OK;
 }
 
@@ -262,10 +592,25 @@ CAResult_t CAQueueingThreadDestroy(CAQueueingThread_t *thread)
 
     OIC_LOG(DEBUG, TAG, "thread destroy..");
 
+    // destroy what a queue without a started thread still holds
+    uint32_t mask = thread->itemsSize - 1;
+    for (uint32_t i = 0; i < thread->count; i++)
+    {
+        CAQueueingThreadItem_t *item = &thread->items[(thread->head + i) & mask];
+        CAQueueingThreadDestroyData(thread, item->data, item->size);
+    }
+    OICFree(thread->items);
+    thread->items = NULL;
+    thread->itemsSize = 0;
+    thread->head = 0;
+    thread->count = 0;
+
     ca_mutex_free(thread->threadMutex);
     thread->threadMutex = NULL;
     ca_cond_free(thread->threadCond);
-    u_queue_delete(thread->dataQueue);
+    thread->threadCond = NULL;
+    ca_cond_free(thread->spaceCond);
+    thread->spaceCond = NULL;
 
     return CA_STATUS_OK;
 }
@@ -289,9 +634,14 @@ CAResult_t CAQueueingThreadStop(CAQueueingThread_t *thread)
         thread->isStop = true;
 
         // notify the thread
-        ca_cond_signal(thread->threadCond);
+        ca_cond_broadcast(thread->threadCond);
 
-        ca_cond_wait(thread->threadCond, thread->threadMutex);
+        // The thread may not have been scheduled yet, and the condition is shared with
+        // the data signals, so wait for the routine itself to finish.
+        while (thread->isRunning)
+        {
+            ca_cond_wait(thread->threadCond, thread->threadMutex);
+        }
 
         // mutex unlock
         ca_mutex_unlock(thread->threadMutex);
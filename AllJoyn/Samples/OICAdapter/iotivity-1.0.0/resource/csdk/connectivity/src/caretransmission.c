@@ -44,6 +44,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <inttypes.h>
 
 #ifndef SINGLE_THREAD
 #ifndef WIN32
@@ -67,18 +68,31 @@
 
 #define TAG "CA_RETRANS"
 
-typedef struct
+struct CARetransmissionData
 {
     uint64_t timeStamp;                 /**< last sent time. microseconds */
 #ifndef SINGLE_THREAD
     uint64_t timeout;                   /**< timeout value. microseconds */
 #endif
+    uint64_t expireTick;                /**< wheel tick of next retransmission */
     uint8_t triedCount;                 /**< retransmission count */
     uint16_t messageId;                 /**< coap PDU message id */
     CAEndpoint_t *endpoint;             /**< remote endpoint */
     void *pdu;                          /**< coap PDU */
     uint32_t size;                      /**< coap PDU size */
-} CARetransmissionData_t;
+    bool isSending;                     /**< being sent outside of the mutex */
+    bool isRemoved;                     /**< removed while isSending is set */
+    CARetransmissionData_t *wheelNext;  /**< next data in the same wheel slot */
+    CARetransmissionData_t **wheelPrev; /**< link pointing to this data in the wheel */
+    OICHashLink_t hashLink;             /**< link in the message id hash table */
+    CARetransmissionData_t *fireNext;   /**< next data to be sent or timed out */
+};
+
+#define CA_RETRANSMISSION_WHEEL_MASK    (CA_RETRANSMISSION_WHEEL_SIZE - 1)
+
+/** range of ticks covered by the whole wheel. **/
+#define CA_RETRANSMISSION_WHEEL_RANGE \
+    ((uint64_t)CA_RETRANSMISSION_WHEEL_SIZE * CA_RETRANSMISSION_WHEEL_SIZE)
 
 static const uint64_t USECS_PER_SEC = 1000000;
 
@@ -121,8 +135,8 @@ CAResult_t CARetransmissionStart(CARetransmission_t *context)
         return CA_STATUS_INVALID_PARAM;
     }
 
-    CAResult_t res = ca_thread_pool_add_task(context->threadPool, CARetransmissionBaseRoutine,
-                                             context);
+    CAResult_t res = ca_thread_pool_add_dedicated_task(context->threadPool,
+                                                       CARetransmissionBaseRoutine, context);
 
     if (CA_STATUS_OK != res)
     {
@@ -135,36 +149,206 @@ CAResult_t CARetransmissionStart(CARetransmission_t *context)
 #endif
 
 /**
- * @brief   check timeout routine
- * @param   currentTime     [IN]microseconds
+ * @brief   calculate the time to wait for the ACK of the current try.
  * @param   retData         [IN]retransmission data
- * @return  true if the timeout period has elapsed, false otherwise
+ * @return  microseconds
  */
-static bool CACheckTimeout(uint64_t currentTime, CARetransmissionData_t *retData)
+static uint64_t CAGetRetransmissionTimeout(const CARetransmissionData_t *retData)
 {
 #ifndef SINGLE_THREAD
-    // #1. calculate timeout
     uint32_t milliTimeoutValue = retData->timeout * 0.001;
-    uint64_t timeout = (milliTimeoutValue << retData->triedCount) * (uint64_t) 1000;
+    return (milliTimeoutValue << retData->triedCount) * (uint64_t) 1000;
+#else
+    return (2 << retData->triedCount) * (uint64_t) 1000000;
+#endif
+}
 
-    if (currentTime >= retData->timeStamp + timeout)
+/**
+ * @brief   convert the time to the wheel tick, rounding up so that the data never
+ *          expires before the given time.
+ * @param   time            [IN]microseconds
+ * @return  wheel tick
+ */
+static uint64_t CAGetTickFromTime(uint64_t time)
+{
+    return (time + CA_RETRANSMISSION_TICK_USEC - 1) / CA_RETRANSMISSION_TICK_USEC;
+}
+
+static uint32_t CAGetRetransmissionHash(const CAEndpoint_t *endpoint, uint16_t messageId)
+{
+    uint32_t hash = OICHashString(endpoint->addr);
+    hash = OICHashAppend(hash, &endpoint->port, sizeof(endpoint->port));
+    hash = OICHashAppend(hash, &endpoint->adapter, sizeof(endpoint->adapter));
+    return OICHashAppend(hash, &messageId, sizeof(messageId));
+}
+
+static bool CAIsSameRetransmissionData(const CARetransmissionData_t *retData,
+                                       const CAEndpoint_t *endpoint, uint16_t messageId)
+{
+    return retData->messageId == messageId
+           && retData->endpoint->adapter == endpoint->adapter
+           && retData->endpoint->port == endpoint->port
+           && 0 == strncmp(retData->endpoint->addr, endpoint->addr, MAX_ADDR_STR_SIZE_CA);
+}
+
+static void CAHashRemove(CARetransmission_t *context, CARetransmissionData_t *retData)
+{
+    OICHashTableRemove(&context->hashTable, &retData->hashLink);
+    context->count--;
+}
+
+static CARetransmissionData_t *CAHashFind(const CARetransmission_t *context,
+                                          const CAEndpoint_t *endpoint, uint16_t messageId)
+{
+    uint32_t hash = CAGetRetransmissionHash(endpoint, messageId);
+    for (OICHashLink_t *link = OICHashTableFind(&context->hashTable, hash); link;
+         link = OICHashTableFindNext(link))
     {
-        OIC_LOG_V(DEBUG, TAG, "%d microseconds time out!!, tried count(%ld)",
-                  timeout, retData->triedCount);
-        return true;
+        CARetransmissionData_t *retData = OIC_HASH_ENTRY(link, CARetransmissionData_t, hashLink);
+        if (CAIsSameRetransmissionData(retData, endpoint, messageId))
+        {
+            return retData;
+        }
+    }
+    return NULL;
+}
+
+static void CAWheelInsert(CARetransmissionWheel_t *wheel, CARetransmissionData_t *retData)
+{
+    CARetransmissionData_t **slot = NULL;
+    uint64_t tick = retData->expireTick;
+
+    if (tick < wheel->currentTick)
+    {
+        tick = wheel->currentTick;
+    }
+
+    uint64_t delta = tick - wheel->currentTick;
+    if (delta < CA_RETRANSMISSION_WHEEL_SIZE)
+    {
+        slot = &wheel->slots[0][tick & CA_RETRANSMISSION_WHEEL_MASK];
+    }
+    else
+    {
+        // data beyond the wheel range parks in the farthest slot and is
+        // re-inserted when that slot cascades.
+        if (delta >= CA_RETRANSMISSION_WHEEL_RANGE)
+        {
+            tick = wheel->currentTick + CA_RETRANSMISSION_WHEEL_RANGE - 1;
+        }
+        slot = &wheel->slots[1][(tick >> CA_RETRANSMISSION_WHEEL_BITS)
+                                & CA_RETRANSMISSION_WHEEL_MASK];
     }
-#else
-    // #1. calculate timeout
-    uint64_t timeOut = (2 << retData->triedCount) * 1000000;
 
-    if (currentTime >= retData->timeStamp + timeOut)
+    retData->wheelNext = *slot;
+    if (retData->wheelNext)
     {
-        OIC_LOG_V(DEBUG, TAG, "timeout=%d, tried cnt=%d",
-                  (2 << retData->triedCount), retData->triedCount);
-        return true;
+        retData->wheelNext->wheelPrev = &retData->wheelNext;
     }
+    retData->wheelPrev = slot;
+    *slot = retData;
+}
+
+static void CAWheelRemove(CARetransmissionData_t *retData)
+{
+    if (NULL == retData->wheelPrev)
+    {
+        return;
+    }
+
+    *retData->wheelPrev = retData->wheelNext;
+    if (retData->wheelNext)
+    {
+        retData->wheelNext->wheelPrev = retData->wheelPrev;
+    }
+    retData->wheelNext = NULL;
+    retData->wheelPrev = NULL;
+}
+
+/**
+ * @brief   process all wheel ticks up to nowTick.
+ * @return  list of the expired data linked by fireNext.
+ */
+static CARetransmissionData_t *CAWheelAdvance(CARetransmission_t *context, uint64_t nowTick)
+{
+    CARetransmissionWheel_t *wheel = &context->wheel;
+    CARetransmissionData_t *expired = NULL;
+
+    if (0 == context->count)
+    {
+        wheel->currentTick = nowTick + 1;
+        return NULL;
+    }
+
+    while (wheel->currentTick <= nowTick)
+    {
+        uint32_t index = wheel->currentTick & CA_RETRANSMISSION_WHEEL_MASK;
+        CARetransmissionData_t *list = NULL;
+
+        // entering a new round, spread the next level 1 slot over level 0.
+        if (0 == index)
+        {
+            uint32_t upper = (wheel->currentTick >> CA_RETRANSMISSION_WHEEL_BITS)
+                             & CA_RETRANSMISSION_WHEEL_MASK;
+            list = wheel->slots[1][upper];
+            wheel->slots[1][upper] = NULL;
+            while (list)
+            {
+                CARetransmissionData_t *next = list->wheelNext;
+                CAWheelInsert(wheel, list);
+                list = next;
+            }
+        }
+
+        list = wheel->slots[0][index];
+        wheel->slots[0][index] = NULL;
+        while (list)
+        {
+            CARetransmissionData_t *next = list->wheelNext;
+            list->wheelNext = NULL;
+            list->wheelPrev = NULL;
+            list->fireNext = expired;
+            expired = list;
+            list = next;
+        }
+
+        wheel->currentTick++;
+    }
+
+    return expired;
+}
+
+#ifndef SINGLE_THREAD
+/**
+ * @brief   calculate how long the thread can sleep until the next wheel event.
+ * @param   currentTime     [IN]microseconds
+ * @return  microseconds. 0 if there is something to process now.
+ */
+static uint64_t CAGetNextWaitTime(const CARetransmission_t *context, uint64_t currentTime)
+{
+    const CARetransmissionWheel_t *wheel = &context->wheel;
+
+    // level 1 slots only matter at the next round boundary.
+    uint64_t nextTick = (wheel->currentTick | CA_RETRANSMISSION_WHEEL_MASK) + 1;
+    for (uint64_t tick = wheel->currentTick; tick < nextTick; tick++)
+    {
+        if (wheel->slots[0][tick & CA_RETRANSMISSION_WHEEL_MASK])
+        {
+            nextTick = tick;
+            break;
+        }
+    }
+
+    uint64_t nextTime = nextTick * CA_RETRANSMISSION_TICK_USEC;
+    return (nextTime > currentTime) ? nextTime - currentTime : 0;
+}
 #endif
-    return false;
+
+static void CAFreeRetransmissionData(CARetransmissionData_t *retData)
+{
+    CAFreeEndpoint(retData->endpoint);
+    OICFree(retData->pdu);
+    OICFree(retData);
 }
 
 static void CACheckRetransmissionList(CARetransmission_t *context)
@@ -175,71 +359,89 @@ static void CACheckRetransmissionList(CARetransmission_t *context)
         return;
     }
 
+    uint64_t currentTime = getCurrentTimeInMicroSeconds();
+    CARetransmissionData_t *fired = NULL;
+
     // mutex lock
     ca_mutex_lock(context->threadMutex);
 
-    uint32_t i = 0;
-    uint32_t len = u_arraylist_length(context->dataList);
-
-    for (i = 0; i < len; i++)
+    CARetransmissionData_t *expired = CAWheelAdvance(context,
+                                                     currentTime / CA_RETRANSMISSION_TICK_USEC);
+    while (expired)
     {
-        CARetransmissionData_t *retData = u_arraylist_get(context->dataList, i);
+        CARetransmissionData_t *retData = expired;
+        expired = expired->fireNext;
 
-        if (NULL == retData)
+        // #1. if time's up, increase the retransmission count and update timestamp.
+        if (retData->triedCount < context->config.tryingCount)
         {
-            continue;
+            retData->timeStamp = currentTime;
+            retData->triedCount++;
+            retData->isSending = true;
         }
 
-        uint64_t currentTime = getCurrentTimeInMicroSeconds();
-
-        if (CACheckTimeout(currentTime, retData))
+        // #2. if tried count is max, remove the retransmission data from the table.
+        // otherwise schedule the next try.
+        if (retData->triedCount >= context->config.tryingCount)
         {
-            // #2. if time's up, send the data.
-            if (NULL != context->dataSendMethod)
-            {
-                OIC_LOG_V(DEBUG, TAG, "retransmission CON data!!, msgid=%d",
-                          retData->messageId);
-                context->dataSendMethod(retData->endpoint, retData->pdu, retData->size);
-            }
+            CAHashRemove(context, retData);
+            retData->isRemoved = true;
+        }
+        else
+        {
+            retData->expireTick = CAGetTickFromTime(retData->timeStamp
+                                                    + CAGetRetransmissionTimeout(retData));
+            CAWheelInsert(&context->wheel, retData);
+        }
 
-            // #3. increase the retransmission count and update timestamp.
-            retData->timeStamp = currentTime;
-            retData->triedCount++;
+        retData->fireNext = fired;
+        fired = retData;
+    }
+
+    // mutex unlock
+    ca_mutex_unlock(context->threadMutex);
+
+    if (NULL == fired)
+    {
+        return;
+    }
+
+    // #3. send the data and notify timeouts without holding the mutex.
+    for (CARetransmissionData_t *retData = fired; retData; retData = retData->fireNext)
+    {
+        if (retData->isSending && NULL != context->dataSendMethod)
+        {
+            OIC_LOG_V(DEBUG, TAG, "retransmission CON data!!, msgid=%d",
+                      retData->messageId);
+            context->dataSendMethod(retData->endpoint, retData->pdu, retData->size);
         }
 
-        // #4. if tried count is max, remove the retransmission data from list.
         if (retData->triedCount >= context->config.tryingCount)
         {
-            CARetransmissionData_t *removedData = u_arraylist_remove(context->dataList, i);
-            if (NULL == removedData)
-            {
-                OIC_LOG(ERROR, TAG, "Removed data is NULL");
-                // mutex unlock
-                ca_mutex_unlock(context->threadMutex);
-                return;
-            }
             OIC_LOG_V(DEBUG, TAG, "max trying count, remove RTCON data,"
-                      "msgid=%d", removedData->messageId);
+                      "msgid=%d", retData->messageId);
 
             // callback for retransmit timeout
             if (NULL != context->timeoutCallback)
             {
-                context->timeoutCallback(removedData->endpoint, removedData->pdu,
-                                         removedData->size);
+                context->timeoutCallback(retData->endpoint, retData->pdu, retData->size);
             }
+        }
+    }
 
-            CAFreeEndpoint(removedData->endpoint);
-            OICFree(removedData->pdu);
-
-            OICFree(removedData);
+    // #4. release the data removed by the timeout or by an ACK received meanwhile.
+    ca_mutex_lock(context->threadMutex);
+    while (fired)
+    {
+        CARetransmissionData_t *retData = fired;
+        fired = fired->fireNext;
 
-            // modify loop value.
-            len = u_arraylist_length(context->dataList);
-            --i;
+        retData->isSending = false;
+        if (retData->isRemoved)
+        {
+            CAFreeRetransmissionData(retData);
         }
     }
-
-    // mutex unlock
     ca_mutex_unlock(context->threadMutex);
 }
 
@@ -270,7 +472,7 @@ void CARetransmissionBaseRoutine(void *threadValue)
         // mutex lock
         ca_mutex_lock(context->threadMutex);
 
-        if (!context->isStop && u_arraylist_length(context->dataList) <= 0)
+        if (!context->isStop && context->count <= 0)
         {
             // if list is empty, thread will wait
             OIC_LOG(DEBUG, TAG, "wait..there is no retransmission data.");
@@ -282,13 +484,15 @@ void CARetransmissionBaseRoutine(void *threadValue)
         }
         else if (!context->isStop)
         {
-            // check each RETRANSMISSION_CHECK_PERIOD_SEC time.
-            OIC_LOG_V(DEBUG, TAG, "wait..(%ld)microseconds",
-                      RETRANSMISSION_CHECK_PERIOD_SEC * (uint64_t) USECS_PER_SEC);
+            // sleep until the next wheel event, new data wakes the thread up.
+            uint64_t waitTime = CAGetNextWaitTime(context, getCurrentTimeInMicroSeconds());
+            if (0 < waitTime)
+            {
+                OIC_LOG_V(DEBUG, TAG, "wait..(%" PRIu64 ")microseconds", waitTime);
 
-            // wait
-            uint64_t absTime = RETRANSMISSION_CHECK_PERIOD_SEC * (uint64_t) USECS_PER_SEC;
-            ca_cond_wait_for(context->threadCond, context->threadMutex, absTime );
+                // wait
+                ca_cond_wait_for(context->threadCond, context->threadMutex, waitTime);
+            }
         }
         else
         {
@@ -346,6 +550,12 @@ CAResult_t CARetransmissionInitialize(CARetransmission_t *context,
         cfg = *config;
     }
 
+    if (!OICHashTableReserve(&context->hashTable, CA_RETRANSMISSION_HASH_SIZE))
+    {
+        OIC_LOG(ERROR, TAG, "memory error");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
     // set send thread data
     context->threadPool = handle;
     context->threadMutex = ca_mutex_new();
@@ -354,7 +564,8 @@ CAResult_t CARetransmissionInitialize(CARetransmission_t *context,
     context->timeoutCallback = timeoutCallback;
     context->config = cfg;
     context->isStop = false;
-    context->dataList = u_arraylist_create();
+    context->count = 0;
+    context->wheel.currentTick = getCurrentTimeInMicroSeconds() / CA_RETRANSMISSION_TICK_USEC;
 
     return CA_STATUS_OK;
 }
@@ -428,49 +639,48 @@ CAResult_t CARetransmissionSentData(CARetransmission_t *context,
     retData->endpoint = remoteEndpoint;
     retData->pdu = pduData;
     retData->size = size;
-#ifndef SINGLE_THREAD
+
+    // data without any try left times out on the next check.
+    retData->expireTick = (0 < context->config.tryingCount) ?
+        CAGetTickFromTime(retData->timeStamp + CAGetRetransmissionTimeout(retData)) : 0;
+
     // mutex lock
     ca_mutex_lock(context->threadMutex);
 
-    uint32_t i = 0;
-    uint32_t len = u_arraylist_length(context->dataList);
-
-    // #3. add data into list
-    for (i = 0; i < len; i++)
+    // #3. add data into the hash table and the timer wheel
+    if (CAHashFind(context, endpoint, messageId))
     {
-        CARetransmissionData_t *currData = u_arraylist_get(context->dataList, i);
-
-        if (NULL == currData)
-        {
-            continue;
-        }
+        OIC_LOG(ERROR, TAG, "Duplicate message ID");
 
-        // found index
-        if (NULL != currData->endpoint && currData->messageId == messageId
-            && (currData->endpoint->adapter == endpoint->adapter))
-        {
-            OIC_LOG(ERROR, TAG, "Duplicate message ID");
+        // mutex unlock
+        ca_mutex_unlock(context->threadMutex);
 
-            // mutex unlock
-            ca_mutex_unlock(context->threadMutex);
+        CAFreeRetransmissionData(retData);
+        return CA_STATUS_FAILED;
+    }
 
-            OICFree(retData);
-            OICFree(pduData);
-            OICFree(remoteEndpoint);
-            return CA_STATUS_FAILED;
-        }
+    // the wheel is not advanced while it is empty, catch it up to now so the
+    // next advance does not walk every tick of the idle period.
+    if (0 == context->count)
+    {
+        context->wheel.currentTick = CAGetTickFromTime(retData->timeStamp);
     }
 
-    u_arraylist_add(context->dataList, (void *) retData);
+    // a table that cannot grow only gets longer chains
+    OICHashTableInsert(&context->hashTable, &retData->hashLink,
+                       CAGetRetransmissionHash(endpoint, messageId));
+    CAWheelInsert(&context->wheel, retData);
+    context->count++;
 
+#ifndef SINGLE_THREAD
     // notify the thread
     ca_cond_signal(context->threadCond);
 
     // mutex unlock
     ca_mutex_unlock(context->threadMutex);
-
 #else
-    u_arraylist_add(context->dataList, (void *) retData);
+    // mutex unlock
+    ca_mutex_unlock(context->threadMutex);
 
     CACheckRetransmissionList(context);
 #endif
@@ -509,75 +719,51 @@ CAResult_t CARetransmissionReceivedData(CARetransmission_t *context,
 
     // mutex lock
     ca_mutex_lock(context->threadMutex);
-    uint32_t len = u_arraylist_length(context->dataList);
 
-    // find index
-    uint32_t i;
-    for (i = 0; i < len; i++)
+    CARetransmissionData_t *retData = CAHashFind(context, endpoint, messageId);
+    if (NULL == retData)
     {
-        CARetransmissionData_t *retData = (CARetransmissionData_t *) u_arraylist_get(
-                context->dataList, i);
+        // mutex unlock
+        ca_mutex_unlock(context->threadMutex);
 
-        if (NULL == retData)
-        {
-            continue;
-        }
+        OIC_LOG(DEBUG, TAG, "OUT");
+        return CA_STATUS_OK;
+    }
 
-        // found index
-        if (NULL != retData->endpoint && retData->messageId == messageId
-            && (retData->endpoint->adapter == endpoint->adapter))
-        {
-            // get pdu data for getting token when CA_EMPTY(RST/ACK) is received from remote device
-            // if retransmission was finish..token will be unavailable.
-            if (CA_EMPTY == CAGetCodeFromPduBinaryData(pdu, size))
-            {
-                OIC_LOG(DEBUG, TAG, "code is CA_EMPTY");
-
-                if (NULL == retData->pdu)
-                {
-                    OIC_LOG(ERROR, TAG, "retData->pdu is null");
-                    OICFree(retData);
-                    // mutex unlock
-                    ca_mutex_unlock(context->threadMutex);
-
-                    return CA_STATUS_FAILED;
-                }
-
-                // copy PDU data
-                (*retransmissionPdu) = (void *) OICCalloc(1, retData->size);
-                if ((*retransmissionPdu) == NULL)
-                {
-                    OICFree(retData);
-                    OIC_LOG(ERROR, TAG, "memory error");
-
-                    // mutex unlock
-                    ca_mutex_unlock(context->threadMutex);
-
-                    return CA_MEMORY_ALLOC_FAILED;
-                }
-                memcpy((*retransmissionPdu), retData->pdu, retData->size);
-            }
+    // get pdu data for getting token when CA_EMPTY(RST/ACK) is received from remote device
+    // if retransmission was finish..token will be unavailable.
+    if (CA_EMPTY == CAGetCodeFromPduBinaryData(pdu, size))
+    {
+        OIC_LOG(DEBUG, TAG, "code is CA_EMPTY");
 
-            // #2. remove data from list
-            CARetransmissionData_t *removedData = u_arraylist_remove(context->dataList, i);
-            if (NULL == removedData)
-            {
-                OIC_LOG(ERROR, TAG, "Removed data is NULL");
+        // copy PDU data
+        (*retransmissionPdu) = (void *) OICCalloc(1, retData->size);
+        if ((*retransmissionPdu) == NULL)
+        {
+            OIC_LOG(ERROR, TAG, "memory error");
 
-                // mutex unlock
-                ca_mutex_unlock(context->threadMutex);
+            // mutex unlock
+            ca_mutex_unlock(context->threadMutex);
 
-                return CA_STATUS_FAILED;
-            }
+            return CA_MEMORY_ALLOC_FAILED;
+        }
+        memcpy((*retransmissionPdu), retData->pdu, retData->size);
+    }
 
-            OIC_LOG_V(DEBUG, TAG, "remove RTCON data!!, msgid=%d", messageId);
+    // #2. remove data from the hash table and the timer wheel
+    CAHashRemove(context, retData);
+    CAWheelRemove(retData);
 
-            CAFreeEndpoint(removedData->endpoint);
-            OICFree(removedData->pdu);
-            OICFree(removedData);
+    OIC_LOG_V(DEBUG, TAG, "remove RTCON data!!, msgid=%d", messageId);
 
-            break;
-        }
+    // data being retransmitted is released by the retransmission thread.
+    if (retData->isSending)
+    {
+        retData->isRemoved = true;
+    }
+    else
+    {
+        CAFreeRetransmissionData(retData);
     }
 
     // mutex unlock
@@ -624,10 +810,22 @@ CAResult_t CARetransmissionDestroy(CARetransmission_t *context)
 
     OIC_LOG(DEBUG, TAG, "retransmission context destroy..");
 
+    for (size_t i = 0; i < context->hashTable.size; i++)
+    {
+        while (context->hashTable.buckets[i])
+        {
+            CARetransmissionData_t *retData = OIC_HASH_ENTRY(context->hashTable.buckets[i],
+                                                             CARetransmissionData_t, hashLink);
+            CAHashRemove(context, retData);
+            CAFreeRetransmissionData(retData);
+        }
+    }
+    OICHashTableClear(&context->hashTable);
+    memset(&context->wheel, 0, sizeof(context->wheel));
+
     ca_mutex_free(context->threadMutex);
     context->threadMutex = NULL;
     ca_cond_free(context->threadCond);
-    u_arraylist_free(&context->dataList);
 
     return CA_STATUS_OK;
 }
@@ -319,6 +319,12 @@ void CAIPSetPacketReceiveCallback(CAIPPacketReceivedCallback callback)
     OIC_LOG(DEBUG, TAG, "OUT");
 }
 
+void CAIPSetPacketBatchReceiveCallback(CAIPPacketBatchReceivedCallback callback)
+{
+    // packets are read one at a time
+    (void)callback;
+}
+
 void CAIPSetExceptionCallback(CAIPExceptionCallback callback)
 {
     // TODO
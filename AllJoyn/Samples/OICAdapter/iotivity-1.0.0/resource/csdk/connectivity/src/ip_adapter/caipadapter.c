@@ -69,6 +69,11 @@ static CAQueueingThread_t *g_sendQueueHandle = NULL;
  */
 static CANetworkPacketReceivedCallback g_networkPacketCallback = NULL;
 
+/**
+ * Network Packet Batch Received Callback to CA.
+ */
+static CANetworkPacketBatchReceivedCallback g_networkPacketBatchCallback = NULL;
+
 /**
  * Network Changed Callback to CA.
  */
@@ -81,6 +86,7 @@ static CAErrorHandleCallback g_errorCallback = NULL;
 
 static void CAIPPacketReceivedCB(const CASecureEndpoint_t *endpoint,
                                  const void *data, uint32_t dataLength);
+static void CAIPPacketBatchReceivedCB(const CAReceivedPacket_t *packets, uint32_t count);
 #ifdef __WITH_DTLS__
 static void CAIPPacketSendCB(CAEndpoint_t *endpoint,
                              const void *data, uint32_t dataLength);
@@ -101,6 +107,8 @@ void CAFreeIPData(CAIPData *ipData);
 
 static void CADataDestroyer(void *data, uint32_t size);
 
+static bool CAIsNonConfirmableIPData(const void *data, uint32_t size);
+
 CAResult_t CAIPInitializeQueueHandles()
 {
     OIC_LOG(DEBUG, TAG, "IN");
@@ -129,6 +137,7 @@ CAResult_t CAIPInitializeQueueHandles()
         g_sendQueueHandle = NULL;
         return CA_STATUS_FAILED;
     }
+    CAQueueingThreadSetDropCheck(g_sendQueueHandle, CAIsNonConfirmableIPData);
 
     OIC_LOG(DEBUG, TAG, "OUT");
     return CA_STATUS_OK;
@@ -186,6 +195,24 @@ void CAIPPacketReceivedCB(const CASecureEndpoint_t *sep, const void *data,
     OIC_LOG(DEBUG, TAG, "OUT");
 }
 
+void CAIPPacketBatchReceivedCB(const CAReceivedPacket_t *packets, uint32_t count)
+{
+    VERIFY_NON_NULL_VOID(packets, TAG, "packets is NULL");
+
+    OIC_LOG_V(DEBUG, TAG, "%u packets received", count);
+
+    if (g_networkPacketBatchCallback)
+    {
+        g_networkPacketBatchCallback(packets, count);
+    }
+}
+
+void CASetIPPacketBatchReceivedCallback(CANetworkPacketBatchReceivedCallback callback)
+{
+    g_networkPacketBatchCallback = callback;
+    CAIPSetPacketBatchReceiveCallback(callback ? CAIPPacketBatchReceivedCB : NULL);
+}
+
 void CAIPErrorHandler (const CAEndpoint_t *endpoint, const void *data,
                        uint32_t dataLength, CAResult_t result)
 {
@@ -224,6 +251,8 @@ static void CAInitializeIPGlobals()
     caglobals.ip.m6s.fd = -1;
     caglobals.ip.m4.fd  = -1;
     caglobals.ip.m4s.fd = -1;
+    caglobals.ip.epollFd = -1;
+    caglobals.ip.eventFd = -1;
     caglobals.ip.u6.port  = 0;
     caglobals.ip.u6s.port = 0;
     caglobals.ip.u4.port  = 0;
@@ -404,8 +433,12 @@ static int32_t CAQueueIPData(bool isMulticast, const CAEndpoint_t *endpoint,
         OIC_LOG(ERROR, TAG, "Failed to create ipData!");
         return -1;
     }
-    // Add message to send queue
-    CAQueueingThreadAddData(g_sendQueueHandle, ipData, sizeof(CAIPData));
+    // Add message to send queue; the queue frees the data if it is full
+    if (CA_STATUS_OK != CAQueueingThreadAddData(g_sendQueueHandle, ipData, sizeof(CAIPData)))
+    {
+        OIC_LOG(ERROR, TAG, "Failed to queue ipData!");
+        return -1;
+    }
 
 #endif // SINGLE_THREAD
 
@@ -475,6 +508,7 @@ void CATerminateIP()
 #endif
 
     CAIPSetPacketReceiveCallback(NULL);
+    CASetIPPacketBatchReceivedCallback(NULL);
 
 #ifndef SINGLE_THREAD
     CAIPDeinitializeQueueHandles();
@@ -584,4 +618,16 @@ void CADataDestroyer(void *data, uint32_t size)
     CAFreeIPData(etdata);
 }
 
+bool CAIsNonConfirmableIPData(const void *data, uint32_t size)
+{
+    const CAIPData *ipData = (const CAIPData *) data;
+    if (size < sizeof(CAIPData) || NULL == ipData->data || 0 == ipData->dataLen)
+    {
+        return false;
+    }
+
+    // the type of a CoAP message is in bits 4 and 5 of its first byte, 1 is non-confirmable
+    return 1 == ((((const uint8_t *) ipData->data)[0] >> 4) & 0x03);
+}
+
 #endif // SINGLE_THREAD
@@ -49,6 +49,11 @@ static int inet_aton(const char* pszAddrString, void* pAddrBuf) { return inet_pt
 #include <linux/netlink.h>
 #include <linux/rtnetlink.h>
 #endif
+#if defined(__linux__) && !defined(__ANDROID__)
+#define CA_IP_EPOLL
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
 
 #include "pdu.h"
 #include "caipinterface.h"
@@ -69,6 +74,54 @@ static int inet_aton(const char* pszAddrString, void* pAddrBuf) { return inet_pt
 
 #define SELECT_TIMEOUT 1     // select() seconds (and termination latency)
 
+#ifdef CA_IP_EPOLL
+#define RECV_BATCH_SIZE 16   // datagrams read by one recvmmsg()
+#define EPOLL_EVENTS 16      // events handled per epoll_wait()
+
+// epoll data of the non-socket fds, sockets use their index in g_epollSockets
+#define EPOLL_NETLINK_INDEX 0x100
+#define EPOLL_EVENT_INDEX   0x101
+
+static const struct
+{
+    CASocket_t *sock;
+    CATransportFlags_t flags;
+} g_epollSockets[] = {
+    { &caglobals.ip.u6,  CA_IPV6 },
+    { &caglobals.ip.u6s, CA_IPV6 | CA_SECURE },
+    { &caglobals.ip.u4,  CA_IPV4 },
+    { &caglobals.ip.u4s, CA_IPV4 | CA_SECURE },
+    { &caglobals.ip.m6,  CA_MULTICAST | CA_IPV6 },
+    { &caglobals.ip.m6s, CA_MULTICAST | CA_IPV6 | CA_SECURE },
+    { &caglobals.ip.m4,  CA_MULTICAST | CA_IPV4 },
+    { &caglobals.ip.m4s, CA_MULTICAST | CA_IPV4 | CA_SECURE },
+};
+
+/**
+ * Mutex that serializes closing the eventfd with writes from other threads.
+ * It is kept after the server stops, network monitor callbacks may still
+ * try to wake up the receive thread.
+ */
+static ca_mutex g_eventFdMutex = NULL;
+
+/**
+ * Buffers reused by every recvmmsg() of the receive thread.
+ */
+typedef struct
+{
+    struct mmsghdr msgs[RECV_BATCH_SIZE];
+    struct iovec iovs[RECV_BATCH_SIZE];
+    struct sockaddr_storage srcAddrs[RECV_BATCH_SIZE];
+    CAReceivedPacket_t packets[RECV_BATCH_SIZE];
+    union
+    {
+        struct cmsghdr cmsg;
+        unsigned char data[CMSG_SPACE(sizeof (struct in6_pktinfo))];
+    } controls[RECV_BATCH_SIZE];
+    char buffers[RECV_BATCH_SIZE][COAP_MAX_PDU_SIZE];
+} CARecvBatch_t;
+#endif
+
 #define IPv4_MULTICAST     "224.0.1.187"
 static struct in_addr IPv4MulticastAddress = { 0 };
 
@@ -111,11 +164,21 @@ static CAIPExceptionCallback g_exceptionCallback;
 
 static CAIPPacketReceivedCallback g_packetReceivedCallback;
 
+static CAIPPacketBatchReceivedCallback g_packetBatchReceivedCallback;
+
 static void CAHandleNetlink();
 static void CAFindReadyMessage();
 static void CASelectReturned(fd_set *readFds, int ret);
 static void CAProcessNewInterface(CAInterface_t *ifchanged);
 static CAResult_t CAReceiveMessage(int fd, CATransportFlags_t flags);
+static void CAGetReceivedEndpoint(CATransportFlags_t flags, struct sockaddr_storage *srcAddr,
+                                  const unsigned char *pktinfo, CASecureEndpoint_t *sep);
+static void CAProcessReceivedMessage(CATransportFlags_t flags, struct sockaddr_storage *srcAddr,
+                                     const unsigned char *pktinfo,
+                                     char *recvBuffer, size_t recvLen);
+#ifdef CA_IP_EPOLL
+static void CAEpollReceiveHandler();
+#endif
 
 #define SET(TYPE, FDS) \
     if (caglobals.ip.TYPE.fd != -1) \
@@ -135,6 +198,15 @@ static void CAReceiveHandler(void *data)
     (void)data;
     OIC_LOG(DEBUG, TAG, "IN");
 
+#ifdef CA_IP_EPOLL
+    if (caglobals.ip.epollFd != -1)
+    {
+        CAEpollReceiveHandler();
+        OIC_LOG(DEBUG, TAG, "OUT");
+        return;
+    }
+#endif
+
     while (!caglobals.ip.terminate)
     {
         CAFindReadyMessage();
@@ -326,12 +398,22 @@ static CAResult_t CAReceiveMessage(int fd, CATransportFlags_t flags)
         }
     }
 
-    CASecureEndpoint_t sep = {.endpoint = {.adapter = CA_ADAPTER_IP, .flags = flags}};
+    CAProcessReceivedMessage(flags, &srcAddr, pktinfo, recvBuffer, recvLen);
+
+    return CA_STATUS_OK;
+}
+
+static void CAGetReceivedEndpoint(CATransportFlags_t flags, struct sockaddr_storage *srcAddr,
+                                  const unsigned char *pktinfo, CASecureEndpoint_t *sep)
+{
+    memset(sep, 0, sizeof (*sep));
+    sep->endpoint.adapter = CA_ADAPTER_IP;
+    sep->endpoint.flags = flags;
 
     if (flags & CA_IPV6)
     {
-        sep.endpoint.iface = ((struct sockaddr_in6 *)&srcAddr)->sin6_scope_id;
-        ((struct sockaddr_in6 *)&srcAddr)->sin6_scope_id = 0;
+        sep->endpoint.iface = ((struct sockaddr_in6 *)srcAddr)->sin6_scope_id;
+        ((struct sockaddr_in6 *)srcAddr)->sin6_scope_id = 0;
 
         if ((flags & CA_MULTICAST) && pktinfo)
         {
@@ -339,7 +421,7 @@ static CAResult_t CAReceiveMessage(int fd, CATransportFlags_t flags)
             unsigned char topbits = ((unsigned char *)addr)[0];
             if (topbits != 0xff)
             {
-                sep.endpoint.flags &= ~CA_MULTICAST;
+                sep->endpoint.flags &= ~CA_MULTICAST;
             }
         }
     }
@@ -352,12 +434,20 @@ static CAResult_t CAReceiveMessage(int fd, CATransportFlags_t flags)
             unsigned char topbits = ((unsigned char *)&host)[3];
             if (topbits < 224 || topbits > 239)
             {
-                sep.endpoint.flags &= ~CA_MULTICAST;
+                sep->endpoint.flags &= ~CA_MULTICAST;
             }
         }
     }
 
-    CAConvertAddrToName(&srcAddr, sep.endpoint.addr, &sep.endpoint.port);
+    CAConvertAddrToName(srcAddr, sep->endpoint.addr, &sep->endpoint.port);
+}
+
+static void CAProcessReceivedMessage(CATransportFlags_t flags, struct sockaddr_storage *srcAddr,
+                                     const unsigned char *pktinfo,
+                                     char *recvBuffer, size_t recvLen)
+{
+    CASecureEndpoint_t sep;
+    CAGetReceivedEndpoint(flags, srcAddr, pktinfo, &sep);
 
     if (flags & CA_SECURE)
     {
@@ -375,9 +465,165 @@ static CAResult_t CAReceiveMessage(int fd, CATransportFlags_t flags)
             g_packetReceivedCallback(&sep, recvBuffer, recvLen);
         }
     }
+}
+
+#ifdef CA_IP_EPOLL
+static void CAReceiveBatch(CARecvBatch_t *batch, int fd, CATransportFlags_t flags)
+{
+    int level = IPPROTO_IP;
+    int type = IP_PKTINFO;
+    socklen_t nameLen = sizeof (struct sockaddr_in);
+    if (flags & CA_IPV6)
+    {
+        level = IPPROTO_IPV6;
+        type = IPV6_PKTINFO;
+        nameLen = sizeof (struct sockaddr_in6);
+    }
 
-    return CA_STATUS_OK;
+    for (int i = 0; i < RECV_BATCH_SIZE; i++)
+    {
+        struct msghdr *msg = &batch->msgs[i].msg_hdr;
+        batch->iovs[i].iov_base = batch->buffers[i];
+        batch->iovs[i].iov_len = sizeof (batch->buffers[i]);
+        msg->msg_name = &batch->srcAddrs[i];
+        msg->msg_namelen = nameLen;
+        msg->msg_iov = &batch->iovs[i];
+        msg->msg_iovlen = 1;
+        msg->msg_control = &batch->controls[i];
+        msg->msg_controllen = sizeof (batch->controls[i]);
+        msg->msg_flags = 0;
+    }
+
+    int count = recvmmsg(fd, batch->msgs, RECV_BATCH_SIZE, MSG_DONTWAIT, NULL);
+    if (-1 == count)
+    {
+        if (EAGAIN != errno && EWOULDBLOCK != errno && EINTR != errno)
+        {
+            OIC_LOG_V(ERROR, TAG, "recvmmsg failed %s", strerror(errno));
+        }
+        return;
+    }
+
+    // plain datagrams are handed on together, so that they are queued at once
+    uint32_t packetCount = 0;
+    for (int i = 0; i < count && !caglobals.ip.terminate; i++)
+    {
+        struct msghdr *msg = &batch->msgs[i].msg_hdr;
+        unsigned char *pktinfo = NULL;
+
+        if (flags & CA_MULTICAST)
+        {
+            for (struct cmsghdr *cmp = CMSG_FIRSTHDR(msg); cmp != NULL;
+                 cmp = CMSG_NXTHDR(msg, cmp))
+            {
+                if (cmp->cmsg_level == level && cmp->cmsg_type == type)
+                {
+                    pktinfo = CMSG_DATA(cmp);
+                }
+            }
+        }
+
+        if ((flags & CA_SECURE) || !g_packetBatchReceivedCallback)
+        {
+            CAProcessReceivedMessage(flags, &batch->srcAddrs[i], pktinfo,
+                                     batch->buffers[i], batch->msgs[i].msg_len);
+            continue;
+        }
+
+        CAReceivedPacket_t *packet = &batch->packets[packetCount++];
+        CAGetReceivedEndpoint(flags, &batch->srcAddrs[i], pktinfo, &packet->sep);
+        packet->data = batch->buffers[i];
+        packet->dataLen = batch->msgs[i].msg_len;
+    }
+
+    if (packetCount)
+    {
+        g_packetBatchReceivedCallback(batch->packets, packetCount);
+    }
+}
+
+static void CAEpollReceiveHandler()
+{
+    CARecvBatch_t *batch = (CARecvBatch_t *)OICMalloc(sizeof (CARecvBatch_t));
+    if (!batch)
+    {
+        OIC_LOG(ERROR, TAG, "Out of memory");
+        return;
+    }
+
+    // the globals are reset when the adapter stops, this thread keeps its own
+    // copy of the fds it has to close.
+    int epollFd = caglobals.ip.epollFd;
+    int eventFd = caglobals.ip.eventFd;
+
+    struct epoll_event events[EPOLL_EVENTS];
+    int timeout = caglobals.ip.selectTimeout == -1 ? -1 : caglobals.ip.selectTimeout * 1000;
+
+    while (!caglobals.ip.terminate)
+    {
+        int ret = epoll_wait(epollFd, events, EPOLL_EVENTS, timeout);
+
+        if (caglobals.ip.terminate)
+        {
+            OIC_LOG_V(DEBUG, TAG, "Packet receiver Stop request received.");
+            break;
+        }
+        if (ret < 0)
+        {
+            if (EINTR != errno)
+            {
+                OIC_LOG_V(FATAL, TAG, "epoll_wait error %s", strerror(errno));
+            }
+            continue;
+        }
+
+        for (int i = 0; i < ret && !caglobals.ip.terminate; i++)
+        {
+            uint32_t index = events[i].data.u32;
+
+            if (EPOLL_EVENT_INDEX == index)
+            {
+                uint64_t value;
+                (void)read(eventFd, &value, sizeof (value));
+
+                CAInterface_t *ifchanged = CAFindInterfaceChange();
+                if (ifchanged)
+                {
+                    CAProcessNewInterface(ifchanged);
+                    OICFree(ifchanged);
+                }
+            }
+            else if (EPOLL_NETLINK_INDEX == index)
+            {
+                CAHandleNetlink();
+            }
+            else if (index < sizeof (g_epollSockets) / sizeof (g_epollSockets[0])
+                     && g_epollSockets[index].sock->fd != -1)
+            {
+                // level triggered, a socket with more pending datagrams is
+                // reported again after the other sockets had their turn.
+                CAReceiveBatch(batch, g_epollSockets[index].sock->fd,
+                               g_epollSockets[index].flags);
+            }
+        }
+    }
+
+    ca_mutex_lock(g_eventFdMutex);
+    if (caglobals.ip.epollFd == epollFd)
+    {
+        caglobals.ip.epollFd = -1;
+    }
+    if (caglobals.ip.eventFd == eventFd)
+    {
+        caglobals.ip.eventFd = -1;
+    }
+    close(epollFd);
+    close(eventFd);
+    ca_mutex_unlock(g_eventFdMutex);
+
+    OICFree(batch);
 }
+#endif
 
 void CAIPPullData()
 {
@@ -523,6 +769,107 @@ static void CAInitializeNetlink()
 #endif
 }
 
+#ifdef CA_IP_EPOLL
+static bool CAAddEpollFd(int fd, uint32_t index)
+{
+    if (-1 == fd)
+    {
+        return true;
+    }
+
+    struct epoll_event event = { .events = EPOLLIN, .data = { .u32 = index } };
+    if (-1 == epoll_ctl(caglobals.ip.epollFd, EPOLL_CTL_ADD, fd, &event))
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_ctl failed: %s", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+static void CAInitializeEpoll()
+{
+    if (!g_eventFdMutex)
+    {
+        g_eventFdMutex = ca_mutex_new();
+        if (!g_eventFdMutex)
+        {
+            OIC_LOG(ERROR, TAG, "ca_mutex_new failed");
+            return;
+        }
+    }
+
+    caglobals.ip.epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (-1 == caglobals.ip.epollFd)
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_create1 failed: %s", strerror(errno));
+        return;
+    }
+
+    caglobals.ip.eventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    bool added = (-1 != caglobals.ip.eventFd);
+    if (!added)
+    {
+        OIC_LOG_V(ERROR, TAG, "eventfd failed: %s", strerror(errno));
+    }
+
+    for (uint32_t i = 0; added && i < sizeof (g_epollSockets) / sizeof (g_epollSockets[0]); i++)
+    {
+        added = CAAddEpollFd(g_epollSockets[i].sock->fd, i);
+    }
+    added = added && CAAddEpollFd(caglobals.ip.netlinkFd, EPOLL_NETLINK_INDEX);
+    added = added && CAAddEpollFd(caglobals.ip.eventFd, EPOLL_EVENT_INDEX);
+
+    if (!added)
+    {
+        // fall back to select()
+        ca_mutex_lock(g_eventFdMutex);
+        close(caglobals.ip.epollFd);
+        caglobals.ip.epollFd = -1;
+        if (-1 != caglobals.ip.eventFd)
+        {
+            close(caglobals.ip.eventFd);
+            caglobals.ip.eventFd = -1;
+        }
+        ca_mutex_unlock(g_eventFdMutex);
+        return;
+    }
+
+    caglobals.ip.shutdownFds[0] = -1;
+    caglobals.ip.shutdownFds[1] = -1;
+    caglobals.ip.selectTimeout = -1;
+}
+
+/**
+ * Writes to the eventfd of the receive thread.
+ * @return false if the receive thread does not use epoll.
+ */
+static bool CASignalEventFd()
+{
+    if (!g_eventFdMutex)
+    {
+        return false;
+    }
+
+    ca_mutex_lock(g_eventFdMutex);
+    bool signaled = (caglobals.ip.eventFd != -1);
+    if (signaled)
+    {
+        uint64_t value = 1;
+        ssize_t len = 0;
+        do
+        {
+            len = write(caglobals.ip.eventFd, &value, sizeof (value));
+        } while ((len == -1) && (errno == EINTR));
+        if ((len == -1) && (errno != EAGAIN))
+        {
+            OIC_LOG_V(DEBUG, TAG, "eventfd write failed: %s", strerror(errno));
+        }
+    }
+    ca_mutex_unlock(g_eventFdMutex);
+    return signaled;
+}
+#endif
+
 static void CAInitializePipe()
 {
 #ifdef WIN32
@@ -619,14 +966,21 @@ CAResult_t CAIPStartServer(const ca_thread_pool_t threadPool)
               caglobals.ip.u6.port, caglobals.ip.u6s.port, caglobals.ip.u4.port,
               caglobals.ip.u4s.port, caglobals.ip.m6.port, caglobals.ip.m6s.port,
               caglobals.ip.m4.port, caglobals.ip.m4s.port);
-    // create pipe for fast shutdown
-    CAInitializePipe();
-    CHECKFD(caglobals.ip.shutdownFds[0]);
-    CHECKFD(caglobals.ip.shutdownFds[1]);
-
     // create source of network interface change notifications
     CAInitializeNetlink();
 
+#ifdef CA_IP_EPOLL
+    // wait on all sockets with epoll, and on an eventfd for shutdown
+    CAInitializeEpoll();
+    if (-1 == caglobals.ip.epollFd)
+#endif
+    {
+        // create pipe for fast shutdown
+        CAInitializePipe();
+        CHECKFD(caglobals.ip.shutdownFds[0]);
+        CHECKFD(caglobals.ip.shutdownFds[1]);
+    }
+
     caglobals.ip.selectTimeout = CAGetPollingInterval(caglobals.ip.selectTimeout);
 
     res = CAIPStartListenServer();
@@ -637,7 +991,7 @@ CAResult_t CAIPStartServer(const ca_thread_pool_t threadPool)
     }
 
     caglobals.ip.terminate = false;
-    res = ca_thread_pool_add_task(threadPool, CAReceiveHandler, NULL);
+    res = ca_thread_pool_add_dedicated_task(threadPool, CAReceiveHandler, NULL);
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "thread_pool_add_task failed");
@@ -656,6 +1010,13 @@ void CAIPStopServer()
     caglobals.ip.started = false;
     caglobals.ip.terminate = true;
 
+#ifdef CA_IP_EPOLL
+    if (CASignalEventFd())
+    {
+        // receive thread will stop immediately and close the epoll fds
+    }
+    else
+#endif
     if (caglobals.ip.shutdownFds[1] != -1)
     {
         close(caglobals.ip.shutdownFds[1]);
@@ -671,6 +1032,12 @@ void CAIPStopServer()
 
 void CAWakeUpForChange()
 {
+#ifdef CA_IP_EPOLL
+    if (CASignalEventFd())
+    {
+        return;
+    }
+#endif
 #ifndef WIN32
     if (caglobals.ip.shutdownFds[1] != -1)
     {
@@ -907,6 +1274,15 @@ void CAIPSetPacketReceiveCallback(CAIPPacketReceivedCallback callback)
     OIC_LOG(DEBUG, TAG, "OUT");
 }
 
+void CAIPSetPacketBatchReceiveCallback(CAIPPacketBatchReceivedCallback callback)
+{
+    OIC_LOG(DEBUG, TAG, "IN");
+
+    g_packetBatchReceivedCallback = callback;
+
+    OIC_LOG(DEBUG, TAG, "OUT");
+}
+
 void CAIPSetExceptionCallback(CAIPExceptionCallback callback)
 {
     OIC_LOG(DEBUG, TAG, "IN");
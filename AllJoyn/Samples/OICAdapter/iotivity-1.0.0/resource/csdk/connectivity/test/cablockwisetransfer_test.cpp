@@ -0,0 +1,286 @@
+//******************************************************************
+//
+// Copyright 2015 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include "cainterface.h"
+#include "camessagehandler.h"
+#include "cablockwisetransfer.h"
+#include "oic_malloc.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#ifdef WITH_BWT
+
+static const size_t BLOCK_SZX = CA_BLOCK_SIZE_1024_BYTE;
+static const size_t BLOCK_LEN = 1024;
+static const size_t TOTAL_LEN = 1024 * 1024;
+static const uint8_t TOKEN_LENGTH = 8;
+
+typedef struct
+{
+    int sent;
+    int received;
+    size_t receivedLen;
+    bool receivedMatches;
+} bwtTestData;
+
+static bwtTestData g_data;
+static uint8_t g_representation[TOTAL_LEN];
+
+static uint64_t nowUsec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// requests for the next block go nowhere
+static void sendBlock(CAData_t *data)
+{
+    g_data.sent++;
+    CADestroyDataSet(data);
+}
+
+static void receiveRepresentation(CAData_t *data)
+{
+    g_data.received++;
+    g_data.receivedLen = data->responseInfo->info.payloadSize;
+    g_data.receivedMatches = g_data.receivedLen <= TOTAL_LEN &&
+        0 == memcmp(data->responseInfo->info.payload, g_representation, g_data.receivedLen);
+    CADestroyDataSet(data);
+}
+
+// One block of a response, as it arrives in the ACK to the request for it.
+class ReceivedBlock
+{
+public:
+    ReceivedBlock(const uint8_t *token, uint32_t num, size_t totalLen, bool sizeOption)
+    {
+        size_t offset = num * BLOCK_LEN;
+        size_t len = (totalLen - offset < BLOCK_LEN) ? totalLen - offset : BLOCK_LEN;
+        bool more = offset + len < totalLen;
+
+        m_pdu = coap_pdu_init(CA_MSG_ACKNOWLEDGE, COAP_RESPONSE_CODE(205),
+                              (unsigned short) num, COAP_MAX_PDU_SIZE, coap_udp);
+        coap_add_token(m_pdu, TOKEN_LENGTH, token, coap_udp);
+
+        unsigned char buf[4];
+        coap_add_option(m_pdu, COAP_OPTION_BLOCK2,
+                        coap_encode_var_bytes(buf, (num << 4) | (more << 3) | BLOCK_SZX),
+                        buf, coap_udp);
+        if (sizeOption)
+        {
+            coap_add_option(m_pdu, COAP_OPTION_SIZE2,
+                            coap_encode_var_bytes(buf, (unsigned int) totalLen), buf, coap_udp);
+        }
+        coap_add_data(m_pdu, (unsigned int) len, g_representation + offset);
+
+        memset(&m_info, 0, sizeof(m_info));
+        m_info.result = CA_CONTENT;
+        m_info.info.type = CA_MSG_ACKNOWLEDGE;
+        m_info.info.messageId = (uint16_t) num;
+        m_info.info.token = (CAToken_t) token;
+        m_info.info.tokenLength = TOKEN_LENGTH;
+        m_info.info.payload = g_representation + offset;
+        m_info.info.payloadSize = len;
+
+        memset(&m_data, 0, sizeof(m_data));
+        m_data.type = SEND_TYPE_UNICAST;
+        m_data.responseInfo = &m_info;
+        m_data.dataType = CA_RESPONSE_DATA;
+    }
+
+    ~ReceivedBlock()
+    {
+        coap_delete_pdu(m_pdu);
+    }
+
+    CAResult_t receive(const CAEndpoint_t *endpoint)
+    {
+        return CAReceiveBlockWiseData(m_pdu, endpoint, &m_data, m_pdu->length);
+    }
+
+private:
+    coap_pdu_t *m_pdu;
+    CAResponseInfo_t m_info;
+    CAData_t m_data;
+};
+
+class CABlockWiseTransferF : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        memset(&g_data, 0, sizeof(g_data));
+        for (size_t i = 0; i < TOTAL_LEN; i++)
+        {
+            g_representation[i] = (uint8_t) (i * 31 + (i >> 10));
+        }
+
+        memset(&m_endpoint, 0, sizeof(m_endpoint));
+        m_endpoint.adapter = CA_ADAPTER_IP;
+        m_endpoint.flags = CA_IPV4;
+        strcpy(m_endpoint.addr, "127.0.0.1");
+        m_endpoint.port = 5683;
+
+        ASSERT_EQ(CA_STATUS_OK, CAInitializeBlockWiseTransfer(sendBlock, receiveRepresentation));
+    }
+
+    virtual void TearDown()
+    {
+        for (size_t i = 0; i < m_blocks.size(); i++)
+        {
+            delete m_blocks[i];
+        }
+        CATerminateBlockWiseTransfer();
+    }
+
+    // Prepares the blocks of one response per token, interleaved so that
+    // every transfer has a block in flight at the same time.
+    void prepare(int transfers, size_t totalLen, bool sizeOption)
+    {
+        m_tokens.assign(transfers * TOKEN_LENGTH, 0);
+        for (int t = 0; t < transfers; t++)
+        {
+            m_tokens[t * TOKEN_LENGTH] = (uint8_t) t;
+            m_tokens[t * TOKEN_LENGTH + 1] = (uint8_t) (t >> 8);
+            m_tokens[t * TOKEN_LENGTH + 7] = 0xB7;
+        }
+
+        uint32_t blocks = (uint32_t) ((totalLen + BLOCK_LEN - 1) / BLOCK_LEN);
+        for (uint32_t num = 0; num < blocks; num++)
+        {
+            for (int t = 0; t < transfers; t++)
+            {
+                m_blocks.push_back(new ReceivedBlock(&m_tokens[t * TOKEN_LENGTH], num,
+                                                     totalLen, sizeOption));
+            }
+        }
+    }
+
+    // returns the time to receive all prepared blocks in usec
+    uint64_t receiveAll()
+    {
+        g_data.received = 0;
+        uint64_t start = nowUsec();
+        for (size_t i = 0; i < m_blocks.size(); i++)
+        {
+            EXPECT_EQ(CA_STATUS_OK, m_blocks[i]->receive(&m_endpoint));
+        }
+        return nowUsec() - start;
+    }
+
+    void benchmark(const char *name, int transfers, bool sizeOption)
+    {
+        static const int ROUNDS = 5;
+        size_t totalLen = TOTAL_LEN / transfers;
+        prepare(transfers, totalLen, sizeOption);
+
+        uint64_t usec = 0;
+        for (int i = 0; i < ROUNDS; i++)
+        {
+            usec += receiveAll();
+            ASSERT_EQ(transfers, g_data.received);
+            ASSERT_EQ(totalLen, g_data.receivedLen);
+            ASSERT_TRUE(g_data.receivedMatches);
+        }
+
+        printf("[          ] %s: %.1f msec per MB, %.2f usec per block\n", name,
+               (double) usec / ROUNDS / 1000, (double) usec / ROUNDS / m_blocks.size());
+    }
+
+    CAEndpoint_t m_endpoint;
+    std::vector<uint8_t> m_tokens;
+    std::vector<ReceivedBlock *> m_blocks;
+};
+
+TEST_F(CABlockWiseTransferF, ReassemblesWithSizeOption)
+{
+    prepare(1, 10 * BLOCK_LEN + 100, true);
+    receiveAll();
+
+    EXPECT_EQ(1, g_data.received);
+    EXPECT_EQ(10 * BLOCK_LEN + 100, g_data.receivedLen);
+    EXPECT_TRUE(g_data.receivedMatches);
+
+    // every block but the last one asks for the next
+    EXPECT_EQ(10, g_data.sent);
+}
+
+TEST_F(CABlockWiseTransferF, ReassemblesWithoutSizeOption)
+{
+    prepare(1, 33 * BLOCK_LEN, false);
+    receiveAll();
+
+    EXPECT_EQ(1, g_data.received);
+    EXPECT_EQ(33 * BLOCK_LEN, g_data.receivedLen);
+    EXPECT_TRUE(g_data.receivedMatches);
+}
+
+TEST_F(CABlockWiseTransferF, KeepsInterleavedTransfersApart)
+{
+    prepare(100, 4 * BLOCK_LEN, true);
+    receiveAll();
+
+    EXPECT_EQ(100, g_data.received);
+    EXPECT_EQ(4 * BLOCK_LEN, g_data.receivedLen);
+    EXPECT_TRUE(g_data.receivedMatches);
+}
+
+TEST_F(CABlockWiseTransferF, RemovesFinishedTransfer)
+{
+    uint8_t token[TOKEN_LENGTH] = { 0xB7 };
+    CABlockDataID_t *blockID = CACreateBlockDatablockId((CAToken_t) token, TOKEN_LENGTH,
+                                                        m_endpoint.port);
+    ASSERT_TRUE(NULL != blockID);
+
+    ReceivedBlock first(token, 0, 2 * BLOCK_LEN, true);
+    EXPECT_EQ(CA_STATUS_OK, first.receive(&m_endpoint));
+    EXPECT_TRUE(CAIsBlockDataInList(blockID));
+
+    ReceivedBlock last(token, 1, 2 * BLOCK_LEN, true);
+    EXPECT_EQ(CA_STATUS_OK, last.receive(&m_endpoint));
+    EXPECT_FALSE(CAIsBlockDataInList(blockID));
+    EXPECT_EQ(1, g_data.received);
+
+    CADestroyBlockID(blockID);
+}
+
+TEST_F(CABlockWiseTransferF, Benchmark)
+{
+    // 1 MB of representations in 1 KB blocks
+    benchmark("1 x 1 MB, Size2", 1, true);
+}
+
+TEST_F(CABlockWiseTransferF, BenchmarkWithoutSizeOption)
+{
+    benchmark("1 x 1 MB, no Size2", 1, false);
+}
+
+TEST_F(CABlockWiseTransferF, BenchmarkInterleaved)
+{
+    benchmark("64 x 16 KB interleaved, Size2", 64, true);
+}
+
+#endif // WITH_BWT
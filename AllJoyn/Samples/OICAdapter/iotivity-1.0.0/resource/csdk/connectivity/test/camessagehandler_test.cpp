@@ -0,0 +1,218 @@
+//******************************************************************
+//
+// Copyright 2015 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include "cainterface.h"
+#include "camessagehandler.h"
+#include "caprotocolmessage.h"
+#include "caremotehandler.h"
+#include "oic_malloc.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+// Counts the OICMalloc allocations of the thread that set g_countAllocations.
+static thread_local bool g_countAllocations = false;
+static size_t g_allocations = 0;
+
+static void countAllocation(size_t /*size*/)
+{
+    if (g_countAllocations)
+    {
+        g_allocations++;
+    }
+}
+
+static const uint8_t TOKEN[] = { 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0 };
+
+// A temperature reading, about what a small sensor sends.
+static const char SENSOR_PAYLOAD[] = "\xBF\x62rt\x69oic.r.tmp\x64temp\x18\x17\xFF";
+
+static uint64_t nowUsec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+class CAMessageHandlerF : public testing::Test
+{
+public:
+    // the received request as it was copied out of the pdu before
+    void receiveCopy()
+    {
+        coap_pdu_t *pdu = receive();
+        CAData_t *cadata = (CAData_t *) OICCalloc(1, sizeof(CAData_t));
+        cadata->remoteEndpoint = CACloneEndpoint(&m_endpoint);
+        cadata->requestInfo = (CARequestInfo_t *) OICCalloc(1, sizeof(CARequestInfo_t));
+        cadata->dataType = CA_REQUEST_DATA;
+        EXPECT_EQ(CA_STATUS_OK, CAGetRequestInfoFromPDU(pdu, &m_endpoint, cadata->requestInfo));
+        coap_delete_pdu(pdu);
+
+        CAFreeEndpoint(cadata->remoteEndpoint);
+        CADestroyRequestInfoInternal(cadata->requestInfo);
+        OICFree(cadata);
+    }
+
+    void receiveBorrowed()
+    {
+        CAData_t *cadata = CAGenerateReceivedData(&m_endpoint, NULL, receive(), CA_REQUEST_DATA);
+        EXPECT_TRUE(NULL != cadata);
+        CAReleaseReceivedData(cadata);
+    }
+
+protected:
+    virtual void SetUp()
+    {
+        ASSERT_EQ(CA_STATUS_OK, CAInitialize());
+
+        memset(&m_endpoint, 0, sizeof(m_endpoint));
+        m_endpoint.adapter = CA_ADAPTER_IP;
+        m_endpoint.flags = CA_IPV4;
+        strcpy(m_endpoint.addr, "127.0.0.1");
+        m_endpoint.port = 5683;
+        m_messageId = 1;
+
+        // the datagram of a GET, as an adapter hands it up
+        coap_pdu_t *pdu = coap_pdu_init(CA_MSG_NONCONFIRM, COAP_REQUEST_GET, 0,
+                                        COAP_MAX_PDU_SIZE, coap_udp);
+        coap_add_token(pdu, sizeof(TOKEN), TOKEN, coap_udp);
+        coap_add_option(pdu, COAP_OPTION_URI_PATH, 1, (const uint8_t *) "a", coap_udp);
+        coap_add_option(pdu, COAP_OPTION_URI_PATH, 11, (const uint8_t *) "temperature",
+                        coap_udp);
+        uint8_t format = COAP_MEDIATYPE_APPLICATION_CBOR;
+        coap_add_option(pdu, COAP_OPTION_CONTENT_FORMAT, 1, &format, coap_udp);
+        coap_add_option(pdu, COAP_OPTION_URI_QUERY, 16, (const uint8_t *) "if=oic.if.sensor",
+                        coap_udp);
+        coap_add_option(pdu, 2048, 3, (const uint8_t *) "abc", coap_udp);
+        coap_add_data(pdu, sizeof(SENSOR_PAYLOAD) - 1, (const uint8_t *) SENSOR_PAYLOAD);
+        m_datagram.assign((const uint8_t *) pdu->hdr, (const uint8_t *) pdu->hdr + pdu->length);
+        coap_delete_pdu(pdu);
+    }
+
+    virtual void TearDown()
+    {
+        CATerminate();
+    }
+
+    // every request gets a message id of its own, as on the wire
+    coap_pdu_t *receive()
+    {
+        m_datagram[2] = (uint8_t) (m_messageId >> 8);
+        m_datagram[3] = (uint8_t) m_messageId;
+        m_messageId++;
+
+        uint32_t code = 0;
+        return CAParsePDU((const char *) &m_datagram[0], (uint32_t) m_datagram.size(), &code,
+                          &m_endpoint);
+    }
+
+    void benchmark(const char *name, void (CAMessageHandlerF::*receiveOne)())
+    {
+        static const int REQUESTS = 20000;
+
+        g_allocations = 0;
+        OICSetAllocHook(countAllocation);
+        g_countAllocations = true;
+        (this->*receiveOne)();
+        g_countAllocations = false;
+        OICSetAllocHook(NULL);
+        size_t allocations = g_allocations;
+
+        uint64_t start = nowUsec();
+        for (int i = 0; i < REQUESTS; i++)
+        {
+            (this->*receiveOne)();
+        }
+        uint64_t usec = nowUsec() - start;
+
+        printf("[          ] %s: %lu allocations, %.3f usec per request\n", name,
+               (unsigned long) allocations, (double) usec / REQUESTS);
+    }
+
+    CAEndpoint_t m_endpoint;
+    std::vector<uint8_t> m_datagram;
+    uint16_t m_messageId;
+};
+
+TEST_F(CAMessageHandlerF, GenerateReceivedRequest)
+{
+    coap_pdu_t *pdu = receive();
+    ASSERT_TRUE(NULL != pdu);
+
+    CAData_t *cadata = CAGenerateReceivedData(&m_endpoint, NULL, pdu, CA_REQUEST_DATA);
+    ASSERT_TRUE(NULL != cadata);
+    ASSERT_TRUE(NULL != cadata->requestInfo);
+    EXPECT_TRUE(NULL == cadata->responseInfo);
+    EXPECT_EQ(CA_REQUEST_DATA, cadata->dataType);
+    EXPECT_STREQ(m_endpoint.addr, cadata->remoteEndpoint->addr);
+
+    const CAInfo_t *info = &cadata->requestInfo->info;
+    EXPECT_EQ(CA_GET, cadata->requestInfo->method);
+    EXPECT_STREQ("/a/temperature?if=oic.if.sensor", info->resourceUri);
+    ASSERT_EQ(sizeof(TOKEN), info->tokenLength);
+    EXPECT_EQ(0, memcmp(TOKEN, info->token, sizeof(TOKEN)));
+    ASSERT_EQ(sizeof(SENSOR_PAYLOAD) - 1, info->payloadSize);
+    EXPECT_EQ(0, memcmp(SENSOR_PAYLOAD, info->payload, info->payloadSize));
+    ASSERT_EQ(1, info->numOptions);
+    EXPECT_EQ(2048, info->options[0].optionID);
+
+    CAReleaseReceivedData(cadata);
+}
+
+TEST_F(CAMessageHandlerF, CloneOutlivesReceivedData)
+{
+    CAData_t *cadata = CAGenerateReceivedData(&m_endpoint, NULL, receive(), CA_REQUEST_DATA);
+    ASSERT_TRUE(NULL != cadata);
+
+    // the receive queue holds a reference of its own
+    CAHoldReceivedData(cadata);
+    CAReleaseReceivedData(cadata);
+    EXPECT_STREQ("/a/temperature?if=oic.if.sensor", cadata->requestInfo->info.resourceUri);
+
+    CARequestInfo_t *clone = CACloneRequestInfo(cadata->requestInfo);
+    ASSERT_TRUE(NULL != clone);
+    CAReleaseReceivedData(cadata);
+
+    EXPECT_STREQ("/a/temperature?if=oic.if.sensor", clone->info.resourceUri);
+    ASSERT_EQ(sizeof(SENSOR_PAYLOAD) - 1, clone->info.payloadSize);
+    EXPECT_EQ(0, memcmp(SENSOR_PAYLOAD, clone->info.payload, clone->info.payloadSize));
+    CADestroyRequestInfoInternal(clone);
+}
+
+TEST_F(CAMessageHandlerF, FreesReplacedToken)
+{
+    CAData_t *cadata = CAGenerateReceivedData(&m_endpoint, NULL, receive(), CA_REQUEST_DATA);
+    ASSERT_TRUE(NULL != cadata);
+
+    // like the token of an empty message taken from the retransmission list
+    cadata->requestInfo->info.token = (CAToken_t) OICMalloc(sizeof(TOKEN));
+    memcpy(cadata->requestInfo->info.token, TOKEN, sizeof(TOKEN));
+    CAReleaseReceivedData(cadata);
+}
+
+TEST_F(CAMessageHandlerF, Benchmark)
+{
+    benchmark("copied", &CAMessageHandlerF::receiveCopy);
+    benchmark("borrowed", &CAMessageHandlerF::receiveBorrowed);
+}
@@ -23,6 +23,9 @@
 #include "gtest/gtest.h"
 
 #include "caprotocolmessage.h"
+#include "oic_malloc.h"
+
+#include <vector>
 
 namespace {
 
@@ -186,3 +189,91 @@ TEST(CAProtocolMessage, CAParseURILongPath)
     verifyParsedOptions(cases, numCases, optlist);
     coap_delete_list(optlist);
 }
+
+// Builds a received GET with path, query, a header option and a payload.
+static coap_pdu_t *createReceivedRequest(const CAEndpoint_t *endpoint)
+{
+    static const uint8_t token[] = { 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0 };
+    static const char payload[] = "\xBF\x62rt\x69oic.r.tmp\x64temp\x18\x17\xFF";
+
+    coap_pdu_t *pdu = coap_pdu_init(CA_MSG_CONFIRM, COAP_REQUEST_GET, 0x1234,
+                                    COAP_MAX_PDU_SIZE, coap_udp);
+    coap_add_token(pdu, sizeof(token), token, coap_udp);
+    coap_add_option(pdu, COAP_OPTION_URI_PATH, 1, (const uint8_t *) "a", coap_udp);
+    coap_add_option(pdu, COAP_OPTION_URI_PATH, 11, (const uint8_t *) "temperature", coap_udp);
+    uint8_t format = COAP_MEDIATYPE_APPLICATION_CBOR;
+    coap_add_option(pdu, COAP_OPTION_CONTENT_FORMAT, 1, &format, coap_udp);
+    coap_add_option(pdu, COAP_OPTION_URI_QUERY, 16, (const uint8_t *) "if=oic.if.sensor", coap_udp);
+    coap_add_option(pdu, COAP_OPTION_URI_QUERY, 4, (const uint8_t *) "rt=x", coap_udp);
+    coap_add_option(pdu, 2048, 3, (const uint8_t *) "abc", coap_udp);
+    coap_add_data(pdu, sizeof(payload) - 1, (const uint8_t *) payload);
+
+    // parse it back the way it is received
+    uint32_t code = 0;
+    coap_pdu_t *received = CAParsePDU((const char *) pdu->hdr, pdu->length, &code, endpoint);
+    coap_delete_pdu(pdu);
+    return received;
+}
+
+TEST(CAProtocolMessage, CAGetBorrowedInfoFromPDU)
+{
+    CAEndpoint_t endpoint;
+    memset(&endpoint, 0, sizeof(endpoint));
+    endpoint.adapter = CA_ADAPTER_IP;
+    coap_pdu_t *pdu = createReceivedRequest(&endpoint);
+    ASSERT_TRUE(NULL != pdu);
+
+    uint32_t code = 0;
+    CAInfo_t owned;
+    ASSERT_EQ(CA_STATUS_OK, CAGetInfoFromPDU(pdu, &endpoint, &code, &owned));
+    EXPECT_EQ(CA_GET, code);
+
+    std::vector<uint8_t> storage(CAGetBorrowedInfoSize(pdu, &endpoint));
+    uint32_t borrowedCode = 0;
+    CAInfo_t borrowed;
+    ASSERT_EQ(CA_STATUS_OK, CAGetBorrowedInfoFromPDU(pdu, &endpoint, &borrowedCode, &borrowed,
+                                                     &storage[0], storage.size()));
+    EXPECT_EQ(code, borrowedCode);
+
+    EXPECT_STREQ("/a/temperature?if=oic.if.sensor;rt=x", owned.resourceUri);
+    EXPECT_STREQ(owned.resourceUri, borrowed.resourceUri);
+    EXPECT_EQ(owned.type, borrowed.type);
+    EXPECT_EQ(owned.messageId, borrowed.messageId);
+    EXPECT_EQ(CA_FORMAT_APPLICATION_CBOR, borrowed.payloadFormat);
+
+    ASSERT_EQ(owned.tokenLength, borrowed.tokenLength);
+    EXPECT_EQ(0, memcmp(owned.token, borrowed.token, borrowed.tokenLength));
+    ASSERT_EQ(owned.payloadSize, borrowed.payloadSize);
+    EXPECT_EQ(0, memcmp(owned.payload, borrowed.payload, borrowed.payloadSize));
+
+    ASSERT_EQ(1u, borrowed.numOptions);
+    ASSERT_EQ(owned.numOptions, borrowed.numOptions);
+    EXPECT_EQ(0, memcmp(owned.options, borrowed.options, sizeof(CAHeaderOption_t)));
+    EXPECT_EQ(2048, borrowed.options[0].optionID);
+
+    // token and payload are not copied
+    const uint8_t *begin = (const uint8_t *) pdu->hdr;
+    EXPECT_TRUE((const uint8_t *) borrowed.token > begin &&
+                (const uint8_t *) borrowed.token < begin + pdu->length);
+    EXPECT_TRUE(borrowed.payload > begin && borrowed.payload < begin + pdu->length);
+
+    CADestroyInfo(&owned);
+    OICFree(owned.resourceUri);
+    coap_delete_pdu(pdu);
+}
+
+TEST(CAProtocolMessage, CAGetBorrowedInfoFromPDUStorageTooSmall)
+{
+    CAEndpoint_t endpoint;
+    memset(&endpoint, 0, sizeof(endpoint));
+    endpoint.adapter = CA_ADAPTER_IP;
+    coap_pdu_t *pdu = createReceivedRequest(&endpoint);
+    ASSERT_TRUE(NULL != pdu);
+
+    std::vector<uint8_t> storage(CAGetBorrowedInfoSize(pdu, &endpoint) - 1);
+    uint32_t code = 0;
+    CAInfo_t borrowed;
+    EXPECT_NE(CA_STATUS_OK, CAGetBorrowedInfoFromPDU(pdu, &endpoint, &code, &borrowed,
+                                                     &storage[0], storage.size()));
+    coap_delete_pdu(pdu);
+}
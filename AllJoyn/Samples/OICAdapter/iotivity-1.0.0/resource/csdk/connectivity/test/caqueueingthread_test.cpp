@@ -0,0 +1,461 @@
+//******************************************************************
+//
+// Copyright 2015 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include "caqueueingthread.h"
+#include "cathreadpool.h"
+#include "camutex.h"
+#include "oic_malloc.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+static const int BURST_SENDERS = 4;
+static const int BURST_MESSAGES = 20000;
+static const uint32_t BURST_CAPACITY = 256;
+
+typedef struct
+{
+    int id;
+    bool nonConfirmable;
+} queueTestMessage;
+
+typedef struct
+{
+    ca_mutex mutex;
+    ca_cond cond;
+    int processed;
+    int destroyed;
+    int lastId;
+    bool ordered;
+    bool release;
+} queueTestData;
+
+static queueTestData g_data;
+
+static uint64_t nowUsec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static queueTestMessage *newMessage(int id, bool nonConfirmable)
+{
+    queueTestMessage *message = (queueTestMessage *) OICMalloc(sizeof(queueTestMessage));
+    message->id = id;
+    message->nonConfirmable = nonConfirmable;
+    return message;
+}
+
+static void processTask(void *data)
+{
+    queueTestMessage *message = (queueTestMessage *) data;
+
+    ca_mutex_lock(g_data.mutex);
+    if (message->id <= g_data.lastId)
+    {
+        g_data.ordered = false;
+    }
+    g_data.lastId = message->id;
+    g_data.processed++;
+    ca_cond_broadcast(g_data.cond);
+    ca_mutex_unlock(g_data.mutex);
+}
+
+// holds the thread until released, so that the queue fills up
+static void blockingTask(void *data)
+{
+    ca_mutex_lock(g_data.mutex);
+    while (!g_data.release)
+    {
+        ca_cond_wait(g_data.cond, g_data.mutex);
+    }
+    ca_mutex_unlock(g_data.mutex);
+    processTask(data);
+}
+
+static void countingDestroy(void *data, uint32_t)
+{
+    ca_mutex_lock(g_data.mutex);
+    g_data.destroyed++;
+    ca_mutex_unlock(g_data.mutex);
+    OICFree(data);
+}
+
+static bool isNonConfirmable(const void *data, uint32_t)
+{
+    return ((const queueTestMessage *) data)->nonConfirmable;
+}
+
+typedef struct
+{
+    CAQueueingThread_t *thread;
+    int first;
+    int count;
+    int failed;
+} senderArgs;
+
+static void *sendMessages(void *arg)
+{
+    senderArgs *args = (senderArgs *) arg;
+    for (int i = 0; i < args->count; i++)
+    {
+        if (CA_STATUS_OK != CAQueueingThreadAddData(args->thread,
+                                                    newMessage(args->first + i, true),
+                                                    sizeof(queueTestMessage)))
+        {
+            args->failed++;
+        }
+    }
+    return NULL;
+}
+
+class CAQueueingThreadF : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        memset(&g_data, 0, sizeof(g_data));
+        g_data.mutex = ca_mutex_new();
+        g_data.cond = ca_cond_new();
+        g_data.lastId = -1;
+        g_data.ordered = true;
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(2, &m_pool));
+        ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadInitialize(&m_thread, m_pool, processTask,
+                                                           countingDestroy));
+    }
+
+    virtual void TearDown()
+    {
+        release();
+        CAQueueingThreadStop(&m_thread);
+        ca_thread_pool_free(m_pool);
+        CAQueueingThreadDestroy(&m_thread);
+        ca_cond_free(g_data.cond);
+        ca_mutex_free(g_data.mutex);
+    }
+
+    // waits up to a second for processed to reach expected
+    bool waitForProcessed(int expected)
+    {
+        ca_mutex_lock(g_data.mutex);
+        while (g_data.processed < expected)
+        {
+            if (CA_WAIT_TIMEDOUT == ca_cond_wait_for(g_data.cond, g_data.mutex, 1000000))
+            {
+                break;
+            }
+        }
+        bool reached = g_data.processed >= expected;
+        ca_mutex_unlock(g_data.mutex);
+        return reached;
+    }
+
+    void release()
+    {
+        ca_mutex_lock(g_data.mutex);
+        g_data.release = true;
+        ca_cond_broadcast(g_data.cond);
+        ca_mutex_unlock(g_data.mutex);
+    }
+
+    // ids of the queued messages, oldest first; taking them empties the queue
+    std::vector<int> takeIds()
+    {
+        std::vector<int> ids;
+        CAQueueingThreadItem_t items[4];
+        uint32_t count = 0;
+        while (0 < (count = CAQueueingThreadTakeData(&m_thread, items, 4)))
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                ids.push_back(((queueTestMessage *) items[i].data)->id);
+                OICFree(items[i].data);
+            }
+        }
+        return ids;
+    }
+
+    ca_thread_pool_t m_pool;
+    CAQueueingThread_t m_thread;
+};
+
+TEST_F(CAQueueingThreadF, InvalidParams)
+{
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, CAQueueingThreadSetLimit(&m_thread, 0, CA_QUEUE_REJECT));
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, CAQueueingThreadSetLimit(NULL, 1, CA_QUEUE_REJECT));
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, CAQueueingThreadAddData(&m_thread, NULL, 1));
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, CAQueueingThreadGetStats(&m_thread, NULL));
+
+    CAQueueStats_t stats;
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadGetStats(&m_thread, &stats));
+    EXPECT_EQ(0u, stats.depth);
+    EXPECT_EQ((uint32_t) CA_QUEUEING_THREAD_DEFAULT_CAPACITY, stats.capacity);
+}
+
+TEST_F(CAQueueingThreadF, TakesDataInOrder)
+{
+    // more than the initial ring, so that it grows while wrapped
+    for (int i = 0; i < 10; i++)
+    {
+        ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadAddData(&m_thread, newMessage(i, false),
+                                                        sizeof(queueTestMessage)));
+    }
+    CAQueueingThreadItem_t items[4];
+    ASSERT_EQ(4u, CAQueueingThreadTakeData(&m_thread, items, 4));
+    for (int i = 0; i < 4; i++)
+    {
+        OICFree(items[i].data);
+    }
+    for (int i = 10; i < 40; i++)
+    {
+        ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadAddData(&m_thread, newMessage(i, false),
+                                                        sizeof(queueTestMessage)));
+    }
+
+    std::vector<int> ids = takeIds();
+    ASSERT_EQ(36u, ids.size());
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        EXPECT_EQ((int) i + 4, ids[i]);
+    }
+
+    CAQueueStats_t stats;
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadGetStats(&m_thread, &stats));
+    EXPECT_EQ(40u, stats.enqueued);
+    EXPECT_EQ(40u, stats.dequeued);
+    EXPECT_EQ(36u, stats.maxDepth);
+    EXPECT_EQ(0u, stats.depth);
+}
+
+TEST_F(CAQueueingThreadF, RejectsWhenFull)
+{
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadSetLimit(&m_thread, 8, CA_QUEUE_REJECT));
+
+    int rejected = 0;
+    for (int i = 0; i < 20; i++)
+    {
+        if (CA_STATUS_OK != CAQueueingThreadAddData(&m_thread, newMessage(i, true),
+                                                    sizeof(queueTestMessage)))
+        {
+            rejected++;
+        }
+    }
+    EXPECT_EQ(12, rejected);
+    // the queue owns rejected data and destroys it
+    EXPECT_EQ(12, g_data.destroyed);
+
+    CAQueueStats_t stats;
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadGetStats(&m_thread, &stats));
+    EXPECT_EQ(8u, stats.depth);
+    EXPECT_EQ(12u, stats.rejected);
+    EXPECT_EQ(0u, stats.dropped);
+
+    std::vector<int> ids = takeIds();
+    ASSERT_EQ(8u, ids.size());
+    EXPECT_EQ(0, ids.front());
+    EXPECT_EQ(7, ids.back());
+}
+
+TEST_F(CAQueueingThreadF, DropsOldestNonConfirmable)
+{
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadSetLimit(&m_thread, 4, CA_QUEUE_DROP_OLDEST_NON));
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadSetDropCheck(&m_thread, isNonConfirmable));
+
+    // confirmable 0, non 1, confirmable 2, non 3
+    for (int i = 0; i < 4; i++)
+    {
+        ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadAddData(&m_thread, newMessage(i, i % 2),
+                                                        sizeof(queueTestMessage)));
+    }
+    // drops 1, then 3
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadAddData(&m_thread, newMessage(4, false),
+                                                    sizeof(queueTestMessage)));
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadAddData(&m_thread, newMessage(5, false),
+                                                    sizeof(queueTestMessage)));
+    // only confirmable messages are left
+    EXPECT_NE(CA_STATUS_OK, CAQueueingThreadAddData(&m_thread, newMessage(6, true),
+                                                    sizeof(queueTestMessage)));
+    EXPECT_EQ(3, g_data.destroyed);
+
+    CAQueueStats_t stats;
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadGetStats(&m_thread, &stats));
+    EXPECT_EQ(2u, stats.dropped);
+    EXPECT_EQ(1u, stats.rejected);
+
+    std::vector<int> ids = takeIds();
+    int expected[] = { 0, 2, 4, 5 };
+    ASSERT_EQ(4u, ids.size());
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        EXPECT_EQ(expected[i], ids[i]);
+    }
+}
+
+TEST_F(CAQueueingThreadF, AddsBatchInOrder)
+{
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadSetLimit(&m_thread, 4, CA_QUEUE_DROP_OLDEST_NON));
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadSetDropCheck(&m_thread, isNonConfirmable));
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadAddData(&m_thread, newMessage(0, true),
+                                                    sizeof(queueTestMessage)));
+
+    // confirmable 1 to 4, non 5; 0 is dropped for 4, then 5 does not fit
+    CAQueueingThreadItem_t items[5];
+    for (int i = 0; i < 5; i++)
+    {
+        items[i].data = newMessage(i + 1, 4 == i);
+        items[i].size = sizeof(queueTestMessage);
+    }
+    EXPECT_NE(CA_STATUS_OK, CAQueueingThreadAddDataBatch(&m_thread, items, 5));
+    EXPECT_EQ(2, g_data.destroyed);
+
+    CAQueueStats_t stats;
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadGetStats(&m_thread, &stats));
+    EXPECT_EQ(5u, stats.enqueued);
+    EXPECT_EQ(1u, stats.dropped);
+    EXPECT_EQ(1u, stats.rejected);
+
+    std::vector<int> ids = takeIds();
+    ASSERT_EQ(4u, ids.size());
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        EXPECT_EQ((int) i + 1, ids[i]);
+    }
+}
+
+TEST_F(CAQueueingThreadF, ThreadProcessesBatch)
+{
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadStart(&m_thread));
+
+    CAQueueingThreadItem_t items[CA_QUEUEING_THREAD_BATCH_SIZE];
+    for (int i = 0; i < CA_QUEUEING_THREAD_BATCH_SIZE; i++)
+    {
+        items[i].data = newMessage(i, false);
+        items[i].size = sizeof(queueTestMessage);
+    }
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadAddDataBatch(&m_thread, items,
+                                                         CA_QUEUEING_THREAD_BATCH_SIZE));
+
+    EXPECT_TRUE(waitForProcessed(CA_QUEUEING_THREAD_BATCH_SIZE));
+    EXPECT_TRUE(g_data.ordered);
+}
+
+TEST_F(CAQueueingThreadF, BlocksUntilThereIsRoom)
+{
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadSetLimit(&m_thread, 2, CA_QUEUE_BLOCK));
+    for (int i = 0; i < 2; i++)
+    {
+        ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadAddData(&m_thread, newMessage(i, true),
+                                                        sizeof(queueTestMessage)));
+    }
+
+    senderArgs args = { &m_thread, 2, 1, 0 };
+    pthread_t sender;
+    ASSERT_EQ(0, pthread_create(&sender, NULL, sendMessages, &args));
+
+    // wait until the sender is blocked, then make room
+    CAQueueStats_t stats;
+    for (int i = 0; i < 100; i++)
+    {
+        ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadGetStats(&m_thread, &stats));
+        if (0 < stats.blocked)
+        {
+            break;
+        }
+        usleep(1000);
+    }
+    EXPECT_EQ(1u, stats.blocked);
+    EXPECT_EQ(2u, stats.depth);
+
+    CAQueueingThreadItem_t item;
+    ASSERT_EQ(1u, CAQueueingThreadTakeData(&m_thread, &item, 1));
+    OICFree(item.data);
+    pthread_join(sender, NULL);
+
+    EXPECT_EQ(0, args.failed);
+    std::vector<int> ids = takeIds();
+    ASSERT_EQ(2u, ids.size());
+    EXPECT_EQ(1, ids[0]);
+    EXPECT_EQ(2, ids[1]);
+}
+
+TEST_F(CAQueueingThreadF, ThreadProcessesQueuedData)
+{
+    m_thread.threadTask = blockingTask;
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadStart(&m_thread));
+
+    for (int i = 0; i < 50; i++)
+    {
+        ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadAddData(&m_thread, newMessage(i, false),
+                                                        sizeof(queueTestMessage)));
+    }
+    release();
+    EXPECT_TRUE(waitForProcessed(50));
+    EXPECT_TRUE(g_data.ordered);
+
+    CAQueueStats_t stats;
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadGetStats(&m_thread, &stats));
+    EXPECT_EQ(50u, stats.dequeued);
+    EXPECT_LE(stats.totalLatency / 50, stats.maxLatency);
+}
+
+// Several senders flood a started queue; memory stays within the capacity and
+// the thread takes the messages in batches.
+TEST_F(CAQueueingThreadF, BenchmarkBurst)
+{
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadSetLimit(&m_thread, BURST_CAPACITY, CA_QUEUE_BLOCK));
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadStart(&m_thread));
+
+    senderArgs args[BURST_SENDERS];
+    pthread_t senders[BURST_SENDERS];
+    uint64_t start = nowUsec();
+    for (int i = 0; i < BURST_SENDERS; i++)
+    {
+        args[i].thread = &m_thread;
+        args[i].first = i * BURST_MESSAGES;
+        args[i].count = BURST_MESSAGES;
+        args[i].failed = 0;
+        ASSERT_EQ(0, pthread_create(&senders[i], NULL, sendMessages, &args[i]));
+    }
+    for (int i = 0; i < BURST_SENDERS; i++)
+    {
+        pthread_join(senders[i], NULL);
+        EXPECT_EQ(0, args[i].failed);
+    }
+    EXPECT_TRUE(waitForProcessed(BURST_SENDERS * BURST_MESSAGES));
+    uint64_t elapsed = nowUsec() - start;
+
+    CAQueueStats_t stats;
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadGetStats(&m_thread, &stats));
+    EXPECT_EQ((uint64_t) BURST_SENDERS * BURST_MESSAGES, stats.dequeued);
+    EXPECT_LE(stats.maxDepth, BURST_CAPACITY);
+    EXPECT_LE(m_thread.itemsSize, BURST_CAPACITY);
+
+    printf("[          ] %d messages: %.3f usec per message, %u peak depth, "
+           "%.1f usec average latency\n", BURST_SENDERS * BURST_MESSAGES,
+           (double) elapsed / (BURST_SENDERS * BURST_MESSAGES), stats.maxDepth,
+           (double) stats.totalLatency / stats.dequeued);
+}
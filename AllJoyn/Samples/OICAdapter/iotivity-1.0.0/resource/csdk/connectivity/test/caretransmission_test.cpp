@@ -0,0 +1,223 @@
+//******************************************************************
+//
+// Copyright 2015 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include "caretransmission.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+// CoAP version 1 header with no token.
+static const uint8_t COAP_TYPE_CON = 0x40;
+static const uint8_t COAP_TYPE_ACK = 0x60;
+static const uint8_t COAP_TYPE_RST = 0x70;
+static const uint8_t COAP_CODE_GET = 0x01;
+static const uint8_t COAP_CODE_EMPTY = 0x00;
+static const uint8_t COAP_CODE_CONTENT = 0x45;
+
+static void makePdu(uint8_t *pdu, uint8_t type, uint8_t code, uint16_t messageId)
+{
+    pdu[0] = type;
+    pdu[1] = code;
+    pdu[2] = (uint8_t)(messageId >> 8);
+    pdu[3] = (uint8_t)(messageId & 0xFF);
+}
+
+static int g_sentCount = 0;
+static int g_timeoutCount = 0;
+
+static CAResult_t countSend(const CAEndpoint_t *, const void *, uint32_t)
+{
+    ++g_sentCount;
+    return CA_STATUS_OK;
+}
+
+static void countTimeout(const CAEndpoint_t *, const void *, uint32_t)
+{
+    ++g_timeoutCount;
+}
+
+class CARetransmissionF : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        g_sentCount = 0;
+        g_timeoutCount = 0;
+
+        memset(&endpoint, 0, sizeof(endpoint));
+        endpoint.adapter = CA_ADAPTER_IP;
+        endpoint.port = 5683;
+        strncpy(endpoint.addr, "192.168.0.10", sizeof(endpoint.addr) - 1);
+
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &threadPool));
+    }
+
+    virtual void TearDown()
+    {
+        ca_thread_pool_free(threadPool);
+    }
+
+    void init(uint8_t tryingCount)
+    {
+        CARetransmissionConfig_t config = { (CATransportAdapter_t) DEFAULT_RETRANSMISSION_TYPE,
+                                            tryingCount };
+        ASSERT_EQ(CA_STATUS_OK, CARetransmissionInitialize(&context, threadPool,
+                                                           countSend, countTimeout, &config));
+    }
+
+    CAResult_t sent(const CAEndpoint_t *ep, uint16_t messageId)
+    {
+        uint8_t pdu[4];
+        makePdu(pdu, COAP_TYPE_CON, COAP_CODE_GET, messageId);
+        return CARetransmissionSentData(&context, ep, pdu, sizeof(pdu));
+    }
+
+    CAResult_t received(const CAEndpoint_t *ep, uint8_t type, uint8_t code,
+                        uint16_t messageId)
+    {
+        uint8_t pdu[4];
+        void *retransmissionPdu = NULL;
+        makePdu(pdu, type, code, messageId);
+        CAResult_t res = CARetransmissionReceivedData(&context, ep, pdu, sizeof(pdu),
+                                                      &retransmissionPdu);
+        free(retransmissionPdu);
+        return res;
+    }
+
+    ca_thread_pool_t threadPool;
+    CARetransmission_t context;
+    CAEndpoint_t endpoint;
+};
+
+TEST_F(CARetransmissionF, AckRemovesData)
+{
+    init(DEFAULT_RETRANSMISSION_COUNT);
+
+    EXPECT_EQ(CA_STATUS_OK, sent(&endpoint, 1));
+    EXPECT_EQ(CA_STATUS_OK, sent(&endpoint, 2));
+    EXPECT_EQ(2u, context.count);
+
+    EXPECT_EQ(CA_STATUS_OK, received(&endpoint, COAP_TYPE_ACK, COAP_CODE_CONTENT, 1));
+    EXPECT_EQ(1u, context.count);
+
+    EXPECT_EQ(CA_STATUS_OK, received(&endpoint, COAP_TYPE_RST, COAP_CODE_EMPTY, 2));
+    EXPECT_EQ(0u, context.count);
+
+    EXPECT_EQ(CA_STATUS_OK, CARetransmissionDestroy(&context));
+}
+
+TEST_F(CARetransmissionF, DuplicateMessageId)
+{
+    init(DEFAULT_RETRANSMISSION_COUNT);
+
+    EXPECT_EQ(CA_STATUS_OK, sent(&endpoint, 7));
+    EXPECT_EQ(CA_STATUS_FAILED, sent(&endpoint, 7));
+    EXPECT_EQ(1u, context.count);
+
+    EXPECT_EQ(CA_STATUS_OK, CARetransmissionDestroy(&context));
+}
+
+TEST_F(CARetransmissionF, AckFromOtherEndpointIgnored)
+{
+    init(DEFAULT_RETRANSMISSION_COUNT);
+
+    CAEndpoint_t other = endpoint;
+    other.port = 5684;
+
+    EXPECT_EQ(CA_STATUS_OK, sent(&endpoint, 3));
+    EXPECT_EQ(CA_STATUS_OK, sent(&other, 3));
+    EXPECT_EQ(2u, context.count);
+
+    EXPECT_EQ(CA_STATUS_OK, received(&other, COAP_TYPE_ACK, COAP_CODE_CONTENT, 3));
+    EXPECT_EQ(1u, context.count);
+
+    EXPECT_EQ(CA_STATUS_OK, received(&other, COAP_TYPE_ACK, COAP_CODE_CONTENT, 3));
+    EXPECT_EQ(1u, context.count);
+
+    EXPECT_EQ(CA_STATUS_OK, CARetransmissionDestroy(&context));
+}
+
+TEST_F(CARetransmissionF, NonConfirmableNotTracked)
+{
+    init(DEFAULT_RETRANSMISSION_COUNT);
+
+    uint8_t pdu[4];
+    makePdu(pdu, 0x50, COAP_CODE_GET, 4);
+    EXPECT_EQ(CA_NOT_SUPPORTED, CARetransmissionSentData(&context, &endpoint, pdu, sizeof(pdu)));
+    EXPECT_EQ(0u, context.count);
+
+    EXPECT_EQ(CA_STATUS_OK, CARetransmissionDestroy(&context));
+}
+
+TEST_F(CARetransmissionF, RetransmitThenTimeout)
+{
+    init(1);
+    ASSERT_EQ(CA_STATUS_OK, CARetransmissionStart(&context));
+
+    EXPECT_EQ(CA_STATUS_OK, sent(&endpoint, 5));
+
+    // first try is due after DEFAULT_ACK_TIMEOUT_SEC * 1.5 at the latest.
+    for (int i = 0; i < 40 && 0 == g_timeoutCount; i++)
+    {
+        usleep(100000);
+    }
+
+    EXPECT_EQ(1, g_sentCount);
+    EXPECT_EQ(1, g_timeoutCount);
+    EXPECT_EQ(0u, context.count);
+
+    EXPECT_EQ(CA_STATUS_OK, CARetransmissionStop(&context));
+    EXPECT_EQ(CA_STATUS_OK, CARetransmissionDestroy(&context));
+}
+
+TEST_F(CARetransmissionF, ManyOutstandingAreMatched)
+{
+    const int outstanding = 1000;
+    init(DEFAULT_RETRANSMISSION_COUNT);
+
+    CAEndpoint_t peers[16];
+    for (int i = 0; i < 16; i++)
+    {
+        peers[i] = endpoint;
+        snprintf(peers[i].addr, sizeof(peers[i].addr), "192.168.0.%d", 10 + i);
+    }
+
+    for (int i = 0; i < outstanding; i++)
+    {
+        ASSERT_EQ(CA_STATUS_OK, sent(&peers[i % 16], (uint16_t) i));
+    }
+    EXPECT_EQ((uint32_t) outstanding, context.count);
+
+    // answered in the reverse order, so each ACK is matched among all others
+    for (int i = outstanding - 1; i >= 0; i--)
+    {
+        EXPECT_EQ(CA_STATUS_OK, received(&peers[i % 16], COAP_TYPE_ACK, COAP_CODE_CONTENT,
+                                         (uint16_t) i));
+    }
+
+    EXPECT_EQ(0u, context.count);
+
+    EXPECT_EQ(0, g_sentCount);
+    EXPECT_EQ(0, g_timeoutCount);
+    EXPECT_EQ(CA_STATUS_OK, CARetransmissionDestroy(&context));
+}
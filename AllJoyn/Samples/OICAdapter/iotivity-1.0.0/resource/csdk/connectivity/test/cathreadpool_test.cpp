@@ -0,0 +1,253 @@
+//******************************************************************
+//
+// Copyright 2015 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include "cathreadpool.h"
+#include "camutex.h"
+#include "ThreadCount.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static const int BENCHMARK_TASKS = 2000;
+
+typedef struct
+{
+    ca_mutex mutex;
+    ca_cond cond;
+    int count;
+    bool release;
+    int maxThreads;
+    uint64_t latencyUsec;
+} poolTestData;
+
+static poolTestData g_data;
+
+static uint64_t nowUsec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void countTask(void *)
+{
+    ca_mutex_lock(g_data.mutex);
+    g_data.count++;
+    ca_cond_broadcast(g_data.cond);
+    ca_mutex_unlock(g_data.mutex);
+}
+
+static void blockingTask(void *)
+{
+    ca_mutex_lock(g_data.mutex);
+    while (!g_data.release)
+    {
+        ca_cond_wait(g_data.cond, g_data.mutex);
+    }
+    g_data.count++;
+    ca_mutex_unlock(g_data.mutex);
+}
+
+static void latencyTask(void *data)
+{
+    uint64_t latency = nowUsec() - *(uint64_t *) data;
+
+    ca_mutex_lock(g_data.mutex);
+    g_data.count++;
+    g_data.latencyUsec += latency;
+    ca_mutex_unlock(g_data.mutex);
+}
+
+class CAThreadPoolF : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        memset(&g_data, 0, sizeof(g_data));
+        g_data.mutex = ca_mutex_new();
+        g_data.cond = ca_cond_new();
+    }
+
+    virtual void TearDown()
+    {
+        ca_cond_free(g_data.cond);
+        ca_mutex_free(g_data.mutex);
+    }
+
+    // waits up to a second for count to reach expected
+    bool waitForCount(int expected)
+    {
+        ca_mutex_lock(g_data.mutex);
+        while (g_data.count < expected)
+        {
+            if (CA_WAIT_TIMEDOUT == ca_cond_wait_for(g_data.cond, g_data.mutex, 1000000))
+            {
+                break;
+            }
+        }
+        bool reached = g_data.count >= expected;
+        ca_mutex_unlock(g_data.mutex);
+        return reached;
+    }
+
+    void release()
+    {
+        ca_mutex_lock(g_data.mutex);
+        g_data.release = true;
+        ca_cond_broadcast(g_data.cond);
+        ca_mutex_unlock(g_data.mutex);
+    }
+
+    void benchmark(const char *name, int32_t workers, bool dedicated)
+    {
+        ca_thread_pool_t pool;
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(workers, &pool));
+
+        g_data.count = 0;
+        g_data.latencyUsec = 0;
+        g_data.maxThreads = 0;
+
+        static uint64_t submitted[BENCHMARK_TASKS];
+        for (int i = 0; i < BENCHMARK_TASKS; i++)
+        {
+            if (0 == i % 50)
+            {
+                int threads = getProcessThreadCount();
+                if (threads > g_data.maxThreads)
+                {
+                    g_data.maxThreads = threads;
+                }
+            }
+
+            submitted[i] = nowUsec();
+            if (dedicated)
+            {
+                ASSERT_EQ(CA_STATUS_OK,
+                          ca_thread_pool_add_dedicated_task(pool, latencyTask, &submitted[i]));
+            }
+            else
+            {
+                // back off while the queue is full, as a busy caller would have to
+                while (CA_STATUS_OK != ca_thread_pool_add_task(pool, latencyTask, &submitted[i]))
+                {
+                    usleep(100);
+                    submitted[i] = nowUsec();
+                }
+            }
+        }
+        ca_thread_pool_free(pool);
+
+        EXPECT_EQ(BENCHMARK_TASKS, g_data.count);
+        printf("[          ] %s: %.3f usec average dispatch latency, %d threads at peak\n",
+               name, (double) g_data.latencyUsec / BENCHMARK_TASKS, g_data.maxThreads);
+    }
+};
+
+TEST_F(CAThreadPoolF, InvalidParams)
+{
+    ca_thread_pool_t pool;
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, ca_thread_pool_init(0, &pool));
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, ca_thread_pool_init(1, NULL));
+
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &pool));
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, ca_thread_pool_add_task(pool, NULL, NULL));
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, ca_thread_pool_add_task(NULL, countTask, NULL));
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, ca_thread_pool_add_dedicated_task(pool, NULL, NULL));
+    ca_thread_pool_free(pool);
+}
+
+TEST_F(CAThreadPoolF, RunsAllTasks)
+{
+    ca_thread_pool_t pool;
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(4, &pool));
+
+    for (int i = 0; i < 100; i++)
+    {
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(pool, countTask, NULL));
+    }
+    EXPECT_TRUE(waitForCount(100));
+
+    ca_thread_pool_free(pool);
+    EXPECT_EQ(100, g_data.count);
+}
+
+TEST_F(CAThreadPoolF, FreeRunsQueuedTasks)
+{
+    ca_thread_pool_t pool;
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &pool));
+
+    // the only worker is busy, so everything else stays queued
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(pool, blockingTask, NULL));
+    for (int i = 0; i < 10; i++)
+    {
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(pool, countTask, NULL));
+    }
+    EXPECT_FALSE(waitForCount(1));
+
+    release();
+    ca_thread_pool_free(pool);
+    EXPECT_EQ(11, g_data.count);
+}
+
+TEST_F(CAThreadPoolF, DedicatedTaskKeepsWorkerFree)
+{
+    ca_thread_pool_t pool;
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &pool));
+
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_add_dedicated_task(pool, blockingTask, NULL));
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(pool, countTask, NULL));
+    EXPECT_TRUE(waitForCount(1));
+
+    release();
+    ca_thread_pool_free(pool);
+    EXPECT_EQ(2, g_data.count);
+}
+
+TEST_F(CAThreadPoolF, FullQueueRefusesTask)
+{
+    ca_thread_pool_t pool;
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(2, &pool));
+
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(pool, blockingTask, NULL));
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(pool, blockingTask, NULL));
+
+    int accepted = 2;
+    while (accepted < 10000 && CA_STATUS_OK == ca_thread_pool_add_task(pool, countTask, NULL))
+    {
+        accepted++;
+    }
+    EXPECT_LT(accepted, 10000);
+
+    release();
+    ca_thread_pool_free(pool);
+    EXPECT_EQ(accepted, g_data.count);
+}
+
+TEST_F(CAThreadPoolF, Benchmark)
+{
+    // a dedicated thread per task is what ca_thread_pool_add_task used to do
+    benchmark("thread per task", 20, true);
+    benchmark("pool of 4 workers", 4, false);
+    benchmark("pool of 20 workers", 20, false);
+}
@@ -0,0 +1,374 @@
+//******************************************************************
+//
+// Copyright 2015 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include "coap.h"
+
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <vector>
+
+extern "C" void coap_handle_failed_notify(coap_context_t *, const coap_address_t *, const str *);
+
+static const int BENCHMARK_EXCHANGES = 5000;
+
+static uint64_t nowUsec()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+class CoAPNetF : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        coap_address_init(&m_addr);
+        m_addr.addr.sin.sin_family = AF_INET;
+        m_addr.addr.sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        m_addr.size = sizeof(struct sockaddr_in);
+
+        m_ctx = coap_new_context(&m_addr);
+        ASSERT_TRUE(m_ctx != NULL);
+
+        // send to ourselves so that every sendto succeeds
+        m_addr.size = sizeof(m_addr.addr);
+        ASSERT_EQ(0, getsockname(m_ctx->sockfd, &m_addr.addr.sa, &m_addr.size));
+    }
+
+    virtual void TearDown()
+    {
+        coap_free_context(m_ctx);
+    }
+
+    coap_address_t peer(unsigned short port)
+    {
+        coap_address_t addr = m_addr;
+        addr.addr.sin.sin_port = htons(port);
+        return addr;
+    }
+
+    coap_tid_t sendConfirmed(const coap_address_t *dst, unsigned int token)
+    {
+        coap_pdu_t *pdu = coap_pdu_init(COAP_MESSAGE_CON, COAP_REQUEST_GET,
+                                        coap_new_message_id(m_ctx), COAP_MAX_PDU_SIZE,
+                                        coap_udp);
+        if (!pdu)
+        {
+            return COAP_INVALID_TID;
+        }
+        coap_add_token(pdu, sizeof(token), (const unsigned char *) &token, coap_udp);
+
+        coap_tid_t id = coap_send_confirmed(m_ctx, dst, pdu);
+        if (COAP_INVALID_TID == id)
+        {
+            coap_delete_pdu(pdu);
+        }
+        return id;
+    }
+
+    coap_context_t *m_ctx;
+    coap_address_t m_addr;
+};
+
+TEST_F(CoAPNetF, FindTransactionByIdAndToken)
+{
+    coap_address_t dst = peer(5683);
+    unsigned int token = 0x1234;
+
+    coap_tid_t id = sendConfirmed(&dst, token);
+    ASSERT_NE(COAP_INVALID_TID, id);
+
+    coap_queue_t *node = coap_find_sent_transaction(m_ctx, id);
+    ASSERT_TRUE(node != NULL);
+    EXPECT_EQ(id, node->id);
+    EXPECT_EQ(node, coap_find_sent_token(m_ctx, &dst, (const unsigned char *) &token,
+                                         sizeof(token)));
+
+    unsigned int other = 0x4321;
+    EXPECT_TRUE(coap_find_sent_token(m_ctx, &dst, (const unsigned char *) &other,
+                                     sizeof(other)) == NULL);
+    EXPECT_FALSE(coap_can_exit(m_ctx));
+
+    coap_queue_t *removed = NULL;
+    EXPECT_EQ(1, coap_remove_from_sendqueue(m_ctx, id, &removed));
+    EXPECT_EQ(node, removed);
+    coap_delete_node(removed);
+
+    EXPECT_TRUE(coap_find_sent_transaction(m_ctx, id) == NULL);
+    EXPECT_EQ(0, coap_remove_from_sendqueue(m_ctx, id, &removed));
+    EXPECT_TRUE(coap_can_exit(m_ctx));
+}
+
+TEST_F(CoAPNetF, PopNextInDueOrder)
+{
+    coap_address_t dst = peer(5683);
+    for (unsigned int i = 0; i < 200; i++)
+    {
+        ASSERT_NE(COAP_INVALID_TID, sendConfirmed(&dst, i));
+    }
+
+    // the first transaction is due within the randomized response timeout
+    coap_queue_t *next = coap_peek_next(m_ctx);
+    ASSERT_TRUE(next != NULL);
+    EXPECT_LE(next->t, (coap_tick_t) COAP_DEFAULT_RESPONSE_TIMEOUT * 3 / 2
+                       * COAP_TICKS_PER_SECOND);
+
+    // all have timed out a minute later
+    coap_tick_t now;
+    coap_ticks(&now);
+    EXPECT_EQ(200u, coap_adjust_basetime(m_ctx, now + 60 * COAP_TICKS_PER_SECOND));
+
+    int popped = 0;
+    while ((next = coap_pop_next(m_ctx)))
+    {
+        EXPECT_EQ(0u, next->t);
+        EXPECT_TRUE(coap_find_sent_transaction(m_ctx, next->id) == NULL);
+        coap_delete_node(next);
+        popped++;
+    }
+    EXPECT_EQ(200, popped);
+    EXPECT_TRUE(coap_can_exit(m_ctx));
+}
+
+TEST_F(CoAPNetF, RetransmitKeepsDueOrder)
+{
+    coap_address_t dst = peer(5683);
+    for (unsigned int i = 0; i < 100; i++)
+    {
+        ASSERT_NE(COAP_INVALID_TID, sendConfirmed(&dst, i));
+    }
+
+    // retransmit everything once; the nodes come back in time order
+    coap_tick_t now;
+    coap_ticks(&now);
+    coap_adjust_basetime(m_ctx, now + 3 * COAP_TICKS_PER_SECOND);
+    coap_queue_t *next;
+    int retransmitted = 0;
+    while ((next = coap_peek_next(m_ctx)) && next->t == 0)
+    {
+        next = coap_pop_next(m_ctx);
+        EXPECT_EQ(next->id, coap_retransmit(m_ctx, next));
+        EXPECT_EQ(next, coap_find_sent_transaction(m_ctx, next->id));
+        retransmitted++;
+    }
+    EXPECT_EQ(100, retransmitted);
+
+    coap_tick_t last = 0;
+    coap_tick_t due = m_ctx->sendqueue_basetime;
+    int popped = 0;
+    while ((next = coap_pop_next(m_ctx)))
+    {
+        due += next->t;
+        EXPECT_GE(due - m_ctx->sendqueue_basetime, last);
+        last = due - m_ctx->sendqueue_basetime;
+        EXPECT_EQ(1, next->retransmit_cnt);
+        coap_delete_node(next);
+        popped++;
+    }
+    EXPECT_EQ(100, popped);
+}
+
+TEST_F(CoAPNetF, CancelAllMessagesForToken)
+{
+    coap_address_t dst = peer(5683);
+    coap_address_t other = peer(5684);
+    unsigned int token = 7;
+
+    ASSERT_NE(COAP_INVALID_TID, sendConfirmed(&dst, token));
+    ASSERT_NE(COAP_INVALID_TID, sendConfirmed(&dst, token));
+    ASSERT_NE(COAP_INVALID_TID, sendConfirmed(&dst, token + 1));
+    coap_tid_t kept = sendConfirmed(&other, token);
+    ASSERT_NE(COAP_INVALID_TID, kept);
+
+    coap_cancel_all_messages(m_ctx, &dst, (const unsigned char *) &token, sizeof(token));
+
+    EXPECT_TRUE(coap_find_sent_token(m_ctx, &dst, (const unsigned char *) &token,
+                                     sizeof(token)) == NULL);
+    EXPECT_TRUE(coap_find_sent_transaction(m_ctx, kept) != NULL);
+    EXPECT_EQ(2u, m_ctx->transaction_count);
+}
+
+TEST_F(CoAPNetF, ObserverTable)
+{
+    static const unsigned char uri[] = "a/light";
+    coap_resource_t *r = coap_resource_init(uri, sizeof(uri) - 1, 0);
+    ASSERT_TRUE(r != NULL);
+    coap_add_resource(m_ctx, r);
+
+    std::vector<coap_address_t> peers;
+    unsigned char tokenBytes[2] = { 0, 0 };
+    str token = { sizeof(tokenBytes), tokenBytes };
+    for (unsigned short i = 0; i < 100; i++)
+    {
+        peers.push_back(peer(6000 + i));
+        tokenBytes[0] = i & 0xFF;
+        ASSERT_TRUE(coap_add_observer(r, &peers[i], &token) != NULL);
+    }
+    EXPECT_EQ(100u, m_ctx->observer_count);
+
+    tokenBytes[0] = 42;
+    coap_subscription_t *s = coap_find_observer(r, &peers[42], &token);
+    ASSERT_TRUE(s != NULL);
+    EXPECT_EQ(r, s->resource);
+    EXPECT_EQ(s, coap_add_observer(r, &peers[42], &token));
+    EXPECT_EQ(s, coap_find_observer(r, &peers[42], NULL));
+    EXPECT_TRUE(coap_find_observer(r, &peers[41], &token) == NULL);
+
+    // failed notifies remove the observer after COAP_OBS_MAX_FAIL
+    for (int i = 0; i < COAP_OBS_MAX_FAIL; i++)
+    {
+        coap_handle_failed_notify(m_ctx, &peers[42], &token);
+    }
+    EXPECT_EQ(COAP_OBS_MAX_FAIL, (int) s->fail_cnt);
+    coap_touch_observer(m_ctx, &peers[42], &token);
+    EXPECT_EQ(0, (int) s->fail_cnt);
+    for (int i = 0; i <= COAP_OBS_MAX_FAIL; i++)
+    {
+        coap_handle_failed_notify(m_ctx, &peers[42], &token);
+    }
+    EXPECT_TRUE(coap_find_observer(r, &peers[42], &token) == NULL);
+    EXPECT_EQ(99u, m_ctx->observer_count);
+
+    tokenBytes[0] = 7;
+    coap_delete_observer(r, &peers[7], &token);
+    EXPECT_TRUE(coap_find_observer(r, &peers[7], &token) == NULL);
+    EXPECT_EQ(98u, m_ctx->observer_count);
+
+    EXPECT_EQ(1, coap_delete_resource(m_ctx, r->key));
+    EXPECT_EQ(0u, m_ctx->observer_count);
+}
+
+TEST_F(CoAPNetF, AddResourceWithObservers)
+{
+    static const unsigned char uri[] = "a/light";
+    static const unsigned char otherUri[] = "a/fan";
+    coap_resource_t *r = coap_resource_init(uri, sizeof(uri) - 1, 0);
+    ASSERT_TRUE(r != NULL);
+    coap_add_resource(m_ctx, r);
+
+    // a full table, so that adding the next resource makes a new one
+    std::vector<coap_address_t> peers;
+    unsigned char tokenBytes[2] = { 0, 0 };
+    str token = { sizeof(tokenBytes), tokenBytes };
+    for (unsigned short i = 0; i < 16; i++)
+    {
+        peers.push_back(peer(6000 + i));
+        tokenBytes[0] = i & 0xFF;
+        ASSERT_TRUE(coap_add_observer(r, &peers[i], &token) != NULL);
+    }
+    ASSERT_EQ(16u, m_ctx->observer_count);
+    ASSERT_EQ(16u, m_ctx->observer_buckets);
+
+    // observed before it is added, like a resource that is registered again
+    coap_resource_t *other = coap_resource_init(otherUri, sizeof(otherUri) - 1, 0);
+    ASSERT_TRUE(other != NULL);
+    tokenBytes[1] = 1;
+    for (unsigned short i = 0; i < 20; i++)
+    {
+        peers.push_back(peer(7000 + i));
+        tokenBytes[0] = i & 0xFF;
+        ASSERT_TRUE(coap_add_observer(other, &peers[16 + i], &token) != NULL);
+    }
+    coap_add_resource(m_ctx, other);
+    EXPECT_EQ(36u, m_ctx->observer_count);
+
+    // every subscription is linked once, and the chains end
+
+    size_t linked = 0;
+    for (unsigned int b = 0; b < m_ctx->observer_buckets; b++)
+    {
+        for (coap_subscription_t *s = m_ctx->observers[b]; s && linked <= 36; s = s->observer_next)
+        {
+            linked++;
+        }
+    }
+    ASSERT_EQ(36u, linked);
+
+    for (unsigned short i = 0; i < 20; i++)
+    {
+        tokenBytes[0] = i & 0xFF;
+        coap_subscription_t *s = coap_find_observer(other, &peers[16 + i], &token);
+        ASSERT_TRUE(s != NULL);
+        EXPECT_EQ(other, s->resource);
+    }
+
+    EXPECT_EQ(1, coap_delete_resource(m_ctx, other->key));
+    EXPECT_EQ(16u, m_ctx->observer_count);
+    EXPECT_EQ(1, coap_delete_resource(m_ctx, r->key));
+    EXPECT_EQ(0u, m_ctx->observer_count);
+}
+
+TEST_F(CoAPNetF, BenchmarkConfirmableExchanges)
+{
+    std::vector<coap_tid_t> ids;
+    ids.reserve(BENCHMARK_EXCHANGES);
+
+    uint64_t start = nowUsec();
+    for (int i = 0; i < BENCHMARK_EXCHANGES; i++)
+    {
+        coap_address_t dst = peer(10000 + i % 1000);
+        coap_tid_t id = sendConfirmed(&dst, i);
+        ASSERT_NE(COAP_INVALID_TID, id);
+        ids.push_back(id);
+    }
+    uint64_t sent = nowUsec();
+
+    // one retransmission round for all pending exchanges
+    coap_tick_t now;
+    coap_ticks(&now);
+    coap_adjust_basetime(m_ctx, now + 3 * COAP_TICKS_PER_SECOND);
+    coap_queue_t *next;
+    int retransmitted = 0;
+    while ((next = coap_peek_next(m_ctx)) && next->t == 0)
+    {
+        coap_retransmit(m_ctx, coap_pop_next(m_ctx));
+        retransmitted++;
+    }
+    uint64_t resent = nowUsec();
+
+    // acknowledge in an order unrelated to the send order
+    int acked = 0;
+    for (int i = 0; i < BENCHMARK_EXCHANGES; i++)
+    {
+        coap_queue_t *node = NULL;
+        int k = (i * 7919) % BENCHMARK_EXCHANGES;
+        if (coap_remove_from_sendqueue(m_ctx, ids[k], &node))
+        {
+            coap_delete_node(node);
+            acked++;
+        }
+    }
+    uint64_t done = nowUsec();
+
+    EXPECT_EQ(BENCHMARK_EXCHANGES, retransmitted);
+    EXPECT_EQ(BENCHMARK_EXCHANGES, acked);
+    EXPECT_TRUE(coap_can_exit(m_ctx));
+
+    printf("[          ] %d exchanges: %.3f usec per send, %.3f usec per retransmit, "
+           "%.3f usec per ack\n", BENCHMARK_EXCHANGES,
+           (double) (sent - start) / BENCHMARK_EXCHANGES,
+           (double) (resent - sent) / BENCHMARK_EXCHANGES,
+           (double) (done - resent) / BENCHMARK_EXCHANGES);
+}
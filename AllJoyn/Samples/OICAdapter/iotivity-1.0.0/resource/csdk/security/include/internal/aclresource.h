@@ -52,6 +52,27 @@ void DeInitACLResource();
  */
 const OicSecAcl_t* GetACLResourceData(const OicUuid_t* subjectId, OicSecAcl_t **savePtr);
 
+/**
+ * This method is used by PolicyEngine to find the ACE deciding a request.
+ * Lookups use an index of the ACL by subject and resource URI.
+ *
+ * @param subjectId ID of the requesting subject.
+ * @param resource URI of the requested resource.
+ * @param subjectFound set to true if the ACL has any ACE for subjectId.
+ *
+ * @retval  the first ACE for subjectId containing resource or the wildcard resource,
+ *          NULL if there is none.
+ */
+const OicSecAcl_t* FindACE(const OicUuid_t* subjectId, const char* resource, bool* subjectFound);
+
+/**
+ * Version of the ACL. It changes whenever the ACL is modified, so results derived
+ * from the ACL can be invalidated.
+ *
+ * @retval  current ACL version.
+ */
+uint32_t GetACLVersion();
+
 /**
  * This function converts ACL data into JSON format.
  * Caller needs to invoke 'free' when done using
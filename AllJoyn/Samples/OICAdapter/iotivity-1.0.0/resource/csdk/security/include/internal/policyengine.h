@@ -30,6 +30,7 @@
 #include <stdint.h>
 
 typedef struct AmsMgrContext AmsMgrContext_t;
+typedef struct PEDecisionCache PEDecisionCache_t;
 
 
 typedef enum PEState
@@ -41,6 +42,15 @@ typedef enum PEState
 } PEState_t;
 
 
+typedef struct PEStats
+{
+    uint32_t    decisions;        //Number of requests checked
+    uint32_t    cacheHits;        //Requests decided from the decision cache
+    uint64_t    totalLatencyUs;   //Time spent deciding, in microseconds
+    uint64_t    maxLatencyUs;     //Longest decision, in microseconds
+} PEStats_t;
+
+
 typedef struct PEContext
 {
     PEState_t   state;
@@ -51,6 +61,8 @@ typedef struct PEContext
     bool        amsProcessing;
     SRMAccessResponse_t retVal;
     AmsMgrContext_t     *amsMgrContext;
+    PEDecisionCache_t   *decisionCache;  //Recent decisions, reset on ACL changes
+    PEStats_t           stats;
 } PEContext_t;
 
 /**
@@ -87,6 +99,15 @@ OCStackResult InitPolicyEngine(PEContext_t *context);
  */
 void DeInitPolicyEngine(PEContext_t *context);
 
+/**
+ * Get the decision statistics of a Policy Engine context.
+ *
+ * @param   context     Pointer to Policy Engine context.
+ * @param   stats       Filled with the number of decisions, cache hits and latency.
+ * @return  none
+ */
+void GetPolicyEngineStats(const PEContext_t *context, PEStats_t *stats);
+
 /**
  * Return the uint16_t CRUDN permission corresponding to passed CAMethod_t.
  */
@@ -21,6 +21,10 @@
 #ifndef IOTVT_SRM_PSI_H
 #define IOTVT_SRM_PSI_H
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /**
  * Reads the Secure Virtual Database from PS into dynamically allocated
  * memory buffer.
@@ -34,7 +38,9 @@ char * GetSVRDatabase();
 
 /**
  * This method is used by a entity handlers of SVR's to update
- * SVR database.
+ * SVR database. The change is applied to the in-memory database, which
+ * ProcessSVRDatabase() writes to PS once updates have been quiet for a moment.
+ * Doxm and pstat changes are written before this returns.
  *
  * @param rsrcName string denoting the SVR name ("acl", "cred", "pstat" etc).
  * @param jsonObj JSON object containing the SVR contents.
@@ -43,4 +49,35 @@ char * GetSVRDatabase();
  */
 OCStackResult UpdateSVRDatabase(const char* rsrcName, cJSON* jsonObj);
 
+/**
+ * This method writes the SVR database changes which UpdateSVRDatabase kept
+ * in memory, once they are due. OCProcess calls it.
+ */
+void ProcessSVRDatabase();
+
+/**
+ * This method gets the time until ProcessSVRDatabase has changes to write.
+ *
+ * @retval  milliseconds until then, UINT32_MAX if no change is pending.
+ */
+uint32_t GetSVRDatabaseFlushTimeout();
+
+/**
+ * This method writes SVR database changes which UpdateSVRDatabase kept
+ * in memory so far, without waiting until they are due.
+ *
+ * @retval  OC_STACK_OK for Success, otherwise some error value
+ */
+OCStackResult FlushSVRDatabase();
+
+/**
+ * This method writes pending SVR database changes and releases the in-memory
+ * SVR database. The next access reads the database from PS again.
+ */
+void DeInitSVRDatabase();
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif //IOTVT_SRM_PSI_H
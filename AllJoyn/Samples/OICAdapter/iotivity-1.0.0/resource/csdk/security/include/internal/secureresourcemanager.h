@@ -43,6 +43,21 @@ OCStackResult SRMRegisterPersistentStorageHandler(OCPersistentStorage* persisten
  */
 OCPersistentStorage* SRMGetPersistentStorageHandler();
 
+/**
+ * @brief   Register the optional Persistent storage rename callback.
+ * @param   renameHandler [IN] Pointer to the rename handler, NULL to write in place.
+ * @return
+ *     OC_STACK_OK    - No errors; Success
+ */
+OCStackResult SRMRegisterPersistentStorageRenameHandler(OCPersistentStorageRename renameHandler);
+
+/**
+ * @brief   Get Persistent storage rename handler.
+ * @return
+ *     The rename handler, NULL if none is registered
+ */
+OCPersistentStorageRename SRMGetPersistentStorageRenameHandler();
+
 /**
  * @brief   Register request and response callbacks.
  *          Requests and responses are delivered in these callbacks.
@@ -69,6 +84,18 @@ OCStackResult SRMInitSecureResources();
  */
 void SRMDeInitSecureResources();
 
+/**
+ * @brief   Write the secure resource changes that are due to persistent storage.
+ * @return  none
+ */
+void SRMProcess();
+
+/**
+ * @brief   Get the time until SRMProcess has secure resource changes to write.
+ * @return  milliseconds until then, UINT32_MAX if no change is pending.
+ */
+uint32_t SRMGetProcessTimeout();
+
 /**
  * @brief   Initialize Policy Engine context.
  * @return  OC_STACK_OK for Success, otherwise some error value.
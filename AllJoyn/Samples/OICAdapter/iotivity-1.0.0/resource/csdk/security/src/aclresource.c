@@ -24,6 +24,7 @@
 #include "logger.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
+#include "oic_hash.h"
 #include "cJSON.h"
 #include "base64.h"
 #include "resourcemanager.h"
@@ -43,9 +44,148 @@
 
 #define TAG  "SRM-ACL"
 
+//Smallest number of buckets of the ACL index
+#define ACL_INDEX_MIN_BUCKETS 64
+
 OicSecAcl_t               *gAcl = NULL;
 static OCResourceHandle    gAclHandle = NULL;
 
+/**
+ * Entry of the ACL index. There is one entry per subject with a NULL uri, and
+ * one per subject and resource URI pointing to the first ACE granting it.
+ */
+typedef struct AclIndexEntry
+{
+    OicUuid_t               subject;
+    const char              *uri;       // points into the ACE, NULL marks the subject
+    const OicSecAcl_t       *ace;
+    size_t                  position;   // position of the ACE in gAcl
+    OICHashLink_t           link;
+} AclIndexEntry_t;
+
+/**
+ * Hash index of gAcl by subject and resource URI. It is rebuilt on the first
+ * lookup after the ACL changed.
+ */
+typedef struct
+{
+    OICHashTable_t          table;
+    AclIndexEntry_t         *entries;
+    const OicSecAcl_t       *head;      // gAcl the index was built from
+    uint32_t                version;    // gAclVersion the index was built from
+    bool                    valid;
+} AclIndex_t;
+
+static AclIndex_t          gAclIndex;
+static uint32_t            gAclVersion = 1;
+
+/**
+ * Marks the ACL as changed. Called after every modification of gAcl.
+ */
+static void ACLChanged()
+{
+    gAclVersion++;
+}
+
+static void FreeACLIndex()
+{
+    OICHashTableClear(&gAclIndex.table);
+    OICFree(gAclIndex.entries);
+    memset(&gAclIndex, 0, sizeof(gAclIndex));
+}
+
+static uint32_t HashACLIndexKey(const OicUuid_t *subject, const char *uri)
+{
+    uint32_t hash = OICHashBytes(subject->id, sizeof(subject->id));
+    return uri ? OICHashAppend(hash, uri, strlen(uri)) : hash;
+}
+
+static AclIndexEntry_t *FindACLIndexEntry(const OicUuid_t *subject, const char *uri)
+{
+    for (OICHashLink_t *link = OICHashTableFind(&gAclIndex.table, HashACLIndexKey(subject, uri));
+         link; link = OICHashTableFindNext(link))
+    {
+        AclIndexEntry_t *entry = OIC_HASH_ENTRY(link, AclIndexEntry_t, link);
+        if (0 == memcmp(&entry->subject, subject, sizeof(OicUuid_t)) &&
+            (entry->uri == uri || (entry->uri && uri && 0 == strcmp(entry->uri, uri))))
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void AddACLIndexEntry(AclIndexEntry_t *entry, const OicSecAcl_t *ace,
+                             size_t position, const char *uri)
+{
+    // An earlier ACE for the same subject and URI decides, later ones are never used
+    if (FindACLIndexEntry(&ace->subject, uri))
+    {
+        return;
+    }
+
+    memcpy(&entry->subject, &ace->subject, sizeof(OicUuid_t));
+    entry->uri = uri;
+    entry->ace = ace;
+    entry->position = position;
+
+    OICHashTableInsert(&gAclIndex.table, &entry->link, HashACLIndexKey(&ace->subject, uri));
+}
+
+/**
+ * Builds the ACL index unless it is up to date.
+ *
+ * @retval  true if the index can be used, false if it could not be built.
+ */
+static bool UpdateACLIndex()
+{
+    if (gAclIndex.valid && gAclIndex.version == gAclVersion && gAclIndex.head == gAcl)
+    {
+        return true;
+    }
+    FreeACLIndex();
+
+    size_t entryCount = 0;
+    const OicSecAcl_t *acl = NULL;
+    LL_FOREACH(gAcl, acl)
+    {
+        entryCount += 1 + acl->resourcesLen;
+    }
+
+    bool reserved = OICHashTableReserve(&gAclIndex.table,
+                                        entryCount > ACL_INDEX_MIN_BUCKETS ?
+                                        entryCount : ACL_INDEX_MIN_BUCKETS);
+    gAclIndex.entries = (AclIndexEntry_t*)OICCalloc(entryCount ? entryCount : 1,
+                                                    sizeof(AclIndexEntry_t));
+    if (!reserved || !gAclIndex.entries)
+    {
+        OC_LOG(ERROR, TAG, "Unable to allocate ACL index");
+        FreeACLIndex();
+        return false;
+    }
+
+    size_t used = 0;
+    size_t position = 0;
+    LL_FOREACH(gAcl, acl)
+    {
+        AddACLIndexEntry(&gAclIndex.entries[used++], acl, position, NULL);
+        for (size_t n = 0; n < acl->resourcesLen; n++)
+        {
+            if (acl->resources[n])
+            {
+                AddACLIndexEntry(&gAclIndex.entries[used++], acl, position, acl->resources[n]);
+            }
+        }
+        position++;
+    }
+
+    gAclIndex.head = gAcl;
+    gAclIndex.version = gAclVersion;
+    gAclIndex.valid = true;
+    OC_LOG_V(DEBUG, TAG, "Indexed %u ACEs", (unsigned int)position);
+    return true;
+}
+
 /**
  * This function frees OicSecAcl_t object's fields and object itself.
  */
@@ -234,7 +374,7 @@ OicSecAcl_t * JSONToAclBin(const char * jsonStr)
 
     VERIFY_NON_NULL(TAG, jsonStr, ERROR);
 
-    jsonRoot = cJSON_Parse(jsonStr);
+    jsonRoot = cJSON_ParseArena(jsonStr);
     VERIFY_NON_NULL(TAG, jsonRoot, ERROR);
 
     jsonAclArray = cJSON_GetObjectItem(jsonRoot, OIC_JSON_ACL_NAME);
@@ -243,12 +383,11 @@ OicSecAcl_t * JSONToAclBin(const char * jsonStr)
     if (cJSON_Array == jsonAclArray->type)
     {
         int numAcl = cJSON_GetArraySize(jsonAclArray);
-        int idx = 0;
+        cJSON *jsonAcl = jsonAclArray->child;
 
         VERIFY_SUCCESS(TAG, numAcl > 0, INFO);
         do
         {
-            cJSON *jsonAcl = cJSON_GetArrayItem(jsonAclArray, idx);
             VERIFY_NON_NULL(TAG, jsonAcl, ERROR);
 
             OicSecAcl_t *acl = (OicSecAcl_t*)OICCalloc(1, sizeof(OicSecAcl_t));
@@ -390,13 +529,14 @@ OicSecAcl_t * JSONToAclBin(const char * jsonStr)
             } while ( ++idxx < acl->ownersLen);
 
             prevAcl = acl;
-        } while( ++idx < numAcl);
+            jsonAcl = jsonAcl->next;
+        } while (jsonAcl);
     }
 
     ret = OC_STACK_OK;
 
 exit:
-    cJSON_Delete(jsonRoot);
+    cJSON_DeleteArena(jsonRoot);
     if (OC_STACK_OK != ret)
     {
         DeleteACLList(headAcl);
@@ -511,6 +651,7 @@ static OCStackResult RemoveACE(const OicUuid_t * subject,
 
     if(deleteFlag)
     {
+        ACLChanged();
         if(UpdatePersistentStorage(gAcl))
         {
             ret = OC_STACK_RESOURCE_DELETED;
@@ -674,6 +815,7 @@ static OCEntityHandlerResult HandleACLPostRequest (const OCEntityHandlerRequest
     {
         // Append the new ACL to existing ACL
         LL_APPEND(gAcl, newAcl);
+        ACLChanged();
 
         if(UpdatePersistentStorage(gAcl))
         {
@@ -899,6 +1041,7 @@ OCStackResult InitACLResource()
         // TODO Needs to update persistent storage
     }
     VERIFY_NON_NULL(TAG, gAcl, FATAL);
+    ACLChanged();
 
     // Instantiate 'oic.sec.acl'
     ret = CreateACLResource();
@@ -923,6 +1066,8 @@ void DeInitACLResource()
 
     DeleteACLList(gAcl);
     gAcl = NULL;
+    ACLChanged();
+    FreeACLIndex();
 }
 
 /**
@@ -985,6 +1130,72 @@ const OicSecAcl_t* GetACLResourceData(const OicUuid_t* subjectId, OicSecAcl_t **
     return NULL;
 }
 
+/**
+ * This method is used by PolicyEngine to find the ACE deciding a request.
+ *
+ * @param subjectId ID of the requesting subject.
+ * @param resource URI of the requested resource.
+ * @param subjectFound set to true if the ACL has any ACE for subjectId.
+ *
+ * @retval  the first ACE for subjectId containing resource or the wildcard resource,
+ *          NULL if there is none.
+ */
+const OicSecAcl_t* FindACE(const OicUuid_t* subjectId, const char* resource, bool* subjectFound)
+{
+    if (NULL == subjectId || NULL == resource || NULL == subjectFound)
+    {
+        return NULL;
+    }
+    *subjectFound = false;
+
+    if (!UpdateACLIndex())
+    {
+        // Same result from a scan of the list
+        const OicSecAcl_t *acl = NULL;
+        LL_FOREACH(gAcl, acl)
+        {
+            if (0 == memcmp(&acl->subject, subjectId, sizeof(OicUuid_t)))
+            {
+                *subjectFound = true;
+                for (size_t n = 0; n < acl->resourcesLen; n++)
+                {
+                    if (0 == strcmp(resource, acl->resources[n]) ||
+                        0 == strcmp(WILDCARD_RESOURCE_URI, acl->resources[n]))
+                    {
+                        return acl;
+                    }
+                }
+            }
+        }
+        return NULL;
+    }
+
+    if (!FindACLIndexEntry(subjectId, NULL))
+    {
+        return NULL;
+    }
+    *subjectFound = true;
+
+    // Whichever of the exact and the wildcard match comes first in the ACL decides
+    const AclIndexEntry_t *exact = FindACLIndexEntry(subjectId, resource);
+    const AclIndexEntry_t *wildcard = FindACLIndexEntry(subjectId, WILDCARD_RESOURCE_URI);
+    if (exact && (!wildcard || exact->position <= wildcard->position))
+    {
+        return exact->ace;
+    }
+    return wildcard ? wildcard->ace : NULL;
+}
+
+/**
+ * Version of the ACL. It changes whenever the ACL is modified, so results derived
+ * from the ACL can be invalidated.
+ *
+ * @retval  current ACL version.
+ */
+uint32_t GetACLVersion()
+{
+    return gAclVersion;
+}
 
 OCStackResult InstallNewACL(const char* newJsonStr)
 {
@@ -997,6 +1208,7 @@ OCStackResult InstallNewACL(const char* newJsonStr)
     {
         // Append the new ACL to existing ACL
         LL_APPEND(gAcl, newAcl);
+        ACLChanged();
 
         // Convert ACL data into JSON for update to persistent storage
         char *jsonStr = BinToAclJSON(gAcl);
@@ -172,7 +172,7 @@ OicSecAmacl_t * JSONToAmaclBin(const char * jsonStr)
 
     VERIFY_NON_NULL(TAG, jsonStr, ERROR);
 
-    jsonRoot = cJSON_Parse(jsonStr);
+    jsonRoot = cJSON_ParseArena(jsonStr);
     VERIFY_NON_NULL(TAG, jsonRoot, ERROR);
 
     jsonAmaclArray = cJSON_GetObjectItem(jsonRoot, OIC_JSON_AMACL_NAME);
@@ -181,12 +181,11 @@ OicSecAmacl_t * JSONToAmaclBin(const char * jsonStr)
     if (cJSON_Array == jsonAmaclArray->type)
     {
         int numAmacl = cJSON_GetArraySize(jsonAmaclArray);
-        int idx = 0;
+        cJSON *jsonAmacl = jsonAmaclArray->child;
 
         VERIFY_SUCCESS(TAG, numAmacl > 0, INFO);
         do
         {
-            cJSON *jsonAmacl = cJSON_GetArrayItem(jsonAmaclArray, idx);
             VERIFY_NON_NULL(TAG, jsonAmacl, ERROR);
 
             OicSecAmacl_t *amacl = (OicSecAmacl_t*)OICCalloc(1, sizeof(OicSecAmacl_t));
@@ -232,13 +231,14 @@ OicSecAmacl_t * JSONToAmaclBin(const char * jsonStr)
                                &(amacl->ownersLen), &(amacl->owners)), ERROR);
 
             prevAmacl = amacl;
-        } while( ++idx < numAmacl);
+            jsonAmacl = jsonAmacl->next;
+        } while (jsonAmacl);
     }
 
     ret = OC_STACK_OK;
 
 exit:
-    cJSON_Delete(jsonRoot);
+    cJSON_DeleteArena(jsonRoot);
     if (OC_STACK_OK != ret)
     {
         DeleteAmaclList(headAmacl);
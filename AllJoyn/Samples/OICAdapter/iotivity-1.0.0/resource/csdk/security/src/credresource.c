@@ -241,7 +241,7 @@ OicSecCred_t * JSONToCredBin(const char * jsonStr)
     OicSecCred_t * prevCred = NULL;
     cJSON *jsonCredArray = NULL;
 
-    cJSON *jsonRoot = cJSON_Parse(jsonStr);
+    cJSON *jsonRoot = cJSON_ParseArena(jsonStr);
     VERIFY_NON_NULL(TAG, jsonRoot, ERROR);
 
     jsonCredArray = cJSON_GetObjectItem(jsonRoot, OIC_JSON_CRED_NAME);
@@ -249,7 +249,7 @@ OicSecCred_t * JSONToCredBin(const char * jsonStr)
     if (cJSON_Array == jsonCredArray->type)
     {
         int numCred = cJSON_GetArraySize(jsonCredArray);
-        int idx = 0;
+        cJSON *jsonCred = jsonCredArray->child;
 
         unsigned char base64Buff[sizeof(((OicUuid_t*)0)->id)] = {0};
         uint32_t outLen = 0;
@@ -258,7 +258,6 @@ OicSecCred_t * JSONToCredBin(const char * jsonStr)
         VERIFY_SUCCESS(TAG, numCred > 0, ERROR);
         do
         {
-            cJSON *jsonCred = cJSON_GetArrayItem(jsonCredArray, idx);
             VERIFY_NON_NULL(TAG, jsonCred, ERROR);
 
             OicSecCred_t *cred = (OicSecCred_t*)OICCalloc(1, sizeof(OicSecCred_t));
@@ -391,13 +390,14 @@ OicSecCred_t * JSONToCredBin(const char * jsonStr)
                 memcpy(cred->owners[i].id, base64Buff, outLen);
             }
             prevCred = cred;
-        } while( ++idx < numCred);
+            jsonCred = jsonCred->next;
+        } while (jsonCred);
     }
 
     ret = OC_STACK_OK;
 
 exit:
-    cJSON_Delete(jsonRoot);
+    cJSON_DeleteArena(jsonRoot);
     if (OC_STACK_OK != ret)
     {
         DeleteCredList(headCred);
@@ -1085,7 +1085,7 @@ static OCStackResult GetCertCredPublicData(CADtlsX509Creds_t *credInfo, OicSecCr
     VERIFY_NON_NULL(TAG, cred, ERROR);
     VERIFY_NON_NULL(TAG, cred->publicData.data, ERROR);
     //VERIFY_SUCCESS(TAG, NULL == credInfo->certificateChain.data, ERROR);
-    cJSON *jsonRoot = cJSON_Parse(cred->publicData.data);
+    cJSON *jsonRoot = cJSON_ParseArena(cred->publicData.data);
     VERIFY_NON_NULL(TAG, jsonRoot, ERROR);
 
     //Get certificate chain
@@ -1110,7 +1110,7 @@ static OCStackResult GetCertCredPublicData(CADtlsX509Creds_t *credInfo, OicSecCr
     VERIFY_SUCCESS(TAG, OC_STACK_OK == GetCAPublicKeyData(credInfo), ERROR);
     ret = OC_STACK_OK;
 exit:
-    cJSON_Delete(jsonRoot);
+    cJSON_DeleteArena(jsonRoot);
     return ret;
 }
 
@@ -1120,7 +1120,7 @@ static OCStackResult GetCertCredPrivateData(CADtlsX509Creds_t *credInfo, OicSecC
     VERIFY_NON_NULL(TAG, credInfo, ERROR);
     VERIFY_NON_NULL(TAG, cred, ERROR);
     VERIFY_NON_NULL(TAG, cred->privateData.data, ERROR);
-    cJSON *jsonRoot = cJSON_Parse(cred->privateData.data);
+    cJSON *jsonRoot = cJSON_ParseArena(cred->privateData.data);
     VERIFY_NON_NULL(TAG, jsonRoot, ERROR);
 
     cJSON *jsonObj = cJSON_GetObjectItem(jsonRoot, PRIVATE_KEY);//TODO define field names constants
@@ -1134,7 +1134,7 @@ static OCStackResult GetCertCredPrivateData(CADtlsX509Creds_t *credInfo, OicSecC
     ret = OC_STACK_OK;
 
 exit:
-    cJSON_Delete(jsonRoot);
+    cJSON_DeleteArena(jsonRoot);
     return ret;
 }
 
@@ -186,7 +186,7 @@ OicSecDoxm_t * JSONToDoxmBin(const char * jsonStr)
     uint32_t outLen = 0;
     B64Result b64Ret = B64_OK;
 
-    cJSON *jsonRoot = cJSON_Parse(jsonStr);
+    cJSON *jsonRoot = cJSON_ParseArena(jsonStr);
     VERIFY_NON_NULL(TAG, jsonRoot, ERROR);
 
     jsonDoxm = cJSON_GetObjectItem(jsonRoot, OIC_JSON_DOXM_NAME);
@@ -318,7 +318,7 @@ OicSecDoxm_t * JSONToDoxmBin(const char * jsonStr)
     ret = OC_STACK_OK;
 
 exit:
-    cJSON_Delete(jsonRoot);
+    cJSON_DeleteArena(jsonRoot);
     if (OC_STACK_OK != ret)
     {
         DeleteDoxmBinData(doxm);
@@ -29,10 +29,40 @@
 #include "srmutility.h"
 #include "doxmresource.h"
 #include "iotvticalendar.h"
+#include "caretransmission.h"
 #include <string.h>
 
 #define TAG "SRM-PE"
 
+//Number of recent decisions remembered by a Policy Engine context
+#define PE_DECISION_CACHE_SIZE 32
+
+/**
+ * Outcome of checking a request against the local ACL, including the fallback
+ * to the wildcard subject.
+ */
+typedef struct PEDecision
+{
+    OicUuid_t           subject;
+    char                resource[MAX_URI_LENGTH];
+    uint16_t            permission;
+    SRMAccessResponse_t retVal;
+    bool                matchingAclFound;
+    bool                wildcardChecked;
+    uint32_t            lastUsed;       // 0 for a free slot
+} PEDecision_t;
+
+/**
+ * Least recently used decisions. All entries belong to one ACL version; they are
+ * dropped when the ACL changes.
+ */
+struct PEDecisionCache
+{
+    uint32_t        aclVersion;
+    uint32_t        clock;
+    PEDecision_t    entries[PE_DECISION_CACHE_SIZE];
+};
+
 /**
  * Return the uint16_t CRUDN permission corresponding to passed CAMethod_t.
  */
@@ -276,6 +306,59 @@ static bool IsAccessWithinValidTime(const OicSecAcl_t *acl)
 }
 
 
+/**
+ * Find the first ACL containing context->subject and the requested resource.
+ * If found, check for context->permission and period validity.
+ * Set context->retVal to result from first ACL found which contains
+ * correct subject AND resource.
+ *
+ * @param context       Policy Engine context of the request.
+ * @param timeDependent set to true if the result depends on the time of the request.
+ *
+ * @retval void
+ */
+static void ProcessAccessRequestAt(PEContext_t *context, bool *timeDependent)
+{
+    bool subjectFound = false;
+    const OicSecAcl_t *currentAcl = FindACE(&context->subject, context->resource,
+                                            &subjectFound);
+
+    // Start out assuming subject not found.
+    context->retVal = ACCESS_DENIED_SUBJECT_NOT_FOUND;
+
+    if(subjectFound)
+    {
+        // Subject was found, so err changes to Rsrc not found for now.
+        OC_LOG_V(DEBUG, TAG, "%s:found ACL matching subject" ,__func__);
+        context->retVal = ACCESS_DENIED_RESOURCE_NOT_FOUND;
+    }
+    else
+    {
+        OC_LOG_V(INFO, TAG, "%s:no ACL found matching subject for resource %s",__func__, context->resource);
+    }
+
+    if(NULL != currentAcl)
+    {
+        OC_LOG_V(INFO, TAG, "%s:found matching resource in ACL" ,__func__);
+        context->matchingAclFound = true;
+
+        // Found the resource, so it's down to valid period & permission.
+        if(NULL != currentAcl->periods && 0 != currentAcl->prdRecrLen)
+        {
+            *timeDependent = true;
+        }
+        context->retVal = ACCESS_DENIED_INVALID_PERIOD;
+        if(IsAccessWithinValidTime(currentAcl))
+        {
+            context->retVal = ACCESS_DENIED_INSUFFICIENT_PERMISSION;
+            if(IsPermissionAllowingRequest(currentAcl->permission, context->permission))
+            {
+                context->retVal = ACCESS_GRANTED;
+            }
+        }
+    }
+}
+
 /**
  * Find ACLs containing context->subject.
  * Search each ACL for requested resource.
@@ -292,50 +375,8 @@ void ProcessAccessRequest(PEContext_t *context)
     OC_LOG(DEBUG, TAG, "Entering ProcessAccessRequest()");
     if(NULL != context)
     {
-        const OicSecAcl_t *currentAcl = NULL;
-        OicSecAcl_t *savePtr = NULL;
-
-        // Start out assuming subject not found.
-        context->retVal = ACCESS_DENIED_SUBJECT_NOT_FOUND;
-
-        // Loop through all ACLs with a matching Subject searching for the right
-        // ACL for this request.
-        do
-        {
-            OC_LOG_V(DEBUG, TAG, "%s: getting ACL..." ,__func__);
-            currentAcl = GetACLResourceData(&context->subject, &savePtr);
-
-            if(NULL != currentAcl)
-            {
-                // Found the subject, so how about resource?
-                OC_LOG_V(DEBUG, TAG, "%s:found ACL matching subject" ,__func__);
-
-                // Subject was found, so err changes to Rsrc not found for now.
-                context->retVal = ACCESS_DENIED_RESOURCE_NOT_FOUND;
-                OC_LOG_V(DEBUG, TAG, "%s:Searching for resource..." ,__func__);
-                if(IsResourceInAcl(context->resource, currentAcl))
-                {
-                    OC_LOG_V(INFO, TAG, "%s:found matching resource in ACL" ,__func__);
-                    context->matchingAclFound = true;
-
-                    // Found the resource, so it's down to valid period & permission.
-                    context->retVal = ACCESS_DENIED_INVALID_PERIOD;
-                    if(IsAccessWithinValidTime(currentAcl))
-                    {
-                        context->retVal = ACCESS_DENIED_INSUFFICIENT_PERMISSION;
-                        if(IsPermissionAllowingRequest(currentAcl->permission, context->permission))
-                        {
-                            context->retVal = ACCESS_GRANTED;
-                        }
-                    }
-                }
-            }
-            else
-            {
-                OC_LOG_V(INFO, TAG, "%s:no ACL found matching subject for resource %s",__func__, context->resource);
-            }
-        }
-        while((NULL != currentAcl) && (false == context->matchingAclFound));
+        bool timeDependent = false;
+        ProcessAccessRequestAt(context, &timeDependent);
 
         if(IsAccessGranted(context->retVal))
         {
@@ -352,6 +393,78 @@ void ProcessAccessRequest(PEContext_t *context)
     }
 }
 
+/**
+ * Look up the decision for the request in context in the decision cache.
+ * On a hit context->retVal and context->matchingAclFound are set.
+ *
+ * @param context           Policy Engine context of the request.
+ * @param wildcardChecked   set to whether the wildcard subject was checked.
+ *
+ * @return true if the decision was cached, else false.
+ */
+static bool FindCachedDecision(PEContext_t *context, bool *wildcardChecked)
+{
+    PEDecisionCache_t *cache = context->decisionCache;
+    if(NULL == cache)
+    {
+        return false;
+    }
+
+    if(cache->aclVersion != GetACLVersion())
+    {
+        memset(cache->entries, 0, sizeof(cache->entries));
+        cache->aclVersion = GetACLVersion();
+        return false;
+    }
+
+    for(size_t i = 0; i < PE_DECISION_CACHE_SIZE; i++)
+    {
+        PEDecision_t *decision = &cache->entries[i];
+        if(0 != decision->lastUsed &&
+           decision->permission == context->permission &&
+           0 == memcmp(&decision->subject, &context->subject, sizeof(OicUuid_t)) &&
+           0 == strcmp(decision->resource, context->resource))
+        {
+            decision->lastUsed = ++cache->clock;
+            context->retVal = decision->retVal;
+            context->matchingAclFound = decision->matchingAclFound;
+            *wildcardChecked = decision->wildcardChecked;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Remember the decision for the request in context, replacing the least
+ * recently used one.
+ */
+static void CacheDecision(PEContext_t *context, const OicUuid_t *subject, bool wildcardChecked)
+{
+    PEDecisionCache_t *cache = context->decisionCache;
+    if(NULL == cache)
+    {
+        return;
+    }
+
+    PEDecision_t *victim = &cache->entries[0];
+    for(size_t i = 1; i < PE_DECISION_CACHE_SIZE && 0 != victim->lastUsed; i++)
+    {
+        if(cache->entries[i].lastUsed < victim->lastUsed)
+        {
+            victim = &cache->entries[i];
+        }
+    }
+
+    memcpy(&victim->subject, subject, sizeof(OicUuid_t));
+    memcpy(victim->resource, context->resource, sizeof(victim->resource));
+    victim->permission = context->permission;
+    victim->retVal = context->retVal;
+    victim->matchingAclFound = context->matchingAclFound;
+    victim->wildcardChecked = wildcardChecked;
+    victim->lastUsed = ++cache->clock;
+}
+
 /**
  * Check whether a request should be allowed.
  * @param   context     Pointer to (Initialized) Policy Engine context to use.
@@ -368,6 +481,8 @@ SRMAccessResponse_t CheckPermission(
     const uint16_t  requestedPermission)
 {
     SRMAccessResponse_t retVal = ACCESS_DENIED_POLICY_ENGINE_ERROR;
+    uint64_t startTime = getCurrentTimeInMicroSeconds();
+    uint64_t latency = 0;
 
     VERIFY_NON_NULL(TAG, context, ERROR);
     VERIFY_NON_NULL(TAG, subjectId, ERROR);
@@ -393,13 +508,27 @@ SRMAccessResponse_t CheckPermission(
         else
         {
             OicUuid_t saveSubject = {.id={0}};
+            OicUuid_t requestSubject;
             bool isSubEmpty = IsRequestSubjectEmpty(context);
+            bool wildcardChecked = false;
+            bool timeDependent = false;
 
-            ProcessAccessRequest(context);
+            memcpy(&requestSubject, &context->subject, sizeof(OicUuid_t));
+            bool cached = FindCachedDecision(context, &wildcardChecked);
+            if(cached)
+            {
+                context->stats.cacheHits++;
+            }
+            else
+            {
+                ProcessAccessRequestAt(context, &timeDependent);
+
+                // If matching ACL not found, and subject != wildcard, try wildcard.
+                wildcardChecked = (false == context->matchingAclFound) &&
+                                  (false == IsWildCardSubject(&context->subject));
+            }
 
-            // If matching ACL not found, and subject != wildcard, try wildcard.
-            if((false == context->matchingAclFound) && \
-              (false == IsWildCardSubject(&context->subject)))
+            if(wildcardChecked)
             {
                 //Saving subject for Amacl check
                 memcpy(&saveSubject, &context->subject,sizeof(OicUuid_t));
@@ -410,8 +539,18 @@ SRMAccessResponse_t CheckPermission(
                 //subject is not tempered.
                 memset(&context->subject, 0, sizeof(context->subject));
                 memcpy(&context->subject, &WILDCARD_SUBJECT_ID,sizeof(OicUuid_t));
-                ProcessAccessRequest(context); // TODO anonymous subj can result
-                                               // in confusing err code return.
+                if(!cached)
+                {
+                    ProcessAccessRequestAt(context, &timeDependent); // TODO anonymous subj can
+                                                                     // result in confusing err
+                                                                     // code return.
+                }
+            }
+
+            // Decisions of ACEs with a validity period change over time
+            if(!cached && !timeDependent)
+            {
+                CacheDecision(context, &requestSubject, wildcardChecked);
             }
 
             //No local ACE found for the request so checking Amacl resource
@@ -455,10 +594,30 @@ SRMAccessResponse_t CheckPermission(
         SetPolicyEngineState(context, AWAITING_REQUEST);
     }
 
+    latency = getCurrentTimeInMicroSeconds() - startTime;
+    context->stats.decisions++;
+    context->stats.totalLatencyUs += latency;
+    if(latency > context->stats.maxLatencyUs)
+    {
+        context->stats.maxLatencyUs = latency;
+    }
+    OC_LOG_V(DEBUG, TAG, "Permission decided in %u us", (unsigned int)latency);
+
 exit:
     return retVal;
 }
 
+/**
+ * Get the decision statistics of a Policy Engine context.
+ */
+void GetPolicyEngineStats(const PEContext_t *context, PEStats_t *stats)
+{
+    if(NULL != context && NULL != stats)
+    {
+        *stats = context->stats;
+    }
+}
+
 /**
  * Initialize the Policy Engine. Call this before calling CheckPermission().
  * @param   context     Pointer to Policy Engine context to initialize.
@@ -472,6 +631,9 @@ OCStackResult InitPolicyEngine(PEContext_t *context)
     }
 
     context->amsMgrContext = (AmsMgrContext_t *)OICMalloc(sizeof(AmsMgrContext_t));
+    // Without a cache every request is checked against the ACL
+    context->decisionCache = (PEDecisionCache_t *)OICCalloc(1, sizeof(PEDecisionCache_t));
+    memset(&context->stats, 0, sizeof(context->stats));
     SetPolicyEngineState(context, AWAITING_REQUEST);
 
     return OC_STACK_OK;
@@ -489,6 +651,8 @@ void DeInitPolicyEngine(PEContext_t *context)
     {
         SetPolicyEngineState(context, STOPPED);
         OICFree(context->amsMgrContext);
+        OICFree(context->decisionCache);
+        context->decisionCache = NULL;
     }
     return;
 }
@@ -27,6 +27,7 @@
 #include "resourcemanager.h"
 #include "srmresourcestrings.h"
 #include "srmutility.h"
+#include "caretransmission.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -35,6 +36,31 @@
 //SVR database buffer block size
 #define DB_FILE_SIZE_BLOCK 1023
 
+//Suffix of the file written before it replaces the SVR database
+#define SVR_DB_TEMP_SUFFIX ".tmp"
+
+//Time pending updates wait for more updates before they are written
+#define SVR_DB_FLUSH_DELAY_USEC (100 * 1000)
+
+//Time the oldest pending update waits at most while updates keep coming
+#define SVR_DB_FLUSH_MAX_DELAY_USEC (1000 * 1000)
+
+/**
+ * Parsed SVR database shared by all SVRs. Updates change the tree in memory,
+ * OCProcess writes the whole document once they have been quiet for a moment.
+ */
+typedef struct
+{
+    cJSON *db;                  /**< Parsed database, NULL until first used. */
+    OCPersistentStorage ps;     /**< Handlers the database was read with. */
+    OCPersistentStorageRename renameHandler; /**< Rename handler then, may be NULL. */
+    uint32_t dirty;             /**< Number of updates not written yet. */
+    uint64_t firstDirtyTime;    /**< Time of the oldest update not written yet. */
+    uint64_t lastDirtyTime;     /**< Time of the newest update not written yet. */
+} SVRDatabase_t;
+
+static SVRDatabase_t g_svrDb;
+
 /**
  * Gets the Secure Virtual Database size.
  *
@@ -65,19 +91,17 @@ size_t GetSVRDatabaseSize(OCPersistentStorage* ps)
 }
 
 /**
- * Reads the Secure Virtual Database from PS into dynamically allocated
+ * Reads the Secure Virtual Database file from PS into dynamically allocated
  * memory buffer.
  *
- * @note Caller of this method MUST use OICFree() method to release memory
- *       referenced by return value.
+ * @param ps  persistent storage handlers to read with.
  *
  * @retval  reference to memory buffer containing SVR database.
  */
-char * GetSVRDatabase()
+static char * ReadSVRDatabase(OCPersistentStorage* ps)
 {
     char * jsonStr = NULL;
     FILE * fp = NULL;
-    OCPersistentStorage* ps = SRMGetPersistentStorageHandler();
     int size = GetSVRDatabaseSize(ps);
     if (0 == size)
     {
@@ -115,6 +139,170 @@ exit:
 }
 
 
+/**
+ * Parses the SVR database file into g_svrDb unless it is loaded already.
+ *
+ * @retval  OC_STACK_OK for Success, otherwise some error value
+ */
+static OCStackResult LoadSVRDatabase()
+{
+    if (g_svrDb.db)
+    {
+        return OC_STACK_OK;
+    }
+
+    OCPersistentStorage* ps = SRMGetPersistentStorageHandler();
+    VERIFY_NON_NULL(TAG, ps, ERROR);
+
+    char* jsonSVRDbStr = ReadSVRDatabase(ps);
+    VERIFY_NON_NULL(TAG, jsonSVRDbStr, ERROR);
+
+    g_svrDb.db = cJSON_Parse(jsonSVRDbStr);
+    OICFree(jsonSVRDbStr);
+    VERIFY_NON_NULL(TAG, g_svrDb.db, ERROR);
+
+    // Keep a copy, the handlers are written back with even if the app changes them
+    g_svrDb.ps = *ps;
+    g_svrDb.renameHandler = SRMGetPersistentStorageRenameHandler();
+    g_svrDb.dirty = 0;
+    return OC_STACK_OK;
+
+exit:
+    return OC_STACK_ERROR;
+}
+
+/**
+ * Writes the SVR database string through the persistent storage handlers.
+ * If the app provides a rename handler the data is written to a temporary file
+ * which then replaces the database, so a crash can't leave a truncated file.
+ *
+ * @retval  OC_STACK_OK for Success, otherwise some error value
+ */
+static OCStackResult WriteSVRDatabase(OCPersistentStorage* ps,
+                                      OCPersistentStorageRename renameHandler,
+                                      const char* jsonSVRDbStr)
+{
+    OCStackResult ret = OC_STACK_ERROR;
+    char* tempName = NULL;
+    const char* fileName = SVR_DB_FILE_NAME;
+
+    if (!ps->open || !ps->write || !ps->close)
+    {
+        OC_LOG (ERROR, TAG, "Persistent storage handlers are not set");
+        return OC_STACK_ERROR;
+    }
+
+    if (renameHandler)
+    {
+        size_t tempNameLen = strlen(SVR_DB_FILE_NAME) + sizeof(SVR_DB_TEMP_SUFFIX);
+        tempName = (char*)OICMalloc(tempNameLen);
+        VERIFY_NON_NULL(TAG, tempName, ERROR);
+        snprintf(tempName, tempNameLen, "%s%s", SVR_DB_FILE_NAME, SVR_DB_TEMP_SUFFIX);
+        fileName = tempName;
+    }
+
+    FILE* fp = ps->open(fileName, "w");
+    if (fp)
+    {
+        size_t len = strlen(jsonSVRDbStr);
+        size_t bytesWritten = ps->write(jsonSVRDbStr, 1, len, fp);
+        OC_LOG_V(DEBUG, TAG, "Written %d bytes into SVR database file", bytesWritten);
+        if (0 == ps->close(fp) && bytesWritten == len)
+        {
+            ret = OC_STACK_OK;
+        }
+    }
+    else
+    {
+        OC_LOG (ERROR, TAG, "Unable to open SVR database file!! ");
+    }
+
+    if (tempName)
+    {
+        if (OC_STACK_OK == ret && 0 != renameHandler(tempName, SVR_DB_FILE_NAME))
+        {
+            OC_LOG (ERROR, TAG, "Unable to replace SVR database file!! ");
+            ret = OC_STACK_ERROR;
+        }
+        if (OC_STACK_OK != ret && ps->unlink)
+        {
+            ps->unlink(tempName);
+        }
+    }
+
+exit:
+    OICFree(tempName);
+    return ret;
+}
+
+/**
+ * Writes the in-memory SVR database if it has changes that are not written yet.
+ *
+ * @retval  OC_STACK_OK for Success, otherwise some error value
+ */
+static OCStackResult WriteDirtySVRDatabase()
+{
+    if (!g_svrDb.dirty || !g_svrDb.db)
+    {
+        return OC_STACK_OK;
+    }
+
+    OC_LOG_V(DEBUG, TAG, "Writing SVR database with %u updates", g_svrDb.dirty);
+    OCStackResult ret = OC_STACK_NO_MEMORY;
+    char* jsonSVRDbStr = cJSON_PrintUnformatted(g_svrDb.db);
+    if (jsonSVRDbStr)
+    {
+        ret = WriteSVRDatabase(&g_svrDb.ps, g_svrDb.renameHandler, jsonSVRDbStr);
+        OICFree(jsonSVRDbStr);
+    }
+
+    // On failure the changes stay pending, OCProcess retries after the delay
+    if (OC_STACK_OK == ret)
+    {
+        g_svrDb.dirty = 0;
+    }
+    else
+    {
+        g_svrDb.firstDirtyTime = g_svrDb.lastDirtyTime = getCurrentTimeInMicroSeconds();
+    }
+    return ret;
+}
+
+/**
+ * Gets the time the pending updates are due to be written at.
+ */
+static uint64_t GetSVRDatabaseFlushTime()
+{
+    uint64_t quietTime = g_svrDb.lastDirtyTime + SVR_DB_FLUSH_DELAY_USEC;
+    uint64_t maxTime = g_svrDb.firstDirtyTime + SVR_DB_FLUSH_MAX_DELAY_USEC;
+    return (quietTime < maxTime) ? quietTime : maxTime;
+}
+
+/**
+ * Reads the Secure Virtual Database from PS into dynamically allocated
+ * memory buffer.
+ *
+ * @note Caller of this method MUST use OICFree() method to release memory
+ *       referenced by return value.
+ *
+ * @retval  reference to memory buffer containing SVR database.
+ */
+char * GetSVRDatabase()
+{
+    char * jsonStr = NULL;
+
+    if (g_svrDb.db)
+    {
+        // Includes updates that are not written yet
+        jsonStr = cJSON_PrintUnformatted(g_svrDb.db);
+    }
+    if (!jsonStr)
+    {
+        jsonStr = ReadSVRDatabase(SRMGetPersistentStorageHandler());
+    }
+    return jsonStr;
+}
+
 /**
  * This method is used by a entity handlers of SVR's to update
  * SVR database.
@@ -127,82 +315,124 @@ exit:
 OCStackResult UpdateSVRDatabase(const char* rsrcName, cJSON* jsonObj)
 {
     OCStackResult ret = OC_STACK_ERROR;
-    cJSON *jsonSVRDb = NULL;
-    OCPersistentStorage* ps = NULL;
-
-    // Read SVR database from PS
-    char* jsonSVRDbStr = GetSVRDatabase();
-    VERIFY_NON_NULL(TAG,jsonSVRDbStr, ERROR);
+    cJSON* jsonDuplicateObj = NULL;
 
-    // Use cJSON_Parse to parse the existing SVR database
-    jsonSVRDb = cJSON_Parse(jsonSVRDbStr);
-    VERIFY_NON_NULL(TAG,jsonSVRDb, ERROR);
+    if (jsonObj && jsonObj->child)
+    {
+        jsonDuplicateObj = cJSON_Duplicate(jsonObj, 1);
+        VERIFY_NON_NULL(TAG,jsonDuplicateObj, ERROR);
+    }
 
-    OICFree(jsonSVRDbStr);
-    jsonSVRDbStr = NULL;
+    VERIFY_SUCCESS(TAG, OC_STACK_OK == LoadSVRDatabase(), ERROR);
 
     //If Cred resource gets updated with empty list then delete the Cred
     //object from database.
     if(NULL == jsonObj && (0 == strcmp(rsrcName, OIC_JSON_CRED_NAME)))
     {
-        cJSON_DeleteItemFromObject(jsonSVRDb, rsrcName);
+        cJSON_DeleteItemFromObject(g_svrDb.db, rsrcName);
     }
-    else if (jsonObj->child )
+    else if (jsonDuplicateObj)
     {
-        // Create a duplicate of the JSON object which was passed.
-        cJSON* jsonDuplicateObj = cJSON_Duplicate(jsonObj, 1);
-        VERIFY_NON_NULL(TAG,jsonDuplicateObj, ERROR);
-
-        cJSON* jsonObj = cJSON_GetObjectItem(jsonSVRDb, rsrcName);
+        cJSON* jsonRsrcObj = cJSON_GetObjectItem(g_svrDb.db, rsrcName);
 
         /*
          ACL, PStat & Doxm resources at least have default entries in the database but
          Cred resource may have no entries. The first cred resource entry (for provisioning tool)
          is created when the device is owned by provisioning tool and it's ownerpsk is generated.*/
         if((strcmp(rsrcName, OIC_JSON_CRED_NAME) == 0 || strcmp(rsrcName, OIC_JSON_CRL_NAME) == 0)
-                                                                                    && (!jsonObj))
+                                                                                    && (!jsonRsrcObj))
         {
             // Add the fist cred object in existing SVR database json
-            cJSON_AddItemToObject(jsonSVRDb, rsrcName, jsonDuplicateObj->child);
+            cJSON_AddItemToObject(g_svrDb.db, rsrcName, jsonDuplicateObj->child);
         }
-        else
+        else if (jsonRsrcObj)
         {
-            VERIFY_NON_NULL(TAG,jsonObj, ERROR);
-
             // Replace the modified json object in existing SVR database json
-            cJSON_ReplaceItemInObject(jsonSVRDb, rsrcName, jsonDuplicateObj->child);
+            cJSON_ReplaceItemInObject(g_svrDb.db, rsrcName, jsonDuplicateObj->child);
+        }
+        else
+        {
+            OC_LOG_V(ERROR, TAG, "%s is not in the SVR database", rsrcName);
+            goto exit;
         }
+        // The child now belongs to the database
+        jsonDuplicateObj->child = NULL;
     }
 
-    // Generate string representation of updated SVR database json object
-    jsonSVRDbStr = cJSON_PrintUnformatted(jsonSVRDb);
-    VERIFY_NON_NULL(TAG,jsonSVRDbStr, ERROR);
+    uint64_t now = getCurrentTimeInMicroSeconds();
+    if (0 == g_svrDb.dirty)
+    {
+        g_svrDb.firstDirtyTime = now;
+    }
+    g_svrDb.lastDirtyTime = now;
+    g_svrDb.dirty++;
+    ret = OC_STACK_OK;
 
-    // Update the persistent storage with new SVR database
-    ps = SRMGetPersistentStorageHandler();
-    if (ps && ps->open)
+    // Ownership and provisioning state must survive a crash once the requester
+    // is told about them. Other updates are coalesced and written by OCProcess.
+    if (0 == strcmp(rsrcName, OIC_JSON_DOXM_NAME) || 0 == strcmp(rsrcName, OIC_JSON_PSTAT_NAME))
     {
-        FILE* fp = ps->open(SVR_DB_FILE_NAME, "w");
-        if (fp)
-        {
-            size_t bytesWritten = ps->write(jsonSVRDbStr, 1, strlen(jsonSVRDbStr), fp);
-            if (bytesWritten == strlen(jsonSVRDbStr))
-            {
-                ret = OC_STACK_OK;
-            }
-            OC_LOG_V(DEBUG, TAG, "Written %d bytes into SVR database file", bytesWritten);
-            ps->close(fp);
-            fp = NULL;
-        }
-        else
+        ret = WriteDirtySVRDatabase();
+    }
+
+exit:
+    cJSON_Delete(jsonDuplicateObj);
+    return ret;
+}
+
+/**
+ * Writes the pending SVR database updates once they are due.
+ */
+void ProcessSVRDatabase()
+{
+    if (g_svrDb.dirty && getCurrentTimeInMicroSeconds() >= GetSVRDatabaseFlushTime())
+    {
+        if (OC_STACK_OK != WriteDirtySVRDatabase())
         {
-            OC_LOG (ERROR, TAG, "Unable to open SVR database file!! ");
+            OC_LOG (ERROR, TAG, "Pending SVR database changes were not written");
         }
     }
+}
 
-exit:
-    OICFree(jsonSVRDbStr);
-    cJSON_Delete(jsonSVRDb);
+/**
+ * Gets the time until ProcessSVRDatabase() has pending updates to write.
+ *
+ * @retval  milliseconds until then, UINT32_MAX if no update is pending.
+ */
+uint32_t GetSVRDatabaseFlushTimeout()
+{
+    if (!g_svrDb.dirty)
+    {
+        return UINT32_MAX;
+    }
 
-    return ret;
+    uint64_t now = getCurrentTimeInMicroSeconds();
+    uint64_t flushTime = GetSVRDatabaseFlushTime();
+    return (flushTime > now) ? (uint32_t)((flushTime - now + 999) / 1000) : 0;
+}
+
+/**
+ * Writes changes of the SVR database that are still pending in memory.
+ *
+ * @retval  OC_STACK_OK for Success, otherwise some error value
+ */
+OCStackResult FlushSVRDatabase()
+{
+    return WriteDirtySVRDatabase();
+}
+
+/**
+ * Writes pending changes and releases the in-memory SVR database.
+ * The next access reads the database from PS again.
+ */
+void DeInitSVRDatabase()
+{
+    if (OC_STACK_OK != WriteDirtySVRDatabase())
+    {
+        OC_LOG (ERROR, TAG, "Pending SVR database changes were not written");
+    }
+
+    cJSON_Delete(g_svrDb.db);
+    g_svrDb.db = NULL;
+    g_svrDb.dirty = 0;
 }
@@ -125,7 +125,7 @@ OicSecPstat_t * JSONToPstatBin(const char * jsonStr)
     uint32_t outLen = 0;
     B64Result b64Ret = B64_OK;
 
-    cJSON *jsonRoot = cJSON_Parse(jsonStr);
+    cJSON *jsonRoot = cJSON_ParseArena(jsonStr);
     VERIFY_NON_NULL(TAG, jsonRoot, INFO);
 
     jsonPstat = cJSON_GetObjectItem(jsonRoot, OIC_JSON_PSTAT_NAME);
@@ -180,7 +180,7 @@ OicSecPstat_t * JSONToPstatBin(const char * jsonStr)
     ret = OC_STACK_OK;
 
 exit:
-    cJSON_Delete(jsonRoot);
+    cJSON_DeleteArena(jsonRoot);
     if (OC_STACK_OK != ret)
     {
         OC_LOG (ERROR, TAG, "JSONToPstatBin failed");
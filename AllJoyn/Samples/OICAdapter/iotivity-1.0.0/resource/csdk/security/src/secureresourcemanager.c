@@ -31,7 +31,9 @@
 #include "oic_malloc.h"
 #include "securevirtualresourcetypes.h"
 #include "secureresourcemanager.h"
+#include "cJSON.h"
 #include "srmresourcestrings.h"
+#include "psinterface.h"
 
 #define TAG  "SRM"
 
@@ -47,6 +49,7 @@ static CAResponseCallback gResponseHandler = NULL;
 static CAErrorCallback gErrorHandler = NULL;
 //Persistent Storage callback handler for open/read/write/close/unlink
 static OCPersistentStorage *gPersistentStorageHandler =  NULL;
+static OCPersistentStorageRename gPersistentStorageRenameHandler = NULL;
 //Provisioning response callback
 static SPResponseCallback gSPResponseHandler = NULL;
 
@@ -304,6 +307,8 @@ OCStackResult SRMRegisterPersistentStorageHandler(OCPersistentStorage* persisten
         OC_LOG(ERROR, TAG, "The persistent storage handler is invalid");
         return OC_STACK_INVALID_PARAM;
     }
+    // Pending changes go to the storage they were read from
+    DeInitSVRDatabase();
     gPersistentStorageHandler = persistentStorageHandler;
     return OC_STACK_OK;
 }
@@ -319,6 +324,31 @@ OCPersistentStorage* SRMGetPersistentStorageHandler()
     return gPersistentStorageHandler;
 }
 
+/**
+ * @brief   Register the optional Persistent storage rename callback.
+ * @param   renameHandler [IN] Pointer to the rename handler, NULL to write in place.
+ * @return
+ *     OC_STACK_OK    - No errors; Success
+ */
+OCStackResult SRMRegisterPersistentStorageRenameHandler(OCPersistentStorageRename renameHandler)
+{
+    OC_LOG(DEBUG, TAG, "SRMRegisterPersistentStorageRenameHandler !!");
+    // Pending changes are written the way they were meant to be
+    DeInitSVRDatabase();
+    gPersistentStorageRenameHandler = renameHandler;
+    return OC_STACK_OK;
+}
+
+/**
+ * @brief   Get Persistent storage rename handler.
+ * @return
+ *     The rename handler, NULL if none is registered
+ */
+OCPersistentStorageRename SRMGetPersistentStorageRenameHandler()
+{
+    return gPersistentStorageRenameHandler;
+}
+
 
 /**
  * @brief   Initialize all secure resources ( /oic/sec/cred, /oic/sec/acl, /oic/sec/pstat etc).
@@ -348,6 +378,25 @@ OCStackResult SRMInitSecureResources()
 void SRMDeInitSecureResources()
 {
     DestroySecureResources();
+    DeInitSVRDatabase();
+}
+
+/**
+ * @brief   Write the secure resource changes that are due to persistent storage.
+ * @retval  none
+ */
+void SRMProcess()
+{
+    ProcessSVRDatabase();
+}
+
+/**
+ * @brief   Get the time until SRMProcess has secure resource changes to write.
+ * @return  milliseconds until then, UINT32_MAX if no change is pending.
+ */
+uint32_t SRMGetProcessTimeout()
+{
+    return GetSVRDatabaseFlushTimeout();
 }
 
 /**
@@ -137,7 +137,7 @@ OicSecSvc_t * JSONToSvcBin(const char * jsonStr)
 
     VERIFY_NON_NULL(TAG, jsonStr, ERROR);
 
-    jsonRoot = cJSON_Parse(jsonStr);
+    jsonRoot = cJSON_ParseArena(jsonStr);
     VERIFY_NON_NULL(TAG, jsonRoot, ERROR);
 
     jsonSvcArray = cJSON_GetObjectItem(jsonRoot, OIC_JSON_SVC_NAME);
@@ -146,12 +146,11 @@ OicSecSvc_t * JSONToSvcBin(const char * jsonStr)
     if (cJSON_Array == jsonSvcArray->type)
     {
         int numSvc = cJSON_GetArraySize(jsonSvcArray);
-        int idx = 0;
+        cJSON *jsonSvc = jsonSvcArray->child;
 
         VERIFY_SUCCESS(TAG, numSvc > 0, INFO);
         do
         {
-            cJSON *jsonSvc = cJSON_GetArrayItem(jsonSvcArray, idx);
             VERIFY_NON_NULL(TAG, jsonSvc, ERROR);
 
             OicSecSvc_t *svc = (OicSecSvc_t*)OICCalloc(1, sizeof(OicSecSvc_t));
@@ -212,13 +211,14 @@ OicSecSvc_t * JSONToSvcBin(const char * jsonStr)
             } while ( ++idxx < svc->ownersLen);
 
             prevSvc = svc;
-        } while( ++idx < numSvc);
+            jsonSvc = jsonSvc->next;
+        } while (jsonSvc);
     }
 
     ret = OC_STACK_OK;
 
 exit:
-    cJSON_Delete(jsonRoot);
+    cJSON_DeleteArena(jsonRoot);
     if (OC_STACK_OK != ret)
     {
         DeleteSVCList(headSvc);
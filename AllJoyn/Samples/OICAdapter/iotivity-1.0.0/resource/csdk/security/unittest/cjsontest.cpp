@@ -0,0 +1,306 @@
+//******************************************************************
+//
+// Copyright 2015 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include "oic_malloc.h"
+#include "oic_string.h"
+#include "cJSON.h"
+#include "securevirtualresourcetypes.h"
+#include "srmresourcestrings.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern char * BinToAclJSON(const OicSecAcl_t * acl);
+extern OicSecAcl_t * JSONToAclBin(const char * jsonStr);
+extern void DeleteACLList(OicSecAcl_t* acl);
+
+#ifdef __cplusplus
+}
+#endif
+
+static const char CJSON_TEST_DOC[] =
+    "{\"acl\":[{\"sub\":\"MjIyMjIyMjIyMjIyMjIyMg==\",\"rsrc\":[\"/a/led\",\"/a/fan\"],"
+    "\"perms\":6,\"ownrs\":[\"MTExMTExMTExMTExMTExMQ==\"]}],"
+    "\"pstat\":{\"isop\":false,\"tm\":-1,\"ratio\":0.25,\"ch\":null,\"sm\":[],\"empty\":{}},"
+    "\"esc\":\"tab\\tquote\\\"\\u00e9\\ud83d\\ude00\"}";
+
+static const int SVR_BENCHMARK_ACES = 5000;
+static const int SVR_BENCHMARK_ROUNDS = 10;
+
+// Builds an ACL of count ACEs, each with a few resources and an owner.
+static OicSecAcl_t *CreateAcl(int count)
+{
+    OicSecAcl_t *head = NULL;
+    OicSecAcl_t **tail = &head;
+    for (int i = 0; i < count; i++)
+    {
+        OicSecAcl_t *ace = (OicSecAcl_t *)OICCalloc(1, sizeof(OicSecAcl_t));
+        snprintf((char *)ace->subject.id, sizeof(ace->subject.id), "subject%08d", i % 500);
+        ace->resourcesLen = 4;
+        ace->resources = (char **)OICCalloc(ace->resourcesLen, sizeof(char *));
+        for (size_t j = 0; j < ace->resourcesLen; j++)
+        {
+            char uri[64];
+            snprintf(uri, sizeof(uri), "/oic/r/device%05d/resource%zu", i, j);
+            ace->resources[j] = OICStrdup(uri);
+        }
+        ace->permission = PERMISSION_READ | (i % 2 ? PERMISSION_WRITE : 0);
+        ace->ownersLen = 1;
+        ace->owners = (OicUuid_t *)OICCalloc(1, sizeof(OicUuid_t));
+        memcpy(ace->owners->id, "1111111111111111", sizeof(ace->owners->id));
+        *tail = ace;
+        tail = &ace->next;
+    }
+    return head;
+}
+
+static double CpuUsec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// Rebuilds a document from the streaming parser's callbacks.
+struct SaxBuilder
+{
+    cJSON *stack[64];
+    int depth;
+    cJSON *root;
+    int values;
+    int stopAfter;
+};
+
+static void SaxAdd(SaxBuilder *builder, const char *key, cJSON *item)
+{
+    if (0 == builder->depth)
+    {
+        builder->root = item;
+        return;
+    }
+    cJSON *parent = builder->stack[builder->depth - 1];
+    if (cJSON_Object == parent->type)
+    {
+        cJSON_AddItemToObject(parent, key, item);
+    }
+    else
+    {
+        cJSON_AddItemToArray(parent, item);
+    }
+}
+
+static int SaxStartObject(void *ctx, const char *key)
+{
+    SaxBuilder *builder = (SaxBuilder *)ctx;
+    cJSON *item = cJSON_CreateObject();
+    SaxAdd(builder, key, item);
+    builder->stack[builder->depth++] = item;
+    return 1;
+}
+
+static int SaxStartArray(void *ctx, const char *key)
+{
+    SaxBuilder *builder = (SaxBuilder *)ctx;
+    cJSON *item = cJSON_CreateArray();
+    SaxAdd(builder, key, item);
+    builder->stack[builder->depth++] = item;
+    return 1;
+}
+
+static int SaxEnd(void *ctx)
+{
+    ((SaxBuilder *)ctx)->depth--;
+    return 1;
+}
+
+static int SaxValue(void *ctx, const char *key, const cJSON *item)
+{
+    SaxBuilder *builder = (SaxBuilder *)ctx;
+    cJSON *copy = cJSON_Duplicate((cJSON *)item, 0);
+    SaxAdd(builder, key, copy);
+    return ++builder->values != builder->stopAfter;
+}
+
+static const cJSON_SaxHandler SAX_BUILDER = {SaxStartObject, SaxEnd, SaxStartArray, SaxEnd, SaxValue};
+
+// Counts ACEs by their permission member.
+static int SaxCountAces(void *ctx, const char *key, const cJSON *item)
+{
+    if (key && cJSON_Number == item->type && 0 == strcmp(key, OIC_JSON_PERMISSION_NAME))
+    {
+        (*(int *)ctx)++;
+    }
+    return 1;
+}
+
+static std::string PrintUnformatted(cJSON *json)
+{
+    char *jsonStr = cJSON_PrintUnformatted(json);
+    std::string str = jsonStr ? jsonStr : "";
+    OICFree(jsonStr);
+    return str;
+}
+
+TEST(CJSONTest, ArenaParseMatchesHeapParse)
+{
+    cJSON *heap = cJSON_Parse(CJSON_TEST_DOC);
+    cJSON *arena = cJSON_ParseArena(CJSON_TEST_DOC);
+    ASSERT_TRUE(NULL != heap);
+    ASSERT_TRUE(NULL != arena);
+
+    EXPECT_EQ(PrintUnformatted(heap), PrintUnformatted(arena));
+    cJSON *pstat = cJSON_GetObjectItem(arena, "pstat");
+    ASSERT_TRUE(NULL != pstat);
+    EXPECT_EQ(-1, cJSON_GetObjectItem(pstat, "tm")->valueint);
+    EXPECT_STREQ("tab\tquote\"\xc3\xa9\xf0\x9f\x98\x80",
+                 cJSON_GetObjectItem(arena, "esc")->valuestring);
+
+    // A copy of an arena document is an ordinary one
+    cJSON *copy = cJSON_Duplicate(arena, 1);
+    cJSON_DeleteArena(arena);
+    EXPECT_EQ(PrintUnformatted(heap), PrintUnformatted(copy));
+    cJSON_DeleteItemFromObject(copy, "esc");
+    EXPECT_TRUE(NULL == cJSON_GetObjectItem(copy, "esc"));
+    cJSON_Delete(copy);
+    cJSON_Delete(heap);
+
+    EXPECT_TRUE(NULL == cJSON_ParseArena("{\"acl\":[1,2,}"));
+    EXPECT_TRUE(NULL == cJSON_ParseArena(NULL));
+    cJSON_DeleteArena(NULL);
+}
+
+TEST(CJSONTest, PrintFormats)
+{
+    cJSON *json = cJSON_Parse("{\"a\":[1,2.5,\"x\\n\"],\"b\":{},\"c\":{\"d\":true}}");
+    ASSERT_TRUE(NULL != json);
+
+    EXPECT_EQ("{\"a\":[1,2.500000,\"x\\n\"],\"b\":{},\"c\":{\"d\":true}}", PrintUnformatted(json));
+    char *jsonStr = cJSON_Print(json);
+    EXPECT_STREQ("{\n\t\"a\":\t[1, 2.500000, \"x\\n\"],\n\t\"b\":\t{\n},\n"
+                 "\t\"c\":\t{\n\t\t\"d\":\ttrue\n\t}\n}", jsonStr);
+    OICFree(jsonStr);
+
+    // Starts with a single byte and grows
+    jsonStr = cJSON_PrintBuffered(json, 1, 0);
+    EXPECT_EQ(PrintUnformatted(json), std::string(jsonStr));
+    OICFree(jsonStr);
+    cJSON_Delete(json);
+}
+
+TEST(CJSONTest, SaxParseVisitsEveryValue)
+{
+    SaxBuilder builder = SaxBuilder();
+    ASSERT_EQ(1, cJSON_ParseSax(CJSON_TEST_DOC, &SAX_BUILDER, &builder));
+    EXPECT_EQ(0, builder.depth);
+    EXPECT_EQ(10, builder.values);
+
+    cJSON *heap = cJSON_Parse(CJSON_TEST_DOC);
+    EXPECT_EQ(PrintUnformatted(heap), PrintUnformatted(builder.root));
+    cJSON_Delete(heap);
+    cJSON_Delete(builder.root);
+
+    // A callback can stop the walk
+    builder = SaxBuilder();
+    builder.stopAfter = 3;
+    EXPECT_EQ(0, cJSON_ParseSax(CJSON_TEST_DOC, &SAX_BUILDER, &builder));
+    EXPECT_EQ(3, builder.values);
+    cJSON_Delete(builder.root);
+
+    cJSON_SaxHandler none = cJSON_SaxHandler();
+    EXPECT_EQ(1, cJSON_ParseSax(CJSON_TEST_DOC, &none, NULL));
+    EXPECT_EQ(0, cJSON_ParseSax("{\"acl\" 1}", &none, NULL));
+    EXPECT_EQ(0, cJSON_ParseSax("[1 2]", &none, NULL));
+}
+
+TEST(CJSONTest, CutOffEscapesAreMalformed)
+{
+    const char *docs[] = {"\"\\", "[\"\\u12", "{\"a\":\"\\u12\"}", "[\"\\ud83d\\ude0\"]"};
+    cJSON_SaxHandler none = cJSON_SaxHandler();
+    for (size_t i = 0; i < sizeof(docs) / sizeof(docs[0]); i++)
+    {
+        EXPECT_TRUE(NULL == cJSON_Parse(docs[i])) << docs[i];
+        EXPECT_TRUE(NULL == cJSON_ParseArena(docs[i])) << docs[i];
+        EXPECT_EQ(0, cJSON_ParseSax(docs[i], &none, NULL)) << docs[i];
+    }
+}
+
+TEST(CJSONTest, LargeSvrDatabase)
+{
+    OicSecAcl_t *acl = CreateAcl(SVR_BENCHMARK_ACES);
+    char *jsonStr = BinToAclJSON(acl);
+    DeleteACLList(acl);
+    ASSERT_TRUE(NULL != jsonStr);
+    size_t len = strlen(jsonStr);
+    EXPECT_LE((size_t)1 << 20, len);
+
+    double heapUsec = 0, arenaUsec = 0, saxUsec = 0, printUsec = 0, aclUsec = 0;
+    for (int round = 0; round < SVR_BENCHMARK_ROUNDS; round++)
+    {
+        double start = CpuUsec();
+        cJSON *heap = cJSON_Parse(jsonStr);
+        cJSON_Delete(heap);
+        heapUsec += CpuUsec() - start;
+        ASSERT_TRUE(NULL != heap);
+
+        start = CpuUsec();
+        cJSON *arena = cJSON_ParseArena(jsonStr);
+        ASSERT_TRUE(NULL != arena);
+        arenaUsec += CpuUsec() - start;
+
+        start = CpuUsec();
+        char *printed = cJSON_PrintUnformatted(arena);
+        printUsec += CpuUsec() - start;
+        ASSERT_TRUE(NULL != printed);
+        EXPECT_STREQ(jsonStr, printed);
+        OICFree(printed);
+
+        start = CpuUsec();
+        cJSON_DeleteArena(arena);
+        arenaUsec += CpuUsec() - start;
+
+        int aces = 0;
+        cJSON_SaxHandler counter = cJSON_SaxHandler();
+        counter.value = SaxCountAces;
+        start = CpuUsec();
+        EXPECT_EQ(1, cJSON_ParseSax(jsonStr, &counter, &aces));
+        saxUsec += CpuUsec() - start;
+        EXPECT_EQ(SVR_BENCHMARK_ACES, aces);
+
+        start = CpuUsec();
+        acl = JSONToAclBin(jsonStr);
+        aclUsec += CpuUsec() - start;
+        ASSERT_TRUE(NULL != acl);
+        DeleteACLList(acl);
+    }
+    OICFree(jsonStr);
+
+    printf("[          ] %zu KB SVR database, %d ACEs, usec CPU per document:\n",
+           len >> 10, SVR_BENCHMARK_ACES);
+    printf("[          ] parse %.0f, arena parse %.0f, SAX parse %.0f, print %.0f, "
+           "JSONToAclBin %.0f\n", heapUsec / SVR_BENCHMARK_ROUNDS,
+           arenaUsec / SVR_BENCHMARK_ROUNDS, saxUsec / SVR_BENCHMARK_ROUNDS,
+           printUsec / SVR_BENCHMARK_ROUNDS, aclUsec / SVR_BENCHMARK_ROUNDS);
+}
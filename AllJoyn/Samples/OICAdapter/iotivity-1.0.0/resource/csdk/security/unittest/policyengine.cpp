@@ -36,6 +36,11 @@ extern "C" {
 
 #include "policyengine.h"
 #include "doxmresource.h"
+#include "aclresource.h"
+#include "oic_malloc.h"
+#include "oic_string.h"
+
+extern OicSecAcl_t *gAcl;
 
 // test parameters
 PEContext_t g_peContext;
@@ -50,6 +55,33 @@ OicUuid_t g_devOwner;
 char g_resource1[] = "Resource1";
 char g_resource2[] = "Resource2";
 
+static const int BENCHMARK_ACES = 2000;
+static const int BENCHMARK_CHECKS = 10000;
+
+// Appends an ACE for subject with a single resource to gAcl.
+static void AppendAce(const OicUuid_t *subject, const char *resource, uint16_t permission)
+{
+    OicSecAcl_t *ace = (OicSecAcl_t *)OICCalloc(1, sizeof(OicSecAcl_t));
+    memcpy(&ace->subject, subject, sizeof(OicUuid_t));
+    ace->resourcesLen = 1;
+    ace->resources = (char **)OICCalloc(1, sizeof(char *));
+    ace->resources[0] = OICStrdup(resource);
+    ace->permission = permission;
+
+    OicSecAcl_t **tail = &gAcl;
+    while (*tail)
+    {
+        tail = &(*tail)->next;
+    }
+    *tail = ace;
+}
+
+// Drops the ACL, which also marks it as changed.
+static void ResetAcl()
+{
+    DeInitACLResource();
+}
+
 //Policy Engine Core Tests
 TEST(PolicyEngineCore, InitPolicyEngine)
 {
@@ -98,6 +130,85 @@ TEST(PolicyEngineCore, CheckDevOwnerRequest)
 
 }
 
+TEST(PolicyEngineCore, FirstMatchingAceDecides)
+{
+    ResetAcl();
+    AppendAce(&g_subjectIdA, g_resource1, PERMISSION_READ);
+    AppendAce(&g_subjectIdA, "*", PERMISSION_FULL_CONTROL);
+
+    EXPECT_EQ(ACCESS_GRANTED,
+        CheckPermission(&g_peContext, &g_subjectIdA, g_resource1, PERMISSION_READ));
+    // the exact ACE comes before the wildcard one
+    EXPECT_EQ(ACCESS_DENIED_INSUFFICIENT_PERMISSION,
+        CheckPermission(&g_peContext, &g_subjectIdA, g_resource1, PERMISSION_WRITE));
+    EXPECT_EQ(ACCESS_GRANTED,
+        CheckPermission(&g_peContext, &g_subjectIdA, g_resource2, PERMISSION_WRITE));
+    EXPECT_EQ(ACCESS_DENIED_SUBJECT_NOT_FOUND,
+        CheckPermission(&g_peContext, &g_subjectIdB, g_resource1, PERMISSION_READ));
+
+    ResetAcl();
+    AppendAce(&g_subjectIdB, g_resource2, PERMISSION_READ);
+    // falls back to the wildcard subject, which has no ACE either
+    EXPECT_FALSE(IsAccessGranted(
+        CheckPermission(&g_peContext, &g_subjectIdB, g_resource1, PERMISSION_READ)));
+    ResetAcl();
+}
+
+TEST(PolicyEngineCore, DecisionCacheFollowsAclChanges)
+{
+    PEStats_t before, after;
+
+    ResetAcl();
+    AppendAce(&g_subjectIdA, g_resource1, PERMISSION_READ);
+    GetPolicyEngineStats(&g_peContext, &before);
+    EXPECT_EQ(ACCESS_DENIED_INSUFFICIENT_PERMISSION,
+        CheckPermission(&g_peContext, &g_subjectIdA, g_resource1, PERMISSION_WRITE));
+    EXPECT_EQ(ACCESS_DENIED_INSUFFICIENT_PERMISSION,
+        CheckPermission(&g_peContext, &g_subjectIdA, g_resource1, PERMISSION_WRITE));
+    GetPolicyEngineStats(&g_peContext, &after);
+    EXPECT_EQ(before.decisions + 2, after.decisions);
+    EXPECT_EQ(before.cacheHits + 1, after.cacheHits);
+
+    ResetAcl();
+    AppendAce(&g_subjectIdA, g_resource1, PERMISSION_FULL_CONTROL);
+    EXPECT_EQ(ACCESS_GRANTED,
+        CheckPermission(&g_peContext, &g_subjectIdA, g_resource1, PERMISSION_WRITE));
+    ResetAcl();
+}
+
+TEST(PolicyEngineCore, DecisionLatencyWithManyAces)
+{
+    ResetAcl();
+    OicUuid_t subject = {{0}};
+    char resource[MAX_URI_LENGTH];
+    for (int i = 0; i < BENCHMARK_ACES; i++)
+    {
+        snprintf((char *)subject.id, sizeof(subject.id), "Subject%d", i % 100);
+        snprintf(resource, sizeof(resource), "/a/resource%d", i);
+        AppendAce(&subject, resource, PERMISSION_READ);
+    }
+
+    PEStats_t before, after;
+    GetPolicyEngineStats(&g_peContext, &before);
+    for (int i = 0; i < BENCHMARK_CHECKS; i++)
+    {
+        // mostly distinct requests, so most of them miss the decision cache
+        int ace = (i * 7) % BENCHMARK_ACES;
+        snprintf((char *)subject.id, sizeof(subject.id), "Subject%d", ace % 100);
+        snprintf(resource, sizeof(resource), "/a/resource%d", ace);
+        ASSERT_EQ(ACCESS_GRANTED,
+            CheckPermission(&g_peContext, &subject, resource, PERMISSION_READ));
+    }
+    GetPolicyEngineStats(&g_peContext, &after);
+
+    uint32_t decisions = after.decisions - before.decisions;
+    EXPECT_EQ((uint32_t)BENCHMARK_CHECKS, decisions);
+    printf("%s %d ACEs: %.3f us average decision, %u cache hits\n", PE_UT_TAG,
+           BENCHMARK_ACES, (double)(after.totalLatencyUs - before.totalLatencyUs) / decisions,
+           after.cacheHits - before.cacheHits);
+    ResetAcl();
+}
+
 TEST(PolicyEngineCore, DeInitPolicyEngine)
 {
     DeInitPolicyEngine(&g_peContext);
@@ -0,0 +1,288 @@
+//******************************************************************
+//
+// Copyright 2015 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "ocstack.h"
+#include "ocpayload.h"
+#include "cainterface.h"
+#include "oic_malloc.h"
+#include "cJSON.h"
+#include "psinterface.h"
+#include "secureresourcemanager.h"
+#include "srmresourcestrings.h"
+#include "aclresource.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+OCEntityHandlerResult ACLEntityHandler (OCEntityHandlerFlag flag,
+                                        OCEntityHandlerRequest * ehRequest);
+#ifdef __cplusplus
+}
+#endif
+
+#define PSI_TEST_DB_FILE_NAME "psinterfacetest_svr_db.json"
+#define PSI_TEST_DB_TEMP_FILE_NAME "psinterfacetest_svr_db.json.tmp"
+
+static const char PSI_TEST_DB[] =
+    "{\"acl\":{\"acl\":[]},\"pstat\":{\"isop\":false}}";
+
+static const int BULK_UPDATES = 500;
+static const int ACL_POSTS = 50;
+
+// Longer than the time the SVR database waits for more updates
+static const useconds_t FLUSH_DELAY_USEC = 150 * 1000;
+
+static int g_dbWrites;
+
+// Maps the SVR database names to the test files and counts writes.
+static const char *PsiTestPath(const char *path)
+{
+    std::string tempName = std::string(SVR_DB_FILE_NAME) + ".tmp";
+    return (0 == tempName.compare(path)) ? PSI_TEST_DB_TEMP_FILE_NAME : PSI_TEST_DB_FILE_NAME;
+}
+
+static FILE *PsiTestOpen(const char *path, const char *mode)
+{
+    if ('w' == mode[0])
+    {
+        g_dbWrites++;
+    }
+    return fopen(PsiTestPath(path), mode);
+}
+
+static int PsiTestUnlink(const char *path)
+{
+    return unlink(PsiTestPath(path));
+}
+
+static int PsiTestRename(const char *oldpath, const char *newpath)
+{
+    return rename(PsiTestPath(oldpath), PsiTestPath(newpath));
+}
+
+static cJSON *UpdateFor(int index)
+{
+    cJSON *jsonRoot = cJSON_CreateObject();
+    cJSON *jsonAcl = cJSON_CreateObject();
+    cJSON_AddItemToObject(jsonRoot, OIC_JSON_ACL_NAME, jsonAcl);
+    cJSON_AddNumberToObject(jsonAcl, "index", index);
+    return jsonRoot;
+}
+
+// Index of the last update in the database file, -1 if there is none.
+static int IndexInFile()
+{
+    char jsonStr[sizeof(PSI_TEST_DB) + 64] = { 0 };
+    FILE *fp = fopen(PSI_TEST_DB_FILE_NAME, "r");
+    if (fp)
+    {
+        fread(jsonStr, 1, sizeof(jsonStr) - 1, fp);
+        fclose(fp);
+    }
+
+    int index = -1;
+    cJSON *jsonRoot = cJSON_Parse(jsonStr);
+    cJSON *jsonAcl = cJSON_GetObjectItem(jsonRoot, OIC_JSON_ACL_NAME);
+    cJSON *jsonIndex = jsonAcl ? cJSON_GetObjectItem(jsonAcl, "index") : NULL;
+    if (jsonIndex)
+    {
+        index = jsonIndex->valueint;
+    }
+    cJSON_Delete(jsonRoot);
+    return index;
+}
+
+class PSInterfaceF : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        FILE *fp = fopen(PSI_TEST_DB_FILE_NAME, "w");
+        ASSERT_TRUE(NULL != fp);
+        fwrite(PSI_TEST_DB, 1, sizeof(PSI_TEST_DB) - 1, fp);
+        fclose(fp);
+
+        memset(&m_ps, 0, sizeof(m_ps));
+        m_ps.open = PsiTestOpen;
+        m_ps.read = fread;
+        m_ps.write = fwrite;
+        m_ps.close = fclose;
+        m_ps.unlink = PsiTestUnlink;
+        ASSERT_EQ(OC_STACK_OK, SRMRegisterPersistentStorageHandler(&m_ps));
+        ASSERT_EQ(OC_STACK_OK, SRMRegisterPersistentStorageRenameHandler(PsiTestRename));
+        g_dbWrites = 0;
+    }
+
+    virtual void TearDown()
+    {
+        DeInitSVRDatabase();
+        SRMRegisterPersistentStorageRenameHandler(NULL);
+        unlink(PSI_TEST_DB_FILE_NAME);
+        unlink(PSI_TEST_DB_TEMP_FILE_NAME);
+    }
+
+    OCPersistentStorage m_ps;
+};
+
+TEST_F(PSInterfaceF, UpdateIsWrittenBehind)
+{
+    EXPECT_EQ(UINT32_MAX, GetSVRDatabaseFlushTimeout());
+    cJSON *jsonUpdate = UpdateFor(1);
+    EXPECT_EQ(OC_STACK_OK, UpdateSVRDatabase(OIC_JSON_ACL_NAME, jsonUpdate));
+    cJSON_Delete(jsonUpdate);
+    EXPECT_EQ(0, g_dbWrites);
+    EXPECT_EQ(-1, IndexInFile());
+
+    char *jsonStr = GetSVRDatabase();
+    ASSERT_TRUE(NULL != jsonStr);
+    EXPECT_TRUE(NULL != strstr(jsonStr, "\"index\":1"));
+    EXPECT_TRUE(NULL != strstr(jsonStr, OIC_JSON_PSTAT_NAME));
+    OICFree(jsonStr);
+
+    EXPECT_EQ(OC_STACK_OK, FlushSVRDatabase());
+    EXPECT_EQ(1, g_dbWrites);
+    EXPECT_EQ(1, IndexInFile());
+
+    // Nothing is pending
+    EXPECT_EQ(OC_STACK_OK, FlushSVRDatabase());
+    EXPECT_EQ(1, g_dbWrites);
+    EXPECT_EQ(UINT32_MAX, GetSVRDatabaseFlushTimeout());
+}
+
+TEST_F(PSInterfaceF, UpdateIsWrittenWhenDue)
+{
+    cJSON *jsonUpdate = UpdateFor(2);
+    EXPECT_EQ(OC_STACK_OK, UpdateSVRDatabase(OIC_JSON_ACL_NAME, jsonUpdate));
+    cJSON_Delete(jsonUpdate);
+
+    uint32_t timeout = GetSVRDatabaseFlushTimeout();
+    EXPECT_LT(0u, timeout);
+    EXPECT_GE(FLUSH_DELAY_USEC / 1000, timeout);
+    ProcessSVRDatabase();
+    EXPECT_EQ(0, g_dbWrites);
+
+    usleep(FLUSH_DELAY_USEC);
+    EXPECT_EQ(0u, GetSVRDatabaseFlushTimeout());
+    ProcessSVRDatabase();
+    EXPECT_EQ(1, g_dbWrites);
+    EXPECT_EQ(2, IndexInFile());
+    EXPECT_EQ(UINT32_MAX, GetSVRDatabaseFlushTimeout());
+}
+
+TEST_F(PSInterfaceF, PstatUpdateIsWrittenBeforeReturn)
+{
+    cJSON *jsonUpdate = UpdateFor(4);
+    EXPECT_EQ(OC_STACK_OK, UpdateSVRDatabase(OIC_JSON_ACL_NAME, jsonUpdate));
+    cJSON_Delete(jsonUpdate);
+
+    jsonUpdate = cJSON_CreateObject();
+    cJSON *jsonPstat = cJSON_CreateObject();
+    cJSON_AddItemToObject(jsonUpdate, OIC_JSON_PSTAT_NAME, jsonPstat);
+    cJSON_AddTrueToObject(jsonPstat, "isop");
+    EXPECT_EQ(OC_STACK_OK, UpdateSVRDatabase(OIC_JSON_PSTAT_NAME, jsonUpdate));
+    cJSON_Delete(jsonUpdate);
+
+    // The pending ACL update is written along
+    EXPECT_EQ(1, g_dbWrites);
+    EXPECT_EQ(4, IndexInFile());
+    EXPECT_EQ(UINT32_MAX, GetSVRDatabaseFlushTimeout());
+}
+
+TEST_F(PSInterfaceF, UnknownResourceIsRejected)
+{
+    cJSON *jsonUpdate = cJSON_CreateObject();
+    cJSON_AddItemToObject(jsonUpdate, OIC_JSON_SVC_NAME, cJSON_CreateObject());
+    EXPECT_NE(OC_STACK_OK, UpdateSVRDatabase(OIC_JSON_SVC_NAME, jsonUpdate));
+    cJSON_Delete(jsonUpdate);
+    EXPECT_EQ(UINT32_MAX, GetSVRDatabaseFlushTimeout());
+}
+
+TEST_F(PSInterfaceF, WriteReplacesFile)
+{
+    cJSON *jsonUpdate = UpdateFor(7);
+    EXPECT_EQ(OC_STACK_OK, UpdateSVRDatabase(OIC_JSON_ACL_NAME, jsonUpdate));
+    cJSON_Delete(jsonUpdate);
+    EXPECT_EQ(OC_STACK_OK, FlushSVRDatabase());
+
+    EXPECT_EQ(1, g_dbWrites);
+    EXPECT_EQ(7, IndexInFile());
+    EXPECT_NE(0, access(PSI_TEST_DB_TEMP_FILE_NAME, F_OK));
+}
+
+TEST_F(PSInterfaceF, DeInitWritesPendingUpdates)
+{
+    cJSON *jsonUpdate = UpdateFor(3);
+    EXPECT_EQ(OC_STACK_OK, UpdateSVRDatabase(OIC_JSON_ACL_NAME, jsonUpdate));
+    cJSON_Delete(jsonUpdate);
+
+    DeInitSVRDatabase();
+    EXPECT_EQ(1, g_dbWrites);
+    EXPECT_EQ(3, IndexInFile());
+}
+
+TEST_F(PSInterfaceF, BulkUpdatesAreCoalesced)
+{
+    for (int i = 0; i < BULK_UPDATES; i++)
+    {
+        cJSON *jsonUpdate = UpdateFor(i);
+        ASSERT_EQ(OC_STACK_OK, UpdateSVRDatabase(OIC_JSON_ACL_NAME, jsonUpdate));
+        cJSON_Delete(jsonUpdate);
+    }
+    EXPECT_EQ(0, g_dbWrites);
+    EXPECT_EQ(OC_STACK_OK, FlushSVRDatabase());
+
+    EXPECT_EQ(BULK_UPDATES - 1, IndexInFile());
+    EXPECT_EQ(1, g_dbWrites);
+}
+
+TEST_F(PSInterfaceF, AclPostsAreCoalesced)
+{
+    OCEntityHandlerRequest ehReq = OCEntityHandlerRequest();
+    ehReq.method = OC_REST_POST;
+
+    for (int i = 0; i < ACL_POSTS; i++)
+    {
+        char jsonStr[128];
+        snprintf(jsonStr, sizeof(jsonStr),
+                 "{\"acl\":[{\"sub\":\"Kg==\",\"rsrc\":[\"/a/light/%d\"],\"perms\":255,"
+                 "\"ownrs\":[\"MjIyMjIyMjIyMjIyMjIyMg==\"]}]}", i);
+        ehReq.payload = (OCPayload*)OCSecurityPayloadCreate(jsonStr);
+        ACLEntityHandler(OC_REQUEST_FLAG, &ehReq);
+        OCPayloadDestroy(ehReq.payload);
+    }
+    EXPECT_EQ(0, g_dbWrites);
+
+    usleep(FLUSH_DELAY_USEC);
+    ProcessSVRDatabase();
+    EXPECT_EQ(1, g_dbWrites);
+
+    char *jsonStr = GetSVRDatabase();
+    ASSERT_TRUE(NULL != jsonStr);
+    EXPECT_TRUE(NULL != strstr(jsonStr, "/a/light/0"));
+    EXPECT_TRUE(NULL != strstr(jsonStr, "/a/light/49"));
+    OICFree(jsonStr);
+
+    DeInitACLResource();
+    EXPECT_EQ(1, g_dbWrites);
+}
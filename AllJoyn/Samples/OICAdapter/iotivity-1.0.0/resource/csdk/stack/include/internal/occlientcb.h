@@ -35,6 +35,7 @@
 
 #include "ocresource.h"
 #include "cacommon.h"
+#include "oic_hash.h"
 
 /**
  * Data structure For presence Discovery.
@@ -128,10 +129,42 @@ typedef struct ClientCB {
 
     /** next node in this list.*/
     struct ClientCB    *next;
+
+    /** previous node in this list.*/
+    struct ClientCB    *prev;
+
+    /** links in the token, handle, node address and presence uri indexes.*/
+    OICHashLink_t tokenLink;
+    OICHashLink_t handleLink;
+    OICHashLink_t nodeLink;
+    OICHashLink_t uriLink;
+
+    /** position in the heap of callbacks ordered by TTL, CLIENTCB_NOT_IN_HEAP if TTL is 0.*/
+    size_t ttlHeapIndex;
 } ClientCB;
 
 /**
- * Linked list of ClientCB node.
+ * Value of ClientCB::ttlHeapIndex for a callback that does not time out.
+ */
+#define CLIENTCB_NOT_IN_HEAP (SIZE_MAX)
+
+/**
+ * Statistics of the client callbacks.
+ */
+typedef struct
+{
+    /** number of callbacks waiting for a response.*/
+    size_t liveCallbacks;
+
+    /** most callbacks there were at the same time.*/
+    size_t peakCallbacks;
+
+    /** number of callbacks deleted because their TTL ran out.*/
+    size_t timedOutCallbacks;
+} OCClientCBStats;
+
+/**
+ * Doubly linked list of ClientCB node, in the utlist DL_ convention.
  */
 extern struct ClientCB *cbList;
 
@@ -188,9 +221,10 @@ bool ClientTokenExist(const CAToken_t token, uint8_t tokenLength);
  * @param[in] token        Token to search for.
  * @param[in] tokenLength  The Length of the token.
  * @param[in] handle       Handle to search for.
- * @param[in] requestUri   Uri to search for.
+ * @param[in] requestUri   Uri of a presence callback to search for.
  *
  * @brief You can search by token OR by handle, but not both.
+ * Only presence callbacks are found by their uri.
  *
  * @return address of the node if found, otherwise NULL
  */
@@ -229,6 +263,37 @@ void DeleteClientCBList();
  */
 void FindAndDeleteClientCB(ClientCB * cbNode);
 
+/** @ingroup ocstack
+ *
+ * This method is used to change the TTL of a callback.
+ *
+ * @param[in] cbNode    Address to client callback node.
+ * @param[in] ttl       time to live in coap_ticks, 0 if the callback does not time out.
+ */
+void UpdateClientCBTTL(ClientCB * cbNode, uint32_t ttl);
+
+/** @ingroup ocstack
+ *
+ * This method is used to delete the callbacks whose TTL has run out.
+ */
+void DeleteTimedOutClientCBs();
+
+/** @ingroup ocstack
+ *
+ * This method is used to get the time until the next callback times out.
+ *
+ * @return Milliseconds until then, UINT32_MAX if no callback has a TTL.
+ */
+uint32_t GetClientCBTimeout();
+
+/** @ingroup ocstack
+ *
+ * This method is used to get the statistics of the client callbacks.
+ *
+ * @param[out] stats    the statistics.
+ */
+void GetClientCBStats(OCClientCBStats *stats);
+
 /** @ingroup ocstack
  *
  * This method is used to search a multicast presence node from list.
@@ -0,0 +1,147 @@
+//******************************************************************
+//
+// Copyright 2015 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * Client side cache of discovery responses.  A unicast discovery of a server whose response
+ * to the same URI is younger than the maximum age is answered from the cache instead of the
+ * network; the answer is queued and handed to the stack by ::OCProcess.
+ */
+
+#ifndef OC_DISCOVERY_CACHE_H
+#define OC_DISCOVERY_CACHE_H
+
+#include "octypes.h"
+#include "cacommon.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Cached discovery response waiting to be handed to the callback of a request.
+ */
+typedef struct OCDiscoveryDelivery
+{
+    /** server that sent the response.*/
+    OCDevAddr devAddr;
+
+    /** resource uri of the response.*/
+    char *resourceUri;
+
+    /** encoded payload of the response.*/
+    uint8_t *payload;
+    size_t payloadSize;
+
+    /** token of the request.*/
+    uint8_t token[CA_MAX_TOKEN_LEN];
+    uint8_t tokenLength;
+
+    /** Linked list; in request order.*/
+    struct OCDiscoveryDelivery *next;
+} OCDiscoveryDelivery;
+
+/**
+ * Statistics of the discovery cache.
+ */
+typedef struct
+{
+    /** number of responses in the cache.*/
+    size_t entries;
+
+    /** number of discoveries answered from the cache.*/
+    size_t hits;
+
+    /** number of unicast discoveries sent to the network while the cache is enabled.*/
+    size_t misses;
+
+    /** number of responses dropped because they were older than the maximum age.*/
+    size_t expired;
+} OCDiscoveryCacheStats;
+
+/**
+ * Set the maximum age of cached responses.
+ *
+ * @param maxAgeSeconds     maximum age in seconds, 0 to disable and empty the cache.
+ */
+void SetDiscoveryCacheMaxAge(uint32_t maxAgeSeconds);
+
+/**
+ * Keep a discovery response.  Does nothing if the cache is disabled or the server is secure.
+ *
+ * @param devAddr           server that sent the response.
+ * @param requestUri        uri and query of the discovery request.
+ * @param resourceUri       resource uri of the response.
+ * @param payload           encoded payload of the response, which is copied.
+ * @param payloadSize       size of the payload.
+ */
+void StoreDiscoveryResponse(const OCDevAddr *devAddr, const char *requestUri,
+                            const char *resourceUri, const uint8_t *payload, size_t payloadSize);
+
+/**
+ * Queue the cached response of a server for a discovery request, if it is fresh.
+ *
+ * @param devAddr           server of the request.
+ * @param requestUri        uri and query of the request.
+ * @param token             token of the request.
+ * @param tokenLength       length of the token.
+ *
+ * @return true if the response was queued, false if the request has to be sent.
+ */
+bool QueueCachedDiscoveryResponse(const OCDevAddr *devAddr, const char *requestUri,
+                                  const CAToken_t token, uint8_t tokenLength);
+
+/**
+ * Check whether cached responses are waiting to be handed over.
+ */
+bool HasCachedDiscoveryDeliveries();
+
+/**
+ * Take the queued responses.  Responses queued while they are being handed over are
+ * kept for the next call.
+ *
+ * @return list of responses to free with ::DeleteDiscoveryDelivery, NULL if there are none.
+ */
+OCDiscoveryDelivery *TakeCachedDiscoveryDeliveries();
+
+/**
+ * Free a response taken with ::TakeCachedDiscoveryDeliveries.
+ */
+void DeleteDiscoveryDelivery(OCDiscoveryDelivery *delivery);
+
+/**
+ * Get the statistics of the cache.
+ *
+ * @param[out] stats    the statistics.
+ */
+void GetDiscoveryCacheStats(OCDiscoveryCacheStats *stats);
+
+/**
+ * Empty the cache and the queue, disable the cache and reset its statistics.
+ */
+void DeleteDiscoveryCache();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
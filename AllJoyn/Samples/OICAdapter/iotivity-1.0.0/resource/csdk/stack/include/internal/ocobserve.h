@@ -29,6 +29,8 @@
 #ifndef OC_OBSERVE_H
 #define OC_OBSERVE_H
 
+#include "oic_hash.h"
+
 /** Sequence number is a 24 bit field, per https://tools.ietf.org/html/draft-ietf-core-observe-16.*/
 #define MAX_SEQUENCE_NUMBER              (0xFFFFFF)
 
@@ -80,9 +82,29 @@ typedef struct ResourceObserver
     /** next node in this list.*/
     struct ResourceObserver *next;
 
+    /** previous node in this list.*/
+    struct ResourceObserver *prev;
+
     /** requested payload encoding format. */
     OCPayloadFormat acceptFormat;
 
+    /** links in the observe ID and token indexes.*/
+    OICHashLink_t idLink;
+    OICHashLink_t tokenLink;
+
+    /** neighbours in the list of observers of the same resource.*/
+    struct ResourceObserver *resourceNext;
+    struct ResourceObserver *resourcePrev;
+
+    /** start of the current rate limiting window, in coap ticks.*/
+    uint32_t rateWindowStart;
+
+    /** number of notifications sent in the current rate limiting window.*/
+    uint16_t rateWindowCount;
+
+    /** a notification was held back by the rate limiter and is still owed.*/
+    uint8_t pendingNotification;
+
 } ResourceObserver;
 
 #ifdef WITH_PRESENCE
@@ -131,11 +153,42 @@ OCStackResult SendListObserverNotification (OCResource * resource,
         const OCRepPayload *payload, uint32_t maxAge,
         OCQualityOfService qos);
 
+/**
+ * Send the notifications held back by the rate limiter to observers whose rate limiting
+ * window has passed.  Each of them gets the current representation of its resource.
+ */
+void SendPendingObserverNotifications();
+
+/**
+ * Get the time until ::SendPendingObserverNotifications has a notification to send.
+ *
+ * @return Milliseconds until the first rate limiting window of a pending observer
+ *         passes, 0 if one has passed and UINT32_MAX if there is nothing pending.
+ */
+uint32_t GetPendingObserverNotificationTimeout();
+
+/**
+ * Limit the number of notifications sent to any single observer.  Notifications above
+ * the limit are coalesced into one that is sent by ::SendPendingObserverNotifications
+ * once the observer's one second window has passed.
+ *
+ * @param notificationsPerSecond  Maximum notifications per observer and second; 0 disables
+ *                                the limit.
+ */
+void SetObserverNotificationRate(uint16_t notificationsPerSecond);
+
 /**
  * Delete all observers in the observe list.
  */
 void DeleteObserverList();
 
+/**
+ * Delete all observers of a resource.  Called before the resource itself is deleted.
+ *
+ * @param resource        Observed resource.
+ */
+void DeleteObserversUsingResource(OCResource *resource);
+
 /**
  * Create a unique observation ID.
  *
@@ -0,0 +1,127 @@
+//******************************************************************
+//
+// Copyright 2015 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * Block allocator for parsed payloads.  A payload and everything it points to is taken from
+ * one arena, which is freed when the last payload structure in it is destroyed.  Setters may
+ * still replace parts of such a payload with heap memory, so the destroy functions free a
+ * pointer only if the arena does not own it.
+ *
+ * All functions accept a NULL arena and then use the heap, so that a single code path
+ * builds both kinds of payloads.
+ */
+
+#ifndef OC_PAYLOAD_ARENA_H
+#define OC_PAYLOAD_ARENA_H
+
+#include "octypes.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct OCPayloadArena OCPayloadArena;
+
+/**
+ * Create an arena holding one reference.
+ *
+ * @param sizeHint  expected number of bytes, the size of the first block.
+ *
+ * @return the arena, NULL if out of memory.
+ */
+OCPayloadArena* OCPayloadArenaCreate(size_t sizeHint);
+
+/**
+ * Take a reference, one for each payload structure that can be destroyed on its own.
+ */
+void OCPayloadArenaRetain(OCPayloadArena* arena);
+
+/**
+ * Drop a reference, freeing the arena with the last one.
+ */
+void OCPayloadArenaRelease(OCPayloadArena* arena);
+
+/**
+ * Allocate zeroed memory, aligned for any payload type.
+ */
+void* OCPayloadArenaCalloc(OCPayloadArena* arena, size_t num, size_t size);
+
+/**
+ * Allocate length + 1 bytes for a NUL terminated string.
+ */
+char* OCPayloadArenaAllocString(OCPayloadArena* arena, size_t length);
+
+/**
+ * Copy a NUL terminated string.
+ */
+char* OCPayloadArenaStrdup(OCPayloadArena* arena, const char* str);
+
+/**
+ * Check whether ptr was allocated from the arena.
+ */
+bool OCPayloadArenaOwns(const OCPayloadArena* arena, const void* ptr);
+
+/**
+ * Free ptr unless the arena owns it.
+ */
+void OCPayloadArenaFree(const OCPayloadArena* arena, void* ptr);
+
+/**
+ * Create an empty representation payload that holds a reference to the arena.
+ */
+OCRepPayload* OCRepPayloadCreateInArena(OCPayloadArena* arena);
+
+/**
+ * Add a property, or reset the one with the same name, without looking at the value.
+ * A new property is allocated from the arena of the payload.
+ *
+ * @param payload   the representation.
+ * @param name      name of the property, allocated from the arena of the payload.  It is
+ *                  taken over, and freed if the property exists already or on failure.
+ * @param type      type the caller stores into the returned value.
+ *
+ * @return the property, NULL if out of memory.
+ */
+OCRepPayloadValue* OCRepPayloadAddValue(OCRepPayload* payload, char* name,
+        OCRepPayloadPropType type);
+
+/**
+ * Create an empty discovery payload that holds a reference to the arena.
+ */
+OCDiscoveryPayload* OCDiscoveryPayloadCreateInArena(OCPayloadArena* arena);
+
+/**
+ * Create an empty resource of a discovery payload that holds a reference to the arena.
+ */
+OCResourcePayload* OCResourcePayloadCreateInArena(OCPayloadArena* arena);
+
+/**
+ * Append a list node whose value is the string str, which it does not copy.
+ */
+bool OCStringLLAppendInArena(OCPayloadArena* arena, OCStringLL** list, char* str);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
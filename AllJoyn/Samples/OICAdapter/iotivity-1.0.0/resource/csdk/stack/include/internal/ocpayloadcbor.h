@@ -27,11 +27,52 @@
 extern "C"
 {
 #endif
+
+/**
+ * How OCParsePayload allocates representation and discovery payloads.
+ */
+typedef enum
+{
+    /** Every structure and string on its own from the heap. */
+    OC_PAYLOAD_PARSE_HEAP = 0,
+    /** All of a payload from one arena, see ocpayloadarena.h. */
+    OC_PAYLOAD_PARSE_ARENA,
+    /**
+     * From one arena, after a pass that validates the CBOR and indexes where its
+     * containers end, so that looking up keys and skipping values don't iterate over
+     * nested containers again.  The default.
+     */
+    OC_PAYLOAD_PARSE_INDEXED
+} OCPayloadParseMode;
+
+/**
+ * Select how payloads are allocated by the following calls of OCParsePayload.
+ */
+void OCSetPayloadParseMode(OCPayloadParseMode mode);
+
 OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadType type,
         const uint8_t* payload, size_t payloadSize);
 
 OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t* size);
 
+/**
+ * Encode a payload into a caller supplied buffer in a single pass.
+ *
+ * @param payload   Payload to encode.
+ * @param buffer    Destination buffer.  May be NULL if *size is 0.
+ * @param size      In: size of buffer.  Out: number of bytes written on success, or the
+ *                  exact number of bytes required if the buffer was too small.
+ *
+ * @return OC_STACK_OK on success, OC_STACK_NO_MEMORY if the buffer was too small.
+ *         Calling with a NULL buffer and a size of 0 therefore only computes the size.
+ */
+OCStackResult OCConvertPayloadToBuffer(OCPayload* payload, uint8_t* buffer, size_t* size);
+
+/**
+ * Release the encode arena kept by OCConvertPayload for the calling thread.
+ */
+void OCConvertPayloadReleaseArena();
+
 #ifdef __cplusplus
 }
 #endif
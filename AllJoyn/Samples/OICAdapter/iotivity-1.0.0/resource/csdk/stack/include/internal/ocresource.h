@@ -31,6 +31,7 @@
 
 #include "ocstackconfig.h"
 #include "occlientcb.h"
+#include "oic_hash.h"
 
 /** Macro Definitions for observers */
 
@@ -125,6 +126,19 @@ typedef struct ocactionset
     OCAction* head;
 } OCActionSet;
 
+/**
+ * Link of a resource type or interface binding into the name index of the stack.
+ */
+typedef struct resourceindexlink_t {
+
+    /** Resource the name is bound to.*/
+    struct OCResource *resource;
+
+    /** Previous and next binding of the same name; in binding order.*/
+    struct resourceindexlink_t *prev;
+    struct resourceindexlink_t *next;
+} OCResourceIndexLink;
+
 /**
  * Data structure for holding name and data types for each OIC resource.
  */
@@ -133,6 +147,9 @@ typedef struct resourcetype_t {
     /** linked list; for multiple types on resource. */
     struct resourcetype_t *next;
 
+    /** Link into the resource type index.*/
+    OCResourceIndexLink indexLink;
+
     /**
      * Name of the type; this string is ‘.’ (dot) separate list of segments where each segment is a
      * namespace and the final segment is the type; type and sub-types can be separate with
@@ -169,6 +186,9 @@ typedef struct resourceinterface_t {
     /** linked list; for multiple interfaces on resource.*/
     struct resourceinterface_t *next;
 
+    /** Link into the resource interface index.*/
+    OCResourceIndexLink indexLink;
+
     /** Name of the interface; this is ‘.’ (dot) separate list of segments where each segment is a
      * namespace and the final segment is the interface; usually only two segments would be
      * defined. Either way this string is opaque and not parsed by segment.*/
@@ -232,6 +252,17 @@ typedef struct OCResource {
 
     /** Pointer of ActionSet which to support group action.*/
     OCActionSet *actionsetHead;
+
+    /** Links in the URI and handle indexes.*/
+    OICHashLink_t uriLink;
+    OICHashLink_t handleLink;
+
+    /** Discovery payload fragment of the resource; dropped whenever its types or
+     *  interfaces change.*/
+    OCResourcePayload *discoveryFragment;
+
+    /** Observers of this resource; linked through ResourceObserver::resourceNext.*/
+    struct ResourceObserver *observers;
 } OCResource;
 
 
@@ -116,6 +116,45 @@ OCEntityHandlerResult defaultResourceEHandler(OCEntityHandlerFlag flag,
  */
 OCResource *FindResourceByUri(const char* resourceUri);
 
+/**
+ * Check that a handle refers to a resource in the resource list.
+ * @return pointer to the resource, or NULL if the handle is unknown.
+ */
+OCResource *FindResourceByHandle(OCResourceHandle handle);
+
+/**
+ * Add a resource to the URI and handle indexes.  The URI must be set.
+ * @return ::OC_STACK_OK for Success, otherwise some error value.
+ */
+OCStackResult AddResourceToIndex(OCResource *resource);
+
+/**
+ * Remove a resource and all of its type and interface bindings from the indexes,
+ * and drop its discovery payload fragment.
+ */
+void RemoveResourceFromIndex(OCResource *resource);
+
+/**
+ * Add a type binding of a resource to the resource type index.
+ */
+void IndexResourceType(OCResource *resource, OCResourceType *resourceType);
+
+/**
+ * Add an interface binding of a resource to the resource interface index.
+ */
+void IndexResourceInterface(OCResource *resource, OCResourceInterface *resourceInterface);
+
+/**
+ * Free the resource indexes.  All resources must have been removed.
+ */
+void DeleteResourceIndex();
+
+/**
+ * Drop the encoded responses to earlier discovery requests.  Called whenever something a
+ * discovery response is built from changes.
+ */
+void InvalidateDiscoveryResponses();
+
 /**
  * This function checks whether the specified resource URI aligns with a pre-existing
  * virtual resource; returns false otherwise.
@@ -37,6 +37,34 @@
  */
 typedef OCStackResult (* OCEHResponseHandler)(OCEntityHandlerResponse * ehResponse);
 
+/**
+ * An observer that receives a copy of a notification sent for another observer.
+ */
+typedef struct
+{
+    /** Token of the observe request.*/
+    uint8_t token[CA_MAX_TOKEN_LEN];
+
+    /** Token length.*/
+    uint8_t tokenLength;
+
+    /** Quality of service decided for this notification.*/
+    OCQualityOfService qos;
+} OCFanOutObserver;
+
+/**
+ * Observers sharing one notification.  The response to the server request is encoded
+ * once and sent to each of them with only the token and message type changed.
+ */
+typedef struct
+{
+    /** Number of observers.*/
+    uint16_t count;
+
+    /** Observers; allocated with the structure.*/
+    OCFanOutObserver observers[1];
+} OCObserverFanOut;
+
 /**
  * following structure will be created in occoap and passed up the stack on the server side.
  */
@@ -103,6 +131,9 @@ typedef struct OCServerRequest
     /** Flag indicating notification.*/
     uint8_t notificationFlag;
 
+    /** Further observers receiving the same notification; NULL for other requests.*/
+    OCObserverFanOut *fanOut;
+
     /** Payload Size.*/
     size_t payloadSize;
 
@@ -143,6 +174,20 @@ typedef struct OCServerResponse {
  */
 OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse);
 
+/**
+ * Handler function for sending a response whose payload the caller encoded already, such
+ * as a cached discovery response.  Like ::HandleSingleResponse it deletes the request.
+ *
+ * @param ehResponse      Pointer to the response; its payload is ignored.
+ * @param payload         CBOR encoded payload, which stays owned by the caller.
+ * @param payloadSize     Size of the payload.
+ *
+ * @return
+ *     ::OCStackResult
+ */
+OCStackResult HandleEncodedResponse(OCEntityHandlerResponse * ehResponse,
+                                    const uint8_t *payload, size_t payloadSize);
+
 /**
  * Handler function for sending a response from multiple resources, such as a collection.
  * Aggregates responses from multiple resource until all responses are received then sends the
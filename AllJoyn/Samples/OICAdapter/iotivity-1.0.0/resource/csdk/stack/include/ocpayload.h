@@ -118,6 +118,9 @@ void OCSecurityPayloadDestroy(OCSecurityPayload* payload);
 void OCDiscoveryPayloadAddResource(OCDiscoveryPayload* payload, const OCResource* res,
         uint16_t port);
 void OCDiscoveryPayloadAddNewResource(OCDiscoveryPayload* payload, OCResourcePayload* res);
+OCResourcePayload* OCDiscoveryResourceCreate(const OCResource* res, uint16_t port);
+// Frees the resource payload and every payload linked after it through next.
+void OCDiscoveryResourceDestroy(OCResourcePayload* payload);
 bool OCResourcePayloadAddResourceType(OCResourcePayload* payload, const char* resourceType);
 bool OCResourcePayloadAddInterface(OCResourcePayload* payload, const char* iface);
 
@@ -114,6 +114,40 @@ OCStackResult OCStopMulticastServer();
  */
 OCStackResult OCProcess();
 
+/**
+ * This function does the same as ::OCProcess and reports when the stack has timed work to
+ * do next, so that an event loop can block in ::OCWaitForEvents instead of polling.
+ *
+ * @param nextTimeout       Milliseconds until the next presence request, presence timeout,
+ *                          held back observer notification or expiry of a request without
+ *                          response is due, UINT32_MAX if there is none.  It is 0 while
+ *                          discovery responses from the cache wait to be handed over.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCProcessEvents(uint32_t *nextTimeout);
+
+/**
+ * This function blocks until a request or response has been received and is waiting for
+ * ::OCProcessEvents, ::OCSignalEvents is called or the timeout elapses. It must not be
+ * called while holding a lock that other threads need to call into the stack.
+ *
+ * @param timeout           Maximum time to wait in milliseconds, usually the one
+ *                          reported by ::OCProcessEvents.
+ *
+ * @return ::OC_STACK_OK if there is something to process, ::OC_STACK_TIMEOUT if the timeout
+ *         elapsed and ::OC_STACK_NOTIMPL if this build has to poll ::OCProcess.
+ */
+OCStackResult OCWaitForEvents(uint32_t timeout);
+
+/**
+ * This function wakes up the thread waiting in ::OCWaitForEvents, e.g. to stop it.
+ * If no thread is waiting, the next wait returns at once.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCSignalEvents();
+
 /**
  * This function discovers or Perform requests on a specified resource
  * (specified by that Resource's respective URI).
@@ -169,6 +203,20 @@ OCStackResult OCDoResource(OCDoHandle *handle,
 OCStackResult OCCancel(OCDoHandle handle, OCQualityOfService qos, OCHeaderOption * options,
         uint8_t numOptions);
 
+/**
+ * This function lets a unicast discovery (::OC_REST_DISCOVER with a destination) be answered
+ * by the response of the same server to an earlier discovery of the same URI, if that is not
+ * older than the given age.  The cached response is handed to the callback by the next
+ * ::OCProcess, as if the server had sent it.  Multicast discoveries are always sent, and
+ * their responses refresh the cache.  Responses of secure endpoints are not cached.
+ *
+ * @param maxAgeSeconds     Maximum age of a cached response, 0 (the default) to disable the
+ *                          cache and empty it.  ::OCStop disables it again.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCSetDiscoveryCacheMaxAge(uint32_t maxAgeSeconds);
+
 /**
  * Register Persistent storage callback.
  * @param   persistentStorageHandler  Pointers to open, read, write, close & unlink handlers.
@@ -179,6 +227,17 @@ OCStackResult OCCancel(OCDoHandle handle, OCQualityOfService qos, OCHeaderOption
  */
 OCStackResult OCRegisterPersistentStorageHandler(OCPersistentStorage* persistentStorageHandler);
 
+/**
+ * Register an optional rename handler for the persistent storage. If set, the open handler
+ * must honor the path; the SVR database is then written to a temporary file that replaces
+ * the database atomically.
+ * @param   renameHandler  Pointer to the rename handler, NULL to write the database in place.
+ *
+ * @return
+ *     OC_STACK_OK                    No errors; Success.
+ */
+OCStackResult OCRegisterPersistentStorageRenameHandler(OCPersistentStorageRename renameHandler);
+
 #ifdef WITH_PRESENCE
 /**
  * When operating in  OCServer or  OCClientServer mode,
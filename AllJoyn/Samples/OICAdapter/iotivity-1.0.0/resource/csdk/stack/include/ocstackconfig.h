@@ -80,4 +80,11 @@
  */
 #define MAX_CB_TIMEOUT_SECONDS   (2 * 60 * 60)  // 2 hours = 7200 seconds.
 
+/**
+ * Maximum number of notifications sent to a single observer per second.  Notifications
+ * above this rate are coalesced and the observer receives the latest representation once
+ * its window has passed.  Zero disables the limit.
+ */
+#define MAX_OBSERVER_NOTIFICATIONS_PER_SECOND (0)
+
 #endif //OCSTACK_CONFIG_H_
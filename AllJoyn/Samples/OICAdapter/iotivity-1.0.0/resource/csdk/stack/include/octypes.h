@@ -775,6 +775,12 @@ typedef struct {
     int (* unlink)(const char *path);
 } OCPersistentStorage;
 
+/**
+ * Optional persistent storage rename handler, registered separately with
+ * OCRegisterPersistentStorageRenameHandler so OCPersistentStorage keeps its layout.
+ */
+typedef int (* OCPersistentStorageRename)(const char *oldpath, const char *newpath);
+
 /**
  * Possible returned values from entity handler.
  */
@@ -980,6 +986,9 @@ typedef struct OCStringLL
     char* value;
 } OCStringLL;
 
+/** Block allocator a received payload is parsed into, opaque outside the stack. */
+struct OCPayloadArena;
+
 // used for get/set/put/observe/etc representations
 typedef struct OCRepPayload
 {
@@ -989,6 +998,14 @@ typedef struct OCRepPayload
     OCStringLL* interfaces;
     OCRepPayloadValue* values;
     struct OCRepPayload* next;
+    /** arena the payload was parsed into, NULL if it was built with the setters. */
+    struct OCPayloadArena* arena;
+    /** last of values and their number, maintained by the setters. */
+    OCRepPayloadValue* lastValue;
+    size_t valueCount;
+    /** hash index of values by name once there are many of them, else NULL. */
+    OCRepPayloadValue** valueIndex;
+    size_t valueIndexSize;
 } OCRepPayload;
 
 // used inside a discovery payload
@@ -1002,6 +1019,8 @@ typedef struct OCResourcePayload
     bool secure;
     uint16_t port;
     struct OCResourcePayload* next;
+    /** arena the resource was parsed into, NULL if it was allocated from the heap. */
+    struct OCPayloadArena* arena;
 } OCResourcePayload;
 
 /**
@@ -1093,6 +1112,8 @@ typedef struct
     OCResourcePayload *resources;
     /** This structure holds the collection response for the /oic/res. */
     OCResourceCollectionPayload *collectionResources;
+    /** Arena the payload was parsed into, NULL if it was allocated from the heap. */
+    struct OCPayloadArena *arena;
 } OCDiscoveryPayload;
 
 /**
@@ -0,0 +1,297 @@
+//******************************************************************
+//
+// Copyright 2014 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+// Load generator measuring how many discovery responses and GET/PUT
+// responses per second a server (e.g. ocserver) sustains. A fixed window
+// of discoveries or requests is kept outstanding; each response issues
+// the next one.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <time.h>
+#include <iostream>
+#include "ocstack.h"
+#include "logger.h"
+#include "occlientload.h"
+#include "ocpayload.h"
+
+static int TestCase = TEST_DISCOVERY_LOAD;
+static int Duration = DEFAULT_DURATION_SEC;
+static int Window = DEFAULT_WINDOW;
+static OCQualityOfService Qos = OC_LOW_QOS;
+static const char *ServerAddr = "";
+
+static std::string coapServerResource = "/a/light";
+static const char *RESOURCE_DISCOVERY_QUERY = "%s/oic/res";
+
+static OCDevAddr endpoint;
+static bool endpointFound = false;
+
+static uint64_t responses = 0;
+static uint64_t requests = 0;
+static uint64_t errors = 0;
+static uint64_t totalLatencyUs = 0;
+
+int gQuitFlag = 0;
+
+/* SIGINT handler: set gQuitFlag to 1 for graceful termination */
+void handleSigInt(int signum)
+{
+    if (signum == SIGINT)
+    {
+        gQuitFlag = 1;
+    }
+}
+
+static uint64_t getTimeUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void PrintUsage()
+{
+    OC_LOG(INFO, TAG, "Usage : occlientload -t <1|2|3> -d <sec> -w <window> -q <0|1> -a <addr>");
+    OC_LOG(INFO, TAG, "-t 1 : Discovery load, count /oic/res responses");
+    OC_LOG(INFO, TAG, "-t 2 : Discover once, then GET load on /a/light");
+    OC_LOG(INFO, TAG, "-t 3 : Discover once, then PUT load on /a/light");
+    OC_LOG(INFO, TAG, "-d <sec> : duration of the measurement (default 10)");
+    OC_LOG(INFO, TAG, "-w <n> : outstanding discoveries or requests (default 16)");
+    OC_LOG(INFO, TAG, "-q 0 : Nonconfirmable requests, -q 1 : Confirmable requests");
+    OC_LOG(INFO, TAG, "-a <addr> : unicast discovery to ip:port instead of multicast");
+}
+
+static void deleteContext(void *ctx)
+{
+    delete (uint64_t *)ctx;
+}
+
+static void countResponse(void *ctx, OCClientResponse *clientResponse)
+{
+    if (!clientResponse || clientResponse->result > OC_STACK_RESOURCE_DELETED)
+    {
+        errors++;
+        return;
+    }
+
+    responses++;
+    if (ctx)
+    {
+        totalLatencyUs += getTimeUs() - *(uint64_t *)ctx;
+    }
+}
+
+OCPayload* putPayload()
+{
+    OCRepPayload* payload = OCRepPayloadCreate();
+
+    if(!payload)
+    {
+        std::cout << "Failed to create put payload object"<<std::endl;
+        std::exit(1);
+    }
+
+    OCRepPayloadSetPropInt(payload, "power", 15);
+    OCRepPayloadSetPropBool(payload, "state", true);
+
+    return (OCPayload*) payload;
+}
+
+OCStackApplicationResult requestCB(void* ctx, OCDoHandle /*handle*/,
+        OCClientResponse * clientResponse)
+{
+    countResponse(ctx, clientResponse);
+
+    if (!gQuitFlag)
+    {
+        SendRequest();
+    }
+    return OC_STACK_DELETE_TRANSACTION;
+}
+
+OCStackApplicationResult discoveryReqCB(void* ctx, OCDoHandle /*handle*/,
+        OCClientResponse * clientResponse)
+{
+    if (TestCase != TEST_DISCOVERY_LOAD)
+    {
+        if (clientResponse && !endpointFound)
+        {
+            OC_LOG_V(INFO, TAG, "Discovered @ %s:%u",
+                    clientResponse->devAddr.addr, clientResponse->devAddr.port);
+            endpoint = clientResponse->devAddr;
+            endpointFound = true;
+        }
+        return OC_STACK_DELETE_TRANSACTION;
+    }
+
+    countResponse(ctx, clientResponse);
+
+    if (!gQuitFlag)
+    {
+        SendDiscovery();
+    }
+    return OC_STACK_DELETE_TRANSACTION;
+}
+
+OCStackResult SendDiscovery()
+{
+    char queryUri[200];
+    snprintf(queryUri, sizeof (queryUri), RESOURCE_DISCOVERY_QUERY, ServerAddr);
+
+    OCCallbackData cbData;
+    cbData.cb = discoveryReqCB;
+    cbData.context = new uint64_t(getTimeUs());
+    cbData.cd = deleteContext;
+
+    OCStackResult ret = OCDoResource(NULL, OC_REST_DISCOVER, queryUri, 0, 0, CT_DEFAULT,
+                                     OC_LOW_QOS, &cbData, NULL, 0);
+    if (ret != OC_STACK_OK)
+    {
+        OC_LOG_V(ERROR, TAG, "OCDoResource returns error %d for discovery", ret);
+        deleteContext(cbData.context);
+        errors++;
+    }
+    requests++;
+    return ret;
+}
+
+OCStackResult SendRequest()
+{
+    OCMethod method = (TestCase == TEST_PUT_LOAD) ? OC_REST_PUT : OC_REST_GET;
+
+    OCCallbackData cbData;
+    cbData.cb = requestCB;
+    cbData.context = new uint64_t(getTimeUs());
+    cbData.cd = deleteContext;
+
+    OCStackResult ret = OCDoResource(NULL, method, coapServerResource.c_str(), &endpoint,
+                                     (method == OC_REST_PUT) ? putPayload() : NULL,
+                                     CT_ADAPTER_IP, Qos, &cbData, NULL, 0);
+    if (ret != OC_STACK_OK)
+    {
+        OC_LOG_V(ERROR, TAG, "OCDoResource returns error %d with method %d", ret, method);
+        deleteContext(cbData.context);
+        errors++;
+    }
+    requests++;
+    return ret;
+}
+
+static bool ProcessUntil(uint64_t deadline, bool *condition)
+{
+    while (!gQuitFlag && getTimeUs() < deadline && !(condition && *condition))
+    {
+        if (OCProcess() != OC_STACK_OK)
+        {
+            OC_LOG(ERROR, TAG, "OCStack process error");
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:d:w:q:a:")) != -1)
+    {
+        switch(opt)
+        {
+            case 't':
+                TestCase = atoi(optarg);
+                break;
+            case 'd':
+                Duration = atoi(optarg);
+                break;
+            case 'w':
+                Window = atoi(optarg);
+                break;
+            case 'q':
+                Qos = atoi(optarg) ? OC_HIGH_QOS : OC_LOW_QOS;
+                break;
+            case 'a':
+                ServerAddr = optarg;
+                break;
+            default:
+                PrintUsage();
+                return -1;
+        }
+    }
+
+    if ((TestCase < TEST_DISCOVERY_LOAD || TestCase >= MAX_TESTS) ||
+            (Duration <= 0) || (Window <= 0 || Window > MAX_WINDOW))
+    {
+        PrintUsage();
+        return -1;
+    }
+
+    /* Initialize OCStack*/
+    if (OCInit(NULL, 0, OC_CLIENT) != OC_STACK_OK)
+    {
+        OC_LOG(ERROR, TAG, "OCStack init error");
+        return 0;
+    }
+
+    signal(SIGINT, handleSigInt);
+
+    if (TestCase != TEST_DISCOVERY_LOAD)
+    {
+        SendDiscovery();
+        ProcessUntil(getTimeUs() + 5000000, &endpointFound);
+        if (!endpointFound)
+        {
+            OC_LOG(ERROR, TAG, "No server found");
+            OCStop();
+            return 0;
+        }
+        requests = 0;
+        errors = 0;
+    }
+
+    uint64_t start = getTimeUs();
+    for (int i = 0; i < Window; i++)
+    {
+        (TestCase == TEST_DISCOVERY_LOAD) ? SendDiscovery() : SendRequest();
+    }
+    ProcessUntil(start + (uint64_t)Duration * 1000000, NULL);
+    uint64_t elapsed = getTimeUs() - start;
+
+    gQuitFlag = 1;
+    printf("%s load: %llu requests, %llu responses, %llu errors in %.2f sec\n",
+           (TestCase == TEST_DISCOVERY_LOAD) ? "discovery" :
+           (TestCase == TEST_GET_LOAD) ? "GET" : "PUT",
+           (unsigned long long)requests, (unsigned long long)responses,
+           (unsigned long long)errors, elapsed / 1000000.0);
+    printf("throughput: %.1f responses/sec, mean latency: %.1f usec\n",
+           responses * 1000000.0 / elapsed,
+           responses ? (double)totalLatencyUs / responses : 0.0);
+
+    if (OCStop() != OC_STACK_OK)
+    {
+        OC_LOG(ERROR, TAG, "OCStack stop error");
+    }
+
+    return 0;
+}
@@ -23,6 +23,7 @@
 #include "utlist.h"
 #include "logger.h"
 #include "oic_malloc.h"
+#include <stddef.h>
 #include <string.h>
 
 #ifdef WITH_ARDUINO
@@ -42,9 +43,144 @@
 /// Module Name
 #define TAG "occlientcb"
 
+/** Initial number of entries of the TTL heap.*/
+#define CLIENTCB_TTL_HEAP_INIT_SIZE (32)
+
 struct ClientCB *cbList = NULL;
 static OCMulticastNode * mcPresenceNodes = NULL;
 
+// Callbacks hashed by token, by handle, by their own address and, for presence, by uri.
+static OICHashTable_t g_tokenIndex;
+static OICHashTable_t g_handleIndex;
+static OICHashTable_t g_nodeIndex;
+static OICHashTable_t g_uriIndex;
+
+// Binary min-heap of the callbacks with a TTL.  It has room for every callback, so that
+// giving one a TTL never fails.
+static ClientCB **g_ttlHeap = NULL;
+static size_t g_ttlHeapCount = 0;
+static size_t g_ttlHeapCapacity = 0;
+
+static OCClientCBStats g_cbStats = { 0, 0, 0 };
+
+static bool IsPresenceCB(const ClientCB *cbNode)
+{
+    return cbNode->method == OC_REST_PRESENCE && cbNode->requestUri;
+}
+
+static void InsertClientCBIndex(ClientCB *cbNode)
+{
+    OICHashTableInsert(&g_tokenIndex, &cbNode->tokenLink,
+                       OICHashBytes(cbNode->token, cbNode->tokenLength));
+    OICHashTableInsert(&g_handleIndex, &cbNode->handleLink, OICHashPointer(cbNode->handle));
+    OICHashTableInsert(&g_nodeIndex, &cbNode->nodeLink, OICHashPointer(cbNode));
+    if (IsPresenceCB(cbNode))
+    {
+        OICHashTableInsert(&g_uriIndex, &cbNode->uriLink, OICHashString(cbNode->requestUri));
+    }
+}
+
+/*
+ * Makes room in the indexes and the TTL heap for one more callback.
+ */
+static bool ReserveClientCB()
+{
+    // A full index still works, only with longer chains.
+    size_t count = g_cbStats.liveCallbacks + 1;
+    if (!OICHashTableReserve(&g_tokenIndex, count) ||
+        !OICHashTableReserve(&g_handleIndex, count) ||
+        !OICHashTableReserve(&g_nodeIndex, count) ||
+        !OICHashTableReserve(&g_uriIndex, count))
+    {
+        return false;
+    }
+
+    if (g_cbStats.liveCallbacks >= g_ttlHeapCapacity)
+    {
+        size_t capacity = g_ttlHeapCapacity ? g_ttlHeapCapacity * 2 : CLIENTCB_TTL_HEAP_INIT_SIZE;
+        ClientCB **heap = (ClientCB **) OICRealloc(g_ttlHeap, capacity * sizeof(ClientCB *));
+        if (!heap)
+        {
+            return false;
+        }
+        g_ttlHeap = heap;
+        g_ttlHeapCapacity = capacity;
+    }
+    return true;
+}
+
+static void UnindexClientCB(ClientCB *cbNode)
+{
+    OICHashTableRemove(&g_tokenIndex, &cbNode->tokenLink);
+    OICHashTableRemove(&g_handleIndex, &cbNode->handleLink);
+    OICHashTableRemove(&g_nodeIndex, &cbNode->nodeLink);
+    OICHashTableRemove(&g_uriIndex, &cbNode->uriLink);
+}
+
+static void SetTTLHeapNode(size_t index, ClientCB *cbNode)
+{
+    g_ttlHeap[index] = cbNode;
+    cbNode->ttlHeapIndex = index;
+}
+
+static void SiftUpTTLHeap(size_t index)
+{
+    ClientCB *cbNode = g_ttlHeap[index];
+    while (index > 0)
+    {
+        size_t parent = (index - 1) / 2;
+        if (g_ttlHeap[parent]->TTL <= cbNode->TTL)
+        {
+            break;
+        }
+        SetTTLHeapNode(index, g_ttlHeap[parent]);
+        index = parent;
+    }
+    SetTTLHeapNode(index, cbNode);
+}
+
+static void SiftDownTTLHeap(size_t index)
+{
+    ClientCB *cbNode = g_ttlHeap[index];
+    while (true)
+    {
+        size_t child = 2 * index + 1;
+        if (child >= g_ttlHeapCount)
+        {
+            break;
+        }
+        if (child + 1 < g_ttlHeapCount && g_ttlHeap[child + 1]->TTL < g_ttlHeap[child]->TTL)
+        {
+            child++;
+        }
+        if (cbNode->TTL <= g_ttlHeap[child]->TTL)
+        {
+            break;
+        }
+        SetTTLHeapNode(index, g_ttlHeap[child]);
+        index = child;
+    }
+    SetTTLHeapNode(index, cbNode);
+}
+
+static void RemoveFromTTLHeap(ClientCB *cbNode)
+{
+    size_t index = cbNode->ttlHeapIndex;
+    if (index == CLIENTCB_NOT_IN_HEAP)
+    {
+        return;
+    }
+
+    cbNode->ttlHeapIndex = CLIENTCB_NOT_IN_HEAP;
+    ClientCB *last = g_ttlHeap[--g_ttlHeapCount];
+    if (last != cbNode)
+    {
+        SetTTLHeapNode(index, last);
+        SiftUpTTLHeap(index);
+        SiftDownTTLHeap(last->ttlHeapIndex);
+    }
+}
+
 OCStackResult
 AddClientCB (ClientCB** clientCB, OCCallbackData* cbData,
              CAToken_t token, uint8_t tokenLength,
@@ -68,7 +204,10 @@ AddClientCB (ClientCB** clientCB, OCCallbackData* cbData,
 
     if(!cbNode)// If it does not already exist, create new node.
     {
-        cbNode = (ClientCB*) OICMalloc(sizeof(ClientCB));
+        if (ReserveClientCB())
+        {
+            cbNode = (ClientCB*) OICCalloc(1, sizeof(ClientCB));
+        }
         if(!cbNode)
         {
             *clientCB = NULL;
@@ -105,8 +244,17 @@ AddClientCB (ClientCB** clientCB, OCCallbackData* cbData,
             }
             cbNode->requestUri = requestUri;    // I own it now
             cbNode->devAddr = devAddr;          // I own it now
+            cbNode->ttlHeapIndex = CLIENTCB_NOT_IN_HEAP;
             OC_LOG_V(INFO, TAG, "Added Callback for uri : %s", requestUri);
-            LL_APPEND(cbList, cbNode);
+            DL_APPEND(cbList, cbNode);
+            InsertClientCBIndex(cbNode);
+            UpdateClientCBTTL(cbNode, cbNode->TTL);
+
+            g_cbStats.liveCallbacks++;
+            if (g_cbStats.liveCallbacks > g_cbStats.peakCallbacks)
+            {
+                g_cbStats.peakCallbacks = g_cbStats.liveCallbacks;
+            }
             *clientCB = cbNode;
         }
     }
@@ -153,7 +301,10 @@ void DeleteClientCB(ClientCB * cbNode)
 {
     if(cbNode)
     {
-        LL_DELETE(cbList, cbNode);
+        UnindexClientCB(cbNode);
+        RemoveFromTTLHeap(cbNode);
+        DL_DELETE(cbList, cbNode);
+        g_cbStats.liveCallbacks--;
         OC_LOG (INFO, TAG, "Deleting token");
         OC_LOG_BUFFER(INFO, TAG, (const uint8_t *)cbNode->token, cbNode->tokenLength);
         CADestroyToken (cbNode->token);
@@ -190,56 +341,9 @@ void DeleteClientCB(ClientCB * cbNode)
     }
 }
 
-/*
- * This function checks if the node is past its time to live and
- * deletes it if timed-out. Calling this function with a  presence or observe
- * callback with ttl set to 0 will not delete anything as presence nodes have
- * their own mechanisms for timeouts. A null argument will cause the function to
- * silently return.
- */
-static void CheckAndDeleteTimedOutCB(ClientCB* cbNode)
-{
-    if (!cbNode)
-    {
-        return;
-    }
-    if (cbNode->TTL == 0)
-    {
-        return;
-    }
-    coap_tick_t now;
-    coap_ticks(&now);
-
-    if (cbNode->TTL < now)
-    {
-        OC_LOG(INFO, TAG, "Deleting timed-out callback");
-        DeleteClientCB(cbNode);
-    }
-}
-
 bool ClientTokenExist(const CAToken_t token, uint8_t tokenLength)
 {
-    bool bRet = false;
-    ClientCB* out = NULL;
-
-    if (token && *token && tokenLength <= CA_MAX_TOKEN_LEN && tokenLength > 0)
-    {
-        OC_LOG(INFO, TAG, "Looking for token");
-        OC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
-        OC_LOG(INFO, TAG, "\tFound in callback list");
-        LL_FOREACH(cbList, out)
-        {
-            OC_LOG_BUFFER(INFO, TAG, (const uint8_t *)out->token, tokenLength);
-
-            if (memcmp(out->token, token, tokenLength) == 0)
-            {
-                bRet = true;
-                break;
-            }
-        }
-    }
-
-    return bRet;
+    return GetClientCB(token, tokenLength, NULL, NULL) != NULL;
 }
 
 ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
@@ -247,51 +351,132 @@ ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
 {
 
     ClientCB* out = NULL;
+    OICHashLink_t *link = NULL;
 
-    if(token && *token && tokenLength <= CA_MAX_TOKEN_LEN && tokenLength > 0)
+    if(token && tokenLength <= CA_MAX_TOKEN_LEN && tokenLength > 0)
     {
         OC_LOG (INFO, TAG,  "Looking for token");
         OC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
-        OC_LOG(INFO, TAG, "\tFound in callback list");
-        LL_FOREACH(cbList, out)
+        for (link = OICHashTableFind(&g_tokenIndex, OICHashBytes(token, tokenLength)); link;
+             link = OICHashTableFindNext(link))
         {
-            OC_LOG_BUFFER(INFO, TAG, (const uint8_t *)out->token, tokenLength);
-
-            if(memcmp(out->token, token, tokenLength) == 0)
+            out = OIC_HASH_ENTRY(link, ClientCB, tokenLink);
+            if(out->tokenLength == tokenLength && memcmp(out->token, token, tokenLength) == 0)
             {
+                OC_LOG(INFO, TAG, "\tFound in callback list");
                 return out;
             }
-            CheckAndDeleteTimedOutCB(out);
         }
     }
     else if(handle)
     {
-        LL_FOREACH(cbList, out)
+        for (link = OICHashTableFind(&g_handleIndex, OICHashPointer(handle)); link;
+             link = OICHashTableFindNext(link))
         {
+            out = OIC_HASH_ENTRY(link, ClientCB, handleLink);
             if(out->handle == handle)
             {
                 return out;
             }
-            CheckAndDeleteTimedOutCB(out);
         }
     }
     else if(requestUri)
     {
         OC_LOG_V(INFO, TAG, "Looking for uri %s", requestUri);
-        LL_FOREACH(cbList, out)
+        for (link = OICHashTableFind(&g_uriIndex, OICHashString(requestUri)); link;
+             link = OICHashTableFindNext(link))
         {
-            OC_LOG_V(INFO, TAG, "\tFound %s", out->requestUri);
-            if(out->requestUri && strcmp(out->requestUri, requestUri ) == 0)
+            out = OIC_HASH_ENTRY(link, ClientCB, uriLink);
+            if(strcmp(out->requestUri, requestUri) == 0)
             {
+                OC_LOG_V(INFO, TAG, "\tFound %s", out->requestUri);
                 return out;
             }
-            CheckAndDeleteTimedOutCB(out);
         }
     }
     OC_LOG(INFO, TAG, "Callback Not found !!");
     return NULL;
 }
 
+void UpdateClientCBTTL(ClientCB * cbNode, uint32_t ttl)
+{
+    if (!cbNode)
+    {
+        return;
+    }
+
+    uint32_t oldTTL = cbNode->TTL;
+    cbNode->TTL = ttl;
+    if (ttl == 0)
+    {
+        RemoveFromTTLHeap(cbNode);
+    }
+    else if (cbNode->ttlHeapIndex == CLIENTCB_NOT_IN_HEAP)
+    {
+        g_ttlHeapCount++;
+        SetTTLHeapNode(g_ttlHeapCount - 1, cbNode);
+        SiftUpTTLHeap(cbNode->ttlHeapIndex);
+    }
+    else if (ttl < oldTTL)
+    {
+        SiftUpTTLHeap(cbNode->ttlHeapIndex);
+    }
+    else
+    {
+        SiftDownTTLHeap(cbNode->ttlHeapIndex);
+    }
+}
+
+/*
+ * Presence and observe callbacks have a TTL of 0 and are not in the heap, as presence nodes
+ * have their own mechanisms for timeouts and observes can be explicitly cancelled.
+ */
+void DeleteTimedOutClientCBs()
+{
+    if (!g_ttlHeapCount)
+    {
+        return;
+    }
+
+    coap_tick_t now;
+    coap_ticks(&now);
+
+    while (g_ttlHeapCount && g_ttlHeap[0]->TTL < now)
+    {
+        OC_LOG(INFO, TAG, "Deleting timed-out callback");
+        g_cbStats.timedOutCallbacks++;
+        DeleteClientCB(g_ttlHeap[0]);
+    }
+}
+
+uint32_t GetClientCBTimeout()
+{
+    if (!g_ttlHeapCount)
+    {
+        return UINT32_MAX;
+    }
+
+    coap_tick_t now;
+    coap_ticks(&now);
+
+    // a callback times out once now is past its TTL
+    if (g_ttlHeap[0]->TTL < now)
+    {
+        return 0;
+    }
+    uint64_t ticks = (uint64_t)g_ttlHeap[0]->TTL - now + 1;
+    uint64_t timeout = (ticks * 1000 + COAP_TICKS_PER_SECOND - 1) / COAP_TICKS_PER_SECOND;
+    return (timeout < UINT32_MAX) ? (uint32_t)timeout : UINT32_MAX;
+}
+
+void GetClientCBStats(OCClientCBStats *stats)
+{
+    if (stats)
+    {
+        *stats = g_cbStats;
+    }
+}
+
 #ifdef WITH_PRESENCE
 OCStackResult InsertResourceTypeFilter(ClientCB * cbNode, char * resourceTypeName)
 {
@@ -324,15 +509,30 @@ void DeleteClientCBList()
         DeleteClientCB(out);
     }
     cbList = NULL;
+
+    OICHashTableClear(&g_tokenIndex);
+    OICHashTableClear(&g_handleIndex);
+    OICHashTableClear(&g_nodeIndex);
+    OICHashTableClear(&g_uriIndex);
+
+    OICFree(g_ttlHeap);
+    g_ttlHeap = NULL;
+    g_ttlHeapCount = 0;
+    g_ttlHeapCapacity = 0;
+
+    g_cbStats.peakCallbacks = 0;
+    g_cbStats.timedOutCallbacks = 0;
 }
 
 void FindAndDeleteClientCB(ClientCB * cbNode)
 {
-    ClientCB* tmp;
     if(cbNode)
     {
-        LL_FOREACH(cbList, tmp)
+        // cbNode may be gone already, so it is only compared
+        for (OICHashLink_t *link = OICHashTableFind(&g_nodeIndex, OICHashPointer(cbNode)); link;
+             link = OICHashTableFindNext(link))
         {
+            ClientCB *tmp = OIC_HASH_ENTRY(link, ClientCB, nodeLink);
             if (cbNode == tmp)
             {
                 DeleteClientCB(tmp);
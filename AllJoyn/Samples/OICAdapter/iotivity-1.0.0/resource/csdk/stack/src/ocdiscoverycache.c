@@ -0,0 +1,361 @@
+//******************************************************************
+//
+// Copyright 2015 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "ocdiscoverycache.h"
+#include "logger.h"
+#include "oic_malloc.h"
+#include "oic_string.h"
+#include "oic_hash.h"
+#include <string.h>
+
+#ifdef WITH_ARDUINO
+#include "Time.h"
+#else
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#else
+#include <time.h>
+#endif
+#endif
+#include "coap_time.h"
+
+/// Module Name
+#define TAG "ocdiscoverycache"
+
+/** Most responses kept; the oldest one is dropped to make room for another.*/
+#define DISCOVERY_CACHE_MAX_ENTRIES (4096)
+
+/**
+ * Response of one server to the discovery of one URI.
+ */
+typedef struct OCDiscoveryEntry
+{
+    OCDevAddr devAddr;
+    char *requestUri;
+    char *resourceUri;
+    uint8_t *payload;
+    size_t payloadSize;
+
+    /** time in coap ticks at which the response is too old.*/
+    coap_tick_t expiry;
+
+    /** link in the cache, hashed by server and request URI.*/
+    OICHashLink_t link;
+
+    /** previous and next entry in the order they were stored.*/
+    struct OCDiscoveryEntry *older;
+    struct OCDiscoveryEntry *newer;
+} OCDiscoveryEntry;
+
+static uint32_t g_maxAgeSeconds = 0;
+
+static OICHashTable_t g_cache;
+static OCDiscoveryEntry *g_oldest = NULL;
+static OCDiscoveryEntry *g_newest = NULL;
+
+static OCDiscoveryDelivery *g_deliveries = NULL;
+static OCDiscoveryDelivery *g_lastDelivery = NULL;
+
+static OCDiscoveryCacheStats g_stats = { 0, 0, 0, 0 };
+
+static uint32_t HashDiscoveryKey(const OCDevAddr *devAddr, const char *requestUri)
+{
+    uint32_t hash = OICHashBytes(devAddr->addr, strlen(devAddr->addr));
+    hash = OICHashAppend(hash, &devAddr->port, sizeof(devAddr->port));
+    return OICHashAppend(hash, requestUri, strlen(requestUri));
+}
+
+static bool IsSameServer(const OCDevAddr *a, const OCDevAddr *b)
+{
+    return a->adapter == b->adapter && a->port == b->port && strcmp(a->addr, b->addr) == 0;
+}
+
+static OCDiscoveryEntry *FindDiscoveryEntry(const OCDevAddr *devAddr, const char *requestUri,
+                                            uint32_t hash)
+{
+    for (OICHashLink_t *link = OICHashTableFind(&g_cache, hash); link;
+         link = OICHashTableFindNext(link))
+    {
+        OCDiscoveryEntry *entry = OIC_HASH_ENTRY(link, OCDiscoveryEntry, link);
+        if (IsSameServer(&entry->devAddr, devAddr) && strcmp(entry->requestUri, requestUri) == 0)
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void UnlinkDiscoveryEntry(OCDiscoveryEntry *entry)
+{
+    OICHashTableRemove(&g_cache, &entry->link);
+
+    if (entry->older)
+    {
+        entry->older->newer = entry->newer;
+    }
+    else
+    {
+        g_oldest = entry->newer;
+    }
+    if (entry->newer)
+    {
+        entry->newer->older = entry->older;
+    }
+    else
+    {
+        g_newest = entry->older;
+    }
+    entry->older = NULL;
+    entry->newer = NULL;
+}
+
+static void FreeDiscoveryEntry(OCDiscoveryEntry *entry)
+{
+    OICFree(entry->requestUri);
+    OICFree(entry->resourceUri);
+    OICFree(entry->payload);
+    OICFree(entry);
+}
+
+static void DeleteDiscoveryEntry(OCDiscoveryEntry *entry)
+{
+    UnlinkDiscoveryEntry(entry);
+    FreeDiscoveryEntry(entry);
+    g_stats.entries--;
+}
+
+static void DeleteDiscoveryEntries()
+{
+    OCDiscoveryEntry *entry = g_oldest;
+    while (entry)
+    {
+        OCDiscoveryEntry *newer = entry->newer;
+        FreeDiscoveryEntry(entry);
+        entry = newer;
+    }
+    OICHashTableClear(&g_cache);
+    g_oldest = NULL;
+    g_newest = NULL;
+    g_stats.entries = 0;
+}
+
+/*
+ * Entries are stored with the same maximum age, so the expired ones are the oldest ones,
+ * unless the maximum age was lowered.  Those are dropped when they are looked up.
+ */
+static void DeleteExpiredDiscoveryEntries(coap_tick_t now)
+{
+    while (g_oldest && g_oldest->expiry <= now)
+    {
+        DeleteDiscoveryEntry(g_oldest);
+        g_stats.expired++;
+    }
+}
+
+void SetDiscoveryCacheMaxAge(uint32_t maxAgeSeconds)
+{
+    g_maxAgeSeconds = maxAgeSeconds;
+    if (!maxAgeSeconds)
+    {
+        DeleteDiscoveryEntries();
+    }
+}
+
+void StoreDiscoveryResponse(const OCDevAddr *devAddr, const char *requestUri,
+                            const char *resourceUri, const uint8_t *payload, size_t payloadSize)
+{
+    if (!g_maxAgeSeconds || !devAddr || !requestUri || !payload || !payloadSize)
+    {
+        return;
+    }
+
+    // Whether the server is still the one that was authenticated is not known to the cache.
+    if (devAddr->flags & OC_FLAG_SECURE)
+    {
+        return;
+    }
+
+    coap_tick_t now;
+    coap_ticks(&now);
+    DeleteExpiredDiscoveryEntries(now);
+
+    uint32_t hash = HashDiscoveryKey(devAddr, requestUri);
+    OCDiscoveryEntry *entry = FindDiscoveryEntry(devAddr, requestUri, hash);
+    if (entry)
+    {
+        UnlinkDiscoveryEntry(entry);
+        OICFree(entry->resourceUri);
+        OICFree(entry->payload);
+        entry->resourceUri = NULL;
+        entry->payload = NULL;
+    }
+    else
+    {
+        if (g_stats.entries >= DISCOVERY_CACHE_MAX_ENTRIES)
+        {
+            DeleteDiscoveryEntry(g_oldest);
+        }
+        if (!OICHashTableReserve(&g_cache, g_stats.entries + 1))
+        {
+            return;
+        }
+
+        entry = (OCDiscoveryEntry *) OICCalloc(1, sizeof(OCDiscoveryEntry));
+        if (!entry)
+        {
+            return;
+        }
+        entry->devAddr = *devAddr;
+        entry->requestUri = OICStrdup(requestUri);
+        g_stats.entries++;
+    }
+
+    entry->resourceUri = resourceUri ? OICStrdup(resourceUri) : NULL;
+    entry->payload = (uint8_t *) OICMalloc(payloadSize);
+    if (!entry->requestUri || (resourceUri && !entry->resourceUri) || !entry->payload)
+    {
+        OC_LOG(ERROR, TAG, "Out of memory caching a discovery response");
+        FreeDiscoveryEntry(entry);
+        g_stats.entries--;
+        return;
+    }
+    memcpy(entry->payload, payload, payloadSize);
+    entry->payloadSize = payloadSize;
+    entry->expiry = now + (coap_tick_t)g_maxAgeSeconds * COAP_TICKS_PER_SECOND;
+
+    OICHashTableInsert(&g_cache, &entry->link, hash);
+    entry->older = g_newest;
+    if (g_newest)
+    {
+        g_newest->newer = entry;
+    }
+    else
+    {
+        g_oldest = entry;
+    }
+    g_newest = entry;
+}
+
+bool QueueCachedDiscoveryResponse(const OCDevAddr *devAddr, const char *requestUri,
+                                  const CAToken_t token, uint8_t tokenLength)
+{
+    if (!g_maxAgeSeconds || !devAddr || !requestUri || !token ||
+        tokenLength > CA_MAX_TOKEN_LEN)
+    {
+        return false;
+    }
+
+    coap_tick_t now;
+    coap_ticks(&now);
+    DeleteExpiredDiscoveryEntries(now);
+
+    OCDiscoveryEntry *entry = FindDiscoveryEntry(devAddr, requestUri,
+                                                 HashDiscoveryKey(devAddr, requestUri));
+    if (entry && entry->expiry <= now)
+    {
+        DeleteDiscoveryEntry(entry);
+        g_stats.expired++;
+        entry = NULL;
+    }
+    if (!entry)
+    {
+        g_stats.misses++;
+        return false;
+    }
+
+    OCDiscoveryDelivery *delivery =
+        (OCDiscoveryDelivery *) OICCalloc(1, sizeof(OCDiscoveryDelivery));
+    if (!delivery)
+    {
+        return false;
+    }
+    delivery->devAddr = entry->devAddr;
+    delivery->resourceUri = entry->resourceUri ? OICStrdup(entry->resourceUri) : NULL;
+    delivery->payload = (uint8_t *) OICMalloc(entry->payloadSize);
+    if ((entry->resourceUri && !delivery->resourceUri) || !delivery->payload)
+    {
+        DeleteDiscoveryDelivery(delivery);
+        return false;
+    }
+    memcpy(delivery->payload, entry->payload, entry->payloadSize);
+    delivery->payloadSize = entry->payloadSize;
+    memcpy(delivery->token, token, tokenLength);
+    delivery->tokenLength = tokenLength;
+
+    if (g_lastDelivery)
+    {
+        g_lastDelivery->next = delivery;
+    }
+    else
+    {
+        g_deliveries = delivery;
+    }
+    g_lastDelivery = delivery;
+
+    g_stats.hits++;
+    return true;
+}
+
+bool HasCachedDiscoveryDeliveries()
+{
+    return g_deliveries != NULL;
+}
+
+OCDiscoveryDelivery *TakeCachedDiscoveryDeliveries()
+{
+    OCDiscoveryDelivery *deliveries = g_deliveries;
+    g_deliveries = NULL;
+    g_lastDelivery = NULL;
+    return deliveries;
+}
+
+void DeleteDiscoveryDelivery(OCDiscoveryDelivery *delivery)
+{
+    if (delivery)
+    {
+        OICFree(delivery->resourceUri);
+        OICFree(delivery->payload);
+        OICFree(delivery);
+    }
+}
+
+void GetDiscoveryCacheStats(OCDiscoveryCacheStats *stats)
+{
+    if (stats)
+    {
+        *stats = g_stats;
+    }
+}
+
+void DeleteDiscoveryCache()
+{
+    DeleteDiscoveryEntries();
+
+    OCDiscoveryDelivery *delivery = TakeCachedDiscoveryDeliveries();
+    while (delivery)
+    {
+        OCDiscoveryDelivery *next = delivery->next;
+        DeleteDiscoveryDelivery(delivery);
+        delivery = next;
+    }
+
+    g_maxAgeSeconds = 0;
+    memset(&g_stats, 0, sizeof(g_stats));
+}
@@ -34,6 +34,17 @@
 #include "utlist.h"
 #include "pdu.h"
 
+#ifdef WITH_ARDUINO
+#include "Time.h"
+#else
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#else
+#include <time.h>
+#endif
+#endif
+#include "coap_time.h"
+
 
 // Module Name
 #define MOD_NAME "ocobserve"
@@ -42,7 +53,176 @@
 
 #define VERIFY_NON_NULL(arg) { if (!arg) {OC_LOG(FATAL, TAG, #arg " is NULL"); goto exit;} }
 
+/** Number of distinct observation IDs; zero is reserved for observers without an ID.*/
+#define MAX_OBSERVATION_IDS (UINT8_MAX)
+
 static struct ResourceObserver * serverObsList = NULL;
+
+// Observers hashed by observation ID and by token.
+static OICHashTable_t g_idIndex;
+static OICHashTable_t g_tokenIndex;
+static size_t g_observerCount = 0;
+static size_t g_observationIdCount = 0;
+
+static uint16_t g_notificationRate = MAX_OBSERVER_NOTIFICATIONS_PER_SECOND;
+static size_t g_pendingNotificationCount = 0;
+
+static bool IndexObserver(ResourceObserver *observer)
+{
+    // A full index still works, only with longer chains.
+    if (!OICHashTableReserve(&g_idIndex, g_observerCount + 1) ||
+        !OICHashTableReserve(&g_tokenIndex, g_observerCount + 1))
+    {
+        return false;
+    }
+
+    OICHashTableInsert(&g_tokenIndex, &observer->tokenLink,
+                       OICHashBytes(observer->token, observer->tokenLength));
+    g_observerCount++;
+    if (observer->observeId)
+    {
+        // observation IDs are small and unique, so they are their own hash
+        OICHashTableInsert(&g_idIndex, &observer->idLink, observer->observeId);
+        g_observationIdCount++;
+    }
+    return true;
+}
+
+static void UnindexObserver(ResourceObserver *observer)
+{
+    OICHashTableRemove(&g_tokenIndex, &observer->tokenLink);
+    if (observer->observeId)
+    {
+        OICHashTableRemove(&g_idIndex, &observer->idLink);
+        g_observationIdCount--;
+    }
+    g_observerCount--;
+}
+
+// The observers of a resource follow the utlist convention: the head's resourcePrev
+// points to the tail.
+static void AppendResourceObserver(OCResource *resource, ResourceObserver *observer)
+{
+    ResourceObserver *head = resource->observers;
+    observer->resourceNext = NULL;
+    if (head)
+    {
+        observer->resourcePrev = head->resourcePrev;
+        head->resourcePrev->resourceNext = observer;
+        head->resourcePrev = observer;
+    }
+    else
+    {
+        observer->resourcePrev = observer;
+        resource->observers = observer;
+    }
+}
+
+static void RemoveResourceObserver(OCResource *resource, ResourceObserver *observer)
+{
+    if (observer->resourcePrev == observer)
+    {
+        resource->observers = NULL;
+    }
+    else if (observer == resource->observers)
+    {
+        observer->resourceNext->resourcePrev = observer->resourcePrev;
+        resource->observers = observer->resourceNext;
+    }
+    else
+    {
+        observer->resourcePrev->resourceNext = observer->resourceNext;
+        if (observer->resourceNext)
+        {
+            observer->resourceNext->resourcePrev = observer->resourcePrev;
+        }
+        else
+        {
+            resource->observers->resourcePrev = observer->resourcePrev;
+        }
+    }
+    observer->resourceNext = NULL;
+    observer->resourcePrev = NULL;
+}
+
+static void SetPendingNotification(ResourceObserver *observer, bool pending)
+{
+    if (pending && !observer->pendingNotification)
+    {
+        g_pendingNotificationCount++;
+
+        // a thread waiting in OCWaitForEvents has to take the new deadline
+        CASignalRequestResponse();
+    }
+    else if (!pending && observer->pendingNotification)
+    {
+        g_pendingNotificationCount--;
+    }
+    observer->pendingNotification = pending;
+}
+
+static void DeleteObserver(ResourceObserver *observer)
+{
+    UnindexObserver(observer);
+    DL_DELETE (serverObsList, observer);
+    if (observer->resource)
+    {
+        RemoveResourceObserver(observer->resource, observer);
+    }
+    SetPendingNotification(observer, false);
+
+    OICFree(observer->resUri);
+    OICFree(observer->query);
+    OICFree(observer->token);
+    OICFree(observer);
+}
+
+static uint32_t GetObserverTicks()
+{
+    coap_tick_t now;
+    coap_ticks(&now);
+    return (uint32_t) now;
+}
+
+static bool IsRateWindowOver(const ResourceObserver *observer, uint32_t now)
+{
+    return (uint32_t)(now - observer->rateWindowStart) >= COAP_TICKS_PER_SECOND;
+}
+
+/**
+ * Account a notification against the rate limit of an observer.  A notification that is
+ * over the limit marks the observer as pending instead.
+ *
+ * @param observer Observer.
+ * @param now Current time in coap ticks.
+ * @return true if the notification may be sent now.
+ */
+static bool IsNotificationAllowed(ResourceObserver *observer, uint32_t now)
+{
+    if (!g_notificationRate)
+    {
+        SetPendingNotification(observer, false);
+        return true;
+    }
+
+    if (IsRateWindowOver(observer, now))
+    {
+        observer->rateWindowStart = now;
+        observer->rateWindowCount = 0;
+    }
+
+    if (observer->rateWindowCount < g_notificationRate)
+    {
+        observer->rateWindowCount++;
+        SetPendingNotification(observer, false);
+        return true;
+    }
+
+    OC_LOG_V(INFO, TAG, "Holding back notification for observer id %u", observer->observeId);
+    SetPendingNotification(observer, true);
+    return false;
+}
+
 /**
  * Determine observe QOS based on the QOS of the request.
  * The qos passed as a parameter overrides what the client requested.
@@ -96,6 +276,213 @@ static OCQualityOfService DetermineObserverQoS(OCMethod method,
     return decidedQoS;
 }
 
+/**
+ * Check whether one encoded notification can serve two observers.
+ *
+ * @param a First observer.
+ * @param b Second observer.
+ * @param compareQuery Whether the entity handler sees the query of the observer.
+ * @return true if b can be sent the notification created for a.
+ */
+static bool IsSameNotification(const ResourceObserver *a, const ResourceObserver *b,
+                               bool compareQuery)
+{
+#if defined (ROUTING_GATEWAY) || defined (ROUTING_EP)
+    // Route information is added per endpoint, so every observer gets its own response.
+    (void)a;
+    (void)b;
+    (void)compareQuery;
+    return false;
+#else
+    if (a->acceptFormat != b->acceptFormat || b->tokenLength > CA_MAX_TOKEN_LEN)
+    {
+        return false;
+    }
+    return !compareQuery ||
+           strcmp(a->query ? a->query : "", b->query ? b->query : "") == 0;
+#endif
+}
+
+static OCObserverFanOut *CreateObserverFanOut(OCMethod method, ResourceObserver **observers,
+        size_t count, OCQualityOfService qos)
+{
+    OCObserverFanOut *fanOut = (OCObserverFanOut *) OICMalloc(sizeof(OCObserverFanOut) +
+            (count - 1) * sizeof(OCFanOutObserver));
+    if (!fanOut)
+    {
+        OC_LOG(ERROR, TAG, "Failed to allocate notification fan-out");
+        return NULL;
+    }
+
+    fanOut->count = (uint16_t)count;
+    for (size_t i = 0; i < count; i++)
+    {
+        OCFanOutObserver *entry = &fanOut->observers[i];
+        memcpy(entry->token, observers[i]->token, observers[i]->tokenLength);
+        entry->tokenLength = observers[i]->tokenLength;
+        entry->qos = DetermineObserverQoS(method, observers[i], qos);
+    }
+    return fanOut;
+}
+
+/**
+ * Move the observers that can share the notification of batch[leader] into group and
+ * clear them in batch.
+ *
+ * @return Number of observers moved.
+ */
+static size_t CollectNotificationGroup(ResourceObserver **batch, size_t count, size_t leader,
+        ResourceObserver **group, bool compareQuery)
+{
+    size_t groupCount = 0;
+    for (size_t i = leader + 1; i < count && groupCount < UINT16_MAX; i++)
+    {
+        if (batch[i] && IsSameNotification(batch[leader], batch[i], compareQuery))
+        {
+            group[groupCount++] = batch[i];
+            batch[i] = NULL;
+        }
+    }
+    return groupCount;
+}
+
+/**
+ * Ask the entity handler of a resource for a notification on behalf of leader.  Its
+ * response is encoded once and sent to leader and every observer of group.
+ */
+static OCStackResult NotifyObserverGroup(OCMethod method, OCResource *resPtr,
+        ResourceObserver *leader, ResourceObserver **group, size_t groupCount,
+        OCQualityOfService qos)
+{
+    OCServerRequest * request = NULL;
+    OCEntityHandlerRequest ehRequest = {0};
+    OCEntityHandlerResult ehResult = OC_EH_ERROR;
+    OCObserverFanOut *fanOut = NULL;
+
+    OCQualityOfService leaderQos = DetermineObserverQoS(method, leader, qos);
+    if (groupCount)
+    {
+        fanOut = CreateObserverFanOut(method, group, groupCount, qos);
+        if (!fanOut)
+        {
+            return OC_STACK_NO_MEMORY;
+        }
+    }
+
+    OCStackResult result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
+            0, resPtr->sequenceNum, leaderQos, leader->query,
+            NULL, NULL,
+            leader->token, leader->tokenLength,
+            leader->resUri, 0, leader->acceptFormat,
+            &leader->devAddr);
+
+    if(!request)
+    {
+        OICFree(fanOut);
+        return result;
+    }
+
+    request->fanOut = fanOut;
+    request->observeResult = OC_STACK_OK;
+    if(result == OC_STACK_OK)
+    {
+        result = FormOCEntityHandlerRequest(
+                    &ehRequest,
+                    (OCRequestHandle) request,
+                    request->method,
+                    &request->devAddr,
+                    (OCResourceHandle) resPtr,
+                    request->query,
+                    PAYLOAD_TYPE_REPRESENTATION,
+                    request->payload,
+                    request->payloadSize,
+                    request->numRcvdVendorSpecificHeaderOptions,
+                    request->rcvdVendorSpecificHeaderOptions,
+                    OC_OBSERVE_NO_OPTION,
+                    0);
+        if(result == OC_STACK_OK)
+        {
+            ehResult = resPtr->entityHandler(OC_REQUEST_FLAG, &ehRequest,
+                                resPtr->entityHandlerCallbackParam);
+            if(ehResult == OC_EH_ERROR)
+            {
+                FindAndDeleteServerRequest(request);
+            }
+        }
+        OCPayloadDestroy(ehRequest.payload);
+    }
+    return result;
+}
+
+/**
+ * Notify the observers of a resource, one entity handler call per group of observers
+ * that see the same query.
+ *
+ * @param method RESTful method.
+ * @param resPtr Observed resource.
+ * @param qos Quality of service of the notification.
+ * @param pendingOnly Only notify observers held back by the rate limiter.
+ * @param errorFlag Set if any notification failed.
+ * @return Number of observers of the resource.
+ */
+static size_t NotifyObservers(OCMethod method, OCResource *resPtr, OCQualityOfService qos,
+        bool pendingOnly, bool *errorFlag)
+{
+    size_t numObs = 0;
+    ResourceObserver *observer = NULL;
+
+    for (observer = resPtr->observers; observer; observer = observer->resourceNext)
+    {
+        numObs++;
+    }
+    if (!numObs)
+    {
+        return 0;
+    }
+
+    // The second half is scratch space for the groups.
+    ResourceObserver **batch = (ResourceObserver **) OICMalloc(2 * numObs *
+                                                                sizeof(ResourceObserver *));
+    if (!batch)
+    {
+        OC_LOG(ERROR, TAG, "Failed to allocate observer batch");
+        *errorFlag = true;
+        return numObs;
+    }
+    ResourceObserver **group = batch + numObs;
+
+    size_t count = 0;
+    uint32_t now = GetObserverTicks();
+    for (observer = resPtr->observers; observer; observer = observer->resourceNext)
+    {
+        if (pendingOnly && !observer->pendingNotification)
+        {
+            continue;
+        }
+        if (IsNotificationAllowed(observer, now))
+        {
+            batch[count++] = observer;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!batch[i])
+        {
+            continue;
+        }
+        size_t groupCount = CollectNotificationGroup(batch, count, i, group, true);
+        if (NotifyObserverGroup(method, resPtr, batch[i], group, groupCount, qos)
+                != OC_STACK_OK)
+        {
+            *errorFlag = true;
+        }
+    }
+
+    OICFree(batch);
+    return numObs;
+}
+
 #ifdef WITH_PRESENCE
 OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr, uint32_t maxAge,
         OCPresenceTrigger trigger, OCResourceType *resourceType, OCQualityOfService qos)
@@ -111,113 +498,70 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
     }
 
     OCStackResult result = OC_STACK_ERROR;
-    ResourceObserver * resourceObserver = serverObsList;
-    uint8_t numObs = 0;
-    OCServerRequest * request = NULL;
-    OCEntityHandlerRequest ehRequest = {0};
-    OCEntityHandlerResult ehResult = OC_EH_ERROR;
+    size_t numObs = 0;
     bool observeErrorFlag = false;
 
-    // Find clients that are observing this resource
-    while (resourceObserver)
+#ifdef WITH_PRESENCE
+    if(method == OC_REST_PRESENCE)
     {
-        if (resourceObserver->resource == resPtr)
+        ResourceObserver * resourceObserver = resPtr->observers;
+        OCServerRequest * request = NULL;
+
+        // Find clients that are observing this resource
+        while (resourceObserver)
         {
             numObs++;
-#ifdef WITH_PRESENCE
-            if(method != OC_REST_PRESENCE)
-            {
-#endif
-                qos = DetermineObserverQoS(method, resourceObserver, qos);
 
-                result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
-                        0, resPtr->sequenceNum, qos, resourceObserver->query,
-                        NULL, NULL,
-                        resourceObserver->token, resourceObserver->tokenLength,
-                        resourceObserver->resUri, 0, resourceObserver->acceptFormat,
-                        &resourceObserver->devAddr);
+            OCEntityHandlerResponse ehResponse = {0};
 
-                if(request)
-                {
-                    request->observeResult = OC_STACK_OK;
-                    if(result == OC_STACK_OK)
-                    {
-                        result = FormOCEntityHandlerRequest(
-                                    &ehRequest,
-                                    (OCRequestHandle) request,
-                                    request->method,
-                                    &request->devAddr,
-                                    (OCResourceHandle) resPtr,
-                                    request->query,
-                                    PAYLOAD_TYPE_REPRESENTATION,
-                                    request->payload,
-                                    request->payloadSize,
-                                    request->numRcvdVendorSpecificHeaderOptions,
-                                    request->rcvdVendorSpecificHeaderOptions,
-                                    OC_OBSERVE_NO_OPTION,
-                                    0);
-                        if(result == OC_STACK_OK)
-                        {
-                            ehResult = resPtr->entityHandler(OC_REQUEST_FLAG, &ehRequest,
-                                                resPtr->entityHandlerCallbackParam);
-                            if(ehResult == OC_EH_ERROR)
-                            {
-                                FindAndDeleteServerRequest(request);
-                            }
-                        }
-                        OCPayloadDestroy(ehRequest.payload);
-                    }
-                }
-#ifdef WITH_PRESENCE
-            }
-            else
+            //This is effectively the implementation for the presence entity handler.
+            OC_LOG(DEBUG, TAG, "This notification is for Presence");
+            result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
+                    0, resPtr->sequenceNum, qos, resourceObserver->query,
+                    NULL, NULL,
+                    resourceObserver->token, resourceObserver->tokenLength,
+                    resourceObserver->resUri, 0, resourceObserver->acceptFormat,
+                    &resourceObserver->devAddr);
+
+            if(result == OC_STACK_OK)
             {
-                OCEntityHandlerResponse ehResponse = {0};
+                OCPresencePayload* presenceResBuf = OCPresencePayloadCreate(
+                        resPtr->sequenceNum, maxAge, trigger,
+                        resourceType ? resourceType->resourcetypename : NULL);
 
-                //This is effectively the implementation for the presence entity handler.
-                OC_LOG(DEBUG, TAG, "This notification is for Presence");
-                result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
-                        0, resPtr->sequenceNum, qos, resourceObserver->query,
-                        NULL, NULL,
-                        resourceObserver->token, resourceObserver->tokenLength,
-                        resourceObserver->resUri, 0, resourceObserver->acceptFormat,
-                        &resourceObserver->devAddr);
+                if(!presenceResBuf)
+                {
+                    return OC_STACK_NO_MEMORY;
+                }
 
                 if(result == OC_STACK_OK)
                 {
-                    OCPresencePayload* presenceResBuf = OCPresencePayloadCreate(
-                            resPtr->sequenceNum, maxAge, trigger,
-                            resourceType ? resourceType->resourcetypename : NULL);
-
-                    if(!presenceResBuf)
-                    {
-                        return OC_STACK_NO_MEMORY;
-                    }
-
-                    if(result == OC_STACK_OK)
-                    {
-                        ehResponse.ehResult = OC_EH_OK;
-                        ehResponse.payload = (OCPayload*)presenceResBuf;
-                        ehResponse.persistentBufferFlag = 0;
-                        ehResponse.requestHandle = (OCRequestHandle) request;
-                        ehResponse.resourceHandle = (OCResourceHandle) resPtr;
-                        OICStrcpy(ehResponse.resourceUri, sizeof(ehResponse.resourceUri),
-                                resourceObserver->resUri);
-                        result = OCDoResponse(&ehResponse);
-                    }
-
-                    OCPresencePayloadDestroy(presenceResBuf);
+                    ehResponse.ehResult = OC_EH_OK;
+                    ehResponse.payload = (OCPayload*)presenceResBuf;
+                    ehResponse.persistentBufferFlag = 0;
+                    ehResponse.requestHandle = (OCRequestHandle) request;
+                    ehResponse.resourceHandle = (OCResourceHandle) resPtr;
+                    OICStrcpy(ehResponse.resourceUri, sizeof(ehResponse.resourceUri),
+                            resourceObserver->resUri);
+                    result = OCDoResponse(&ehResponse);
                 }
+
+                OCPresencePayloadDestroy(presenceResBuf);
             }
-#endif
 
             // Since we are in a loop, set an error flag to indicate at least one error occurred.
             if (result != OC_STACK_OK)
             {
                 observeErrorFlag = true;
             }
+            resourceObserver = resourceObserver->resourceNext;
         }
-        resourceObserver = resourceObserver->next;
+    }
+    else
+#endif
+    {
+        numObs = NotifyObservers(method, resPtr, qos, false, &observeErrorFlag);
+        result = OC_STACK_OK;
     }
 
     if (numObs == 0)
@@ -233,6 +577,129 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
     return result;
 }
 
+void SendPendingObserverNotifications()
+{
+    ResourceObserver *observer = NULL;
+    bool notified = true;
+
+    // Every pass clears the pending flag of all ready observers of one resource.
+    while (g_pendingNotificationCount && notified)
+    {
+        uint32_t now = GetObserverTicks();
+        notified = false;
+        LL_FOREACH (serverObsList, observer)
+        {
+            if (observer->pendingNotification &&
+                    (!g_notificationRate || IsRateWindowOver(observer, now)))
+            {
+                bool observeErrorFlag = false;
+                NotifyObservers(OC_REST_OBSERVE, observer->resource, OC_NA_QOS, true,
+                                &observeErrorFlag);
+                notified = true;
+                break;
+            }
+        }
+    }
+}
+
+uint32_t GetPendingObserverNotificationTimeout()
+{
+    uint32_t timeout = UINT32_MAX;
+    if (!g_pendingNotificationCount)
+    {
+        return timeout;
+    }
+    if (!g_notificationRate)
+    {
+        return 0;
+    }
+
+    uint32_t now = GetObserverTicks();
+    ResourceObserver *observer = NULL;
+    LL_FOREACH (serverObsList, observer)
+    {
+        if (!observer->pendingNotification)
+        {
+            continue;
+        }
+
+        uint32_t elapsed = now - observer->rateWindowStart;
+        if (elapsed >= COAP_TICKS_PER_SECOND)
+        {
+            return 0;
+        }
+
+        // round up, waking up early would only find the window still open
+        uint32_t remaining = ((COAP_TICKS_PER_SECOND - elapsed) * 1000 +
+                              COAP_TICKS_PER_SECOND - 1) / COAP_TICKS_PER_SECOND;
+        if (remaining < timeout)
+        {
+            timeout = remaining;
+        }
+    }
+    return timeout;
+}
+
+void SetObserverNotificationRate(uint16_t notificationsPerSecond)
+{
+    g_notificationRate = notificationsPerSecond;
+}
+
+/**
+ * Send an application provided representation to leader and every observer of group.
+ */
+static OCStackResult NotifyObserverGroupWithPayload(OCResource *resource,
+        ResourceObserver *leader, ResourceObserver **group, size_t groupCount,
+        const OCRepPayload *payload, OCQualityOfService qos)
+{
+    OCServerRequest * request = NULL;
+    OCObserverFanOut *fanOut = NULL;
+
+    OCQualityOfService leaderQos = DetermineObserverQoS(OC_REST_GET, leader, qos);
+    if (groupCount)
+    {
+        fanOut = CreateObserverFanOut(OC_REST_GET, group, groupCount, qos);
+        if (!fanOut)
+        {
+            return OC_STACK_NO_MEMORY;
+        }
+    }
+
+    OCStackResult result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
+            0, resource->sequenceNum, leaderQos, leader->query,
+            NULL, NULL, leader->token, leader->tokenLength,
+            leader->resUri, 0, leader->acceptFormat,
+            &leader->devAddr);
+
+    if(!request)
+    {
+        OICFree(fanOut);
+        return result;
+    }
+
+    request->fanOut = fanOut;
+    request->observeResult = OC_STACK_OK;
+    if(result == OC_STACK_OK)
+    {
+        OCEntityHandlerResponse ehResponse = {0};
+        ehResponse.ehResult = OC_EH_OK;
+        ehResponse.payload = (OCPayload*)OCRepPayloadCreate();
+        if(!ehResponse.payload)
+        {
+            FindAndDeleteServerRequest(request);
+            return OC_STACK_NO_MEMORY;
+        }
+        memcpy(ehResponse.payload, payload, sizeof(*payload));
+        ehResponse.persistentBufferFlag = 0;
+        ehResponse.requestHandle = (OCRequestHandle) request;
+        ehResponse.resourceHandle = (OCResourceHandle) resource;
+        result = OCDoResponse(&ehResponse);
+        OICFree(ehResponse.payload);
+    }
+    FindAndDeleteServerRequest(request);
+    return result;
+}
+
 OCStackResult SendListObserverNotification (OCResource * resource,
         OCObservationId  *obsIdList, uint8_t numberOfIds,
         const OCRepPayload *payload,
@@ -245,80 +712,62 @@ OCStackResult SendListObserverNotification (OCResource * resource,
         return OC_STACK_INVALID_PARAM;
     }
 
-    uint8_t numIds = numberOfIds;
     ResourceObserver *observer = NULL;
     uint8_t numSentNotification = 0;
-    OCServerRequest * request = NULL;
-    OCStackResult result = OC_STACK_ERROR;
     bool observeErrorFlag = false;
 
     OC_LOG(INFO, TAG, "Entering SendListObserverNotification");
-    while(numIds)
+    if (!numberOfIds)
     {
-        observer = GetObserverUsingId (*obsIdList);
-        if(observer)
-        {
-            // Found observer - verify if it matches the resource handle
-            if (observer->resource == resource)
-            {
-                qos = DetermineObserverQoS(OC_REST_GET, observer, qos);
+        return OC_STACK_NO_OBSERVERS;
+    }
 
+    // The second half is scratch space for the groups.
+    ResourceObserver **batch = (ResourceObserver **) OICMalloc(2 * numberOfIds *
+                                                                sizeof(ResourceObserver *));
+    if (!batch)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+    ResourceObserver **group = batch + numberOfIds;
 
-                result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
-                        0, resource->sequenceNum, qos, observer->query,
-                        NULL, NULL, observer->token, observer->tokenLength,
-                        observer->resUri, 0, observer->acceptFormat,
-                        &observer->devAddr);
+    size_t count = 0;
+    for (uint8_t i = 0; i < numberOfIds; i++)
+    {
+        observer = GetObserverUsingId (obsIdList[i]);
+        // Found observer - verify if it matches the resource handle
+        if (observer && observer->resource == resource)
+        {
+            batch[count++] = observer;
+        }
+    }
 
-                if(request)
-                {
-                    request->observeResult = OC_STACK_OK;
-                    if(result == OC_STACK_OK)
-                    {
-                        OCEntityHandlerResponse ehResponse = {0};
-                        ehResponse.ehResult = OC_EH_OK;
-                        ehResponse.payload = (OCPayload*)OCRepPayloadCreate();
-                        if(!ehResponse.payload)
-                        {
-                            FindAndDeleteServerRequest(request);
-                            continue;
-                        }
-                        memcpy(ehResponse.payload, payload, sizeof(*payload));
-                        ehResponse.persistentBufferFlag = 0;
-                        ehResponse.requestHandle = (OCRequestHandle) request;
-                        ehResponse.resourceHandle = (OCResourceHandle) resource;
-                        result = OCDoResponse(&ehResponse);
-                        if(result == OC_STACK_OK)
-                        {
-                            OC_LOG_V(INFO, TAG, "Observer id %d notified.", *obsIdList);
-
-                            // Increment only if OCDoResponse is successful
-                            numSentNotification++;
-
-                            OICFree(ehResponse.payload);
-                            FindAndDeleteServerRequest(request);
-                        }
-                        else
-                        {
-                            OC_LOG_V(INFO, TAG, "Error notifying observer id %d.", *obsIdList);
-                        }
-                    }
-                    else
-                    {
-                        FindAndDeleteServerRequest(request);
-                    }
-                }
-                // Since we are in a loop, set an error flag to indicate
-                // at least one error occurred.
-                if (result != OC_STACK_OK)
-                {
-                    observeErrorFlag = true;
-                }
-            }
+    // The payload does not depend on the query, so only the accept format splits groups.
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!batch[i])
+        {
+            continue;
+        }
+        size_t groupCount = CollectNotificationGroup(batch, count, i, group, false);
+        if (NotifyObserverGroupWithPayload(resource, batch[i], group, groupCount, payload, qos)
+                == OC_STACK_OK)
+        {
+            OC_LOG_V(INFO, TAG, "Observer id %d and %u others notified.",
+                     batch[i]->observeId, (unsigned)groupCount);
+
+            // Increment only if OCDoResponse is successful
+            numSentNotification += (uint8_t)(groupCount + 1);
+        }
+        else
+        {
+            // Since we are in a loop, set an error flag to indicate
+            // at least one error occurred.
+            OC_LOG_V(INFO, TAG, "Error notifying observer id %d.", batch[i]->observeId);
+            observeErrorFlag = true;
         }
-        obsIdList++;
-        numIds--;
     }
+    OICFree(batch);
 
     if(numSentNotification == numberOfIds && !observeErrorFlag)
     {
@@ -342,12 +791,18 @@ OCStackResult GenerateObserverId (OCObservationId *observationId)
     OC_LOG(INFO, TAG, "Entering GenerateObserverId");
     VERIFY_NON_NULL (observationId);
 
+    if (g_observationIdCount >= MAX_OBSERVATION_IDS)
+    {
+        OC_LOG(ERROR, TAG, "All observation IDs are in use");
+        return OC_STACK_ERROR;
+    }
+
     do
     {
         *observationId = OCGetRandomByte();
-        // Check if observation Id already exists
-        resObs = GetObserverUsingId (*observationId);
-    } while (NULL != resObs);
+        // Check if observation Id already exists; zero means no ID
+        resObs = *observationId ? GetObserverUsingId (*observationId) : NULL;
+    } while (0 == *observationId || NULL != resObs);
 
     OC_LOG_V(INFO, TAG, "GeneratedObservation ID is %u", *observationId);
 
@@ -377,7 +832,7 @@ OCStackResult AddObserver (const char         *resUri,
     }
     ResourceObserver *obsNode = NULL;
 
-    if(!resUri || !token || !*token)
+    if(!resUri || !token || 0 == tokenLength)
     {
         return OC_STACK_INVALID_PARAM;
     }
@@ -410,7 +865,12 @@ OCStackResult AddObserver (const char         *resUri,
         obsNode->devAddr = *devAddr;
         obsNode->resource = resHandle;
 
-        LL_APPEND (serverObsList, obsNode);
+        if (!IndexObserver(obsNode))
+        {
+            goto exit;
+        }
+        DL_APPEND (serverObsList, obsNode);
+        AppendResourceObserver(resHandle, obsNode);
 
         return OC_STACK_OK;
     }
@@ -420,6 +880,7 @@ exit:
     {
         OICFree(obsNode->resUri);
         OICFree(obsNode->query);
+        OICFree(obsNode->token);
         OICFree(obsNode);
     }
     return OC_STACK_NO_MEMORY;
@@ -427,12 +888,12 @@ exit:
 
 ResourceObserver* GetObserverUsingId (const OCObservationId observeId)
 {
-    ResourceObserver *out = NULL;
-
     if (observeId)
     {
-        LL_FOREACH (serverObsList, out)
+        for (OICHashLink_t *link = OICHashTableFind(&g_idIndex, observeId); link;
+             link = OICHashTableFindNext(link))
         {
+            ResourceObserver *out = OIC_HASH_ENTRY(link, ResourceObserver, idLink);
             if (out->observeId == observeId)
             {
                 return out;
@@ -445,18 +906,18 @@ ResourceObserver* GetObserverUsingId (const OCObservationId observeId)
 
 ResourceObserver* GetObserverUsingToken (const CAToken_t token, uint8_t tokenLength)
 {
-    ResourceObserver *out = NULL;
-
-    if(token && *token)
+    if(token && tokenLength)
     {
         OC_LOG(INFO, TAG, "Looking for token");
         OC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
-        OC_LOG(INFO, TAG, "\tFound token:");
 
-        LL_FOREACH (serverObsList, out)
+        uint32_t hash = OICHashBytes(token, tokenLength);
+        for (OICHashLink_t *link = OICHashTableFind(&g_tokenIndex, hash); link;
+             link = OICHashTableFindNext(link))
         {
-            OC_LOG_BUFFER(INFO, TAG, (const uint8_t *)out->token, tokenLength);
-            if((memcmp(out->token, token, tokenLength) == 0))
+            ResourceObserver *out = OIC_HASH_ENTRY(link, ResourceObserver, tokenLink);
+            if (out->tokenLength == tokenLength &&
+                    memcmp(out->token, token, tokenLength) == 0)
             {
                 return out;
             }
@@ -473,7 +934,7 @@ ResourceObserver* GetObserverUsingToken (const CAToken_t token, uint8_t tokenLen
 
 OCStackResult DeleteObserverUsingToken (CAToken_t token, uint8_t tokenLength)
 {
-    if(!token || !*token)
+    if(!token || 0 == tokenLength)
     {
         return OC_STACK_INVALID_PARAM;
     }
@@ -485,16 +946,27 @@ OCStackResult DeleteObserverUsingToken (CAToken_t token, uint8_t tokenLength)
     {
         OC_LOG_V(INFO, TAG, "deleting observer id  %u with token", obsNode->observeId);
         OC_LOG_BUFFER(INFO, TAG, (const uint8_t *)obsNode->token, tokenLength);
-        LL_DELETE (serverObsList, obsNode);
-        OICFree(obsNode->resUri);
-        OICFree(obsNode->query);
-        OICFree(obsNode->token);
-        OICFree(obsNode);
+        DeleteObserver(obsNode);
     }
     // it is ok if we did not find the observer...
     return OC_STACK_OK;
 }
 
+void DeleteObserversUsingResource(OCResource *resource)
+{
+    if (!resource)
+    {
+        return;
+    }
+
+    while (resource->observers)
+    {
+        OC_LOG_V(INFO, TAG, "deleting observer id  %u of deleted resource",
+                 resource->observers->observeId);
+        DeleteObserver(resource->observers);
+    }
+}
+
 void DeleteObserverList()
 {
     ResourceObserver *out = NULL;
@@ -503,10 +975,16 @@ void DeleteObserverList()
     {
         if(out)
         {
-            DeleteObserverUsingToken ((out->token), out->tokenLength);
+            DeleteObserver(out);
         }
     }
     serverObsList = NULL;
+
+    OICHashTableClear(&g_idIndex);
+    OICHashTableClear(&g_tokenIndex);
+    g_observerCount = 0;
+    g_observationIdCount = 0;
+    g_pendingNotificationCount = 0;
 }
 
 /*
@@ -24,14 +24,205 @@
 #include <string.h>
 #include "oic_malloc.h"
 #include "oic_string.h"
+#include "oic_hash.h"
 #include "ocstackinternal.h"
 #include "ocresource.h"
 #include "logger.h"
 #include "rdpayload.h"
+#include "ocpayloadarena.h"
 
 #define TAG "OCPayload"
-static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val);
+
+/** Alignment of OCPayloadArenaCalloc, enough for int64_t, double and pointers. */
+#define ARENA_ALIGNMENT (8)
+#define ARENA_ALIGN(size) (((size) + ARENA_ALIGNMENT - 1) & ~((size_t)ARENA_ALIGNMENT - 1))
+/** Smallest block, so that a small payload still needs a single one. */
+#define ARENA_MIN_BLOCK_SIZE (256)
+
+/** Number of properties from which a representation indexes them by name. */
+#define REP_INDEX_MIN_VALUES (8)
+
+typedef struct OCPayloadArenaBlock
+{
+    struct OCPayloadArenaBlock* next;
+    size_t size;
+    size_t used;
+} OCPayloadArenaBlock;
+
+struct OCPayloadArena
+{
+    size_t refCount;
+    /** block allocations are taken from, the older ones follow it */
+    OCPayloadArenaBlock* blocks;
+};
+
+static void OCFreeRepPayloadValueContents(const OCPayloadArena* arena, OCRepPayloadValue* val);
 static void FreeOCDiscoveryResource(OCResourcePayload* payload);
+static void OCFreeOCStringLLInArena(const OCPayloadArena* arena, OCStringLL* ll);
+
+static uint8_t* OCPayloadArenaBlockData(const OCPayloadArenaBlock* block)
+{
+    return (uint8_t*)block + ARENA_ALIGN(sizeof(OCPayloadArenaBlock));
+}
+
+static void OCPayloadArenaInitBlock(OCPayloadArenaBlock* block, size_t size)
+{
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+}
+
+OCPayloadArena* OCPayloadArenaCreate(size_t sizeHint)
+{
+    size_t size = sizeHint < ARENA_MIN_BLOCK_SIZE ? ARENA_MIN_BLOCK_SIZE : ARENA_ALIGN(sizeHint);
+
+    // the arena and its first block are one allocation
+    OCPayloadArena* arena = (OCPayloadArena*)OICMalloc(ARENA_ALIGN(sizeof(OCPayloadArena)) +
+            ARENA_ALIGN(sizeof(OCPayloadArenaBlock)) + size);
+    if (!arena)
+    {
+        return NULL;
+    }
+
+    arena->refCount = 1;
+    arena->blocks = (OCPayloadArenaBlock*)((uint8_t*)arena + ARENA_ALIGN(sizeof(OCPayloadArena)));
+    OCPayloadArenaInitBlock(arena->blocks, size);
+    return arena;
+}
+
+void OCPayloadArenaRetain(OCPayloadArena* arena)
+{
+    if (arena)
+    {
+        arena->refCount++;
+    }
+}
+
+void OCPayloadArenaRelease(OCPayloadArena* arena)
+{
+    if (!arena || --arena->refCount > 0)
+    {
+        return;
+    }
+
+    OCPayloadArenaBlock* block = arena->blocks;
+    while (block->next)
+    {
+        OCPayloadArenaBlock* next = block->next;
+        OICFree(block);
+        block = next;
+    }
+    // the last block is the first one, allocated with the arena
+    OICFree(arena);
+}
+
+static void* OCPayloadArenaAlloc(OCPayloadArena* arena, size_t size, size_t alignment)
+{
+    OCPayloadArenaBlock* block = arena->blocks;
+    size_t offset = (block->used + alignment - 1) & ~(alignment - 1);
+
+    if (offset > block->size || size > block->size - offset)
+    {
+        size_t blockSize = block->size * 2;
+        if (blockSize < size)
+        {
+            blockSize = ARENA_ALIGN(size);
+        }
+
+        OCPayloadArenaBlock* newBlock =
+            (OCPayloadArenaBlock*)OICMalloc(ARENA_ALIGN(sizeof(OCPayloadArenaBlock)) + blockSize);
+        if (!newBlock)
+        {
+            return NULL;
+        }
+        OCPayloadArenaInitBlock(newBlock, blockSize);
+        newBlock->next = block;
+        arena->blocks = newBlock;
+
+        block = newBlock;
+        offset = 0;
+    }
+
+    block->used = offset + size;
+    return OCPayloadArenaBlockData(block) + offset;
+}
+
+void* OCPayloadArenaCalloc(OCPayloadArena* arena, size_t num, size_t size)
+{
+    if (!arena)
+    {
+        return OICCalloc(num, size);
+    }
+
+    if (num == 0 || size == 0 || num > SIZE_MAX / size)
+    {
+        return NULL;
+    }
+
+    void* ptr = OCPayloadArenaAlloc(arena, num * size, ARENA_ALIGNMENT);
+    if (ptr)
+    {
+        memset(ptr, 0, num * size);
+    }
+    return ptr;
+}
+
+char* OCPayloadArenaAllocString(OCPayloadArena* arena, size_t length)
+{
+    if (length == SIZE_MAX)
+    {
+        return NULL;
+    }
+
+    if (!arena)
+    {
+        return (char*)OICMalloc(length + 1);
+    }
+
+    return (char*)OCPayloadArenaAlloc(arena, length + 1, 1);
+}
+
+char* OCPayloadArenaStrdup(OCPayloadArena* arena, const char* str)
+{
+    if (!str)
+    {
+        return NULL;
+    }
+
+    size_t length = strlen(str);
+    char* dup = OCPayloadArenaAllocString(arena, length);
+    if (dup)
+    {
+        memcpy(dup, str, length + 1);
+    }
+    return dup;
+}
+
+bool OCPayloadArenaOwns(const OCPayloadArena* arena, const void* ptr)
+{
+    if (!arena || !ptr)
+    {
+        return false;
+    }
+
+    for (const OCPayloadArenaBlock* block = arena->blocks; block; block = block->next)
+    {
+        const uint8_t* data = OCPayloadArenaBlockData(block);
+        if ((const uint8_t*)ptr >= data && (const uint8_t*)ptr < data + block->size)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void OCPayloadArenaFree(const OCPayloadArena* arena, void* ptr)
+{
+    if (!OCPayloadArenaOwns(arena, ptr))
+    {
+        OICFree(ptr);
+    }
+}
 
 void OCPayloadDestroy(OCPayload* payload)
 {
@@ -71,7 +262,12 @@ void OCPayloadDestroy(OCPayload* payload)
 }
 OCRepPayload* OCRepPayloadCreate()
 {
-    OCRepPayload* payload = (OCRepPayload*)OICCalloc(1, sizeof(OCRepPayload));
+    return OCRepPayloadCreateInArena(NULL);
+}
+
+OCRepPayload* OCRepPayloadCreateInArena(OCPayloadArena* arena)
+{
+    OCRepPayload* payload = (OCRepPayload*)OCPayloadArenaCalloc(arena, 1, sizeof(OCRepPayload));
 
     if(!payload)
     {
@@ -79,6 +275,8 @@ OCRepPayload* OCRepPayloadCreate()
     }
 
     payload->base.type = PAYLOAD_TYPE_REPRESENTATION;
+    payload->arena = arena;
+    OCPayloadArenaRetain(arena);
 
     return payload;
 }
@@ -99,6 +297,82 @@ void OCRepPayloadAppend(OCRepPayload* parent, OCRepPayload* child)
     child->next = NULL;
 }
 
+static void OCRepPayloadIndexInsert(OCRepPayloadValue** index, size_t indexSize,
+        OCRepPayloadValue* val)
+{
+    size_t slot = OICHashString(val->name) & (indexSize - 1);
+    while (index[slot])
+    {
+        slot = (slot + 1) & (indexSize - 1);
+    }
+    index[slot] = val;
+}
+
+static void OCRepPayloadBuildIndex(OCRepPayload* payload)
+{
+    OICFree(payload->valueIndex);
+    payload->valueIndex = NULL;
+    payload->valueIndexSize = 0;
+
+    if (payload->valueCount < REP_INDEX_MIN_VALUES)
+    {
+        return;
+    }
+
+    // at most half full, so that probe sequences stay short
+    size_t indexSize = REP_INDEX_MIN_VALUES * 2;
+    while (indexSize < payload->valueCount * 4)
+    {
+        indexSize *= 2;
+    }
+
+    // without an index the values are searched one by one
+    OCRepPayloadValue** index = (OCRepPayloadValue**)OICCalloc(indexSize, sizeof(*index));
+    if (!index)
+    {
+        return;
+    }
+
+    for (OCRepPayloadValue* val = payload->values; val; val = val->next)
+    {
+        OCRepPayloadIndexInsert(index, indexSize, val);
+    }
+    payload->valueIndex = index;
+    payload->valueIndexSize = indexSize;
+}
+
+static void OCRepPayloadLinkValue(OCRepPayload* payload, OCRepPayloadValue* val)
+{
+    if (!payload->lastValue)
+    {
+        payload->lastValue = payload->values;
+        while (payload->lastValue && payload->lastValue->next)
+        {
+            payload->lastValue = payload->lastValue->next;
+        }
+    }
+
+    if (payload->lastValue)
+    {
+        payload->lastValue->next = val;
+    }
+    else
+    {
+        payload->values = val;
+    }
+    payload->lastValue = val;
+    payload->valueCount++;
+
+    if (payload->valueIndex && payload->valueCount * 2 <= payload->valueIndexSize)
+    {
+        OCRepPayloadIndexInsert(payload->valueIndex, payload->valueIndexSize, val);
+    }
+    else if (payload->valueCount >= REP_INDEX_MIN_VALUES)
+    {
+        OCRepPayloadBuildIndex(payload);
+    }
+}
+
 static OCRepPayloadValue* OCRepPayloadFindValue(const OCRepPayload* payload, const char* name)
 {
     if(!payload || !name)
@@ -106,6 +380,20 @@ static OCRepPayloadValue* OCRepPayloadFindValue(const OCRepPayload* payload, con
         return NULL;
     }
 
+    if (payload->valueIndex)
+    {
+        size_t mask = payload->valueIndexSize - 1;
+        for (size_t slot = OICHashString(name) & mask; payload->valueIndex[slot];
+             slot = (slot + 1) & mask)
+        {
+            if (0 == strcmp(payload->valueIndex[slot]->name, name))
+            {
+                return payload->valueIndex[slot];
+            }
+        }
+        return NULL;
+    }
+
     OCRepPayloadValue* val = payload->values;
     while(val)
     {
@@ -149,7 +437,7 @@ static void OCCopyPropertyValueArray(OCRepPayloadValue* dest, OCRepPayloadValue*
                 dest->arr.strArray[i] = OICStrdup(source->arr.strArray[i]);
             }
             break;
-        case OCREP_PROP_ARRAY:
+        case OCREP_PROP_OBJECT:
             dest->arr.objArray = (OCRepPayload**)OICMalloc(dimTotal * sizeof(OCRepPayload*));
             for(size_t i = 0; i < dimTotal; ++i)
             {
@@ -186,7 +474,7 @@ static void OCCopyPropertyValue (OCRepPayloadValue *dest, OCRepPayloadValue *sou
     }
 }
 
-static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val)
+static void OCFreeRepPayloadValueContents(const OCPayloadArena* arena, OCRepPayloadValue* val)
 {
     if(!val)
     {
@@ -195,7 +483,7 @@ static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val)
 
     if(val->type == OCREP_PROP_STRING)
     {
-        OICFree(val->str);
+        OCPayloadArenaFree(arena, val->str);
     }
     else if (val->type == OCREP_PROP_OBJECT)
     {
@@ -211,21 +499,21 @@ static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val)
             case OCREP_PROP_BOOL:
                 // Since this is a union, iArray will
                 // point to all of the above
-                OICFree(val->arr.iArray);
+                OCPayloadArenaFree(arena, val->arr.iArray);
                 break;
             case OCREP_PROP_STRING:
                 for(size_t i = 0; i< dimTotal;++i)
                 {
-                    OICFree(val->arr.strArray[i]);
+                    OCPayloadArenaFree(arena, val->arr.strArray[i]);
                 }
-                OICFree(val->arr.strArray);
+                OCPayloadArenaFree(arena, val->arr.strArray);
                 break;
             case OCREP_PROP_OBJECT:
                 for(size_t i = 0; i< dimTotal;++i)
                 {
                     OCRepPayloadDestroy(val->arr.objArray[i]);
                 }
-                OICFree(val->arr.objArray);
+                OCPayloadArenaFree(arena, val->arr.objArray);
                 break;
             case OCREP_PROP_NULL:
             case OCREP_PROP_ARRAY:
@@ -236,17 +524,16 @@ static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val)
     }
 }
 
-static void OCFreeRepPayloadValue(OCRepPayloadValue* val)
+static void OCFreeRepPayloadValue(const OCPayloadArena* arena, OCRepPayloadValue* val)
 {
-    if(!val)
+    while(val)
     {
-        return;
+        OCRepPayloadValue* next = val->next;
+        OCPayloadArenaFree(arena, val->name);
+        OCFreeRepPayloadValueContents(arena, val);
+        OCPayloadArenaFree(arena, val);
+        val = next;
     }
-
-    OICFree(val->name);
-    OCFreeRepPayloadValueContents(val);
-    OCFreeRepPayloadValue(val->next);
-    OICFree(val);
 }
 static OCRepPayloadValue* OCRepPayloadValueClone (OCRepPayloadValue* source)
 {
@@ -276,7 +563,7 @@ static OCRepPayloadValue* OCRepPayloadValueClone (OCRepPayloadValue* source)
         destIter->next = (OCRepPayloadValue*) OICCalloc(1, sizeof(OCRepPayloadValue));
         if (!destIter->next)
         {
-            OCFreeRepPayloadValue (headOfClone);
+            OCFreeRepPayloadValue (NULL, headOfClone);
             return NULL;
         }
 
@@ -298,56 +585,59 @@ static OCRepPayloadValue* OCRepPayloadFindAndSetValue(OCRepPayload* payload, con
         return NULL;
     }
 
-    OCRepPayloadValue* val = payload->values;
-    if(val == NULL)
+    OCRepPayloadValue* val = OCRepPayloadFindValue(payload, name);
+    if(val)
     {
-        payload->values = (OCRepPayloadValue*)OICCalloc(1, sizeof(OCRepPayloadValue));
-        if(!payload->values)
-        {
-            return NULL;
-        }
-        payload->values->name = OICStrdup(name);
-        if(!payload->values->name)
-        {
-            OICFree(payload->values);
-            payload->values = NULL;
-            return NULL;
-        }
-        payload->values->type =type;
-        return payload->values;
+        OCFreeRepPayloadValueContents(payload->arena, val);
+        val->type = type;
+        return val;
     }
 
-    while(val)
+    // a property set on a parsed payload is not taken from its arena, which would only
+    // grow until the payload is destroyed
+    val = (OCRepPayloadValue*)OICCalloc(1, sizeof(OCRepPayloadValue));
+    if(!val)
     {
-        if(0 == strcmp(val->name, name))
-        {
-            OCFreeRepPayloadValueContents(val);
-            val->type = type;
-            return val;
-        }
-        else if(val->next == NULL)
-        {
-            val->next = (OCRepPayloadValue*)OICCalloc(1, sizeof(OCRepPayloadValue));
-            if(!val->next)
-            {
-                return NULL;
-            }
-            val->next->name = OICStrdup(name);
-            if(!val->next->name)
-            {
-                OICFree(val->next);
-                val->next = NULL;
-                return NULL;
-            }
-            val->next->type =type;
-            return val->next;
-        }
+        return NULL;
+    }
+    val->name = OICStrdup(name);
+    if(!val->name)
+    {
+        OICFree(val);
+        return NULL;
+    }
+    val->type = type;
+    OCRepPayloadLinkValue(payload, val);
+    return val;
+}
 
-        val = val->next;
+OCRepPayloadValue* OCRepPayloadAddValue(OCRepPayload* payload, char* name,
+        OCRepPayloadPropType type)
+{
+    if(!payload || !name)
+    {
+        return NULL;
     }
 
-    OC_LOG(ERROR, TAG, "FindAndSetValue reached point after while loop, pointer corruption?");
-    return NULL;
+    OCRepPayloadValue* val = OCRepPayloadFindValue(payload, name);
+    if(val)
+    {
+        OCPayloadArenaFree(payload->arena, name);
+        OCFreeRepPayloadValueContents(payload->arena, val);
+        val->type = type;
+        return val;
+    }
+
+    val = (OCRepPayloadValue*)OCPayloadArenaCalloc(payload->arena, 1, sizeof(OCRepPayloadValue));
+    if(!val)
+    {
+        OCPayloadArenaFree(payload->arena, name);
+        return NULL;
+    }
+    val->name = name;
+    val->type = type;
+    OCRepPayloadLinkValue(payload, val);
+    return val;
 }
 
 bool OCRepPayloadAddResourceType(OCRepPayload* payload, const char* resourceType)
@@ -1005,14 +1295,35 @@ bool OCRepPayloadGetPropObjectArray(const OCRepPayload* payload, const char* nam
 
 void OCFreeOCStringLL(OCStringLL* ll)
 {
-    if(!ll)
+    OCFreeOCStringLLInArena(NULL, ll);
+}
+
+static void OCFreeOCStringLLInArena(const OCPayloadArena* arena, OCStringLL* ll)
+{
+    while(ll)
     {
-        return;
+        OCStringLL* next = ll->next;
+        OCPayloadArenaFree(arena, ll->value);
+        OCPayloadArenaFree(arena, ll);
+        ll = next;
     }
+}
 
-    OCFreeOCStringLL(ll->next);
-    OICFree(ll->value);
-    OICFree(ll);
+bool OCStringLLAppendInArena(OCPayloadArena* arena, OCStringLL** list, char* str)
+{
+    OCStringLL* node = (OCStringLL*)OCPayloadArenaCalloc(arena, 1, sizeof(OCStringLL));
+    if(!node)
+    {
+        return false;
+    }
+    node->value = str;
+
+    while(*list)
+    {
+        list = &(*list)->next;
+    }
+    *list = node;
+    return true;
 }
 
 OCStringLL* CloneOCStringLL (OCStringLL* ll)
@@ -1070,28 +1381,45 @@ OCRepPayload* OCRepPayloadClone (const OCRepPayload* payload)
     clone->interfaces = CloneOCStringLL (payload->interfaces);
     clone->values = OCRepPayloadValueClone (payload->values);
 
+    for (OCRepPayloadValue* val = clone->values; val; val = val->next)
+    {
+        clone->lastValue = val;
+        clone->valueCount++;
+    }
+    OCRepPayloadBuildIndex(clone);
+
     return clone;
 }
 
 
 void OCRepPayloadDestroy(OCRepPayload* payload)
 {
-    if(!payload)
+    while(payload)
     {
-        return;
-    }
+        OCPayloadArena* arena = payload->arena;
+        OCRepPayload* next = payload->next;
 
-    OICFree(payload->uri);
-    OCFreeOCStringLL(payload->types);
-    OCFreeOCStringLL(payload->interfaces);
-    OCFreeRepPayloadValue(payload->values);
-    OCRepPayloadDestroy(payload->next);
-    OICFree(payload);
+        OCPayloadArenaFree(arena, payload->uri);
+        OCFreeOCStringLLInArena(arena, payload->types);
+        OCFreeOCStringLLInArena(arena, payload->interfaces);
+        OCFreeRepPayloadValue(arena, payload->values);
+        OICFree(payload->valueIndex);
+        OCPayloadArenaFree(arena, payload);
+        OCPayloadArenaRelease(arena);
+
+        payload = next;
+    }
 }
 
 OCDiscoveryPayload* OCDiscoveryPayloadCreate()
 {
-    OCDiscoveryPayload* payload = (OCDiscoveryPayload*)OICCalloc(1, sizeof(OCDiscoveryPayload));
+    return OCDiscoveryPayloadCreateInArena(NULL);
+}
+
+OCDiscoveryPayload* OCDiscoveryPayloadCreateInArena(OCPayloadArena* arena)
+{
+    OCDiscoveryPayload* payload =
+        (OCDiscoveryPayload*)OCPayloadArenaCalloc(arena, 1, sizeof(OCDiscoveryPayload));
 
     if(!payload)
     {
@@ -1099,6 +1427,24 @@ OCDiscoveryPayload* OCDiscoveryPayloadCreate()
     }
 
     payload->base.type = PAYLOAD_TYPE_DISCOVERY;
+    payload->arena = arena;
+    OCPayloadArenaRetain(arena);
+
+    return payload;
+}
+
+OCResourcePayload* OCResourcePayloadCreateInArena(OCPayloadArena* arena)
+{
+    OCResourcePayload* payload =
+        (OCResourcePayload*)OCPayloadArenaCalloc(arena, 1, sizeof(OCResourcePayload));
+
+    if(!payload)
+    {
+        return NULL;
+    }
+
+    payload->arena = arena;
+    OCPayloadArenaRetain(arena);
 
     return payload;
 }
@@ -1264,6 +1610,16 @@ void OCDiscoveryPayloadAddResource(OCDiscoveryPayload* payload, const OCResource
     OCDiscoveryPayloadAddNewResource(payload, OCCopyResource(res, port));
 }
 
+OCResourcePayload* OCDiscoveryResourceCreate(const OCResource* res, uint16_t port)
+{
+    return res ? OCCopyResource(res, port) : NULL;
+}
+
+void OCDiscoveryResourceDestroy(OCResourcePayload* payload)
+{
+    FreeOCDiscoveryResource(payload);
+}
+
 bool OCResourcePayloadAddResourceType(OCResourcePayload* payload, const char* resourceType)
 {
     if (!resourceType)
@@ -1381,19 +1737,22 @@ void OCDiscoveryPayloadAddNewResource(OCDiscoveryPayload* payload, OCResourcePay
 
 static void FreeOCDiscoveryResource(OCResourcePayload* payload)
 {
-    if(!payload)
+    while(payload)
     {
-        return;
-    }
+        OCPayloadArena* arena = payload->arena;
+        OCResourcePayload* next = payload->next;
 
-    OICFree(payload->uri);
-    OICFree(payload->sid);
-    OCFreeOCStringLL(payload->types);
-    OCFreeOCStringLL(payload->interfaces);
-    FreeOCDiscoveryResource(payload->next);
-    OICFree(payload);
+        OCPayloadArenaFree(arena, payload->uri);
+        OCPayloadArenaFree(arena, payload->sid);
+        OCFreeOCStringLLInArena(arena, payload->types);
+        OCFreeOCStringLLInArena(arena, payload->interfaces);
+        OCPayloadArenaFree(arena, payload);
+        OCPayloadArenaRelease(arena);
 
+        payload = next;
+    }
 }
+
 void OCDiscoveryPayloadDestroy(OCDiscoveryPayload* payload)
 {
     if(!payload)
@@ -1401,8 +1760,10 @@ void OCDiscoveryPayloadDestroy(OCDiscoveryPayload* payload)
         return;
     }
 
+    OCPayloadArena* arena = payload->arena;
     FreeOCDiscoveryResource(payload->resources);
-    OICFree(payload);
+    OCPayloadArenaFree(arena, payload);
+    OCPayloadArenaRelease(arena);
 }
 
 OCDevicePayload* OCDevicePayloadCreate(const char* uri, const uint8_t* sid, const char* dname,
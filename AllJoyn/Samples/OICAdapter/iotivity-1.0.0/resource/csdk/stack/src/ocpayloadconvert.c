@@ -21,6 +21,7 @@
 #include "ocpayloadcbor.h"
 #include "platform_features.h"
 #include <stdlib.h>
+#include <string.h>
 #include "oic_malloc.h"
 #include "oic_string.h"
 #include "logger.h"
@@ -33,6 +34,8 @@
 #define TAG "OCPayloadConvert"
 // Arbitrarily chosen size that seems to contain the majority of packages
 #define INIT_SIZE (255)
+// Largest encode arena kept by a thread between payloads
+#define MAX_ARENA_SIZE (4096)
 
 // CBOR Array Length
 #define DISCOVERY_CBOR_ARRAY_LEN 1
@@ -63,6 +66,76 @@ static int64_t AddTextStringToMap(CborEncoder* map, const char* key, size_t keyl
 static int64_t ConditionalAddTextStringToMap(CborEncoder* map, const char* key, size_t keylen,
         const char* value);
 
+// Per-thread encode arena.  It grows to the largest payload encoded on the thread, up to
+// MAX_ARENA_SIZE, so a payload is normally encoded exactly once and then copied into an
+// exact-size buffer.  The cap bounds what is left behind by threads that exit without
+// releasing their arena; larger payloads are sized in the arena and encoded again.
+static OC_THREAD_LOCAL uint8_t* g_encodeArena = NULL;
+static OC_THREAD_LOCAL size_t g_encodeArenaSize = 0;
+
+static OCStackResult OCConvertPayloadResult(int64_t err)
+{
+    if (err == 0)
+    {
+        return OC_STACK_OK;
+    }
+    else if (err == CborErrorOutOfMemory)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+    else if (err < 0)
+    {
+        return (OCStackResult)-err;
+    }
+    else
+    {
+        return OC_STACK_ERROR;
+    }
+}
+
+static void OCGrowEncodeArena(size_t size)
+{
+    size_t newSize = g_encodeArenaSize ? g_encodeArenaSize : INIT_SIZE;
+    while (newSize < size)
+    {
+        newSize *= 2;
+    }
+    if (newSize > MAX_ARENA_SIZE)
+    {
+        newSize = MAX_ARENA_SIZE;
+    }
+
+    OICFree(g_encodeArena);
+    g_encodeArena = (uint8_t*)OICMalloc(newSize);
+    g_encodeArenaSize = g_encodeArena ? newSize : 0;
+}
+
+void OCConvertPayloadReleaseArena()
+{
+    OICFree(g_encodeArena);
+    g_encodeArena = NULL;
+    g_encodeArenaSize = 0;
+}
+
+OCStackResult OCConvertPayloadToBuffer(OCPayload* payload, uint8_t* buffer, size_t* size)
+{
+    if (!payload)
+    {
+        OC_LOG(ERROR, TAG, "Payload parameter NULL");
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    if (!size || (!buffer && *size))
+    {
+        OC_LOG(ERROR, TAG, "Out parameter/s parameter NULL");
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    // On CborErrorOutOfMemory tinycbor keeps counting past the end of the buffer, so
+    // the size reported back is the exact encoded size.
+    return OCConvertPayloadResult(OCConvertPayloadHelper(payload, buffer, size));
+}
+
 OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t* size)
 {
     // TinyCbor Version 47a78569c0 or better on master is required for the re-allocation
@@ -85,52 +158,58 @@ OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t*
 
     OC_LOG_V(INFO, TAG, "Converting payload of type %d", payload->type);
 
-    size_t curSize = INIT_SIZE;
-    uint8_t* out = (uint8_t*)OICCalloc(1, curSize);
-    int64_t err = OCConvertPayloadHelper(payload, out, &curSize);
-
-    if (err == CborErrorOutOfMemory)
+    if (!g_encodeArena)
     {
-        // reallocate "out" and try again!
-        uint8_t* out2 = (uint8_t*)OICRealloc(out, curSize);
-
-        if (!out2)
+        OCGrowEncodeArena(INIT_SIZE);
+        if (!g_encodeArena)
         {
-            OICFree(out);
             return OC_STACK_NO_MEMORY;
         }
-
-        out = out2;
-        err = OCConvertPayloadHelper(payload, out, &curSize);
     }
 
-    if (err == 0)
+    size_t curSize = g_encodeArenaSize;
+    int64_t err = OCConvertPayloadHelper(payload, g_encodeArena, &curSize);
+    uint8_t* out = NULL;
+
+    if (err == CborErrorOutOfMemory)
     {
-        if (curSize < INIT_SIZE)
+        // curSize now holds the exact encoded size: encode straight into the final
+        // buffer and grow the arena, within its cap, so the next payload of this size fits.
+        out = (uint8_t*)OICMalloc(curSize);
+        if (!out)
         {
-            uint8_t* out2 = (uint8_t*)OICRealloc(out, curSize);
-
-            if (!out2)
-            {
-                OICFree(out);
-                return OC_STACK_NO_MEMORY;
-            }
+            return OC_STACK_NO_MEMORY;
+        }
 
-            out = out2;
+        err = OCConvertPayloadHelper(payload, out, &curSize);
+        if (err != 0)
+        {
+            OICFree(out);
+            return OCConvertPayloadResult(err);
         }
 
-        *size = curSize;
-        *outPayload = out;
-        return OC_STACK_OK;
+        if (curSize <= MAX_ARENA_SIZE)
+        {
+            OCGrowEncodeArena(curSize);
+        }
     }
-    else if (err < 0)
+    else if (err == 0)
     {
-        return (OCStackResult)-err;
+        out = (uint8_t*)OICMalloc(curSize);
+        if (!out)
+        {
+            return OC_STACK_NO_MEMORY;
+        }
+        memcpy(out, g_encodeArena, curSize);
     }
     else
     {
-        return OC_STACK_ERROR;
+        return OCConvertPayloadResult(err);
     }
+
+    *size = curSize;
+    *outPayload = out;
+    return OC_STACK_OK;
 }
 
 static int64_t OCConvertPayloadHelper(OCPayload* payload, uint8_t* outPayload, size_t* size)
@@ -296,7 +375,6 @@ static int64_t OCConvertDiscoveryPayload(OCDiscoveryPayload* payload, uint8_t* o
             OCResourcePayload* resource = OCDiscoveryPayloadGetResource(payload, i);
             if(!resource)
             {
-                OICFree(outPayload);
                 return OC_STACK_INVALID_PARAM;
             }
 
@@ -396,7 +474,6 @@ static int64_t OCConvertDiscoveryPayload(OCDiscoveryPayload* payload, uint8_t* o
 
     return checkError(err, &encoder, outPayload, size);
 cbor_error:
-    OICFree(outPayload);
     return OC_STACK_ERROR;
 }
 
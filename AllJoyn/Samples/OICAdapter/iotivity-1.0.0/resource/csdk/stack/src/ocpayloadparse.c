@@ -38,17 +38,34 @@
 #include "oic_string.h"
 #include "payload_logging.h"
 #include "rdpayload.h"
+#include "ocpayloadarena.h"
 
 #define TAG "OCPayloadParse"
 
-static OCStackResult OCParseDiscoveryPayload(OCPayload** outPayload, CborValue* arrayVal);
+/** Size of the first arena block per byte of CBOR, which the structures are larger than. */
+#define PARSE_ARENA_SIZE_FACTOR (4)
+
+/** Entries of the CBOR index on the stack, more are allocated. */
+#define PARSE_INDEX_STACK_ENTRIES (64)
+
+static OCPayloadParseMode g_parseMode = OC_PAYLOAD_PARSE_INDEXED;
+
+static OCStackResult OCParseDiscoveryPayload(OCPayloadArena* arena, OCPayload** outPayload,
+        CborValue* arrayVal);
 static OCStackResult OCParseDevicePayload(OCPayload** outPayload, CborValue* arrayVal);
 static OCStackResult OCParsePlatformPayload(OCPayload** outPayload, CborValue* arrayVal);
-static bool OCParseSingleRepPayload(OCRepPayload** outPayload, CborValue* repParent);
-static OCStackResult OCParseRepPayload(OCPayload** outPayload, CborValue* arrayVal);
+static bool OCParseSingleRepPayload(OCPayloadArena* arena, OCRepPayload** outPayload,
+        CborValue* repParent);
+static OCStackResult OCParseRepPayload(OCPayloadArena* arena, OCPayload** outPayload,
+        CborValue* arrayVal);
 static OCStackResult OCParsePresencePayload(OCPayload** outPayload, CborValue* arrayVal);
 static OCStackResult OCParseSecurityPayload(OCPayload** outPayload, CborValue* arrayVal);
 
+void OCSetPayloadParseMode(OCPayloadParseMode mode)
+{
+    g_parseMode = mode;
+}
+
 OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadType payloadType,
         const uint8_t* payload, size_t payloadSize)
 {
@@ -69,6 +86,32 @@ OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadType payloadType,
         return OC_STACK_MALFORMED_RESPONSE;
     }
 
+    // a malformed payload is rejected here, before anything is allocated for it
+    CborIndexEntry indexEntries[PARSE_INDEX_STACK_ENTRIES];
+    CborIndexEntry* allocatedEntries = NULL;
+    if (g_parseMode == OC_PAYLOAD_PARSE_INDEXED)
+    {
+        size_t indexCount = 0;
+        CborError indexErr = cbor_parser_build_index(&parser, &rootValue, 0, indexEntries,
+                PARSE_INDEX_STACK_ENTRIES, &indexCount);
+        if (CborNoError == indexErr && indexCount > PARSE_INDEX_STACK_ENTRIES)
+        {
+            // without all entries the rest is iterated over, as without an index
+            allocatedEntries = (CborIndexEntry*)OICMalloc(indexCount * sizeof(CborIndexEntry));
+            if (allocatedEntries)
+            {
+                indexErr = cbor_parser_build_index(&parser, &rootValue, 0, allocatedEntries,
+                        indexCount, &indexCount);
+            }
+        }
+        if (CborNoError != indexErr)
+        {
+            OC_LOG_V(ERROR, TAG, "CBOR payload validation failed :%d", indexErr);
+            OICFree(allocatedEntries);
+            return OC_STACK_MALFORMED_RESPONSE;
+        }
+    }
+
     CborValue arrayValue;
     // enter the array
     err = err || cbor_value_enter_container(&rootValue, &arrayValue);
@@ -76,14 +119,28 @@ OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadType payloadType,
     if(err)
     {
         OC_LOG_V(ERROR, TAG, "CBOR payload parse failed :%d", err);
+        OICFree(allocatedEntries);
         return OC_STACK_MALFORMED_RESPONSE;
     }
 
+    // the payload holds the arena, the reference of the parser is dropped when it is done
+    OCPayloadArena* arena = NULL;
+    if (g_parseMode != OC_PAYLOAD_PARSE_HEAP &&
+        (payloadType == PAYLOAD_TYPE_DISCOVERY || payloadType == PAYLOAD_TYPE_REPRESENTATION))
+    {
+        arena = OCPayloadArenaCreate(payloadSize * PARSE_ARENA_SIZE_FACTOR);
+        if (!arena)
+        {
+            OICFree(allocatedEntries);
+            return OC_STACK_NO_MEMORY;
+        }
+    }
+
     OCStackResult result = OC_STACK_ERROR;
     switch(payloadType)
     {
         case PAYLOAD_TYPE_DISCOVERY:
-            result = OCParseDiscoveryPayload(outPayload, &arrayValue);
+            result = OCParseDiscoveryPayload(arena, outPayload, &arrayValue);
             break;
         case PAYLOAD_TYPE_DEVICE:
             result = OCParseDevicePayload(outPayload, &arrayValue);
@@ -92,7 +149,7 @@ OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadType payloadType,
             result = OCParsePlatformPayload(outPayload, &arrayValue);
             break;
         case PAYLOAD_TYPE_REPRESENTATION:
-            result = OCParseRepPayload(outPayload, &arrayValue);
+            result = OCParseRepPayload(arena, outPayload, &arrayValue);
             break;
         case PAYLOAD_TYPE_PRESENCE:
             result = OCParsePresencePayload(outPayload, &arrayValue);
@@ -108,13 +165,18 @@ OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadType payloadType,
             result = OC_STACK_ERROR;
             break;
     }
+    OCPayloadArenaRelease(arena);
 
     if(result == OC_STACK_OK)
     {
+        // the parsers stop at an item they don't expect
+        err = err || !cbor_value_at_end(&arrayValue);
         err = err || cbor_value_leave_container(&rootValue, &arrayValue);
         if(err != CborNoError)
         {
-            return OC_STACK_MALFORMED_RESPONSE;
+            OCPayloadDestroy(*outPayload);
+            *outPayload = NULL;
+            result = OC_STACK_MALFORMED_RESPONSE;
         }
     }
     else
@@ -122,6 +184,7 @@ OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadType payloadType,
         OC_LOG_V(INFO, TAG, "Finished parse payload, result is %d", result);
     }
 
+    OICFree(allocatedEntries);
     return result;
 }
 
@@ -188,7 +251,122 @@ static char* InPlaceStringTrim(char* str)
     return str;
 }
 
-static OCStackResult OCParseDiscoveryPayload(OCPayload** outPayload, CborValue* arrayVal)
+// Like cbor_value_dup_text_string and cbor_value_dup_byte_string, into the arena.  CBOR
+// strings are not NUL terminated, so they cannot be used in place.
+static CborError OCParseCopyString(OCPayloadArena* arena, const CborValue* value, char** out)
+{
+    *out = NULL;
+    if (!cbor_value_is_text_string(value) && !cbor_value_is_byte_string(value))
+    {
+        return CborErrorIllegalType;
+    }
+
+    // a string of known length is copied straight from the buffer
+    const char* view = NULL;
+    size_t len = 0;
+    CborError err;
+    if (cbor_value_is_text_string(value))
+    {
+        err = cbor_value_get_text_string_view(value, &view, &len, NULL);
+    }
+    else
+    {
+        err = cbor_value_get_byte_string_view(value, (const uint8_t**)&view, &len, NULL);
+    }
+    if (CborNoError == err)
+    {
+        char* str = OCPayloadArenaAllocString(arena, len);
+        if (!str)
+        {
+            return CborErrorOutOfMemory;
+        }
+        memcpy(str, view, len);
+        str[len] = '\0';
+        *out = str;
+        return CborNoError;
+    }
+    if (CborErrorUnknownLength != err)
+    {
+        return err;
+    }
+
+    err = cbor_value_calculate_string_length(value, &len);
+    if (CborNoError != err)
+    {
+        return err;
+    }
+
+    char* str = OCPayloadArenaAllocString(arena, len);
+    if (!str)
+    {
+        return CborErrorOutOfMemory;
+    }
+
+    size_t bufLen = len + 1;
+    if (cbor_value_is_text_string(value))
+    {
+        err = cbor_value_copy_text_string(value, str, &bufLen, NULL);
+    }
+    else
+    {
+        err = cbor_value_copy_byte_string(value, (uint8_t*)str, &bufLen, NULL);
+    }
+    if (CborNoError != err)
+    {
+        OCPayloadArenaFree(arena, str);
+        return err;
+    }
+
+    str[len] = '\0';
+    *out = str;
+    return CborNoError;
+}
+
+// Append the space separated values of an rt or if string to list.  In an arena the nodes
+// point into one copy of the string.
+static OCStackResult OCParseStringList(OCPayloadArena* arena, const CborValue* value,
+        OCStringLL** list)
+{
+    char* input = NULL;
+    CborError err = OCParseCopyString(arena, value, &input);
+    if (CborErrorOutOfMemory == err)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+    if (CborNoError != err)
+    {
+        return OC_STACK_MALFORMED_RESPONSE;
+    }
+
+    OCStackResult result = OC_STACK_OK;
+    char* savePtr;
+    char* curPtr = strtok_r(input, " ", &savePtr);
+
+    while (curPtr)
+    {
+        char* trimmed = InPlaceStringTrim(curPtr);
+        if (trimmed[0] != '\0')
+        {
+            char* str = arena ? trimmed : OICStrdup(trimmed);
+            if (!str || !OCStringLLAppendInArena(arena, list, str))
+            {
+                if (!arena)
+                {
+                    OICFree(str);
+                }
+                result = OC_STACK_NO_MEMORY;
+                break;
+            }
+        }
+        curPtr = strtok_r(NULL, " ", &savePtr);
+    }
+
+    OCPayloadArenaFree(arena, input);
+    return result;
+}
+
+static OCStackResult OCParseDiscoveryPayload(OCPayloadArena* arena, OCPayload** outPayload,
+        CborValue* arrayVal)
 {
     if (!outPayload)
     {
@@ -197,8 +375,9 @@ static OCStackResult OCParseDiscoveryPayload(OCPayload** outPayload, CborValue*
 
     bool err = false;
     OCResourcePayload* resource = NULL;
+    OCStackResult listResult = OC_STACK_OK;
 
-    OCDiscoveryPayload* out = OCDiscoveryPayloadCreate();
+    OCDiscoveryPayload* out = OCDiscoveryPayloadCreateInArena(arena);
     if(!out)
     {
         return OC_STACK_NO_MEMORY;
@@ -252,9 +431,10 @@ static OCStackResult OCParseDiscoveryPayload(OCPayload** outPayload, CborValue*
     if (cbor_value_is_map(arrayVal))
     {
         size_t resourceCount = 0;
+        OCResourcePayload** tail = &out->resources;
         while (cbor_value_is_map(arrayVal))
         {
-            resource = (OCResourcePayload*)OICCalloc(1, sizeof(OCResourcePayload));
+            resource = OCResourcePayloadCreateInArena(arena);
             if(!resource)
             {
                 OC_LOG(ERROR, TAG, "Memory allocation failed");
@@ -269,8 +449,7 @@ static OCStackResult OCParseDiscoveryPayload(OCPayload** outPayload, CborValue*
                 OC_LOG(ERROR, TAG, "Cbor find value failed.");
                 goto malformed_cbor;
             }
-            size_t len;
-            err = cbor_value_dup_byte_string(&curVal, &(resource->sid), &len, NULL);
+            err = OCParseCopyString(arena, &curVal, (char**)&(resource->sid));
             if (CborNoError != err)
             {
                 OC_LOG(ERROR, TAG, "Cbor di finding failed.");
@@ -280,14 +459,14 @@ static OCStackResult OCParseDiscoveryPayload(OCPayload** outPayload, CborValue*
             {
                 CborValue linkArray;
                 err = cbor_value_map_find_value(arrayVal, OC_RSRVD_LINKS, &linkArray);
-                if (CborNoError != err)
+                if (CborNoError != err || !cbor_value_is_array(&linkArray))
                 {
                     OC_LOG(ERROR, TAG, "Cbor links finding failed.");
                     goto malformed_cbor;
                 }
                 CborValue linkMap;
                 err = cbor_value_enter_container(&linkArray, &linkMap);
-                if (CborNoError != err)
+                if (CborNoError != err || !cbor_value_is_map(&linkMap))
                 {
                     OC_LOG(ERROR, TAG, "Cbor entering map failed.");
                     goto malformed_cbor;
@@ -299,7 +478,7 @@ static OCStackResult OCParseDiscoveryPayload(OCPayload** outPayload, CborValue*
                     OC_LOG(ERROR, TAG, "Cbor finding href type failed.");
                     goto malformed_cbor;
                 }
-                err = cbor_value_dup_text_string(&curVal, &(resource->uri), &len, NULL);
+                err = OCParseCopyString(arena, &curVal, &(resource->uri));
                 if (CborNoError != err)
                 {
                     OC_LOG(ERROR, TAG, "Cbor finding href value failed.");
@@ -315,36 +494,11 @@ static OCStackResult OCParseDiscoveryPayload(OCPayload** outPayload, CborValue*
                 }
                 if (cbor_value_is_text_string(&rtVal))
                 {
-                    char* input = NULL;
-                    char* savePtr;
-                    err = cbor_value_dup_text_string(&rtVal, &input, &len, NULL);
-                    if (CborNoError != err)
+                    listResult = OCParseStringList(arena, &rtVal, &resource->types);
+                    if (OC_STACK_OK != listResult)
                     {
                         OC_LOG(ERROR, TAG, "Cbor finding rt value failed.");
-                        goto malformed_cbor;
-                    }
-                    if (input)
-                    {
-                        char* curPtr = strtok_r(input, " ", &savePtr);
-
-                        while (curPtr)
-                        {
-                            char* trimmed = InPlaceStringTrim(curPtr);
-                            if (trimmed[0] !='\0')
-                            {
-                                if (!OCResourcePayloadAddResourceType(resource, trimmed))
-                                {
-                                    OICFree(resource->uri);
-                                    OICFree(resource->sid);
-                                    OCFreeOCStringLL(resource->types);
-                                    OICFree(resource);
-                                    OCDiscoveryPayloadDestroy(out);
-                                    return OC_STACK_NO_MEMORY;
-                                }
-                            }
-                            curPtr = strtok_r(NULL, " ", &savePtr);
-                        }
-                        OICFree(input);
+                        goto list_error;
                     }
                 }
 
@@ -358,43 +512,18 @@ static OCStackResult OCParseDiscoveryPayload(OCPayload** outPayload, CborValue*
                 }
                 if (!err && cbor_value_is_text_string(&ifVal))
                 {
-                    char* input = NULL;
-                    char* savePtr;
-                    err = cbor_value_dup_text_string(&ifVal, &input, &len, NULL);
-                    if (CborNoError != err)
+                    listResult = OCParseStringList(arena, &ifVal, &resource->interfaces);
+                    if (OC_STACK_OK != listResult)
                     {
                         OC_LOG(ERROR, TAG, "Cbor finding if value failed.");
-                        goto malformed_cbor;
-                    }
-                    if (input)
-                    {
-                        char* curPtr = strtok_r(input, " ", &savePtr);
-
-                        while (curPtr)
-                        {
-                            char* trimmed = InPlaceStringTrim(curPtr);
-                            if (trimmed[0] !='\0')
-                            {
-                                if (!OCResourcePayloadAddInterface(resource, trimmed))
-                                {
-                                    OICFree(resource->uri);
-                                    OICFree(resource->sid);
-                                    OCFreeOCStringLL(resource->types);
-                                    OICFree(resource);
-                                    OCDiscoveryPayloadDestroy(out);
-                                    return OC_STACK_NO_MEMORY;
-                                }
-                            }
-                            curPtr = strtok_r(NULL, " ", &savePtr);
-                        }
-                        OICFree(input);
+                        goto list_error;
                     }
                 }
                 // Policy
                 {
                     CborValue policyMap;
                     err = cbor_value_map_find_value(&linkMap, OC_RSRVD_POLICY, &policyMap);
-                    if (CborNoError != err)
+                    if (CborNoError != err || !cbor_value_is_map(&policyMap))
                     {
                         OC_LOG(ERROR, TAG, "Cbor finding policy type failed.");
                         goto malformed_cbor;
@@ -402,7 +531,7 @@ static OCStackResult OCParseDiscoveryPayload(OCPayload** outPayload, CborValue*
                     // Bitmap
                     CborValue val;
                     err = cbor_value_map_find_value(&policyMap, OC_RSRVD_BITMAP, &val);
-                    if (CborNoError != err)
+                    if (CborNoError != err || !cbor_value_is_unsigned_integer(&val))
                     {
                         OC_LOG(ERROR, TAG, "Cbor finding bitmap type failed.");
                         goto malformed_cbor;
@@ -422,7 +551,7 @@ static OCStackResult OCParseDiscoveryPayload(OCPayload** outPayload, CborValue*
                         OC_LOG(ERROR, TAG, "Cbor finding secure type failed.");
                         goto malformed_cbor;
                     }
-                    if(cbor_value_is_valid(&val))
+                    if(cbor_value_is_boolean(&val))
                     {
                         err = cbor_value_get_boolean(&val, &(resource->secure));
                         if (CborNoError != err)
@@ -439,7 +568,7 @@ static OCStackResult OCParseDiscoveryPayload(OCPayload** outPayload, CborValue*
                             OC_LOG(ERROR, TAG, "Cbor finding port type failed.");
                             goto malformed_cbor;
                         }
-                        if(cbor_value_is_valid(&port))
+                        if(cbor_value_is_unsigned_integer(&port))
                         {
                             err = cbor_value_get_uint64(&port, &temp);
                             if (CborNoError != err)
@@ -459,19 +588,21 @@ static OCStackResult OCParseDiscoveryPayload(OCPayload** outPayload, CborValue*
                 goto malformed_cbor;
             }
             ++resourceCount;
-            OCDiscoveryPayloadAddNewResource(out, resource);
+            *tail = resource;
+            tail = &resource->next;
         }
     }
 
     *outPayload = (OCPayload*)out;
     return OC_STACK_OK;
 
+list_error:
+    OCDiscoveryResourceDestroy(resource);
+    OCDiscoveryPayloadDestroy(out);
+    return listResult;
+
 malformed_cbor:
-    OICFree(resource->uri);
-    OICFree(resource->sid);
-    OCFreeOCStringLL(resource->types);
-    OCFreeOCStringLL(resource->interfaces);
-    OICFree(resource);
+    OCDiscoveryResourceDestroy(resource);
     OCDiscoveryPayloadDestroy(out);
     return OC_STACK_MALFORMED_RESPONSE;
 
@@ -741,7 +872,7 @@ static bool OCParseArrayFindDimensionsAndType(const CborValue* parent, size_t di
 
     err = err || cbor_value_enter_container(parent, &insideArray);
 
-    while (cbor_value_is_valid(&insideArray))
+    while (!err && cbor_value_is_valid(&insideArray))
     {
         OCRepPayloadPropType tempType = DecodeCborType(cbor_value_get_type(&insideArray));
 
@@ -785,7 +916,7 @@ static bool OCParseArrayFindDimensionsAndType(const CborValue* parent, size_t di
         }
 
         ++dimensions[0];
-        cbor_value_advance(&insideArray);
+        err = err || cbor_value_advance(&insideArray);
     }
 
     return err;
@@ -818,8 +949,8 @@ static size_t arrayStep(size_t dimensions[MAX_REP_ARRAY_DEPTH], size_t elementNu
         elementNum;
 }
 
-static bool OCParseArrayFillArray(const CborValue* parent, size_t dimensions[MAX_REP_ARRAY_DEPTH],
-        OCRepPayloadPropType type, void* targetArray)
+static bool OCParseArrayFillArray(OCPayloadArena* arena, const CborValue* parent,
+        size_t dimensions[MAX_REP_ARRAY_DEPTH], OCRepPayloadPropType type, void* targetArray)
 {
     bool err = false;
     CborValue insideArray;
@@ -827,8 +958,6 @@ static bool OCParseArrayFillArray(const CborValue* parent, size_t dimensions[MAX
     err = err || cbor_value_enter_container(parent, &insideArray);
 
     size_t i = 0;
-    char* tempStr = NULL;
-    size_t tempLen = 0;
     OCRepPayload* tempPl = NULL;
 
     size_t newdim[MAX_REP_ARRAY_DEPTH];
@@ -838,7 +967,18 @@ static bool OCParseArrayFillArray(const CborValue* parent, size_t dimensions[MAX
 
     while (!err && i < dimensions[0] && cbor_value_is_valid(&insideArray))
     {
-        if (cbor_value_get_type(&insideArray) != CborNullType)
+        if (dimensions[1] == 0 ?
+                DecodeCborType(cbor_value_get_type(&insideArray)) != type :
+                !cbor_value_is_array(&insideArray))
+        {
+            // the type was found from the other elements, this one may be a tag or a float
+            if (cbor_value_get_type(&insideArray) != CborNullType)
+            {
+                OC_LOG(ERROR, TAG, "Mismatched element in Parse Array");
+                err = true;
+            }
+        }
+        else
         {
             switch (type)
             {
@@ -850,7 +990,7 @@ static bool OCParseArrayFillArray(const CborValue* parent, size_t dimensions[MAX
                     }
                     else
                     {
-                        err = err || OCParseArrayFillArray(&insideArray, newdim,
+                        err = err || OCParseArrayFillArray(arena, &insideArray, newdim,
                             type,
                             &(((int64_t*)targetArray)[arrayStep(dimensions, i)])
                             );
@@ -864,7 +1004,7 @@ static bool OCParseArrayFillArray(const CborValue* parent, size_t dimensions[MAX
                     }
                     else
                     {
-                        err = err || OCParseArrayFillArray(&insideArray, newdim,
+                        err = err || OCParseArrayFillArray(arena, &insideArray, newdim,
                             type,
                             &(((double*)targetArray)[arrayStep(dimensions, i)])
                             );
@@ -878,7 +1018,7 @@ static bool OCParseArrayFillArray(const CborValue* parent, size_t dimensions[MAX
                     }
                     else
                     {
-                        err = err || OCParseArrayFillArray(&insideArray, newdim,
+                        err = err || OCParseArrayFillArray(arena, &insideArray, newdim,
                             type,
                             &(((bool*)targetArray)[arrayStep(dimensions, i)])
                             );
@@ -887,14 +1027,12 @@ static bool OCParseArrayFillArray(const CborValue* parent, size_t dimensions[MAX
                 case OCREP_PROP_STRING:
                     if (dimensions[1] == 0)
                     {
-                        err = err || cbor_value_dup_text_string(&insideArray,
-                                &tempStr, &tempLen, NULL);
-                        ((char**)targetArray)[i] = tempStr;
-                        tempStr = NULL;
+                        err = err || OCParseCopyString(arena, &insideArray,
+                                &(((char**)targetArray)[i]));
                     }
                     else
                     {
-                        err = err || OCParseArrayFillArray(&insideArray, newdim,
+                        err = err || OCParseArrayFillArray(arena, &insideArray, newdim,
                             type,
                             &(((char**)targetArray)[arrayStep(dimensions, i)])
                             );
@@ -903,13 +1041,13 @@ static bool OCParseArrayFillArray(const CborValue* parent, size_t dimensions[MAX
                 case OCREP_PROP_OBJECT:
                     if (dimensions[1] == 0)
                     {
-                        err = err || OCParseSingleRepPayload(&tempPl, &insideArray);
+                        err = err || OCParseSingleRepPayload(arena, &tempPl, &insideArray);
                         ((OCRepPayload**)targetArray)[i] = tempPl;
                         tempPl = NULL;
                     }
                     else
                     {
-                        err = err || OCParseArrayFillArray(&insideArray, newdim,
+                        err = err || OCParseArrayFillArray(arena, &insideArray, newdim,
                             type,
                             &(((OCRepPayload**)targetArray)[arrayStep(dimensions, i)])
                             );
@@ -928,7 +1066,8 @@ static bool OCParseArrayFillArray(const CborValue* parent, size_t dimensions[MAX
     return err;
 }
 
-static bool OCParseArray(OCRepPayload* out, const char* name, CborValue* container)
+// Fill val, which is of type OCREP_PROP_NULL, with the array in container
+static bool OCParseArray(OCPayloadArena* arena, OCRepPayloadValue* val, CborValue* container)
 {
     OCRepPayloadPropType type;
     size_t dimensions[MAX_REP_ARRAY_DEPTH];
@@ -940,16 +1079,15 @@ static bool OCParseArray(OCRepPayload* out, const char* name, CborValue* contain
         return err;
     }
 
+    // an empty array or one of nulls stays a null, the caller advances past it
     if (type == OCREP_PROP_NULL)
     {
-        err = err || OCRepPayloadSetNull(out, name);
-        err = err || cbor_value_advance(container);
         return err;
     }
 
     size_t dimTotal = calcDimTotal(dimensions);
     size_t allocSize = getAllocSize(type);
-    void* arr = OICCalloc(dimTotal, allocSize);
+    void* arr = OCPayloadArenaCalloc(arena, dimTotal, allocSize);
 
     if (!arr)
     {
@@ -957,70 +1095,48 @@ static bool OCParseArray(OCRepPayload* out, const char* name, CborValue* contain
         return true;
     }
 
-    err = err || OCParseArrayFillArray(container, dimensions, type, arr);
+    err = err || OCParseArrayFillArray(arena, container, dimensions, type, arr);
 
     switch (type)
     {
         case OCREP_PROP_INT:
-            if (err || !OCRepPayloadSetIntArrayAsOwner(out, name, (int64_t*)arr, dimensions))
-            {
-                OICFree(arr);
-                err = true;
-            }
+            val->arr.iArray = (int64_t*)arr;
             break;
         case OCREP_PROP_DOUBLE:
-            if (err || !OCRepPayloadSetDoubleArrayAsOwner(out, name, (double*)arr, dimensions))
-            {
-                OICFree(arr);
-                err = true;
-            }
+            val->arr.dArray = (double*)arr;
             break;
         case OCREP_PROP_BOOL:
-            if (err || !OCRepPayloadSetBoolArrayAsOwner(out, name, (bool*)arr, dimensions))
-            {
-                OICFree(arr);
-                err = true;
-            }
+            val->arr.bArray = (bool*)arr;
             break;
         case OCREP_PROP_STRING:
-            if (err || !OCRepPayloadSetStringArrayAsOwner(out, name, (char**)arr, dimensions))
-            {
-                for(size_t i = 0; i < dimTotal; ++i)
-                {
-                    OICFree(((char**)arr)[i]);
-                }
-                OICFree(arr);
-                err = true;
-            }
+            val->arr.strArray = (char**)arr;
             break;
         case OCREP_PROP_OBJECT:
-            if (err || !OCRepPayloadSetPropObjectArrayAsOwner(out, name, (OCRepPayload**)arr, dimensions))
-            {
-                for(size_t i = 0; i < dimTotal; ++i)
-                {
-                    OCRepPayloadDestroy(((OCRepPayload**)arr)[i]);
-                }
-                OICFree(arr);
-                err = true;
-            }
+            val->arr.objArray = (OCRepPayload**)arr;
             break;
         default:
             OC_LOG(ERROR, TAG, "Invalid Array type in Parse Array");
-            err = true;
-            break;
+            OCPayloadArenaFree(arena, arr);
+            return true;
     }
 
+    // the array is freed with the value
+    val->type = OCREP_PROP_ARRAY;
+    val->arr.type = type;
+    memcpy(val->arr.dimensions, dimensions, MAX_REP_ARRAY_DEPTH * sizeof(size_t));
+
     return err;
 }
 
-static bool OCParseSingleRepPayload(OCRepPayload** outPayload, CborValue* repParent)
+static bool OCParseSingleRepPayload(OCPayloadArena* arena, OCRepPayload** outPayload,
+        CborValue* repParent)
 {
     if (!outPayload)
     {
         return false;
     }
 
-    *outPayload = OCRepPayloadCreate();
+    *outPayload = OCRepPayloadCreateInArena(arena);
     OCRepPayload* curPayload = *outPayload;
     bool err = false;
     if(!*outPayload)
@@ -1028,17 +1144,15 @@ static bool OCParseSingleRepPayload(OCRepPayload** outPayload, CborValue* repPar
         return CborErrorOutOfMemory;
     }
 
-    size_t len;
     CborValue curVal;
     err = err || cbor_value_map_find_value(repParent, OC_RSRVD_HREF, &curVal);
     if(cbor_value_is_valid(&curVal))
     {
-        err = err || cbor_value_dup_text_string(&curVal, &curPayload->uri, &len,
-            NULL);
+        err = err || OCParseCopyString(arena, &curVal, &curPayload->uri);
     }
 
     err = err || cbor_value_map_find_value(repParent, OC_RSRVD_PROPERTY, &curVal);
-    if(cbor_value_is_valid(&curVal))
+    if(cbor_value_is_map(&curVal))
     {
         CborValue insidePropValue = {0};
         err = err || cbor_value_map_find_value(&curVal, OC_RSRVD_RESOURCE_TYPE,
@@ -1046,52 +1160,16 @@ static bool OCParseSingleRepPayload(OCRepPayload** outPayload, CborValue* repPar
 
         if(cbor_value_is_text_string(&insidePropValue))
         {
-            char* allRt = NULL;
-            err = err || cbor_value_dup_text_string(&insidePropValue, &allRt, &len, NULL);
-
-            char* savePtr;
-
-            if (allRt)
-            {
-                char* curPtr = strtok_r(allRt, " ", &savePtr);
-
-                while (curPtr)
-                {
-                    char* trimmed = InPlaceStringTrim(curPtr);
-                    if (trimmed[0] != '\0')
-                    {
-                        OCRepPayloadAddResourceType(curPayload, curPtr);
-                    }
-                    curPtr = strtok_r(NULL, " ", &savePtr);
-                }
-            }
-            OICFree(allRt);
+            err = err || OC_STACK_OK != OCParseStringList(arena, &insidePropValue,
+                    &curPayload->types);
         }
 
         err = err || cbor_value_map_find_value(&curVal, OC_RSRVD_INTERFACE, &insidePropValue);
 
         if(cbor_value_is_text_string(&insidePropValue))
         {
-            char* allIf = NULL;
-            err = err || cbor_value_dup_text_string(&insidePropValue, &allIf, &len, NULL);
-
-            char* savePtr;
-
-            if (allIf)
-            {
-                char* curPtr = strtok_r(allIf, " ", &savePtr);
-
-                while (curPtr)
-                {
-                    char* trimmed = InPlaceStringTrim(curPtr);
-                    if (trimmed[0] != '\0')
-                    {
-                        OCRepPayloadAddInterface(curPayload, curPtr);
-                    }
-                    curPtr = strtok_r(NULL, " ", &savePtr);
-                }
-            }
-            OICFree(allIf);
+            err = err || OC_STACK_OK != OCParseStringList(arena, &insidePropValue,
+                    &curPayload->interfaces);
         }
     }
 
@@ -1104,66 +1182,59 @@ static bool OCParseSingleRepPayload(OCRepPayload** outPayload, CborValue* repPar
         while(!err && cbor_value_is_valid(&repMap))
         {
             char* name = NULL;
-            err = err || cbor_value_dup_text_string(&repMap, &name, &len, NULL);
+            err = err || OCParseCopyString(arena, &repMap, &name);
 
             err = err || cbor_value_advance(&repMap);
 
-            int64_t intval = 0;
-            bool boolval = false;
-            char* strval = NULL;
-            double doubleval = 0;
-            OCRepPayload* pl = NULL;
+            OCRepPayloadValue* val = NULL;
+            if (err)
+            {
+                OCPayloadArenaFree(arena, name);
+            }
+            else
+            {
+                // added as a null, and parsed into place below
+                val = OCRepPayloadAddValue(curPayload, name, OCREP_PROP_NULL);
+                err = !val;
+            }
 
-            switch(cbor_value_get_type(&repMap))
+            if (!err)
             {
-                case CborNullType:
-                    err = !OCRepPayloadSetNull(curPayload, name);
-                    break;
-                case CborIntegerType:
-                    err = err || cbor_value_get_int64(&repMap, &intval);
-                    if (!err)
-                    {
-                        err = !OCRepPayloadSetPropInt(curPayload, name, intval);
-                    }
-                    break;
-                case CborDoubleType:
-                    err = err || cbor_value_get_double(&repMap, &doubleval);
-                    if (!err)
-                    {
-                        err = !OCRepPayloadSetPropDouble(curPayload, name, doubleval);
-                    }
-                    break;
-                case CborBooleanType:
-                    err = err || cbor_value_get_boolean(&repMap, &boolval);
-                    if (!err)
-                    {
-                        err = !OCRepPayloadSetPropBool(curPayload, name, boolval);
-                    }
-                    break;
-                case CborTextStringType:
-                    err = err || cbor_value_dup_text_string(&repMap, &strval, &len, NULL);
-                    if (!err)
-                    {
-                        err = !OCRepPayloadSetPropStringAsOwner(curPayload, name, strval);
-                    }
-                    break;
-                case CborMapType:
-                    err = err || OCParseSingleRepPayload(&pl, &repMap);
-                    if (!err)
-                    {
-                        err = !OCRepPayloadSetPropObjectAsOwner(curPayload, name, pl);
-                    }
-                    break;
-                case CborArrayType:
-                    err = err || OCParseArray(curPayload, name, &repMap);
-                    break;
-                default:
-                    OC_LOG_V(ERROR, TAG, "Parsing rep property, unknown type %d", repMap.type);
-                    err = true;
+                switch(cbor_value_get_type(&repMap))
+                {
+                    case CborNullType:
+                        break;
+                    case CborIntegerType:
+                        err = err || cbor_value_get_int64(&repMap, &val->i);
+                        val->type = OCREP_PROP_INT;
+                        break;
+                    case CborDoubleType:
+                        err = err || cbor_value_get_double(&repMap, &val->d);
+                        val->type = OCREP_PROP_DOUBLE;
+                        break;
+                    case CborBooleanType:
+                        err = err || cbor_value_get_boolean(&repMap, &val->b);
+                        val->type = OCREP_PROP_BOOL;
+                        break;
+                    case CborTextStringType:
+                        err = err || OCParseCopyString(arena, &repMap, &val->str);
+                        val->type = OCREP_PROP_STRING;
+                        break;
+                    case CborMapType:
+                        err = err || OCParseSingleRepPayload(arena, &val->obj, &repMap);
+                        val->type = OCREP_PROP_OBJECT;
+                        break;
+                    case CborArrayType:
+                        err = err || OCParseArray(arena, val, &repMap);
+                        break;
+                    default:
+                        OC_LOG_V(ERROR, TAG, "Parsing rep property, unknown type %d",
+                                repMap.type);
+                        err = true;
+                }
             }
 
              err = err || cbor_value_advance(&repMap);
-            OICFree(name);
         }
         err = err || cbor_value_leave_container(&curVal, &repMap);
     }
@@ -1176,7 +1247,8 @@ static bool OCParseSingleRepPayload(OCRepPayload** outPayload, CborValue* repPar
 
     return err;
 }
-static OCStackResult OCParseRepPayload(OCPayload** outPayload, CborValue* arrayVal)
+static OCStackResult OCParseRepPayload(OCPayloadArena* arena, OCPayload** outPayload,
+        CborValue* arrayVal)
 {
     if (!outPayload)
     {
@@ -1190,7 +1262,7 @@ static OCStackResult OCParseRepPayload(OCPayload** outPayload, CborValue* arrayV
     OCRepPayload* temp = NULL;
     while(!err && cbor_value_is_map(arrayVal))
     {
-         err = err || OCParseSingleRepPayload(&temp, arrayVal);
+         err = err || OCParseSingleRepPayload(arena, &temp, arrayVal);
 
         if(rootPayload == NULL)
         {
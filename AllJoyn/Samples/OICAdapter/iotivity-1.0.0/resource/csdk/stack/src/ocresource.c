@@ -35,6 +35,7 @@
 #include "logger.h"
 #include "cJSON.h"
 #include "ocpayload.h"
+#include "ocpayloadcbor.h"
 #include "secureresourcemanager.h"
 #include "cacommon.h"
 #include "cainterface.h"
@@ -292,6 +293,50 @@ OCStackResult BuildVirtualResourceResponse(const OCResource *resourcePtr,
     return OC_STACK_OK;
 }
 
+/*
+ * Links the discovery fragment of a resource into the payload, building it first if the
+ * resource changed since the last discovery.  The payload only borrows the fragment.
+ */
+static OCStackResult AddDiscoveryFragment(OCResource *resourcePtr, OCDiscoveryPayload *payload,
+                                          OCResourcePayload **tail, OCDevAddr *devAddr)
+{
+    uint16_t port = 0;
+    if (resourcePtr->resourceProperties & OC_SECURE)
+    {
+       if (GetSecurePortInfo(devAddr, &port) != OC_STACK_OK)
+       {
+           port = 0;
+       }
+    }
+
+    if (!resourcePtr->discoveryFragment)
+    {
+        resourcePtr->discoveryFragment = OCDiscoveryResourceCreate(resourcePtr, port);
+        if (!resourcePtr->discoveryFragment)
+        {
+            return OC_STACK_NO_MEMORY;
+        }
+    }
+
+    // Properties and the secure port can change without the fragment being dropped.
+    OCResourcePayload *fragment = resourcePtr->discoveryFragment;
+    fragment->bitmap = resourcePtr->resourceProperties & (OC_OBSERVABLE | OC_DISCOVERABLE);
+    fragment->secure = (resourcePtr->resourceProperties & OC_SECURE) != 0;
+    fragment->port = port;
+    fragment->next = NULL;
+
+    if (*tail)
+    {
+        (*tail)->next = fragment;
+    }
+    else
+    {
+        payload->resources = fragment;
+    }
+    *tail = fragment;
+    return OC_STACK_OK;
+}
+
 OCStackResult BuildVirtualCollectionResourceResponse(const OCResourceCollectionPayload *resourcePtr,
         OCDiscoveryPayload *payload, OCDevAddr *devAddr)
 {
@@ -331,6 +376,228 @@ uint8_t IsCollectionResource (OCResource *resource)
     return 0;
 }
 
+//-----------------------------------------------------------------------------
+// Resource indexes
+//-----------------------------------------------------------------------------
+
+/** Name index entry; lists the bindings of one resource type or interface name.*/
+typedef struct resourcenameentry_t
+{
+    OICHashLink_t link;
+    char *name;
+    size_t count;
+    OCResourceIndexLink *head;
+    OCResourceIndexLink *tail;
+} OCResourceNameEntry;
+
+static OICHashTable_t g_uriIndex;
+static OICHashTable_t g_handleIndex;
+
+static OICHashTable_t g_typeIndex;
+static OICHashTable_t g_interfaceIndex;
+
+// Set when a binding could not be indexed; discovery then visits every resource.
+static bool g_nameIndexIncomplete = false;
+
+static OCResourceNameEntry *FindNameEntry(const OICHashTable_t *index, const char *name)
+{
+    if (!name)
+    {
+        return NULL;
+    }
+
+    for (OICHashLink_t *link = OICHashTableFind(index, OICHashString(name)); link;
+         link = OICHashTableFindNext(link))
+    {
+        OCResourceNameEntry *entry = OIC_HASH_ENTRY(link, OCResourceNameEntry, link);
+        if (strcmp(entry->name, name) == 0)
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void AddNameLink(OICHashTable_t *index, const char *name, OCResource *resource,
+                        OCResourceIndexLink *link)
+{
+    OCResourceNameEntry *entry = FindNameEntry(index, name);
+    if (!entry)
+    {
+        entry = (OCResourceNameEntry *) OICCalloc(1, sizeof(OCResourceNameEntry));
+        if (!entry || !(entry->name = OICStrdup(name)) ||
+            !OICHashTableInsert(index, &entry->link, OICHashString(name)))
+        {
+            OC_LOG_V(ERROR, TAG, "Failed to index %s", name);
+            if (entry)
+            {
+                OICFree(entry->name);
+            }
+            OICFree(entry);
+            g_nameIndexIncomplete = true;
+            return;
+        }
+    }
+
+    link->resource = resource;
+    link->next = NULL;
+    link->prev = entry->tail;
+    if (entry->tail)
+    {
+        entry->tail->next = link;
+    }
+    else
+    {
+        entry->head = link;
+    }
+    entry->tail = link;
+    entry->count++;
+}
+
+static void RemoveNameLink(OICHashTable_t *index, const char *name,
+                           OCResourceIndexLink *link)
+{
+    if (!link->resource)
+    {
+        return;
+    }
+
+    OCResourceNameEntry *entry = FindNameEntry(index, name);
+    link->resource = NULL;
+    if (!entry)
+    {
+        return;
+    }
+
+    if (link->prev)
+    {
+        link->prev->next = link->next;
+    }
+    else
+    {
+        entry->head = link->next;
+    }
+    if (link->next)
+    {
+        link->next->prev = link->prev;
+    }
+    else
+    {
+        entry->tail = link->prev;
+    }
+    link->prev = NULL;
+    link->next = NULL;
+
+    if (--entry->count == 0)
+    {
+        OICHashTableRemove(index, &entry->link);
+        OICFree(entry->name);
+        OICFree(entry);
+    }
+}
+
+static void DeleteNameIndex(OICHashTable_t *index)
+{
+    for (size_t i = 0; i < index->size; i++)
+    {
+        while (index->buckets[i])
+        {
+            OCResourceNameEntry *entry =
+                OIC_HASH_ENTRY(index->buckets[i], OCResourceNameEntry, link);
+            OICHashTableRemove(index, &entry->link);
+            OICFree(entry->name);
+            OICFree(entry);
+        }
+    }
+    OICHashTableClear(index);
+}
+
+static void DropDiscoveryFragment(OCResource *resource)
+{
+    if (resource->discoveryFragment)
+    {
+        // Fragments are only linked into a discovery payload while it is being sent.
+        resource->discoveryFragment->next = NULL;
+        OCDiscoveryResourceDestroy(resource->discoveryFragment);
+        resource->discoveryFragment = NULL;
+    }
+}
+
+OCStackResult AddResourceToIndex(OCResource *resource)
+{
+    if (!resource || !resource->uri)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    if (!OICHashTableReserve(&g_uriIndex, g_uriIndex.count + 1) ||
+        !OICHashTableReserve(&g_handleIndex, g_handleIndex.count + 1))
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+
+    OICHashTableInsert(&g_uriIndex, &resource->uriLink, OICHashString(resource->uri));
+    OICHashTableInsert(&g_handleIndex, &resource->handleLink, OICHashPointer(resource));
+    InvalidateDiscoveryResponses();
+    return OC_STACK_OK;
+}
+
+void RemoveResourceFromIndex(OCResource *resource)
+{
+    if (!resource)
+    {
+        return;
+    }
+
+    OICHashTableRemove(&g_uriIndex, &resource->uriLink);
+    OICHashTableRemove(&g_handleIndex, &resource->handleLink);
+
+    for (OCResourceType *type = resource->rsrcType; type; type = type->next)
+    {
+        RemoveNameLink(&g_typeIndex, type->resourcetypename, &type->indexLink);
+    }
+    for (OCResourceInterface *iface = resource->rsrcInterface; iface; iface = iface->next)
+    {
+        RemoveNameLink(&g_interfaceIndex, iface->name, &iface->indexLink);
+    }
+
+    DropDiscoveryFragment(resource);
+    InvalidateDiscoveryResponses();
+}
+
+void IndexResourceType(OCResource *resource, OCResourceType *resourceType)
+{
+    if (resource && resourceType && resourceType->resourcetypename)
+    {
+        AddNameLink(&g_typeIndex, resourceType->resourcetypename, resource,
+                    &resourceType->indexLink);
+        DropDiscoveryFragment(resource);
+        InvalidateDiscoveryResponses();
+    }
+}
+
+void IndexResourceInterface(OCResource *resource, OCResourceInterface *resourceInterface)
+{
+    if (resource && resourceInterface && resourceInterface->name)
+    {
+        AddNameLink(&g_interfaceIndex, resourceInterface->name, resource,
+                    &resourceInterface->indexLink);
+        DropDiscoveryFragment(resource);
+        InvalidateDiscoveryResponses();
+    }
+}
+
+void DeleteResourceIndex()
+{
+    OICHashTableClear(&g_uriIndex);
+    OICHashTableClear(&g_handleIndex);
+
+    DeleteNameIndex(&g_typeIndex);
+    DeleteNameIndex(&g_interfaceIndex);
+    g_nameIndexIncomplete = false;
+    InvalidateDiscoveryResponses();
+}
+
 OCResource *FindResourceByUri(const char* resourceUri)
 {
     if(!resourceUri)
@@ -338,19 +605,92 @@ OCResource *FindResourceByUri(const char* resourceUri)
         return NULL;
     }
 
-    OCResource * pointer = headResource;
-    while (pointer)
+    for (OICHashLink_t *link = OICHashTableFind(&g_uriIndex, OICHashString(resourceUri)); link;
+         link = OICHashTableFindNext(link))
     {
+        OCResource *pointer = OIC_HASH_ENTRY(link, OCResource, uriLink);
         if (strcmp(resourceUri, pointer->uri) == 0)
         {
             return pointer;
         }
-        pointer = pointer->next;
     }
     OC_LOG_V(INFO, TAG, "Resource %s not found", resourceUri);
     return NULL;
 }
 
+OCResource *FindResourceByHandle(OCResourceHandle handle)
+{
+    if (!handle)
+    {
+        return NULL;
+    }
+
+    for (OICHashLink_t *link = OICHashTableFind(&g_handleIndex, OICHashPointer(handle)); link;
+         link = OICHashTableFindNext(link))
+    {
+        OCResource *pointer = OIC_HASH_ENTRY(link, OCResource, handleLink);
+        if (pointer == (OCResource *) handle)
+        {
+            return pointer;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Returns true if a discovery request with these filters can be answered from the
+ * resource type or interface index; *candidates is then the first binding to visit.
+ */
+static bool GetDiscoveryCandidates(char *interfaceFilter, char *resourceTypeFilter,
+                                   OCResourceIndexLink **candidates)
+{
+    *candidates = NULL;
+
+#ifdef WITH_RD
+    // The resource directory has to see every resource.
+    (void) interfaceFilter;
+    (void) resourceTypeFilter;
+    return false;
+#else
+    bool hasInterfaceFilter = interfaceFilter && *interfaceFilter;
+    bool hasTypeFilter = resourceTypeFilter && *resourceTypeFilter;
+    if (g_nameIndexIncomplete || (!hasInterfaceFilter && !hasTypeFilter))
+    {
+        return false;
+    }
+
+    OCResourceNameEntry *typeEntry = hasTypeFilter ?
+        FindNameEntry(&g_typeIndex, resourceTypeFilter) : NULL;
+    OCResourceNameEntry *interfaceEntry = hasInterfaceFilter ?
+        FindNameEntry(&g_interfaceIndex, interfaceFilter) : NULL;
+
+    if ((hasTypeFilter && !typeEntry) || (hasInterfaceFilter && !interfaceEntry))
+    {
+        return true;
+    }
+
+    // Visit the shorter list; the other filter is still checked per resource.
+    OCResourceNameEntry *entry = typeEntry;
+    if (!entry || (interfaceEntry && interfaceEntry->count < entry->count))
+    {
+        entry = interfaceEntry;
+    }
+    *candidates = entry->head;
+    return true;
+#endif
+}
+
+static OCResource *NextDiscoveryResource(OCResource *resource, OCResourceIndexLink **candidate,
+                                         bool useIndex)
+{
+    if (!useIndex)
+    {
+        return resource->next;
+    }
+
+    *candidate = (*candidate)->next;
+    return *candidate ? (*candidate)->resource : NULL;
+}
 
 OCStackResult DetermineResourceHandling (const OCServerRequest *request,
                                          ResourceHandling *handling,
@@ -557,6 +897,128 @@ static bool includeThisResourceInResponse(OCResource *resource,
 
 }
 
+//-----------------------------------------------------------------------------
+// Encoded discovery responses
+//-----------------------------------------------------------------------------
+
+/** Number of encoded discovery responses kept; requests mostly differ in their filters.*/
+#define DISCOVERY_RESPONSE_CACHE_SIZE (8)
+
+/**
+ * Encoded response to a discovery request.  Besides the resources and the device and
+ * platform information, it depends on the query and, through the secure port, on the
+ * transport the request came in on.
+ */
+typedef struct
+{
+    OCVirtualResources uri;
+    OCTransportAdapter adapter;
+    OCTransportFlags family;
+    char *query;
+    uint8_t *payload;
+    size_t payloadSize;
+    uint32_t lastUsed;
+} OCDiscoveryResponse;
+
+static OCDiscoveryResponse g_discoveryResponses[DISCOVERY_RESPONSE_CACHE_SIZE];
+static uint32_t g_discoveryResponseUses = 0;
+
+void InvalidateDiscoveryResponses()
+{
+    for (size_t i = 0; i < DISCOVERY_RESPONSE_CACHE_SIZE; i++)
+    {
+        OICFree(g_discoveryResponses[i].query);
+        OICFree(g_discoveryResponses[i].payload);
+    }
+    memset(g_discoveryResponses, 0, sizeof(g_discoveryResponses));
+}
+
+static bool IsDiscoveryResponseCacheable(const OCServerRequest *request,
+                                         OCVirtualResources uri)
+{
+    return (uri == OC_WELL_KNOWN_URI || uri == OC_DEVICE_URI || uri == OC_PLATFORM_URI) &&
+           (request->acceptFormat == OC_FORMAT_UNDEFINED ||
+            request->acceptFormat == OC_FORMAT_CBOR);
+}
+
+static OCTransportFlags GetDiscoveryResponseFamily(const OCDevAddr *devAddr)
+{
+    return (OCTransportFlags)(devAddr->flags & (OC_IP_USE_V4 | OC_IP_USE_V6));
+}
+
+static const OCDiscoveryResponse *FindEncodedDiscoveryResponse(const OCServerRequest *request,
+                                                               OCVirtualResources uri)
+{
+    OCTransportFlags family = GetDiscoveryResponseFamily(&request->devAddr);
+    for (size_t i = 0; i < DISCOVERY_RESPONSE_CACHE_SIZE; i++)
+    {
+        OCDiscoveryResponse *entry = &g_discoveryResponses[i];
+        if (entry->payload && entry->uri == uri && entry->adapter == request->devAddr.adapter &&
+            entry->family == family && strcmp(entry->query, request->query) == 0)
+        {
+            entry->lastUsed = ++g_discoveryResponseUses;
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Encodes a discovery payload into the least recently used entry.
+ * @return the entry, NULL if the payload could not be encoded or kept.
+ */
+static const OCDiscoveryResponse *EncodeDiscoveryResponse(const OCServerRequest *request,
+                                                          OCVirtualResources uri,
+                                                          OCPayload *payload)
+{
+    OCDiscoveryResponse *entry = &g_discoveryResponses[0];
+    for (size_t i = 1; i < DISCOVERY_RESPONSE_CACHE_SIZE; i++)
+    {
+        if (g_discoveryResponses[i].lastUsed < entry->lastUsed)
+        {
+            entry = &g_discoveryResponses[i];
+        }
+    }
+
+    uint8_t *encoded = NULL;
+    size_t encodedSize = 0;
+    if (OCConvertPayload(payload, &encoded, &encodedSize) != OC_STACK_OK)
+    {
+        return NULL;
+    }
+    char *query = OICStrdup(request->query);
+    if (!query)
+    {
+        OICFree(encoded);
+        return NULL;
+    }
+
+    OICFree(entry->query);
+    OICFree(entry->payload);
+    entry->uri = uri;
+    entry->adapter = request->devAddr.adapter;
+    entry->family = GetDiscoveryResponseFamily(&request->devAddr);
+    entry->query = query;
+    entry->payload = encoded;
+    entry->payloadSize = encodedSize;
+    entry->lastUsed = ++g_discoveryResponseUses;
+    return entry;
+}
+
+static OCStackResult SendEncodedDiscoveryResponse(OCServerRequest *request, OCResource *resource,
+                                                  const OCDiscoveryResponse *discoveryResponse)
+{
+    OCEntityHandlerResponse response = {0};
+
+    response.ehResult = OC_EH_OK;
+    response.requestHandle = (OCRequestHandle) request;
+    response.resourceHandle = (OCResourceHandle) resource;
+
+    // Virtual resources are always answered by HandleSingleResponse.
+    return HandleEncodedResponse(&response, discoveryResponse->payload,
+                                 discoveryResponse->payloadSize);
+}
+
 OCStackResult SendNonPersistantDiscoveryResponse(OCServerRequest *request, OCResource *resource,
                                 OCPayload *discoveryPayload, OCEntityHandlerResult ehResult)
 {
@@ -598,12 +1060,27 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
     OCStackResult discoveryResult = OC_STACK_ERROR;
 
     bool bMulticast    = false;     // Was the discovery request a multicast request?
+    bool foundResourceAtRD = false;
     OCPayload* payload = NULL;
 
     OC_LOG(INFO, TAG, "Entering HandleVirtualResource");
 
     OCVirtualResources virtualUriInRequest = GetTypeOfVirtualURI (request->resourceUrl);
 
+    // Step 0: Repeat the response to an earlier request, if nothing changed since then
+    bool cacheable = IsDiscoveryResponseCacheable(request, virtualUriInRequest);
+    if (cacheable)
+    {
+        const OCDiscoveryResponse *cached =
+            FindEncodedDiscoveryResponse(request, virtualUriInRequest);
+        if (cached)
+        {
+            OC_LOG(INFO, TAG, "Sending the cached discovery response");
+            SendEncodedDiscoveryResponse(request, resource, cached);
+            return OC_STACK_OK;
+        }
+    }
+
     // Step 1: Generate the response to discovery request
     if (virtualUriInRequest == OC_WELL_KNOWN_URI)
     {
@@ -619,8 +1096,16 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
 
             if(payload)
             {
-                bool foundResourceAtRD = false;
-                for(;resource && discoveryResult == OC_STACK_OK; resource = resource->next)
+                OCResourceIndexLink *candidate = NULL;
+                OCResourcePayload *tail = NULL;
+                bool useIndex = GetDiscoveryCandidates(filterOne, filterTwo, &candidate);
+                if (useIndex)
+                {
+                    resource = candidate ? candidate->resource : NULL;
+                }
+
+                for(;resource && discoveryResult == OC_STACK_OK;
+                    resource = NextDiscoveryResource(resource, &candidate, useIndex))
                 {
 #ifdef WITH_RD
                     if (strcmp(resource->uri, OC_RSRVD_RD_URI) == 0)
@@ -639,8 +1124,8 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
 #endif
                     if(!foundResourceAtRD && includeThisResourceInResponse(resource, filterOne, filterTwo))
                     {
-                        discoveryResult = BuildVirtualResourceResponse(resource,
-                                (OCDiscoveryPayload*)payload,
+                        discoveryResult = AddDiscoveryFragment(resource,
+                                (OCDiscoveryPayload*)payload, &tail,
                                 &request->devAddr);
                     }
                 }
@@ -736,7 +1221,22 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
     {
         if(discoveryResult == OC_STACK_OK)
         {
-            SendNonPersistantDiscoveryResponse(request, resource, payload, OC_EH_OK);
+            // Resources of the directory change without the resources of the stack changing,
+            // so responses that include them are not kept.
+            const OCDiscoveryResponse *stored = NULL;
+            if (cacheable && !foundResourceAtRD)
+            {
+                stored = EncodeDiscoveryResponse(request, virtualUriInRequest, payload);
+            }
+
+            if (stored)
+            {
+                SendEncodedDiscoveryResponse(request, resource, stored);
+            }
+            else
+            {
+                SendNonPersistantDiscoveryResponse(request, resource, payload, OC_EH_OK);
+            }
         }
         else if(bMulticast == false)
         {
@@ -753,6 +1253,11 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
         }
     }
 
+    if (virtualUriInRequest == OC_WELL_KNOWN_URI && payload)
+    {
+        // The resource payloads are the discovery fragments owned by the resources.
+        ((OCDiscoveryPayload*)payload)->resources = NULL;
+    }
     OCPayloadDestroy(payload);
 
     return OC_STACK_OK;
@@ -877,13 +1382,14 @@ HandleResourceWithEntityHandler (OCServerRequest *request,
         }
 
         result = GenerateObserverId(&ehRequest.obsInfo.obsId);
-        VERIFY_SUCCESS(result, OC_STACK_OK);
-
-        result = AddObserver ((const char*)(request->resourceUrl),
-                (const char *)(request->query),
-                ehRequest.obsInfo.obsId, request->requestToken, request->tokenLength,
-                resource, request->qos, request->acceptFormat,
-                &request->devAddr);
+        if(result == OC_STACK_OK)
+        {
+            result = AddObserver ((const char*)(request->resourceUrl),
+                    (const char *)(request->query),
+                    ehRequest.obsInfo.obsId, request->requestToken, request->tokenLength,
+                    resource, request->qos, request->acceptFormat,
+                    &request->devAddr);
+        }
 
         if(result == OC_STACK_OK)
         {
@@ -1044,6 +1550,7 @@ ProcessRequest(ResourceHandling resHandling, OCResource *resource, OCServerReque
 void DeletePlatformInfo()
 {
     OC_LOG(INFO, TAG, "Deleting platform info.");
+    InvalidateDiscoveryResponses();
 
     OICFree(savedPlatformInfo.platformID);
     savedPlatformInfo.platformID = NULL;
@@ -1134,6 +1641,7 @@ OCStackResult SavePlatformInfo(OCPlatformInfo info)
 void DeleteDeviceInfo()
 {
     OC_LOG(INFO, TAG, "Deleting device info.");
+    InvalidateDiscoveryResponses();
 
     OICFree(savedDeviceInfo.deviceName);
     savedDeviceInfo.deviceName = NULL;
@@ -22,6 +22,7 @@
 #include "ocstack.h"
 #include "ocserverrequest.h"
 #include "ocresourcehandler.h"
+#include "ocobserve.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
 #include "ocpayload.h"
@@ -101,6 +102,7 @@ static void DeleteServerRequest(OCServerRequest * serverRequest)
     {
         LL_DELETE(serverRequestList, serverRequest);
         OICFree(serverRequest->requestToken);
+        OICFree(serverRequest->fanOut);
         OICFree(serverRequest);
         serverRequest = NULL;
         OC_LOG(INFO, TAG, "Server Request Removed!!");
@@ -177,6 +179,51 @@ static OCStackResult OCSendResponse(const CAEndpoint_t *object, CAResponseInfo_t
     return OC_STACK_OK;
 }
 
+/**
+ * Send an already encoded notification to the further observers of a server request.
+ * Only the token and the message type differ from the response for the request itself.
+ *
+ * @param serverRequest Server request of the notification.
+ * @param responseInfo Response sent for the server request; its token buffer must hold
+ *                     CA_MAX_TOKEN_LEN bytes.
+ *
+ * @return ::OC_STACK_OK if every observer was sent the notification.
+ */
+static OCStackResult SendFanOutResponses(const OCServerRequest *serverRequest,
+                                         CAResponseInfo_t *responseInfo)
+{
+    OCStackResult result = OC_STACK_OK;
+    const OCObserverFanOut *fanOut = serverRequest->fanOut;
+
+    for (uint16_t i = 0; i < fanOut->count; i++)
+    {
+        const OCFanOutObserver *entry = &fanOut->observers[i];
+
+        // The observer may have gone away while the response was delayed.
+        ResourceObserver *observer = GetObserverUsingToken((CAToken_t)entry->token,
+                                                           entry->tokenLength);
+        if (!observer)
+        {
+            continue;
+        }
+
+        CAEndpoint_t responseEndpoint = {.adapter = CA_DEFAULT_ADAPTER};
+        CopyDevAddrToEndpoint(&observer->devAddr, &responseEndpoint);
+
+        memcpy(responseInfo->info.token, entry->token, entry->tokenLength);
+        responseInfo->info.tokenLength = entry->tokenLength;
+        responseInfo->info.type = (entry->qos == OC_HIGH_QOS) ? CA_MSG_CONFIRM :
+                                                               CA_MSG_NONCONFIRM;
+
+        OCStackResult sendResult = OCSendResponse(&responseEndpoint, responseInfo);
+        if (OC_STACK_OK != sendResult)
+        {
+            result = sendResult;
+        }
+    }
+    return result;
+}
+
 //-------------------------------------------------------------------------------------------------
 // Internal APIs
 //-------------------------------------------------------------------------------------------------
@@ -472,14 +519,18 @@ CAResponseResult_t ConvertEHResultToCAResult (OCEntityHandlerResult result, OCMe
 
 
 /**
- * Handler function for sending a response from a single resource
+ * Send a response from a single resource and delete its request.
  *
  * @param ehResponse - pointer to the response from the resource
+ * @param encodedPayload - CBOR encoding of the payload, which the caller keeps; NULL to
+ *                         encode ehResponse->payload
+ * @param encodedPayloadSize - size of encodedPayload
  *
  * @return
  *     OCStackResult
  */
-OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
+static OCStackResult SendSingleResponse(OCEntityHandlerResponse * ehResponse,
+                                        const uint8_t *encodedPayload, size_t encodedPayloadSize)
 {
     OCStackResult result = OC_STACK_ERROR;
     CAEndpoint_t responseEndpoint = {.adapter = CA_DEFAULT_ADAPTER};
@@ -593,8 +644,15 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
     responseInfo.info.payloadSize = 0;
     responseInfo.info.payloadFormat = CA_FORMAT_UNDEFINED;
 
+    if(encodedPayload)
+    {
+        // CASendResponse copies the payload, so it is lent rather than duplicated.
+        responseInfo.info.payload = (CAPayload_t)encodedPayload;
+        responseInfo.info.payloadSize = encodedPayloadSize;
+        responseInfo.info.payloadFormat = CA_FORMAT_APPLICATION_CBOR;
+    }
     // Put the JSON prefix and suffix around the payload
-    if(ehResponse->payload)
+    else if(ehResponse->payload)
     {
         if (ehResponse->payload->type == PAYLOAD_TYPE_PRESENCE)
         {
@@ -690,13 +748,58 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
     result = OCSendResponse(&responseEndpoint, &responseInfo);
 #endif
 
-    OICFree(responseInfo.info.payload);
+    if (serverRequest->fanOut)
+    {
+        OCStackResult fanOutResult = SendFanOutResponses(serverRequest, &responseInfo);
+        if (OC_STACK_OK == result)
+        {
+            result = fanOutResult;
+        }
+    }
+
+    if(!encodedPayload)
+    {
+        OICFree(responseInfo.info.payload);
+    }
     OICFree(responseInfo.info.options);
     //Delete the request
     FindAndDeleteServerRequest(serverRequest);
     return result;
 }
 
+/**
+ * Handler function for sending a response from a single resource
+ *
+ * @param ehResponse - pointer to the response from the resource
+ *
+ * @return
+ *     OCStackResult
+ */
+OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
+{
+    return SendSingleResponse(ehResponse, NULL, 0);
+}
+
+/**
+ * Handler function for sending a response whose payload is encoded already
+ *
+ * @param ehResponse - pointer to the response, its payload is ignored
+ * @param payload - CBOR encoded payload, which stays owned by the caller
+ * @param payloadSize - size of payload
+ *
+ * @return
+ *     OCStackResult
+ */
+OCStackResult HandleEncodedResponse(OCEntityHandlerResponse * ehResponse,
+                                    const uint8_t *payload, size_t payloadSize)
+{
+    if(!payload || !payloadSize)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+    return SendSingleResponse(ehResponse, payload, payloadSize);
+}
+
 /**
  * Handler function for sending a response from multiple resources, such as a collection.
  * Aggregates responses from multiple resource until all responses are received then sends the
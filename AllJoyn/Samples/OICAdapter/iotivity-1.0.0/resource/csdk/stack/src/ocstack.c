@@ -37,6 +37,7 @@
 #include "ocstackinternal.h"
 #include "ocresourcehandler.h"
 #include "occlientcb.h"
+#include "ocdiscoverycache.h"
 #include "ocobserve.h"
 #include "ocrandom.h"
 #include "oic_malloc.h"
@@ -107,6 +108,8 @@ static uint32_t PresenceTimeOut[] = {50, 75, 85, 95, 100};
 #endif
 
 static OCMode myStackMode;
+// Set while a cached discovery response is handed to HandleCAResponses.
+static bool deliveringCachedDiscovery = false;
 #ifdef RA_ADAPTER
 //TODO: revisit this design
 static bool gRASetInfo = false;
@@ -136,6 +139,11 @@ static const char COAP_TCP[] = "coap+tcp:";
 
 #define MILLISECONDS_PER_SECOND   (1000)
 
+#ifdef ROUTING_GATEWAY
+// Longest time OCProcessEvents lets pass until the next OCProcess call.
+#define ROUTING_PROCESS_TIMEOUT   (1000)
+#endif
+
 //-----------------------------------------------------------------------------
 // Private internal function prototypes
 //-----------------------------------------------------------------------------
@@ -1229,6 +1237,15 @@ void HandleCAResponses(const CAEndpoint_t* endPoint, const CAResponseInfo_t* res
                     OCPayloadDestroy(response.payload);
                     return;
                 }
+
+                if (cbNode->method == OC_REST_DISCOVER && response.result == OC_STACK_OK &&
+                    !deliveringCachedDiscovery)
+                {
+                    StoreDiscoveryResponse(&response.devAddr, cbNode->requestUri,
+                                           responseInfo->info.resourceUri,
+                                           responseInfo->info.payload,
+                                           responseInfo->info.payloadSize);
+                }
             }
 
             response.numRcvdVendorSpecificHeaderOptions = 0;
@@ -1293,8 +1310,8 @@ void HandleCAResponses(const CAEndpoint_t* endPoint, const CAResponseInfo_t* res
                 else
                 {
                     // To keep discovery callbacks active.
-                    cbNode->TTL = GetTicks(MAX_CB_TIMEOUT_SECONDS *
-                                            MILLISECONDS_PER_SECOND);
+                    UpdateClientCBTTL(cbNode, GetTicks(MAX_CB_TIMEOUT_SECONDS *
+                                                       MILLISECONDS_PER_SECOND));
                 }
             }
 
@@ -1999,6 +2016,10 @@ OCStackResult OCStop()
     DeleteObserverList();
     // Remove all the client callbacks
     DeleteClientCBList();
+    // Remove the cached discovery responses
+    DeleteDiscoveryCache();
+    // Release the payload encode arena of this thread
+    OCConvertPayloadReleaseArena();
 
     // De-init the SRM Policy Engine
     // TODO after BeachHead delivery: consolidate into single SRMDeInit()
@@ -2533,11 +2554,21 @@ OCStackResult OCDoResource(OCDoHandle *handle,
     resourceUri = NULL;   // Client CB list entry now owns it
     resourceType = NULL;  // Client CB list entry now owns it
 
-    // send request
-    result = OCSendRequest(&endpoint, &requestInfo);
-    if (OC_STACK_OK != result)
+    // send request, unless the server answered the same discovery recently
+    if (method == OC_REST_DISCOVER && !requestInfo.isMulticast &&
+        QueueCachedDiscoveryResponse(clientCB->devAddr, clientCB->requestUri, token,
+                                     tokenLength))
     {
-        goto exit;
+        OC_LOG(INFO, TAG, "Answering the discovery from the cache");
+        CASignalRequestResponse();
+    }
+    else
+    {
+        result = OCSendRequest(&endpoint, &requestInfo);
+        if (OC_STACK_OK != result)
+        {
+            goto exit;
+        }
     }
 
     if (handle)
@@ -2666,6 +2697,13 @@ OCStackResult OCCancel(OCDoHandle handle, OCQualityOfService qos, OCHeaderOption
     return ret;
 }
 
+OCStackResult OCSetDiscoveryCacheMaxAge(uint32_t maxAgeSeconds)
+{
+    OC_LOG_V(INFO, TAG, "Discovery cache max age %u seconds", maxAgeSeconds);
+    SetDiscoveryCacheMaxAge(maxAgeSeconds);
+    return OC_STACK_OK;
+}
+
 /**
  * @brief   Register Persistent storage callback.
  * @param   persistentStorageHandler [IN] Pointers to open, read, write, close & unlink handlers.
@@ -2696,6 +2734,12 @@ OCStackResult OCRegisterPersistentStorageHandler(OCPersistentStorage* persistent
     return SRMRegisterPersistentStorageHandler(persistentStorageHandler);
 }
 
+OCStackResult OCRegisterPersistentStorageRenameHandler(OCPersistentStorageRename renameHandler)
+{
+    OC_LOG(INFO, TAG, "RegisterPersistentStorageRenameHandler !!");
+    return SRMRegisterPersistentStorageRenameHandler(renameHandler);
+}
+
 #ifdef WITH_PRESENCE
 
 OCStackResult OCProcessPresence()
@@ -2793,12 +2837,52 @@ exit:
 }
 #endif // WITH_PRESENCE
 
+/**
+ * Hand the discovery responses taken from the cache to the callbacks of their requests,
+ * as if the servers had sent them again.
+ */
+static void DeliverCachedDiscoveryResponses()
+{
+    OCDiscoveryDelivery *delivery = TakeCachedDiscoveryDeliveries();
+    while (delivery)
+    {
+        OCDiscoveryDelivery *next = delivery->next;
+
+        // A request cancelled in the meantime must not make the stack reset the server.
+        if (GetClientCB((CAToken_t)delivery->token, delivery->tokenLength, NULL, NULL))
+        {
+            CAEndpoint_t endpoint = {.adapter = CA_DEFAULT_ADAPTER};
+            CopyDevAddrToEndpoint(&delivery->devAddr, &endpoint);
+
+            CAResponseInfo_t responseInfo = {.result = CA_CONTENT};
+            responseInfo.info.type = CA_MSG_NONCONFIRM;
+            responseInfo.info.token = (CAToken_t)delivery->token;
+            responseInfo.info.tokenLength = delivery->tokenLength;
+            responseInfo.info.resourceUri = delivery->resourceUri;
+            responseInfo.info.payload = delivery->payload;
+            responseInfo.info.payloadSize = delivery->payloadSize;
+            responseInfo.info.payloadFormat = CA_FORMAT_APPLICATION_CBOR;
+
+            deliveringCachedDiscovery = true;
+            HandleCAResponses(&endpoint, &responseInfo);
+            deliveringCachedDiscovery = false;
+        }
+
+        DeleteDiscoveryDelivery(delivery);
+        delivery = next;
+    }
+}
+
 OCStackResult OCProcess()
 {
 #ifdef WITH_PRESENCE
     OCProcessPresence();
 #endif
     CAHandleRequestResponse();
+    DeliverCachedDiscoveryResponses();
+    SendPendingObserverNotifications();
+    DeleteTimedOutClientCBs();
+    SRMProcess();
 
 #ifdef ROUTING_GATEWAY
     RMProcess();
@@ -2806,6 +2890,97 @@ OCStackResult OCProcess()
     return OC_STACK_OK;
 }
 
+#ifdef WITH_PRESENCE
+/**
+ * Get the time until ::OCProcessPresence has a presence request or timeout to handle.
+ *
+ * @return Milliseconds until then, UINT32_MAX if no presence is requested.
+ */
+static uint32_t GetPresenceTimeout()
+{
+    uint32_t timeout = UINT32_MAX;
+    uint32_t now = GetTicks(0);
+    ClientCB* cbNode = NULL;
+
+    LL_FOREACH(cbList, cbNode)
+    {
+        if (OC_REST_PRESENCE != cbNode->method || !cbNode->presence ||
+            cbNode->presence->TTLlevel > PresenceTimeOutSize)
+        {
+            continue;
+        }
+
+        // the timeout is reported as soon as the last level is reached
+        if (cbNode->presence->TTLlevel == PresenceTimeOutSize ||
+            now >= cbNode->presence->timeOut[cbNode->presence->TTLlevel])
+        {
+            return 0;
+        }
+
+        uint32_t ticks = cbNode->presence->timeOut[cbNode->presence->TTLlevel] - now;
+        uint32_t remaining = (uint32_t)(((uint64_t)ticks * MILLISECONDS_PER_SECOND +
+                                        COAP_TICKS_PER_SECOND - 1) / COAP_TICKS_PER_SECOND);
+        if (remaining < timeout)
+        {
+            timeout = remaining;
+        }
+    }
+
+    return timeout;
+}
+#endif // WITH_PRESENCE
+
+OCStackResult OCProcessEvents(uint32_t *nextTimeout)
+{
+    VERIFY_NON_NULL(nextTimeout, ERROR, OC_STACK_INVALID_PARAM);
+
+    OCStackResult result = OCProcess();
+
+    uint32_t timeout = GetPendingObserverNotificationTimeout();
+    uint32_t clientCBTimeout = GetClientCBTimeout();
+    if (clientCBTimeout < timeout)
+    {
+        timeout = clientCBTimeout;
+    }
+    uint32_t srmTimeout = SRMGetProcessTimeout();
+    if (srmTimeout < timeout)
+    {
+        timeout = srmTimeout;
+    }
+    // callbacks may have asked for discoveries that the cache answers
+    if (HasCachedDiscoveryDeliveries())
+    {
+        timeout = 0;
+    }
+#ifdef WITH_PRESENCE
+    uint32_t presenceTimeout = GetPresenceTimeout();
+    if (presenceTimeout < timeout)
+    {
+        timeout = presenceTimeout;
+    }
+#endif
+#ifdef ROUTING_GATEWAY
+    // the routing manager keeps its timers to itself
+    if (ROUTING_PROCESS_TIMEOUT < timeout)
+    {
+        timeout = ROUTING_PROCESS_TIMEOUT;
+    }
+#endif
+
+    *nextTimeout = timeout;
+    return result;
+}
+
+OCStackResult OCWaitForEvents(uint32_t timeout)
+{
+    return CAResultToOCResult(CAWaitForRequestResponse(timeout));
+}
+
+OCStackResult OCSignalEvents()
+{
+    return CAResultToOCResult(CASignalRequestResponse());
+}
+
 #ifdef WITH_PRESENCE
 OCStackResult OCStartPresence(const uint32_t ttl)
 {
@@ -2978,22 +3153,13 @@ OCStackResult OCCreateResource(OCResourceHandle *handle,
         return OC_STACK_INVALID_PARAM;
     }
 
-    // If the headResource is NULL, then no resources have been created...
-    pointer = headResource;
-    if (pointer)
+    // Repeated URLs are not allowed.  If a repeat is found, exit with an error
+    if (FindResourceByUri(uri))
     {
-        // At least one resources is in the resource list, so we need to search for
-        // repeated URLs, which are not allowed.  If a repeat is found, exit with an error
-        while (pointer)
-        {
-            if (strncmp(uri, pointer->uri, MAX_URI_LENGTH) == 0)
-            {
-                OC_LOG_V(ERROR, TAG, "Resource %s already exists", uri);
-                return OC_STACK_INVALID_PARAM;
-            }
-            pointer = pointer->next;
-        }
+        OC_LOG_V(ERROR, TAG, "Resource %s already exists", uri);
+        return OC_STACK_INVALID_PARAM;
     }
+
     // Create the pointer and insert it into the resource list
     pointer = (OCResource *) OICCalloc(1, sizeof(OCResource));
     if (!pointer)
@@ -3013,6 +3179,12 @@ OCStackResult OCCreateResource(OCResourceHandle *handle,
         goto exit;
     }
 
+    result = AddResourceToIndex(pointer);
+    if (result != OC_STACK_OK)
+    {
+        goto exit;
+    }
+
     // Set properties.  Set OC_ACTIVE
     pointer->resourceProperties = (OCResourceProperty) (resourceProperties
             | OC_ACTIVE);
@@ -3733,6 +3905,7 @@ OCStackResult OCChangeResourceProperty(OCResourceProperty * inputProperty,
     {
         *inputProperty = (OCResourceProperty) (*inputProperty | resourceProperties);
     }
+    InvalidateDiscoveryResponses();
     return OC_STACK_OK;
 }
 #endif
@@ -3785,17 +3958,7 @@ void insertResource(OCResource *resource)
 
 OCResource *findResource(OCResource *resource)
 {
-    OCResource *pointer = headResource;
-
-    while (pointer)
-    {
-        if (pointer == resource)
-        {
-            return resource;
-        }
-        pointer = pointer->next;
-    }
-    return NULL;
+    return FindResourceByHandle((OCResourceHandle) resource);
 }
 
 void deleteAllResources()
@@ -3824,6 +3987,8 @@ void deleteAllResources()
     // presence notification attributed to their deletion to be processed.
     deleteResource((OCResource *) presenceResource.handle);
 #endif // WITH_PRESENCE
+
+    DeleteResourceIndex();
 }
 
 OCStackResult deleteResource(OCResource *resource)
@@ -3902,6 +4067,8 @@ void deleteResourceElements(OCResource *resource)
         return;
     }
 
+    RemoveResourceFromIndex(resource);
+    DeleteObserversUsingResource(resource);
     OICFree(resource->uri);
     deleteResourceType(resource->rsrcType);
     deleteResourceInterface(resource->rsrcInterface);
@@ -3967,6 +4134,7 @@ void insertResourceType(OCResource *resource, OCResourceType *resourceType)
         previous->next = resourceType;
     }
     resourceType->next = NULL;
+    IndexResourceType(resource, resourceType);
 
     OC_LOG_V(INFO, TAG, "Added type %s to %s", resourceType->resourcetypename, resource->uri);
 }
@@ -4066,6 +4234,8 @@ void insertResourceInterface(OCResource *resource, OCResourceInterface *newInter
         }
         previous->next = newInterface;
     }
+
+    IndexResourceInterface(resource, newInterface);
 }
 
 OCResourceInterface *findResourceInterfaceAtIndex(OCResourceHandle handle,
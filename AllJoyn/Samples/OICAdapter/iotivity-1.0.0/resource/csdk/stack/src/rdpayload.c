@@ -24,6 +24,7 @@
 #include "octypes.h"
 #include "ocstack.h"
 #include "ocpayload.h"
+#include "ocpayloadarena.h"
 #include "payload_logging.h"
 
 #define TAG "OCRDPayload"
@@ -136,7 +137,6 @@ int64_t OCRDPayloadToCbor(const OCRDPayload *rdPayload, uint8_t *outPayload, siz
     return OC_STACK_OK;
 
 cbor_error:
-    OICFree(outPayload);
     return OC_STACK_ERROR;
 }
 
@@ -443,6 +443,10 @@ static CborError FindStringLLInMap(const CborValue *linksMap, char *tag, OCStrin
     {
         return CborUnknownError;
     }
+    if (!cbor_value_is_array(&rtArray))
+    {
+        return CborNoError;
+    }
     CborValue rtVal;
     cborFindResult = cbor_value_enter_container(&rtArray, &rtVal);
     if (CborNoError != cborFindResult)
@@ -530,7 +534,7 @@ OCStackResult OCTagsCborToPayload(CborValue *tagsMap, OCTagsPayload **tagsPayloa
             tags->di.id_length = MAX_IDENTITY_SIZE;
             OICFree(id);
         }
-        uint64_t temp;
+        uint64_t temp = 0;
         if (CborNoError != FindIntInMap(tagsMap, OC_RSRVD_HOSTING_PORT, &temp))
         {
             OCFreeTagsResource(tags);
@@ -568,6 +572,11 @@ OCStackResult OCTagsCborToPayload(CborValue *tagsMap, OCTagsPayload **tagsPayloa
 
 OCStackResult OCLinksCborToPayload(CborValue *linksArray, OCLinksPayload **linksPayload)
 {
+    if (!cbor_value_is_array(linksArray))
+    {
+        OC_LOG(ERROR, TAG, "Links is not an array");
+        return OC_STACK_ERROR;
+    }
     CborValue linksMap;
     CborError cborFindResult = cbor_value_enter_container(linksArray, &linksMap);
     if (CborNoError != cborFindResult)
@@ -635,7 +644,7 @@ OCStackResult OCLinksCborToPayload(CborValue *linksArray, OCLinksPayload **links
             OCFreeLinksResource(setLinks);
             return OC_STACK_ERROR;
         }
-        uint64_t temp;
+        uint64_t temp = 0;
         cborFindResult = FindIntInMap(&linksMap, OC_RSRVD_INS, &temp);
         if (CborNoError != cborFindResult)
         {
@@ -661,9 +670,9 @@ OCStackResult OCLinksCborToPayload(CborValue *linksArray, OCLinksPayload **links
         cborFindResult = cbor_value_advance(&linksMap);
         if (CborNoError != cborFindResult)
         {
+            // setLinks is in the list already
             OC_LOG(ERROR, TAG, "Failed advancing links map");
             OCFreeLinksResource(*linksPayload);
-            OCFreeLinksResource(setLinks);
             return OC_STACK_ERROR;
         }
     }
@@ -1054,8 +1063,10 @@ void OCDiscoveryCollectionPayloadDestroy(OCDiscoveryPayload* payload)
         return;
     }
 
+    OCPayloadArena* arena = payload->arena;
     OCFreeCollectionResource(payload->collectionResources);
-    OICFree(payload);
+    OCPayloadArenaFree(arena, payload);
+    OCPayloadArenaRelease(arena);
 }
 
 
@@ -0,0 +1,282 @@
+//******************************************************************
+//
+// Copyright 2015 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <sys/time.h>
+
+extern "C"
+{
+    #include "ocstack.h"
+    #include "ocstackinternal.h"
+    #include "occlientcb.h"
+    #include "oic_malloc.h"
+    #include "oic_string.h"
+    #include "coap_time.h"
+}
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "gtest_helper.h"
+
+namespace itst = iotivity::test;
+
+static const std::chrono::seconds SHORT_TEST_TIMEOUT = std::chrono::seconds(5);
+static const int BENCHMARK_LOOKUPS = 100000;
+
+static int g_deletedContexts = 0;
+
+static OCStackApplicationResult keepHandler(void * /*ctx*/, OCDoHandle /*handle*/,
+                                            OCClientResponse * /*clientResponse*/)
+{
+    return OC_STACK_KEEP_TRANSACTION;
+}
+
+static void contextDeleter(void * /*ctx*/)
+{
+    ++g_deletedContexts;
+}
+
+class OCClientCBF : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        g_deletedContexts = 0;
+        EXPECT_EQ(OC_STACK_OK, OCInit(NULL, 0, OC_CLIENT));
+    }
+
+    virtual void TearDown()
+    {
+        EXPECT_EQ(OC_STACK_OK, OCStop());
+    }
+
+    void makeToken(int index, uint8_t *token)
+    {
+        // the first byte is zero for some of them, as it may be on the wire
+        token[0] = (uint8_t)(index >> 16);
+        token[1] = (uint8_t)(index >> 8);
+        token[2] = (uint8_t)(index & 0xFF);
+        for (int i = 3; i < CA_MAX_TOKEN_LEN; i++)
+        {
+            token[i] = (uint8_t)i;
+        }
+    }
+
+    ClientCB *addCB(int index, OCMethod method, uint32_t ttl, const char *uri = "/a/light")
+    {
+        CAToken_t token = (CAToken_t)OICMalloc(CA_MAX_TOKEN_LEN);
+        makeToken(index, (uint8_t *)token);
+        OCDoHandle handle = (OCDoHandle)OICMalloc(sizeof(uint8_t));
+
+        OCCallbackData cbData;
+        cbData.cb = keepHandler;
+        cbData.context = NULL;
+        cbData.cd = contextDeleter;
+
+        ClientCB *cbNode = NULL;
+        EXPECT_EQ(OC_STACK_OK, AddClientCB(&cbNode, &cbData, token, CA_MAX_TOKEN_LEN,
+                                           &handle, method, NULL, OICStrdup(uri), NULL, ttl));
+        return cbNode;
+    }
+
+    ClientCB *findCB(int index)
+    {
+        uint8_t token[CA_MAX_TOKEN_LEN];
+        makeToken(index, token);
+        return GetClientCB((CAToken_t)token, CA_MAX_TOKEN_LEN, NULL, NULL);
+    }
+
+    uint32_t ticksFromNow(uint32_t seconds)
+    {
+        coap_tick_t now;
+        coap_ticks(&now);
+        return (uint32_t)(now + seconds * COAP_TICKS_PER_SECOND);
+    }
+};
+
+TEST_F(OCClientCBF, IndexesFollowAddAndDelete)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+
+    const int count = 300;
+    ClientCB *cbNodes[count];
+    for (int i = 0; i < count; i++)
+    {
+        cbNodes[i] = addCB(i, OC_REST_GET, ticksFromNow(60));
+        ASSERT_TRUE(NULL != cbNodes[i]);
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        EXPECT_EQ(cbNodes[i], findCB(i));
+        EXPECT_EQ(cbNodes[i], GetClientCB(NULL, 0, cbNodes[i]->handle, NULL));
+    }
+
+    for (int i = 0; i < count; i += 2)
+    {
+        FindAndDeleteClientCB(cbNodes[i]);
+    }
+    for (int i = 0; i < count; i++)
+    {
+        EXPECT_EQ(i % 2 != 0, NULL != findCB(i));
+    }
+    EXPECT_EQ(count / 2, g_deletedContexts);
+
+    // A shorter token with the same prefix is a different callback
+    uint8_t token[CA_MAX_TOKEN_LEN];
+    makeToken(1, token);
+    EXPECT_EQ(NULL, GetClientCB((CAToken_t)token, CA_MAX_TOKEN_LEN - 1, NULL, NULL));
+    EXPECT_TRUE(ClientTokenExist((CAToken_t)token, CA_MAX_TOKEN_LEN));
+
+    // Deleting a callback that is gone already does nothing
+    FindAndDeleteClientCB(cbNodes[0]);
+    EXPECT_EQ(count / 2, g_deletedContexts);
+}
+
+#ifdef WITH_PRESENCE
+TEST_F(OCClientCBF, PresenceFoundByUri)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+
+    ClientCB *presence = addCB(1, OC_REST_PRESENCE, 0, "coap://127.0.0.1:5683/oic/ad");
+    ASSERT_TRUE(NULL != presence);
+    EXPECT_EQ(CLIENTCB_NOT_IN_HEAP, presence->ttlHeapIndex);
+    ASSERT_TRUE(NULL != addCB(2, OC_REST_GET, ticksFromNow(60), "/oic/ad"));
+
+    EXPECT_EQ(presence, GetClientCB(NULL, 0, NULL, "coap://127.0.0.1:5683/oic/ad"));
+    EXPECT_EQ(NULL, GetClientCB(NULL, 0, NULL, "coap://127.0.0.1:5684/oic/ad"));
+
+    // Only presence callbacks are found by their uri
+    EXPECT_EQ(NULL, GetClientCB(NULL, 0, NULL, "/oic/ad"));
+
+    // A second presence request to the same server uses the same callback
+    EXPECT_EQ(presence, addCB(3, OC_REST_PRESENCE, 0, "coap://127.0.0.1:5683/oic/ad"));
+    EXPECT_EQ(NULL, findCB(3));
+}
+#endif
+
+TEST_F(OCClientCBF, TimedOutCallbacksAreDeleted)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+
+    EXPECT_EQ(UINT32_MAX, GetClientCBTimeout());
+
+    ASSERT_TRUE(NULL != addCB(1, OC_REST_GET, ticksFromNow(60)));
+    ClientCB *expired = addCB(2, OC_REST_GET, 1);
+    ASSERT_TRUE(NULL != expired);
+    ClientCB *observe = addCB(3, OC_REST_OBSERVE, 1);
+    ASSERT_TRUE(NULL != observe);
+    EXPECT_EQ(0u, observe->TTL);
+    ClientCB *refreshed = addCB(4, OC_REST_GET, 2);
+    ASSERT_TRUE(NULL != refreshed);
+
+    // Like a discovery callback that is kept after a response
+    UpdateClientCBTTL(refreshed, ticksFromNow(30));
+    EXPECT_EQ(0u, GetClientCBTimeout());
+
+    OCClientCBStats before;
+    GetClientCBStats(&before);
+    EXPECT_EQ(4u, before.liveCallbacks);
+
+    DeleteTimedOutClientCBs();
+    EXPECT_TRUE(NULL != findCB(1));
+    EXPECT_EQ(NULL, findCB(2));
+    EXPECT_TRUE(NULL != findCB(3));
+    EXPECT_TRUE(NULL != findCB(4));
+    EXPECT_EQ(1, g_deletedContexts);
+
+    OCClientCBStats after;
+    GetClientCBStats(&after);
+    EXPECT_EQ(3u, after.liveCallbacks);
+    EXPECT_EQ(4u, after.peakCallbacks);
+    EXPECT_EQ(before.timedOutCallbacks + 1, after.timedOutCallbacks);
+
+    uint32_t timeout = GetClientCBTimeout();
+    EXPECT_LT(29000u, timeout);
+    EXPECT_GE(30001u, timeout);
+
+    // An observation that is given a TTL times out like any other request
+    UpdateClientCBTTL(observe, 1);
+    EXPECT_EQ(0u, GetClientCBTimeout());
+    DeleteTimedOutClientCBs();
+    EXPECT_EQ(NULL, findCB(3));
+
+    UpdateClientCBTTL(refreshed, 0);
+    DeleteClientCB(findCB(1));
+    EXPECT_EQ(UINT32_MAX, GetClientCBTimeout());
+}
+
+TEST_F(OCClientCBF, HeapKeepsTTLOrder)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+
+    const int count = 200;
+    for (int i = 0; i < count; i++)
+    {
+        // the TTLs of the even ones have passed, in a scrambled order
+        uint32_t ttl = (i % 2) ? ticksFromNow(60 + (i * 37) % count)
+                               : (uint32_t)(1 + (i * 37) % count);
+        ASSERT_TRUE(NULL != addCB(i, OC_REST_GET, ttl));
+    }
+    for (int i = 1; i < count; i += 4)
+    {
+        UpdateClientCBTTL(findCB(i), 2);
+    }
+
+    DeleteTimedOutClientCBs();
+    for (int i = 0; i < count; i++)
+    {
+        EXPECT_EQ(i % 2 != 0 && i % 4 != 1, NULL != findCB(i));
+    }
+}
+
+TEST_F(OCClientCBF, BenchmarkResponseMatching)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+
+    const int sizes[] = { 10, 1000, 10000 };
+    int added = 0;
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        for (; added < sizes[s]; added++)
+        {
+            ASSERT_TRUE(NULL != addCB(added, OC_REST_OBSERVE, 0));
+        }
+
+        uint8_t token[CA_MAX_TOKEN_LEN];
+        clock_t start = clock();
+        for (int i = 0; i < BENCHMARK_LOOKUPS; i++)
+        {
+            makeToken(i % added, token);
+            if (!GetClientCB((CAToken_t)token, CA_MAX_TOKEN_LEN, NULL, NULL))
+            {
+                ADD_FAILURE();
+                break;
+            }
+        }
+        clock_t elapsed = clock() - start;
+
+        printf("[          ] %d callbacks, %.3f usec CPU per response matched\n",
+               added, (double)elapsed * 1000000 / CLOCKS_PER_SEC / BENCHMARK_LOOKUPS);
+    }
+}
@@ -0,0 +1,480 @@
+//******************************************************************
+//
+// Copyright 2015 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+extern "C"
+{
+    #include "ocstack.h"
+    #include "ocstackinternal.h"
+    #include "ocresourcehandler.h"
+    #include "ocdiscoverycache.h"
+    #include "ocpayload.h"
+    #include "ocpayloadcbor.h"
+    #include "oic_malloc.h"
+}
+
+#include "gtest/gtest.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest_helper.h"
+
+namespace itst = iotivity::test;
+
+static const std::chrono::seconds SHORT_TEST_TIMEOUT = std::chrono::seconds(5);
+static const std::chrono::seconds LONG_TEST_TIMEOUT = std::chrono::seconds(60);
+static const int SIMULATED_SERVERS = 200;
+static const int BENCHMARK_DISCOVERIES = 1000;
+static const int BENCHMARK_RESOURCES = 10;
+
+static uint64_t nowUsec()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static OCEntityHandlerResult dummyHandler(OCEntityHandlerFlag /*flag*/,
+        OCEntityHandlerRequest * /*request*/, void * /*callbackParam*/)
+{
+    return OC_EH_OK;
+}
+
+/**
+ * Servers on loopback that answer every request with the same device payload, like
+ * the /oic/d resource of a real server does.  They count the requests they receive.
+ */
+class SimulatedServers
+{
+public:
+    SimulatedServers(int count) : m_requests(0), m_run(true), m_payload(NULL), m_payloadSize(0)
+    {
+        uint8_t sid[UUID_SIZE] = { 0x12, 0x34 };
+        OCDevicePayload *payload = OCDevicePayloadCreate(OC_RSRVD_DEVICE_URI, sid, "simulated",
+                                                         OC_SPEC_VERSION, OC_DATA_MODEL_VERSION);
+        EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload *)payload, &m_payload,
+                                                &m_payloadSize));
+        OCPayloadDestroy((OCPayload *)payload);
+
+        for (int i = 0; i < count; i++)
+        {
+            int fd = socket(AF_INET, SOCK_DGRAM, 0);
+            sockaddr_in addr;
+            memset(&addr, 0, sizeof(addr));
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t length = sizeof(addr);
+            if (fd < 0 || bind(fd, (sockaddr *)&addr, sizeof(addr)) != 0 ||
+                getsockname(fd, (sockaddr *)&addr, &length) != 0)
+            {
+                ADD_FAILURE() << "cannot open simulated server " << i;
+                if (fd >= 0)
+                {
+                    close(fd);
+                }
+                break;
+            }
+
+            pollfd entry = { fd, POLLIN, 0 };
+            m_sockets.push_back(entry);
+
+            OCDevAddr devAddr;
+            memset(&devAddr, 0, sizeof(devAddr));
+            devAddr.adapter = OC_ADAPTER_IP;
+            devAddr.flags = OC_IP_USE_V4;
+            devAddr.port = ntohs(addr.sin_port);
+            strncpy(devAddr.addr, "127.0.0.1", sizeof(devAddr.addr) - 1);
+            m_addresses.push_back(devAddr);
+        }
+
+        m_thread = std::thread([this]() { serve(); });
+    }
+
+    ~SimulatedServers()
+    {
+        m_run = false;
+        m_thread.join();
+        for (size_t i = 0; i < m_sockets.size(); i++)
+        {
+            close(m_sockets[i].fd);
+        }
+        OICFree(m_payload);
+    }
+
+    const std::vector<OCDevAddr> &addresses() const
+    {
+        return m_addresses;
+    }
+
+    int requests() const
+    {
+        return m_requests;
+    }
+
+private:
+    void serve()
+    {
+        while (m_run)
+        {
+            if (poll(&m_sockets[0], m_sockets.size(), 10) <= 0)
+            {
+                continue;
+            }
+            for (size_t i = 0; i < m_sockets.size(); i++)
+            {
+                if (m_sockets[i].revents & POLLIN)
+                {
+                    respond(m_sockets[i].fd);
+                }
+            }
+        }
+    }
+
+    // Answers a CoAP request with 2.05 Content, a CBOR payload and the token of the request.
+    void respond(int fd)
+    {
+        uint8_t request[1500];
+        sockaddr_in from;
+        socklen_t fromLength = sizeof(from);
+        ssize_t length = recvfrom(fd, request, sizeof(request), 0, (sockaddr *)&from,
+                                  &fromLength);
+        if (length < 4)
+        {
+            return;
+        }
+        uint8_t type = (request[0] >> 4) & 0x03;
+        uint8_t tokenLength = request[0] & 0x0F;
+        if (tokenLength > 8 || length < 4 + tokenLength || request[1] == 0)
+        {
+            return;
+        }
+        m_requests++;
+
+        std::vector<uint8_t> response(4 + tokenLength);
+        // a confirmable request is acknowledged, others are answered non-confirmable
+        response[0] = (uint8_t)(0x40 | ((type == 0) ? 0x20 : 0x10) | tokenLength);
+        response[1] = 0x45;
+        response[2] = request[2];
+        response[3] = request[3];
+        memcpy(&response[4], &request[4], tokenLength);
+        response.push_back(0xC1);   // Content-Format
+        response.push_back(60);     // application/cbor
+        response.push_back(0xFF);
+        response.insert(response.end(), m_payload, m_payload + m_payloadSize);
+
+        sendto(fd, &response[0], response.size(), 0, (sockaddr *)&from, fromLength);
+    }
+
+    std::vector<pollfd> m_sockets;
+    std::vector<OCDevAddr> m_addresses;
+    std::atomic<int> m_requests;
+    std::atomic<bool> m_run;
+    std::thread m_thread;
+    uint8_t *m_payload;
+    size_t m_payloadSize;
+};
+
+class OCDiscoveryCacheF : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        m_responses = 0;
+        m_resourceUris.clear();
+    }
+
+    virtual void TearDown()
+    {
+        EXPECT_EQ(OC_STACK_OK, OCStop());
+    }
+
+    static OCStackApplicationResult discoveryHandler(void *ctx, OCDoHandle /*handle*/,
+                                                     OCClientResponse *clientResponse)
+    {
+        OCDiscoveryCacheF *self = static_cast<OCDiscoveryCacheF *>(ctx);
+        if (clientResponse && clientResponse->result == OC_STACK_OK && clientResponse->payload)
+        {
+            self->m_responses++;
+            if (clientResponse->payload->type == PAYLOAD_TYPE_DISCOVERY)
+            {
+                OCDiscoveryPayload *payload = (OCDiscoveryPayload *)clientResponse->payload;
+                self->m_resourceUris.clear();
+                for (OCResourcePayload *resource = payload->resources; resource;
+                     resource = resource->next)
+                {
+                    self->m_resourceUris.insert(resource->uri);
+                }
+            }
+        }
+        return OC_STACK_DELETE_TRANSACTION;
+    }
+
+    OCStackResult discover(const OCDevAddr &devAddr, const char *uri, OCDoHandle *handle = NULL)
+    {
+        OCCallbackData cbData;
+        cbData.cb = discoveryHandler;
+        cbData.context = this;
+        cbData.cd = NULL;
+        return OCDoResource(handle, OC_REST_DISCOVER, uri, &devAddr, NULL, CT_DEFAULT,
+                            OC_LOW_QOS, &cbData, NULL, 0);
+    }
+
+    // Runs the stack until the number of responses is reached or a second passed.
+    bool processUntil(int responses)
+    {
+        uint64_t deadline = nowUsec() + 1000000;
+        while (m_responses < responses && nowUsec() < deadline)
+        {
+            uint32_t timeout = UINT32_MAX;
+            OCProcessEvents(&timeout);
+            if (m_responses < responses)
+            {
+                OCWaitForEvents(timeout < 10 ? timeout : 10);
+            }
+        }
+        return m_responses >= responses;
+    }
+
+    // Discovers the device of every simulated server once; returns the time it took in usec.
+    uint64_t discoverAll(const SimulatedServers &servers)
+    {
+        int expected = m_responses + (int)servers.addresses().size();
+        uint64_t start = nowUsec();
+        for (size_t i = 0; i < servers.addresses().size(); i++)
+        {
+            EXPECT_EQ(OC_STACK_OK, discover(servers.addresses()[i], OC_RSRVD_DEVICE_URI));
+        }
+        EXPECT_TRUE(processUntil(expected));
+        return nowUsec() - start;
+    }
+
+    OCDevAddr self()
+    {
+        OCDevAddr devAddr;
+        memset(&devAddr, 0, sizeof(devAddr));
+        devAddr.adapter = OC_ADAPTER_IP;
+        devAddr.flags = OC_IP_USE_V4;
+        devAddr.port = caglobals.ip.u4.port;
+        strncpy(devAddr.addr, "127.0.0.1", sizeof(devAddr.addr) - 1);
+        return devAddr;
+    }
+
+    int m_responses;
+    std::set<std::string> m_resourceUris;
+};
+
+TEST_F(OCDiscoveryCacheF, ServerResponseFollowsResources)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    ASSERT_EQ(OC_STACK_OK, OCInit(NULL, 0, OC_CLIENT_SERVER));
+
+    OCResourceHandle light = NULL;
+    OCResourceHandle fan = NULL;
+    ASSERT_EQ(OC_STACK_OK, OCCreateResource(&light, "core.light", "oic.if.baseline",
+                                            "/a/light", dummyHandler, NULL, OC_DISCOVERABLE));
+
+    ASSERT_EQ(OC_STACK_OK, discover(self(), OC_RSRVD_WELL_KNOWN_URI));
+    ASSERT_TRUE(processUntil(1));
+    EXPECT_EQ(1u, m_resourceUris.count("/a/light"));
+
+    // the same response again, from the cache of the server
+    ASSERT_EQ(OC_STACK_OK, discover(self(), OC_RSRVD_WELL_KNOWN_URI));
+    ASSERT_TRUE(processUntil(2));
+    EXPECT_EQ(1u, m_resourceUris.count("/a/light"));
+
+    ASSERT_EQ(OC_STACK_OK, OCCreateResource(&fan, "core.fan", "oic.if.baseline",
+                                            "/a/fan", dummyHandler, NULL, OC_DISCOVERABLE));
+    ASSERT_EQ(OC_STACK_OK, discover(self(), OC_RSRVD_WELL_KNOWN_URI));
+    ASSERT_TRUE(processUntil(3));
+    EXPECT_EQ(1u, m_resourceUris.count("/a/light"));
+    EXPECT_EQ(1u, m_resourceUris.count("/a/fan"));
+
+    // a filter is part of the key
+    ASSERT_EQ(OC_STACK_OK, discover(self(), "/oic/res?rt=core.fan"));
+    ASSERT_TRUE(processUntil(4));
+    EXPECT_EQ(0u, m_resourceUris.count("/a/light"));
+    EXPECT_EQ(1u, m_resourceUris.count("/a/fan"));
+
+    ASSERT_EQ(OC_STACK_OK, OCBindResourceTypeToResource(light, "core.fan"));
+    ASSERT_EQ(OC_STACK_OK, discover(self(), "/oic/res?rt=core.fan"));
+    ASSERT_TRUE(processUntil(5));
+    EXPECT_EQ(1u, m_resourceUris.count("/a/light"));
+
+    ASSERT_EQ(OC_STACK_OK, OCDeleteResource(fan));
+    ASSERT_EQ(OC_STACK_OK, discover(self(), OC_RSRVD_WELL_KNOWN_URI));
+    ASSERT_TRUE(processUntil(6));
+    EXPECT_EQ(1u, m_resourceUris.count("/a/light"));
+    EXPECT_EQ(0u, m_resourceUris.count("/a/fan"));
+}
+
+TEST_F(OCDiscoveryCacheF, ClientAnswersRediscoveryFromCache)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    ASSERT_EQ(OC_STACK_OK, OCInit(NULL, 0, OC_CLIENT));
+    SimulatedServers servers(4);
+    const OCDevAddr &server = servers.addresses()[0];
+
+    // disabled by default
+    ASSERT_EQ(OC_STACK_OK, discover(server, OC_RSRVD_DEVICE_URI));
+    ASSERT_TRUE(processUntil(1));
+    ASSERT_EQ(OC_STACK_OK, discover(server, OC_RSRVD_DEVICE_URI));
+    ASSERT_TRUE(processUntil(2));
+    EXPECT_EQ(2, servers.requests());
+
+    ASSERT_EQ(OC_STACK_OK, OCSetDiscoveryCacheMaxAge(60));
+    ASSERT_EQ(OC_STACK_OK, discover(server, OC_RSRVD_DEVICE_URI));
+    ASSERT_TRUE(processUntil(3));
+    EXPECT_EQ(3, servers.requests());
+
+    ASSERT_EQ(OC_STACK_OK, discover(server, OC_RSRVD_DEVICE_URI));
+    uint32_t timeout = UINT32_MAX;
+    OCProcessEvents(&timeout);
+    EXPECT_EQ(4, m_responses);
+    EXPECT_EQ(3, servers.requests());
+
+    // the answer waits for OCProcess, and a cancelled request gets none
+    OCDoHandle handle = NULL;
+    ASSERT_EQ(OC_STACK_OK, discover(server, OC_RSRVD_DEVICE_URI, &handle));
+    EXPECT_TRUE(HasCachedDiscoveryDeliveries());
+    EXPECT_EQ(4, m_responses);
+    EXPECT_EQ(OC_STACK_OK, OCCancel(handle, OC_LOW_QOS, NULL, 0));
+    OCProcessEvents(&timeout);
+    EXPECT_FALSE(HasCachedDiscoveryDeliveries());
+    EXPECT_EQ(4, m_responses);
+
+    // other servers are not answered from the cache
+    ASSERT_EQ(OC_STACK_OK, discover(servers.addresses()[1], OC_RSRVD_DEVICE_URI));
+    ASSERT_TRUE(processUntil(5));
+    EXPECT_EQ(4, servers.requests());
+
+    OCDiscoveryCacheStats stats;
+    GetDiscoveryCacheStats(&stats);
+    EXPECT_EQ(2u, stats.entries);
+    EXPECT_EQ(2u, stats.hits);
+
+    // disabling empties the cache
+    ASSERT_EQ(OC_STACK_OK, OCSetDiscoveryCacheMaxAge(0));
+    ASSERT_EQ(OC_STACK_OK, discover(server, OC_RSRVD_DEVICE_URI));
+    ASSERT_TRUE(processUntil(6));
+    EXPECT_EQ(5, servers.requests());
+    GetDiscoveryCacheStats(&stats);
+    EXPECT_EQ(0u, stats.entries);
+}
+
+TEST_F(OCDiscoveryCacheF, ClientCacheExpires)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    ASSERT_EQ(OC_STACK_OK, OCInit(NULL, 0, OC_CLIENT));
+    SimulatedServers servers(1);
+
+    ASSERT_EQ(OC_STACK_OK, OCSetDiscoveryCacheMaxAge(1));
+    ASSERT_EQ(OC_STACK_OK, discover(servers.addresses()[0], OC_RSRVD_DEVICE_URI));
+    ASSERT_TRUE(processUntil(1));
+    ASSERT_EQ(OC_STACK_OK, discover(servers.addresses()[0], OC_RSRVD_DEVICE_URI));
+    ASSERT_TRUE(processUntil(2));
+    EXPECT_EQ(1, servers.requests());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    ASSERT_EQ(OC_STACK_OK, discover(servers.addresses()[0], OC_RSRVD_DEVICE_URI));
+    ASSERT_TRUE(processUntil(3));
+    EXPECT_EQ(2, servers.requests());
+
+    OCDiscoveryCacheStats stats;
+    GetDiscoveryCacheStats(&stats);
+    EXPECT_EQ(1u, stats.expired);
+    EXPECT_EQ(1u, stats.entries);
+}
+
+// Periodic rediscovery of 200 servers, as the bridge does every minute.
+TEST_F(OCDiscoveryCacheF, BenchmarkRediscovery)
+{
+    itst::DeadmanTimer killSwitch(LONG_TEST_TIMEOUT);
+    ASSERT_EQ(OC_STACK_OK, OCInit(NULL, 0, OC_CLIENT));
+    SimulatedServers servers(SIMULATED_SERVERS);
+    ASSERT_EQ((size_t)SIMULATED_SERVERS, servers.addresses().size());
+
+    uint64_t uncached = discoverAll(servers);
+    int uncachedRequests = servers.requests();
+
+    ASSERT_EQ(OC_STACK_OK, OCSetDiscoveryCacheMaxAge(60));
+    discoverAll(servers);
+    int before = servers.requests();
+    uint64_t cached = discoverAll(servers);
+    int cachedRequests = servers.requests() - before;
+
+    EXPECT_EQ(SIMULATED_SERVERS, uncachedRequests);
+    EXPECT_EQ(0, cachedRequests);
+
+    printf("[          ] %d servers, uncached: %d requests, %.3f msec; "
+           "cached: %d requests, %.3f msec\n", SIMULATED_SERVERS,
+           uncachedRequests, uncached / 1000.0, cachedRequests, cached / 1000.0);
+}
+
+// Repeated unicast discovery of a server, answered from its cache and with the response built
+// again each time.  The resources fit into one datagram.
+TEST_F(OCDiscoveryCacheF, BenchmarkServerResponse)
+{
+    itst::DeadmanTimer killSwitch(LONG_TEST_TIMEOUT);
+    ASSERT_EQ(OC_STACK_OK, OCInit(NULL, 0, OC_CLIENT_SERVER));
+
+    for (int i = 0; i < BENCHMARK_RESOURCES; i++)
+    {
+        char uri[32];
+        snprintf(uri, sizeof(uri), "/a/light/%d", i);
+        OCResourceHandle handle = NULL;
+        ASSERT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.light", "oic.if.baseline",
+                                                uri, dummyHandler, NULL,
+                                                OC_DISCOVERABLE | OC_OBSERVABLE));
+    }
+
+    for (int cached = 0; cached <= 1; cached++)
+    {
+        uint64_t start = nowUsec();
+        clock_t cpuStart = clock();
+        for (int i = 0; i < BENCHMARK_DISCOVERIES; i++)
+        {
+            if (!cached)
+            {
+                InvalidateDiscoveryResponses();
+            }
+            ASSERT_EQ(OC_STACK_OK, discover(self(), OC_RSRVD_WELL_KNOWN_URI));
+            ASSERT_TRUE(processUntil(m_responses + 1));
+            ASSERT_EQ((size_t)BENCHMARK_RESOURCES, m_resourceUris.size());
+        }
+        clock_t cpu = clock() - cpuStart;
+
+        printf("[          ] %s: %.1f usec, %.1f usec CPU per discovery of %d resources\n",
+               cached ? "cached" : "built", (double)(nowUsec() - start) / BENCHMARK_DISCOVERIES,
+               (double)cpu * 1000000 / CLOCKS_PER_SEC / BENCHMARK_DISCOVERIES,
+               BENCHMARK_RESOURCES);
+    }
+}
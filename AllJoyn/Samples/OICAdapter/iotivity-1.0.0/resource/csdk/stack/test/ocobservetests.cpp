@@ -0,0 +1,271 @@
+//******************************************************************
+//
+// Copyright 2015 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+extern "C"
+{
+    #include "ocstack.h"
+    #include "ocstackinternal.h"
+    #include "ocresourcehandler.h"
+    #include "ocobserve.h"
+    #include "ocpayload.h"
+}
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "gtest_helper.h"
+
+namespace itst = iotivity::test;
+
+static const std::chrono::seconds SHORT_TEST_TIMEOUT = std::chrono::seconds(5);
+static const int BENCHMARK_OBSERVERS = 1000;
+static const int BENCHMARK_NOTIFICATIONS = 10;
+
+static int g_requestCount = 0;
+
+static OCEntityHandlerResult notifyingHandler(OCEntityHandlerFlag flag,
+        OCEntityHandlerRequest *request, void * /*callbackParam*/)
+{
+    if (!(flag & OC_REQUEST_FLAG))
+    {
+        return OC_EH_OK;
+    }
+    ++g_requestCount;
+
+    OCRepPayload *payload = OCRepPayloadCreate();
+    OCRepPayloadSetPropInt(payload, "power", g_requestCount);
+
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = request->requestHandle;
+    response.resourceHandle = request->resource;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *)payload;
+    OCStackResult result = OCDoResponse(&response);
+
+    OCRepPayloadDestroy(payload);
+    return (result == OC_STACK_OK) ? OC_EH_OK : OC_EH_ERROR;
+}
+
+class OCObserveF : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        g_requestCount = 0;
+        EXPECT_EQ(OC_STACK_OK, OCInit(NULL, 0, OC_SERVER));
+        EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                                "core.light",
+                                                "oic.if.baseline",
+                                                "/a/light",
+                                                notifyingHandler,
+                                                NULL,
+                                                OC_DISCOVERABLE|OC_OBSERVABLE));
+    }
+
+    virtual void TearDown()
+    {
+        SetObserverNotificationRate(MAX_OBSERVER_NOTIFICATIONS_PER_SECOND);
+        EXPECT_EQ(OC_STACK_OK, OCStop());
+    }
+
+    void makeToken(int index, char *token)
+    {
+        token[0] = (char)0xA5;
+        token[1] = (char)(index >> 8);
+        token[2] = (char)(index & 0xFF);
+        for (int i = 3; i < CA_MAX_TOKEN_LEN; i++)
+        {
+            token[i] = (char)i;
+        }
+    }
+
+    OCStackResult addObserver(int index, OCObservationId id, const char *query = NULL)
+    {
+        char token[CA_MAX_TOKEN_LEN];
+        makeToken(index, token);
+
+        OCDevAddr devAddr;
+        memset(&devAddr, 0, sizeof(devAddr));
+        devAddr.adapter = OC_ADAPTER_IP;
+        devAddr.flags = OC_IP_USE_V4;
+        devAddr.port = (uint16_t)(40000 + index % 1000);
+        strncpy(devAddr.addr, "127.0.0.1", sizeof(devAddr.addr) - 1);
+
+        return AddObserver("/a/light", query, id, token, CA_MAX_TOKEN_LEN,
+                           (OCResource *)handle, OC_LOW_QOS, OC_FORMAT_CBOR, &devAddr);
+    }
+
+    ResourceObserver *findObserver(int index)
+    {
+        char token[CA_MAX_TOKEN_LEN];
+        makeToken(index, token);
+        return GetObserverUsingToken(token, CA_MAX_TOKEN_LEN);
+    }
+
+    OCResourceHandle handle;
+};
+
+TEST_F(OCObserveF, IndexesFollowAddAndDelete)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+
+    OCObservationId ids[UINT8_MAX];
+    for (int i = 0; i < UINT8_MAX; i++)
+    {
+        ASSERT_EQ(OC_STACK_OK, GenerateObserverId(&ids[i]));
+        EXPECT_NE(0, ids[i]);
+        ASSERT_EQ(OC_STACK_OK, addObserver(i, ids[i]));
+    }
+
+    // Every ID is taken now; further observers can only be added without one
+    OCObservationId id = 0;
+    EXPECT_EQ(OC_STACK_ERROR, GenerateObserverId(&id));
+    ASSERT_EQ(OC_STACK_OK, addObserver(UINT8_MAX, 0));
+
+    for (int i = 0; i < UINT8_MAX; i++)
+    {
+        ResourceObserver *observer = findObserver(i);
+        ASSERT_TRUE(NULL != observer);
+        EXPECT_EQ(ids[i], observer->observeId);
+        EXPECT_EQ(observer, GetObserverUsingId(ids[i]));
+    }
+    EXPECT_TRUE(NULL != findObserver(UINT8_MAX));
+
+    for (int i = 0; i < UINT8_MAX; i += 2)
+    {
+        char token[CA_MAX_TOKEN_LEN];
+        makeToken(i, token);
+        EXPECT_EQ(OC_STACK_OK, DeleteObserverUsingToken(token, CA_MAX_TOKEN_LEN));
+    }
+    for (int i = 0; i < UINT8_MAX; i++)
+    {
+        EXPECT_EQ(i % 2 != 0, NULL != findObserver(i));
+        EXPECT_EQ(i % 2 != 0, NULL != GetObserverUsingId(ids[i]));
+    }
+
+    // A shorter token with the same prefix is a different observer
+    char token[CA_MAX_TOKEN_LEN];
+    makeToken(1, token);
+    EXPECT_EQ(NULL, GetObserverUsingToken(token, CA_MAX_TOKEN_LEN - 1));
+
+    EXPECT_EQ(OC_STACK_OK, GenerateObserverId(&id));
+}
+
+TEST_F(OCObserveF, DeleteResourceRemovesObservers)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+
+    ASSERT_EQ(OC_STACK_OK, addObserver(1, 1));
+    ASSERT_EQ(OC_STACK_OK, addObserver(2, 2));
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle));
+
+    EXPECT_EQ(NULL, findObserver(1));
+    EXPECT_EQ(NULL, findObserver(2));
+    EXPECT_EQ(NULL, GetObserverUsingId(1));
+}
+
+TEST_F(OCObserveF, NotifyAllCallsHandlerOncePerQuery)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+
+    for (int i = 0; i < 10; i++)
+    {
+        ASSERT_EQ(OC_STACK_OK, addObserver(i, 0));
+    }
+    ASSERT_EQ(OC_STACK_OK, addObserver(10, 0, "if=oic.if.baseline"));
+
+    EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_LOW_QOS));
+    EXPECT_EQ(2, g_requestCount);
+}
+
+TEST_F(OCObserveF, NotifyListOfObservers)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+
+    OCObservationId ids[10];
+    for (int i = 0; i < 10; i++)
+    {
+        ASSERT_EQ(OC_STACK_OK, GenerateObserverId(&ids[i]));
+        ASSERT_EQ(OC_STACK_OK, addObserver(i, ids[i]));
+    }
+
+    OCRepPayload *payload = OCRepPayloadCreate();
+    OCRepPayloadSetPropInt(payload, "power", 1);
+    EXPECT_EQ(OC_STACK_OK, OCNotifyListOfObservers(handle, ids, 10, payload, OC_LOW_QOS));
+
+    // Observers that are gone are reported, the others are still notified
+    EXPECT_EQ(OC_STACK_OK, DeleteObserverUsingToken(findObserver(0)->token, CA_MAX_TOKEN_LEN));
+    EXPECT_EQ(OC_STACK_ERROR, OCNotifyListOfObservers(handle, ids, 10, payload, OC_LOW_QOS));
+    EXPECT_EQ(0, g_requestCount);
+
+    OCRepPayloadDestroy(payload);
+}
+
+TEST_F(OCObserveF, RateLimitCoalescesNotifications)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+
+    SetObserverNotificationRate(1);
+    ASSERT_EQ(OC_STACK_OK, addObserver(1, 0));
+
+    EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_LOW_QOS));
+    EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_LOW_QOS));
+    EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_LOW_QOS));
+    EXPECT_EQ(1, g_requestCount);
+    EXPECT_TRUE(findObserver(1)->pendingNotification);
+
+    SendPendingObserverNotifications();
+    EXPECT_EQ(1, g_requestCount);
+
+    usleep(1100000);
+    SendPendingObserverNotifications();
+    EXPECT_EQ(2, g_requestCount);
+    EXPECT_FALSE(findObserver(1)->pendingNotification);
+
+    SendPendingObserverNotifications();
+    EXPECT_EQ(2, g_requestCount);
+}
+
+TEST_F(OCObserveF, BenchmarkThousandObservers)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+
+    for (int i = 0; i < BENCHMARK_OBSERVERS; i++)
+    {
+        ASSERT_EQ(OC_STACK_OK, addObserver(i, 0));
+    }
+
+    clock_t start = clock();
+    for (int i = 0; i < BENCHMARK_NOTIFICATIONS; i++)
+    {
+        EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_LOW_QOS));
+    }
+    clock_t elapsed = clock() - start;
+
+    EXPECT_EQ(BENCHMARK_NOTIFICATIONS, g_requestCount);
+    printf("[          ] %d observers, %.3f usec CPU per notified observer\n",
+           BENCHMARK_OBSERVERS, (double)elapsed * 1000000 / CLOCKS_PER_SEC /
+           (BENCHMARK_NOTIFICATIONS * BENCHMARK_OBSERVERS));
+}
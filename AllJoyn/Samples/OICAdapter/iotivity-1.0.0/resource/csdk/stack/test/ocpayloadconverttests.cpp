@@ -0,0 +1,214 @@
+//******************************************************************
+//
+// Copyright 2015 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+extern "C"
+{
+    #include "ocstack.h"
+    #include "ocpayload.h"
+    #include "ocpayloadcbor.h"
+    #include "ocrandom.h"
+    #include "oic_malloc.h"
+    #include "oic_string.h"
+}
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static const int BENCHMARK_ITERATIONS = 2000;
+
+static OCStringLL* createStringLL(const char* value)
+{
+    OCStringLL* ll = (OCStringLL*)OICCalloc(1, sizeof(OCStringLL));
+    ll->value = OICStrdup(value);
+    return ll;
+}
+
+static OCDiscoveryPayload* createDiscoveryPayload(int resourceCount)
+{
+    OCDiscoveryPayload* payload = OCDiscoveryPayloadCreate();
+    for (int i = 0; i < resourceCount; ++i)
+    {
+        char uri[32];
+        snprintf(uri, sizeof(uri), "/a/light/%d", i);
+
+        OCResourcePayload* res = (OCResourcePayload*)OICCalloc(1, sizeof(OCResourcePayload));
+        res->uri = OICStrdup(uri);
+        res->sid = (uint8_t*)OICCalloc(1, UUID_SIZE);
+        res->types = createStringLL("core.light");
+        res->types->next = createStringLL("core.brightlight");
+        res->interfaces = createStringLL("oic.if.baseline");
+        res->bitmap = OC_DISCOVERABLE | OC_OBSERVABLE;
+        OCDiscoveryPayloadAddNewResource(payload, res);
+    }
+    return payload;
+}
+
+static OCRepPayload* createRepPayload(int index)
+{
+    char uri[32];
+    snprintf(uri, sizeof(uri), "/a/room/%d", index);
+
+    OCRepPayload* payload = OCRepPayloadCreate();
+    OCRepPayloadSetUri(payload, uri);
+    OCRepPayloadAddResourceType(payload, "core.room");
+    OCRepPayloadSetPropInt(payload, "power", index);
+    OCRepPayloadSetPropDouble(payload, "temperature", 21.5);
+    OCRepPayloadSetPropString(payload, "name", "living room ceiling light");
+    OCRepPayloadSetPropBool(payload, "state", true);
+
+    int64_t values[16];
+    for (int i = 0; i < 16; ++i)
+    {
+        values[i] = i * 1000;
+    }
+    size_t dimensions[MAX_REP_ARRAY_DEPTH] = {16, 0, 0};
+    OCRepPayloadSetIntArray(payload, "history", values, dimensions);
+    return payload;
+}
+
+static OCRepPayload* createCollectionPayload(int childCount)
+{
+    OCRepPayload* payload = createRepPayload(0);
+    for (int i = 1; i <= childCount; ++i)
+    {
+        OCRepPayloadAppend(payload, createRepPayload(i));
+    }
+    return payload;
+}
+
+static void benchmark(const char* name, OCPayload* payload)
+{
+    uint8_t* out = NULL;
+    size_t size = 0;
+
+    clock_t start = clock();
+    for (int i = 0; i < BENCHMARK_ITERATIONS; ++i)
+    {
+        ASSERT_EQ(OC_STACK_OK, OCConvertPayload(payload, &out, &size));
+        OICFree(out);
+    }
+    clock_t elapsed = clock() - start;
+
+    printf("[          ] %s: %u bytes, %.3f usec CPU per conversion\n", name, (unsigned)size,
+           (double)elapsed * 1000000 / CLOCKS_PER_SEC / BENCHMARK_ITERATIONS);
+}
+
+static void expectBufferMatches(OCPayload* payload)
+{
+    uint8_t* out = NULL;
+    size_t size = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload(payload, &out, &size));
+
+    size_t required = 0;
+    EXPECT_EQ(OC_STACK_NO_MEMORY, OCConvertPayloadToBuffer(payload, NULL, &required));
+    EXPECT_EQ(size, required);
+
+    uint8_t* buffer = (uint8_t*)OICMalloc(required);
+    size_t bufferSize = required - 1;
+    EXPECT_EQ(OC_STACK_NO_MEMORY, OCConvertPayloadToBuffer(payload, buffer, &bufferSize));
+    EXPECT_EQ(required, bufferSize);
+
+    bufferSize = required;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayloadToBuffer(payload, buffer, &bufferSize));
+    EXPECT_EQ(size, bufferSize);
+    EXPECT_EQ(0, memcmp(out, buffer, size));
+
+    OICFree(buffer);
+    OICFree(out);
+}
+
+TEST(OCConvertPayloadTests, InvalidParams)
+{
+    OCRepPayload* payload = OCRepPayloadCreate();
+    uint8_t buffer[8];
+    size_t size = sizeof(buffer);
+
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCConvertPayloadToBuffer(NULL, buffer, &size));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCConvertPayloadToBuffer((OCPayload*)payload, buffer, NULL));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCConvertPayloadToBuffer((OCPayload*)payload, NULL, &size));
+
+    OCPayloadDestroy((OCPayload*)payload);
+}
+
+TEST(OCConvertPayloadTests, RepresentationToBuffer)
+{
+    OCRepPayload* payload = createRepPayload(1);
+    expectBufferMatches((OCPayload*)payload);
+    OCPayloadDestroy((OCPayload*)payload);
+}
+
+TEST(OCConvertPayloadTests, DiscoveryToBuffer)
+{
+    OCDiscoveryPayload* payload = createDiscoveryPayload(32);
+    expectBufferMatches((OCPayload*)payload);
+    OCPayloadDestroy((OCPayload*)payload);
+}
+
+TEST(OCConvertPayloadTests, ArenaGrowthKeepsOutput)
+{
+    OCConvertPayloadReleaseArena();
+
+    // Larger than the initial arena, so the first conversion has to grow it.
+    OCRepPayload* payload = createCollectionPayload(16);
+    uint8_t* first = NULL;
+    size_t firstSize = 0;
+    uint8_t* second = NULL;
+    size_t secondSize = 0;
+
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)payload, &first, &firstSize));
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)payload, &second, &secondSize));
+    EXPECT_EQ(firstSize, secondSize);
+    EXPECT_EQ(0, memcmp(first, second, firstSize));
+
+    OCPayload* parsed = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCParsePayload(&parsed, PAYLOAD_TYPE_REPRESENTATION,
+                                          first, firstSize));
+    size_t children = 0;
+    for (OCRepPayload* rep = (OCRepPayload*)parsed; rep; rep = rep->next)
+    {
+        ++children;
+    }
+    EXPECT_EQ(17u, children);
+
+    OCPayloadDestroy(parsed);
+    OICFree(first);
+    OICFree(second);
+    OCPayloadDestroy((OCPayload*)payload);
+    OCConvertPayloadReleaseArena();
+}
+
+TEST(OCConvertPayloadTests, Benchmark)
+{
+    OCDiscoveryPayload* discovery = createDiscoveryPayload(32);
+    OCRepPayload* representation = createRepPayload(1);
+    OCRepPayload* collection = createCollectionPayload(16);
+
+    benchmark("discovery (32 resources)", (OCPayload*)discovery);
+    benchmark("representation", (OCPayload*)representation);
+    benchmark("collection (16 children)", (OCPayload*)collection);
+
+    OCPayloadDestroy((OCPayload*)discovery);
+    OCPayloadDestroy((OCPayload*)representation);
+    OCPayloadDestroy((OCPayload*)collection);
+    OCConvertPayloadReleaseArena();
+}
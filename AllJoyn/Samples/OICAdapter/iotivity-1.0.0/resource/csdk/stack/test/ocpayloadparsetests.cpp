@@ -0,0 +1,689 @@
+//******************************************************************
+//
+// Copyright 2015 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+extern "C"
+{
+    #include "ocstack.h"
+    #include "ocpayload.h"
+    #include "ocpayloadcbor.h"
+    #include "ocpayloadarena.h"
+    #include "ocrandom.h"
+    #include "oic_malloc.h"
+    #include "oic_string.h"
+}
+
+#include "cbor.h"
+#include "gtest/gtest.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+static const int BENCHMARK_ITERATIONS = 2000;
+static const int FUZZ_ITERATIONS = 20000;
+
+static void encode(OCPayload* payload, uint8_t** out, size_t* size)
+{
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload(payload, out, size));
+}
+
+static OCPayload* parse(OCPayloadParseMode mode, OCPayloadType type,
+                        const uint8_t* buffer, size_t size)
+{
+    OCPayload* payload = NULL;
+    OCSetPayloadParseMode(mode);
+    EXPECT_EQ(OC_STACK_OK, OCParsePayload(&payload, type, buffer, size));
+    OCSetPayloadParseMode(OC_PAYLOAD_PARSE_INDEXED);
+    return payload;
+}
+
+static OCRepPayload* createRepPayload(int propertyCount)
+{
+    OCRepPayload* payload = OCRepPayloadCreate();
+    OCRepPayloadSetUri(payload, "/a/room");
+    OCRepPayloadAddResourceType(payload, "core.room");
+    OCRepPayloadAddResourceType(payload, "core.light");
+    OCRepPayloadAddInterface(payload, "oic.if.baseline");
+    OCRepPayloadSetPropString(payload, "name", "living room ceiling light");
+    OCRepPayloadSetPropDouble(payload, "temperature", 21.5);
+    OCRepPayloadSetPropBool(payload, "state", true);
+    OCRepPayloadSetNull(payload, "nothing");
+
+    int64_t values[16];
+    for (int i = 0; i < 16; ++i)
+    {
+        values[i] = i * 1000;
+    }
+    size_t dimensions[MAX_REP_ARRAY_DEPTH] = {16, 0, 0};
+    OCRepPayloadSetIntArray(payload, "history", values, dimensions);
+
+    const char* names[] = {"kitchen", "hall", "bedroom"};
+    size_t strDimensions[MAX_REP_ARRAY_DEPTH] = {3, 0, 0};
+    OCRepPayloadSetStringArray(payload, "rooms", names, strDimensions);
+
+    OCRepPayload* child = OCRepPayloadCreate();
+    OCRepPayloadSetPropInt(child, "level", 7);
+    OCRepPayloadSetPropString(child, "unit", "lux");
+    OCRepPayload* children[2] = {child, OCRepPayloadClone(child)};
+    size_t objDimensions[MAX_REP_ARRAY_DEPTH] = {2, 0, 0};
+    OCRepPayloadSetPropObjectArray(payload, "sensors", (const OCRepPayload**)children,
+                                   objDimensions);
+    OCRepPayloadSetPropObjectAsOwner(payload, "dimmer", children[1]);
+    OCRepPayloadDestroy(child);
+
+    for (int i = 0; i < propertyCount; ++i)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "property%d", i);
+        OCRepPayloadSetPropInt(payload, name, i);
+    }
+    return payload;
+}
+
+static OCDiscoveryPayload* createDiscoveryPayload(int resourceCount)
+{
+    OCDiscoveryPayload* payload = OCDiscoveryPayloadCreate();
+    for (int i = 0; i < resourceCount; ++i)
+    {
+        char uri[32];
+        snprintf(uri, sizeof(uri), "/a/light/%d", i);
+
+        OCResourcePayload* res = (OCResourcePayload*)OICCalloc(1, sizeof(OCResourcePayload));
+        res->uri = OICStrdup(uri);
+        res->sid = (uint8_t*)OICCalloc(1, UUID_SIZE);
+        OCResourcePayloadAddResourceType(res, "core.light");
+        OCResourcePayloadAddResourceType(res, "core.brightlight");
+        OCResourcePayloadAddInterface(res, "oic.if.baseline");
+        res->bitmap = OC_DISCOVERABLE | OC_OBSERVABLE;
+        OCDiscoveryPayloadAddNewResource(payload, res);
+    }
+    return payload;
+}
+
+// A representation of a collection, whose children hold the rest of the tree.
+static OCRepPayload* createNestedRepPayload(int depth, int children)
+{
+    OCRepPayload* payload = OCRepPayloadCreate();
+    OCRepPayloadSetPropString(payload, "name", "floor");
+    OCRepPayloadSetPropInt(payload, "depth", depth);
+    OCRepPayloadSetPropBool(payload, "state", depth % 2 == 0);
+    for (int i = 0; depth > 0 && i < children; ++i)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "child%d", i);
+        OCRepPayloadSetPropObjectAsOwner(payload, name,
+                                         createNestedRepPayload(depth - 1, children));
+    }
+    return payload;
+}
+
+// parses in all modes and checks that they encode back to the same bytes
+static void expectModesMatch(OCPayload* payload, OCPayloadType type)
+{
+    uint8_t* original = NULL;
+    size_t originalSize = 0;
+    encode(payload, &original, &originalSize);
+
+    for (int mode = OC_PAYLOAD_PARSE_HEAP; mode <= OC_PAYLOAD_PARSE_INDEXED; ++mode)
+    {
+        OCPayload* parsed = parse((OCPayloadParseMode)mode, type, original, originalSize);
+        ASSERT_TRUE(NULL != parsed);
+
+        uint8_t* out = NULL;
+        size_t size = 0;
+        encode(parsed, &out, &size);
+        EXPECT_EQ(originalSize, size);
+        EXPECT_EQ(0, memcmp(original, out, size));
+
+        OICFree(out);
+        OCPayloadDestroy(parsed);
+    }
+    OICFree(original);
+}
+
+TEST(OCPayloadArenaTests, AllocatesAcrossBlocks)
+{
+    OCPayloadArena* arena = OCPayloadArenaCreate(0);
+    ASSERT_TRUE(NULL != arena);
+
+    void* first = OCPayloadArenaCalloc(arena, 3, sizeof(int64_t));
+    char* str = OCPayloadArenaStrdup(arena, "core.light");
+    void* aligned = OCPayloadArenaCalloc(arena, 1, sizeof(double));
+    ASSERT_TRUE(first && str && aligned);
+    EXPECT_EQ(0u, (uintptr_t)aligned % sizeof(double));
+    EXPECT_STREQ("core.light", str);
+
+    // more than the first block, so it takes another one
+    void* big = OCPayloadArenaCalloc(arena, 4096, 1);
+    ASSERT_TRUE(NULL != big);
+    EXPECT_TRUE(OCPayloadArenaOwns(arena, first));
+    EXPECT_TRUE(OCPayloadArenaOwns(arena, big));
+
+    char* heap = OICStrdup("heap");
+    EXPECT_FALSE(OCPayloadArenaOwns(arena, heap));
+    OCPayloadArenaFree(arena, str);
+    OCPayloadArenaFree(arena, heap);
+
+    EXPECT_EQ(NULL, OCPayloadArenaCalloc(arena, SIZE_MAX / 2, 4));
+    OCPayloadArenaRelease(arena);
+}
+
+TEST(OCPayloadParseTests, RepresentationModesMatch)
+{
+    OCRepPayload* payload = createRepPayload(0);
+    expectModesMatch((OCPayload*)payload, PAYLOAD_TYPE_REPRESENTATION);
+    OCRepPayloadDestroy(payload);
+
+    payload = createRepPayload(64);
+    expectModesMatch((OCPayload*)payload, PAYLOAD_TYPE_REPRESENTATION);
+    OCRepPayloadDestroy(payload);
+
+    payload = createNestedRepPayload(4, 3);
+    expectModesMatch((OCPayload*)payload, PAYLOAD_TYPE_REPRESENTATION);
+    OCRepPayloadDestroy(payload);
+}
+
+TEST(OCPayloadParseTests, DiscoveryModesMatch)
+{
+    OCDiscoveryPayload* payload = createDiscoveryPayload(32);
+    expectModesMatch((OCPayload*)payload, PAYLOAD_TYPE_DISCOVERY);
+    OCDiscoveryPayloadDestroy(payload);
+}
+
+TEST(OCPayloadParseTests, SettersOnArenaPayload)
+{
+    OCRepPayload* payload = createRepPayload(4);
+    uint8_t* buffer = NULL;
+    size_t size = 0;
+    encode((OCPayload*)payload, &buffer, &size);
+    OCRepPayloadDestroy(payload);
+
+    OCRepPayload* parsed = (OCRepPayload*)parse(OC_PAYLOAD_PARSE_ARENA,
+                                                PAYLOAD_TYPE_REPRESENTATION, buffer, size);
+    ASSERT_TRUE(NULL != parsed);
+    ASSERT_TRUE(NULL != parsed->arena);
+    EXPECT_STREQ("core.room", parsed->types->value);
+    EXPECT_STREQ("core.light", parsed->types->next->value);
+
+    // values of the arena replaced by values of the heap
+    EXPECT_TRUE(OCRepPayloadSetPropString(parsed, "name", "hall light"));
+    EXPECT_TRUE(OCRepPayloadSetPropInt(parsed, "history", 3));
+    EXPECT_TRUE(OCRepPayloadSetPropString(parsed, "added", "value"));
+    EXPECT_TRUE(OCRepPayloadAddResourceType(parsed, "core.added"));
+
+    char* name = NULL;
+    EXPECT_TRUE(OCRepPayloadGetPropString(parsed, "name", &name));
+    EXPECT_STREQ("hall light", name);
+    OICFree(name);
+    int64_t history = 0;
+    EXPECT_TRUE(OCRepPayloadGetPropInt(parsed, "history", &history));
+    EXPECT_EQ(3, history);
+
+    OCRepPayload* dimmer = NULL;
+    EXPECT_TRUE(OCRepPayloadGetPropObject(parsed, "dimmer", &dimmer));
+    int64_t level = 0;
+    EXPECT_TRUE(OCRepPayloadGetPropInt(dimmer, "level", &level));
+    EXPECT_EQ(7, level);
+    OCRepPayloadDestroy(dimmer);
+
+    // a clone is on the heap and outlives the arena
+    OCRepPayload* clone = OCRepPayloadClone(parsed);
+    OCRepPayloadDestroy(parsed);
+    EXPECT_EQ(NULL, clone->arena);
+    EXPECT_TRUE(OCRepPayloadGetPropString(clone, "added", &name));
+    EXPECT_STREQ("value", name);
+    OICFree(name);
+    EXPECT_TRUE(OCRepPayloadGetPropInt(clone, "property3", &level));
+    EXPECT_EQ(3, level);
+    OCRepPayloadDestroy(clone);
+
+    OICFree(buffer);
+}
+
+TEST(OCPayloadParseTests, IndexedProperties)
+{
+    const int count = 200;
+    OCRepPayload* payload = OCRepPayloadCreate();
+    for (int i = 0; i < count; ++i)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "p%d", i);
+        ASSERT_TRUE(OCRepPayloadSetPropInt(payload, name, i));
+    }
+    EXPECT_EQ((size_t)count, payload->valueCount);
+    EXPECT_TRUE(NULL != payload->valueIndex);
+
+    // setting a property again keeps its position
+    EXPECT_TRUE(OCRepPayloadSetPropInt(payload, "p17", -17));
+    EXPECT_EQ((size_t)count, payload->valueCount);
+
+    int i = 0;
+    for (OCRepPayloadValue* val = payload->values; val; val = val->next, ++i)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "p%d", i);
+        EXPECT_STREQ(name, val->name);
+
+        int64_t value = 0;
+        EXPECT_TRUE(OCRepPayloadGetPropInt(payload, name, &value));
+        EXPECT_EQ(i == 17 ? -17 : i, value);
+    }
+    EXPECT_EQ(count, i);
+    EXPECT_FALSE(OCRepPayloadIsNull(payload, "p"));
+    EXPECT_FALSE(OCRepPayloadIsNull(payload, "missing"));
+
+    OCRepPayloadDestroy(payload);
+}
+
+TEST(OCPayloadParseTests, MalformedPayloads)
+{
+    // [{"rep": {"a": "abc", "b": [1, 2], "c": undefined}}]
+    const uint8_t rep[] = {0x81, 0xA1, 0x63, 'r', 'e', 'p', 0xA3, 0x61, 'a', 0x63, 'a', 'b', 'c',
+                           0x61, 'b', 0x82, 0x01, 0x02, 0x61, 'c', 0xF7};
+    // [{"di": h'01', "links": [{"href": 5}]}]
+    const uint8_t discovery[] = {0x81, 0xA2, 0x62, 'd', 'i', 0x41, 0x01,
+                                 0x65, 'l', 'i', 'n', 'k', 's', 0x81, 0xA1,
+                                 0x64, 'h', 'r', 'e', 'f', 0x05};
+
+    // what was parsed before the error is freed with the arena
+    for (int mode = OC_PAYLOAD_PARSE_HEAP; mode <= OC_PAYLOAD_PARSE_INDEXED; ++mode)
+    {
+        OCSetPayloadParseMode((OCPayloadParseMode)mode);
+
+        OCPayload* parsed = NULL;
+        EXPECT_EQ(OC_STACK_MALFORMED_RESPONSE, OCParsePayload(&parsed,
+                  PAYLOAD_TYPE_REPRESENTATION, rep, sizeof(rep)));
+        EXPECT_EQ(NULL, parsed);
+        EXPECT_EQ(OC_STACK_MALFORMED_RESPONSE, OCParsePayload(&parsed,
+                  PAYLOAD_TYPE_DISCOVERY, discovery, sizeof(discovery)));
+        EXPECT_EQ(NULL, parsed);
+
+        // truncated: the map misses its last value
+        EXPECT_EQ(OC_STACK_MALFORMED_RESPONSE, OCParsePayload(&parsed,
+                  PAYLOAD_TYPE_REPRESENTATION, rep, sizeof(rep) - 1));
+        EXPECT_EQ(NULL, parsed);
+    }
+    OCSetPayloadParseMode(OC_PAYLOAD_PARSE_INDEXED);
+}
+
+TEST(OCPayloadParseTests, EmptyArrayValue)
+{
+    // [{"rep": {"a": [], "b": 1}}]
+    const uint8_t rep[] = {0x81, 0xA1, 0x63, 'r', 'e', 'p', 0xA2, 0x61, 'a', 0x80,
+                           0x61, 'b', 0x01};
+
+    for (int mode = OC_PAYLOAD_PARSE_HEAP; mode <= OC_PAYLOAD_PARSE_INDEXED; ++mode)
+    {
+        OCRepPayload* parsed = (OCRepPayload*)parse((OCPayloadParseMode)mode,
+                PAYLOAD_TYPE_REPRESENTATION, rep, sizeof(rep));
+        ASSERT_TRUE(NULL != parsed);
+        EXPECT_TRUE(OCRepPayloadIsNull(parsed, "a"));
+        int64_t b = 0;
+        EXPECT_TRUE(OCRepPayloadGetPropInt(parsed, "b", &b));
+        EXPECT_EQ(1, b);
+        OCRepPayloadDestroy(parsed);
+    }
+}
+
+// Records where each item of value and of the containers in it starts, where advancing
+// over it ends and what a key lookup finds, as the payload parsers see them.
+static CborError describeCbor(const CborValue* value, const uint8_t* base,
+                              std::vector<size_t>& out)
+{
+    CborValue next = *value;
+    CborError err = cbor_value_advance(&next);
+    out.push_back(value->ptr - base);
+    out.push_back(err ? SIZE_MAX : next.ptr - base);
+    if (err)
+    {
+        return err;
+    }
+
+    if (cbor_value_is_map(value))
+    {
+        CborValue found;
+        err = cbor_value_map_find_value(value, OC_RSRVD_REPRESENTATION, &found);
+        out.push_back(err || !cbor_value_is_valid(&found) ? SIZE_MAX : found.ptr - base);
+        if (err)
+        {
+            return err;
+        }
+    }
+
+    if (cbor_value_is_container(value))
+    {
+        CborValue container = *value;
+        CborValue element;
+        err = cbor_value_enter_container(&container, &element);
+        while (!err && !cbor_value_at_end(&element))
+        {
+            err = describeCbor(&element, base, out);
+            err = err ? err : cbor_value_advance(&element);
+        }
+        err = err ? err : cbor_value_leave_container(&container, &element);
+        EXPECT_TRUE(err || container.ptr == next.ptr);
+    }
+    return err;
+}
+
+// Walks the whole buffer with and without an index and checks that both see the same.
+// Returns whether the buffer is valid.
+static bool expectIndexMatchesIterator(const uint8_t* buffer, size_t size, size_t capacity)
+{
+    CborParser parser;
+    CborValue root;
+    if (CborNoError != cbor_parser_init(buffer, size, 0, &parser, &root))
+    {
+        return false;
+    }
+
+    CborValue it = root;
+    CborError walkErr = CborNoError;
+    while (!walkErr && !cbor_value_at_end(&it))
+    {
+        walkErr = cbor_value_advance(&it);
+    }
+
+    std::vector<CborIndexEntry> entries(capacity + 1);
+    size_t count = 0;
+    CborError indexErr = cbor_parser_build_index(&parser, &root, 0, &entries[0], capacity,
+                                                 &count);
+    EXPECT_EQ(CborNoError == walkErr, CborNoError == indexErr);
+    if (indexErr)
+    {
+        return false;
+    }
+    EXPECT_EQ(count < capacity ? count : capacity, parser.indexCount);
+
+    std::vector<size_t> expected;
+    std::vector<size_t> actual;
+    CborParser plain;
+    CborValue plainRoot;
+    cbor_parser_init(buffer, size, 0, &plain, &plainRoot);
+    EXPECT_EQ(describeCbor(&plainRoot, buffer, expected), describeCbor(&root, buffer, actual));
+    EXPECT_TRUE(expected == actual);
+    return true;
+}
+
+TEST(OCPayloadParseTests, CborIndexMatchesIterator)
+{
+    OCRepPayload* payload = createNestedRepPayload(3, 3);
+    uint8_t* buffer = NULL;
+    size_t size = 0;
+    encode((OCPayload*)payload, &buffer, &size);
+    OCRepPayloadDestroy(payload);
+
+    // all entries, some of them, none
+    EXPECT_TRUE(expectIndexMatchesIterator(buffer, size, 1024));
+    EXPECT_TRUE(expectIndexMatchesIterator(buffer, size, 5));
+    EXPECT_TRUE(expectIndexMatchesIterator(buffer, size, 0));
+    OICFree(buffer);
+
+    // [_ {"rep": (_ "ab", "c"), 1: 24(h'00'), "x": [_ 1, 24(2)]}, [], {_ }]
+    const uint8_t chunked[] = {0x9F, 0xA3, 0x63, 'r', 'e', 'p', 0x7F, 0x62, 'a', 'b', 0x61, 'c',
+                               0xFF, 0x01, 0xD8, 0x18, 0x41, 0x00, 0x61, 'x', 0x9F, 0x01, 0xD8,
+                               0x18, 0x02, 0xFF, 0x80, 0xBF, 0xFF, 0xFF};
+    EXPECT_TRUE(expectIndexMatchesIterator(chunked, sizeof(chunked), 16));
+
+    CborParser parser;
+    CborValue root;
+    ASSERT_EQ(CborNoError, cbor_parser_init(chunked, sizeof(chunked), 0, &parser, &root));
+    CborIndexEntry entries[16];
+    size_t count = 0;
+    ASSERT_EQ(CborNoError, cbor_parser_build_index(&parser, &root, 0, entries, 16, &count));
+    // the outer array, the first map, its chunked string and array, the empty map;
+    // the empty array is not indexed
+    EXPECT_EQ(5u, count);
+    EXPECT_EQ(0u, entries[0].begin);
+    EXPECT_EQ(sizeof(chunked), entries[0].end);
+
+    for (size_t size = 1; size < sizeof(chunked); ++size)
+    {
+        EXPECT_FALSE(expectIndexMatchesIterator(chunked, size, 16)) << "size " << size;
+    }
+}
+
+TEST(OCPayloadParseTests, CborStringView)
+{
+    // ["light", h'0102', (_ "a", "b")]
+    const uint8_t buffer[] = {0x83, 0x65, 'l', 'i', 'g', 'h', 't', 0x42, 0x01, 0x02,
+                              0x7F, 0x61, 'a', 0x61, 'b', 0xFF};
+    CborParser parser;
+    CborValue root;
+    CborValue it;
+    ASSERT_EQ(CborNoError, cbor_parser_init(buffer, sizeof(buffer), 0, &parser, &root));
+    ASSERT_EQ(CborNoError, cbor_value_enter_container(&root, &it));
+
+    const char* text = NULL;
+    size_t length = 0;
+    ASSERT_EQ(CborNoError, cbor_value_get_text_string_view(&it, &text, &length, &it));
+    EXPECT_EQ(5u, length);
+    EXPECT_EQ((const char*)buffer + 2, text);
+
+    const uint8_t* bytes = NULL;
+    ASSERT_EQ(CborNoError, cbor_value_get_byte_string_view(&it, &bytes, &length, &it));
+    EXPECT_EQ(2u, length);
+    EXPECT_EQ(buffer + 8, bytes);
+
+    // chunks are not contiguous
+    ASSERT_TRUE(cbor_value_is_text_string(&it));
+    EXPECT_EQ(CborErrorUnknownLength, cbor_value_get_text_string_view(&it, &text, &length, NULL));
+
+    // the length says more than there is
+    ASSERT_EQ(CborNoError, cbor_parser_init(buffer, 5, 0, &parser, &root));
+    ASSERT_EQ(CborNoError, cbor_value_enter_container(&root, &it));
+    EXPECT_EQ(CborErrorUnexpectedEOF, cbor_value_get_text_string_view(&it, &text, &length, NULL));
+}
+
+static CborError indexUtf8(const char* text)
+{
+    uint8_t buffer[64];
+    size_t length = strlen(text);
+    buffer[0] = 0x78;
+    buffer[1] = (uint8_t)length;
+    memcpy(buffer + 2, text, length);
+
+    CborParser parser;
+    CborValue root;
+    size_t count = 0;
+    CborError err = cbor_parser_init(buffer, length + 2, 0, &parser, &root);
+    return err ? err : cbor_parser_build_index(&parser, &root, CborIndexFlag_ValidateUtf8,
+                                               NULL, 0, &count);
+}
+
+TEST(OCPayloadParseTests, CborIndexValidatesUtf8)
+{
+    EXPECT_EQ(CborNoError, indexUtf8("oic.if.baseline"));
+    EXPECT_EQ(CborNoError, indexUtf8("caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x92\xA1 and more ascii"));
+    EXPECT_EQ(CborNoError, indexUtf8("\xF4\x8F\xBF\xBF"));
+
+    // after a word of ascii, overlong, surrogate, too large, truncated, stray continuation
+    EXPECT_EQ(CborErrorInvalidUtf8TextString, indexUtf8("oic.if.b\xFFseline"));
+    EXPECT_EQ(CborErrorInvalidUtf8TextString, indexUtf8("\xC0\xAF"));
+    EXPECT_EQ(CborErrorInvalidUtf8TextString, indexUtf8("\xE0\x80\xAF"));
+    EXPECT_EQ(CborErrorInvalidUtf8TextString, indexUtf8("\xED\xA0\x80"));
+    EXPECT_EQ(CborErrorInvalidUtf8TextString, indexUtf8("\xF4\x90\x80\x80"));
+    EXPECT_EQ(CborErrorInvalidUtf8TextString, indexUtf8("\xE2\x82"));
+    EXPECT_EQ(CborErrorInvalidUtf8TextString, indexUtf8("a\x80"));
+}
+
+// Deterministic, so that a failure can be reproduced from the iteration number.
+static uint32_t fuzzRandom(uint32_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// Mutates encoded payloads and checks that the index validates exactly what the iterator
+// accepts, and that parsing them in every mode neither crashes nor leaks.
+TEST(OCPayloadParseTests, FuzzPayloads)
+{
+    std::vector<std::vector<uint8_t> > seeds;
+    OCPayload* payloads[] = {
+        (OCPayload*)createRepPayload(4),
+        (OCPayload*)createNestedRepPayload(2, 2),
+        (OCPayload*)createDiscoveryPayload(3)
+    };
+    OCPayloadType types[] = {
+        PAYLOAD_TYPE_REPRESENTATION, PAYLOAD_TYPE_REPRESENTATION, PAYLOAD_TYPE_DISCOVERY
+    };
+    for (size_t i = 0; i < sizeof(payloads) / sizeof(payloads[0]); ++i)
+    {
+        uint8_t* buffer = NULL;
+        size_t size = 0;
+        encode(payloads[i], &buffer, &size);
+        seeds.push_back(std::vector<uint8_t>(buffer, buffer + size));
+        OICFree(buffer);
+        OCPayloadDestroy(payloads[i]);
+    }
+
+    uint32_t state = 0x4F494321;
+    size_t valid = 0;
+    for (int i = 0; i < FUZZ_ITERATIONS; ++i)
+    {
+        size_t seed = fuzzRandom(&state) % seeds.size();
+        std::vector<uint8_t> data = seeds[seed];
+        for (uint32_t n = 1 + fuzzRandom(&state) % 4; n > 0 && !data.empty(); --n)
+        {
+            size_t pos = fuzzRandom(&state) % data.size();
+            switch (fuzzRandom(&state) % 5)
+            {
+                case 0:
+                    data[pos] = (uint8_t)fuzzRandom(&state);
+                    break;
+                case 1:
+                    data[pos] ^= (uint8_t)(1 << fuzzRandom(&state) % 8);
+                    break;
+                case 2:
+                    data.insert(data.begin() + pos, (uint8_t)fuzzRandom(&state));
+                    break;
+                case 3:
+                    data.erase(data.begin() + pos);
+                    break;
+                default:
+                    data.resize(pos);
+                    break;
+            }
+        }
+        if (data.empty())
+        {
+            continue;
+        }
+
+        SCOPED_TRACE(i);
+        valid += expectIndexMatchesIterator(&data[0], data.size(), 8) ? 1 : 0;
+
+        for (int mode = OC_PAYLOAD_PARSE_HEAP; mode <= OC_PAYLOAD_PARSE_INDEXED; ++mode)
+        {
+            OCSetPayloadParseMode((OCPayloadParseMode)mode);
+            OCPayload* parsed = NULL;
+            if (OC_STACK_OK == OCParsePayload(&parsed, types[seed], &data[0], data.size()))
+            {
+                OCPayloadDestroy(parsed);
+            }
+        }
+    }
+    OCSetPayloadParseMode(OC_PAYLOAD_PARSE_INDEXED);
+
+    // the mutations are not all rejected by the CBOR layer
+    EXPECT_LT(0u, valid);
+    printf("[          ] %d mutated payloads, %u valid CBOR\n", FUZZ_ITERATIONS, (unsigned)valid);
+}
+
+// Decodes the payload and looks up what a client reads of it, as OCRepresentation and
+// the discovery callback of the C++ API do.
+static void benchmarkDecode(const char* name, OCPayload* payload, OCPayloadType type)
+{
+    uint8_t* buffer = NULL;
+    size_t size = 0;
+    encode(payload, &buffer, &size);
+
+    const char* modeNames[] = {"heap", "arena", "indexed"};
+    for (int mode = OC_PAYLOAD_PARSE_HEAP; mode <= OC_PAYLOAD_PARSE_INDEXED; ++mode)
+    {
+        OCSetPayloadParseMode((OCPayloadParseMode)mode);
+
+        clock_t start = clock();
+        for (int i = 0; i < BENCHMARK_ITERATIONS; ++i)
+        {
+            OCPayload* parsed = NULL;
+            if (OC_STACK_OK != OCParsePayload(&parsed, type, buffer, size))
+            {
+                ADD_FAILURE();
+                break;
+            }
+
+            size_t found = 0;
+            if (type == PAYLOAD_TYPE_REPRESENTATION)
+            {
+                OCRepPayload* rep = (OCRepPayload*)parsed;
+                for (OCRepPayloadValue* val = rep->values; val; val = val->next)
+                {
+                    found += OCRepPayloadIsNull(rep, val->name) ? 1 : 0;
+                    int64_t value;
+                    found += OCRepPayloadGetPropInt(rep, val->name, &value) ? 1 : 0;
+                }
+            }
+            else
+            {
+                OCDiscoveryPayload* discovery = (OCDiscoveryPayload*)parsed;
+                for (OCResourcePayload* res = discovery->resources; res; res = res->next)
+                {
+                    found += strlen(res->uri) + strlen(res->types->value);
+                }
+            }
+            EXPECT_LT(0u, found);
+
+            OCPayloadDestroy(parsed);
+        }
+        clock_t elapsed = clock() - start;
+
+        printf("[          ] %s: %u bytes, %.3f usec CPU per decode and lookup (%s)\n", name,
+               (unsigned)size, (double)elapsed * 1000000 / CLOCKS_PER_SEC / BENCHMARK_ITERATIONS,
+               modeNames[mode]);
+    }
+    OCSetPayloadParseMode(OC_PAYLOAD_PARSE_INDEXED);
+    OICFree(buffer);
+}
+
+TEST(OCPayloadParseTests, Benchmark)
+{
+    OCDiscoveryPayload* discovery = createDiscoveryPayload(32);
+    OCRepPayload* representation = createRepPayload(0);
+    OCRepPayload* large = createRepPayload(64);
+    OCRepPayload* nested = createNestedRepPayload(4, 3);
+
+    benchmarkDecode("discovery (32 resources)", (OCPayload*)discovery,
+                    PAYLOAD_TYPE_DISCOVERY);
+    benchmarkDecode("representation", (OCPayload*)representation,
+                    PAYLOAD_TYPE_REPRESENTATION);
+    benchmarkDecode("representation (72 properties)", (OCPayload*)large,
+                    PAYLOAD_TYPE_REPRESENTATION);
+    benchmarkDecode("representation (121 nested objects)", (OCPayload*)nested,
+                    PAYLOAD_TYPE_REPRESENTATION);
+
+    OCPayloadDestroy((OCPayload*)discovery);
+    OCPayloadDestroy((OCPayload*)representation);
+    OCPayloadDestroy((OCPayload*)large);
+    OCPayloadDestroy((OCPayload*)nested);
+}
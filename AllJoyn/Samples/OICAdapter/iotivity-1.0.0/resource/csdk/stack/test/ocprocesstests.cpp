@@ -0,0 +1,323 @@
+//******************************************************************
+//
+// Copyright 2015 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+extern "C"
+{
+    #include "ocstack.h"
+    #include "ocstackinternal.h"
+    #include "ocobserve.h"
+    #include "ocpayload.h"
+}
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "gtest_helper.h"
+
+namespace itst = iotivity::test;
+
+static const std::chrono::seconds SHORT_TEST_TIMEOUT = std::chrono::seconds(5);
+static const std::chrono::seconds LONG_TEST_TIMEOUT = std::chrono::seconds(60);
+static const int BENCHMARK_ROUND_TRIPS = 100;
+
+static OCEntityHandlerResult lightHandler(OCEntityHandlerFlag flag,
+        OCEntityHandlerRequest *request, void * /*callbackParam*/)
+{
+    if (!(flag & OC_REQUEST_FLAG))
+    {
+        return OC_EH_OK;
+    }
+
+    OCRepPayload *payload = OCRepPayloadCreate();
+    OCRepPayloadSetPropInt(payload, "power", 42);
+
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = request->requestHandle;
+    response.resourceHandle = request->resource;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *)payload;
+    OCStackResult result = OCDoResponse(&response);
+
+    OCRepPayloadDestroy(payload);
+    return (result == OC_STACK_OK) ? OC_EH_OK : OC_EH_ERROR;
+}
+
+static uint64_t nowUsec()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class OCProcessF : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        m_responses = 0;
+        EXPECT_EQ(OC_STACK_OK, OCInit(NULL, 0, OC_CLIENT_SERVER));
+        EXPECT_EQ(OC_STACK_OK, OCCreateResource(&m_handle,
+                                                "core.light",
+                                                "oic.if.baseline",
+                                                "/a/light",
+                                                lightHandler,
+                                                NULL,
+                                                OC_DISCOVERABLE|OC_OBSERVABLE));
+
+        memset(&m_server, 0, sizeof(m_server));
+        m_server.adapter = OC_ADAPTER_IP;
+        m_server.flags = OC_IP_USE_V4;
+        m_server.port = caglobals.ip.u4.port;
+        strncpy(m_server.addr, "127.0.0.1", sizeof(m_server.addr) - 1);
+    }
+
+    virtual void TearDown()
+    {
+        stopProcessing();
+        EXPECT_EQ(OC_STACK_OK, OCStop());
+    }
+
+    // Runs OCProcess like the C++ wrappers did before, or blocks between calls.
+    void startProcessing(bool eventDriven)
+    {
+        m_run = true;
+        m_thread = std::thread([this, eventDriven]()
+        {
+            while (m_run)
+            {
+                uint32_t timeout = UINT32_MAX;
+                {
+                    std::lock_guard<std::recursive_mutex> lock(m_stackLock);
+                    OCProcessEvents(&timeout);
+                }
+
+                if (!eventDriven || OC_STACK_NOTIMPL == OCWaitForEvents(timeout))
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+            }
+        });
+    }
+
+    void stopProcessing()
+    {
+        if (m_thread.joinable())
+        {
+            m_run = false;
+            OCSignalEvents();
+            m_thread.join();
+        }
+    }
+
+    static OCStackApplicationResult responseHandler(void *ctx, OCDoHandle /*handle*/,
+                                                    OCClientResponse * /*clientResponse*/)
+    {
+        OCProcessF *self = static_cast<OCProcessF *>(ctx);
+        std::lock_guard<std::mutex> lock(self->m_responseLock);
+        self->m_responses++;
+        self->m_responseCond.notify_all();
+        return OC_STACK_KEEP_TRANSACTION;
+    }
+
+    int responses()
+    {
+        std::lock_guard<std::mutex> lock(m_responseLock);
+        return m_responses;
+    }
+
+    bool waitForResponses(int count)
+    {
+        std::unique_lock<std::mutex> lock(m_responseLock);
+        return m_responseCond.wait_for(lock, SHORT_TEST_TIMEOUT,
+                                       [this, count]() { return m_responses >= count; });
+    }
+
+    OCStackResult doResource(OCDoHandle *handle, OCMethod method)
+    {
+        OCCallbackData cbData;
+        cbData.cb = responseHandler;
+        cbData.context = this;
+        cbData.cd = NULL;
+
+        std::lock_guard<std::recursive_mutex> lock(m_stackLock);
+        return OCDoResource(handle, method, "/a/light", &m_server, NULL, CT_DEFAULT,
+                            OC_LOW_QOS, &cbData, NULL, 0);
+    }
+
+    // returns the average time in usec from OCDoResource until the response is handled
+    double benchmarkGet(bool eventDriven)
+    {
+        startProcessing(eventDriven);
+
+        uint64_t total = 0;
+        for (int i = 0; i < BENCHMARK_ROUND_TRIPS; i++)
+        {
+            int expected = responses() + 1;
+            uint64_t start = nowUsec();
+            OCDoHandle handle = NULL;
+            EXPECT_EQ(OC_STACK_OK, doResource(&handle, OC_REST_GET));
+            EXPECT_TRUE(waitForResponses(expected));
+            total += nowUsec() - start;
+
+            std::lock_guard<std::recursive_mutex> lock(m_stackLock);
+            OCCancel(handle, OC_LOW_QOS, NULL, 0);
+        }
+
+        stopProcessing();
+        return (double)total / BENCHMARK_ROUND_TRIPS;
+    }
+
+    // returns the average time in usec from OCNotifyAllObservers until the client has it
+    double benchmarkObserve(bool eventDriven)
+    {
+        startProcessing(eventDriven);
+
+        int expected = responses() + 1;
+        OCDoHandle handle = NULL;
+        EXPECT_EQ(OC_STACK_OK, doResource(&handle, OC_REST_OBSERVE));
+        EXPECT_TRUE(waitForResponses(expected));
+
+        uint64_t total = 0;
+        for (int i = 0; i < BENCHMARK_ROUND_TRIPS; i++)
+        {
+            expected = responses() + 1;
+            uint64_t start = nowUsec();
+            {
+                std::lock_guard<std::recursive_mutex> lock(m_stackLock);
+                EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(m_handle, OC_LOW_QOS));
+            }
+            EXPECT_TRUE(waitForResponses(expected));
+            total += nowUsec() - start;
+        }
+
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_stackLock);
+            OCCancel(handle, OC_LOW_QOS, NULL, 0);
+        }
+        stopProcessing();
+        return (double)total / BENCHMARK_ROUND_TRIPS;
+    }
+
+    OCResourceHandle m_handle;
+    OCDevAddr m_server;
+    std::recursive_mutex m_stackLock;
+    std::thread m_thread;
+    std::atomic<bool> m_run;
+
+    std::mutex m_responseLock;
+    std::condition_variable m_responseCond;
+    int m_responses;
+};
+
+TEST_F(OCProcessF, WaitForEventsTimesOut)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+
+    // datagrams left over from earlier tests wake the first wait
+    while (OC_STACK_OK == OCWaitForEvents(0))
+    {
+        OCProcess();
+    }
+
+    uint64_t start = nowUsec();
+    EXPECT_EQ(OC_STACK_TIMEOUT, OCWaitForEvents(50));
+    EXPECT_LE(45000u, nowUsec() - start);
+
+    EXPECT_EQ(OC_STACK_TIMEOUT, OCWaitForEvents(0));
+}
+
+TEST_F(OCProcessF, SignalEventsEndsWait)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+
+    std::thread signaler([]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        OCSignalEvents();
+    });
+    EXPECT_EQ(OC_STACK_OK, OCWaitForEvents(UINT32_MAX));
+    signaler.join();
+
+    // a signal without a waiter is kept for the next wait
+    EXPECT_EQ(OC_STACK_OK, OCSignalEvents());
+    EXPECT_EQ(OC_STACK_OK, OCWaitForEvents(UINT32_MAX));
+}
+
+TEST_F(OCProcessF, ProcessEventsReportsObserverDeadline)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+
+    uint32_t timeout = 0;
+    EXPECT_EQ(OC_STACK_OK, OCProcessEvents(&timeout));
+    EXPECT_EQ(UINT32_MAX, timeout);
+
+    OCDevAddr devAddr = m_server;
+    devAddr.port = 40000;
+    char token[CA_MAX_TOKEN_LEN] = { (char)0xA5 };
+    SetObserverNotificationRate(1);
+    ASSERT_EQ(OC_STACK_OK, AddObserver("/a/light", NULL, 0, token, CA_MAX_TOKEN_LEN,
+                                       (OCResource *)m_handle, OC_LOW_QOS, OC_FORMAT_CBOR,
+                                       &devAddr));
+
+    // the second notification is held back for the rest of the one second window
+    EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(m_handle, OC_LOW_QOS));
+    EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(m_handle, OC_LOW_QOS));
+    EXPECT_EQ(OC_STACK_OK, OCProcessEvents(&timeout));
+    EXPECT_LT(0u, timeout);
+    EXPECT_GE(1000u, timeout);
+
+    SetObserverNotificationRate(MAX_OBSERVER_NOTIFICATIONS_PER_SECOND);
+}
+
+TEST_F(OCProcessF, GetRoundTrip)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+
+    startProcessing(true);
+    OCDoHandle handle = NULL;
+    EXPECT_EQ(OC_STACK_OK, doResource(&handle, OC_REST_GET));
+    EXPECT_TRUE(waitForResponses(1));
+}
+
+TEST_F(OCProcessF, BenchmarkGetLatency)
+{
+    itst::DeadmanTimer killSwitch(LONG_TEST_TIMEOUT);
+
+    double polled = benchmarkGet(false);
+    double eventDriven = benchmarkGet(true);
+    printf("[          ] GET round trip: %.0f usec polled, %.0f usec event driven\n",
+           polled, eventDriven);
+}
+
+TEST_F(OCProcessF, BenchmarkObserveLatency)
+{
+    itst::DeadmanTimer killSwitch(LONG_TEST_TIMEOUT);
+
+    double polled = benchmarkObserve(false);
+    double eventDriven = benchmarkObserve(true);
+    printf("[          ] notification: %.0f usec polled, %.0f usec event driven\n",
+           polled, eventDriven);
+}
@@ -23,6 +23,7 @@ extern "C"
 {
     #include "ocstack.h"
     #include "ocstackinternal.h"
+    #include "ocresourcehandler.h"
     #include "logger.h"
     #include "oic_malloc.h"
 }
@@ -42,7 +43,10 @@ extern "C"
 #include <string.h>
 
 #include <iostream>
+#include <set>
+#include <string>
 #include <stdint.h>
+#include <time.h>
 
 #include "gtest_helper.h"
 
@@ -82,6 +86,28 @@ extern "C"  OCStackApplicationResult asyncDoResourcesCallback(void* ctx,
     return OC_STACK_KEEP_TRANSACTION;
 }
 
+static std::set<std::string> gDiscoveredUris;
+static bool gDiscoveryDone = false;
+
+extern "C"  OCStackApplicationResult filteredDiscoveryCallback(void* /*ctx*/,
+        OCDoHandle /*handle*/, OCClientResponse * clientResponse)
+{
+    gDiscoveredUris.clear();
+    if (clientResponse && clientResponse->payload &&
+        PAYLOAD_TYPE_DISCOVERY == clientResponse->payload->type)
+    {
+        OCDiscoveryPayload *payload = (OCDiscoveryPayload *)clientResponse->payload;
+        for (OCResourcePayload *resource = payload->resources; resource;
+             resource = resource->next)
+        {
+            gDiscoveredUris.insert(resource->uri);
+        }
+    }
+    gDiscoveryDone = true;
+
+    return OC_STACK_DELETE_TRANSACTION;
+}
+
 //-----------------------------------------------------------------------------
 // Entity handler
 //-----------------------------------------------------------------------------
@@ -128,6 +154,109 @@ uint8_t InitResourceIndex()
     return 0;
 #endif
 }
+
+static bool ResourceHasName(OCResourceHandle handle, const char *name, bool type)
+{
+    uint8_t count = 0;
+    if (type)
+    {
+        EXPECT_EQ(OC_STACK_OK, OCGetNumberOfResourceTypes(handle, &count));
+    }
+    else
+    {
+        EXPECT_EQ(OC_STACK_OK, OCGetNumberOfResourceInterfaces(handle, &count));
+    }
+    for (uint8_t i = 0; i < count; i++)
+    {
+        const char *bound = type ? OCGetResourceTypeName(handle, i) :
+                                   OCGetResourceInterfaceName(handle, i);
+        if (bound && 0 == strcmp(bound, name))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// URIs an rt and/or if filtered discovery must return, found by walking every resource.
+std::set<std::string> FilterResourcesByWalk(const char *interfaceFilter,
+                                            const char *resourceTypeFilter)
+{
+    std::set<std::string> uris;
+    uint8_t numResources = 0;
+    EXPECT_EQ(OC_STACK_OK, OCGetNumberOfResources(&numResources));
+    for (uint8_t i = 0; i < numResources; i++)
+    {
+        OCResourceHandle handle = OCGetResourceHandle(i);
+        OCResourceProperty properties = OCGetResourceProperties(handle);
+        if (properties & OC_EXPLICIT_DISCOVERABLE)
+        {
+            if (!interfaceFilter && !resourceTypeFilter)
+            {
+                continue;
+            }
+        }
+        else if (!(properties & OC_ACTIVE) || !(properties & OC_DISCOVERABLE))
+        {
+            continue;
+        }
+        if ((interfaceFilter && !ResourceHasName(handle, interfaceFilter, false)) ||
+            (resourceTypeFilter && !ResourceHasName(handle, resourceTypeFilter, true)))
+        {
+            continue;
+        }
+        uris.insert(OCGetResourceUri(handle));
+    }
+    return uris;
+}
+
+// Sends a discovery request to the stack itself and returns the URIs in the response.
+std::set<std::string> DiscoverResources(const char *query)
+{
+    OCDevAddr devAddr;
+    memset(&devAddr, 0, sizeof(devAddr));
+    devAddr.adapter = OC_ADAPTER_IP;
+    devAddr.flags = OC_IP_USE_V4;
+    devAddr.port = caglobals.ip.u4.port;
+    strncpy(devAddr.addr, "127.0.0.1", sizeof(devAddr.addr) - 1);
+
+    OCCallbackData cbData;
+    cbData.cb = filteredDiscoveryCallback;
+    cbData.context = NULL;
+    cbData.cd = NULL;
+
+    gDiscoveredUris.clear();
+    gDiscoveryDone = false;
+    EXPECT_EQ(OC_STACK_OK, OCDoResource(NULL, OC_REST_DISCOVER, query, &devAddr, NULL,
+                                        CT_DEFAULT, OC_LOW_QOS, &cbData, NULL, 0));
+    for (int i = 0; i < 1000 && !gDiscoveryDone; i++)
+    {
+        OCProcess();
+        usleep(1000);
+    }
+    EXPECT_TRUE(gDiscoveryDone) << query;
+    return gDiscoveredUris;
+}
+
+void ExpectFilteredDiscoveryMatchesWalk(const char *interfaceFilter,
+                                        const char *resourceTypeFilter)
+{
+    std::string query = OC_RSRVD_WELL_KNOWN_URI;
+    const char *separator = "?";
+    if (interfaceFilter)
+    {
+        query += separator + std::string(OC_RSRVD_INTERFACE) + "=" + interfaceFilter;
+        separator = "&";
+    }
+    if (resourceTypeFilter)
+    {
+        query += separator + std::string(OC_RSRVD_RESOURCE_TYPE) + "=" + resourceTypeFilter;
+    }
+
+    EXPECT_EQ(FilterResourcesByWalk(interfaceFilter, resourceTypeFilter),
+              DiscoverResources(query.c_str())) << query;
+}
+
 //-----------------------------------------------------------------------------
 //  Tests
 //-----------------------------------------------------------------------------
@@ -1609,6 +1738,179 @@ TEST(StackResourceAccess, DeleteMiddleResource)
     EXPECT_EQ(OC_STACK_OK, OCStop());
 }
 
+TEST(StackResourceAccess, IndexedLookupAfterDelete)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OC_LOG(INFO, TAG, "Starting IndexedLookupAfterDelete test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle0;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle0,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led0",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+    OCResourceHandle handle1;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle1,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led1",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+
+    EXPECT_EQ((OCResource *)handle0, FindResourceByUri("/a/led0"));
+    EXPECT_EQ((OCResource *)handle1, FindResourceByUri("/a/led1"));
+    EXPECT_EQ((OCResource *)handle1, FindResourceByHandle(handle1));
+    EXPECT_EQ(NULL, FindResourceByUri("/a/led2"));
+
+    // A duplicate URI is rejected through the index
+    OCResourceHandle duplicate;
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCCreateResource(&duplicate,
+                                                       "core.led",
+                                                       "core.rw",
+                                                       "/a/led1",
+                                                       0,
+                                                       NULL,
+                                                       OC_DISCOVERABLE|OC_OBSERVABLE));
+
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle1));
+    EXPECT_EQ(NULL, FindResourceByUri("/a/led1"));
+    EXPECT_EQ(NULL, FindResourceByHandle(handle1));
+    EXPECT_EQ((OCResource *)handle0, FindResourceByHandle(handle0));
+
+    // The URI is free again once the resource is gone
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle1,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led1",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+    EXPECT_EQ((OCResource *)handle1, FindResourceByUri("/a/led1"));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+    EXPECT_EQ(NULL, FindResourceByUri("/a/led0"));
+}
+
+TEST(StackResourceAccess, ManyResourcesLookup)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OC_LOG(INFO, TAG, "Starting ManyResourcesLookup test");
+    InitStack(OC_SERVER);
+
+    const int count = 5000;
+    OCResourceHandle *handles = (OCResourceHandle *)OICCalloc(count, sizeof(OCResourceHandle));
+    ASSERT_TRUE(NULL != handles);
+
+    char uri[32];
+    for (int i = 0; i < count; i++)
+    {
+        snprintf(uri, sizeof(uri), "/a/light/%d", i);
+        ASSERT_EQ(OC_STACK_OK, OCCreateResource(&handles[i],
+                                                (i % 2) ? "core.light" : "core.fan",
+                                                "core.rw",
+                                                uri,
+                                                0,
+                                                NULL,
+                                                OC_DISCOVERABLE));
+    }
+
+    clock_t start = clock();
+    for (int i = 0; i < count; i++)
+    {
+        snprintf(uri, sizeof(uri), "/a/light/%d", i);
+        ASSERT_EQ((OCResource *)handles[i], FindResourceByUri(uri));
+        ASSERT_EQ((OCResource *)handles[i], FindResourceByHandle(handles[i]));
+    }
+    clock_t elapsed = clock() - start;
+    printf("[          ] %d resources, %.3f usec CPU per URI and handle lookup\n", count,
+           (double)elapsed * 1000000 / CLOCKS_PER_SEC / count);
+
+    for (int i = 0; i < count; i += 2)
+    {
+        EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handles[i]));
+    }
+    for (int i = 0; i < count; i++)
+    {
+        snprintf(uri, sizeof(uri), "/a/light/%d", i);
+        EXPECT_EQ((i % 2) ? (OCResource *)handles[i] : NULL, FindResourceByUri(uri));
+    }
+
+    OICFree(handles);
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackResourceAccess, FilteredDiscoveryMatchesWalk)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OC_LOG(INFO, TAG, "Starting FilteredDiscoveryMatchesWalk test");
+    InitStack(OC_CLIENT_SERVER);
+
+    const char *types[] = { "core.light", "core.fan", "core.light", "core.door",
+                            "core.fan", "core.light" };
+    const char *interfaces[] = { "core.rw", "core.r", "core.r", "core.rw", "core.rw",
+                                 "core.r" };
+    const int count = sizeof(types) / sizeof(types[0]);
+    OCResourceHandle handles[count];
+    char uri[32];
+    for (int i = 0; i < count; i++)
+    {
+        snprintf(uri, sizeof(uri), "/a/filtered/%d", i);
+        ASSERT_EQ(OC_STACK_OK, OCCreateResource(&handles[i],
+                                                types[i],
+                                                interfaces[i],
+                                                uri,
+                                                0,
+                                                NULL,
+                                                (i == 3) ? OC_OBSERVABLE :
+                                                           OC_DISCOVERABLE|OC_OBSERVABLE));
+    }
+    ASSERT_EQ(1u, FilterResourcesByWalk(NULL, "core.fan").count("/a/filtered/4"));
+
+    const char *typeFilters[] = { "core.light", "core.fan", "core.door", "core.bulb", NULL };
+    const char *interfaceFilters[] = { "core.rw", "core.r", OC_RSRVD_INTERFACE_DEFAULT,
+                                       "core.x", NULL };
+    const int numTypeFilters = sizeof(typeFilters) / sizeof(typeFilters[0]);
+    const int numInterfaceFilters = sizeof(interfaceFilters) / sizeof(interfaceFilters[0]);
+    for (int i = 0; i < numInterfaceFilters; i++)
+    {
+        for (int j = 0; j < numTypeFilters; j++)
+        {
+            ExpectFilteredDiscoveryMatchesWalk(interfaceFilters[i], typeFilters[j]);
+        }
+    }
+
+    // Types and interfaces bound after the resource was created
+    ASSERT_EQ(OC_STACK_OK, OCBindResourceTypeToResource(handles[1], "core.light"));
+    ASSERT_EQ(OC_STACK_OK, OCBindResourceTypeToResource(handles[2], "core.bulb"));
+    ASSERT_EQ(OC_STACK_OK, OCBindResourceInterfaceToResource(handles[0], "core.r"));
+    ASSERT_EQ(OC_STACK_OK, OCBindResourceInterfaceToResource(handles[5], "core.x"));
+    for (int i = 0; i < numInterfaceFilters; i++)
+    {
+        for (int j = 0; j < numTypeFilters; j++)
+        {
+            ExpectFilteredDiscoveryMatchesWalk(interfaceFilters[i], typeFilters[j]);
+        }
+    }
+
+    // Deleted resources, including the only one with the core.x interface
+    ASSERT_EQ(OC_STACK_OK, OCDeleteResource(handles[5]));
+    ASSERT_EQ(OC_STACK_OK, OCDeleteResource(handles[1]));
+    for (int i = 0; i < numInterfaceFilters; i++)
+    {
+        for (int j = 0; j < numTypeFilters; j++)
+        {
+            ExpectFilteredDiscoveryMatchesWalk(interfaceFilters[i], typeFilters[j]);
+        }
+    }
+    EXPECT_TRUE(DiscoverResources("/oic/res?if=core.x").empty());
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
 TEST(PODTests, OCHeaderOption)
 {
     EXPECT_TRUE(std::is_pod<OCHeaderOption>::value);
@@ -0,0 +1,113 @@
+//******************************************************************
+//
+// Copyright 2015 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef _CALLBACK_EXECUTOR_H_
+#define _CALLBACK_EXECUTOR_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <OCApi.h>
+
+namespace OC
+{
+    /**
+     * Runs the application callbacks of the client API as selected by
+     * PlatformConfig::callbackDispatch.
+     */
+    class CallbackExecutor
+    {
+    public:
+        typedef std::function<void()> Task;
+
+        /**
+         * @param dispatch  how tasks are run.
+         * @param threads   maximum number of worker threads for CallbackDispatch::ThreadPool.
+         *                  The workers are started as they are needed.
+         */
+        CallbackExecutor(CallbackDispatch dispatch, unsigned int threads);
+
+        /**
+         * Does not wait for the worker threads, it may run on the thread that processes
+         * the stack. The workers run the tasks that were already posted and then exit.
+         */
+        ~CallbackExecutor();
+
+        CallbackExecutor(const CallbackExecutor&) = delete;
+        CallbackExecutor& operator=(const CallbackExecutor&) = delete;
+
+        /**
+         * Runs task, on the calling thread for CallbackDispatch::Inline.
+         *
+         * @param task  the callback with its arguments bound.
+         * @param key   identifies the tasks that run in the order they are posted and never
+         *              at the same time, e.g. the notifications of one observation.
+         *              nullptr for a task that may run in parallel to any other.
+         *              CallbackDispatch::Thread ignores it.
+         */
+        void post(Task task, const void* key = nullptr);
+
+        CallbackDispatch dispatch() const
+        {
+            return m_dispatch;
+        }
+
+    private:
+        // tasks of one key, or a single task without one
+        struct Strand
+        {
+            const void* key;
+            std::deque<Task> tasks;
+        };
+
+        // shared with the workers, which may outlive the executor if a callback drops the
+        // last reference to it
+        struct State
+        {
+            State() : workers(0), idleWorkers(0), stop(false) {}
+
+            std::mutex mutex;
+            std::condition_variable cond;
+            // strands with tasks waiting for a worker, a running strand is not in here
+            std::deque<std::shared_ptr<Strand>> ready;
+            // strands with a key that are ready or running
+            std::unordered_map<const void*, std::shared_ptr<Strand>> strands;
+            unsigned int workers;
+            unsigned int idleWorkers;
+            bool stop;
+        };
+
+        // runs the first task of the first ready strand, with the lock held on entry and
+        // on return
+        static void runReady(State& state, std::unique_lock<std::mutex>& lock);
+        static void workerFunc(std::shared_ptr<State> state);
+
+        const CallbackDispatch m_dispatch;
+        const unsigned int m_maxThreads;
+        std::shared_ptr<State> m_state;
+    };
+}
+
+#endif
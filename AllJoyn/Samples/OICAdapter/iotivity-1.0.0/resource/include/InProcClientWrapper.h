@@ -28,6 +28,7 @@
 
 #include <OCApi.h>
 #include <IClientWrapper.h>
+#include <CallbackExecutor.h>
 #include <InitializeException.h>
 #include <ResourceInitException.h>
 
@@ -38,48 +39,62 @@ namespace OC
         struct GetContext
         {
             GetCallback callback;
-            GetContext(GetCallback cb) : callback(cb){}
+            std::shared_ptr<CallbackExecutor> executor;
+            GetContext(GetCallback cb, std::shared_ptr<CallbackExecutor> ex)
+                : callback(cb), executor(ex){}
         };
 
         struct SetContext
         {
             PutCallback callback;
-            SetContext(PutCallback cb) : callback(cb){}
+            std::shared_ptr<CallbackExecutor> executor;
+            SetContext(PutCallback cb, std::shared_ptr<CallbackExecutor> ex)
+                : callback(cb), executor(ex){}
         };
 
         struct ListenContext
         {
             FindCallback callback;
             std::weak_ptr<IClientWrapper> clientWrapper;
+            std::shared_ptr<CallbackExecutor> executor;
 
-            ListenContext(FindCallback cb, std::weak_ptr<IClientWrapper> cw)
-                : callback(cb), clientWrapper(cw){}
+            ListenContext(FindCallback cb, std::weak_ptr<IClientWrapper> cw,
+                          std::shared_ptr<CallbackExecutor> ex)
+                : callback(cb), clientWrapper(cw), executor(ex){}
         };
 
         struct DeviceListenContext
         {
             FindDeviceCallback callback;
             IClientWrapper::Ptr clientWrapper;
-            DeviceListenContext(FindDeviceCallback cb, IClientWrapper::Ptr cw)
-                    : callback(cb), clientWrapper(cw){}
+            std::shared_ptr<CallbackExecutor> executor;
+            DeviceListenContext(FindDeviceCallback cb, IClientWrapper::Ptr cw,
+                                std::shared_ptr<CallbackExecutor> ex)
+                    : callback(cb), clientWrapper(cw), executor(ex){}
         };
 
         struct SubscribePresenceContext
         {
             SubscribeCallback callback;
-            SubscribePresenceContext(SubscribeCallback cb) : callback(cb){}
+            std::shared_ptr<CallbackExecutor> executor;
+            SubscribePresenceContext(SubscribeCallback cb, std::shared_ptr<CallbackExecutor> ex)
+                : callback(cb), executor(ex){}
         };
 
         struct DeleteContext
         {
             DeleteCallback callback;
-            DeleteContext(DeleteCallback cb) : callback(cb){}
+            std::shared_ptr<CallbackExecutor> executor;
+            DeleteContext(DeleteCallback cb, std::shared_ptr<CallbackExecutor> ex)
+                : callback(cb), executor(ex){}
         };
 
         struct ObserveContext
         {
             ObserveCallback callback;
-            ObserveContext(ObserveCallback cb) : callback(cb){}
+            std::shared_ptr<CallbackExecutor> executor;
+            ObserveContext(ObserveCallback cb, std::shared_ptr<CallbackExecutor> ex)
+                : callback(cb), executor(ex){}
         };
     }
 
@@ -158,6 +173,7 @@ namespace OC
 
     private:
         PlatformConfig  m_cfg;
+        std::shared_ptr<CallbackExecutor> m_executor;
     };
 }
 
@@ -123,6 +123,31 @@ namespace OC
         NaQos       = OC_NA_QOS
     };
 
+    /**
+     * How the client API hands responses, discovered resources and notifications to the
+     * application callbacks.
+     */
+    enum class CallbackDispatch
+    {
+        /** A new thread for every callback. */
+        Thread,
+
+        /**
+         * A bounded pool of worker threads. Notifications of one observation are passed on
+         * one after another in the order they were received.
+         */
+        ThreadPool,
+
+        /**
+         * On the thread processing the stack. Lowest latency, but the callback must return
+         * quickly and must not wait for another callback.
+         */
+        Inline
+    };
+
+    /** Number of worker threads used for CallbackDispatch::ThreadPool by default. */
+    const unsigned int DEFAULT_CALLBACK_THREADS = 4;
+
     /**
      *  Data structure to provide the configuration.
      */
@@ -152,6 +177,12 @@ namespace OC
         /** persistant storage Handler structure (open/read/write/close/unlink). */
         OCPersistentStorage        *ps;
 
+        /** indicate how client callbacks are called : Thread, ThreadPool or Inline. */
+        CallbackDispatch           callbackDispatch;
+
+        /** maximum number of worker threads for CallbackDispatch::ThreadPool. */
+        unsigned int               callbackThreads;
+
         public:
             PlatformConfig()
                 : serviceType(ServiceType::InProc),
@@ -161,7 +192,9 @@ namespace OC
                 ipAddress("0.0.0.0"),
                 port(0),
                 QoS(QualityOfService::NaQos),
-                ps(nullptr)
+                ps(nullptr),
+                callbackDispatch(CallbackDispatch::ThreadPool),
+                callbackThreads(DEFAULT_CALLBACK_THREADS)
         {}
             PlatformConfig(const ServiceType serviceType_,
             const ModeType mode_,
@@ -176,7 +209,9 @@ namespace OC
                 ipAddress(""),
                 port(0),
                 QoS(QoS_),
-                ps(ps_)
+                ps(ps_),
+                callbackDispatch(CallbackDispatch::ThreadPool),
+                callbackThreads(DEFAULT_CALLBACK_THREADS)
         {}
             // for backward compatibility
             PlatformConfig(const ServiceType serviceType_,
@@ -192,7 +227,9 @@ namespace OC
                 ipAddress(ipAddress_),
                 port(port_),
                 QoS(QoS_),
-                ps(ps_)
+                ps(ps_),
+                callbackDispatch(CallbackDispatch::ThreadPool),
+                callbackThreads(DEFAULT_CALLBACK_THREADS)
         {}
     };
 
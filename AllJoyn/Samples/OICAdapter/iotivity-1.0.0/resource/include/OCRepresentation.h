@@ -246,6 +246,13 @@ namespace OC
                         return boost::get<T>(m_values[m_attrName]);
                     }
 
+                    // Moves the value out, leaving the attribute with a moved-from value.
+                    template<typename T>
+                    T moveValue()
+                    {
+                        return std::move(boost::get<T>(m_values[m_attrName]));
+                    }
+
                     std::string getValueToString() const;
 
                     template<typename T>
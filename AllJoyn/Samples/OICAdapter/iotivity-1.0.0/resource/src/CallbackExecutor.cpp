@@ -0,0 +1,160 @@
+//******************************************************************
+//
+// Copyright 2015 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "CallbackExecutor.h"
+
+#include <system_error>
+
+namespace OC
+{
+    CallbackExecutor::CallbackExecutor(CallbackDispatch dispatch, unsigned int threads)
+        : m_dispatch(dispatch), m_maxThreads(threads ? threads : 1),
+          m_state(std::make_shared<State>())
+    {
+    }
+
+    CallbackExecutor::~CallbackExecutor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            m_state->stop = true;
+        }
+        m_state->cond.notify_all();
+    }
+
+    void CallbackExecutor::post(Task task, const void* key)
+    {
+        if(m_dispatch == CallbackDispatch::Inline)
+        {
+            task();
+            return;
+        }
+
+        if(m_dispatch == CallbackDispatch::Thread)
+        {
+            try
+            {
+                std::thread exec(task);
+                exec.detach();
+            }
+            catch(const std::system_error&)
+            {
+                task();
+            }
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(m_state->mutex);
+
+        if(key)
+        {
+            auto it = m_state->strands.find(key);
+            if(it != m_state->strands.end())
+            {
+                // queued behind the tasks of the same key, which are ready or running
+                it->second->tasks.push_back(std::move(task));
+                return;
+            }
+        }
+
+        std::shared_ptr<Strand> strand = std::make_shared<Strand>();
+        strand->key = key;
+        strand->tasks.push_back(std::move(task));
+        if(key)
+        {
+            m_state->strands[key] = strand;
+        }
+        m_state->ready.push_back(strand);
+
+        if(m_state->idleWorkers != 0 || m_state->workers >= m_maxThreads)
+        {
+            lock.unlock();
+            m_state->cond.notify_one();
+            return;
+        }
+
+        ++m_state->workers;
+        lock.unlock();
+
+        try
+        {
+            std::thread worker(&CallbackExecutor::workerFunc, m_state);
+            worker.detach();
+        }
+        catch(const std::system_error&)
+        {
+            lock.lock();
+            if(--m_state->workers == 0)
+            {
+                // nobody else would run the tasks, so run them like CallbackDispatch::Inline
+                while(!m_state->ready.empty())
+                {
+                    runReady(*m_state, lock);
+                }
+            }
+        }
+    }
+
+    void CallbackExecutor::runReady(State& state, std::unique_lock<std::mutex>& lock)
+    {
+        std::shared_ptr<Strand> strand = state.ready.front();
+        state.ready.pop_front();
+        Task task = std::move(strand->tasks.front());
+        strand->tasks.pop_front();
+
+        lock.unlock();
+        task();
+        task = nullptr;
+        lock.lock();
+
+        if(!strand->tasks.empty())
+        {
+            // back of the queue, so that one busy observation cannot starve the others
+            state.ready.push_back(strand);
+        }
+        else if(strand->key)
+        {
+            state.strands.erase(strand->key);
+        }
+    }
+
+    void CallbackExecutor::workerFunc(std::shared_ptr<State> state)
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        while(true)
+        {
+            if(state->ready.empty())
+            {
+                if(state->stop)
+                {
+                    --state->workers;
+                    return;
+                }
+
+                ++state->idleWorkers;
+                state->cond.wait(lock);
+                --state->idleWorkers;
+                continue;
+            }
+
+            runReady(*state, lock);
+        }
+    }
+}
@@ -32,7 +32,9 @@ namespace OC
     InProcClientWrapper::InProcClientWrapper(
         std::weak_ptr<std::recursive_mutex> csdkLock, PlatformConfig cfg)
             : m_threadRun(false), m_csdkLock(csdkLock),
-              m_cfg { cfg }
+              m_cfg { cfg },
+              m_executor(std::make_shared<CallbackExecutor>(cfg.callbackDispatch,
+                                                            cfg.callbackThreads))
     {
         // if the config type is server, we ought to never get called.  If the config type
         // is both, we count on the server to run the thread and do the initialize
@@ -60,6 +62,7 @@ namespace OC
         if(m_threadRun && m_listeningThread.joinable())
         {
             m_threadRun = false;
+            OCSignalEvents();
             m_listeningThread.join();
         }
 
@@ -76,11 +79,12 @@ namespace OC
         while(m_threadRun)
         {
             OCStackResult result;
+            uint32_t timeout = UINT32_MAX;
             auto cLock = m_csdkLock.lock();
             if(cLock)
             {
                 std::lock_guard<std::recursive_mutex> lock(*cLock);
-                result = OCProcess();
+                result = OCProcessEvents(&timeout);
             }
             else
             {
@@ -92,8 +96,13 @@ namespace OC
                 // TODO: do something with result if failed?
             }
 
-            // To minimize CPU utilization we may wish to do this with sleep
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // Block until a response arrives or the stack has timed work to do.
+            // Builds that cannot wait for received data fall back to polling.
+            result = (OC_STACK_OK == result) ? OCWaitForEvents(timeout) : result;
+            if(OC_STACK_OK != result && OC_STACK_TIMEOUT != result)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
         }
     }
 
@@ -168,8 +177,7 @@ namespace OC
         // loop to ensure valid construction of all resources
         for(auto resource : container.Resources())
         {
-            std::thread exec(context->callback, resource);
-            exec.detach();
+            context->executor->post(std::bind(context->callback, resource));
         }
 
 
@@ -192,7 +200,7 @@ namespace OC
         resourceUri << serviceUrl << resourceType;
 
         ClientCallbackContext::ListenContext* context =
-            new ClientCallbackContext::ListenContext(callback, shared_from_this());
+            new ClientCallbackContext::ListenContext(callback, shared_from_this(), m_executor);
         OCCallbackData cbdata{
                 static_cast<void*>(context),
                 listenCallback,
@@ -228,8 +236,7 @@ namespace OC
         try
         {
             OCRepresentation rep = parseGetSetCallback(clientResponse);
-            std::thread exec(context->callback, rep);
-            exec.detach();
+            context->executor->post(std::bind(context->callback, rep));
         }
         catch(OC::OCException& e)
         {
@@ -256,7 +263,8 @@ namespace OC
         deviceUri << serviceUrl << deviceURI;
 
         ClientCallbackContext::DeviceListenContext* context =
-            new ClientCallbackContext::DeviceListenContext(callback, shared_from_this());
+            new ClientCallbackContext::DeviceListenContext(callback, shared_from_this(),
+                                                         m_executor);
         OCCallbackData cbdata{
                 static_cast<void*>(context),
                 listenDeviceCallback,
@@ -331,8 +339,7 @@ namespace OC
             }
         }
 
-        std::thread exec(context->callback, serverHeaderOptions, rep, result);
-        exec.detach();
+        context->executor->post(std::bind(context->callback, serverHeaderOptions, rep, result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -348,7 +355,7 @@ namespace OC
         }
         OCStackResult result;
         ClientCallbackContext::GetContext* ctx =
-            new ClientCallbackContext::GetContext(callback);
+            new ClientCallbackContext::GetContext(callback, m_executor);
         OCCallbackData cbdata{
                 static_cast<void*>(ctx),
                 getResourceCallback,
@@ -408,8 +415,7 @@ namespace OC
             }
         }
 
-        std::thread exec(context->callback, serverHeaderOptions, attrs, result);
-        exec.detach();
+        context->executor->post(std::bind(context->callback, serverHeaderOptions, attrs, result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -461,7 +467,8 @@ namespace OC
             return OC_STACK_INVALID_PARAM;
         }
         OCStackResult result;
-        ClientCallbackContext::SetContext* ctx = new ClientCallbackContext::SetContext(callback);
+        ClientCallbackContext::SetContext* ctx =
+            new ClientCallbackContext::SetContext(callback, m_executor);
         OCCallbackData cbdata{
                 static_cast<void*>(ctx),
                 setResourceCallback,
@@ -507,7 +514,8 @@ namespace OC
             return OC_STACK_INVALID_PARAM;
         }
         OCStackResult result;
-        ClientCallbackContext::SetContext* ctx = new ClientCallbackContext::SetContext(callback);
+        ClientCallbackContext::SetContext* ctx =
+            new ClientCallbackContext::SetContext(callback, m_executor);
         OCCallbackData cbdata{
                 static_cast<void*>(ctx),
                 setResourceCallback,
@@ -554,8 +562,8 @@ namespace OC
         {
             parseServerHeaderOptions(clientResponse, serverHeaderOptions);
         }
-        std::thread exec(context->callback, serverHeaderOptions, clientResponse->result);
-        exec.detach();
+        context->executor->post(std::bind(context->callback, serverHeaderOptions,
+                                          clientResponse->result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -572,7 +580,7 @@ namespace OC
         }
         OCStackResult result;
         ClientCallbackContext::DeleteContext* ctx =
-            new ClientCallbackContext::DeleteContext(callback);
+            new ClientCallbackContext::DeleteContext(callback, m_executor);
         OCCallbackData cbdata{
                 static_cast<void*>(ctx),
                 deleteResourceCallback,
@@ -627,9 +635,9 @@ namespace OC
                 result = e.code();
             }
         }
-        std::thread exec(context->callback, serverHeaderOptions, attrs,
-                    result, sequenceNumber);
-        exec.detach();
+        // the notifications of one observation reach the application in order
+        context->executor->post(std::bind(context->callback, serverHeaderOptions, attrs,
+                                          result, sequenceNumber), context);
         if(sequenceNumber == OC_OBSERVE_DEREGISTER)
         {
             return OC_STACK_DELETE_TRANSACTION;
@@ -650,7 +658,7 @@ namespace OC
         OCStackResult result;
 
         ClientCallbackContext::ObserveContext* ctx =
-            new ClientCallbackContext::ObserveContext(callback);
+            new ClientCallbackContext::ObserveContext(callback, m_executor);
         OCCallbackData cbdata{
                 static_cast<void*>(ctx),
                 observeResourceCallback,
@@ -738,10 +746,8 @@ namespace OC
          */
         std::string url = clientResponse->devAddr.addr;
 
-        std::thread exec(context->callback, clientResponse->result,
-                    clientResponse->sequenceNumber, url);
-
-        exec.detach();
+        context->executor->post(std::bind(context->callback, clientResponse->result,
+                                          clientResponse->sequenceNumber, url), context);
 
         return OC_STACK_KEEP_TRANSACTION;
     }
@@ -756,7 +762,7 @@ namespace OC
         }
 
         ClientCallbackContext::SubscribePresenceContext* ctx =
-            new ClientCallbackContext::SubscribePresenceContext(presenceHandler);
+            new ClientCallbackContext::SubscribePresenceContext(presenceHandler, m_executor);
         OCCallbackData cbdata{
                 static_cast<void*>(ctx),
                 subscribePresenceCallback,
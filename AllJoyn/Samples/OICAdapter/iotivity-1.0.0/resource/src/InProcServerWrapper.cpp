@@ -294,10 +294,11 @@ namespace OC
         while(cLock && m_threadRun)
         {
             OCStackResult result;
+            uint32_t timeout = UINT32_MAX;
 
             {
                 std::lock_guard<std::recursive_mutex> lock(*cLock);
-                result = OCProcess();
+                result = OCProcessEvents(&timeout);
             }
 
             if(OC_STACK_ERROR == result)
@@ -306,7 +307,12 @@ namespace OC
                 // ...the value of variable result is simply ignored for now.
             }
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // block until there is something to process, unless the stack has to be polled
+            result = OCWaitForEvents(timeout);
+            if(OC_STACK_OK != result && OC_STACK_TIMEOUT != result)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
         }
     }
 
@@ -600,6 +606,7 @@ namespace OC
         if(m_processThread.joinable())
         {
             m_threadRun = false;
+            OCSignalEvents();
             m_processThread.join();
         }
 
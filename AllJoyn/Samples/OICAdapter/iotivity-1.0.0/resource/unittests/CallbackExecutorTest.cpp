@@ -0,0 +1,211 @@
+//******************************************************************
+//
+// Copyright 2015 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <CallbackExecutor.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+
+namespace CallbackExecutorTest
+{
+    using namespace OC;
+    using std::chrono::steady_clock;
+
+    // number of callbacks running at the same time, and the most there were
+    class Concurrency
+    {
+    public:
+        Concurrency() : m_running(0), m_peak(0) {}
+
+        void enter()
+        {
+            int running = ++m_running;
+            int peak = m_peak;
+            while(running > peak && !m_peak.compare_exchange_weak(peak, running))
+            {
+            }
+        }
+
+        void leave()
+        {
+            --m_running;
+        }
+
+        int peak() const
+        {
+            return m_peak;
+        }
+
+    private:
+        std::atomic<int> m_running;
+        std::atomic<int> m_peak;
+    };
+
+    TEST(CallbackExecutorTest, InlineRunsOnCallingThread)
+    {
+        CallbackExecutor executor(CallbackDispatch::Inline, DEFAULT_CALLBACK_THREADS);
+        std::thread::id id;
+
+        executor.post([&id]() { id = std::this_thread::get_id(); });
+        EXPECT_EQ(std::this_thread::get_id(), id);
+    }
+
+    // the executor does not wait for its workers when it goes away
+    static void waitFor(const std::atomic<int>& done, int expected)
+    {
+        while(done < expected)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    TEST(CallbackExecutorTest, ThreadPoolBoundsThreads)
+    {
+        Concurrency concurrency;
+        std::atomic<int> done(0);
+        {
+            CallbackExecutor executor(CallbackDispatch::ThreadPool, 3);
+            for(int i = 0; i < 50; i++)
+            {
+                executor.post([&]()
+                {
+                    concurrency.enter();
+                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                    concurrency.leave();
+                    ++done;
+                });
+            }
+        }
+
+        // the workers run what was posted before the executor went away
+        waitFor(done, 50);
+        EXPECT_GE(3, concurrency.peak());
+        EXPECT_LT(1, concurrency.peak());
+    }
+
+    TEST(CallbackExecutorTest, ThreadPoolKeepsOrderOfKey)
+    {
+        const int keys = 4;
+        const int notifications = 500;
+        std::vector<int> received[keys];
+        Concurrency concurrency[keys];
+        std::atomic<int> done(0);
+        {
+            CallbackExecutor executor(CallbackDispatch::ThreadPool, DEFAULT_CALLBACK_THREADS);
+            for(int i = 0; i < notifications; i++)
+            {
+                for(int k = 0; k < keys; k++)
+                {
+                    executor.post([&, i, k]()
+                    {
+                        concurrency[k].enter();
+                        received[k].push_back(i);
+                        concurrency[k].leave();
+                        ++done;
+                    }, &received[k]);
+                }
+            }
+        }
+        waitFor(done, keys * notifications);
+
+        for(int k = 0; k < keys; k++)
+        {
+            ASSERT_EQ(static_cast<size_t>(notifications), received[k].size());
+            EXPECT_TRUE(std::is_sorted(received[k].begin(), received[k].end()));
+            EXPECT_EQ(1, concurrency[k].peak());
+        }
+    }
+
+    TEST(CallbackExecutorTest, CallbackMayDropLastReference)
+    {
+        std::shared_ptr<CallbackExecutor> executor =
+            std::make_shared<CallbackExecutor>(CallbackDispatch::ThreadPool, 1);
+        std::weak_ptr<CallbackExecutor> observer = executor;
+        std::atomic<bool> done(false);
+
+        // like a callback that cancels its observation, which deletes the context
+        std::shared_ptr<CallbackExecutor>* context =
+            new std::shared_ptr<CallbackExecutor>(executor);
+        executor->post([context, &done]()
+        {
+            delete context;
+            done = true;
+        });
+        executor.reset();
+
+        while(!done || !observer.expired())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    // Hands 1000 discovered resources to callbacks that take about as long as printing
+    // the resource does, as in the examples.
+    static void benchmarkDiscovery(const char* name, CallbackDispatch dispatch)
+    {
+        const int resources = 1000;
+        Concurrency concurrency;
+        std::atomic<int> done(0);
+        std::atomic<long long> totalLatency(0);
+        std::atomic<long long> maxLatency(0);
+
+        steady_clock::time_point start = steady_clock::now();
+        {
+            CallbackExecutor executor(dispatch, DEFAULT_CALLBACK_THREADS);
+            for(int i = 0; i < resources; i++)
+            {
+                steady_clock::time_point posted = steady_clock::now();
+                executor.post([&, posted]()
+                {
+                    long long latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                                            steady_clock::now() - posted).count();
+                    totalLatency += latency;
+                    long long max = maxLatency;
+                    while(latency > max && !maxLatency.compare_exchange_weak(max, latency))
+                    {
+                    }
+
+                    concurrency.enter();
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                    concurrency.leave();
+                    ++done;
+                });
+            }
+        }
+
+        waitFor(done, resources);
+        long long total = std::chrono::duration_cast<std::chrono::milliseconds>(
+                              steady_clock::now() - start).count();
+
+        printf("[          ] %s: %d peak callback threads, %lld usec mean / %lld usec max "
+               "latency, %lld msec for all\n", name, concurrency.peak(),
+               totalLatency / resources, static_cast<long long>(maxLatency), total);
+    }
+
+    TEST(CallbackExecutorTest, BenchmarkDiscovery)
+    {
+        benchmarkDiscovery("Thread", CallbackDispatch::Thread);
+        benchmarkDiscovery("ThreadPool", CallbackDispatch::ThreadPool);
+        benchmarkDiscovery("Inline", CallbackDispatch::Inline);
+    }
+}
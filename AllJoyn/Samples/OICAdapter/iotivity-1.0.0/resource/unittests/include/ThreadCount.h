@@ -0,0 +1,53 @@
+//******************************************************************
+//
+// Copyright 2015 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * Helpers shared by the unit tests that check how many threads a component starts.
+ */
+
+#ifndef THREAD_COUNT_H_
+#define THREAD_COUNT_H_
+
+#include <fstream>
+#include <string>
+
+/**
+ * Gets the number of threads in this process.
+ *
+ * @return The number of threads, or 0 when /proc is not available.
+ */
+inline int getProcessThreadCount()
+{
+    std::ifstream status{ "/proc/self/status" };
+    std::string line;
+
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, 8, "Threads:") == 0)
+        {
+            return std::stoi(line.substr(8));
+        }
+    }
+    return 0;
+}
+
+#endif // THREAD_COUNT_H_
@@ -45,6 +45,17 @@ OCStackResult OCRDStart();
 */
 OCStackResult OCRDStop();
 
+/**
+ * Keeps the published resources in a sqlite database, and loads those stored there before
+ * that have not expired.  It should be called before OCRDStart().
+ *
+ * @param path Path of the database file, which is created if it does not exist.
+ *
+ * @return ::OC_STACK_OK upon success, ::OC_STACK_NOTIMPL if the resource directory is built
+ * without RD_DATABASE, ::OC_STACK_ERROR in case of error.
+ */
+OCStackResult OCRDOpenDatabase(const char *path);
+
 /**
  * Checks based on the resource type if the entity exists in the resource directory.
  *
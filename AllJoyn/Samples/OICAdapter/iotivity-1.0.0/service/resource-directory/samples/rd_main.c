@@ -29,9 +29,10 @@ void handleSigInt(int signum);
 /*
 * This method is an entry point of Resource Directory.
 * This function should be run only on the device that it could be host device.
+* The published resources are kept in the database given as argument, if any.
 */
 
-int main()
+int main(int argc, char *argv[])
 {
     printf("OCResourceDirectory is starting...\n");
     OCStackResult result = OCInit(NULL, 0, OC_CLIENT_SERVER);
@@ -40,6 +41,11 @@ int main()
         printf("Failed starting RD server ...\n");
         return 0;
     }
+    if (argc > 1 && OCRDOpenDatabase(argv[1]) != OC_STACK_OK)
+    {
+        printf("Failed opening database %s...\n", argv[1]);
+        return 0;
+    }
     if (OCRDStart() != OC_STACK_OK)
     {
         printf("OCRDStart failed...\n");
@@ -0,0 +1,142 @@
+//******************************************************************
+//
+// Copyright 2015 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+#include "rd_server.h"
+#include "rd_storage.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "rdpayload.h"
+#include "oic_malloc.h"
+#include "oic_string.h"
+
+/*
+* This program publishes 10000 links to the storage of the Resource Directory, the way the
+* publish requests of 1000 devices would, and measures how long looking them up takes.
+* With a database path as argument the resources are stored in that database as well.
+*/
+
+#define BENCH_DEVICES 1000
+#define BENCH_LINKS_PER_DEVICE 10
+#define BENCH_RESOURCE_TYPES 500
+#define BENCH_LOOKUPS 100000
+
+static double elapsedUsec(const struct timespec *start)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) * 1000000.0 + (end.tv_nsec - start->tv_nsec) / 1000.0;
+}
+
+static OCResourceCollectionPayload *createPublishPayload(int device)
+{
+    char id[MAX_IDENTITY_SIZE];
+    snprintf(id, sizeof(id), "bench-device-%d", device);
+    OCTagsPayload *tags = OCCopyTagsResources("bench", (unsigned char *)id, NULL, 0, 0, 0,
+                                              NULL, NULL, 3600);
+    if (!tags)
+    {
+        return NULL;
+    }
+
+    OCLinksPayload *links = NULL;
+    OCLinksPayload **tail = &links;
+    for (int i = 0; i < BENCH_LINKS_PER_DEVICE; i++)
+    {
+        char href[32];
+        char rtValue[32];
+        snprintf(href, sizeof(href), "/a/bench/%d", i);
+        snprintf(rtValue, sizeof(rtValue), "oic.r.bench.%d",
+                 (device * BENCH_LINKS_PER_DEVICE + i) % BENCH_RESOURCE_TYPES);
+        OCStringLL rt = { NULL, rtValue };
+        OCStringLL itf = { NULL, (char *)OC_RSRVD_INTERFACE_DEFAULT };
+
+        *tail = OCCopyLinksResources(href, &rt, &itf, NULL, false, NULL, href, 0, NULL);
+        if (!*tail)
+        {
+            break;
+        }
+        tail = &(*tail)->next;
+    }
+
+    OCResourceCollectionPayload *payload = OCCopyCollectionResource(tags, links);
+    if (!payload)
+    {
+        OCFreeTagsResource(tags);
+        OCFreeLinksResource(links);
+    }
+    return payload;
+}
+
+static void benchmarkLookup(const char *name, const char *interfaceType, int resourceTypes)
+{
+    char rtValue[32];
+    struct timespec start;
+    int found = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCH_LOOKUPS; i++)
+    {
+        snprintf(rtValue, sizeof(rtValue), "oic.r.bench.%d", (i * 7919) % resourceTypes);
+        OCResourceCollectionPayload *payload = NULL;
+        if (OCRDCheckPublishedResource(interfaceType, rtValue, &payload) == OC_STACK_OK)
+        {
+            found++;
+            OCFreeCollectionResource(payload);
+        }
+    }
+    printf("%s: %.3f usec per lookup, %d of %d found\n", name,
+           elapsedUsec(&start) / BENCH_LOOKUPS, found, BENCH_LOOKUPS);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && OCRDOpenDatabase(argv[1]) != OC_STACK_OK)
+    {
+        printf("Failed opening database %s\n", argv[1]);
+        return 1;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int device = 0; device < BENCH_DEVICES; device++)
+    {
+        OCResourceCollectionPayload *payload = createPublishPayload(device);
+        if (!payload || OCRDStorePublishedResources(payload) != OC_STACK_OK)
+        {
+            printf("Failed publishing resources of device %d\n", device);
+            OCFreeCollectionResource(payload);
+            OCRDStorageClose();
+            return 1;
+        }
+        OCFreeCollectionResource(payload);
+    }
+    printf("Published %d links: %.3f usec per publish request\n",
+           BENCH_DEVICES * BENCH_LINKS_PER_DEVICE, elapsedUsec(&start) / BENCH_DEVICES);
+
+    benchmarkLookup("Resource type", NULL, BENCH_RESOURCE_TYPES);
+    benchmarkLookup("Resource type, half missing", NULL, 2 * BENCH_RESOURCE_TYPES);
+    benchmarkLookup("Resource type or interface", OC_RSRVD_INTERFACE_DEFAULT,
+                    BENCH_RESOURCE_TYPES);
+
+    OCRDStorageClose();
+    return 0;
+}
@@ -21,17 +21,520 @@
 
 #include <pthread.h>
 #include <string.h>
+#include <time.h>
 
 #include "payload_logging.h"
 #include "oic_malloc.h"
+#include "oic_string.h"
+#include "oic_hash.h"
 
 #include "rdpayload.h"
+#include "rd_server.h"
+
+#ifdef RD_DATABASE
+#include "sqlite3.h"
+#endif
 
 #define TAG  PCF("RDStorage")
 
-pthread_mutex_t storageMutex = PTHREAD_MUTEX_INITIALIZER;
-// This variable holds the published resources on the RD.
+/** Number of entries of the TTL heap when the first expiring resources are stored. */
+#define RD_HEAP_INITIAL_SIZE 16
+
+/** Entry of a link, or for the di index of published resources, under one key. */
+typedef struct OCRDIndexRef
+{
+    /** Key the entry is listed under. */
+    struct OCRDIndexKey *key;
+    /** Published resources the entry belongs to. */
+    OCRDStorePublishResources *resource;
+    /** The link, NULL in the di index. */
+    OCLinksPayload *link;
+    /** Order the link was published in, a lookup returns the lowest. */
+    uint64_t seq;
+    /** Previous entry under the same key. */
+    struct OCRDIndexRef *prev;
+    /** Next entry under the same key, published later. */
+    struct OCRDIndexRef *next;
+    /** Next entry of the same published resources. */
+    struct OCRDIndexRef *nextOfResource;
+} OCRDIndexRef;
+
+/** Key of an index with the entries listed under it. */
+typedef struct OCRDIndexKey
+{
+    char *value;
+    /** Index the key is in. */
+    OICHashTable_t *index;
+    OCRDIndexRef *first;
+    OCRDIndexRef *last;
+    /** Link in the index. */
+    OICHashLink_t link;
+} OCRDIndexKey;
+
+static pthread_mutex_t storageMutex = PTHREAD_MUTEX_INITIALIZER;
+// This variable holds the published resources on the RD, in the order they were published.
 static OCRDStorePublishResources *g_rdStorage = NULL;
+static OCRDStorePublishResources *g_rdStorageTail = NULL;
+
+// Links by their resource types and interface types, published resources by device id.
+static OICHashTable_t g_rtIndex;
+static OICHashTable_t g_itfIndex;
+static OICHashTable_t g_diIndex;
+static uint64_t g_linkSeq = 0;
+
+// Min-heap of the published resources that expire, by expiry.
+static OCRDStorePublishResources **g_ttlHeap = NULL;
+static size_t g_ttlHeapCount = 0;
+static size_t g_ttlHeapSize = 0;
+
+#ifdef RD_DATABASE
+
+#define RD_DB_CREATE_TABLE "CREATE TABLE IF NOT EXISTS RD_PUBLISHED(ID INTEGER PRIMARY KEY \
+                            AUTOINCREMENT, DI TEXT NOT NULL, EXPIRY INTEGER NOT NULL, \
+                            PAYLOAD BLOB NOT NULL);"
+#define RD_DB_TRANSACTION_BEGIN "BEGIN TRANSACTION;"
+#define RD_DB_TRANSACTION_COMMIT "COMMIT;"
+#define RD_DB_INSERT "INSERT INTO RD_PUBLISHED (DI, EXPIRY, PAYLOAD) VALUES(?,?,?)"
+#define RD_DB_UPDATE "UPDATE RD_PUBLISHED SET PAYLOAD = ? WHERE ID = ?"
+#define RD_DB_DELETE "DELETE FROM RD_PUBLISHED WHERE ID = ?"
+#define RD_DB_DELETE_EXPIRED "DELETE FROM RD_PUBLISHED WHERE EXPIRY != 0 AND EXPIRY <= ?"
+#define RD_DB_SELECT_ALL "SELECT ID, EXPIRY, PAYLOAD FROM RD_PUBLISHED ORDER BY ID"
+
+/** Size of the first buffer a publication is encoded into, doubled until it fits. */
+#define RD_DB_INITIAL_PAYLOAD_SIZE 1024
+#define RD_DB_MAX_PAYLOAD_SIZE (64 * 1024)
+
+#define RD_BIND_INDEX_FIRST 1
+#define RD_BIND_INDEX_SECOND 2
+#define RD_BIND_INDEX_THIRD 3
+
+/**
+ * Macro to verify sqlite success.
+ */
+#define RD_VERIFY_SQLITE_OK(arg, retValue) do{ if (SQLITE_OK != (arg)) \
+            { OC_LOG_V(ERROR, TAG, "Error in " #arg ", Error Message: %s", \
+               sqlite3_errmsg(g_db)); return retValue; }}while(0)
+
+static sqlite3 *g_db = NULL;
+// Statements used for each publication and expiry, prepared when the database is opened.
+static sqlite3_stmt *g_insertStmt = NULL;
+static sqlite3_stmt *g_updateStmt = NULL;
+static sqlite3_stmt *g_deleteStmt = NULL;
+
+static void dbBegin()
+{
+    if (g_db && SQLITE_OK != sqlite3_exec(g_db, RD_DB_TRANSACTION_BEGIN, NULL, NULL, NULL))
+    {
+        OC_LOG_V(ERROR, TAG, "Failed beginning transaction: %s", sqlite3_errmsg(g_db));
+    }
+}
+
+static void dbCommit()
+{
+    if (g_db && SQLITE_OK != sqlite3_exec(g_db, RD_DB_TRANSACTION_COMMIT, NULL, NULL, NULL))
+    {
+        OC_LOG_V(ERROR, TAG, "Failed committing transaction: %s", sqlite3_errmsg(g_db));
+    }
+}
+
+/**
+ * Converts the resources to the CBOR of the publish payload.
+ *
+ * @return the CBOR, to be freed by the caller, NULL if the resources could not be converted.
+ */
+static uint8_t *dbEncode(const OCResourceCollectionPayload *collection, size_t *encodedSize)
+{
+    OCRDPayload rdPayload;
+    memset(&rdPayload, 0, sizeof(rdPayload));
+    rdPayload.base.type = PAYLOAD_TYPE_RD;
+    rdPayload.rdPublish = (OCResourceCollectionPayload *)collection;
+
+    // OCRDPayloadToCbor does not report the size it needs, so this retries with larger buffers
+    uint8_t *data = NULL;
+    size_t size = 0;
+    for (size_t bufferSize = RD_DB_INITIAL_PAYLOAD_SIZE;
+         !size && bufferSize <= RD_DB_MAX_PAYLOAD_SIZE; bufferSize *= 2)
+    {
+        OICFree(data);
+        data = (uint8_t *)OICMalloc(bufferSize);
+        if (!data)
+        {
+            break;
+        }
+        size = bufferSize;
+        if (OC_STACK_OK != OCRDPayloadToCbor(&rdPayload, data, &size))
+        {
+            size = 0;
+        }
+    }
+    if (!size)
+    {
+        OC_LOG(ERROR, TAG, "Failed converting resources for the database.");
+        OICFree(data);
+        return NULL;
+    }
+    *encodedSize = size;
+    return data;
+}
+
+/**
+ * Stores the resources in the database as the CBOR of the publish payload.
+ *
+ * @return the row of the resources, 0 if they could not be stored.
+ */
+static int64_t dbInsert(const OCResourceCollectionPayload *collection)
+{
+    if (!g_db)
+    {
+        return 0;
+    }
+
+    size_t size = 0;
+    uint8_t *data = dbEncode(collection, &size);
+    if (!data)
+    {
+        return 0;
+    }
+
+    // the database outlives the monotonic clock, so it keeps the wall clock time
+    uint32_t ttl = collection->tags->ttl;
+    sqlite3_int64 expiry = ttl ? (sqlite3_int64)time(NULL) + ttl : 0;
+
+    int64_t rowId = 0;
+    sqlite3_reset(g_insertStmt);
+    sqlite3_clear_bindings(g_insertStmt);
+    if (SQLITE_OK == sqlite3_bind_text(g_insertStmt, RD_BIND_INDEX_FIRST,
+                (const char *)collection->tags->di.id, -1, SQLITE_STATIC) &&
+        SQLITE_OK == sqlite3_bind_int64(g_insertStmt, RD_BIND_INDEX_SECOND, expiry) &&
+        SQLITE_OK == sqlite3_bind_blob(g_insertStmt, RD_BIND_INDEX_THIRD, data, (int)size,
+                SQLITE_STATIC) &&
+        SQLITE_DONE == sqlite3_step(g_insertStmt))
+    {
+        rowId = sqlite3_last_insert_rowid(g_db);
+    }
+    else
+    {
+        OC_LOG_V(ERROR, TAG, "Failed storing resources: %s", sqlite3_errmsg(g_db));
+    }
+    sqlite3_reset(g_insertStmt);
+    OICFree(data);
+    return rowId;
+}
+
+/**
+ * Replaces the stored resources, after some of their links were removed. The expiry stays.
+ */
+static void dbUpdate(const OCRDStorePublishResources *resource)
+{
+    if (!g_db || !resource->rowId)
+    {
+        return;
+    }
+
+    size_t size = 0;
+    uint8_t *data = dbEncode(resource->publishedResource, &size);
+    if (!data)
+    {
+        return;
+    }
+
+    sqlite3_reset(g_updateStmt);
+    if (SQLITE_OK != sqlite3_bind_blob(g_updateStmt, RD_BIND_INDEX_FIRST, data, (int)size,
+                SQLITE_STATIC) ||
+        SQLITE_OK != sqlite3_bind_int64(g_updateStmt, RD_BIND_INDEX_SECOND, resource->rowId) ||
+        SQLITE_DONE != sqlite3_step(g_updateStmt))
+    {
+        OC_LOG_V(ERROR, TAG, "Failed updating resources: %s", sqlite3_errmsg(g_db));
+    }
+    sqlite3_reset(g_updateStmt);
+    OICFree(data);
+}
+
+static void dbDelete(int64_t rowId)
+{
+    if (!g_db || !rowId)
+    {
+        return;
+    }
+
+    sqlite3_reset(g_deleteStmt);
+    if (SQLITE_OK != sqlite3_bind_int64(g_deleteStmt, RD_BIND_INDEX_FIRST, rowId) ||
+        SQLITE_DONE != sqlite3_step(g_deleteStmt))
+    {
+        OC_LOG_V(ERROR, TAG, "Failed deleting resources: %s", sqlite3_errmsg(g_db));
+    }
+    sqlite3_reset(g_deleteStmt);
+}
+
+static void dbClose()
+{
+    sqlite3_finalize(g_insertStmt);
+    sqlite3_finalize(g_updateStmt);
+    sqlite3_finalize(g_deleteStmt);
+    sqlite3_close(g_db);
+    g_insertStmt = NULL;
+    g_updateStmt = NULL;
+    g_deleteStmt = NULL;
+    g_db = NULL;
+}
+
+#else
+
+static void dbBegin()
+{
+}
+
+static void dbCommit()
+{
+}
+
+static int64_t dbInsert(const OCResourceCollectionPayload *collection)
+{
+    (void)collection;
+    return 0;
+}
+
+static void dbUpdate(const OCRDStorePublishResources *resource)
+{
+    (void)resource;
+}
+
+static void dbDelete(int64_t rowId)
+{
+    (void)rowId;
+}
+
+static void dbClose()
+{
+}
+
+#endif // RD_DATABASE
+
+static uint64_t getCurrentTimeMs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
+
+static OCRDIndexKey *indexFindKey(const OICHashTable_t *index, const char *value, uint32_t hash)
+{
+    for (OICHashLink_t *link = OICHashTableFind(index, hash); link;
+         link = OICHashTableFindNext(link))
+    {
+        OCRDIndexKey *key = OIC_HASH_ENTRY(link, OCRDIndexKey, link);
+        if (strcmp(key->value, value) == 0)
+        {
+            return key;
+        }
+    }
+    return NULL;
+}
+
+static void indexRemoveKey(OCRDIndexKey *key)
+{
+    OICHashTableRemove(key->index, &key->link);
+    OICFree(key->value);
+    OICFree(key);
+}
+
+/**
+ * Lists the resources, or one of their links, under the value.
+ */
+static bool indexAdd(OICHashTable_t *index, const char *value, OCRDStorePublishResources *resource,
+        OCLinksPayload *link, uint64_t seq)
+{
+    uint32_t hash = OICHashString(value);
+    OCRDIndexKey *key = indexFindKey(index, value, hash);
+    if (!key)
+    {
+        key = (OCRDIndexKey *)OICCalloc(1, sizeof(OCRDIndexKey));
+        if (!key)
+        {
+            return false;
+        }
+        key->value = OICStrdup(value);
+        if (!key->value || !OICHashTableInsert(index, &key->link, hash))
+        {
+            OICFree(key->value);
+            OICFree(key);
+            return false;
+        }
+        key->index = index;
+    }
+
+    OCRDIndexRef *ref = (OCRDIndexRef *)OICCalloc(1, sizeof(OCRDIndexRef));
+    if (!ref)
+    {
+        if (!key->first)
+        {
+            indexRemoveKey(key);
+        }
+        return false;
+    }
+    ref->key = key;
+    ref->resource = resource;
+    ref->link = link;
+    ref->seq = seq;
+    ref->prev = key->last;
+    if (key->last)
+    {
+        key->last->next = ref;
+    }
+    else
+    {
+        key->first = ref;
+    }
+    key->last = ref;
+    ref->nextOfResource = resource->refs;
+    resource->refs = ref;
+    return true;
+}
+
+/**
+ * Removes the entry from the entries of its key, and the key if it was the last one.
+ */
+static void indexUnlinkRef(OCRDIndexRef *ref)
+{
+    OCRDIndexKey *key = ref->key;
+    if (ref->prev)
+    {
+        ref->prev->next = ref->next;
+    }
+    else
+    {
+        key->first = ref->next;
+    }
+    if (ref->next)
+    {
+        ref->next->prev = ref->prev;
+    }
+    else
+    {
+        key->last = ref->prev;
+    }
+    if (!key->first)
+    {
+        indexRemoveKey(key);
+    }
+    OICFree(ref);
+}
+
+static void indexRemoveRefs(OCRDStorePublishResources *resource)
+{
+    OCRDIndexRef *ref = resource->refs;
+    while (ref)
+    {
+        OCRDIndexRef *next = ref->nextOfResource;
+        indexUnlinkRef(ref);
+        ref = next;
+    }
+    resource->refs = NULL;
+}
+
+static void indexRemoveLinkRefs(OCRDStorePublishResources *resource, const OCLinksPayload *link)
+{
+    OCRDIndexRef **prev = &resource->refs;
+    while (*prev)
+    {
+        OCRDIndexRef *ref = *prev;
+        if (ref->link == link)
+        {
+            *prev = ref->nextOfResource;
+            indexUnlinkRef(ref);
+        }
+        else
+        {
+            prev = &ref->nextOfResource;
+        }
+    }
+}
+
+static OCRDIndexRef *indexFirst(const OICHashTable_t *index, const char *value)
+{
+    OCRDIndexKey *key = indexFindKey(index, value, OICHashString(value));
+    return key ? key->first : NULL;
+}
+
+static void heapSet(size_t i, OCRDStorePublishResources *resource)
+{
+    g_ttlHeap[i] = resource;
+    resource->heapIndex = i;
+}
+
+static void heapUp(size_t i)
+{
+    OCRDStorePublishResources *resource = g_ttlHeap[i];
+    while (i > 0)
+    {
+        size_t parent = (i - 1) / 2;
+        if (g_ttlHeap[parent]->expiry <= resource->expiry)
+        {
+            break;
+        }
+        heapSet(i, g_ttlHeap[parent]);
+        i = parent;
+    }
+    heapSet(i, resource);
+}
+
+static void heapDown(size_t i)
+{
+    OCRDStorePublishResources *resource = g_ttlHeap[i];
+    while (true)
+    {
+        size_t child = 2 * i + 1;
+        if (child >= g_ttlHeapCount)
+        {
+            break;
+        }
+        if (child + 1 < g_ttlHeapCount &&
+            g_ttlHeap[child + 1]->expiry < g_ttlHeap[child]->expiry)
+        {
+            child++;
+        }
+        if (resource->expiry <= g_ttlHeap[child]->expiry)
+        {
+            break;
+        }
+        heapSet(i, g_ttlHeap[child]);
+        i = child;
+    }
+    heapSet(i, resource);
+}
+
+static bool heapPush(OCRDStorePublishResources *resource)
+{
+    if (g_ttlHeapCount == g_ttlHeapSize)
+    {
+        size_t size = g_ttlHeapSize ? g_ttlHeapSize * 2 : RD_HEAP_INITIAL_SIZE;
+        OCRDStorePublishResources **heap = (OCRDStorePublishResources **)OICRealloc(g_ttlHeap,
+                size * sizeof(OCRDStorePublishResources *));
+        if (!heap)
+        {
+            return false;
+        }
+        g_ttlHeap = heap;
+        g_ttlHeapSize = size;
+    }
+    g_ttlHeap[g_ttlHeapCount] = resource;
+    heapUp(g_ttlHeapCount++);
+    return true;
+}
+
+static void heapRemove(OCRDStorePublishResources *resource)
+{
+    size_t i = resource->heapIndex;
+    resource->heapIndex = RD_NOT_IN_HEAP;
+    if (--g_ttlHeapCount == i)
+    {
+        return;
+    }
+    OCRDStorePublishResources *moved = g_ttlHeap[g_ttlHeapCount];
+    heapSet(i, moved);
+    heapUp(i);
+    heapDown(moved->heapIndex);
+}
 
 static void printStoragedResources(OCRDStorePublishResources *payload)
 {
@@ -46,84 +549,282 @@ static void printStoragedResources(OCRDStorePublishResources *payload)
     }
 }
 
-OCStackResult OCRDStorePublishedResources(const OCResourceCollectionPayload *payload)
+static void removeResources(OCRDStorePublishResources *resource)
 {
-    OCResourceCollectionPayload *storeResource = (OCResourceCollectionPayload *)OICCalloc(1, sizeof(OCResourceCollectionPayload));
-    if (!storeResource)
+    if (resource->prev)
     {
-        OC_LOG(ERROR, TAG, "Failed allocating memory for OCRDStorePublishResources.");
-        return OC_STACK_NO_MEMORY;
+        resource->prev->next = resource->next;
+    }
+    else
+    {
+        g_rdStorage = resource->next;
+    }
+    if (resource->next)
+    {
+        resource->next->prev = resource->prev;
+    }
+    else
+    {
+        g_rdStorageTail = resource->prev;
     }
 
-    OC_LOG(DEBUG, TAG, "Storing Resources ... ");
+    if (resource->heapIndex != RD_NOT_IN_HEAP)
+    {
+        heapRemove(resource);
+    }
+    indexRemoveRefs(resource);
+    dbDelete(resource->rowId);
+    OCFreeCollectionResource(resource->publishedResource);
+    OICFree(resource);
+}
 
-    OCTagsPayload *tags = payload->tags;
-    storeResource->tags = OCCopyTagsResources(tags->n.deviceName, tags->di.id, tags->baseURI,
-        tags->bitmap, tags->port, tags->ins, tags->rts, tags->drel, tags->ttl);
-    if (!storeResource->tags)
+/**
+ * Removes the published resources whose time to live has passed.
+ */
+static void expireResources(uint64_t now)
+{
+    if (!g_ttlHeapCount || g_ttlHeap[0]->expiry > now)
     {
-        OC_LOG(ERROR, TAG, "Failed allocating memory for tags.");
-        OCFreeCollectionResource(storeResource);
-        return OC_STACK_NO_MEMORY;
+        return;
     }
 
-    for (OCLinksPayload *links = payload->setLinks; links; links = links->next)
+    dbBegin();
+    while (g_ttlHeapCount && g_ttlHeap[0]->expiry <= now)
     {
-        if (!storeResource->setLinks)
+        OC_LOG_V(DEBUG, TAG, "Resources of %s expired.",
+                 (char *)g_ttlHeap[0]->publishedResource->tags->di.id);
+        removeResources(g_ttlHeap[0]);
+    }
+    dbCommit();
+}
+
+static bool hasHref(const OCLinksPayload *links, const char *href)
+{
+    for (; links; links = links->next)
+    {
+        if (links->href && strcmp(links->href, href) == 0)
         {
-            storeResource->setLinks = OCCopyLinksResources(links->href, links->rt, links->itf,
-                links->rel, links->obs, links->title, links->uri, links->ins, links->mt);
-            if (!storeResource->setLinks)
-            {
-                OC_LOG(ERROR, TAG, "Failed allocating memory for links.");
-                OCFreeCollectionResource(storeResource);
-                return OC_STACK_NO_MEMORY;
-            }
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Removes the links of the resource that have the href of one of the links.
+ *
+ * @return true if a link was removed.
+ */
+static bool removeRepublishedLinks(OCRDStorePublishResources *resource,
+        const OCLinksPayload *links)
+{
+    bool removed = false;
+    OCLinksPayload **prev = &resource->publishedResource->setLinks;
+    while (*prev)
+    {
+        OCLinksPayload *link = *prev;
+        if (link->href && hasHref(links, link->href))
+        {
+            *prev = link->next;
+            link->next = NULL;
+            indexRemoveLinkRefs(resource, link);
+            OCFreeLinksResource(link);
+            removed = true;
         }
         else
         {
-            OCLinksPayload *temp = storeResource->setLinks;
-            while (temp->next)
+            prev = &link->next;
+        }
+    }
+    return removed;
+}
+
+/**
+ * Removes the links the same device published before with the href of one of the links
+ * of the resources. Resources left without links are removed.
+ */
+static void replaceRepublishedLinks(OCRDStorePublishResources *resources)
+{
+    const char *di = (const char *)resources->publishedResource->tags->di.id;
+    if (!di[0])
+    {
+        return;
+    }
+
+    OCRDIndexRef *ref = indexFirst(&g_diIndex, di);
+    while (ref)
+    {
+        OCRDIndexRef *next = ref->next;
+        OCRDStorePublishResources *previous = ref->resource;
+        if (previous != resources &&
+            removeRepublishedLinks(previous, resources->publishedResource->setLinks))
+        {
+            OC_LOG_V(DEBUG, TAG, "Replacing links published before by %s.", di);
+            if (previous->publishedResource->setLinks)
             {
-                temp = temp->next;
+                dbUpdate(previous);
             }
-            temp->next = OCCopyLinksResources(links->href, links->rt, links->itf, links->rel,
-                links->obs, links->title, links->uri, links->ins, links->mt);
-            if (!temp->next)
+            else
             {
-                OC_LOG(ERROR, TAG, "Failed allocating memory for links.");
-                OCFreeCollectionResource(storeResource);
-                return OC_STACK_NO_MEMORY;
+                removeResources(previous);
             }
         }
-
+        ref = next;
     }
-    storeResource->next = NULL;
-    OCRDStorePublishResources *resources = (OCRDStorePublishResources *)OICCalloc(1, sizeof(OCRDStorePublishResources));
+}
+
+/**
+ * Indexes the resources and adds them to the storage. A link replaces the link the same
+ * device published before with the same href, the other links published before stay.
+ *
+ * @param collection Resources to add, taken over, and freed on failure.
+ * @param expiry Time the resources expire at, 0 if never.
+ * @param rowId Row of the resources in the database, 0 to store them there.
+ */
+static OCStackResult addResources(OCResourceCollectionPayload *collection, uint64_t expiry,
+        int64_t rowId)
+{
+    OCRDStorePublishResources *resources =
+        (OCRDStorePublishResources *)OICCalloc(1, sizeof(OCRDStorePublishResources));
     if (!resources)
     {
-        OCFreeCollectionResource(storeResource);
+        OCFreeCollectionResource(collection);
         return OC_STACK_NO_MEMORY;
     }
-    resources->publishedResource = storeResource;
+    resources->publishedResource = collection;
+    resources->expiry = expiry;
+    resources->heapIndex = RD_NOT_IN_HEAP;
 
-    pthread_mutex_lock(&storageMutex);
-    if (g_rdStorage)
+    const char *di = (const char *)collection->tags->di.id;
+    bool indexed = !di[0] || indexAdd(&g_diIndex, di, resources, NULL, 0);
+    for (OCLinksPayload *link = collection->setLinks; indexed && link; link = link->next)
     {
-        OCRDStorePublishResources *temp = g_rdStorage;
-        while (temp->next)
+        // Links without rt or itf are kept but never found.
+        if (!link->rt || !link->itf)
         {
-            temp = temp->next;
+            OC_LOG(DEBUG, TAG, "Either resource type and interface type are missing.");
+            continue;
         }
-        temp->next = resources;
+        uint64_t seq = ++g_linkSeq;
+        for (OCStringLL *rt = link->rt; indexed && rt; rt = rt->next)
+        {
+            indexed = indexAdd(&g_rtIndex, rt->value, resources, link, seq);
+        }
+        for (OCStringLL *itf = link->itf; indexed && itf; itf = itf->next)
+        {
+            indexed = indexAdd(&g_itfIndex, itf->value, resources, link, seq);
+        }
+    }
+    if (!indexed || (expiry && !heapPush(resources)))
+    {
+        OC_LOG(ERROR, TAG, "Failed allocating memory for the indexes.");
+        indexRemoveRefs(resources);
+        OCFreeCollectionResource(collection);
+        OICFree(resources);
+        return OC_STACK_NO_MEMORY;
+    }
+
+    dbBegin();
+    resources->rowId = rowId ? rowId : dbInsert(collection);
+    replaceRepublishedLinks(resources);
+    dbCommit();
+
+    resources->prev = g_rdStorageTail;
+    if (g_rdStorageTail)
+    {
+        g_rdStorageTail->next = resources;
     }
     else
     {
         g_rdStorage = resources;
     }
+    g_rdStorageTail = resources;
+    return OC_STACK_OK;
+}
+
+OCStackResult OCRDStorePublishedResources(const OCResourceCollectionPayload *payload)
+{
+    if (!payload || !payload->tags)
+    {
+        OC_LOG(ERROR, TAG, "Missing tags of the published resources.");
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    OCResourceCollectionPayload *storeResource = (OCResourceCollectionPayload *)OICCalloc(1, sizeof(OCResourceCollectionPayload));
+    if (!storeResource)
+    {
+        OC_LOG(ERROR, TAG, "Failed allocating memory for OCRDStorePublishResources.");
+        return OC_STACK_NO_MEMORY;
+    }
+
+    OC_LOG(DEBUG, TAG, "Storing Resources ... ");
+
+    OCTagsPayload *tags = payload->tags;
+    storeResource->tags = OCCopyTagsResources(tags->n.deviceName, tags->di.id, tags->baseURI,
+        tags->bitmap, tags->port, tags->ins, tags->rts, tags->drel, tags->ttl);
+    if (!storeResource->tags)
+    {
+        OC_LOG(ERROR, TAG, "Failed allocating memory for tags.");
+        OCFreeCollectionResource(storeResource);
+        return OC_STACK_NO_MEMORY;
+    }
+
+    OCLinksPayload **tail = &storeResource->setLinks;
+    for (OCLinksPayload *links = payload->setLinks; links; links = links->next)
+    {
+        *tail = OCCopyLinksResources(links->href, links->rt, links->itf, links->rel,
+            links->obs, links->title, links->uri, links->ins, links->mt);
+        if (!*tail)
+        {
+            OC_LOG(ERROR, TAG, "Failed allocating memory for links.");
+            OCFreeCollectionResource(storeResource);
+            return OC_STACK_NO_MEMORY;
+        }
+        tail = &(*tail)->next;
+    }
+    storeResource->next = NULL;
+
+    uint64_t now = getCurrentTimeMs();
+    uint64_t expiry = tags->ttl ? now + (uint64_t)tags->ttl * 1000 : 0;
+
+    pthread_mutex_lock(&storageMutex);
+    expireResources(now);
+    OCStackResult result = addResources(storeResource, expiry, 0);
+    if (result == OC_STACK_OK)
+    {
+        printStoragedResources(g_rdStorageTail);
+    }
     pthread_mutex_unlock(&storageMutex);
+    return result;
+}
 
-    printStoragedResources(g_rdStorage);
+/**
+ * Copies the tags of the resources and one of their links into a collection payload.
+ */
+static OCStackResult copyPublishedLink(const OCRDStorePublishResources *resource,
+        const OCLinksPayload *tLinks, const char *href, OCResourceCollectionPayload **payload)
+{
+    OCTagsPayload *tag = resource->publishedResource->tags;
+    OCTagsPayload *tags = OCCopyTagsResources(tag->n.deviceName, tag->di.id, tag->baseURI,
+        tag->bitmap, tag->port, tag->ins, tag->rts, tag->drel, tag->ttl);
+    if (!tags)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+    OCLinksPayload *links = OCCopyLinksResources(href, tLinks->rt, tLinks->itf,
+        tLinks->rel, tLinks->obs, tLinks->title, tLinks->uri, tLinks->ins, tLinks->mt);
+    if (!links)
+    {
+        OCFreeTagsResource(tags);
+        return OC_STACK_NO_MEMORY;
+    }
+    *payload = OCCopyCollectionResource(tags, links);
+    if (!*payload)
+    {
+        OCFreeTagsResource(tags);
+        OCFreeLinksResource(links);
+        return OC_STACK_NO_MEMORY;
+    }
     return OC_STACK_OK;
 }
 
@@ -139,92 +840,158 @@ OCStackResult OCRDCheckPublishedResource(const char *interfaceType, const char *
     }
 
     OC_LOG(DEBUG, TAG, "Check Resource in RD");
-    if (g_rdStorage && g_rdStorage->publishedResource)
+
+    pthread_mutex_lock(&storageMutex);
+    expireResources(getCurrentTimeMs());
+
+    // The first link published with either type matches, the resource type if it has both.
+    OCRDIndexRef *rtRef = resourceType ? indexFirst(&g_rtIndex, resourceType) : NULL;
+    OCRDIndexRef *itfRef = interfaceType ? indexFirst(&g_itfIndex, interfaceType) : NULL;
+
+    OCStackResult result = OC_STACK_ERROR;
+    if (rtRef && (!itfRef || rtRef->seq <= itfRef->seq))
+    {
+        OC_LOG_V(DEBUG, TAG, "Resource Type: %s", resourceType);
+        result = copyPublishedLink(rtRef->resource, rtRef->link, rtRef->link->href, payload);
+    }
+    else if (itfRef)
+    {
+        OC_LOG_V(DEBUG, TAG, "Interface Type: %s", interfaceType);
+        result = copyPublishedLink(itfRef->resource, itfRef->link, itfRef->link->uri, payload);
+    }
+    pthread_mutex_unlock(&storageMutex);
+    return result;
+}
+
+#ifdef RD_DATABASE
+
+/**
+ * Adds the resources stored in the database that have not expired.
+ */
+static OCStackResult loadDatabase()
+{
+    sqlite3_int64 now = (sqlite3_int64)time(NULL);
+    uint64_t nowMs = getCurrentTimeMs();
+
+    sqlite3_stmt *stmt = NULL;
+    int res = sqlite3_prepare_v2(g_db, RD_DB_DELETE_EXPIRED, -1, &stmt, NULL);
+    RD_VERIFY_SQLITE_OK(res, OC_STACK_ERROR);
+    res = sqlite3_bind_int64(stmt, RD_BIND_INDEX_FIRST, now);
+    if (SQLITE_OK != res || SQLITE_DONE != sqlite3_step(stmt))
     {
-        for (OCRDStorePublishResources *pResource = g_rdStorage;
-                pResource; pResource = pResource->next)
+        OC_LOG_V(ERROR, TAG, "Failed deleting expired resources: %s", sqlite3_errmsg(g_db));
+    }
+    sqlite3_finalize(stmt);
+
+    res = sqlite3_prepare_v2(g_db, RD_DB_SELECT_ALL, -1, &stmt, NULL);
+    RD_VERIFY_SQLITE_OK(res, OC_STACK_ERROR);
+
+    size_t loaded = 0;
+    while (SQLITE_ROW == sqlite3_step(stmt))
+    {
+        int64_t rowId = sqlite3_column_int64(stmt, 0);
+        sqlite3_int64 expiry = sqlite3_column_int64(stmt, 1);
+        const uint8_t *data = (const uint8_t *)sqlite3_column_blob(stmt, 2);
+        size_t size = (size_t)sqlite3_column_bytes(stmt, 2);
+
+        CborParser parser;
+        CborValue rootArray;
+        CborValue collectionArray;
+        OCRDPayload *rdPayload = NULL;
+        if (CborNoError != cbor_parser_init(data, size, 0, &parser, &rootArray) ||
+            !cbor_value_is_array(&rootArray) ||
+            CborNoError != cbor_value_enter_container(&rootArray, &collectionArray) ||
+            OC_STACK_OK != OCRDCborToPayload(&collectionArray, (OCPayload **)&rdPayload) ||
+            !rdPayload->rdPublish || !rdPayload->rdPublish->tags)
         {
-            if (pResource->publishedResource->setLinks)
-            {
-                for (OCLinksPayload *tLinks = pResource->publishedResource->setLinks; tLinks; tLinks = tLinks->next)
-                {
-                    // If either rt or itf are NULL, it should skip remaining code execution.
-                    if (!tLinks->rt || !tLinks->itf)
-                    {
-                        OC_LOG(DEBUG, TAG, "Either resource type and interface type are missing.");
-                        continue;
-                    }
-                    if (resourceType)
-                    {
-                        OCStringLL *temp = tLinks->rt;
-                        while(temp)
-                        {
-                            OC_LOG_V(DEBUG, TAG, "Resource Type: %s %s", resourceType, temp->value);
-                            if (strcmp(resourceType, temp->value) == 0)
-                            {
-                                OCTagsPayload *tag = pResource->publishedResource->tags;
-                                OCTagsPayload *tags = OCCopyTagsResources(tag->n.deviceName, tag->di.id, tag->baseURI,
-                                    tag->bitmap, tag->port, tag->ins, tag->rts, tag->drel, tag->ttl);
-                                if (!tags)
-                                {
-                                    return OC_STACK_NO_MEMORY;
-                                }
-                                OCLinksPayload *links = OCCopyLinksResources(tLinks->href, tLinks->rt, tLinks->itf,
-                                    tLinks->rel, tLinks->obs, tLinks->title, tLinks->uri, tLinks->ins, tLinks->mt);
-                                if (!links)
-                                {
-                                    OCFreeTagsResource(tags);
-                                    return OC_STACK_NO_MEMORY;
-                                }
-                                *payload = OCCopyCollectionResource(tags, links);
-                                if (!*payload)
-                                {
-                                    OCFreeTagsResource(tags);
-                                    OCFreeLinksResource(links);
-                                    return OC_STACK_NO_MEMORY;
-                                }
-                                return OC_STACK_OK;
-                            }
-                            temp = temp->next;
-                        }
-                    }
-                    if (interfaceType)
-                    {
-                        OCStringLL *temp = tLinks->itf;
-                        while (temp)
-                        {
-                            OC_LOG_V(DEBUG, TAG, "Interface Type: %s %s", interfaceType, temp->value);
-                            if (strcmp(interfaceType, temp->value) == 0)
-                            {
-                                OCTagsPayload *tag = pResource->publishedResource->tags;
-                                OCTagsPayload *tags = OCCopyTagsResources(tag->n.deviceName, tag->di.id, tag->baseURI,
-                                    tag->bitmap, tag->port, tag->ins, tag->rts, tag->drel, tag->ttl);
-                                if (!tags)
-                                {
-                                    return OC_STACK_NO_MEMORY;
-                                }
-                                OCLinksPayload *links = OCCopyLinksResources(tLinks->uri, tLinks->rt, tLinks->itf,
-                                    tLinks->rel, tLinks->obs, tLinks->title, tLinks->uri, tLinks->ins, tLinks->mt);
-                                if (!links)
-                                {
-                                    OCFreeTagsResource(tags);
-                                    return OC_STACK_NO_MEMORY;
-                                }
-                                *payload = OCCopyCollectionResource(tags, links);
-                                if (!*payload)
-                                {
-                                    OCFreeTagsResource(tags);
-                                    OCFreeLinksResource(links);
-                                    return OC_STACK_NO_MEMORY;
-                                }
-                                return OC_STACK_OK;
-                            }
-                            temp = temp->next;
-                        }
-                    }
-                }
-            }
+            OC_LOG_V(ERROR, TAG, "Skipping malformed resources in row %lld.", (long long)rowId);
+            OCRDPayloadDestroy(rdPayload);
+            continue;
+        }
+        OCResourceCollectionPayload *collection = rdPayload->rdPublish;
+        rdPayload->rdPublish = NULL;
+        OCRDPayloadDestroy(rdPayload);
+
+        uint64_t expiryMs = expiry ? nowMs + (uint64_t)(expiry - now) * 1000 : 0;
+        if (OC_STACK_OK != addResources(collection, expiryMs, rowId))
+        {
+            sqlite3_finalize(stmt);
+            return OC_STACK_NO_MEMORY;
         }
+        loaded++;
+    }
+    sqlite3_finalize(stmt);
+
+    OC_LOG_V(DEBUG, TAG, "Loaded %u published resources.", (unsigned int)loaded);
+    return OC_STACK_OK;
+}
+
+OCStackResult OCRDOpenDatabase(const char *path)
+{
+    if (!path)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&storageMutex);
+    if (g_db)
+    {
+        pthread_mutex_unlock(&storageMutex);
+        OC_LOG(ERROR, TAG, "The database is open already.");
+        return OC_STACK_ERROR;
+    }
+
+    OCStackResult result = OC_STACK_ERROR;
+    if (SQLITE_OK != sqlite3_open_v2(path, &g_db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE,
+                NULL) ||
+        SQLITE_OK != sqlite3_exec(g_db, RD_DB_CREATE_TABLE, NULL, NULL, NULL) ||
+        SQLITE_OK != sqlite3_prepare_v2(g_db, RD_DB_INSERT, -1, &g_insertStmt, NULL) ||
+        SQLITE_OK != sqlite3_prepare_v2(g_db, RD_DB_UPDATE, -1, &g_updateStmt, NULL) ||
+        SQLITE_OK != sqlite3_prepare_v2(g_db, RD_DB_DELETE, -1, &g_deleteStmt, NULL))
+    {
+        OC_LOG_V(ERROR, TAG, "Failed opening database %s: %s", path, sqlite3_errmsg(g_db));
+    }
+    else
+    {
+        result = loadDatabase();
+    }
+
+    if (result != OC_STACK_OK)
+    {
+        dbClose();
     }
-    return OC_STACK_ERROR;
+    pthread_mutex_unlock(&storageMutex);
+    return result;
+}
+
+#else
+
+OCStackResult OCRDOpenDatabase(const char *path)
+{
+    (void)path;
+    OC_LOG(ERROR, TAG, "Resource directory built without RD_DATABASE.");
+    return OC_STACK_NOTIMPL;
+}
+
+#endif // RD_DATABASE
+
+void OCRDStorageClose()
+{
+    pthread_mutex_lock(&storageMutex);
+    // closed first, so that the resources stay in the database
+    dbClose();
+    while (g_rdStorage)
+    {
+        removeResources(g_rdStorage);
+    }
+
+    OICHashTableClear(&g_rtIndex);
+    OICHashTableClear(&g_itfIndex);
+    OICHashTableClear(&g_diIndex);
+
+    OICFree(g_ttlHeap);
+    g_ttlHeap = NULL;
+    g_ttlHeapCount = 0;
+    g_ttlHeapSize = 0;
+    pthread_mutex_unlock(&storageMutex);
 }
@@ -22,17 +22,37 @@
 
 #include "octypes.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+/** Value of heapIndex for published resources that do not expire. */
+#define RD_NOT_IN_HEAP ((size_t)-1)
+
+struct OCRDIndexRef;
+
 /** Stucture holding Published Resources on the Resource Directory. */
 typedef struct OCRDStorePublishResources
 {
     /** Publish resource. */
     OCResourceCollectionPayload *publishedResource;
+    /** Time the resources expire at, in milliseconds of the monotonic clock, 0 if never. */
+    uint64_t expiry;
+    /** Position in the TTL heap, RD_NOT_IN_HEAP if the resources do not expire. */
+    size_t heapIndex;
+    /** Entries of the resources in the rt, itf and di indexes. */
+    struct OCRDIndexRef *refs;
+    /** Row of the resources in the database, 0 if they are not stored there. */
+    int64_t rowId;
     /** Linked list pointing to next published resource. */
     struct OCRDStorePublishResources *next;
+    /** Linked list pointing to previous published resource. */
+    struct OCRDStorePublishResources *prev;
 } OCRDStorePublishResources;
 
 /**
- * Stores the publish resources.
+ * Stores the publish resources.  A link replaces the link that the same device published
+ * before with the same href, the other links published before by the device stay.
  *
  * @param payload RDPublish payload sent from the remote device.
  *
@@ -40,6 +60,12 @@ typedef struct OCRDStorePublishResources
  */
 OCStackResult OCRDStorePublishedResources(const OCResourceCollectionPayload *payload);
 
+/**
+ * Removes all published resources from memory and closes the database, if one is open.
+ * The resources stored in the database stay there.
+ */
+void OCRDStorageClose();
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
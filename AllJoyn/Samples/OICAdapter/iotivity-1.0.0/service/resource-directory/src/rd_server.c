@@ -191,6 +191,7 @@ OCStackResult OCRDStart()
 OCStackResult OCRDStop()
 {
     OCStackResult result = OCStop();
+    OCRDStorageClose();
 
     if (result == OC_STACK_OK)
     {
@@ -0,0 +1,335 @@
+//******************************************************************
+//
+// Copyright 2015 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include "rd_server.h"
+#include "rd_storage.h"
+#include "rdpayload.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct Link
+    {
+        std::string href;
+        std::vector<std::string> rts;
+        std::vector<std::string> itfs;
+    };
+
+    struct Publication
+    {
+        std::string di;
+        std::vector<Link> links;
+    };
+
+    struct Found
+    {
+        Found() : found(false) {}
+
+        bool found;
+        std::string di;
+        std::string href;
+    };
+
+    // the list of the values, in nodes kept by the caller
+    OCStringLL *toStringLL(const std::vector<std::string>& values, std::vector<OCStringLL>& nodes)
+    {
+        nodes.resize(values.size());
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            nodes[i].value = (char *)values[i].c_str();
+            nodes[i].next = i + 1 < values.size() ? &nodes[i + 1] : NULL;
+        }
+        return nodes.empty() ? NULL : &nodes[0];
+    }
+
+    bool contains(const std::vector<std::string>& values, const char *value)
+    {
+        for (const std::string& v : values)
+        {
+            if (v == value)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+class RDStorageF : public testing::Test
+{
+protected:
+    virtual void TearDown()
+    {
+        OCRDStorageClose();
+    }
+
+    // publishes the links and records them, as they are merged by the storage
+    void publish(const Publication& publication, uint32_t ttl = 0)
+    {
+        OCTagsPayload *tags = OCCopyTagsResources("test",
+                (const unsigned char *)publication.di.c_str(), NULL, 0, 0, 0, NULL, NULL, ttl);
+        ASSERT_TRUE(NULL != tags);
+
+        OCLinksPayload *links = NULL;
+        OCLinksPayload **tail = &links;
+        for (const Link& link : publication.links)
+        {
+            std::vector<OCStringLL> rtNodes;
+            std::vector<OCStringLL> itfNodes;
+            OCStringLL *rt = toStringLL(link.rts, rtNodes);
+            OCStringLL *itf = toStringLL(link.itfs, itfNodes);
+            // the uri, which an itf lookup returns, tells the link apart from the href
+            std::string uri = link.href + "?uri";
+            *tail = OCCopyLinksResources(link.href.c_str(), rt, itf, NULL, false, NULL,
+                                         uri.c_str(), 0, NULL);
+            ASSERT_TRUE(NULL != *tail);
+            tail = &(*tail)->next;
+        }
+
+        OCResourceCollectionPayload *payload = OCCopyCollectionResource(tags, links);
+        ASSERT_TRUE(NULL != payload);
+        EXPECT_EQ(OC_STACK_OK, OCRDStorePublishedResources(payload));
+        OCFreeCollectionResource(payload);
+
+        for (Publication& previous : m_published)
+        {
+            if (previous.di != publication.di)
+            {
+                continue;
+            }
+            for (size_t i = 0; i < previous.links.size();)
+            {
+                bool republished = false;
+                for (const Link& link : publication.links)
+                {
+                    republished = republished || link.href == previous.links[i].href;
+                }
+                if (republished)
+                {
+                    previous.links.erase(previous.links.begin() + i);
+                }
+                else
+                {
+                    i++;
+                }
+            }
+        }
+        m_published.push_back(publication);
+    }
+
+    Found lookup(const char *itf, const char *rt)
+    {
+        Found result;
+        OCResourceCollectionPayload *payload = NULL;
+        if (OC_STACK_OK == OCRDCheckPublishedResource(itf, rt, &payload))
+        {
+            result.found = true;
+            result.di = (const char *)payload->tags->di.id;
+            result.href = payload->setLinks->href;
+            OCFreeCollectionResource(payload);
+        }
+        return result;
+    }
+
+    // the walk over every published link that the lookup did before the indexes
+    Found linearScan(const char *itf, const char *rt)
+    {
+        Found result;
+        for (const Publication& publication : m_published)
+        {
+            for (const Link& link : publication.links)
+            {
+                if (link.rts.empty() || link.itfs.empty())
+                {
+                    continue;
+                }
+                if (rt && contains(link.rts, rt))
+                {
+                    result.found = true;
+                    result.di = publication.di;
+                    result.href = link.href;
+                    return result;
+                }
+                if (itf && contains(link.itfs, itf))
+                {
+                    result.found = true;
+                    result.di = publication.di;
+                    result.href = link.href + "?uri";
+                    return result;
+                }
+            }
+        }
+        return result;
+    }
+
+    void expectLookupsMatchLinearScan(const std::vector<std::string>& rts,
+                                      const std::vector<std::string>& itfs)
+    {
+        std::vector<const char *> rtQueries = { NULL, "oic.r.missing" };
+        std::vector<const char *> itfQueries = { NULL, "oic.if.missing" };
+        for (const std::string& rt : rts)
+        {
+            rtQueries.push_back(rt.c_str());
+        }
+        for (const std::string& itf : itfs)
+        {
+            itfQueries.push_back(itf.c_str());
+        }
+
+        for (const char *rt : rtQueries)
+        {
+            for (const char *itf : itfQueries)
+            {
+                if (!rt && !itf)
+                {
+                    continue;
+                }
+                Found expected = linearScan(itf, rt);
+                Found actual = lookup(itf, rt);
+                EXPECT_EQ(expected.found, actual.found) << (rt ? rt : "") << " " << (itf ? itf : "");
+                EXPECT_EQ(expected.di, actual.di) << (rt ? rt : "") << " " << (itf ? itf : "");
+                EXPECT_EQ(expected.href, actual.href) << (rt ? rt : "") << " " << (itf ? itf : "");
+            }
+        }
+    }
+
+    std::vector<Publication> m_published;
+};
+
+TEST_F(RDStorageF, LookupMatchesLinearScan)
+{
+    std::vector<std::string> rts;
+    for (int i = 0; i < 7; i++)
+    {
+        rts.push_back("oic.r.test." + std::to_string(i));
+    }
+    std::vector<std::string> itfs = { "oic.if.baseline", "oic.if.s", "oic.if.a" };
+
+    for (int device = 0; device < 30; device++)
+    {
+        Publication publication;
+        publication.di = "device-" + std::to_string(device);
+        for (int i = 0; i < 4; i++)
+        {
+            int n = device * 4 + i;
+            Link link;
+            link.href = "/a/" + std::to_string(i);
+            link.rts.push_back(rts[(n * 3) % rts.size()]);
+            if (n % 5 == 0)
+            {
+                link.rts.push_back(rts[(n + 1) % rts.size()]);
+            }
+            // links without itf are never found
+            if (n % 11 != 0)
+            {
+                link.itfs.push_back(itfs[n % itfs.size()]);
+            }
+            publication.links.push_back(link);
+        }
+        publish(publication);
+    }
+
+    expectLookupsMatchLinearScan(rts, itfs);
+}
+
+TEST_F(RDStorageF, ResourcesExpireAfterTtl)
+{
+    publish({ "expiring", { { "/a/light", { "oic.r.light" }, { "oic.if.baseline" } } } }, 1);
+    publish({ "staying", { { "/a/fan", { "oic.r.fan" }, { "oic.if.baseline" } } } });
+
+    EXPECT_TRUE(lookup(NULL, "oic.r.light").found);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+
+    EXPECT_FALSE(lookup(NULL, "oic.r.light").found);
+    Found fan = lookup(NULL, "oic.r.fan");
+    EXPECT_TRUE(fan.found);
+    EXPECT_EQ("staying", fan.di);
+    EXPECT_EQ("/a/fan?uri", lookup("oic.if.baseline", NULL).href);
+}
+
+TEST_F(RDStorageF, PublishAgainReplacesLinksWithSameHref)
+{
+    publish({ "lamp", { { "/a/light", { "oic.r.light" }, { "oic.if.baseline" } },
+                        { "/a/dimmer", { "oic.r.dimmer" }, { "oic.if.baseline" } } } });
+    publish({ "other", { { "/a/light", { "oic.r.light" }, { "oic.if.baseline" } } } });
+
+    // the same device, one href of before and a new one
+    publish({ "lamp", { { "/a/light", { "oic.r.light.rgb" }, { "oic.if.baseline" } },
+                        { "/a/switch", { "oic.r.switch" }, { "oic.if.baseline" } } } });
+
+    Found light = lookup(NULL, "oic.r.light");
+    EXPECT_TRUE(light.found);
+    EXPECT_EQ("other", light.di);
+    EXPECT_EQ("/a/light", lookup(NULL, "oic.r.light.rgb").href);
+    EXPECT_EQ("lamp", lookup(NULL, "oic.r.dimmer").di);
+    EXPECT_EQ("lamp", lookup(NULL, "oic.r.switch").di);
+
+    // the other links of the first publication stay, so it is found before the other device
+    EXPECT_EQ("lamp", lookup("oic.if.baseline", NULL).di);
+
+    // a publication whose links were all replaced is gone
+    publish({ "other", { { "/a/light", { "oic.r.light" }, { "oic.if.baseline" } } } });
+    publish({ "lamp", { { "/a/dimmer", { "oic.r.dimmer" }, { "oic.if.baseline" } } } });
+    expectLookupsMatchLinearScan({ "oic.r.light", "oic.r.light.rgb", "oic.r.dimmer",
+                                   "oic.r.switch" }, { "oic.if.baseline" });
+}
+
+#ifdef RD_DATABASE
+TEST_F(RDStorageF, ReloadsFromDatabase)
+{
+    char path[] = "/tmp/rd_storage_testXXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_NE(-1, fd);
+    close(fd);
+    unlink(path);
+
+    ASSERT_EQ(OC_STACK_OK, OCRDOpenDatabase(path));
+    publish({ "lamp", { { "/a/light", { "oic.r.light" }, { "oic.if.baseline" } },
+                        { "/a/dimmer", { "oic.r.dimmer" }, { "oic.if.baseline" } } } }, 3600);
+    publish({ "fan", { { "/a/fan", { "oic.r.fan" }, { "oic.if.a" } } } });
+    publish({ "lamp", { { "/a/light", { "oic.r.light.rgb" }, { "oic.if.s" } } } }, 3600);
+    publish({ "short", { { "/a/short", { "oic.r.short" }, { "oic.if.a" } } } }, 1);
+
+    std::vector<std::string> rts = { "oic.r.light", "oic.r.light.rgb", "oic.r.dimmer",
+                                     "oic.r.fan" };
+    std::vector<std::string> itfs = { "oic.if.baseline", "oic.if.s", "oic.if.a" };
+    m_published.pop_back();
+    OCRDStorageClose();
+    std::this_thread::sleep_for(std::chrono::milliseconds(2100));
+
+    // the expired publication is not loaded again
+    ASSERT_EQ(OC_STACK_OK, OCRDOpenDatabase(path));
+    EXPECT_FALSE(lookup(NULL, "oic.r.short").found);
+    expectLookupsMatchLinearScan(rts, itfs);
+
+    OCRDStorageClose();
+    unlink(path);
+}
+#endif
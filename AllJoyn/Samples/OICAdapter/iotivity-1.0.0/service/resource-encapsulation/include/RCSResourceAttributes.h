@@ -32,6 +32,7 @@
 #define BOOST_MPL_LIMIT_LIST_SIZE 30
 #define BOOST_MPL_LIMIT_VECTOR_SIZE 30
 
+#include <atomic>
 #include <functional>
 #include <unordered_map>
 #include <vector>
@@ -41,7 +42,6 @@
 #include <boost/mpl/find.hpp>
 #include <boost/mpl/distance.hpp>
 #include <boost/mpl/begin_end.hpp>
-#include <boost/scoped_ptr.hpp>
 
 #include <RCSException.h>
 
@@ -57,6 +57,9 @@ namespace OIC
         * operators and accessors)<br/>
         * An attribute value can be one of various types. <br/>
         *
+        * Keys are interned and shared by every attributes that uses them, scalar values are
+        * stored inline and other values are shared between copies until one of them is
+        * modified, so copying attributes is cheap.
         *
         * @see Value
         * @see Type
@@ -130,7 +133,24 @@ namespace OIC
 
             template <typename T> struct IndexOfType;
 
+            template< typename T >
+            struct IsInlined: public std::integral_constant< bool,
+                std::is_same< T, std::nullptr_t >::value || std::is_same< T, int >::value ||
+                std::is_same< T, double >::value || std::is_same< T, bool >::value > { };
+
+            struct Entry;
+            struct EntryChunk;
+            class EntryTable;
+
+            template< typename CHUNK >
+            struct EntryPosition
+            {
+                CHUNK* m_chunk;
+                size_t m_index;
+            };
+
         public:
+            class Value;
 
             /**
              * Trait class that identifies whether T is supported by the Value.
@@ -233,6 +253,8 @@ namespace OIC
 
                 //! @cond
                 friend bool operator==(const Type&, const Type&) noexcept;
+
+                friend class Value;
                 //! @endcond
 
             private:
@@ -298,20 +320,19 @@ namespace OIC
                  *       Otherwise it won't compile.
                  */
                 template< typename T, typename = typename enable_if_supported< T >::type >
-                Value(T&& value) :
-                        m_data{ new ValueVariant{ std::forward< T >(value) } }
-                {
-                }
+                Value(T&& value);
 
                 Value(const char*);
 
+                ~Value();
+
                 Value& operator=(const Value&);
                 Value& operator=(Value&&);
 
                 template< typename T, typename = typename enable_if_supported< T >::type >
                 Value& operator=(T&& rhs)
                 {
-                    *m_data = std::forward< T >(rhs);
+                    Value(std::forward< T >(rhs)).swap(*this);
                     return *this;
                 }
 
@@ -367,18 +388,32 @@ namespace OIC
                 //! @endcond
 
             private:
+                struct SharedData;
+
                 template< typename T, typename = typename enable_if_supported< T >::type >
-                typename std::add_lvalue_reference< T >::type checkedGet() const
-                {
-                    try
-                    {
-                        return boost::get< T >(*m_data);
-                    }
-                    catch (const boost::bad_get&)
-                    {
-                        throw RCSBadGetException{ "Wrong type" };
-                    }
-                }
+                const T& checkedGet() const;
+
+                template< typename T, typename = typename enable_if_supported< T >::type >
+                T& checkedGet();
+
+                template< typename T >
+                void construct(T&& value, std::true_type);
+
+                template< typename T >
+                void construct(T&& value, std::false_type);
+
+                template< typename T >
+                T& data(std::true_type) const;
+
+                template< typename T >
+                T& data(std::false_type) const;
+
+                template< typename VISITOR >
+                void visit(const std::string& key, VISITOR& visitor) const;
+
+                bool isShared() const noexcept;
+                void detach();
+                void release() noexcept;
 
                 template< typename T, typename U >
                 bool equals(const U& rhs) const
@@ -394,7 +429,21 @@ namespace OIC
                 }
 
             private:
-                boost::scoped_ptr< ValueVariant > m_data;
+                union Storage
+                {
+                    std::nullptr_t m_null;
+                    int m_int;
+                    double m_double;
+                    bool m_bool;
+                    SharedData* m_shared;
+                };
+
+                Storage m_storage;
+                int m_which;
+
+                // A non-const reference to the shared data has been handed out,
+                // so it can't be shared with copies any more.
+                bool m_leaked;
             };
 
             class KeyValuePair;
@@ -402,12 +451,14 @@ namespace OIC
             class const_iterator;
 
         public:
-            RCSResourceAttributes() = default;
-            RCSResourceAttributes(const RCSResourceAttributes&) = default;
-            RCSResourceAttributes(RCSResourceAttributes&&) = default;
+            RCSResourceAttributes() noexcept;
+            RCSResourceAttributes(const RCSResourceAttributes&);
+            RCSResourceAttributes(RCSResourceAttributes&&) noexcept;
+
+            ~RCSResourceAttributes();
 
-            RCSResourceAttributes& operator=(const RCSResourceAttributes&) = default;
-            RCSResourceAttributes& operator=(RCSResourceAttributes&&) = default;
+            RCSResourceAttributes& operator=(const RCSResourceAttributes&);
+            RCSResourceAttributes& operator=(RCSResourceAttributes&&) noexcept;
 
             /**
              * Returns an {@link iterator} referring to the first element.
@@ -547,19 +598,12 @@ namespace OIC
 
         private:
             template< typename VISITOR >
-            void visit(VISITOR& visitor) const
-            {
-                KeyValueVisitorHelper< VISITOR > helper{ visitor };
+            void visit(VISITOR& visitor) const;
 
-                for (const auto& i : m_values)
-                {
-                    boost::variant< const std::string& > key{ i.first };
-                    boost::apply_visitor(helper, key, *i.second.m_data);
-                }
-            }
+            void reserve(size_t size);
 
         private:
-            std::unordered_map< std::string, Value > m_values;
+            EntryTable* m_table;
 
             //! @cond
             friend class ResourceAttributesConverter;
@@ -620,6 +664,108 @@ namespace OIC
         };
 
         template < typename T > constexpr int RCSResourceAttributes::IndexOfType< T >::value;
+
+        struct RCSResourceAttributes::Value::SharedData
+        {
+            template< typename T >
+            explicit SharedData(T&& value) :
+                    m_refs{ 1 },
+                    m_data{ std::forward< T >(value) }
+            {
+            }
+
+            SharedData(const SharedData&) = delete;
+            SharedData& operator=(const SharedData&) = delete;
+
+            std::atomic< int > m_refs;
+            ValueVariant m_data;
+        };
+
+        template< typename T, typename >
+        RCSResourceAttributes::Value::Value(T&& value) :
+                m_storage(),
+                m_which{ IndexOfType< typename std::decay< T >::type >::value },
+                m_leaked{ false }
+        {
+            construct(std::forward< T >(value), IsInlined< typename std::decay< T >::type >{ });
+        }
+
+        template< typename T >
+        void RCSResourceAttributes::Value::construct(T&& value, std::true_type)
+        {
+            data< typename std::decay< T >::type >(std::true_type{ }) = value;
+        }
+
+        template< typename T >
+        void RCSResourceAttributes::Value::construct(T&& value, std::false_type)
+        {
+            m_storage.m_shared = new SharedData{ std::forward< T >(value) };
+        }
+
+        template< typename T >
+        T& RCSResourceAttributes::Value::data(std::true_type) const
+        {
+            return *reinterpret_cast< T* >(const_cast< Storage* >(&m_storage));
+        }
+
+        template< typename T >
+        T& RCSResourceAttributes::Value::data(std::false_type) const
+        {
+            return boost::get< T >(m_storage.m_shared->m_data);
+        }
+
+        template< typename T, typename >
+        const T& RCSResourceAttributes::Value::checkedGet() const
+        {
+            if (m_which != IndexOfType< T >::value)
+            {
+                throw RCSBadGetException{ "Wrong type" };
+            }
+
+            return data< T >(IsInlined< T >{ });
+        }
+
+        template< typename T, typename >
+        T& RCSResourceAttributes::Value::checkedGet()
+        {
+            if (m_which != IndexOfType< T >::value)
+            {
+                throw RCSBadGetException{ "Wrong type" };
+            }
+
+            if (!IsInlined< T >::value)
+            {
+                detach();
+            }
+
+            return data< T >(IsInlined< T >{ });
+        }
+
+        template< typename VISITOR >
+        void RCSResourceAttributes::Value::visit(const std::string& key, VISITOR& visitor) const
+        {
+            switch (m_which)
+            {
+                case IndexOfType< std::nullptr_t >::value:
+                    return visitor(key, m_storage.m_null);
+
+                case IndexOfType< int >::value:
+                    return visitor(key, m_storage.m_int);
+
+                case IndexOfType< double >::value:
+                    return visitor(key, m_storage.m_double);
+
+                case IndexOfType< bool >::value:
+                    return visitor(key, m_storage.m_bool);
+
+                default:
+                {
+                    KeyValueVisitorHelper< VISITOR > helper{ visitor };
+                    boost::variant< const std::string& > keyVariant{ key };
+                    boost::apply_visitor(helper, keyVariant, m_storage.m_shared->m_data);
+                }
+            }
+        }
         //! @endcond
 
         /**
@@ -784,7 +930,7 @@ namespace OIC
                 public std::iterator< std::forward_iterator_tag, RCSResourceAttributes::KeyValuePair >
         {
         private:
-            typedef std::unordered_map< std::string, Value >::iterator base_iterator;
+            typedef EntryPosition< EntryChunk > base_iterator;
 
         public:
             iterator();
@@ -826,7 +972,7 @@ namespace OIC
                                        const RCSResourceAttributes::KeyValuePair >
         {
         private:
-            typedef std::unordered_map< std::string, Value >::const_iterator base_iterator;
+            typedef EntryPosition< const EntryChunk > base_iterator;
 
         public:
             const_iterator();
@@ -857,6 +1003,17 @@ namespace OIC
             //! @endcond
         };
 
+        //! @cond
+        template< typename VISITOR >
+        void RCSResourceAttributes::visit(VISITOR& visitor) const
+        {
+            for (const auto& kv : *this)
+            {
+                kv.value().visit(kv.key(), visitor);
+            }
+        }
+        //! @endcond
+
     }
 }
 
@@ -27,8 +27,11 @@
 #define SERVER_RCSRESOURCEOBJECT_H
 
 #include <string>
+#include <chrono>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <unordered_set>
 
 #include <RCSResourceAttributes.h>
 #include <RCSResponse.h>
@@ -59,6 +62,8 @@ namespace OIC
         //! @cond
         template < typename T >
         class AtomicWrapper;
+
+        class ExpiryTimer;
         //! @endcond
 
         /**
@@ -74,8 +79,14 @@ namespace OIC
          * by a set request. In this case, add an AttributeUpdatedListener with a key interested
          * in instead of overriding SetRequestHandler.
          * </p>
+         * <p>
+         * Changed attributes are tracked between notifications. Observers that register with
+         * the query parameter "delta" (e.g. "/a/light?delta=1") are notified of the changed
+         * attributes only, unless an attribute was removed; the others always receive all of
+         * them. The get request handler is not invoked for such partial notifications.
+         * </p>
          */
-        class RCSResourceObject
+        class RCSResourceObject : public std::enable_shared_from_this< RCSResourceObject >
         {
             private:
                 class WeakGuard;
@@ -290,8 +301,7 @@ namespace OIC
                 template< typename T >
                 T getAttribute(const std::string& key) const
                 {
-                    WeakGuard lock(*this);
-                    return m_resourceAttributes.at(key).get< T >();
+                    return getAttributeValue(key).get< T >();
                 }
 
                 /**
@@ -343,6 +353,16 @@ namespace OIC
                  */
                 const RCSResourceAttributes& getAttributes() const;
 
+                /**
+                 * Returns the attributes as of the last completed update.
+                 *
+                 * This doesn't need a LockGuard and never waits for one held by another thread.
+                 * Changes made under a LockGuard become visible when the guard is destroyed.
+                 *
+                 * @note Thread-safety is guaranteed for the attributes.
+                 */
+                std::shared_ptr< const RCSResourceAttributes > getAttributesSnapshot() const;
+
                 /**
                  * Checks whether the resource is observable or not.
                  */
@@ -408,6 +428,9 @@ namespace OIC
                 /**
                  * Notifies all observers of the current attributes.
                  *
+                 * Changes waiting for an auto notification are included, so they are not sent
+                 * again.
+                 *
                  * @throws RCSPlatformException If the operation failed.
                  */
                 virtual void notify() const;
@@ -426,6 +449,23 @@ namespace OIC
                  */
                 AutoNotifyPolicy getAutoNotifyPolicy() const;
 
+                /**
+                 * Batches auto notifications.
+                 *
+                 * A change is held back for up to @a interval and sent in one notification
+                 * together with the changes that follow it, or sooner once
+                 * @a maxChangedAttributes attributes have changed.
+                 * An interval of zero, the default, notifies on every change.
+                 *
+                 * @param interval the longest time a change is held back
+                 * @param maxChangedAttributes the number of changed attributes which sends the
+                 *        notification at once, or 0 for no limit
+                 *
+                 * @see setAutoNotifyPolicy
+                 */
+                void setAutoNotifyInterval(std::chrono::milliseconds interval,
+                        size_t maxChangedAttributes = 0);
+
                 /**
                  * Sets the policy for handling a set request.
                  *
@@ -459,8 +499,18 @@ namespace OIC
             void autoNotify(bool, AutoNotifyPolicy) const;
             void autoNotify(bool) const;
 
+            void scheduleAutoNotify() const;
+            void sendAutoNotification() const;
+            void sendNotification() const;
+
+            bool isPartialNotification(const OC::OCResourceRequest&) const;
+
             bool testValueUpdated(const std::string&, const RCSResourceAttributes::Value&) const;
 
+            void recordChange(const std::string&) const;
+            bool collectChanges() const;
+            void publishSnapshot() const;
+
             template< typename K, typename V >
             void setAttributeInternal(K&&, V&&);
 
@@ -487,6 +537,23 @@ namespace OIC
 
             std::mutex m_mutexAttributeUpdatedListeners;
 
+            mutable std::shared_ptr< const RCSResourceAttributes > m_snapshot;
+            mutable std::mutex m_mutexSnapshot;
+
+            mutable std::unordered_set< std::string > m_changedKeys;
+            mutable size_t m_changeCount;
+            mutable bool m_attributesExposed;
+
+            std::chrono::milliseconds m_autoNotifyInterval;
+            size_t m_autoNotifyMaxChanges;
+            mutable bool m_autoNotifyPending;
+            mutable bool m_autoNotifyScheduled;
+            mutable std::unique_ptr< ExpiryTimer > m_autoNotifyTimer;
+
+            mutable RCSResourceAttributes m_notifyingChanges;
+            mutable std::unique_ptr< AtomicThreadId > m_notifyingThread;
+            mutable std::mutex m_mutexNotifyingChanges;
+
         };
 
         /**
@@ -496,7 +563,8 @@ namespace OIC
          * object was created, the LockGuard is destructed and the attributes is unlocked.
          *
          * Additionally when this is destructed, it tries to notify depending on AutoNotifyPolicy
-         * of the RCSResourceObject.
+         * of the RCSResourceObject. All the changes made while it is held are sent in a single
+         * notification.
          */
         class RCSResourceObject::LockGuard
         {
@@ -537,7 +605,7 @@ namespace OIC
 
             bool m_isOwningLock;
 
-            std::function<void()> m_autoNotifyFunc;
+            size_t m_changeCount;
         };
 
         //! @cond
@@ -62,7 +62,7 @@ namespace OIC
 
             if (task->isExecuted()) return false;
 
-            return ExpiryTimerImpl::getInstance()->cancel(id);
+            return ExpiryTimerImpl::getInstance()->cancel(task);
         }
 
         void ExpiryTimer::cancelAll()
@@ -20,6 +20,9 @@
 
 #include "ExpiryTimerImpl.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "RCSException.h"
 
 namespace OIC
@@ -30,17 +33,41 @@ namespace OIC
         namespace
         {
             constexpr ExpiryTimerImpl::Id INVALID_ID{ 0U };
+
+            // cancelled tasks are left in the wheel until there are at least this many.
+            constexpr long PURGE_THRESHOLD{ 1024 };
+
+            // expired tasks are split over the executors in batches of at least this size.
+            constexpr size_t MIN_BATCH_SIZE{ 64 };
         }
 
+        constexpr size_t ExpiryTimerImpl::NUM_OF_EXECUTORS;
+        constexpr size_t ExpiryTimerImpl::WHEEL_BITS;
+        constexpr size_t ExpiryTimerImpl::WHEEL_SIZE;
+        constexpr size_t ExpiryTimerImpl::WHEEL_LEVELS;
+        constexpr size_t ExpiryTimerImpl::INDEX_SHARDS;
+
         ExpiryTimerImpl::ExpiryTimerImpl() :
-                m_tasks{ },
+                m_epoch{ std::chrono::steady_clock::now() },
+                m_tick{ 0 },
+                m_nextWakeUp{ std::numeric_limits< Tick >::max() },
+                m_numOfTasks{ 0 },
+                m_numOfCancelled{ 0 },
                 m_thread{ },
                 m_mutex{ },
                 m_cond{ },
                 m_stop{ false },
-                m_mt{ std::random_device{ }() },
-                m_dist{ }
+                m_nextId{ INVALID_ID + 1 },
+                m_executors{ },
+                m_executorMutex{ },
+                m_executorCond{ },
+                m_batches{ },
+                m_executorStop{ false }
         {
+            for (size_t i = 0; i < NUM_OF_EXECUTORS; ++i)
+            {
+                m_executors.push_back(std::thread(&ExpiryTimerImpl::runExecutor, this));
+            }
             m_thread = std::thread(&ExpiryTimerImpl::run, this);
         }
 
@@ -48,11 +75,29 @@ namespace OIC
         {
             {
                 std::lock_guard< std::mutex > lock{ m_mutex };
-                m_tasks.clear();
+                for (auto& level : m_wheel)
+                {
+                    for (auto& slot : level)
+                    {
+                        slot.clear();
+                    }
+                }
+                m_numOfTasks = 0;
                 m_stop = true;
             }
             m_cond.notify_all();
             m_thread.join();
+
+            {
+                std::lock_guard< std::mutex > lock{ m_executorMutex };
+                m_batches.clear();
+                m_executorStop = true;
+            }
+            m_executorCond.notify_all();
+            for (auto& executor : m_executors)
+            {
+                executor.join();
+            }
         }
 
         ExpiryTimerImpl* ExpiryTimerImpl::getInstance()
@@ -73,150 +118,388 @@ namespace OIC
                 throw RCSInvalidParameterException{ "callback is empty." };
             }
 
-            return addTask(convertToTime(Milliseconds{ delay }), std::move(cb), generateId());
+            return addTask(now() + delay, std::move(cb), generateId());
         }
 
         bool ExpiryTimerImpl::cancel(Id id)
         {
             if (id == INVALID_ID) return false;
 
-            std::lock_guard< std::mutex > lock{ m_mutex };
+            std::shared_ptr< TimerTask > task;
+            {
+                IndexShard& shard = shardOf(id);
+                std::lock_guard< std::mutex > lock{ shard.mutex };
+
+                auto it = shard.tasks.find(id);
+                if (it == shard.tasks.end()) return false;
+
+                task = it->second;
+            }
+
+            return cancel(task);
+        }
+
+        bool ExpiryTimerImpl::cancel(const std::shared_ptr< TimerTask >& task)
+        {
+            if (!task) return false;
 
-            for(auto it = m_tasks.begin(); it != m_tasks.end(); ++it)
+            ++m_numOfCancelled;
+            if (!task->cancel())
             {
-                if(it->second->getId() == id)
-                {
-                    m_tasks.erase(it);
-                    return true;
-                }
+                --m_numOfCancelled;
+                return false;
             }
-            return false;
+
+            removeFromIndex(task->getId());
+            return true;
         }
 
         size_t ExpiryTimerImpl::cancelAll(
                 const std::unordered_set< std::shared_ptr<TimerTask > >& tasks)
         {
-            std::lock_guard< std::mutex > lock{ m_mutex };
             size_t erased { 0 };
 
-            for(auto it = m_tasks.begin(); it != m_tasks.end();)
+            for (const auto& task : tasks)
             {
-                if(tasks.count(it->second))
+                if (cancel(task))
                 {
-                    it = m_tasks.erase(it);
                     ++erased;
                 }
-                else
-                {
-                    ++it;
-                }
             }
             return erased;
         }
 
-        ExpiryTimerImpl::Milliseconds ExpiryTimerImpl::convertToTime(Milliseconds delay)
+        ExpiryTimerImpl::Tick ExpiryTimerImpl::now() const
         {
-            const auto now = std::chrono::system_clock::now();
-            return std::chrono::duration_cast< Milliseconds >(now.time_since_epoch()) + delay;
+            return std::chrono::duration_cast< Milliseconds >(
+                    std::chrono::steady_clock::now() - m_epoch).count();
         }
 
-        std::shared_ptr< TimerTask > ExpiryTimerImpl::addTask(
-                Milliseconds delay, Callback cb, Id id)
+        std::shared_ptr< TimerTask > ExpiryTimerImpl::addTask(Tick expiry, Callback cb, Id id)
         {
-            std::lock_guard< std::mutex > lock{ m_mutex };
-
             auto newTask = std::make_shared< TimerTask >(id, std::move(cb));
-            m_tasks.insert({ delay, newTask });
-            m_cond.notify_all();
+            newTask->m_expiry = expiry;
+
+            {
+                IndexShard& shard = shardOf(id);
+                std::lock_guard< std::mutex > lock{ shard.mutex };
+                shard.tasks[id] = newTask;
+            }
+
+            bool wakeUp{ false };
+            {
+                std::lock_guard< std::mutex > lock{ m_mutex };
+
+                if (m_numOfTasks == 0)
+                {
+                    m_tick = std::max(m_tick, now());
+                }
+                insert(newTask);
+
+                wakeUp = expiry < m_nextWakeUp;
+            }
+
+            if (wakeUp)
+            {
+                m_cond.notify_one();
+            }
 
             return newTask;
         }
 
-        bool ExpiryTimerImpl::containsId(Id id) const
+        ExpiryTimerImpl::Id ExpiryTimerImpl::generateId()
         {
-            for (const auto& info : m_tasks)
+            Id newId = m_nextId++;
+
+            while (newId == INVALID_ID)
             {
-                if (info.second->getId() == id) return true;
+                newId = m_nextId++;
             }
-            return false;
+            return newId;
         }
 
-        ExpiryTimerImpl::Id ExpiryTimerImpl::generateId()
+        ExpiryTimerImpl::IndexShard& ExpiryTimerImpl::shardOf(Id id)
         {
-            Id newId = m_dist(m_mt);
+            return m_index[id % INDEX_SHARDS];
+        }
 
-            std::lock_guard< std::mutex > lock{ m_mutex };
+        void ExpiryTimerImpl::removeFromIndex(Id id)
+        {
+            IndexShard& shard = shardOf(id);
+            std::lock_guard< std::mutex > lock{ shard.mutex };
+            shard.tasks.erase(id);
+        }
 
-            while (newId == INVALID_ID || containsId(newId))
+        void ExpiryTimerImpl::insert(std::shared_ptr< TimerTask > task)
+        {
+            Tick expiry = std::max< Tick >(task->m_expiry, m_tick);
+            Tick delta = expiry - m_tick;
+
+            size_t level = 0;
+            while (level + 1 < WHEEL_LEVELS && delta >> (WHEEL_BITS * (level + 1)))
             {
-                newId = m_dist(m_mt);
+                ++level;
             }
-            return newId;
+
+            // Tasks further out than the wheel spans wait in the last slot of the top
+            // level and are re-inserted with their real expiry when it is cascaded.
+            if (delta >> (WHEEL_BITS * WHEEL_LEVELS))
+            {
+                expiry = m_tick + (Tick{ 1 } << (WHEEL_BITS * WHEEL_LEVELS)) - 1;
+            }
+
+            size_t slot = (expiry >> (WHEEL_BITS * level)) & (WHEEL_SIZE - 1);
+            m_wheel[level][slot].push_back(std::move(task));
+            ++m_numOfTasks;
+        }
+
+        void ExpiryTimerImpl::cascade(size_t level)
+        {
+            Tasks tasks;
+            tasks.swap(m_wheel[level][(m_tick >> (WHEEL_BITS * level)) & (WHEEL_SIZE - 1)]);
+            m_numOfTasks -= tasks.size();
+
+            for (auto& task : tasks)
+            {
+                if (task->isCancelled())
+                {
+                    --m_numOfCancelled;
+                }
+                else
+                {
+                    insert(std::move(task));
+                }
+            }
+        }
+
+        ExpiryTimerImpl::Tick ExpiryTimerImpl::nextEventTick() const
+        {
+            Tick next = std::numeric_limits< Tick >::max();
+
+            for (size_t i = 0; i < WHEEL_SIZE; ++i)
+            {
+                if (!m_wheel[0][(m_tick + i) & (WHEEL_SIZE - 1)].empty())
+                {
+                    next = m_tick + i;
+                    break;
+                }
+            }
+
+            for (size_t level = 1; level < WHEEL_LEVELS; ++level)
+            {
+                const size_t shift = WHEEL_BITS * level;
+                const Tick base = m_tick >> shift;
+
+                // the current slot was already cascaded unless m_tick is on its boundary.
+                size_t i = (m_tick & ((Tick{ 1 } << shift) - 1)) ? 1 : 0;
+                for (; i <= WHEEL_SIZE && ((base + i) << shift) < next; ++i)
+                {
+                    if (!m_wheel[level][(base + i) & (WHEEL_SIZE - 1)].empty())
+                    {
+                        next = (base + i) << shift;
+                        break;
+                    }
+                }
+            }
+
+            return next;
         }
 
-        void ExpiryTimerImpl::executeExpired()
+        void ExpiryTimerImpl::advance(Tick current, Tasks& expired)
         {
-            if (m_tasks.empty()) return;
+            while (m_numOfTasks > 0)
+            {
+                Tick next = nextEventTick();
+                if (next > current) break;
+
+                m_tick = next;
+
+                for (size_t level = 1; level < WHEEL_LEVELS
+                        && (m_tick & ((Tick{ 1 } << (WHEEL_BITS * level)) - 1)) == 0; ++level)
+                {
+                    cascade(level);
+                }
+
+                Tasks& slot = m_wheel[0][m_tick & (WHEEL_SIZE - 1)];
+                m_numOfTasks -= slot.size();
+                for (auto& task : slot)
+                {
+                    if (task->isCancelled())
+                    {
+                        --m_numOfCancelled;
+                    }
+                    else
+                    {
+                        expired.push_back(std::move(task));
+                    }
+                }
+                slot.clear();
 
-            auto now = std::chrono::system_clock::now().time_since_epoch();
+                ++m_tick;
+            }
+
+            // nothing is due up to current, so the ticks in between can be skipped.
+            m_tick = std::max(m_tick, current + 1);
+        }
 
-            auto it = m_tasks.begin();
-            for (; it != m_tasks.end() && it->first <= now; ++it)
+        void ExpiryTimerImpl::purgeCancelled()
+        {
+            long cancelled = m_numOfCancelled;
+            if (cancelled < PURGE_THRESHOLD || static_cast< size_t >(cancelled) * 2 < m_numOfTasks)
             {
-                it->second->execute();
+                return;
             }
 
-            m_tasks.erase(m_tasks.begin(), it);
+            auto isCancelled = [](const std::shared_ptr< TimerTask >& task)
+            {
+                return task->isCancelled();
+            };
+
+            for (auto& level : m_wheel)
+            {
+                for (auto& slot : level)
+                {
+                    auto it = std::remove_if(slot.begin(), slot.end(), isCancelled);
+                    size_t removed = slot.end() - it;
+
+                    slot.erase(it, slot.end());
+                    m_numOfTasks -= removed;
+                    m_numOfCancelled -= static_cast< long >(removed);
+                }
+            }
         }
 
-        ExpiryTimerImpl::Milliseconds ExpiryTimerImpl::remainingTimeForNext() const
+        void ExpiryTimerImpl::dispatch(Tasks&& expired)
         {
-            const Milliseconds& expiredTime = m_tasks.begin()->first;
+            const size_t numOfBatches = std::min(NUM_OF_EXECUTORS,
+                    (expired.size() + MIN_BATCH_SIZE - 1) / MIN_BATCH_SIZE);
 
-            return std::chrono::duration_cast< Milliseconds >(expiredTime -
-                    std::chrono::system_clock::now().time_since_epoch()) + Milliseconds{ 1 };
+            {
+                std::lock_guard< std::mutex > lock{ m_executorMutex };
+
+                if (numOfBatches <= 1)
+                {
+                    m_batches.push_back(std::move(expired));
+                }
+                else
+                {
+                    const size_t batchSize = (expired.size() + numOfBatches - 1) / numOfBatches;
+                    for (size_t begin = 0; begin < expired.size(); begin += batchSize)
+                    {
+                        auto first = expired.begin() + begin;
+                        auto last = expired.begin() + std::min(begin + batchSize, expired.size());
+                        m_batches.push_back(Tasks(std::make_move_iterator(first),
+                                                  std::make_move_iterator(last)));
+                    }
+                }
+            }
+
+            if (numOfBatches <= 1)
+            {
+                m_executorCond.notify_one();
+            }
+            else
+            {
+                m_executorCond.notify_all();
+            }
         }
 
         void ExpiryTimerImpl::run()
         {
-            auto hasTaskOrStop = [this](){ return !m_tasks.empty() || m_stop; };
-
             std::unique_lock< std::mutex > lock{ m_mutex };
 
-            while(!m_stop)
+            while (!m_stop)
             {
-                m_cond.wait(lock, hasTaskOrStop);
+                Tasks expired;
+                advance(now(), expired);
+                purgeCancelled();
 
-                if (m_stop) break;
+                if (!expired.empty())
+                {
+                    dispatch(std::move(expired));
+                }
 
-                m_cond.wait_for(lock, remainingTimeForNext());
+                if (m_numOfTasks == 0)
+                {
+                    m_nextWakeUp = std::numeric_limits< Tick >::max();
+                    m_cond.wait(lock);
+                }
+                else
+                {
+                    m_nextWakeUp = nextEventTick();
+                    m_cond.wait_until(lock, m_epoch + Milliseconds(
+                            static_cast< Milliseconds::rep >(m_nextWakeUp)));
+                }
+            }
+        }
 
-                executeExpired();
+        void ExpiryTimerImpl::runExecutor()
+        {
+            std::unique_lock< std::mutex > lock{ m_executorMutex };
+
+            while (true)
+            {
+                m_executorCond.wait(lock, [this](){ return m_executorStop || !m_batches.empty(); });
+
+                if (m_executorStop) break;
+
+                Tasks batch{ std::move(m_batches.front()) };
+                m_batches.pop_front();
+                lock.unlock();
+
+                for (auto& task : batch)
+                {
+                    removeFromIndex(task->getId());
+
+                    if (!task->execute())
+                    {
+                        --m_numOfCancelled;
+                    }
+                }
+
+                batch.clear();
+                lock.lock();
             }
         }
 
 
         TimerTask::TimerTask(ExpiryTimerImpl::Id id, ExpiryTimerImpl::Callback cb) :
             m_id{ id },
+            m_expiry{ 0 },
+            m_state{ State::PENDING },
             m_callback{ std::move(cb) }
         {
         }
 
-        void TimerTask::execute()
+        bool TimerTask::execute()
         {
-            if (isExecuted()) return;
+            State expected{ State::PENDING };
+            if (!m_state.compare_exchange_strong(expected, State::EXECUTED)) return false;
+
+            ExpiryTimerImpl::Callback callback{ std::move(m_callback) };
+            m_callback = ExpiryTimerImpl::Callback{ };
 
-            ExpiryTimerImpl::Id id { m_id };
-            m_id = INVALID_ID;
+            callback(m_id);
+            return true;
+        }
 
-            std::thread(std::move(m_callback), id).detach();
+        bool TimerTask::cancel()
+        {
+            State expected{ State::PENDING };
+            if (!m_state.compare_exchange_strong(expected, State::CANCELLED)) return false;
 
             m_callback = ExpiryTimerImpl::Callback{ };
+            return true;
+        }
+
+        bool TimerTask::isCancelled() const
+        {
+            return m_state == State::CANCELLED;
         }
 
         bool TimerTask::isExecuted() const
         {
-            return m_id == INVALID_ID;
+            return m_state != State::PENDING;
         }
 
         ExpiryTimerImpl::Id TimerTask::getId() const
@@ -22,14 +22,16 @@
 #define _EXPIRY_TIMER_IMPL_H_
 
 #include <functional>
-#include <map>
 #include <mutex>
 #include <thread>
 #include <chrono>
 #include <condition_variable>
-#include <random>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
+#include <deque>
 #include <atomic>
+#include <memory>
 
 namespace OIC
 {
@@ -37,6 +39,14 @@ namespace OIC
     {
         class TimerTask;
 
+        /**
+         * Timer service shared by every ExpiryTimer.
+         *
+         * Tasks are kept in a hierarchical timer wheel driven by a single thread, and the
+         * tasks that expire together are handed as one batch to a small, fixed set of
+         * executor threads.  Cancelling only marks the task, so it does not contend with
+         * the wheel; cancelled tasks are dropped when their slot comes up.
+         */
         class ExpiryTimerImpl
         {
         public:
@@ -45,8 +55,26 @@ namespace OIC
 
             typedef long long DelayInMillis;
 
+            /**
+             * Number of threads the timer service runs callbacks on.
+             */
+            static constexpr size_t NUM_OF_EXECUTORS{ 4 };
+
         private:
             typedef std::chrono::milliseconds Milliseconds;
+            typedef unsigned long long Tick;
+            typedef std::vector< std::shared_ptr< TimerTask > > Tasks;
+
+            static constexpr size_t WHEEL_BITS{ 6 };
+            static constexpr size_t WHEEL_SIZE{ 1 << WHEEL_BITS };
+            static constexpr size_t WHEEL_LEVELS{ 4 };
+            static constexpr size_t INDEX_SHARDS{ 16 };
+
+            struct IndexShard
+            {
+                std::mutex mutex;
+                std::unordered_map< Id, std::shared_ptr< TimerTask > > tasks;
+            };
 
         private:
             ExpiryTimerImpl();
@@ -61,42 +89,76 @@ namespace OIC
             std::shared_ptr< TimerTask > post(DelayInMillis, Callback);
 
             bool cancel(Id);
+            bool cancel(const std::shared_ptr< TimerTask >&);
             size_t cancelAll(const std::unordered_set< std::shared_ptr<TimerTask > >&);
 
         private:
-            static Milliseconds convertToTime(Milliseconds);
+            Tick now() const;
 
-            std::shared_ptr< TimerTask > addTask(Milliseconds, Callback, Id);
+            std::shared_ptr< TimerTask > addTask(Tick, Callback, Id);
+            Id generateId();
+
+            IndexShard& shardOf(Id);
+            void removeFromIndex(Id);
 
             /**
              * @pre The lock must be acquired with m_mutex.
              */
-            bool containsId(Id) const;
-            Id generateId();
+            void insert(std::shared_ptr< TimerTask >);
+
+            /**
+             * @pre The lock must be acquired with m_mutex.
+             */
+            void cascade(size_t level);
 
             /**
+             * Returns the first tick at or after m_tick that expires tasks or needs a
+             * cascade.
+             *
              * @pre The lock must be acquired with m_mutex.
              */
-            void executeExpired();
+            Tick nextEventTick() const;
 
             /**
+             * Moves the wheel up to the current time, collecting the expired tasks.
+             *
              * @pre The lock must be acquired with m_mutex.
              */
-            Milliseconds remainingTimeForNext() const;
+            void advance(Tick, Tasks&);
+
+            /**
+             * Drops cancelled tasks from the wheel once they make up most of it.
+             *
+             * @pre The lock must be acquired with m_mutex.
+             */
+            void purgeCancelled();
 
             void run();
+            void dispatch(Tasks&&);
+            void runExecutor();
 
         private:
-            std::multimap< Milliseconds, std::shared_ptr< TimerTask > > m_tasks;
+            const std::chrono::steady_clock::time_point m_epoch;
+
+            Tasks m_wheel[WHEEL_LEVELS][WHEEL_SIZE];
+            Tick m_tick;
+            Tick m_nextWakeUp;
+            size_t m_numOfTasks;
+            std::atomic< long > m_numOfCancelled;
 
             std::thread m_thread;
             std::mutex m_mutex;
             std::condition_variable m_cond;
             bool m_stop;
 
-            std::mt19937 m_mt;
-            std::uniform_int_distribution< Id > m_dist;
+            std::atomic< Id > m_nextId;
+            IndexShard m_index[INDEX_SHARDS];
 
+            std::vector< std::thread > m_executors;
+            std::mutex m_executorMutex;
+            std::condition_variable m_executorCond;
+            std::deque< Tasks > m_batches;
+            bool m_executorStop;
         };
 
         class TimerTask
@@ -114,10 +176,21 @@ namespace OIC
             ExpiryTimerImpl::Id getId() const;
 
         private:
-            void execute();
+            enum class State
+            {
+                PENDING,
+                EXECUTED,
+                CANCELLED
+            };
+
+            bool execute();
+            bool cancel();
+            bool isCancelled() const;
 
         private:
-            std::atomic< ExpiryTimerImpl::Id > m_id;
+            const ExpiryTimerImpl::Id m_id;
+            unsigned long long m_expiry;
+            std::atomic< State > m_state;
             ExpiryTimerImpl::Callback m_callback;
 
             friend class ExpiryTimerImpl;
@@ -19,9 +19,15 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include <UnitTestHelper.h>
+#include <ThreadCount.h>
 
 #include <mutex>
 #include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
 
 #include "RCSException.h"
 #include "ExpiryTimer.h"
@@ -145,6 +151,29 @@ TEST_F(ExpiryTimerImplTest, CancelReturnsFalseIfAlreadyExecuted)
     ASSERT_FALSE(ExpiryTimerImpl::getInstance()->cancel(id));
 }
 
+TEST_F(ExpiryTimerImplTest, CallbackBeInvokedWithinToleranceAfterCascade)
+{
+    std::atomic_int called{ 0 };
+    FunctionObject* functor = mocks.Mock< FunctionObject >();
+
+    mocks.ExpectCall(functor, FunctionObject::execute).Do(
+            [this, &called](ExpiryTimerImpl::Id){
+                ++called;
+                Proceed();
+            }
+    );
+
+    // longer than the first level of the wheel, so the task has to be cascaded down.
+    ExpiryTimerImpl::getInstance()->post(300,
+            std::bind(&FunctionObject::execute, functor, std::placeholders::_1));
+
+    Wait(200);
+    ASSERT_EQ(0, called);
+
+    Wait(100 + TOLERANCE_IN_MILLIS);
+    ASSERT_EQ(1, called);
+}
+
 TEST_F(ExpiryTimerImplTest, CallbackBeInvokedWithinToleranceWithMultiplePost)
 {
     constexpr int NUM_OF_POST{ 10000 };
@@ -330,3 +359,89 @@ TEST_F(ExpiryTimerTest, AllTasksAreCancelledAfterTimerDestroyed)
 
     Wait(200);
 }
+
+TEST(ExpiryTimerBenchmark, TenThousandCachesReporting)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    constexpr int NUM_OF_CACHES{ 10000 };
+    constexpr int NUM_OF_REPORTS{ 3 };
+    constexpr ExpiryTimer::DelayInMilliSec REPORT_MILLITIME{ 100 };
+    constexpr ExpiryTimer::DelayInMilliSec EXPIRED_MILLITIME{ 150 };
+
+    // Does what a DataCache in polling mode does on every report: re-arm the network
+    // timeout and post the next polling timer.
+    struct Cache
+    {
+        ExpiryTimer networkTimer;
+        ExpiryTimer pollingTimer;
+        ExpiryTimer::Id networkHandle;
+        Clock::time_point due;
+        int reports;
+    };
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    int reported{ 0 };
+    long long totalJitter{ 0 };
+    long long maxJitter{ 0 };
+
+    std::vector< std::unique_ptr< Cache > > caches;
+    std::function< void(Cache*) > report;
+    report = [&](Cache* cache)
+    {
+        cache->networkTimer.cancel(cache->networkHandle);
+        cache->networkHandle = cache->networkTimer.post(EXPIRED_MILLITIME, [](ExpiryTimer::Id){});
+
+        cache->due = Clock::now() + std::chrono::milliseconds{ REPORT_MILLITIME };
+        cache->pollingTimer.post(REPORT_MILLITIME, [&, cache](ExpiryTimer::Id)
+        {
+            long long jitter = std::chrono::duration_cast< std::chrono::milliseconds >(
+                    Clock::now() - cache->due).count();
+
+            if (++cache->reports < NUM_OF_REPORTS) report(cache);
+
+            // the cache may be gone as soon as the last report is counted.
+            std::lock_guard< std::mutex > lock{ mutex };
+            totalJitter += jitter;
+            maxJitter = std::max(maxJitter, jitter);
+            ++reported;
+            cond.notify_all();
+        });
+    };
+
+    const int threadsBefore = getProcessThreadCount();
+    std::atomic_bool sampling{ true };
+    int maxThreads{ threadsBefore };
+    std::thread sampler([&]()
+    {
+        while (sampling)
+        {
+            maxThreads = std::max(maxThreads, getProcessThreadCount());
+            std::this_thread::sleep_for(std::chrono::milliseconds{ 5 });
+        }
+    });
+
+    for (int i = 0; i < NUM_OF_CACHES; ++i)
+    {
+        caches.emplace_back(new Cache{ });
+        report(caches.back().get());
+    }
+
+    {
+        std::unique_lock< std::mutex > lock{ mutex };
+        cond.wait_for(lock, std::chrono::seconds{ 10 },
+                [&](){ return reported == NUM_OF_CACHES * NUM_OF_REPORTS; });
+    }
+
+    sampling = false;
+    sampler.join();
+
+    ASSERT_EQ(NUM_OF_CACHES * NUM_OF_REPORTS, reported);
+
+    // the sampler itself is one of the extra threads.
+    printf("[          ] %d caches x %d reports: %d extra threads at peak, "
+            "jitter %.3f ms average, %lld ms max\n", NUM_OF_CACHES, NUM_OF_REPORTS,
+            maxThreads - threadsBefore - 1, static_cast< double >(totalJitter) / reported,
+            maxJitter);
+}
@@ -104,9 +104,8 @@ namespace OIC
             class ResourceAttributesBuilder
             {
             private:
-                template < int DEPTH >
-                void insertItem(Detail::Int2Type< DEPTH >,
-                        const OC::OCRepresentation::AttributeItem& item)
+                template< int DEPTH, typename ITEM >
+                void insertItem(Detail::Int2Type< DEPTH >, ITEM& item)
                 {
                     switch (item.base_type()) {
                         case OC::AttributeType::Null:
@@ -125,55 +124,73 @@ namespace OIC
                             return insertItem< DEPTH, OC::AttributeType::String >(item);
 
                         case OC::AttributeType::OCRepresentation:
-                            return insertOcRep(Detail::Int2Type< DEPTH >{ }, item);
+                            return insertOcRepItem(Detail::Int2Type< DEPTH >{ }, item);
 
                         default:
                             assert("There must be no another base type!");
                     }
                 }
 
-                template< int DEPTH, OC::AttributeType BASE_TYPE >
-                void insertItem(const OC::OCRepresentation::AttributeItem& item)
+                template< int DEPTH, OC::AttributeType BASE_TYPE, typename ITEM >
+                void insertItem(ITEM& item)
                 {
                     typedef typename Detail::OCItemType< DEPTH, BASE_TYPE >::type ItemType;
-                    putValue(item.attrname(), item.getValue< ItemType >());
+                    putValue(item.attrname(), takeValue< ItemType >(item));
                 }
 
                 RCSResourceAttributes insertOcRep(Detail::Int2Type< 0 >,
-                        const OC::OCRepresentation& ocRep)
+                        OC::OCRepresentation&& ocRep)
                 {
-                    return ResourceAttributesConverter::fromOCRepresentation(ocRep);
+                    return ResourceAttributesConverter::fromOCRepresentation(std::move(ocRep));
                 }
 
                 template< int DEPTH, typename OCREPS,
                     typename ATTRS = typename Detail::SeqType< DEPTH, RCSResourceAttributes >::type >
-                ATTRS insertOcRep(Detail::Int2Type< DEPTH >, const OCREPS& ocRepVec)
+                ATTRS insertOcRep(Detail::Int2Type< DEPTH >, OCREPS&& ocRepVec)
                 {
                     ATTRS result;
+                    result.reserve(ocRepVec.size());
 
-                    for (const auto& nested : ocRepVec)
+                    for (auto& nested : ocRepVec)
                     {
-                        result.push_back(insertOcRep(Detail::Int2Type< DEPTH - 1 >{ }, nested));
+                        result.push_back(
+                                insertOcRep(Detail::Int2Type< DEPTH - 1 >{ }, std::move(nested)));
                     }
 
                     return result;
                 }
 
-                template< int DEPTH >
-                void insertOcRep(Detail::Int2Type< DEPTH >,
-                        const OC::OCRepresentation::AttributeItem& item)
+                template< int DEPTH, typename ITEM >
+                void insertOcRepItem(Detail::Int2Type< DEPTH >, ITEM& item)
                 {
                     typedef typename Detail::OCItemType< DEPTH,
                             OC::AttributeType::OCRepresentation >::type ItemType;
 
+                    // The value taken is ours, so nested representations are moved from.
                     putValue(item.attrname(),
-                            insertOcRep(Detail::Int2Type< DEPTH >{ }, item.getValue< ItemType >()));
+                            insertOcRep(Detail::Int2Type< DEPTH >{ }, takeValue< ItemType >(item)));
+                }
+
+                template< typename T >
+                static T takeValue(const OC::OCRepresentation::AttributeItem& item)
+                {
+                    return item.getValue< T >();
+                }
+
+                template< typename T >
+                static T takeValue(OC::OCRepresentation::AttributeItem& item)
+                {
+                    return item.moveValue< T >();
                 }
 
             public:
-                ResourceAttributesBuilder() = default;
+                explicit ResourceAttributesBuilder(size_t size)
+                {
+                    m_target.reserve(size);
+                }
 
-                void insertItem(const OC::OCRepresentation::AttributeItem& item)
+                template< typename ITEM >
+                void insertItem(ITEM& item)
                 {
                     switch (item.depth())
                     {
@@ -266,7 +283,7 @@ namespace OIC
             static RCSResourceAttributes fromOCRepresentation(
                     const OC::OCRepresentation& ocRepresentation)
             {
-                ResourceAttributesBuilder builder;
+                ResourceAttributesBuilder builder{ ocRepresentation.size() };
 
                 for (const auto& item : ocRepresentation)
                 {
@@ -276,6 +293,22 @@ namespace OIC
                 return builder.extract();
             }
 
+            /**
+             * Moves values out of @a ocRepresentation instead of copying them.
+             */
+            static RCSResourceAttributes fromOCRepresentation(
+                    OC::OCRepresentation&& ocRepresentation)
+            {
+                ResourceAttributesBuilder builder{ ocRepresentation.size() };
+
+                for (auto& item : ocRepresentation)
+                {
+                    builder.insertItem(item);
+                }
+
+                return builder.extract();
+            }
+
             static OC::OCRepresentation toOCRepresentation(
                     const RCSResourceAttributes& resourceAttributes)
             {
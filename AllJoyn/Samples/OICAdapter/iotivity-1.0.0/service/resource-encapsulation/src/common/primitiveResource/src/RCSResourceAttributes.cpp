@@ -23,6 +23,11 @@
 #include <ResourceAttributesUtils.h>
 #include <ResourceAttributesConverter.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <new>
+
 #include <boost/lexical_cast.hpp>
 #include <boost/mpl/advance.hpp>
 #include <boost/mpl/size.hpp>
@@ -76,24 +81,6 @@ namespace
         }
     };
 
-    class TypeVisitor: public boost::static_visitor< RCSResourceAttributes::Type >
-    {
-    public:
-        TypeVisitor() = default;
-        TypeVisitor(const TypeVisitor&) = delete;
-        TypeVisitor(TypeVisitor&&) = delete;
-
-        TypeVisitor& operator=(const TypeVisitor&) = delete;
-        TypeVisitor& operator=(TypeVisitor&&) = delete;
-
-        template< typename T >
-        RCSResourceAttributes::Type operator()(const T& value) const
-        {
-            return RCSResourceAttributes::Type::typeOf(value);
-        }
-
-    };
-
     template< int >
     struct Int2Type {};
 
@@ -211,6 +198,105 @@ namespace
         return typeInfos[which];
     }
 
+    constexpr size_t NUM_OF_KEY_SHARDS{ 16 };
+
+    // A key shared by every attributes that uses it.
+    // The hash is computed once, and equal keys are always the same object.
+    struct InternedKey
+    {
+        InternedKey(std::string&& str, size_t hash) :
+                m_str{ std::move(str) },
+                m_hash{ hash },
+                m_refs{ 1 }
+        {
+        }
+
+        const std::string m_str;
+        const size_t m_hash;
+        std::atomic< unsigned int > m_refs;
+    };
+
+    struct KeyShard
+    {
+        std::mutex m_mutex;
+        std::unordered_multimap< size_t, InternedKey* > m_keys;
+    };
+
+    KeyShard& getKeyShard(size_t hash)
+    {
+        // Never destroyed, attributes with static storage may outlive it otherwise.
+        static KeyShard* shards = new KeyShard[NUM_OF_KEY_SHARDS];
+
+        return shards[hash % NUM_OF_KEY_SHARDS];
+    }
+
+    inline size_t hashKey(const std::string& key)
+    {
+        return std::hash< std::string >{ }(key);
+    }
+
+    template< typename KEY >
+    InternedKey* internKey(KEY&& key, size_t hash)
+    {
+        KeyShard& shard = getKeyShard(hash);
+        std::lock_guard< std::mutex > lock{ shard.m_mutex };
+
+        auto range = shard.m_keys.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second->m_str == key)
+            {
+                // Taken under the lock, so it can't race with the last release.
+                it->second->m_refs.fetch_add(1, std::memory_order_relaxed);
+                return it->second;
+            }
+        }
+
+        std::unique_ptr< InternedKey > interned{
+            new InternedKey{ std::string(std::forward< KEY >(key)), hash } };
+        shard.m_keys.emplace(hash, interned.get());
+        return interned.release();
+    }
+
+    inline void acquireKey(InternedKey* key)
+    {
+        key->m_refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void releaseKey(InternedKey* key)
+    {
+        // Only a release under the lock may drop the last reference,
+        // otherwise the key could be handed out again while it is being deleted.
+        unsigned int refs = key->m_refs.load(std::memory_order_relaxed);
+        while (refs > 1)
+        {
+            if (key->m_refs.compare_exchange_weak(refs, refs - 1, std::memory_order_release,
+                    std::memory_order_relaxed))
+            {
+                return;
+            }
+        }
+
+        KeyShard& shard = getKeyShard(key->m_hash);
+        std::lock_guard< std::mutex > lock{ shard.m_mutex };
+
+        if (key->m_refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        {
+            return;
+        }
+
+        auto range = shard.m_keys.equal_range(key->m_hash);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second == key)
+            {
+                shard.m_keys.erase(it);
+                break;
+            }
+        }
+        delete key;
+    }
+
 } // unnamed namespace
 
 
@@ -219,6 +305,369 @@ namespace OIC
     namespace Service
     {
 
+        struct RCSResourceAttributes::Entry
+        {
+            Entry(InternedKey* key) noexcept :
+                    m_key{ key }
+            {
+            }
+
+            // nullptr once the entry is erased, until it is reused for another key.
+            InternedKey* m_key;
+            Value m_value;
+        };
+
+        struct RCSResourceAttributes::EntryChunk
+        {
+            EntryChunk* m_next;
+            Entry* m_entries;
+            uint32_t m_capacity;
+            uint32_t m_used;
+        };
+
+        /**
+         * Entries are never moved once inserted, so references to values stay valid
+         * until they are erased, as they would with a node based map.
+         *
+         * The first chunk is allocated together with the table. Small tables are
+         * searched linearly, larger ones get an open addressing index on top.
+         */
+        class RCSResourceAttributes::EntryTable
+        {
+        public:
+            static constexpr size_t MIN_CAPACITY{ 4 };
+            static constexpr size_t LINEAR_SEARCH_LIMIT{ 8 };
+
+            static EntryTable* create(size_t capacity)
+            {
+                capacity = std::max(capacity, MIN_CAPACITY);
+
+                void* mem = ::operator new(sizeof(EntryTable) + capacity * sizeof(Entry));
+                return new (mem) EntryTable{ capacity };
+            }
+
+            static EntryTable* copy(const EntryTable* from)
+            {
+                if (!from || from->m_size == 0)
+                {
+                    return nullptr;
+                }
+
+                EntryTable* table = create(from->m_size);
+                try
+                {
+                    for (auto pos = first(from); pos.m_chunk; pos = next(pos))
+                    {
+                        const Entry& entry = pos.m_chunk->m_entries[pos.m_index];
+
+                        Entry* copied = table->allocate();
+                        new (copied) Entry{ entry.m_key };
+                        acquireKey(entry.m_key);
+                        ++table->m_tail->m_used;
+                        ++table->m_size;
+
+                        copied->m_value = entry.m_value;
+                    }
+                    table->buildIndex();
+                }
+                catch (...)
+                {
+                    destroy(table);
+                    throw;
+                }
+                return table;
+            }
+
+            static void destroy(EntryTable* table) noexcept
+            {
+                if (!table)
+                {
+                    return;
+                }
+
+                for (EntryChunk* chunk = &table->m_head; chunk;)
+                {
+                    for (uint32_t i = 0; i < chunk->m_used; ++i)
+                    {
+                        Entry& entry = chunk->m_entries[i];
+                        if (entry.m_key)
+                        {
+                            releaseKey(entry.m_key);
+                        }
+                        entry.~Entry();
+                    }
+
+                    EntryChunk* next = chunk->m_next;
+                    if (chunk != &table->m_head)
+                    {
+                        ::operator delete(chunk);
+                    }
+                    chunk = next;
+                }
+
+                delete[] table->m_index;
+                table->~EntryTable();
+                ::operator delete(table);
+            }
+
+            template< typename CHUNK >
+            static EntryPosition< CHUNK > skipErased(EntryPosition< CHUNK > pos) noexcept
+            {
+                while (pos.m_chunk)
+                {
+                    if (pos.m_index == pos.m_chunk->m_used)
+                    {
+                        pos = EntryPosition< CHUNK >{ pos.m_chunk->m_next, 0 };
+                    }
+                    else if (pos.m_chunk->m_entries[pos.m_index].m_key)
+                    {
+                        return pos;
+                    }
+                    else
+                    {
+                        ++pos.m_index;
+                    }
+                }
+                return EntryPosition< CHUNK >{ nullptr, 0 };
+            }
+
+            static EntryPosition< EntryChunk > first(EntryTable* table) noexcept
+            {
+                if (!table)
+                {
+                    return EntryPosition< EntryChunk >{ nullptr, 0 };
+                }
+                return skipErased(EntryPosition< EntryChunk >{ &table->m_head, 0 });
+            }
+
+            static EntryPosition< const EntryChunk > first(const EntryTable* table) noexcept
+            {
+                if (!table)
+                {
+                    return EntryPosition< const EntryChunk >{ nullptr, 0 };
+                }
+                return skipErased(EntryPosition< const EntryChunk >{ &table->m_head, 0 });
+            }
+
+            template< typename CHUNK >
+            static EntryPosition< CHUNK > next(EntryPosition< CHUNK > pos) noexcept
+            {
+                ++pos.m_index;
+                return skipErased(pos);
+            }
+
+            template< typename CHUNK >
+            static Entry& entryAt(const EntryPosition< CHUNK >& pos) noexcept
+            {
+                return pos.m_chunk->m_entries[pos.m_index];
+            }
+
+            Entry* find(const std::string& key, size_t hash) const noexcept
+            {
+                return find(hash, [&key, hash](const InternedKey* entryKey)
+                {
+                    return entryKey->m_hash == hash && entryKey->m_str == key;
+                });
+            }
+
+            Entry* find(const InternedKey* key) const noexcept
+            {
+                return find(key->m_hash, [key](const InternedKey* entryKey)
+                {
+                    return entryKey == key;
+                });
+            }
+
+            template< typename KEY >
+            Entry& insert(KEY&& key, size_t hash)
+            {
+                Entry* entry = nullptr;
+
+                if (m_erased > 0)
+                {
+                    entry = findErased();
+                    entry->m_key = internKey(std::forward< KEY >(key), hash);
+                    --m_erased;
+                }
+                else
+                {
+                    entry = allocate();
+                    new (entry) Entry{ internKey(std::forward< KEY >(key), hash) };
+                    ++m_tail->m_used;
+                }
+                ++m_size;
+
+                addToIndex(entry);
+                return *entry;
+            }
+
+            void erase(Entry& entry) noexcept
+            {
+                // Stays in the index, lookups just skip it.
+                releaseKey(entry.m_key);
+                entry.m_key = nullptr;
+                entry.m_value = nullptr;
+
+                --m_size;
+                ++m_erased;
+            }
+
+            size_t size() const noexcept
+            {
+                return m_size;
+            }
+
+        private:
+            explicit EntryTable(size_t capacity) noexcept :
+                    m_head{ nullptr, reinterpret_cast< Entry* >(this + 1),
+                        static_cast< uint32_t >(capacity), 0 },
+                    m_tail{ &m_head },
+                    m_size{ 0 },
+                    m_erased{ 0 },
+                    m_index{ nullptr },
+                    m_indexMask{ 0 },
+                    m_indexUsed{ 0 }
+            {
+            }
+
+            ~EntryTable() = default;
+
+            template< typename MATCH >
+            Entry* find(size_t hash, MATCH&& match) const noexcept
+            {
+                if (m_index)
+                {
+                    for (size_t i = hash & m_indexMask; m_index[i]; i = (i + 1) & m_indexMask)
+                    {
+                        if (m_index[i]->m_key && match(m_index[i]->m_key))
+                        {
+                            return m_index[i];
+                        }
+                    }
+                    return nullptr;
+                }
+
+                for (const EntryChunk* chunk = &m_head; chunk; chunk = chunk->m_next)
+                {
+                    for (uint32_t i = 0; i < chunk->m_used; ++i)
+                    {
+                        Entry& entry = chunk->m_entries[i];
+                        if (entry.m_key && match(entry.m_key))
+                        {
+                            return &entry;
+                        }
+                    }
+                }
+                return nullptr;
+            }
+
+            Entry* findErased() noexcept
+            {
+                for (EntryChunk* chunk = &m_head; chunk; chunk = chunk->m_next)
+                {
+                    for (uint32_t i = 0; i < chunk->m_used; ++i)
+                    {
+                        if (!chunk->m_entries[i].m_key)
+                        {
+                            return &chunk->m_entries[i];
+                        }
+                    }
+                }
+                return nullptr;
+            }
+
+            // Returns uninitialized storage for the next entry in the tail chunk.
+            Entry* allocate()
+            {
+                if (m_tail->m_used == m_tail->m_capacity)
+                {
+                    // Grows geometrically, like a vector would.
+                    const size_t capacity = m_size + m_erased;
+
+                    void* mem = ::operator new(sizeof(EntryChunk) + capacity * sizeof(Entry));
+                    EntryChunk* chunk = static_cast< EntryChunk* >(mem);
+                    chunk->m_next = nullptr;
+                    chunk->m_entries = reinterpret_cast< Entry* >(chunk + 1);
+                    chunk->m_capacity = static_cast< uint32_t >(capacity);
+                    chunk->m_used = 0;
+
+                    m_tail->m_next = chunk;
+                    m_tail = chunk;
+                }
+                return &m_tail->m_entries[m_tail->m_used];
+            }
+
+            void addToIndex(Entry* entry) noexcept
+            {
+                if (m_index && (m_indexUsed + 1) * 2 <= m_indexMask + 1)
+                {
+                    putIndex(entry);
+                }
+                else if (m_index || m_size > LINEAR_SEARCH_LIMIT)
+                {
+                    buildIndex();
+                }
+            }
+
+            // Without an index, entries are searched linearly.
+            // So failing to allocate one is not an error.
+            void buildIndex() noexcept
+            {
+                delete[] m_index;
+                m_index = nullptr;
+
+                if (m_size <= LINEAR_SEARCH_LIMIT)
+                {
+                    return;
+                }
+
+                size_t capacity = 16;
+                while (capacity < m_size * 4)
+                {
+                    capacity <<= 1;
+                }
+
+                m_index = new (std::nothrow) Entry*[capacity]();
+                if (!m_index)
+                {
+                    return;
+                }
+
+                m_indexMask = capacity - 1;
+                m_indexUsed = 0;
+
+                for (auto pos = first(this); pos.m_chunk; pos = next(pos))
+                {
+                    putIndex(&entryAt(pos));
+                }
+            }
+
+            void putIndex(Entry* entry) noexcept
+            {
+                size_t i = entry->m_key->m_hash & m_indexMask;
+                while (m_index[i])
+                {
+                    i = (i + 1) & m_indexMask;
+                }
+                m_index[i] = entry;
+                ++m_indexUsed;
+            }
+
+        private:
+            EntryChunk m_head;
+            EntryChunk* m_tail;
+            size_t m_size;
+            size_t m_erased;
+
+            Entry** m_index;
+            size_t m_indexMask;
+            size_t m_indexUsed;
+        };
+
+        constexpr size_t RCSResourceAttributes::EntryTable::MIN_CAPACITY;
+        constexpr size_t RCSResourceAttributes::EntryTable::LINEAR_SEARCH_LIMIT;
+
+
         RCSResourceAttributes::Value::ComparisonHelper::ComparisonHelper(const Value& v) :
                 m_valueRef(v)
         {
@@ -227,7 +676,33 @@ namespace OIC
         bool RCSResourceAttributes::Value::ComparisonHelper::operator==
                 (const Value::ComparisonHelper& rhs) const
         {
-            return *m_valueRef.m_data == *rhs.m_valueRef.m_data;
+            const Value& lhsValue = m_valueRef;
+            const Value& rhsValue = rhs.m_valueRef;
+
+            if (lhsValue.m_which != rhsValue.m_which)
+            {
+                return false;
+            }
+
+            switch (lhsValue.m_which)
+            {
+                case IndexOfType< std::nullptr_t >::value:
+                    return true;
+
+                case IndexOfType< int >::value:
+                    return lhsValue.m_storage.m_int == rhsValue.m_storage.m_int;
+
+                case IndexOfType< double >::value:
+                    return lhsValue.m_storage.m_double == rhsValue.m_storage.m_double;
+
+                case IndexOfType< bool >::value:
+                    return lhsValue.m_storage.m_bool == rhsValue.m_storage.m_bool;
+
+                default:
+                    return lhsValue.m_storage.m_shared == rhsValue.m_storage.m_shared
+                            || lhsValue.m_storage.m_shared->m_data
+                                    == rhsValue.m_storage.m_shared->m_data;
+            }
         }
 
         bool operator==(const RCSResourceAttributes::Type& lhs,
@@ -256,7 +731,25 @@ namespace OIC
 
         bool operator==(const RCSResourceAttributes& lhs, const RCSResourceAttributes& rhs)
         {
-            return lhs.m_values == rhs.m_values;
+            typedef RCSResourceAttributes::EntryTable EntryTable;
+
+            if (lhs.size() != rhs.size())
+            {
+                return false;
+            }
+
+            // Keys are interned, so entries are matched by the key pointer.
+            for (auto pos = EntryTable::first(lhs.m_table); pos.m_chunk; pos = EntryTable::next(pos))
+            {
+                const auto& entry = EntryTable::entryAt(pos);
+                const auto* matched = rhs.m_table->find(entry.m_key);
+
+                if (!matched || matched->m_value != entry.m_value)
+                {
+                    return false;
+                }
+            }
+            return true;
         }
 
         bool operator!=(const RCSResourceAttributes& lhs, const RCSResourceAttributes& rhs)
@@ -281,82 +774,157 @@ namespace OIC
 
 
         RCSResourceAttributes::Value::Value() :
-                m_data{ new ValueVariant{} }
+                m_storage(),
+                m_which{ IndexOfType< std::nullptr_t >::value },
+                m_leaked{ false }
         {
         }
 
         RCSResourceAttributes::Value::Value(const Value& from) :
-                m_data{ new ValueVariant{ *from.m_data } }
+                m_storage(from.m_storage),
+                m_which{ from.m_which },
+                m_leaked{ false }
         {
+            if (!isShared())
+            {
+                return;
+            }
+
+            if (from.m_leaked)
+            {
+                m_storage.m_shared = new SharedData{ from.m_storage.m_shared->m_data };
+            }
+            else
+            {
+                m_storage.m_shared->m_refs.fetch_add(1, std::memory_order_relaxed);
+            }
         }
 
         RCSResourceAttributes::Value::Value(Value&& from) noexcept :
-                m_data{ new ValueVariant{} }
+                m_storage(from.m_storage),
+                m_which{ from.m_which },
+                m_leaked{ from.m_leaked }
         {
-            m_data.swap(from.m_data);
+            from.m_storage.m_null = nullptr;
+            from.m_which = IndexOfType< std::nullptr_t >::value;
+            from.m_leaked = false;
         }
 
         RCSResourceAttributes::Value::Value(const char* value) :
-                m_data{ new ValueVariant{ std::string{ value } } }
+                m_storage(),
+                m_which{ IndexOfType< std::string >::value },
+                m_leaked{ false }
+        {
+            m_storage.m_shared = new SharedData{ std::string{ value } };
+        }
+
+        RCSResourceAttributes::Value::~Value()
         {
+            release();
         }
 
         auto RCSResourceAttributes::Value::operator=(const Value& rhs) -> Value&
         {
-            *m_data = *rhs.m_data;
+            Value(rhs).swap(*this);
             return *this;
         }
 
         auto RCSResourceAttributes::Value::operator=(Value&& rhs) -> Value&
         {
-            *m_data = ValueVariant{};
-            m_data->swap(*rhs.m_data);
+            Value(std::move(rhs)).swap(*this);
             return *this;
         }
 
         auto RCSResourceAttributes::Value::operator=(const char* rhs) -> Value&
         {
-            *m_data = std::string{ rhs };
+            Value(rhs).swap(*this);
             return *this;
         }
 
         auto RCSResourceAttributes::Value::operator=(std::nullptr_t) -> Value&
         {
-            *m_data = nullptr;
+            release();
+
+            m_storage.m_null = nullptr;
+            m_which = IndexOfType< std::nullptr_t >::value;
+            m_leaked = false;
             return *this;
         }
 
         auto RCSResourceAttributes::Value::getType() const -> Type
         {
-            return boost::apply_visitor(TypeVisitor(), *m_data);
+            return Type{ m_which };
         }
 
         std::string RCSResourceAttributes::Value::toString() const
         {
-            return boost::apply_visitor(ToStringVisitor(), *m_data);
+            switch (m_which)
+            {
+                case IndexOfType< std::nullptr_t >::value:
+                    return ToStringVisitor()(m_storage.m_null);
+
+                case IndexOfType< int >::value:
+                    return ToStringVisitor()(m_storage.m_int);
+
+                case IndexOfType< double >::value:
+                    return ToStringVisitor()(m_storage.m_double);
+
+                case IndexOfType< bool >::value:
+                    return ToStringVisitor()(m_storage.m_bool);
+
+                default:
+                    return boost::apply_visitor(ToStringVisitor(), m_storage.m_shared->m_data);
+            }
         }
 
         void RCSResourceAttributes::Value::swap(Value& rhs) noexcept
         {
-            m_data.swap(rhs.m_data);
+            std::swap(m_storage, rhs.m_storage);
+            std::swap(m_which, rhs.m_which);
+            std::swap(m_leaked, rhs.m_leaked);
+        }
+
+        bool RCSResourceAttributes::Value::isShared() const noexcept
+        {
+            return m_which > IndexOfType< bool >::value;
+        }
+
+        void RCSResourceAttributes::Value::detach()
+        {
+            if (m_storage.m_shared->m_refs.load(std::memory_order_acquire) > 1)
+            {
+                SharedData* copied = new SharedData{ m_storage.m_shared->m_data };
+                release();
+                m_storage.m_shared = copied;
+            }
+            m_leaked = true;
+        }
+
+        void RCSResourceAttributes::Value::release() noexcept
+        {
+            if (isShared()
+                    && m_storage.m_shared->m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                delete m_storage.m_shared;
+            }
         }
 
         auto RCSResourceAttributes::KeyValuePair::KeyVisitor::operator()(
                 iterator* iter) const noexcept -> result_type
         {
-            return iter->m_cur->first;
+            return EntryTable::entryAt(iter->m_cur).m_key->m_str;
         }
 
         auto RCSResourceAttributes::KeyValuePair::KeyVisitor::operator()(
                 const_iterator* iter) const noexcept -> result_type
         {
-            return iter->m_cur->first;
+            return EntryTable::entryAt(iter->m_cur).m_key->m_str;
         }
 
         auto RCSResourceAttributes::KeyValuePair::ValueVisitor::operator() (iterator* iter) noexcept
                 -> result_type
         {
-            return iter->m_cur->second;
+            return EntryTable::entryAt(iter->m_cur).m_value;
         }
 
         auto RCSResourceAttributes::KeyValuePair::ValueVisitor::operator() (const_iterator*)
@@ -369,13 +937,13 @@ namespace OIC
         auto RCSResourceAttributes::KeyValuePair::ConstValueVisitor::operator()(
                 iterator*iter) const noexcept -> result_type
         {
-            return iter->m_cur->second;
+            return EntryTable::entryAt(iter->m_cur).m_value;
         }
 
         auto RCSResourceAttributes::KeyValuePair::ConstValueVisitor::operator()(
                 const_iterator* iter) const noexcept -> result_type
         {
-            return iter->m_cur->second;
+            return EntryTable::entryAt(iter->m_cur).m_value;
         }
 
         auto RCSResourceAttributes::KeyValuePair::key() const noexcept -> const std::string&
@@ -424,7 +992,7 @@ namespace OIC
 
         auto RCSResourceAttributes::iterator::operator++() -> iterator&
         {
-            ++m_cur;
+            m_cur = EntryTable::next(m_cur);
             return *this;
         }
 
@@ -437,7 +1005,7 @@ namespace OIC
 
         bool RCSResourceAttributes::iterator::operator==(const iterator& rhs) const
         {
-            return m_cur == rhs.m_cur;
+            return m_cur.m_chunk == rhs.m_cur.m_chunk && m_cur.m_index == rhs.m_cur.m_index;
         }
 
         bool RCSResourceAttributes::iterator::operator!=(const iterator& rhs) const
@@ -458,14 +1026,14 @@ namespace OIC
 
         RCSResourceAttributes::const_iterator::const_iterator(
                 const RCSResourceAttributes::iterator& iter) :
-                m_cur{ iter.m_cur }, m_keyValuePair{ this }
+                m_cur{ iter.m_cur.m_chunk, iter.m_cur.m_index }, m_keyValuePair{ this }
         {
         }
 
         auto RCSResourceAttributes::const_iterator::operator=(
                 const RCSResourceAttributes::iterator& iter) -> const_iterator&
         {
-            m_cur = iter.m_cur;
+            m_cur = base_iterator{ iter.m_cur.m_chunk, iter.m_cur.m_index };
             return *this;
         }
 
@@ -481,7 +1049,7 @@ namespace OIC
 
         auto RCSResourceAttributes::const_iterator::operator++() -> const_iterator&
         {
-            ++m_cur;
+            m_cur = EntryTable::next(m_cur);
             return *this;
         }
 
@@ -494,7 +1062,7 @@ namespace OIC
 
         bool RCSResourceAttributes::const_iterator::operator==(const const_iterator& rhs) const
         {
-            return m_cur == rhs.m_cur;
+            return m_cur.m_chunk == rhs.m_cur.m_chunk && m_cur.m_index == rhs.m_cur.m_index;
         }
 
         bool RCSResourceAttributes::const_iterator::operator!=(const const_iterator& rhs) const
@@ -503,93 +1071,169 @@ namespace OIC
         }
 
 
+        RCSResourceAttributes::RCSResourceAttributes() noexcept :
+                m_table{ nullptr }
+        {
+        }
+
+        RCSResourceAttributes::RCSResourceAttributes(const RCSResourceAttributes& from) :
+                m_table{ EntryTable::copy(from.m_table) }
+        {
+        }
+
+        RCSResourceAttributes::RCSResourceAttributes(RCSResourceAttributes&& from) noexcept :
+                m_table{ from.m_table }
+        {
+            from.m_table = nullptr;
+        }
+
+        RCSResourceAttributes::~RCSResourceAttributes()
+        {
+            EntryTable::destroy(m_table);
+        }
+
+        auto RCSResourceAttributes::operator=(const RCSResourceAttributes& rhs)
+                -> RCSResourceAttributes&
+        {
+            if (this != &rhs)
+            {
+                EntryTable* copied = EntryTable::copy(rhs.m_table);
+                EntryTable::destroy(m_table);
+                m_table = copied;
+            }
+            return *this;
+        }
+
+        auto RCSResourceAttributes::operator=(RCSResourceAttributes&& rhs) noexcept
+                -> RCSResourceAttributes&
+        {
+            std::swap(m_table, rhs.m_table);
+            rhs.clear();
+            return *this;
+        }
+
         auto RCSResourceAttributes::begin() noexcept -> iterator
         {
-            return iterator{ m_values.begin() };
+            return iterator{ EntryTable::first(m_table) };
         }
 
         auto RCSResourceAttributes::end() noexcept -> iterator
         {
-            return iterator{ m_values.end() };
+            return iterator{ };
         }
 
         auto RCSResourceAttributes::begin() const noexcept -> const_iterator
         {
-            return const_iterator{ m_values.begin() };
+            return const_iterator{ EntryTable::first(static_cast< const EntryTable* >(m_table)) };
         }
 
         auto RCSResourceAttributes::end() const noexcept -> const_iterator
         {
-            return const_iterator{ m_values.end() };
+            return const_iterator{ };
         }
 
         auto RCSResourceAttributes::cbegin() const noexcept -> const_iterator
         {
-            return const_iterator{ m_values.begin() };
+            return begin();
         }
 
         auto RCSResourceAttributes::cend() const noexcept -> const_iterator
         {
-            return const_iterator{ m_values.end() };
+            return end();
         }
 
         auto RCSResourceAttributes::operator[](const std::string& key) -> Value&
         {
-            return m_values[key];
+            const size_t hash = hashKey(key);
+
+            if (!m_table)
+            {
+                m_table = EntryTable::create(EntryTable::MIN_CAPACITY);
+            }
+            else if (Entry* entry = m_table->find(key, hash))
+            {
+                return entry->m_value;
+            }
+            return m_table->insert(key, hash).m_value;
         }
 
         auto RCSResourceAttributes::operator[](std::string&& key) -> Value&
         {
-            return m_values[std::move(key)];
+            const size_t hash = hashKey(key);
+
+            if (!m_table)
+            {
+                m_table = EntryTable::create(EntryTable::MIN_CAPACITY);
+            }
+            else if (Entry* entry = m_table->find(key, hash))
+            {
+                return entry->m_value;
+            }
+            return m_table->insert(std::move(key), hash).m_value;
         }
 
         auto RCSResourceAttributes::at(const std::string& key) -> Value&
         {
-            try
-            {
-                return m_values.at(key);
-            }
-            catch (const std::out_of_range&)
+            Entry* entry = m_table ? m_table->find(key, hashKey(key)) : nullptr;
+
+            if (!entry)
             {
                 throw RCSInvalidKeyException{ "No attribute named '" + key + "'" };
             }
+            return entry->m_value;
         }
 
         auto RCSResourceAttributes::at(const std::string& key) const -> const Value&
         {
-            try
-            {
-                return m_values.at(key);
-            }
-            catch (const std::out_of_range&)
+            const Entry* entry = m_table ? m_table->find(key, hashKey(key)) : nullptr;
+
+            if (!entry)
             {
                 throw RCSInvalidKeyException{ "No attribute named '" + key + "'" };
             }
+            return entry->m_value;
         }
 
         void RCSResourceAttributes::clear() noexcept
         {
-            return m_values.clear();
+            EntryTable::destroy(m_table);
+            m_table = nullptr;
         }
 
         bool RCSResourceAttributes::erase(const std::string& key)
         {
-            return m_values.erase(key) == 1U;
+            Entry* entry = m_table ? m_table->find(key, hashKey(key)) : nullptr;
+
+            if (!entry)
+            {
+                return false;
+            }
+
+            m_table->erase(*entry);
+            return true;
         }
 
         bool RCSResourceAttributes::contains(const std::string& key) const
         {
-            return m_values.find(key) != m_values.end();
+            return m_table && m_table->find(key, hashKey(key));
         }
 
         bool RCSResourceAttributes::empty() const noexcept
         {
-            return m_values.empty();
+            return size() == 0;
         }
 
         size_t RCSResourceAttributes::size() const noexcept
         {
-            return m_values.size();
+            return m_table ? m_table->size() : 0;
+        }
+
+        void RCSResourceAttributes::reserve(size_t size)
+        {
+            if (!m_table)
+            {
+                m_table = EntryTable::create(size);
+            }
         }
 
 
@@ -24,6 +24,10 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <cstdio>
+#include <malloc.h>
+
 using namespace testing;
 using namespace OIC::Service;
 
@@ -73,6 +77,72 @@ TEST_F(ResourceAttributesTest, CopyingValueDoesNotShareState)
     ASSERT_EQ(copied, arbitraryStr);
 }
 
+TEST_F(ResourceAttributesTest, CopyingNestedAttributesDoesNotShareState)
+{
+    RCSResourceAttributes nested;
+    nested[KEY] = "before";
+    resourceAttributes[KEY] = nested;
+
+    RCSResourceAttributes copied{ resourceAttributes };
+    copied[KEY].get< RCSResourceAttributes >()[KEY] = "after";
+
+    ASSERT_EQ("before", resourceAttributes[KEY].get< RCSResourceAttributes >()[KEY]);
+    ASSERT_EQ("after", copied[KEY].get< RCSResourceAttributes >()[KEY]);
+}
+
+TEST_F(ResourceAttributesTest, ValueRefObtainedBeforeCopyDoesNotChangeCopy)
+{
+    resourceAttributes[KEY] = std::vector< int >{ 1, 2, 3 };
+    auto& vec = resourceAttributes[KEY].get< std::vector< int > >();
+
+    RCSResourceAttributes copied{ resourceAttributes };
+    vec.push_back(4);
+
+    ASSERT_EQ(3U, copied[KEY].get< std::vector< int > >().size());
+}
+
+TEST_F(ResourceAttributesTest, ValueRefIsValidAfterOtherValuesAreInserted)
+{
+    auto& valueRef = resourceAttributes[KEY];
+
+    for (int i = 0; i < 100; ++i)
+    {
+        resourceAttributes["key" + std::to_string(i)] = i;
+    }
+    valueRef = 1;
+
+    ASSERT_EQ(resourceAttributes[KEY], 1);
+}
+
+TEST_F(ResourceAttributesTest, ManyValuesCanBeFoundAfterErased)
+{
+    for (int i = 0; i < 100; ++i)
+    {
+        resourceAttributes["key" + std::to_string(i)] = i;
+    }
+    for (int i = 0; i < 100; i += 2)
+    {
+        resourceAttributes.erase("key" + std::to_string(i));
+    }
+    resourceAttributes["key0"] = -1;
+
+    ASSERT_EQ(51U, resourceAttributes.size());
+    ASSERT_EQ(resourceAttributes.at("key0"), -1);
+    ASSERT_EQ(resourceAttributes.at("key99"), 99);
+    ASSERT_FALSE(resourceAttributes.contains("key98"));
+}
+
+TEST_F(ResourceAttributesTest, AttributesWithSameValuesInDifferentOrderAreEqual)
+{
+    RCSResourceAttributes other;
+    resourceAttributes["first"] = 1;
+    resourceAttributes["second"] = "2";
+    other["second"] = "2";
+    other["first"] = 1;
+
+    ASSERT_EQ(resourceAttributes, other);
+}
+
 TEST_F(ResourceAttributesTest, IsNullWhenAssignmentNullptr)
 {
     resourceAttributes[KEY] = nullptr;
@@ -357,6 +427,20 @@ TEST(ResourceAttributesConverterTest, NestedOCRepresentationCanBeConvertedIntoRe
 }
 
 
+TEST(ResourceAttributesConverterTest, MovedOCRepresentationCanBeConvertedIntoResourceAttributes)
+{
+    std::vector< std::string > value{ "first", "second" };
+    OC::OCRepresentation ocRep;
+    OC::OCRepresentation nested;
+    nested[KEY] = value;
+    ocRep[KEY] = nested;
+
+    RCSResourceAttributes resourceAttributes{
+        ResourceAttributesConverter::fromOCRepresentation(std::move(ocRep)) };
+
+    ASSERT_EQ(value, resourceAttributes[KEY].get< RCSResourceAttributes >()[KEY]);
+}
+
 TEST(ResourceAttributesConverterTest, ResourceAttributesCanBeConvertedIntoOCRepresentation)
 {
     double value { 3453453 };
@@ -507,3 +591,97 @@ TEST_F(ResourceAttributesUtilTest, ReplaceWillOverwriteOriginal)
 
     ASSERT_EQ(NEW_VALUE, resourceAttributes[KEY]);
 }
+
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    constexpr int BENCHMARK_ITERATIONS{ 100000 };
+    constexpr int BENCHMARK_SETS{ 10000 };
+
+    // What a typical environment sensor reports.
+    RCSResourceAttributes createSensorAttributes(int seed)
+    {
+        RCSResourceAttributes location;
+        location["room"] = "living room";
+        location["floor"] = seed % 10;
+
+        RCSResourceAttributes attrs;
+        attrs["temperature"] = 21.5 + seed;
+        attrs["humidity"] = 40 + seed;
+        attrs["power"] = true;
+        attrs["unit"] = "C";
+        attrs["location"] = location;
+        attrs["history"] = std::vector< double >(16, seed);
+        return attrs;
+    }
+
+    size_t allocatedBytes()
+    {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        return mallinfo2().uordblks;
+#else
+        return mallinfo().uordblks;
+#endif
+    }
+
+    template< typename FUNC >
+    void benchmark(const char* name, FUNC&& func)
+    {
+        const auto start = Clock::now();
+        for (int i = 0; i < BENCHMARK_ITERATIONS; ++i)
+        {
+            func(i);
+        }
+        const auto elapsed = Clock::now() - start;
+
+        printf("[          ] %s: %.3f usec\n", name,
+                std::chrono::duration< double, std::micro >(elapsed).count()
+                / BENCHMARK_ITERATIONS);
+    }
+}
+
+TEST(ResourceAttributesBenchmark, SensorPayload)
+{
+    RCSResourceAttributes attrs{ createSensorAttributes(0) };
+    const RCSResourceAttributes& constAttrs = attrs;
+    RCSResourceAttributes copied;
+    OC::OCRepresentation ocRep{ ResourceAttributesConverter::toOCRepresentation(attrs) };
+    double sum{ 0 };
+    int equal{ 0 };
+
+    benchmark("get", [&](int)
+    {
+        sum += constAttrs.at("temperature").get< double >();
+    });
+    benchmark("set", [&](int i)
+    {
+        attrs["humidity"] = i;
+    });
+    benchmark("copy", [&](int)
+    {
+        copied = attrs;
+    });
+    benchmark("compare", [&](int)
+    {
+        equal += copied == attrs;
+    });
+    benchmark("fromOCRepresentation", [&](int)
+    {
+        copied = ResourceAttributesConverter::fromOCRepresentation(ocRep);
+    });
+
+    std::vector< RCSResourceAttributes > sets;
+    sets.reserve(BENCHMARK_SETS);
+    const size_t before{ allocatedBytes() };
+    for (int i = 0; i < BENCHMARK_SETS; ++i)
+    {
+        sets.push_back(createSensorAttributes(i));
+    }
+    printf("[          ] %.1f bytes per attribute set\n", sizeof(RCSResourceAttributes)
+            + static_cast< double >(allocatedBytes() - before) / BENCHMARK_SETS);
+
+    EXPECT_EQ(BENCHMARK_ITERATIONS, equal);
+    EXPECT_NE(0, sum);
+}
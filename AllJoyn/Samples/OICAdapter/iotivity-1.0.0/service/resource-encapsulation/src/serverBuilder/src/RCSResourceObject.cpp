@@ -27,6 +27,7 @@
 #include <RequestHandler.h>
 #include <AssertUtils.h>
 #include <AtomicHelper.h>
+#include <ExpiryTimer.h>
 #include <ResourceAttributesConverter.h>
 #include <ResourceAttributesUtils.h>
 
@@ -39,6 +40,8 @@ namespace
 {
     using namespace OIC::Service;
 
+    constexpr char PARTIAL_NOTIFICATION_QUERY[]{ "delta" };
+
     inline bool hasProperty(uint8_t base, uint8_t target)
     {
         return (base & target) == target;
@@ -97,29 +100,6 @@ namespace
         return RESPONSE::defaultAction();
     }
 
-    typedef void (RCSResourceObject::* AutoNotifyFunc)
-            (bool, RCSResourceObject::AutoNotifyPolicy) const;
-
-    std::function <void ()> createAutoNotifyInvoker(AutoNotifyFunc autoNotifyFunc,
-            const RCSResourceObject& resourceObject, const RCSResourceAttributes& resourceAttributes,
-            RCSResourceObject::AutoNotifyPolicy autoNotifyPolicy)
-    {
-        if(autoNotifyPolicy == RCSResourceObject::AutoNotifyPolicy::UPDATED)
-        {
-            auto&& compareAttributesFunc =
-                    std::bind(std::not_equal_to<RCSResourceAttributes>(),
-                                resourceAttributes,
-                                std::cref(resourceAttributes));
-            return std::bind(autoNotifyFunc,
-                    &resourceObject, std::move(compareAttributesFunc), autoNotifyPolicy);
-        }
-        else if(autoNotifyPolicy == RCSResourceObject::AutoNotifyPolicy::ALWAYS)
-        {
-            return std::bind(autoNotifyFunc,
-                    &resourceObject, true, autoNotifyPolicy);
-        }
-        return {};
-    }
 } // unnamed namespace
 
 
@@ -199,9 +179,23 @@ namespace OIC
                 m_attributeUpdatedListeners{ },
                 m_lockOwner{ },
                 m_mutex{ },
-                m_mutexAttributeUpdatedListeners{ }
+                m_mutexAttributeUpdatedListeners{ },
+                m_snapshot{ std::make_shared< const RCSResourceAttributes >(m_resourceAttributes) },
+                m_mutexSnapshot{ },
+                m_changedKeys{ },
+                m_changeCount{ 0 },
+                m_attributesExposed{ false },
+                m_autoNotifyInterval{ 0 },
+                m_autoNotifyMaxChanges{ 0 },
+                m_autoNotifyPending{ false },
+                m_autoNotifyScheduled{ false },
+                m_autoNotifyTimer{ },
+                m_notifyingChanges{ },
+                m_notifyingThread{ },
+                m_mutexNotifyingChanges{ }
         {
             m_lockOwner.reset(new AtomicThreadId);
+            m_notifyingThread.reset(new AtomicThreadId);
         }
 
         RCSResourceObject::~RCSResourceObject()
@@ -228,13 +222,14 @@ namespace OIC
             {
                 WeakGuard lock(*this);
 
-                if (lock.hasLocked())
-                {
-                    needToNotify = true;
-                    valueUpdated = testValueUpdated(key, value);
-                }
+                needToNotify = lock.hasLocked();
+                valueUpdated = testValueUpdated(key, value);
+
+                if (valueUpdated) recordChange(key);
 
                 m_resourceAttributes[std::forward< K >(key)] = std::forward< V >(value);
+
+                if (needToNotify && valueUpdated) publishSnapshot();
             }
 
             if (needToNotify) autoNotify(valueUpdated);
@@ -266,8 +261,12 @@ namespace OIC
         RCSResourceAttributes::Value RCSResourceObject::getAttributeValue(
                 const std::string& key) const
         {
-            WeakGuard lock(*this);
-            return m_resourceAttributes.at(key);
+            if (getLockOwner() == std::this_thread::get_id())
+            {
+                return m_resourceAttributes.at(key);
+            }
+
+            return getAttributesSnapshot()->at(key);
         }
 
         bool RCSResourceObject::removeAttribute(const std::string& key)
@@ -281,6 +280,9 @@ namespace OIC
                 {
                     erased = true;
                     needToNotify = lock.hasLocked();
+
+                    recordChange(key);
+                    if (needToNotify) publishSnapshot();
                 }
             }
 
@@ -291,13 +293,21 @@ namespace OIC
 
         bool RCSResourceObject::containsAttribute(const std::string& key) const
         {
-            WeakGuard lock(*this);
-            return m_resourceAttributes.contains(key);
+            if (getLockOwner() == std::this_thread::get_id())
+            {
+                return m_resourceAttributes.contains(key);
+            }
+
+            return getAttributesSnapshot()->contains(key);
         }
 
         RCSResourceAttributes& RCSResourceObject::getAttributes()
         {
             expectOwnLock();
+
+            // Changes through the reference are found by comparing with the snapshot
+            // when the guard is released.
+            m_attributesExposed = true;
             return m_resourceAttributes;
         }
 
@@ -307,6 +317,53 @@ namespace OIC
             return m_resourceAttributes;
         }
 
+        std::shared_ptr< const RCSResourceAttributes >
+        RCSResourceObject::getAttributesSnapshot() const
+        {
+            std::lock_guard< std::mutex > lock(m_mutexSnapshot);
+            return m_snapshot;
+        }
+
+        void RCSResourceObject::recordChange(const std::string& key) const
+        {
+            m_changedKeys.insert(key);
+            ++m_changeCount;
+        }
+
+        bool RCSResourceObject::collectChanges() const
+        {
+            const RCSResourceAttributes& committed = *m_snapshot;
+            bool changed = false;
+
+            for (const auto& kv : m_resourceAttributes)
+            {
+                if (!committed.contains(kv.key()) || committed.at(kv.key()) != kv.value())
+                {
+                    recordChange(kv.key());
+                    changed = true;
+                }
+            }
+
+            for (const auto& kv : committed)
+            {
+                if (!m_resourceAttributes.contains(kv.key()))
+                {
+                    recordChange(kv.key());
+                    changed = true;
+                }
+            }
+
+            return changed;
+        }
+
+        void RCSResourceObject::publishSnapshot() const
+        {
+            auto snapshot = std::make_shared< const RCSResourceAttributes >(m_resourceAttributes);
+
+            std::lock_guard< std::mutex > lock(m_mutexSnapshot);
+            m_snapshot.swap(snapshot);
+        }
+
         void RCSResourceObject::expectOwnLock() const
         {
             if (getLockOwner() != std::this_thread::get_id())
@@ -346,6 +403,18 @@ namespace OIC
         }
 
         void RCSResourceObject::notify() const
+        {
+            {
+                WeakGuard lock(*this);
+
+                m_changedKeys.clear();
+                m_autoNotifyPending = false;
+            }
+
+            sendNotification();
+        }
+
+        void RCSResourceObject::sendNotification() const
         {
             typedef OCStackResult (*NotifyAllObservers)(OCResourceHandle);
 
@@ -396,6 +465,15 @@ namespace OIC
             return m_autoNotifyPolicy;
         }
 
+        void RCSResourceObject::setAutoNotifyInterval(std::chrono::milliseconds interval,
+                size_t maxChangedAttributes)
+        {
+            WeakGuard lock(*this);
+
+            m_autoNotifyInterval = interval;
+            m_autoNotifyMaxChanges = maxChangedAttributes;
+        }
+
         void RCSResourceObject::setSetRequestHandlerPolicy(SetRequestHandlerPolicy policy)
         {
             m_setRequestHandlerPolicy = policy;
@@ -418,7 +496,107 @@ namespace OIC
             if(autoNotifyPolicy == AutoNotifyPolicy::UPDATED &&
                     isAttributesChanged == false) return;
 
-            notify();
+            {
+                WeakGuard lock(*this);
+
+                m_autoNotifyPending = true;
+
+                if (m_autoNotifyInterval.count() > 0 && (m_autoNotifyMaxChanges == 0
+                        || m_changedKeys.size() < m_autoNotifyMaxChanges))
+                {
+                    scheduleAutoNotify();
+                    return;
+                }
+            }
+
+            sendAutoNotification();
+        }
+
+        void RCSResourceObject::scheduleAutoNotify() const
+        {
+            if (m_autoNotifyScheduled) return;
+
+            if (!m_autoNotifyTimer) m_autoNotifyTimer.reset(new ExpiryTimer);
+
+            std::weak_ptr< const RCSResourceObject > weakThis{ shared_from_this() };
+
+            m_autoNotifyTimer->post(m_autoNotifyInterval.count(),
+                    [weakThis](ExpiryTimer::Id)
+                    {
+                        auto resource = weakThis.lock();
+                        if (!resource) return;
+
+                        try
+                        {
+                            resource->sendAutoNotification();
+                        }
+                        catch (const RCSPlatformException& e)
+                        {
+                            OC_LOG_V(ERROR, LOG_TAG, "Auto notification failed : %s", e.what());
+                        }
+                    });
+            m_autoNotifyScheduled = true;
+        }
+
+        void RCSResourceObject::sendAutoNotification() const
+        {
+            RCSResourceAttributes changes;
+            bool partial = true;
+
+            {
+                WeakGuard lock(*this);
+
+                if (!m_autoNotifyPending) return;
+
+                for (const auto& key : m_changedKeys)
+                {
+                    if (!m_resourceAttributes.contains(key))
+                    {
+                        partial = false;
+                        break;
+                    }
+                    changes[key] = m_resourceAttributes.at(key);
+                }
+
+                m_changedKeys.clear();
+                m_autoNotifyPending = false;
+                m_autoNotifyScheduled = false;
+                if (m_autoNotifyTimer) m_autoNotifyTimer->cancelAll();
+            }
+
+            // Only one partial notification is prepared at a time; a concurrent one falls back
+            // to the full attributes, which is always correct.
+            std::unique_lock< std::mutex > lock(m_mutexNotifyingChanges, std::try_to_lock);
+
+            if (!partial || changes.empty() || !lock.owns_lock())
+            {
+                sendNotification();
+                return;
+            }
+
+            m_notifyingChanges = std::move(changes);
+            m_notifyingThread->store(std::this_thread::get_id());
+
+            try
+            {
+                sendNotification();
+            }
+            catch (...)
+            {
+                m_notifyingThread->store(std::thread::id{ });
+                m_notifyingChanges.clear();
+                throw;
+            }
+
+            m_notifyingThread->store(std::thread::id{ });
+            m_notifyingChanges.clear();
+        }
+
+        bool RCSResourceObject::isPartialNotification(const OC::OCResourceRequest& request) const
+        {
+            // Notifications are requested from the entity handler by the thread sending them.
+            return m_notifyingThread->load() == std::this_thread::get_id()
+                    && request.getQueryParameters().count(PARTIAL_NOTIFICATION_QUERY) != 0;
         }
 
         OCEntityHandlerResult RCSResourceObject::entityHandler(
@@ -479,6 +657,11 @@ namespace OIC
         {
             assert(request != nullptr);
 
+            if (isPartialNotification(*request))
+            {
+                return sendResponse(*this, request, RCSGetResponse::create(m_notifyingChanges));
+            }
+
             auto attrs = getAttributesFromOCRequest(request);
 
             return sendResponse(*this, request, invokeHandler(attrs, request, m_getRequestHandler));
@@ -551,7 +734,8 @@ namespace OIC
         RCSResourceObject::LockGuard::LockGuard(const RCSResourceObject::Ptr ptr) :
                 m_resourceObject(*ptr),
                 m_autoNotifyPolicy{ ptr->getAutoNotifyPolicy() },
-                m_isOwningLock{ false }
+                m_isOwningLock{ false },
+                m_changeCount{ 0 }
         {
             init();
         }
@@ -560,7 +744,8 @@ namespace OIC
                 const RCSResourceObject& serverResource) :
                 m_resourceObject(serverResource),
                 m_autoNotifyPolicy{ serverResource.getAutoNotifyPolicy() },
-                m_isOwningLock{ false }
+                m_isOwningLock{ false },
+                m_changeCount{ 0 }
         {
             init();
         }
@@ -569,7 +754,8 @@ namespace OIC
                 const RCSResourceObject::Ptr ptr, AutoNotifyPolicy autoNotifyPolicy) :
                 m_resourceObject(*ptr),
                 m_autoNotifyPolicy { autoNotifyPolicy },
-                m_isOwningLock{ false }
+                m_isOwningLock{ false },
+                m_changeCount{ 0 }
         {
             init();
         }
@@ -578,20 +764,39 @@ namespace OIC
                 const RCSResourceObject& resourceObject, AutoNotifyPolicy autoNotifyPolicy) :
                 m_resourceObject(resourceObject),
                 m_autoNotifyPolicy { autoNotifyPolicy },
-                m_isOwningLock{ false }
+                m_isOwningLock{ false },
+                m_changeCount{ 0 }
         {
             init();
         }
 
         RCSResourceObject::LockGuard::~LockGuard()
         {
-            if (m_autoNotifyFunc) m_autoNotifyFunc();
+            bool changed = false;
+
+            if (m_resourceObject.m_attributesExposed
+                    || m_resourceObject.m_changeCount != m_changeCount)
+            {
+                changed = m_resourceObject.collectChanges();
+            }
 
             if (m_isOwningLock)
             {
+                if (changed) m_resourceObject.publishSnapshot();
+                m_resourceObject.m_attributesExposed = false;
+
                 m_resourceObject.setLockOwner(std::thread::id{ });
                 m_resourceObject.m_mutex.unlock();
             }
+
+            try
+            {
+                m_resourceObject.autoNotify(changed, m_autoNotifyPolicy);
+            }
+            catch (const RCSPlatformException& e)
+            {
+                OC_LOG_V(ERROR, LOG_TAG, "Auto notification failed : %s", e.what());
+            }
         }
 
         void RCSResourceObject::LockGuard::init()
@@ -602,8 +807,7 @@ namespace OIC
                 m_resourceObject.setLockOwner(std::this_thread::get_id());
                 m_isOwningLock = true;
             }
-            m_autoNotifyFunc = ::createAutoNotifyInvoker(&RCSResourceObject::autoNotify,
-                    m_resourceObject, m_resourceObject.m_resourceAttributes, m_autoNotifyPolicy);
+            m_changeCount = m_resourceObject.m_changeCount;
         }
 
         RCSResourceObject::WeakGuard::WeakGuard(
@@ -33,7 +33,7 @@ namespace
 
     typedef std::function< OC::OCRepresentation(RCSResourceObject&) > OCRepresentationGetter;
 
-    OC::OCRepresentation getOCRepresentationFromResource(RCSResourceObject& resource)
+    OC::OCRepresentation getOCRepresentationFromResource(const RCSResourceObject& resource)
     {
         RCSResourceObject::LockGuard lock{ resource, RCSResourceObject::AutoNotifyPolicy::NEVER };
         return ResourceAttributesConverter::toOCRepresentation(resource.getAttributes());
@@ -24,6 +24,8 @@
 
 #include <OCPlatform.h>
 
+#include <future>
+
 using namespace std;
 using namespace std::placeholders;
 
@@ -38,6 +40,7 @@ typedef OCStackResult (*NotifyAllObservers)(OCResourceHandle);
 constexpr char RESOURCE_URI[]{ "a/test" };
 constexpr char RESOURCE_TYPE[]{ "resourcetype" };
 constexpr char KEY[]{ "key" };
+constexpr char OTHER_KEY[]{ "otherKey" };
 constexpr int value{ 100 };
 
 TEST(ResourceObjectBuilderCreateTest, ThrowIfUriIsInvalid)
@@ -167,6 +170,29 @@ TEST_F(ResourceObjectTest, SettingNestedVectorAttributesIsSameToGettingNestedVec
     ASSERT_EQ(arr31, server->getAttribute<vector<vector<vector<int>>>>(KEY));
 }
 
+TEST_F(ResourceObjectTest, AttributesCanBeReadWhileGuardIsHeldByOtherThread)
+{
+    server->setAttribute(KEY, value);
+
+    RCSResourceObject::LockGuard lock{ server };
+    server->getAttributes()[KEY] = value + 1;
+
+    auto result = async(launch::async, [this]() { return server->getAttribute<int>(KEY); });
+
+    ASSERT_EQ(future_status::ready, result.wait_for(chrono::seconds{ 1 }));
+    ASSERT_EQ(value, result.get());
+}
+
+TEST_F(ResourceObjectTest, SnapshotHasChangesOnceGuardIsReleased)
+{
+    {
+        RCSResourceObject::LockGuard lock{ server };
+        server->getAttributes()[KEY] = value;
+    }
+
+    ASSERT_EQ(value, server->getAttributesSnapshot()->at(KEY).get<int>());
+}
+
 
 class AutoNotifyTest: public ResourceObjectTest
 {
@@ -249,6 +275,38 @@ TEST_F(AutoNotifyTest, WithUpdatePolicy_WillBeNotifiedIfAttributeIsDeleted)
     server->removeAttribute(KEY);
 }
 
+TEST_F(AutoNotifyTest, WithInterval_ChangesAreSentInOneNotification)
+{
+    server->setAutoNotifyPolicy(RCSResourceObject::AutoNotifyPolicy::UPDATED);
+    server->setAutoNotifyInterval(chrono::milliseconds{ 100 });
+
+    mocks.ExpectCallFuncOverload(static_cast< NotifyAllObservers >(
+            OC::OCPlatform::notifyAllObservers)).Return(OC_STACK_OK);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        server->setAttribute(KEY, value + i);
+    }
+
+    this_thread::sleep_for(chrono::milliseconds{ 300 });
+}
+
+TEST_F(AutoNotifyTest, WithMaxChangedAttributes_NotifiedAsSoonAsLimitIsReached)
+{
+    server->setAutoNotifyPolicy(RCSResourceObject::AutoNotifyPolicy::UPDATED);
+    server->setAutoNotifyInterval(chrono::seconds{ 10 }, 2);
+
+    mocks.NeverCallFuncOverload(static_cast< NotifyAllObservers >(
+            OC::OCPlatform::notifyAllObservers));
+
+    server->setAttribute(KEY, value);
+
+    mocks.ExpectCallFuncOverload(static_cast< NotifyAllObservers >(
+            OC::OCPlatform::notifyAllObservers)).Return(OC_STACK_OK);
+
+    server->setAttribute(OTHER_KEY, value);
+}
+
 class AutoNotifyWithGuardTest: public AutoNotifyTest
 {
 };
@@ -307,7 +365,7 @@ public:
 
 public:
     OCResourceRequest::Ptr createRequest(OCMethod method = OC_REST_GET, OCRepresentation ocRep =
-            OCRepresentation{})
+            OCRepresentation{}, const char* query = nullptr)
     {
         auto request = make_shared<OCResourceRequest>();
 
@@ -320,6 +378,7 @@ public:
         ocEntityHandlerRequest.requestHandle = fakeRequestHandle;
         ocEntityHandlerRequest.resource = fakeResourceHandle;
         ocEntityHandlerRequest.method = method;
+        ocEntityHandlerRequest.query = const_cast<char*>(query);
         ocEntityHandlerRequest.payload = reinterpret_cast<OCPayload*>(mc.getPayload());
 
         formResourceRequest(OC_REQUEST_FLAG, &ocEntityHandlerRequest, request);
@@ -418,6 +477,37 @@ TEST_F(ResourceObjectHandlingRequestTest, SendSetResponseWithCustomAttrs)
     ASSERT_EQ(OC_EH_OK, handler(createRequest(OC_REST_PUT)));
 }
 
+TEST_F(ResourceObjectHandlingRequestTest, PartialNotificationHasOnlyChangedAttributes)
+{
+    mocks.OnCallFuncOverload(static_cast< NotifyAllObservers >(
+            OCPlatform::notifyAllObservers)).Return(OC_STACK_OK);
+
+    server->setAttribute(KEY, value);
+    server->setAttribute(OTHER_KEY, value);
+    server->notify();
+
+    server->setAutoNotifyPolicy(RCSResourceObject::AutoNotifyPolicy::UPDATED);
+
+    mocks.ExpectCallFuncOverload(static_cast< NotifyAllObservers >(
+            OCPlatform::notifyAllObservers)).Do(
+            [this](OCResourceHandle)
+            {
+                handler(createRequest(OC_REST_GET, OCRepresentation{}, "delta=1"));
+                return OC_STACK_OK;
+            }
+    );
+
+    mocks.ExpectCallFunc(OCPlatform::sendResponse).Match(
+            [](const shared_ptr<OCResourceResponse> response)
+            {
+                return response->getResourceRepresentation().hasAttribute(KEY)
+                        && !response->getResourceRepresentation().hasAttribute(OTHER_KEY);
+            }
+    ).Return(OC_STACK_OK);
+
+    server->setAttribute(KEY, value + 1);
+}
+
 
 class SetRequestHandlerPolicyTest: public ResourceObjectHandlingRequestTest
 {